@@ -190,6 +190,13 @@
 #define TCUSEPTHREAD   1
 #endif
 
+#if TCUSEPTHREAD && defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_4) && \
+  defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_8)
+#define TCUSEATOMIC    1
+#else
+#define TCUSEATOMIC    0
+#endif
+
 #if defined(_MYMICROYIELD)
 #define TCMICROYIELD   1
 #else
@@ -514,14 +521,8 @@ void *_tc_recdecode(const void *ptr, int size, int *sp, void *op);
 /* compare keys of two records by lexical order */
 #define TCCMPLEXICAL(TC_rv, TC_aptr, TC_asiz, TC_bptr, TC_bsiz) \
   do { \
-    (TC_rv) = 0; \
     int _TC_min = (TC_asiz) < (TC_bsiz) ? (TC_asiz) : (TC_bsiz); \
-    for(int _TC_i = 0; _TC_i < _TC_min; _TC_i++){ \
-      if(((unsigned char *)(TC_aptr))[_TC_i] != ((unsigned char *)(TC_bptr))[_TC_i]){ \
-        (TC_rv) = ((unsigned char *)(TC_aptr))[_TC_i] - ((unsigned char *)(TC_bptr))[_TC_i]; \
-        break; \
-      } \
-    } \
+    (TC_rv) = memcmp((TC_aptr), (TC_bptr), _TC_min); \
     if((TC_rv) == 0) (TC_rv) = (TC_asiz) - (TC_bsiz); \
   } while(false)
 
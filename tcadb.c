@@ -40,6 +40,7 @@ static int tcadbmapreccmplexical(const TCLISTDATUM *a, const TCLISTDATUM *b);
 static int tcadbmapreccmpdecimal(const TCLISTDATUM *a, const TCLISTDATUM *b);
 static int tcadbmapreccmpint32(const TCLISTDATUM *a, const TCLISTDATUM *b);
 static int tcadbmapreccmpint64(const TCLISTDATUM *a, const TCLISTDATUM *b);
+static int tcadbmapreccmpbeint(const TCLISTDATUM *a, const TCLISTDATUM *b);
 static int tcadbtdbqrygetout(const void *pkbuf, int pksiz, TCMAP *cols, void *op);
 
 
@@ -107,6 +108,9 @@ bool tcadbopen(TCADB *adb, const char *name){
   bool tdmode = false;
   bool tbmode = false;
   bool ttmode = false;
+  bool tsmode = false;
+  bool trmode = false;
+  bool tpmode = false;
   int32_t rcnum = -1;
   int64_t xmsiz = -1;
   int32_t dfunit = -1;
@@ -146,6 +150,9 @@ bool tcadbopen(TCADB *adb, const char *name){
       if(strchr(pv, 'd') || strchr(pv, 'D')) tdmode = true;
       if(strchr(pv, 'b') || strchr(pv, 'B')) tbmode = true;
       if(strchr(pv, 't') || strchr(pv, 'T')) ttmode = true;
+      if(strchr(pv, 's') || strchr(pv, 'S')) tsmode = true;
+      if(strchr(pv, 'r') || strchr(pv, 'R')) trmode = true;
+      if(strchr(pv, 'p') || strchr(pv, 'P')) tpmode = true;
     } else if(!tcstricmp(elem, "rcnum")){
       rcnum = tcatoix(pv);
     } else if(!tcstricmp(elem, "xmsiz")){
@@ -251,11 +258,18 @@ bool tcadbopen(TCADB *adb, const char *name){
     if(dbgfd >= 0) tcfdbsetdbgfd(fdb, dbgfd);
     tcfdbsetmutex(fdb);
     tcfdbtune(fdb, width, limsiz);
+    int opts = 0;
+    if(tsmode) opts |= FDBTSPARSE;
+    if(trmode) opts |= FDBTRING;
+    if(tpmode) opts |= FDBTPACK;
+    tcfdbsetopts(fdb, opts);
+    tcfdbsetcache(fdb, lcnum);
     int omode = owmode ? FDBOWRITER : FDBOREADER;
     if(ocmode) omode |= FDBOCREAT;
     if(otmode) omode |= FDBOTRUNC;
     if(onlmode) omode |= FDBONOLCK;
     if(onbmode) omode |= FDBOLCKNB;
+    if(*path == '*') omode = FDBOWRITER | FDBOMEMORY;
     if(!tcfdbopen(fdb, path, omode)){
       tcfdbdel(fdb);
       if(idxs) tclistdel(idxs);
@@ -2865,6 +2879,31 @@ bool tcadbforeach(TCADB *adb, TCITER iter, void *op){
 }
 
 
+/* Process each record of an abstract database object by partitions in parallel. */
+bool tcadbforeachpar(TCADB *adb, TCITER iter, void **ops, int tnum, TCREDUCE reduce, void *rop){
+  assert(adb && iter && ops);
+  switch(adb->omode){
+  case ADBOHDB:
+    return tchdbforeachpar(adb->hdb, iter, ops, tnum, reduce, rop);
+  case ADBOBDB:
+    return tcbdbforeachpar(adb->bdb, iter, ops, tnum, reduce, rop);
+  case ADBOFDB:
+    return tcfdbforeachpar(adb->fdb, iter, ops, tnum, reduce, rop);
+  case ADBOTDB:
+    return tctdbforeachpar(adb->tdb, iter, ops, tnum, reduce, rop);
+  default:
+    break;
+  }
+  bool rv = tcadbforeach(adb, iter, ops[0]);
+  if(reduce){
+    for(int i = 0; i < tnum; i++){
+      reduce(ops[i], rop);
+    }
+  }
+  return rv;
+}
+
+
 /* Map records of an abstract database object into another B+ tree database. */
 bool tcadbmapbdb(TCADB *adb, TCLIST *keys, TCBDB *bdb, ADBMAPPROC proc, void *op, int64_t csiz){
   assert(adb && bdb && proc);
@@ -2963,6 +3002,8 @@ static bool tcadbmapbdbdump(ADBMAPBDB *map){
     tclistsortex(recs, tcadbmapreccmpint32);
   } else if(cmp == tccmpint64){
     tclistsortex(recs, tcadbmapreccmpint64);
+  } else if(cmp == tccmpbeint){
+    tclistsortex(recs, tcadbmapreccmpbeint);
   }
   bool err = false;
   for(int i = 0; i < rnum; i++){
@@ -3038,6 +3079,18 @@ static int tcadbmapreccmpint64(const TCLISTDATUM *a, const TCLISTDATUM *b){
 }
 
 
+/* Compare two list elements as unsigned integers in the big-endian byte order for mapping.
+   `a' specifies the pointer to one element.
+   `b' specifies the pointer to the other element.
+   The return value is positive if the former is big, negative if the latter is big, 0 if both
+   are equivalent. */
+static int tcadbmapreccmpbeint(const TCLISTDATUM *a, const TCLISTDATUM *b){
+  assert(a && b);
+  return tccmpbeint(((TCLISTDATUM *)a)->ptr + sizeof(int), a->size - sizeof(int),
+                    ((TCLISTDATUM *)b)->ptr + sizeof(int), b->size - sizeof(int), NULL);
+}
+
+
 /* Retrieve and remove each record corresponding to a query object.
    `pkbuf' specifies the pointer to the region of the primary key.
    `pksiz' specifies the size of the region of the primary key.
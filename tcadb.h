@@ -88,22 +88,25 @@ void tcadbdel(TCADB *adb);
    hash database.  If it is "+", the database will be an on-memory tree database.  If its suffix
    is ".tch", the database will be a hash database.  If its suffix is ".tcb", the database will
    be a B+ tree database.  If its suffix is ".tcf", the database will be a fixed-length database.
-   If its suffix is ".tct", the database will be a table database.  Otherwise, this function
-   fails.  Tuning parameters can trail the name, separated by "#".  Each parameter is composed of
+   If it begins with "*" and its suffix is ".tcf", the database will be an on-memory fixed-length
+   database.  If its suffix is ".tct", the database will be a table database.  Otherwise, this
+   function fails.  Tuning parameters can trail the name, separated by "#".  Each parameter is composed of
    the name and the value, separated by "=".  On-memory hash database supports "bnum", "capnum",
    and "capsiz".  On-memory tree database supports "capnum" and "capsiz".  Hash database supports
    "mode", "bnum", "apow", "fpow", "opts", "rcnum", "xmsiz", and "dfunit".  B+ tree database
    supports "mode", "lmemb", "nmemb", "bnum", "apow", "fpow", "opts", "lcnum", "ncnum", "xmsiz",
-   and "dfunit".  Fixed-length database supports "mode", "width", and "limsiz".  Table database
-   supports "mode", "bnum", "apow", "fpow", "opts", "rcnum", "lcnum", "ncnum", "xmsiz", "dfunit",
-   and "idx".
+   and "dfunit".  Fixed-length database supports "mode", "width", "limsiz", "opts", and
+   "lcnum".  Table database supports "mode", "bnum", "apow", "fpow", "opts", "rcnum", "lcnum",
+   "ncnum", "xmsiz", "dfunit", and "idx".
    If successful, the return value is true, else, it is false.
    The tuning parameter "capnum" specifies the capacity number of records.  "capsiz" specifies
    the capacity size of using memory.  Records spilled the capacity are removed by the storing
    order.  "mode" can contain "w" of writer, "r" of reader, "c" of creating, "t" of truncating,
    "e" of no locking, and "f" of non-blocking lock.  The default mode is relevant to "wc".
    "opts" can contains "l" of large option, "d" of Deflate option, "b" of BZIP2 option, and "t"
-   of TCBS option.  "idx" specifies the column name of an index and its type separated by ":".
+   of TCBS option.  For fixed-length database, "opts" can contain "s" of sparse option, "r" of
+   ring option, and "p" of pack option, and "lcnum" specifies the maximum number of cached
+   pages.  "idx" specifies the column name of an index and its type separated by ":".
    For example, "casket.tch#bnum=1000000#opts=ld" means that the name of the database file is
    "casket.tch", and the bucket number is 1000000, and the options are large and Deflate. */
 bool tcadbopen(TCADB *adb, const char *name);
@@ -514,6 +517,25 @@ bool tcadbputproc(TCADB *adb, const void *kbuf, int ksiz, const void *vbuf, int
 bool tcadbforeach(TCADB *adb, TCITER iter, void *op);
 
 
+/* Process each record of an abstract database object by partitions in parallel.
+   `adb' specifies the abstract database object.
+   `iter' specifies the pointer to the iterator function called for each record.
+   `ops' specifies the array of arbitrary pointers.  Each worker gives its own element as a
+   parameter of the iterator function.
+   `tnum' specifies the number of workers.  The array `ops' should have as many elements.
+   `reduce' specifies the pointer to the reduce function called for each worker after all
+   workers finish.  It receives the element of `ops' of the worker and `rop'.  If it is `NULL',
+   no reduce function is called.
+   `rop' specifies an arbitrary pointer to be given as a parameter of the reduce function.  If
+   it is not needed, `NULL' can be specified.
+   If successful, the return value is true, else, it is false.
+   The records are divided into ranges of offsets of the file for the hash database and the
+   table database, ranges of leaves for the B+ tree database, and ranges of ID numbers for the
+   fixed-length database.  For the other types, all records are processed by the calling thread
+   with the first element of `ops'. */
+bool tcadbforeachpar(TCADB *adb, TCITER iter, void **ops, int tnum, TCREDUCE reduce, void *rop);
+
+
 /* Map records of an abstract database object into another B+ tree database.
    `adb' specifies the abstract database object.
    `keys' specifies a list object of the keys of the target records.  If it is `NULL', every
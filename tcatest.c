@@ -38,6 +38,8 @@ static int myrand(int range);
 static void setskel(ADBSKEL *skel);
 static void *pdprocfunccmp(const void *vbuf, int vsiz, int *sp, void *op);
 static bool iterfunc(const void *kbuf, int ksiz, const void *vbuf, int vsiz, void *op);
+static bool itercount(const void *kbuf, int ksiz, const void *vbuf, int vsiz, void *op);
+static void reducecount(void *op, void *rop);
 static int runwrite(int argc, char **argv);
 static int runread(int argc, char **argv);
 static int runremove(int argc, char **argv);
@@ -215,6 +217,24 @@ static bool iterfunc(const void *kbuf, int ksiz, const void *vbuf, int vsiz, voi
 }
 
 
+/* iterator function to count records */
+static bool itercount(const void *kbuf, int ksiz, const void *vbuf, int vsiz, void *op){
+  int64_t *cnts = op;
+  cnts[0]++;
+  cnts[1] += ksiz + vsiz;
+  return true;
+}
+
+
+/* reduce function to sum up counts */
+static void reducecount(void *op, void *rop){
+  int64_t *cnts = op;
+  int64_t *sums = rop;
+  sums[0] += cnts[0];
+  sums[1] += cnts[1];
+}
+
+
 /* parse arguments of write command */
 static int runwrite(int argc, char **argv){
   char *name = NULL;
@@ -761,6 +781,29 @@ static int procmisc(const char *name, int rnum){
     eprint(adb, __LINE__, "(validation)");
     err = true;
   }
+  iprintf("checking parallel iteration:\n");
+  int64_t sums[2] = { 0, 0 };
+  if(!tcadbforeach(adb, itercount, sums)){
+    eprint(adb, __LINE__, "tcadbforeach");
+    err = true;
+  }
+  int tnum = myrand(4) + 2;
+  int64_t cnts[tnum][2];
+  void *pops[tnum];
+  for(int i = 0; i < tnum; i++){
+    cnts[i][0] = 0;
+    cnts[i][1] = 0;
+    pops[i] = cnts[i];
+  }
+  int64_t psums[2] = { 0, 0 };
+  if(!tcadbforeachpar(adb, itercount, pops, tnum, reducecount, psums)){
+    eprint(adb, __LINE__, "tcadbforeachpar");
+    err = true;
+  }
+  if(psums[0] != sums[0] || psums[1] != sums[1] || psums[0] != tcadbrnum(adb)){
+    eprint(adb, __LINE__, "(validation)");
+    err = true;
+  }
   iprintf("checking versatile functions:\n");
   TCLIST *args = tclistnew();
   for(int i = 1; i <= rnum; i++){
@@ -37,11 +37,33 @@
 #define BDBDEFNCNUM    512               // default number of node cache
 #define BDBDEFLSMAX    16384             // default maximum size of each leaf
 #define BDBMINLSMAX    512               // minimum maximum size of each leaf
+#define BDBOVFLNUM     64                // number of duplicated values to overflow to pages
+#define BDBOVPGSIZ     8192              // maximum size of each overflow page
+#define BDBPARTMUL     4                 // number of partitions per worker of optimization
+#define BDBCOPYUNIT    (1LL<<24)         // size of each chunk of parallel copying
+#define BDBCOPYBUFSIZ  (1LL<<20)         // size of a buffer of parallel copying
+#define BDBFILEMODE    00644             // permission of a created file
+
+typedef struct {                         // type of structure for a reference to an overflow page
+  uint64_t id;                           // ID number of the page
+  int num;                               // number of values in the page
+  int size;                              // total size of values in the page
+  int base;                              // number of values in the preceding pages
+} BDBOVPG;
+
+typedef struct {                         // type of structure for overflowed values
+  BDBOVPG *pages;                        // array of references to pages
+  int pnum;                              // number of pages
+  int anum;                              // number of allocated elements
+  int vnum;                              // total number of values
+} BDBOVFL;
 
 typedef struct {                         // type of structure for a record
   int ksiz;                              // size of the key region
   int vsiz;                              // size of the value region
   TCLIST *rest;                          // list of value objects
+  BDBOVFL *ovfl;                         // values overflowed to pages
+  uint64_t pfx;                          // normalized prefix of the key
 } BDBREC;
 
 typedef struct {                         // type of structure for a leaf page
@@ -56,13 +78,18 @@ typedef struct {                         // type of structure for a leaf page
 
 typedef struct {                         // type of structure for a page index
   uint64_t pid;                          // ID number of the referring page
+  uint64_t rnum;                         // number of records under the referring page
+  uint64_t pfx;                          // normalized prefix of the key
   int ksiz;                              // size of the key region
 } BDBIDX;
 
 typedef struct {                         // type of structure for a node page
   uint64_t id;                           // ID number of the node
   uint64_t heir;                         // ID of the child before the first index
+  uint64_t hrnum;                        // number of records under the heir
   TCPTRLIST *idxs;                       // list of indices
+  TCTREE *msgs;                          // buffered messages
+  int msiz;                              // total size of the buffered messages
   bool dirty;                            // whether to be written back
   bool dead;                             // whether to be removed
 } BDBNODE;
@@ -78,11 +105,67 @@ enum {                                   // enumeration for duplication behavior
   BDBPDPROC                              // process by a callback function
 };
 
+enum {                                   // enumeration for operations of messages
+  BDBMSGPUT,                             // overwrite the value
+  BDBMSGCAT,                             // concatenate a value
+  BDBMSGOUT                              // remove the value
+};
+
+enum {                                   // enumeration for cursor movements settling messages
+  BDBBCFIRST,                            // move to the first record
+  BDBBCLAST,                             // move to the last record
+  BDBBCJUMP,                             // jump to the front of records of a key
+  BDBBCJUMPB,                            // jump to the rear of records of a key
+  BDBBCPREV,                             // move to the previous record
+  BDBBCNEXT,                             // move to the next record
+  BDBBCREAD                              // read the current record
+};
+
 typedef struct {                         // type of structure for a duplication callback
   TCPDPROC proc;                         // function pointer
   void *op;                              // opaque pointer
 } BDBPDPROCOP;
 
+typedef struct {                         // type of structure for a partition of optimization
+  uint64_t start;                        // ID number of the first leaf of the source
+  uint64_t stop;                         // ID number of the first leaf of the next partition
+  BDBLEAF *leaf;                         // leaf being filled
+  BDBNODE *nodes[BDBLEVELMAX];           // nodes being filled on each level
+  int lvnum;                             // number of levels of the nodes
+  uint64_t first;                        // ID number of the first leaf of the destination
+  uint64_t last;                         // ID number of the last leaf of the destination
+  uint64_t root;                         // ID number of the root page of the destination
+  char *kbuf;                            // pointer to the region of the first key
+  int ksiz;                              // size of the region of the first key
+  uint64_t rnum;                         // number of records
+} BDBOPTPART;
+
+typedef struct {                         // type of structure for parallel maintenance
+  TCBDB *bdb;                            // source database object
+  TCBDB *tbdb;                           // destination database object
+  pthread_mutex_t mtx;                   // mutex for the shared members
+  BDBOPTPART *parts;                     // array of partitions of optimization
+  int pnum;                              // number of partitions of optimization
+  int ifd;                               // file descriptor of the source of copying
+  int ofd;                               // file descriptor of the destination of copying
+  int64_t cur;                           // cursor of the next unit of work
+  int64_t done;                          // amount of processed data
+  int64_t total;                         // total amount of data
+  double stime;                          // start time
+  int ecode;                             // last happened error code
+} BDBPARCTX;
+
+typedef struct {                         // type of structure for a worker of parallel iteration
+  TCBDB *bdb;                            // database object
+  uint64_t start;                        // ID number of the first leaf of the partition
+  uint64_t next;                         // ID number of the first leaf of the next partition
+  TCITER iter;                           // iterator function
+  void *op;                              // opaque pointer of the worker
+  pthread_mutex_t *rmtx;                 // mutex to serialize reading or `NULL'
+  volatile bool *stop;                   // flag to stop all workers
+  int ecode;                             // error code of the worker
+} BDBFEARG;
+
 
 /* private macros */
 #define BDBLOCKMETHOD(TC_bdb, TC_wr) \
@@ -95,16 +178,28 @@ typedef struct {                         // type of structure for a duplication
   ((TC_bdb)->mmtx ? tcbdbunlockcache(TC_bdb) : true)
 #define BDBTHREADYIELD(TC_bdb) \
   do { if((TC_bdb)->mmtx) sched_yield(); } while(false)
+#define BDBCMPKEY(TC_rv, TC_bdb, TC_apfx, TC_aptr, TC_asiz, TC_bpfx, TC_bptr, TC_bsiz) \
+  do { \
+    if((TC_apfx) != (TC_bpfx)){ \
+      (TC_rv) = (TC_apfx) < (TC_bpfx) ? -1 : 1; \
+    } else if((TC_bdb)->cmp == tccmplexical){ \
+      TCCMPLEXICAL((TC_rv), (TC_aptr), (TC_asiz), (TC_bptr), (TC_bsiz)); \
+    } else { \
+      (TC_rv) = (TC_bdb)->cmp((TC_aptr), (TC_asiz), (TC_bptr), (TC_bsiz), (TC_bdb)->cmpop); \
+    } \
+  } while(false)
 
 
 /* private function prototypes */
 static void tcbdbclear(TCBDB *bdb);
 static void tcbdbdumpmeta(TCBDB *bdb);
 static void tcbdbloadmeta(TCBDB *bdb);
+static uint64_t tcbdbkeypfx(TCBDB *bdb, const char *kbuf, int ksiz);
 static BDBLEAF *tcbdbleafnew(TCBDB *bdb, uint64_t prev, uint64_t next);
 static bool tcbdbleafcacheout(TCBDB *bdb, BDBLEAF *leaf);
 static bool tcbdbleafsave(TCBDB *bdb, BDBLEAF *leaf);
 static BDBLEAF *tcbdbleafload(TCBDB *bdb, uint64_t id);
+static bool tcbdbleafread(TCBDB *bdb, uint64_t id, BDBLEAF *leaf);
 static bool tcbdbleafcheck(TCBDB *bdb, uint64_t id);
 static BDBLEAF *tcbdbgethistleaf(TCBDB *bdb, const char *kbuf, int ksiz, uint64_t id);
 static bool tcbdbleafaddrec(TCBDB *bdb, BDBLEAF *leaf, int dmode,
@@ -115,12 +210,32 @@ static BDBNODE *tcbdbnodenew(TCBDB *bdb, uint64_t heir);
 static bool tcbdbnodecacheout(TCBDB *bdb, BDBNODE *node);
 static bool tcbdbnodesave(TCBDB *bdb, BDBNODE *node);
 static BDBNODE *tcbdbnodeload(TCBDB *bdb, uint64_t id);
-static void tcbdbnodeaddidx(TCBDB *bdb, BDBNODE *node, bool order, uint64_t pid,
+static void tcbdbnodeaddidx(TCBDB *bdb, BDBNODE *node, bool order, uint64_t pid, uint64_t rnum,
                             const char *kbuf, int ksiz);
 static bool tcbdbnodesubidx(TCBDB *bdb, BDBNODE *node, uint64_t pid);
+static uint64_t *tcbdbnoderef(BDBNODE *node, uint64_t pid);
+static uint64_t tcbdbleafrnum(BDBLEAF *leaf);
+static bool tcbdbstatadd(TCBDB *bdb, uint64_t id, const char *kbuf, int ksiz, int64_t num);
 static uint64_t tcbdbsearchleaf(TCBDB *bdb, const char *kbuf, int ksiz);
 static BDBREC *tcbdbsearchrec(TCBDB *bdb, BDBLEAF *leaf, const char *kbuf, int ksiz, int *ip);
-static void tcbdbremoverec(TCBDB *bdb, BDBLEAF *leaf, BDBREC *rec, int ri);
+static bool tcbdbremoverec(TCBDB *bdb, BDBLEAF *leaf, BDBREC *rec, int ri);
+static int tcbdbrecvnum(BDBREC *rec);
+static const char *tcbdbrecval(TCBDB *bdb, BDBREC *rec, int vidx, int *sp);
+static bool tcbdbrecinsert(TCBDB *bdb, BDBLEAF *leaf, BDBREC *rec, int ridx,
+                           const char *vbuf, int vsiz);
+static bool tcbdbrecover(TCBDB *bdb, BDBLEAF *leaf, BDBREC *rec, int ridx,
+                         const char *vbuf, int vsiz);
+static char *tcbdbrecremove(TCBDB *bdb, BDBLEAF *leaf, BDBREC *rec, int ridx, int *sp);
+static bool tcbdbrecpurge(TCBDB *bdb, BDBREC *rec);
+static bool tcbdbovflspill(TCBDB *bdb, BDBLEAF *leaf, BDBREC *rec);
+static int tcbdbovflfind(BDBOVFL *ovfl, int ridx, int *op);
+static void tcbdbovflshift(BDBOVFL *ovfl, int pi, int num);
+static bool tcbdbovfladdpage(TCBDB *bdb, BDBOVFL *ovfl, int pi, TCLIST *vals, int size);
+static void tcbdbovfldel(BDBOVFL *ovfl);
+static TCLIST *tcbdbovpgload(TCBDB *bdb, uint64_t id);
+static bool tcbdbovpgsave(TCBDB *bdb, uint64_t id, const TCLIST *vals);
+static bool tcbdbovpgout(TCBDB *bdb, uint64_t id);
+static void tcbdbovpgpurge(TCBDB *bdb);
 static bool tcbdbcacheadjust(TCBDB *bdb);
 static void tcbdbcachepurge(TCBDB *bdb);
 static bool tcbdbopenimpl(TCBDB *bdb, const char *path, int omode);
@@ -135,8 +250,49 @@ static TCLIST *tcbdbgetlist(TCBDB *bdb, const char *kbuf, int ksiz);
 static bool tcbdbrangeimpl(TCBDB *bdb, const char *bkbuf, int bksiz, bool binc,
                            const char *ekbuf, int eksiz, bool einc, int max, TCLIST *keys);
 static bool tcbdbrangefwm(TCBDB *bdb, const char *pbuf, int psiz, int max, TCLIST *keys);
+static bool tcbdbrankimpl(TCBDB *bdb, const char *kbuf, int ksiz, bool inc, uint64_t *np);
 static bool tcbdboptimizeimpl(TCBDB *bdb, int32_t lmemb, int32_t nmemb,
                               int64_t bnum, int8_t apow, int8_t fpow, uint8_t opts);
+static bool tcbdboptimizepar(TCBDB *bdb, TCBDB *tbdb);
+static void *tcbdboptimizethread(void *targ);
+static BDBLEAF *tcbdboptleafnew(BDBPARCTX *ctx, uint64_t prev);
+static BDBNODE *tcbdboptnodenew(BDBPARCTX *ctx, uint64_t heir);
+static bool tcbdboptaddrec(BDBPARCTX *ctx, BDBOPTPART *part, BDBREC *rec);
+static bool tcbdboptovfl(BDBPARCTX *ctx, BDBOVFL *ovfl, bool rlk);
+static bool tcbdboptaddidx(BDBPARCTX *ctx, BDBOPTPART *part, int lv, uint64_t prev, uint64_t pid,
+                           const char *kbuf, int ksiz);
+static void tcbdboptaddcnt(BDBOPTPART *part, uint64_t rnum);
+static bool tcbdboptfinish(BDBPARCTX *ctx, BDBOPTPART *part, bool save);
+static bool tcbdbcopypar(TCBDB *bdb, const char *path);
+static void *tcbdbcopythread(void *targ);
+static void tcbdbparinit(BDBPARCTX *ctx, TCBDB *bdb, int64_t total);
+static bool tcbdbparstep(BDBPARCTX *ctx, int64_t inc);
+static void tcbdbparerr(BDBPARCTX *ctx, int ecode);
+static uint64_t *tcbdbleafparts(TCBDB *bdb, int pmax, int *np);
+static int tcbdbnodechild(TCBDB *bdb, BDBNODE *node, const char *kbuf, int ksiz);
+static void tcbdbbufadd(TCBDB *bdb, BDBNODE *node, const char *kbuf, int ksiz,
+                        const char *mbuf, int msiz);
+static void tcbdbbufdivide(TCBDB *bdb, BDBNODE *node, BDBNODE *newnode,
+                           const char *kbuf, int ksiz);
+static bool tcbdbbufpost(TCBDB *bdb, const char *kbuf, int ksiz, int op,
+                         const char *vbuf, int vsiz);
+static bool tcbdbbufdrain(TCBDB *bdb, uint64_t id, bool all);
+static bool tcbdbbufflush(TCBDB *bdb);
+static bool tcbdbbufsettle(TCBDB *bdb, const char *kbuf, int ksiz);
+static int tcbdbbufpeek(TCBDB *bdb, const char *kbuf, int ksiz, const char **vbp, int *vsp);
+static bool tcbdbbufapply(TCBDB *bdb, const char *kbuf, int ksiz, const char *mbuf, int msiz);
+static bool tcbdbbufprep(TCBDB *bdb, const char *kbuf, int ksiz);
+static bool tcbdbbufpending(TCBDB *bdb, const char *kbuf, int ksiz);
+static int tcbdbbufsettlerange(TCBDB *bdb, const char *bkbuf, int bksiz, bool binc,
+                               const char *ekbuf, int eksiz, bool einc, bool fwm);
+static bool tcbdbbufpreprange(TCBDB *bdb, const char *bkbuf, int bksiz, bool binc,
+                              const char *ekbuf, int eksiz, bool einc, bool fwm);
+static bool tcbdbbufprepcur(BDBCUR *cur, int mode, const char *kbuf, int ksiz);
+static bool tcbdbbufout(TCBDB *bdb, const char *kbuf, int ksiz);
+static bool tcbdbbufaddnum(TCBDB *bdb, const char *kbuf, int ksiz, char *nbuf, int nsiz,
+                           int dmode);
+static int tcbdbmsgpush(char *buf, int size, int op, const char *vbuf, int vsiz);
+static char *tcbdbmsgmerge(const char *obuf, int osiz, const char *nbuf, int nsiz, int *sp);
 static bool tcbdbvanishimpl(TCBDB *bdb);
 static bool tcbdblockmethod(TCBDB *bdb, bool wr);
 static bool tcbdbunlockmethod(TCBDB *bdb);
@@ -145,6 +301,7 @@ static bool tcbdbunlockcache(TCBDB *bdb);
 static bool tcbdbcurfirstimpl(BDBCUR *cur);
 static bool tcbdbcurlastimpl(BDBCUR *cur);
 static bool tcbdbcurjumpimpl(BDBCUR *cur, const char *kbuf, int ksiz, bool forward);
+static bool tcbdbcurjumpnthimpl(BDBCUR *cur, uint64_t nth);
 static bool tcbdbcuradjust(BDBCUR *cur, bool forward);
 static bool tcbdbcurprevimpl(BDBCUR *cur);
 static bool tcbdbcurnextimpl(BDBCUR *cur);
@@ -152,6 +309,10 @@ static bool tcbdbcurputimpl(BDBCUR *cur, const char *vbuf, int vsiz, int mode);
 static bool tcbdbcuroutimpl(BDBCUR *cur);
 static bool tcbdbcurrecimpl(BDBCUR *cur, const char **kbp, int *ksp, const char **vbp, int *vsp);
 static bool tcbdbforeachimpl(TCBDB *bdb, TCITER iter, void *op);
+static bool tcbdbforeachparimpl(TCBDB *bdb, TCITER iter, void **ops, int tnum,
+                                TCREDUCE reduce, void *rop);
+static void *tcbdbforeachthread(void *targ);
+static void tcbdbforeachpart(BDBFEARG *arg);
 
 
 /* debugging function prototypes */
@@ -343,7 +504,9 @@ bool tcbdbput(TCBDB *bdb, const void *kbuf, int ksiz, const void *vbuf, int vsiz
     BDBUNLOCKMETHOD(bdb);
     return false;
   }
-  bool rv = tcbdbputimpl(bdb, kbuf, ksiz, vbuf, vsiz, BDBPDOVER);
+  bool rv = (bdb->bsiz > 0 && bdb->root > BDBNODEIDBASE) ?
+    tcbdbbufpost(bdb, kbuf, ksiz, BDBMSGPUT, vbuf, vsiz) :
+    tcbdbputimpl(bdb, kbuf, ksiz, vbuf, vsiz, BDBPDOVER);
   BDBUNLOCKMETHOD(bdb);
   return rv;
 }
@@ -365,7 +528,8 @@ bool tcbdbputkeep(TCBDB *bdb, const void *kbuf, int ksiz, const void *vbuf, int
     BDBUNLOCKMETHOD(bdb);
     return false;
   }
-  bool rv = tcbdbputimpl(bdb, kbuf, ksiz, vbuf, vsiz, BDBPDKEEP);
+  bool rv = tcbdbbufsettle(bdb, kbuf, ksiz) &&
+    tcbdbputimpl(bdb, kbuf, ksiz, vbuf, vsiz, BDBPDKEEP);
   BDBUNLOCKMETHOD(bdb);
   return rv;
 }
@@ -387,7 +551,9 @@ bool tcbdbputcat(TCBDB *bdb, const void *kbuf, int ksiz, const void *vbuf, int v
     BDBUNLOCKMETHOD(bdb);
     return false;
   }
-  bool rv = tcbdbputimpl(bdb, kbuf, ksiz, vbuf, vsiz, BDBPDCAT);
+  bool rv = (bdb->bsiz > 0 && bdb->root > BDBNODEIDBASE) ?
+    tcbdbbufpost(bdb, kbuf, ksiz, BDBMSGCAT, vbuf, vsiz) :
+    tcbdbputimpl(bdb, kbuf, ksiz, vbuf, vsiz, BDBPDCAT);
   BDBUNLOCKMETHOD(bdb);
   return rv;
 }
@@ -409,7 +575,8 @@ bool tcbdbputdup(TCBDB *bdb, const void *kbuf, int ksiz, const void *vbuf, int v
     BDBUNLOCKMETHOD(bdb);
     return false;
   }
-  bool rv = tcbdbputimpl(bdb, kbuf, ksiz, vbuf, vsiz, BDBPDDUP);
+  bool rv = tcbdbbufsettle(bdb, kbuf, ksiz) &&
+    tcbdbputimpl(bdb, kbuf, ksiz, vbuf, vsiz, BDBPDDUP);
   BDBUNLOCKMETHOD(bdb);
   return rv;
 }
@@ -431,9 +598,9 @@ bool tcbdbputdup3(TCBDB *bdb, const void *kbuf, int ksiz, const TCLIST *vals){
     BDBUNLOCKMETHOD(bdb);
     return false;
   }
-  bool err = false;
+  bool err = !tcbdbbufsettle(bdb, kbuf, ksiz);
   int ln = TCLISTNUM(vals);
-  for(int i = 0; i < ln; i++){
+  for(int i = 0; !err && i < ln; i++){
     const char *vbuf;
     int vsiz;
     TCLISTVAL(vbuf, vals, i, vsiz);
@@ -453,7 +620,8 @@ bool tcbdbout(TCBDB *bdb, const void *kbuf, int ksiz){
     BDBUNLOCKMETHOD(bdb);
     return false;
   }
-  bool rv = tcbdboutimpl(bdb, kbuf, ksiz);
+  bool rv = (bdb->bsiz > 0 && bdb->root > BDBNODEIDBASE) ?
+    tcbdbbufout(bdb, kbuf, ksiz) : tcbdboutimpl(bdb, kbuf, ksiz);
   BDBUNLOCKMETHOD(bdb);
   return rv;
 }
@@ -475,7 +643,7 @@ bool tcbdbout3(TCBDB *bdb, const void *kbuf, int ksiz){
     BDBUNLOCKMETHOD(bdb);
     return false;
   }
-  bool rv = tcbdboutlist(bdb, kbuf, ksiz);
+  bool rv = tcbdbbufsettle(bdb, kbuf, ksiz) && tcbdboutlist(bdb, kbuf, ksiz);
   BDBUNLOCKMETHOD(bdb);
   return rv;
 }
@@ -484,6 +652,7 @@ bool tcbdbout3(TCBDB *bdb, const void *kbuf, int ksiz){
 /* Retrieve a record in a B+ tree database object. */
 void *tcbdbget(TCBDB *bdb, const void *kbuf, int ksiz, int *sp){
   assert(bdb && kbuf && ksiz >= 0 && sp);
+  if(!tcbdbbufprep(bdb, kbuf, ksiz)) return NULL;
   if(!BDBLOCKMETHOD(bdb, false)) return NULL;
   if(!bdb->open){
     tcbdbsetecode(bdb, TCEINVALID, __FILE__, __LINE__, __func__);
@@ -497,7 +666,8 @@ void *tcbdbget(TCBDB *bdb, const void *kbuf, int ksiz, int *sp){
   } else {
     rv = NULL;
   }
-  bool adj = TCMAPRNUM(bdb->leafc) > bdb->lcnum || TCMAPRNUM(bdb->nodec) > bdb->ncnum;
+  bool adj = TCMAPRNUM(bdb->leafc) > bdb->lcnum || TCMAPRNUM(bdb->nodec) > bdb->ncnum ||
+    TCMAPRNUM(bdb->pagec) > bdb->lcnum;
   BDBUNLOCKMETHOD(bdb);
   if(adj && BDBLOCKMETHOD(bdb, true)){
     if(!bdb->tran && !tcbdbcacheadjust(bdb)){
@@ -521,6 +691,7 @@ char *tcbdbget2(TCBDB *bdb, const char *kstr){
 /* Retrieve a record in a B+ tree database object and write the value into a buffer. */
 const void *tcbdbget3(TCBDB *bdb, const void *kbuf, int ksiz, int *sp){
   assert(bdb && kbuf && ksiz >= 0 && sp);
+  if(!tcbdbbufprep(bdb, kbuf, ksiz)) return NULL;
   if(!BDBLOCKMETHOD(bdb, false)) return NULL;
   if(!bdb->open){
     tcbdbsetecode(bdb, TCEINVALID, __FILE__, __LINE__, __func__);
@@ -528,7 +699,8 @@ const void *tcbdbget3(TCBDB *bdb, const void *kbuf, int ksiz, int *sp){
     return NULL;
   }
   const char *rv = tcbdbgetimpl(bdb, kbuf, ksiz, sp);
-  bool adj = TCMAPRNUM(bdb->leafc) > bdb->lcnum || TCMAPRNUM(bdb->nodec) > bdb->ncnum;
+  bool adj = TCMAPRNUM(bdb->leafc) > bdb->lcnum || TCMAPRNUM(bdb->nodec) > bdb->ncnum ||
+    TCMAPRNUM(bdb->pagec) > bdb->lcnum;
   BDBUNLOCKMETHOD(bdb);
   if(adj && BDBLOCKMETHOD(bdb, true)){
     if(!bdb->tran && !tcbdbcacheadjust(bdb)) rv = NULL;
@@ -541,6 +713,7 @@ const void *tcbdbget3(TCBDB *bdb, const void *kbuf, int ksiz, int *sp){
 /* Retrieve records in a B+ tree database object. */
 TCLIST *tcbdbget4(TCBDB *bdb, const void *kbuf, int ksiz){
   assert(bdb && kbuf && ksiz >= 0);
+  if(!tcbdbbufprep(bdb, kbuf, ksiz)) return NULL;
   if(!BDBLOCKMETHOD(bdb, false)) return NULL;
   if(!bdb->open){
     tcbdbsetecode(bdb, TCEINVALID, __FILE__, __LINE__, __func__);
@@ -548,7 +721,8 @@ TCLIST *tcbdbget4(TCBDB *bdb, const void *kbuf, int ksiz){
     return NULL;
   }
   TCLIST *rv = tcbdbgetlist(bdb, kbuf, ksiz);
-  bool adj = TCMAPRNUM(bdb->leafc) > bdb->lcnum || TCMAPRNUM(bdb->nodec) > bdb->ncnum;
+  bool adj = TCMAPRNUM(bdb->leafc) > bdb->lcnum || TCMAPRNUM(bdb->nodec) > bdb->ncnum ||
+    TCMAPRNUM(bdb->pagec) > bdb->lcnum;
   BDBUNLOCKMETHOD(bdb);
   if(adj && BDBLOCKMETHOD(bdb, true)){
     if(!bdb->tran && !tcbdbcacheadjust(bdb)){
@@ -564,6 +738,7 @@ TCLIST *tcbdbget4(TCBDB *bdb, const void *kbuf, int ksiz){
 /* Get the number of records corresponding a key in a B+ tree database object. */
 int tcbdbvnum(TCBDB *bdb, const void *kbuf, int ksiz){
   assert(bdb && kbuf && ksiz >= 0);
+  if(!tcbdbbufprep(bdb, kbuf, ksiz)) return 0;
   if(!BDBLOCKMETHOD(bdb, false)) return 0;
   if(!bdb->open){
     tcbdbsetecode(bdb, TCEINVALID, __FILE__, __LINE__, __func__);
@@ -571,7 +746,8 @@ int tcbdbvnum(TCBDB *bdb, const void *kbuf, int ksiz){
     return 0;
   }
   int rv = tcbdbgetnum(bdb, kbuf, ksiz);
-  bool adj = TCMAPRNUM(bdb->leafc) > bdb->lcnum || TCMAPRNUM(bdb->nodec) > bdb->ncnum;
+  bool adj = TCMAPRNUM(bdb->leafc) > bdb->lcnum || TCMAPRNUM(bdb->nodec) > bdb->ncnum ||
+    TCMAPRNUM(bdb->pagec) > bdb->lcnum;
   BDBUNLOCKMETHOD(bdb);
   if(adj && BDBLOCKMETHOD(bdb, true)){
     if(!bdb->tran && !tcbdbcacheadjust(bdb)) rv = 0;
@@ -609,6 +785,7 @@ TCLIST *tcbdbrange(TCBDB *bdb, const void *bkbuf, int bksiz, bool binc,
                    const void *ekbuf, int eksiz, bool einc, int max){
   assert(bdb);
   TCLIST *keys = tclistnew();
+  if(!tcbdbbufpreprange(bdb, bkbuf, bksiz, binc, ekbuf, eksiz, einc, false)) return keys;
   if(!BDBLOCKMETHOD(bdb, false)) return keys;
   if(!bdb->open){
     tcbdbsetecode(bdb, TCEINVALID, __FILE__, __LINE__, __func__);
@@ -616,7 +793,8 @@ TCLIST *tcbdbrange(TCBDB *bdb, const void *bkbuf, int bksiz, bool binc,
     return keys;
   }
   tcbdbrangeimpl(bdb, bkbuf, bksiz, binc, ekbuf, eksiz, einc, max, keys);
-  bool adj = TCMAPRNUM(bdb->leafc) > bdb->lcnum || TCMAPRNUM(bdb->nodec) > bdb->ncnum;
+  bool adj = TCMAPRNUM(bdb->leafc) > bdb->lcnum || TCMAPRNUM(bdb->nodec) > bdb->ncnum ||
+    TCMAPRNUM(bdb->pagec) > bdb->lcnum;
   BDBUNLOCKMETHOD(bdb);
   if(adj && BDBLOCKMETHOD(bdb, true)){
     tcbdbcacheadjust(bdb);
@@ -639,6 +817,7 @@ TCLIST *tcbdbrange2(TCBDB *bdb, const char *bkstr, bool binc,
 TCLIST *tcbdbfwmkeys(TCBDB *bdb, const void *pbuf, int psiz, int max){
   assert(bdb && pbuf && psiz >= 0);
   TCLIST *keys = tclistnew();
+  if(!tcbdbbufpreprange(bdb, pbuf, psiz, true, NULL, 0, false, true)) return keys;
   if(!BDBLOCKMETHOD(bdb, false)) return keys;
   if(!bdb->open){
     tcbdbsetecode(bdb, TCEINVALID, __FILE__, __LINE__, __func__);
@@ -646,7 +825,8 @@ TCLIST *tcbdbfwmkeys(TCBDB *bdb, const void *pbuf, int psiz, int max){
     return keys;
   }
   tcbdbrangefwm(bdb, pbuf, psiz, max, keys);
-  bool adj = TCMAPRNUM(bdb->leafc) > bdb->lcnum || TCMAPRNUM(bdb->nodec) > bdb->ncnum;
+  bool adj = TCMAPRNUM(bdb->leafc) > bdb->lcnum || TCMAPRNUM(bdb->nodec) > bdb->ncnum ||
+    TCMAPRNUM(bdb->pagec) > bdb->lcnum;
   BDBUNLOCKMETHOD(bdb);
   if(adj && BDBLOCKMETHOD(bdb, true)){
     tcbdbcacheadjust(bdb);
@@ -672,7 +852,9 @@ int tcbdbaddint(TCBDB *bdb, const void *kbuf, int ksiz, int num){
     BDBUNLOCKMETHOD(bdb);
     return INT_MIN;
   }
-  bool rv = tcbdbputimpl(bdb, kbuf, ksiz, (char *)&num, sizeof(num), BDBPDADDINT);
+  bool rv = (bdb->bsiz > 0 && bdb->root > BDBNODEIDBASE) ?
+    tcbdbbufaddnum(bdb, kbuf, ksiz, (char *)&num, sizeof(num), BDBPDADDINT) :
+    tcbdbputimpl(bdb, kbuf, ksiz, (char *)&num, sizeof(num), BDBPDADDINT);
   BDBUNLOCKMETHOD(bdb);
   return rv ? num : INT_MIN;
 }
@@ -687,7 +869,9 @@ double tcbdbadddouble(TCBDB *bdb, const void *kbuf, int ksiz, double num){
     BDBUNLOCKMETHOD(bdb);
     return nan("");
   }
-  bool rv = tcbdbputimpl(bdb, kbuf, ksiz, (char *)&num, sizeof(num), BDBPDADDDBL);
+  bool rv = (bdb->bsiz > 0 && bdb->root > BDBNODEIDBASE) ?
+    tcbdbbufaddnum(bdb, kbuf, ksiz, (char *)&num, sizeof(num), BDBPDADDDBL) :
+    tcbdbputimpl(bdb, kbuf, ksiz, (char *)&num, sizeof(num), BDBPDADDDBL);
   BDBUNLOCKMETHOD(bdb);
   return rv ? num : nan("");
 }
@@ -805,7 +989,11 @@ bool tcbdbcopy(TCBDB *bdb, const char *path){
   if(!tcbdbtranbegin(bdb)) err = true;
   if(BDBLOCKMETHOD(bdb, false)){
     BDBTHREADYIELD(bdb);
-    if(!tchdbcopy(bdb->hdb, path)) err = true;
+    if(bdb->ptnum > 1 && *path != '@'){
+      if(!tcbdbcopypar(bdb, path)) err = true;
+    } else if(!tchdbcopy(bdb->hdb, path)){
+      err = true;
+    }
     BDBUNLOCKMETHOD(bdb);
   } else {
     err = true;
@@ -880,6 +1068,7 @@ bool tcbdbtranabort(TCBDB *bdb){
     return false;
   }
   tcbdbcachepurge(bdb);
+  tcmapclear(bdb->bnodes);
   memcpy(bdb->opaque, bdb->rbopaque, BDBOPAQUESIZ);
   tcbdbloadmeta(bdb);
   TCFREE(bdb->rbopaque);
@@ -889,8 +1078,8 @@ bool tcbdbtranabort(TCBDB *bdb){
   bdb->lleaf = 0;
   bdb->clock++;
   bool err = false;
+  if(!(bdb->ovpage ? tchdbtranabort(bdb->hdb) : tchdbtranvoid(bdb->hdb))) err = true;
   if(!tcbdbcacheadjust(bdb)) err = true;
-  if(!tchdbtranvoid(bdb->hdb)) err = true;
   BDBUNLOCKMETHOD(bdb);
   return !err;
 }
@@ -914,6 +1103,7 @@ const char *tcbdbpath(TCBDB *bdb){
 /* Get the number of records of a B+ tree database object. */
 uint64_t tcbdbrnum(TCBDB *bdb){
   assert(bdb);
+  if(!tcbdbbufprep(bdb, NULL, 0)) return 0;
   if(!BDBLOCKMETHOD(bdb, false)) return 0;
   if(!bdb->open){
     tcbdbsetecode(bdb, TCEINVALID, __FILE__, __LINE__, __func__);
@@ -966,6 +1156,7 @@ void tcbdbcurdel(BDBCUR *cur){
 bool tcbdbcurfirst(BDBCUR *cur){
   assert(cur);
   TCBDB *bdb = cur->bdb;
+  if(!tcbdbbufprepcur(cur, BDBBCFIRST, NULL, 0)) return false;
   if(!BDBLOCKMETHOD(bdb, false)) return false;
   if(!bdb->open){
     tcbdbsetecode(bdb, TCEINVALID, __FILE__, __LINE__, __func__);
@@ -973,7 +1164,8 @@ bool tcbdbcurfirst(BDBCUR *cur){
     return false;
   }
   bool rv = tcbdbcurfirstimpl(cur);
-  bool adj = TCMAPRNUM(bdb->leafc) > bdb->lcnum || TCMAPRNUM(bdb->nodec) > bdb->ncnum;
+  bool adj = TCMAPRNUM(bdb->leafc) > bdb->lcnum || TCMAPRNUM(bdb->nodec) > bdb->ncnum ||
+    TCMAPRNUM(bdb->pagec) > bdb->lcnum;
   BDBUNLOCKMETHOD(bdb);
   if(adj && BDBLOCKMETHOD(bdb, true)){
     if(!bdb->tran && !tcbdbcacheadjust(bdb)) rv = false;
@@ -987,6 +1179,7 @@ bool tcbdbcurfirst(BDBCUR *cur){
 bool tcbdbcurlast(BDBCUR *cur){
   assert(cur);
   TCBDB *bdb = cur->bdb;
+  if(!tcbdbbufprepcur(cur, BDBBCLAST, NULL, 0)) return false;
   if(!BDBLOCKMETHOD(bdb, false)) return false;
   if(!bdb->open){
     tcbdbsetecode(bdb, TCEINVALID, __FILE__, __LINE__, __func__);
@@ -994,7 +1187,8 @@ bool tcbdbcurlast(BDBCUR *cur){
     return false;
   }
   bool rv = tcbdbcurlastimpl(cur);
-  bool adj = TCMAPRNUM(bdb->leafc) > bdb->lcnum || TCMAPRNUM(bdb->nodec) > bdb->ncnum;
+  bool adj = TCMAPRNUM(bdb->leafc) > bdb->lcnum || TCMAPRNUM(bdb->nodec) > bdb->ncnum ||
+    TCMAPRNUM(bdb->pagec) > bdb->lcnum;
   BDBUNLOCKMETHOD(bdb);
   if(adj && BDBLOCKMETHOD(bdb, true)){
     if(!bdb->tran && !tcbdbcacheadjust(bdb)) rv = false;
@@ -1008,6 +1202,7 @@ bool tcbdbcurlast(BDBCUR *cur){
 bool tcbdbcurjump(BDBCUR *cur, const void *kbuf, int ksiz){
   assert(cur && kbuf && ksiz >= 0);
   TCBDB *bdb = cur->bdb;
+  if(!tcbdbbufprepcur(cur, BDBBCJUMP, kbuf, ksiz)) return false;
   if(!BDBLOCKMETHOD(bdb, false)) return false;
   if(!bdb->open){
     tcbdbsetecode(bdb, TCEINVALID, __FILE__, __LINE__, __func__);
@@ -1015,7 +1210,8 @@ bool tcbdbcurjump(BDBCUR *cur, const void *kbuf, int ksiz){
     return false;
   }
   bool rv = tcbdbcurjumpimpl(cur, kbuf, ksiz, true);
-  bool adj = TCMAPRNUM(bdb->leafc) > bdb->lcnum || TCMAPRNUM(bdb->nodec) > bdb->ncnum;
+  bool adj = TCMAPRNUM(bdb->leafc) > bdb->lcnum || TCMAPRNUM(bdb->nodec) > bdb->ncnum ||
+    TCMAPRNUM(bdb->pagec) > bdb->lcnum;
   BDBUNLOCKMETHOD(bdb);
   if(adj && BDBLOCKMETHOD(bdb, true)){
     if(!bdb->tran && !tcbdbcacheadjust(bdb)) rv = false;
@@ -1036,6 +1232,7 @@ bool tcbdbcurjump2(BDBCUR *cur, const char *kstr){
 bool tcbdbcurprev(BDBCUR *cur){
   assert(cur);
   TCBDB *bdb = cur->bdb;
+  if(!tcbdbbufprepcur(cur, BDBBCPREV, NULL, 0)) return false;
   if(!BDBLOCKMETHOD(bdb, false)) return false;
   if(!bdb->open){
     tcbdbsetecode(bdb, TCEINVALID, __FILE__, __LINE__, __func__);
@@ -1048,7 +1245,8 @@ bool tcbdbcurprev(BDBCUR *cur){
     return false;
   }
   bool rv = tcbdbcurprevimpl(cur);
-  bool adj = TCMAPRNUM(bdb->leafc) > bdb->lcnum || TCMAPRNUM(bdb->nodec) > bdb->ncnum;
+  bool adj = TCMAPRNUM(bdb->leafc) > bdb->lcnum || TCMAPRNUM(bdb->nodec) > bdb->ncnum ||
+    TCMAPRNUM(bdb->pagec) > bdb->lcnum;
   BDBUNLOCKMETHOD(bdb);
   if(adj && BDBLOCKMETHOD(bdb, true)){
     if(!bdb->tran && !tcbdbcacheadjust(bdb)) rv = false;
@@ -1062,6 +1260,7 @@ bool tcbdbcurprev(BDBCUR *cur){
 bool tcbdbcurnext(BDBCUR *cur){
   assert(cur);
   TCBDB *bdb = cur->bdb;
+  if(!tcbdbbufprepcur(cur, BDBBCNEXT, NULL, 0)) return false;
   if(!BDBLOCKMETHOD(bdb, false)) return false;
   if(!bdb->open){
     tcbdbsetecode(bdb, TCEINVALID, __FILE__, __LINE__, __func__);
@@ -1074,7 +1273,8 @@ bool tcbdbcurnext(BDBCUR *cur){
     return false;
   }
   bool rv = tcbdbcurnextimpl(cur);
-  bool adj = TCMAPRNUM(bdb->leafc) > bdb->lcnum || TCMAPRNUM(bdb->nodec) > bdb->ncnum;
+  bool adj = TCMAPRNUM(bdb->leafc) > bdb->lcnum || TCMAPRNUM(bdb->nodec) > bdb->ncnum ||
+    TCMAPRNUM(bdb->pagec) > bdb->lcnum;
   BDBUNLOCKMETHOD(bdb);
   if(adj && BDBLOCKMETHOD(bdb, true)){
     if(!bdb->tran && !tcbdbcacheadjust(bdb)) rv = false;
@@ -1099,7 +1299,7 @@ bool tcbdbcurput(BDBCUR *cur, const void *vbuf, int vsiz, int cpmode){
     BDBUNLOCKMETHOD(bdb);
     return false;
   }
-  bool rv = tcbdbcurputimpl(cur, vbuf, vsiz, cpmode);
+  bool rv = tcbdbbufflush(bdb) && tcbdbcurputimpl(cur, vbuf, vsiz, cpmode);
   BDBUNLOCKMETHOD(bdb);
   return rv;
 }
@@ -1127,7 +1327,7 @@ bool tcbdbcurout(BDBCUR *cur){
     BDBUNLOCKMETHOD(bdb);
     return false;
   }
-  bool rv = tcbdbcuroutimpl(cur);
+  bool rv = tcbdbbufflush(bdb) && tcbdbcuroutimpl(cur);
   BDBUNLOCKMETHOD(bdb);
   return rv;
 }
@@ -1137,6 +1337,7 @@ bool tcbdbcurout(BDBCUR *cur){
 void *tcbdbcurkey(BDBCUR *cur, int *sp){
   assert(cur && sp);
   TCBDB *bdb = cur->bdb;
+  if(!tcbdbbufprepcur(cur, BDBBCREAD, NULL, 0)) return false;
   if(!BDBLOCKMETHOD(bdb, false)) return false;
   if(!bdb->open){
     tcbdbsetecode(bdb, TCEINVALID, __FILE__, __LINE__, __func__);
@@ -1174,6 +1375,7 @@ char *tcbdbcurkey2(BDBCUR *cur){
 const void *tcbdbcurkey3(BDBCUR *cur, int *sp){
   assert(cur && sp);
   TCBDB *bdb = cur->bdb;
+  if(!tcbdbbufprepcur(cur, BDBBCREAD, NULL, 0)) return false;
   if(!BDBLOCKMETHOD(bdb, false)) return false;
   if(!bdb->open){
     tcbdbsetecode(bdb, TCEINVALID, __FILE__, __LINE__, __func__);
@@ -1203,6 +1405,7 @@ const void *tcbdbcurkey3(BDBCUR *cur, int *sp){
 void *tcbdbcurval(BDBCUR *cur, int *sp){
   assert(cur && sp);
   TCBDB *bdb = cur->bdb;
+  if(!tcbdbbufprepcur(cur, BDBBCREAD, NULL, 0)) return false;
   if(!BDBLOCKMETHOD(bdb, false)) return false;
   if(!bdb->open){
     tcbdbsetecode(bdb, TCEINVALID, __FILE__, __LINE__, __func__);
@@ -1240,6 +1443,7 @@ char *tcbdbcurval2(BDBCUR *cur){
 const void *tcbdbcurval3(BDBCUR *cur, int *sp){
   assert(cur && sp);
   TCBDB *bdb = cur->bdb;
+  if(!tcbdbbufprepcur(cur, BDBBCREAD, NULL, 0)) return false;
   if(!BDBLOCKMETHOD(bdb, false)) return false;
   if(!bdb->open){
     tcbdbsetecode(bdb, TCEINVALID, __FILE__, __LINE__, __func__);
@@ -1269,6 +1473,7 @@ const void *tcbdbcurval3(BDBCUR *cur, int *sp){
 bool tcbdbcurrec(BDBCUR *cur, TCXSTR *kxstr, TCXSTR *vxstr){
   assert(cur && kxstr && vxstr);
   TCBDB *bdb = cur->bdb;
+  if(!tcbdbbufprepcur(cur, BDBBCREAD, NULL, 0)) return false;
   if(!BDBLOCKMETHOD(bdb, false)) return false;
   if(!bdb->open){
     tcbdbsetecode(bdb, TCEINVALID, __FILE__, __LINE__, __func__);
@@ -1339,6 +1544,7 @@ bool tcbdbmemsync(TCBDB *bdb, bool phys){
     return false;
   }
   bool err = false;
+  if(!tcbdbbufflush(bdb)) err = true;
   bool clk = BDBLOCKCACHE(bdb);
   const char *vbuf;
   int vsiz;
@@ -1616,7 +1822,8 @@ bool tcbdbputdupback(TCBDB *bdb, const void *kbuf, int ksiz, const void *vbuf, i
     BDBUNLOCKMETHOD(bdb);
     return false;
   }
-  bool rv = tcbdbputimpl(bdb, kbuf, ksiz, vbuf, vsiz, BDBPDDUPB);
+  bool rv = tcbdbbufsettle(bdb, kbuf, ksiz) &&
+    tcbdbputimpl(bdb, kbuf, ksiz, vbuf, vsiz, BDBPDDUPB);
   BDBUNLOCKMETHOD(bdb);
   return rv;
 }
@@ -1648,7 +1855,8 @@ bool tcbdbputproc(TCBDB *bdb, const void *kbuf, int ksiz, const void *vbuf, int
   wp += sizeof(procptr);
   memcpy(wp, kbuf, ksiz);
   kbuf = rbuf + sizeof(procptr);
-  bool rv = tcbdbputimpl(bdb, kbuf, ksiz, vbuf, vsiz, BDBPDPROC);
+  bool rv = tcbdbbufsettle(bdb, kbuf, ksiz) &&
+    tcbdbputimpl(bdb, kbuf, ksiz, vbuf, vsiz, BDBPDPROC);
   if(rbuf != stack) TCFREE(rbuf);
   BDBUNLOCKMETHOD(bdb);
   return rv;
@@ -1666,6 +1874,7 @@ bool tcbdbputdupback2(TCBDB *bdb, const char *kstr, const char *vstr){
 bool tcbdbcurjumpback(BDBCUR *cur, const void *kbuf, int ksiz){
   assert(cur && kbuf && ksiz >= 0);
   TCBDB *bdb = cur->bdb;
+  if(!tcbdbbufprepcur(cur, BDBBCJUMPB, kbuf, ksiz)) return false;
   if(!BDBLOCKMETHOD(bdb, false)) return false;
   if(!bdb->open){
     tcbdbsetecode(bdb, TCEINVALID, __FILE__, __LINE__, __func__);
@@ -1684,6 +1893,80 @@ bool tcbdbcurjumpback2(BDBCUR *cur, const char *kstr){
   return tcbdbcurjumpback(cur, kstr, strlen(kstr));
 }
 
+/* Get the number of records in a range of a B+ tree database object. */
+int64_t tcbdbrangecount(TCBDB *bdb, const void *bkbuf, int bksiz, bool binc,
+                        const void *ekbuf, int eksiz, bool einc){
+  assert(bdb);
+  if(!tcbdbbufpreprange(bdb, bkbuf, bksiz, binc, ekbuf, eksiz, einc, false)) return -1;
+  if(!BDBLOCKMETHOD(bdb, false)) return -1;
+  if(!bdb->open){
+    tcbdbsetecode(bdb, TCEINVALID, __FILE__, __LINE__, __func__);
+    BDBUNLOCKMETHOD(bdb);
+    return -1;
+  }
+  uint64_t brank = 0;
+  uint64_t erank = bdb->rnum;
+  bool err = false;
+  if(bkbuf && !tcbdbrankimpl(bdb, bkbuf, bksiz, !binc, &brank)) err = true;
+  if(!err && ekbuf && !tcbdbrankimpl(bdb, ekbuf, eksiz, einc, &erank)) err = true;
+  bool adj = TCMAPRNUM(bdb->leafc) > bdb->lcnum || TCMAPRNUM(bdb->nodec) > bdb->ncnum ||
+    TCMAPRNUM(bdb->pagec) > bdb->lcnum;
+  BDBUNLOCKMETHOD(bdb);
+  if(adj && BDBLOCKMETHOD(bdb, true)){
+    if(!bdb->tran && !tcbdbcacheadjust(bdb)) err = true;
+    BDBUNLOCKMETHOD(bdb);
+  }
+  if(err) return -1;
+  return erank > brank ? erank - brank : 0;
+}
+
+
+/* Get the number of records in a string range of a B+ tree database object. */
+int64_t tcbdbrangecount2(TCBDB *bdb, const char *bkstr, bool binc,
+                         const char *ekstr, bool einc){
+  assert(bdb);
+  return tcbdbrangecount(bdb, bkstr, bkstr ? strlen(bkstr) : 0, binc,
+                         ekstr, ekstr ? strlen(ekstr) : 0, einc);
+}
+
+
+/* Get the rank of a key in a B+ tree database object. */
+int64_t tcbdbrank(TCBDB *bdb, const void *kbuf, int ksiz){
+  assert(bdb && kbuf && ksiz >= 0);
+  return tcbdbrangecount(bdb, NULL, 0, true, kbuf, ksiz, false);
+}
+
+
+/* Get the rank of a string key in a B+ tree database object. */
+int64_t tcbdbrank2(TCBDB *bdb, const char *kstr){
+  assert(bdb && kstr);
+  return tcbdbrank(bdb, kstr, strlen(kstr));
+}
+
+
+/* Move a cursor object to the record at a position. */
+bool tcbdbcurjumpnth(BDBCUR *cur, uint64_t nth){
+  assert(cur);
+  TCBDB *bdb = cur->bdb;
+  if(!tcbdbbufprep(bdb, NULL, 0)) return false;
+  if(!BDBLOCKMETHOD(bdb, false)) return false;
+  if(!bdb->open){
+    tcbdbsetecode(bdb, TCEINVALID, __FILE__, __LINE__, __func__);
+    BDBUNLOCKMETHOD(bdb);
+    return false;
+  }
+  bool rv = tcbdbcurjumpnthimpl(cur, nth);
+  bool adj = TCMAPRNUM(bdb->leafc) > bdb->lcnum || TCMAPRNUM(bdb->nodec) > bdb->ncnum ||
+    TCMAPRNUM(bdb->pagec) > bdb->lcnum;
+  BDBUNLOCKMETHOD(bdb);
+  if(adj && BDBLOCKMETHOD(bdb, true)){
+    if(!bdb->tran && !tcbdbcacheadjust(bdb)) rv = false;
+    BDBUNLOCKMETHOD(bdb);
+  }
+  return rv;
+}
+
+
 
 /* Process each record atomically of a B+ tree database object. */
 bool tcbdbforeach(TCBDB *bdb, TCITER iter, void *op){
@@ -1695,12 +1978,53 @@ bool tcbdbforeach(TCBDB *bdb, TCITER iter, void *op){
     return false;
   }
   BDBTHREADYIELD(bdb);
-  bool rv = tcbdbforeachimpl(bdb, iter, op);
+  bool rv = tcbdbbufflush(bdb) && tcbdbforeachimpl(bdb, iter, op);
+  BDBUNLOCKMETHOD(bdb);
+  return rv;
+}
+
+
+/* Process each record of a B+ tree database object by partitions in parallel. */
+bool tcbdbforeachpar(TCBDB *bdb, TCITER iter, void **ops, int tnum, TCREDUCE reduce, void *rop){
+  assert(bdb && iter && ops);
+  if(!BDBLOCKMETHOD(bdb, true)) return false;
+  if(!bdb->open){
+    tcbdbsetecode(bdb, TCEINVALID, __FILE__, __LINE__, __func__);
+    BDBUNLOCKMETHOD(bdb);
+    return false;
+  }
+  BDBTHREADYIELD(bdb);
+  bool rv = tcbdbbufflush(bdb) && tcbdbforeachparimpl(bdb, iter, ops, tnum, reduce, rop);
   BDBUNLOCKMETHOD(bdb);
   return rv;
 }
 
 
+/* Set the parameters of parallel maintenance of a B+ tree database object. */
+bool tcbdbsetparallel(TCBDB *bdb, int32_t tnum, int64_t limit, TCPROGRESS proc, void *op){
+  assert(bdb);
+  if(!BDBLOCKMETHOD(bdb, true)) return false;
+  bdb->ptnum = (tnum > 1) ? tnum : 1;
+  bdb->plimit = (limit > 0) ? limit : 0;
+  bdb->pproc = proc;
+  bdb->pop = op;
+  BDBUNLOCKMETHOD(bdb);
+  return true;
+}
+
+
+/* Set the size of the message buffer of each node of a B+ tree database object. */
+bool tcbdbsetbuffer(TCBDB *bdb, int32_t bsiz){
+  assert(bdb);
+  if(bdb->open){
+    tcbdbsetecode(bdb, TCEINVALID, __FILE__, __LINE__, __func__);
+    return false;
+  }
+  bdb->bsiz = tclmax(bsiz, 0);
+  return true;
+}
+
+
 
 /*************************************************************************************************
  * private features
@@ -1742,6 +2066,16 @@ static void tcbdbclear(TCBDB *bdb){
   bdb->tran = false;
   bdb->rbopaque = NULL;
   bdb->clock = 0;
+  bdb->ptnum = 1;
+  bdb->plimit = 0;
+  bdb->pproc = NULL;
+  bdb->pop = NULL;
+  bdb->bsiz = 0;
+  bdb->bnodes = NULL;
+  bdb->ovpage = false;
+  bdb->pnum = 0;
+  bdb->pagec = NULL;
+  bdb->ostat = false;
   bdb->cnt_saveleaf = -1;
   bdb->cnt_loadleaf = -1;
   bdb->cnt_killleaf = -1;
@@ -1773,10 +2107,17 @@ static void tcbdbdumpmeta(TCBDB *bdb){
     *(uint8_t *)(wp++) = 0x2;
   } else if(bdb->cmp == tccmpint64){
     *(uint8_t *)(wp++) = 0x3;
+  } else if(bdb->cmp == tccmpbeint){
+    *(uint8_t *)(wp++) = 0x4;
   } else {
     *(uint8_t *)(wp++) = 0xff;
   }
-  wp += 7;
+  *(uint8_t *)(wp++) = (bdb->ovpage ? 0x1 : 0x0) | (bdb->ostat ? 0x2 : 0x0);
+  uint64_t pnum = bdb->pnum;
+  for(int i = 0; i < 6; i++){
+    *(uint8_t *)(wp++) = pnum & 0xff;
+    pnum >>= 8;
+  }
   uint32_t lnum;
   lnum = bdb->lmemb;
   lnum = TCHTOIL(lnum);
@@ -1827,8 +2168,17 @@ static void tcbdbloadmeta(TCBDB *bdb){
     bdb->cmp = tccmpint32;
   } else if(cnum == 0x3){
     bdb->cmp = tccmpint64;
+  } else if(cnum == 0x4){
+    bdb->cmp = tccmpbeint;
   }
-  rp += 7;
+  bdb->ovpage = *(uint8_t *)rp & 0x1;
+  bdb->ostat = *(uint8_t *)(rp++) & 0x2;
+  uint64_t pnum = 0;
+  for(int i = 5; i >= 0; i--){
+    pnum = (pnum << 8) + ((uint8_t *)rp)[i];
+  }
+  bdb->pnum = pnum;
+  rp += 6;
   uint32_t lnum;
   memcpy(&lnum, rp, sizeof(lnum));
   rp += sizeof(lnum);
@@ -1858,6 +2208,46 @@ static void tcbdbloadmeta(TCBDB *bdb){
 }
 
 
+/* Get the normalized prefix of a key.
+   `bdb' specifies the B+ tree database object.
+   `kbuf' specifies the pointer to the region of the key.
+   `ksiz' specifies the size of the region of the key.
+   The return value is an integer whose order agrees with the order of keys by the comparison
+   function.  If the prefixes of two keys differ, comparing them decides the order of the keys.
+   If they are the same, the comparison function should be called.  The prefix is always 0 for
+   a comparison function which is not built-in or is `tccmpdecimal'. */
+static uint64_t tcbdbkeypfx(TCBDB *bdb, const char *kbuf, int ksiz){
+  assert(bdb && kbuf && ksiz >= 0);
+  TCCMP cmp = bdb->cmp;
+  const unsigned char *rp = (const unsigned char *)kbuf;
+  uint64_t pfx = 0;
+  if(cmp == tccmplexical){
+    int min = ksiz < (int)sizeof(pfx) ? ksiz : (int)sizeof(pfx);
+    for(int i = 0; i < min; i++){
+      pfx |= (uint64_t)rp[i] << ((sizeof(pfx) - 1 - i) * 8);
+    }
+  } else if(cmp == tccmpbeint){
+    while(ksiz > 0 && *rp == 0){
+      rp++;
+      ksiz--;
+    }
+    if(ksiz > (int)sizeof(pfx)) return UINT64_MAX;
+    for(int i = 0; i < ksiz; i++){
+      pfx = (pfx << 8) | rp[i];
+    }
+  } else if(cmp == tccmpint32){
+    int32_t num = 0;
+    memcpy(&num, kbuf, ksiz < (int)sizeof(num) ? ksiz : (int)sizeof(num));
+    pfx = (uint32_t)num ^ 0x80000000U;
+  } else if(cmp == tccmpint64){
+    int64_t num = 0;
+    memcpy(&num, kbuf, ksiz < (int)sizeof(num) ? ksiz : (int)sizeof(num));
+    pfx = (uint64_t)num ^ 0x8000000000000000ULL;
+  }
+  return pfx;
+}
+
+
 /* Create a new leaf.
    `bdb' specifies the B+ tree database object.
    `prev' specifies the ID number of the previous leaf.
@@ -1892,6 +2282,7 @@ static bool tcbdbleafcacheout(TCBDB *bdb, BDBLEAF *leaf){
   for(int i = 0; i < ln; i++){
     BDBREC *rec = TCPTRLISTVAL(recs, i);
     if(rec->rest) tclistdel(rec->rest);
+    if(rec->ovfl) tcbdbovfldel(rec->ovfl);
     TCFREE(rec);
   }
   tcptrlistdel(recs);
@@ -1934,7 +2325,9 @@ static bool tcbdbleafsave(TCBDB *bdb, BDBLEAF *leaf){
     wp += step;
     TCLIST *rest = rec->rest;
     int rnum = rest ? TCLISTNUM(rest) : 0;
-    TCSETVNUMBUF(step, wp, rnum);
+    lnum = rnum;
+    if(bdb->ovpage) lnum = (lnum << 1) | (rec->ovfl ? 0x1 : 0x0);
+    TCSETVNUMBUF(step, wp, lnum);
     wp += step;
     TCXSTRCAT(rbuf, hbuf, wp - hbuf);
     TCXSTRCAT(rbuf, dbuf, rec->ksiz);
@@ -1947,6 +2340,23 @@ static bool tcbdbleafsave(TCBDB *bdb, BDBLEAF *leaf){
       TCXSTRCAT(rbuf, hbuf, step);
       TCXSTRCAT(rbuf, vbuf, vsiz);
     }
+    BDBOVFL *ovfl = rec->ovfl;
+    if(ovfl){
+      TCSETVNUMBUF(step, hbuf, ovfl->pnum);
+      TCXSTRCAT(rbuf, hbuf, step);
+      for(int j = 0; j < ovfl->pnum; j++){
+        BDBOVPG *page = ovfl->pages + j;
+        wp = hbuf;
+        llnum = page->id;
+        TCSETVNUMBUF64(step, wp, llnum);
+        wp += step;
+        TCSETVNUMBUF(step, wp, page->num);
+        wp += step;
+        TCSETVNUMBUF(step, wp, page->size);
+        wp += step;
+        TCXSTRCAT(rbuf, hbuf, wp - hbuf);
+      }
+    }
   }
   bool err = false;
   step = sprintf(hbuf, "%llx", (unsigned long long)leaf->id);
@@ -1976,40 +2386,65 @@ static BDBLEAF *tcbdbleafload(TCBDB *bdb, uint64_t id){
   }
   if(clk) BDBUNLOCKCACHE(bdb);
   TCDODEBUG(bdb->cnt_loadleaf++);
+  BDBLEAF lent;
+  if(!tcbdbleafread(bdb, id, &lent)){
+    tcbdbsetecode(bdb, TCEMISC, __FILE__, __LINE__, __func__);
+    return NULL;
+  }
+  clk = BDBLOCKCACHE(bdb);
+  if(!tcmapputkeep(bdb->leafc, &(lent.id), sizeof(lent.id), &lent, sizeof(lent))){
+    int ln = TCPTRLISTNUM(lent.recs);
+    for(int i = 0; i < ln; i++){
+      BDBREC *rec = TCPTRLISTVAL(lent.recs, i);
+      if(rec->rest) tclistdel(rec->rest);
+      if(rec->ovfl) tcbdbovfldel(rec->ovfl);
+      TCFREE(rec);
+    }
+    tcptrlistdel(lent.recs);
+  }
+  leaf = (BDBLEAF *)tcmapget(bdb->leafc, &(lent.id), sizeof(lent.id), &rsiz);
+  if(clk) BDBUNLOCKCACHE(bdb);
+  return leaf;
+}
+
+
+/* Read a leaf from the internal database without caching.
+   `bdb' specifies the B+ tree database object.
+   `id' specifies the ID number of the leaf.
+   `leaf' specifies the leaf object into which the content is read.
+   If successful, the return value is true, else, it is false. */
+static bool tcbdbleafread(TCBDB *bdb, uint64_t id, BDBLEAF *leaf){
+  assert(bdb && id > 0 && leaf);
+  TCHDB *hdb = bdb->hdb;
   char hbuf[(sizeof(uint64_t)+1)*3];
   int step;
   step = sprintf(hbuf, "%llx", (unsigned long long)id);
   char *rbuf = NULL;
   char wbuf[BDBPAGEBUFSIZ];
   const char *rp = NULL;
-  rsiz = tchdbget3(bdb->hdb, hbuf, step, wbuf, BDBPAGEBUFSIZ);
+  int rsiz = tchdbget3(hdb, hbuf, step, wbuf, BDBPAGEBUFSIZ);
   if(rsiz < 1){
-    tcbdbsetecode(bdb, TCEMISC, __FILE__, __LINE__, __func__);
     return false;
   } else if(rsiz < BDBPAGEBUFSIZ){
     rp = wbuf;
   } else {
-    if(!(rbuf = tchdbget(bdb->hdb, hbuf, step, &rsiz))){
-      tcbdbsetecode(bdb, TCEMISC, __FILE__, __LINE__, __func__);
-      return false;
-    }
+    if(!(rbuf = tchdbget(hdb, hbuf, step, &rsiz))) return false;
     rp = rbuf;
   }
-  BDBLEAF lent;
-  lent.id = id;
+  leaf->id = id;
   uint64_t llnum;
   TCREADVNUMBUF64(rp, llnum, step);
-  lent.prev = llnum;
+  leaf->prev = llnum;
   rp += step;
   rsiz -= step;
   TCREADVNUMBUF64(rp, llnum, step);
-  lent.next = llnum;
+  leaf->next = llnum;
   rp += step;
   rsiz -= step;
-  lent.dirty = false;
-  lent.dead = false;
-  lent.recs = tcptrlistnew2(bdb->lmemb + 1);
-  lent.size = 0;
+  leaf->dirty = false;
+  leaf->dead = false;
+  leaf->recs = tcptrlistnew2(bdb->lmemb + 1);
+  leaf->size = 0;
   bool err = false;
   while(rsiz >= 3){
     int ksiz;
@@ -2024,6 +2459,11 @@ static BDBLEAF *tcbdbleafload(TCBDB *bdb, uint64_t id){
     TCREADVNUMBUF(rp, rnum, step);
     rp += step;
     rsiz -= step;
+    bool ovfl = false;
+    if(bdb->ovpage){
+      ovfl = rnum & 0x1;
+      rnum >>= 1;
+    }
     if(rsiz < ksiz + vsiz + rnum){
       err = true;
       break;
@@ -2035,6 +2475,7 @@ static BDBLEAF *tcbdbleafload(TCBDB *bdb, uint64_t id){
     memcpy(dbuf, rp, ksiz);
     dbuf[ksiz] = '\0';
     nrec->ksiz = ksiz;
+    nrec->pfx = tcbdbkeypfx(bdb, dbuf, ksiz);
     rp += ksiz;
     rsiz -= ksiz;
     memcpy(dbuf + ksiz + psiz, rp, vsiz);
@@ -2042,8 +2483,8 @@ static BDBLEAF *tcbdbleafload(TCBDB *bdb, uint64_t id){
     nrec->vsiz = vsiz;
     rp += vsiz;
     rsiz -= vsiz;
-    lent.size += ksiz;
-    lent.size += vsiz;
+    leaf->size += ksiz;
+    leaf->size += vsiz;
     if(rnum > 0){
       nrec->rest = tclistnew2(rnum);
       while(rnum-- > 0 && rsiz > 0){
@@ -2057,31 +2498,57 @@ static BDBLEAF *tcbdbleafload(TCBDB *bdb, uint64_t id){
         TCLISTPUSH(nrec->rest, rp, vsiz);
         rp += vsiz;
         rsiz -= vsiz;
-        lent.size += vsiz;
+        leaf->size += vsiz;
       }
     } else {
       nrec->rest = NULL;
     }
-    TCPTRLISTPUSH(lent.recs, nrec);
+    nrec->ovfl = NULL;
+    if(ovfl && !err){
+      int pnum;
+      TCREADVNUMBUF(rp, pnum, step);
+      rp += step;
+      rsiz -= step;
+      BDBOVFL *ovfl;
+      TCMALLOC(ovfl, sizeof(*ovfl));
+      TCMALLOC(ovfl->pages, sizeof(*ovfl->pages) * pnum + 1);
+      ovfl->pnum = 0;
+      ovfl->anum = pnum;
+      ovfl->vnum = 0;
+      nrec->ovfl = ovfl;
+      while(ovfl->pnum < pnum && rsiz > 0){
+        BDBOVPG *page = ovfl->pages + ovfl->pnum;
+        TCREADVNUMBUF64(rp, page->id, step);
+        rp += step;
+        rsiz -= step;
+        TCREADVNUMBUF(rp, page->num, step);
+        rp += step;
+        rsiz -= step;
+        TCREADVNUMBUF(rp, page->size, step);
+        rp += step;
+        rsiz -= step;
+        page->base = ovfl->vnum;
+        ovfl->vnum += page->num;
+        ovfl->pnum++;
+      }
+      if(ovfl->pnum < 1 || rsiz < 0) err = true;
+    }
+    TCPTRLISTPUSH(leaf->recs, nrec);
+    if(err) break;
   }
   TCFREE(rbuf);
   if(err || rsiz != 0){
-    tcbdbsetecode(bdb, TCEMISC, __FILE__, __LINE__, __func__);
-    return NULL;
-  }
-  clk = BDBLOCKCACHE(bdb);
-  if(!tcmapputkeep(bdb->leafc, &(lent.id), sizeof(lent.id), &lent, sizeof(lent))){
-    int ln = TCPTRLISTNUM(lent.recs);
+    int ln = TCPTRLISTNUM(leaf->recs);
     for(int i = 0; i < ln; i++){
-      BDBREC *rec = TCPTRLISTVAL(lent.recs, i);
+      BDBREC *rec = TCPTRLISTVAL(leaf->recs, i);
       if(rec->rest) tclistdel(rec->rest);
+      if(rec->ovfl) tcbdbovfldel(rec->ovfl);
       TCFREE(rec);
     }
-    tcptrlistdel(lent.recs);
+    tcptrlistdel(leaf->recs);
+    return false;
   }
-  leaf = (BDBLEAF *)tcmapget(bdb->leafc, &(lent.id), sizeof(lent.id), &rsiz);
-  if(clk) BDBUNLOCKCACHE(bdb);
-  return leaf;
+  return true;
 }
 
 
@@ -2114,23 +2581,16 @@ static BDBLEAF *tcbdbgethistleaf(TCBDB *bdb, const char *kbuf, int ksiz, uint64_
   if(!leaf) return NULL;
   int ln = TCPTRLISTNUM(leaf->recs);
   if(ln < 2) return NULL;
+  uint64_t kpfx = tcbdbkeypfx(bdb, kbuf, ksiz);
   BDBREC *rec = TCPTRLISTVAL(leaf->recs, 0);
   char *dbuf = (char *)rec + sizeof(*rec);
   int rv;
-  if(bdb->cmp == tccmplexical){
-    TCCMPLEXICAL(rv, kbuf, ksiz, dbuf, rec->ksiz);
-  } else {
-    rv = bdb->cmp(kbuf, ksiz, dbuf, rec->ksiz, bdb->cmpop);
-  }
+  BDBCMPKEY(rv, bdb, kpfx, kbuf, ksiz, rec->pfx, dbuf, rec->ksiz);
   if(rv == 0) return leaf;
   if(rv < 0) return NULL;
   rec = TCPTRLISTVAL(leaf->recs, ln - 1);
   dbuf = (char *)rec + sizeof(*rec);
-  if(bdb->cmp == tccmplexical){
-    TCCMPLEXICAL(rv, kbuf, ksiz, dbuf, rec->ksiz);
-  } else {
-    rv = bdb->cmp(kbuf, ksiz, dbuf, rec->ksiz, bdb->cmpop);
-  }
+  BDBCMPKEY(rv, bdb, kpfx, kbuf, ksiz, rec->pfx, dbuf, rec->ksiz);
   if(rv <= 0 || leaf->next < 1) return leaf;
   return NULL;
 }
@@ -2148,8 +2608,7 @@ static BDBLEAF *tcbdbgethistleaf(TCBDB *bdb, const char *kbuf, int ksiz, uint64_
 static bool tcbdbleafaddrec(TCBDB *bdb, BDBLEAF *leaf, int dmode,
                             const char *kbuf, int ksiz, const char *vbuf, int vsiz){
   assert(bdb && leaf && kbuf && ksiz >= 0);
-  TCCMP cmp = bdb->cmp;
-  void *cmpop = bdb->cmpop;
+  uint64_t kpfx = tcbdbkeypfx(bdb, kbuf, ksiz);
   TCPTRLIST *recs = leaf->recs;
   int ln = TCPTRLISTNUM(recs);
   int left = 0;
@@ -2159,11 +2618,7 @@ static bool tcbdbleafaddrec(TCBDB *bdb, BDBLEAF *leaf, int dmode,
     BDBREC *rec = TCPTRLISTVAL(recs, i);
     char *dbuf = (char *)rec + sizeof(*rec);
     int rv;
-    if(cmp == tccmplexical){
-      TCCMPLEXICAL(rv, kbuf, ksiz, dbuf, rec->ksiz);
-    } else {
-      rv = cmp(kbuf, ksiz, dbuf, rec->ksiz, cmpop);
-    }
+    BDBCMPKEY(rv, bdb, kpfx, kbuf, ksiz, rec->pfx, dbuf, rec->ksiz);
     if(rv == 0){
       break;
     } else if(rv <= 0){
@@ -2177,11 +2632,7 @@ static bool tcbdbleafaddrec(TCBDB *bdb, BDBLEAF *leaf, int dmode,
     BDBREC *rec = TCPTRLISTVAL(recs, i);
     char *dbuf = (char *)rec + sizeof(*rec);
     int rv;
-    if(cmp == tccmplexical){
-      TCCMPLEXICAL(rv, kbuf, ksiz, dbuf, rec->ksiz);
-    } else {
-      rv = cmp(kbuf, ksiz, dbuf, rec->ksiz, cmpop);
-    }
+    BDBCMPKEY(rv, bdb, kpfx, kbuf, ksiz, rec->pfx, dbuf, rec->ksiz);
     if(rv == 0){
       int psiz = TCALIGNPAD(rec->ksiz);
       BDBREC *orec = rec;
@@ -2204,15 +2655,12 @@ static bool tcbdbleafaddrec(TCBDB *bdb, BDBLEAF *leaf, int dmode,
         dbuf[rec->ksiz+psiz+rec->vsiz] = '\0';
         break;
       case BDBPDDUP:
-        leaf->size += vsiz;
-        if(!rec->rest) rec->rest = tclistnew2(1);
-        TCLISTPUSH(rec->rest, vbuf, vsiz);
+        if(!tcbdbrecinsert(bdb, leaf, rec, tcbdbrecvnum(rec) - 1, vbuf, vsiz)) return false;
         bdb->rnum++;
         break;
       case BDBPDDUPB:
-        leaf->size += vsiz;
-        if(!rec->rest) rec->rest = tclistnew2(1);
-        tclistunshift(rec->rest, dbuf + rec->ksiz + psiz, rec->vsiz);
+        if(!tcbdbrecinsert(bdb, leaf, rec, 0, dbuf + rec->ksiz + psiz, rec->vsiz)) return false;
+        leaf->size += vsiz - rec->vsiz;
         if(vsiz > rec->vsiz){
           TCREALLOC(rec, rec, sizeof(*rec) + rec->ksiz + psiz + vsiz + 1);
           if(rec != orec){
@@ -2253,7 +2701,7 @@ static bool tcbdbleafaddrec(TCBDB *bdb, BDBLEAF *leaf, int dmode,
         procptr = *(BDBPDPROCOP **)((char *)kbuf - sizeof(procptr));
         nvbuf = procptr->proc(dbuf + rec->ksiz + psiz, rec->vsiz, &nvsiz, procptr->op);
         if(nvbuf == (void *)-1){
-          tcbdbremoverec(bdb, leaf, rec, i);
+          if(!tcbdbremoverec(bdb, leaf, rec, i)) return false;
         } else if(nvbuf){
           leaf->size += nvsiz - rec->vsiz;
           if(nvsiz > rec->vsiz){
@@ -2304,6 +2752,8 @@ static bool tcbdbleafaddrec(TCBDB *bdb, BDBLEAF *leaf, int dmode,
       dbuf[ksiz+psiz+vsiz] = '\0';
       nrec->vsiz = vsiz;
       nrec->rest = NULL;
+      nrec->ovfl = NULL;
+      nrec->pfx = kpfx;
       TCPTRLISTINSERT(recs, i, nrec);
       bdb->rnum++;
       break;
@@ -2327,6 +2777,8 @@ static bool tcbdbleafaddrec(TCBDB *bdb, BDBLEAF *leaf, int dmode,
     dbuf[ksiz+psiz+vsiz] = '\0';
     nrec->vsiz = vsiz;
     nrec->rest = NULL;
+    nrec->ovfl = NULL;
+    nrec->pfx = kpfx;
     TCPTRLISTPUSH(recs, nrec);
     bdb->rnum++;
   }
@@ -2381,6 +2833,7 @@ static BDBLEAF *tcbdbleafdivide(TCBDB *bdb, BDBLEAF *leaf){
    If successful, the return value is true, else, it is false. */
 static bool tcbdbleafkill(TCBDB *bdb, BDBLEAF *leaf){
   assert(bdb && leaf);
+  if(bdb->bsiz > 0) return true;
   BDBNODE *node = tcbdbnodeload(bdb, bdb->hist[--bdb->hnum]);
   if(!node) return false;
   if(tcbdbnodesubidx(bdb, node, leaf->id)){
@@ -2416,7 +2869,10 @@ static BDBNODE *tcbdbnodenew(TCBDB *bdb, uint64_t heir){
   BDBNODE nent;
   nent.id = ++bdb->nnum + BDBNODEIDBASE;
   nent.idxs = tcptrlistnew2(bdb->nmemb + 1);
+  nent.msgs = NULL;
+  nent.msiz = 0;
   nent.heir = heir;
+  nent.hrnum = 0;
   nent.dirty = true;
   nent.dead = false;
   tcmapputkeep(bdb->nodec, &(nent.id), sizeof(nent.id), &nent, sizeof(nent));
@@ -2440,6 +2896,7 @@ static bool tcbdbnodecacheout(TCBDB *bdb, BDBNODE *node){
     TCFREE(idx);
   }
   tcptrlistdel(idxs);
+  if(node->msgs) tctreedel(node->msgs);
   tcmapout(bdb->nodec, &(node->id), sizeof(node->id));
   return !err;
 }
@@ -2459,6 +2916,11 @@ static bool tcbdbnodesave(TCBDB *bdb, BDBNODE *node){
   llnum = node->heir;
   TCSETVNUMBUF64(step, hbuf, llnum);
   TCXSTRCAT(rbuf, hbuf, step);
+  if(bdb->ostat){
+    llnum = node->hrnum;
+    TCSETVNUMBUF64(step, hbuf, llnum);
+    TCXSTRCAT(rbuf, hbuf, step);
+  }
   TCPTRLIST *idxs = node->idxs;
   int ln = TCPTRLISTNUM(idxs);
   for(int i = 0; i < ln; i++){
@@ -2468,12 +2930,39 @@ static bool tcbdbnodesave(TCBDB *bdb, BDBNODE *node){
     llnum = idx->pid;
     TCSETVNUMBUF64(step, wp, llnum);
     wp += step;
+    if(bdb->ostat){
+      llnum = idx->rnum;
+      TCSETVNUMBUF64(step, wp, llnum);
+      wp += step;
+    }
     uint32_t lnum = idx->ksiz;
     TCSETVNUMBUF(step, wp, lnum);
     wp += step;
     TCXSTRCAT(rbuf, hbuf, wp - hbuf);
     TCXSTRCAT(rbuf, ebuf, idx->ksiz);
   }
+  TCTREE *msgs = node->msgs;
+  if(msgs && tctreernum(msgs) > 0){
+    *hbuf = 0;
+    TCXSTRCAT(rbuf, hbuf, 1);
+    tctreeiterinit(msgs);
+    const char *kbuf;
+    int ksiz;
+    while((kbuf = tctreeiternext(msgs, &ksiz)) != NULL){
+      int msiz;
+      const char *mbuf = tctreeiterval(kbuf, &msiz);
+      char *wp = hbuf;
+      uint32_t lnum = ksiz;
+      TCSETVNUMBUF(step, wp, lnum);
+      wp += step;
+      lnum = msiz;
+      TCSETVNUMBUF(step, wp, lnum);
+      wp += step;
+      TCXSTRCAT(rbuf, hbuf, wp - hbuf);
+      TCXSTRCAT(rbuf, kbuf, ksiz);
+      TCXSTRCAT(rbuf, mbuf, msiz);
+    }
+  }
   bool err = false;
   step = sprintf(hbuf, "#%llx", (unsigned long long)(node->id - BDBNODEIDBASE));
   if(ln < 1 && !tchdbout(bdb->hdb, hbuf, step) && tchdbecode(bdb->hdb) != TCENOREC)
@@ -2528,15 +3017,52 @@ static BDBNODE *tcbdbnodeload(TCBDB *bdb, uint64_t id){
   nent.heir = llnum;
   rp += step;
   rsiz -= step;
+  nent.hrnum = 0;
+  if(bdb->ostat){
+    TCREADVNUMBUF64(rp, llnum, step);
+    nent.hrnum = llnum;
+    rp += step;
+    rsiz -= step;
+  }
   nent.dirty = false;
   nent.dead = false;
   nent.idxs = tcptrlistnew2(bdb->nmemb + 1);
+  nent.msgs = NULL;
+  nent.msiz = 0;
   bool err = false;
   while(rsiz >= 2){
     uint64_t pid;
     TCREADVNUMBUF64(rp, pid, step);
     rp += step;
     rsiz -= step;
+    if(pid < 1){
+      nent.msgs = tctreenew2(bdb->cmp, bdb->cmpop);
+      while(rsiz >= 2){
+        int ksiz;
+        TCREADVNUMBUF(rp, ksiz, step);
+        rp += step;
+        rsiz -= step;
+        int msiz;
+        TCREADVNUMBUF(rp, msiz, step);
+        rp += step;
+        rsiz -= step;
+        if(rsiz < ksiz + msiz){
+          err = true;
+          break;
+        }
+        tctreeput(nent.msgs, rp, ksiz, rp + ksiz, msiz);
+        nent.msiz += ksiz + msiz;
+        rp += ksiz + msiz;
+        rsiz -= ksiz + msiz;
+      }
+      break;
+    }
+    uint64_t rnum = 0;
+    if(bdb->ostat){
+      TCREADVNUMBUF64(rp, rnum, step);
+      rp += step;
+      rsiz -= step;
+    }
     int ksiz;
     TCREADVNUMBUF(rp, ksiz, step);
     rp += step;
@@ -2548,16 +3074,19 @@ static BDBNODE *tcbdbnodeload(TCBDB *bdb, uint64_t id){
     BDBIDX *nidx;
     TCMALLOC(nidx, sizeof(*nidx) + ksiz + 1);
     nidx->pid = pid;
+    nidx->rnum = rnum;
     char *ebuf = (char *)nidx + sizeof(*nidx);
     memcpy(ebuf, rp, ksiz);
     ebuf[ksiz] = '\0';
     nidx->ksiz = ksiz;
+    nidx->pfx = tcbdbkeypfx(bdb, ebuf, ksiz);
     rp += ksiz;
     rsiz -= ksiz;
     TCPTRLISTPUSH(nent.idxs, nidx);
   }
   TCFREE(rbuf);
   if(err || rsiz != 0){
+    if(nent.msgs) tctreedel(nent.msgs);
     tcbdbsetecode(bdb, TCEMISC, __FILE__, __LINE__, __func__);
     return NULL;
   }
@@ -2569,6 +3098,9 @@ static BDBNODE *tcbdbnodeload(TCBDB *bdb, uint64_t id){
       TCFREE(idx);
     }
     tcptrlistdel(nent.idxs);
+    if(nent.msgs) tctreedel(nent.msgs);
+  } else if(nent.msgs){
+    tcmapputkeep(bdb->bnodes, &(nent.id), sizeof(nent.id), "", 0);
   }
   node = (BDBNODE *)tcmapget(bdb->nodec, &(nent.id), sizeof(nent.id), &rsiz);
   if(clk) BDBUNLOCKCACHE(bdb);
@@ -2581,20 +3113,22 @@ static BDBNODE *tcbdbnodeload(TCBDB *bdb, uint64_t id){
    `node' specifies the node object.
    `order' specifies whether the calling sequence is orderd or not.
    `pid' specifies the ID number of referred page.
+   `rnum' specifies the number of records under the referred page.
    `kbuf' specifies the pointer to the region of the key.
    `ksiz' specifies the size of the region of the key. */
-static void tcbdbnodeaddidx(TCBDB *bdb, BDBNODE *node, bool order, uint64_t pid,
+static void tcbdbnodeaddidx(TCBDB *bdb, BDBNODE *node, bool order, uint64_t pid, uint64_t rnum,
                             const char *kbuf, int ksiz){
   assert(bdb && node && pid > 0 && kbuf && ksiz >= 0);
   BDBIDX *nidx;
   TCMALLOC(nidx, sizeof(*nidx) + ksiz + 1);
   nidx->pid = pid;
+  nidx->rnum = rnum;
   char *ebuf = (char *)nidx + sizeof(*nidx);
   memcpy(ebuf, kbuf, ksiz);
   ebuf[ksiz] = '\0';
   nidx->ksiz = ksiz;
-  TCCMP cmp = bdb->cmp;
-  void *cmpop = bdb->cmpop;
+  uint64_t kpfx = tcbdbkeypfx(bdb, kbuf, ksiz);
+  nidx->pfx = kpfx;
   TCPTRLIST *idxs = node->idxs;
   if(order){
     TCPTRLISTPUSH(idxs, nidx);
@@ -2607,11 +3141,7 @@ static void tcbdbnodeaddidx(TCBDB *bdb, BDBNODE *node, bool order, uint64_t pid,
       BDBIDX *idx = TCPTRLISTVAL(idxs, i);
       char *ebuf = (char *)idx + sizeof(*idx);
       int rv;
-      if(cmp == tccmplexical){
-        TCCMPLEXICAL(rv, kbuf, ksiz, ebuf, idx->ksiz);
-      } else {
-        rv = cmp(kbuf, ksiz, ebuf, idx->ksiz, cmpop);
-      }
+      BDBCMPKEY(rv, bdb, kpfx, kbuf, ksiz, idx->pfx, ebuf, idx->ksiz);
       if(rv == 0){
         break;
       } else if(rv <= 0){
@@ -2625,11 +3155,7 @@ static void tcbdbnodeaddidx(TCBDB *bdb, BDBNODE *node, bool order, uint64_t pid,
       BDBIDX *idx = TCPTRLISTVAL(idxs, i);
       char *ebuf = (char *)idx + sizeof(*idx);
       int rv;
-      if(cmp == tccmplexical){
-        TCCMPLEXICAL(rv, kbuf, ksiz, ebuf, idx->ksiz);
-      } else {
-        rv = cmp(kbuf, ksiz, ebuf, idx->ksiz, cmpop);
-      }
+      BDBCMPKEY(rv, bdb, kpfx, kbuf, ksiz, idx->pfx, ebuf, idx->ksiz);
       if(rv < 0){
         TCPTRLISTINSERT(idxs, i, nidx);
         break;
@@ -2656,6 +3182,7 @@ static bool tcbdbnodesubidx(TCBDB *bdb, BDBNODE *node, uint64_t pid){
       BDBIDX *idx = tcptrlistshift(idxs);
       assert(idx);
       node->heir = idx->pid;
+      node->hrnum = idx->rnum;
       TCFREE(idx);
       return true;
     } else if(bdb->hnum > 0){
@@ -2697,6 +3224,77 @@ static bool tcbdbnodesubidx(TCBDB *bdb, BDBNODE *node, uint64_t pid){
 }
 
 
+/* Get the reference to the number of records under a child of a node.
+   `node' specifies the node object.
+   `pid' specifies the ID number of the child.
+   The return value is the pointer to the number or `NULL' if the child is not found. */
+static uint64_t *tcbdbnoderef(BDBNODE *node, uint64_t pid){
+  assert(node && pid > 0);
+  if(node->heir == pid) return &(node->hrnum);
+  TCPTRLIST *idxs = node->idxs;
+  int ln = TCPTRLISTNUM(idxs);
+  for(int i = 0; i < ln; i++){
+    BDBIDX *idx = TCPTRLISTVAL(idxs, i);
+    if(idx->pid == pid) return &(idx->rnum);
+  }
+  return NULL;
+}
+
+
+/* Get the number of records in a leaf.
+   `leaf' specifies the leaf object.
+   The return value is the number of records including duplicated values. */
+static uint64_t tcbdbleafrnum(BDBLEAF *leaf){
+  assert(leaf);
+  TCPTRLIST *recs = leaf->recs;
+  int ln = TCPTRLISTNUM(recs);
+  uint64_t rnum = 0;
+  for(int i = 0; i < ln; i++){
+    rnum += tcbdbrecvnum(TCPTRLISTVAL(recs, i));
+  }
+  return rnum;
+}
+
+
+/* Add the number of records to the path to a leaf.
+   `bdb' specifies the B+ tree database object.
+   `id' specifies the ID number of the leaf.
+   `kbuf' specifies the pointer to the region of a key in the leaf.
+   `ksiz' specifies the size of the region of the key.
+   `num' specifies the additional number.
+   If successful, the return value is true, else, it is false.
+   The history of visited nodes is used if it leads to the leaf, else, the leaf is searched again
+   for the key. */
+static bool tcbdbstatadd(TCBDB *bdb, uint64_t id, const char *kbuf, int ksiz, int64_t num){
+  assert(bdb && id > 0 && kbuf && ksiz >= 0);
+  if(!bdb->ostat || num == 0 || bdb->root <= BDBNODEIDBASE) return true;
+  BDBNODE *nodes[BDBLEVELMAX];
+  uint64_t *refs[BDBLEVELMAX];
+  for(int i = 0; i < 2; i++){
+    if(i > 0 && tcbdbsearchleaf(bdb, kbuf, ksiz) != id) break;
+    int hnum = bdb->hnum;
+    if(hnum < 1 || bdb->hist[0] != bdb->root) continue;
+    uint64_t cid = id;
+    int j;
+    for(j = hnum - 1; j >= 0; j--){
+      BDBNODE *node = tcbdbnodeload(bdb, bdb->hist[j]);
+      if(!node) return false;
+      if(!(refs[j] = tcbdbnoderef(node, cid))) break;
+      nodes[j] = node;
+      cid = node->id;
+    }
+    if(j >= 0) continue;
+    for(j = 0; j < hnum; j++){
+      *refs[j] += num;
+      nodes[j]->dirty = true;
+    }
+    return true;
+  }
+  tcbdbsetecode(bdb, TCEMISC, __FILE__, __LINE__, __func__);
+  return false;
+}
+
+
 /* Search the leaf object corresponding to a key.
    `bdb' specifies the B+ tree database object.
    `kbuf' specifies the pointer to the region of the key.
@@ -2704,8 +3302,7 @@ static bool tcbdbnodesubidx(TCBDB *bdb, BDBNODE *node, uint64_t pid){
    The return value is the ID number of the leaf object or 0 on failure. */
 static uint64_t tcbdbsearchleaf(TCBDB *bdb, const char *kbuf, int ksiz){
   assert(bdb && kbuf && ksiz >= 0);
-  TCCMP cmp = bdb->cmp;
-  void *cmpop = bdb->cmpop;
+  uint64_t kpfx = tcbdbkeypfx(bdb, kbuf, ksiz);
   uint64_t *hist = bdb->hist;
   uint64_t pid = bdb->root;
   int hnum = 0;
@@ -2728,11 +3325,7 @@ static uint64_t tcbdbsearchleaf(TCBDB *bdb, const char *kbuf, int ksiz){
         idx = TCPTRLISTVAL(idxs, i);
         char *ebuf = (char *)idx + sizeof(*idx);
         int rv;
-        if(cmp == tccmplexical){
-          TCCMPLEXICAL(rv, kbuf, ksiz, ebuf, idx->ksiz);
-        } else {
-          rv = cmp(kbuf, ksiz, ebuf, idx->ksiz, cmpop);
-        }
+        BDBCMPKEY(rv, bdb, kpfx, kbuf, ksiz, idx->pfx, ebuf, idx->ksiz);
         if(rv == 0){
           break;
         } else if(rv <= 0){
@@ -2747,11 +3340,7 @@ static uint64_t tcbdbsearchleaf(TCBDB *bdb, const char *kbuf, int ksiz){
         idx = TCPTRLISTVAL(idxs, i);
         char *ebuf = (char *)idx + sizeof(*idx);
         int rv;
-        if(cmp == tccmplexical){
-          TCCMPLEXICAL(rv, kbuf, ksiz, ebuf, idx->ksiz);
-        } else {
-          rv = cmp(kbuf, ksiz, ebuf, idx->ksiz, cmpop);
-        }
+        BDBCMPKEY(rv, bdb, kpfx, kbuf, ksiz, idx->pfx, ebuf, idx->ksiz);
         if(rv < 0){
           if(i == 0){
             pid = node->heir;
@@ -2784,8 +3373,7 @@ static uint64_t tcbdbsearchleaf(TCBDB *bdb, const char *kbuf, int ksiz){
    The return value is the pointer to a corresponding record or `NULL' on failure. */
 static BDBREC *tcbdbsearchrec(TCBDB *bdb, BDBLEAF *leaf, const char *kbuf, int ksiz, int *ip){
   assert(bdb && leaf && kbuf && ksiz >= 0);
-  TCCMP cmp = bdb->cmp;
-  void *cmpop = bdb->cmpop;
+  uint64_t kpfx = tcbdbkeypfx(bdb, kbuf, ksiz);
   TCPTRLIST *recs = leaf->recs;
   int ln = TCPTRLISTNUM(recs);
   int left = 0;
@@ -2795,11 +3383,7 @@ static BDBREC *tcbdbsearchrec(TCBDB *bdb, BDBLEAF *leaf, const char *kbuf, int k
     BDBREC *rec = TCPTRLISTVAL(recs, i);
     char *dbuf = (char *)rec + sizeof(*rec);
     int rv;
-    if(cmp == tccmplexical){
-      TCCMPLEXICAL(rv, kbuf, ksiz, dbuf, rec->ksiz);
-    } else {
-      rv = cmp(kbuf, ksiz, dbuf, rec->ksiz, cmpop);
-    }
+    BDBCMPKEY(rv, bdb, kpfx, kbuf, ksiz, rec->pfx, dbuf, rec->ksiz);
     if(rv == 0){
       if(ip) *ip = i;
       return rec;
@@ -2819,12 +3403,13 @@ static BDBREC *tcbdbsearchrec(TCBDB *bdb, BDBLEAF *leaf, const char *kbuf, int k
    `bdb' specifies the B+ tree database object.
    `rec' specifies the record object.
    `ri' specifies the index of the record. */
-static void tcbdbremoverec(TCBDB *bdb, BDBLEAF *leaf, BDBREC *rec, int ri){
+static bool tcbdbremoverec(TCBDB *bdb, BDBLEAF *leaf, BDBREC *rec, int ri){
   assert(bdb && leaf && rec && ri >= 0);
-  if(rec->rest){
-    leaf->size -= rec->vsiz;
+  if(rec->rest || rec->ovfl){
     int vsiz;
-    char *vbuf = tclistshift(rec->rest, &vsiz);
+    char *vbuf = tcbdbrecremove(bdb, leaf, rec, 0, &vsiz);
+    if(!vbuf) return false;
+    leaf->size += vsiz - rec->vsiz;
     int psiz = TCALIGNPAD(rec->ksiz);
     if(vsiz > rec->vsiz){
       BDBREC *orec = rec;
@@ -2836,31 +3421,520 @@ static void tcbdbremoverec(TCBDB *bdb, BDBLEAF *leaf, BDBREC *rec, int ri){
     dbuf[rec->ksiz+psiz+vsiz] = '\0';
     rec->vsiz = vsiz;
     TCFREE(vbuf);
-    if(TCLISTNUM(rec->rest) < 1){
-      tclistdel(rec->rest);
-      rec->rest = NULL;
-    }
   } else {
     leaf->size -= rec->ksiz + rec->vsiz;
     TCFREE(tcptrlistremove(leaf->recs, ri));
   }
   bdb->rnum--;
+  return true;
 }
 
 
-/* Adjust the caches for leaves and nodes.
+/* Get the number of values of a record.
+   `rec' specifies the record object.
+   The return value is the number of values including the first one. */
+static int tcbdbrecvnum(BDBREC *rec){
+  assert(rec);
+  if(rec->rest) return TCLISTNUM(rec->rest) + 1;
+  if(rec->ovfl) return rec->ovfl->vnum + 1;
+  return 1;
+}
+
+
+/* Get a value of a record.
    `bdb' specifies the B+ tree database object.
-   The return value is true if successful, else, it is false. */
-static bool tcbdbcacheadjust(TCBDB *bdb){
-  bool err = false;
-  if(TCMAPRNUM(bdb->leafc) > bdb->lcnum){
-    TCDODEBUG(bdb->cnt_adjleafc++);
-    int ecode = tchdbecode(bdb->hdb);
-    bool clk = BDBLOCKCACHE(bdb);
-    TCMAP *leafc = bdb->leafc;
-    tcmapiterinit(leafc);
-    int dnum = tclmax(TCMAPRNUM(bdb->leafc) - bdb->lcnum, BDBCACHEOUT);
-    for(int i = 0; i < dnum; i++){
+   `rec' specifies the record object.
+   `vidx' specifies the index of the value, where 0 means the first one.
+   `sp' specifies the pointer to the variable into which the size of the region of the return
+   value is assigned.
+   If successful, the return value is the pointer to the region of the value, else, it is
+   `NULL'. */
+static const char *tcbdbrecval(TCBDB *bdb, BDBREC *rec, int vidx, int *sp){
+  assert(bdb && rec && vidx >= 0 && sp);
+  if(vidx < 1){
+    *sp = rec->vsiz;
+    return (char *)rec + sizeof(*rec) + rec->ksiz + TCALIGNPAD(rec->ksiz);
+  }
+  if(rec->rest){
+    if(vidx > TCLISTNUM(rec->rest)){
+      tcbdbsetecode(bdb, TCENOREC, __FILE__, __LINE__, __func__);
+      return NULL;
+    }
+    const char *vbuf;
+    TCLISTVAL(vbuf, rec->rest, vidx - 1, *sp);
+    return vbuf;
+  }
+  BDBOVFL *ovfl = rec->ovfl;
+  if(!ovfl || vidx > ovfl->vnum){
+    tcbdbsetecode(bdb, TCENOREC, __FILE__, __LINE__, __func__);
+    return NULL;
+  }
+  int off;
+  int pi = tcbdbovflfind(ovfl, vidx - 1, &off);
+  TCLIST *vals = tcbdbovpgload(bdb, ovfl->pages[pi].id);
+  if(!vals) return NULL;
+  if(off >= TCLISTNUM(vals)){
+    tcbdbsetecode(bdb, TCEMISC, __FILE__, __LINE__, __func__);
+    return NULL;
+  }
+  const char *vbuf;
+  TCLISTVAL(vbuf, vals, off, *sp);
+  return vbuf;
+}
+
+
+/* Insert a value into the rest values of a record.
+   `bdb' specifies the B+ tree database object.
+   `leaf' specifies the leaf object containing the record.
+   `rec' specifies the record object.
+   `ridx' specifies the index in the rest values, which can be the number of them to append.
+   `vbuf' specifies the pointer to the region of the value.
+   `vsiz' specifies the size of the region of the value.
+   If successful, the return value is true, else, it is false. */
+static bool tcbdbrecinsert(TCBDB *bdb, BDBLEAF *leaf, BDBREC *rec, int ridx,
+                           const char *vbuf, int vsiz){
+  assert(bdb && leaf && rec && ridx >= 0 && vbuf && vsiz >= 0);
+  BDBOVFL *ovfl = rec->ovfl;
+  if(!ovfl){
+    if(!rec->rest) rec->rest = tclistnew2(1);
+    TCLIST *rest = rec->rest;
+    if(ridx >= TCLISTNUM(rest)){
+      TCLISTPUSH(rest, vbuf, vsiz);
+    } else {
+      tclistinsert(rest, ridx, vbuf, vsiz);
+    }
+    leaf->size += vsiz;
+    if(bdb->ovpage && TCLISTNUM(rest) >= BDBOVFLNUM) return tcbdbovflspill(bdb, leaf, rec);
+    return true;
+  }
+  int pi, off;
+  if(ridx >= ovfl->vnum){
+    pi = ovfl->pnum - 1;
+    off = ovfl->pages[pi].num;
+  } else {
+    pi = tcbdbovflfind(ovfl, ridx, &off);
+  }
+  BDBOVPG *page = ovfl->pages + pi;
+  if(off >= page->num && page->size + vsiz > BDBOVPGSIZ){
+    TCLIST *vals = tclistnew2(1);
+    TCLISTPUSH(vals, vbuf, vsiz);
+    bool rv = tcbdbovfladdpage(bdb, ovfl, pi + 1, vals, vsiz);
+    if(rv){
+      tcbdbovflshift(ovfl, pi + 1, 1);
+      ovfl->vnum++;
+    }
+    return rv;
+  }
+  TCLIST *vals = tcbdbovpgload(bdb, page->id);
+  if(!vals) return false;
+  if(off >= TCLISTNUM(vals)){
+    TCLISTPUSH(vals, vbuf, vsiz);
+  } else {
+    tclistinsert(vals, off, vbuf, vsiz);
+  }
+  page->num++;
+  page->size += vsiz;
+  tcbdbovflshift(ovfl, pi, 1);
+  ovfl->vnum++;
+  if(page->size > BDBOVPGSIZ && page->num > 1){
+    int hnum = page->num / 2;
+    TCLIST *hvals = tclistnew2(page->num - hnum);
+    int hsiz = 0;
+    for(int i = hnum; i < page->num; i++){
+      const char *hbuf;
+      int hvsiz;
+      TCLISTVAL(hbuf, vals, i, hvsiz);
+      TCLISTPUSH(hvals, hbuf, hvsiz);
+      hsiz += hvsiz;
+    }
+    while(TCLISTNUM(vals) > hnum){
+      int rsiz;
+      TCFREE(tclistpop(vals, &rsiz));
+    }
+    page->num = hnum;
+    page->size -= hsiz;
+    uint64_t id = page->id;
+    if(!tcbdbovfladdpage(bdb, ovfl, pi + 1, hvals, hsiz)) return false;
+    return tcbdbovpgsave(bdb, id, vals);
+  }
+  return tcbdbovpgsave(bdb, page->id, vals);
+}
+
+
+/* Overwrite a value in the rest values of a record.
+   `bdb' specifies the B+ tree database object.
+   `leaf' specifies the leaf object containing the record.
+   `rec' specifies the record object.
+   `ridx' specifies the index in the rest values.
+   `vbuf' specifies the pointer to the region of the new value.
+   `vsiz' specifies the size of the region of the new value.
+   If successful, the return value is true, else, it is false. */
+static bool tcbdbrecover(TCBDB *bdb, BDBLEAF *leaf, BDBREC *rec, int ridx,
+                         const char *vbuf, int vsiz){
+  assert(bdb && leaf && rec && ridx >= 0 && vbuf && vsiz >= 0);
+  if(rec->rest){
+    TCLIST *rest = rec->rest;
+    if(ridx >= TCLISTNUM(rest)){
+      tcbdbsetecode(bdb, TCENOREC, __FILE__, __LINE__, __func__);
+      return false;
+    }
+    leaf->size += vsiz - TCLISTVALSIZ(rest, ridx);
+    tclistover(rest, ridx, vbuf, vsiz);
+    return true;
+  }
+  BDBOVFL *ovfl = rec->ovfl;
+  if(!ovfl || ridx >= ovfl->vnum){
+    tcbdbsetecode(bdb, TCENOREC, __FILE__, __LINE__, __func__);
+    return false;
+  }
+  int off;
+  int pi = tcbdbovflfind(ovfl, ridx, &off);
+  BDBOVPG *page = ovfl->pages + pi;
+  TCLIST *vals = tcbdbovpgload(bdb, page->id);
+  if(!vals) return false;
+  if(off >= TCLISTNUM(vals)){
+    tcbdbsetecode(bdb, TCEMISC, __FILE__, __LINE__, __func__);
+    return false;
+  }
+  page->size += vsiz - TCLISTVALSIZ(vals, off);
+  tclistover(vals, off, vbuf, vsiz);
+  return tcbdbovpgsave(bdb, page->id, vals);
+}
+
+
+/* Remove a value from the rest values of a record.
+   `bdb' specifies the B+ tree database object.
+   `leaf' specifies the leaf object containing the record.
+   `rec' specifies the record object.
+   `ridx' specifies the index in the rest values.
+   `sp' specifies the pointer to the variable into which the size of the region of the return
+   value is assigned.
+   If successful, the return value is the pointer to the region of the removed value, else, it
+   is `NULL'.  Because the region of the return value is allocated with the `malloc' call, it
+   should be released with the `free' call when it is no longer in use. */
+static char *tcbdbrecremove(TCBDB *bdb, BDBLEAF *leaf, BDBREC *rec, int ridx, int *sp){
+  assert(bdb && leaf && rec && ridx >= 0 && sp);
+  if(rec->rest){
+    TCLIST *rest = rec->rest;
+    if(ridx >= TCLISTNUM(rest)){
+      tcbdbsetecode(bdb, TCENOREC, __FILE__, __LINE__, __func__);
+      return NULL;
+    }
+    char *vbuf = tclistremove(rest, ridx, sp);
+    leaf->size -= *sp;
+    if(TCLISTNUM(rest) < 1){
+      tclistdel(rest);
+      rec->rest = NULL;
+    }
+    return vbuf;
+  }
+  BDBOVFL *ovfl = rec->ovfl;
+  if(!ovfl || ridx >= ovfl->vnum){
+    tcbdbsetecode(bdb, TCENOREC, __FILE__, __LINE__, __func__);
+    return NULL;
+  }
+  int off;
+  int pi = tcbdbovflfind(ovfl, ridx, &off);
+  BDBOVPG *page = ovfl->pages + pi;
+  TCLIST *vals = tcbdbovpgload(bdb, page->id);
+  if(!vals) return NULL;
+  if(off >= TCLISTNUM(vals)){
+    tcbdbsetecode(bdb, TCEMISC, __FILE__, __LINE__, __func__);
+    return NULL;
+  }
+  char *vbuf = tclistremove(vals, off, sp);
+  page->num--;
+  page->size -= *sp;
+  tcbdbovflshift(ovfl, pi, -1);
+  ovfl->vnum--;
+  bool err = false;
+  if(page->num < 1){
+    if(!tcbdbovpgout(bdb, page->id)) err = true;
+    ovfl->pnum--;
+    memmove(ovfl->pages + pi, ovfl->pages + pi + 1, sizeof(*ovfl->pages) * (ovfl->pnum - pi));
+  } else if(!tcbdbovpgsave(bdb, page->id, vals)){
+    err = true;
+  }
+  if(ovfl->pnum < 1){
+    tcbdbovfldel(ovfl);
+    rec->ovfl = NULL;
+  }
+  if(err){
+    TCFREE(vbuf);
+    return NULL;
+  }
+  return vbuf;
+}
+
+
+/* Remove all overflow pages of a record.
+   `bdb' specifies the B+ tree database object.
+   `rec' specifies the record object.
+   If successful, the return value is true, else, it is false. */
+static bool tcbdbrecpurge(TCBDB *bdb, BDBREC *rec){
+  assert(bdb && rec);
+  BDBOVFL *ovfl = rec->ovfl;
+  if(!ovfl) return true;
+  bool err = false;
+  for(int i = 0; i < ovfl->pnum; i++){
+    if(!tcbdbovpgout(bdb, ovfl->pages[i].id)) err = true;
+  }
+  return !err;
+}
+
+
+/* Move the rest values of a record into overflow pages.
+   `bdb' specifies the B+ tree database object.
+   `leaf' specifies the leaf object containing the record.
+   `rec' specifies the record object.
+   If successful, the return value is true, else, it is false. */
+static bool tcbdbovflspill(TCBDB *bdb, BDBLEAF *leaf, BDBREC *rec){
+  assert(bdb && leaf && rec && rec->rest && !rec->ovfl);
+  TCLIST *rest = rec->rest;
+  int ln = TCLISTNUM(rest);
+  BDBOVFL *ovfl;
+  TCMALLOC(ovfl, sizeof(*ovfl));
+  ovfl->anum = ln / (BDBOVPGSIZ / 256 + 1) + 2;
+  TCMALLOC(ovfl->pages, sizeof(*ovfl->pages) * ovfl->anum);
+  ovfl->pnum = 0;
+  ovfl->vnum = ln;
+  rec->ovfl = ovfl;
+  rec->rest = NULL;
+  bool err = false;
+  TCLIST *vals = tclistnew2(ln);
+  int size = 0;
+  for(int i = 0; i < ln; i++){
+    const char *vbuf;
+    int vsiz;
+    TCLISTVAL(vbuf, rest, i, vsiz);
+    if(TCLISTNUM(vals) > 0 && size + vsiz > BDBOVPGSIZ){
+      if(!tcbdbovfladdpage(bdb, ovfl, ovfl->pnum, vals, size)) err = true;
+      vals = tclistnew2(ln - i);
+      size = 0;
+    }
+    TCLISTPUSH(vals, vbuf, vsiz);
+    size += vsiz;
+    leaf->size -= vsiz;
+  }
+  if(!tcbdbovfladdpage(bdb, ovfl, ovfl->pnum, vals, size)) err = true;
+  tclistdel(rest);
+  return !err;
+}
+
+
+/* Find the page containing a value of overflowed values.
+   `ovfl' specifies the overflowed values.
+   `ridx' specifies the index in the rest values.
+   `op' specifies the pointer to the variable into which the offset in the page is assigned.
+   The return value is the index of the page.  The page is found by binary search on the numbers
+   of values in the preceding pages. */
+static int tcbdbovflfind(BDBOVFL *ovfl, int ridx, int *op){
+  assert(ovfl && ridx >= 0 && op);
+  BDBOVPG *pages = ovfl->pages;
+  int left = 0;
+  int right = ovfl->pnum - 1;
+  while(left < right){
+    int mid = (left + right + 1) / 2;
+    if(pages[mid].base <= ridx){
+      left = mid;
+    } else {
+      right = mid - 1;
+    }
+  }
+  *op = ridx - pages[left].base;
+  return left;
+}
+
+
+/* Shift the numbers of values in the preceding pages of overflowed values.
+   `ovfl' specifies the overflowed values.
+   `pi' specifies the index of the page whose number of values has changed.
+   `num' specifies the difference of the number. */
+static void tcbdbovflshift(BDBOVFL *ovfl, int pi, int num){
+  assert(ovfl && pi >= 0);
+  BDBOVPG *pages = ovfl->pages;
+  int pnum = ovfl->pnum;
+  for(int i = pi + 1; i < pnum; i++){
+    pages[i].base += num;
+  }
+}
+
+
+/* Add a page to overflowed values.
+   `bdb' specifies the B+ tree database object.
+   `ovfl' specifies the overflowed values.
+   `pi' specifies the index of the new page in the directory.
+   `vals' specifies the list of values, whose ownership is moved to the cache.
+   `size' specifies the total size of the values.
+   If successful, the return value is true, else, it is false.
+   The following pages should be shifted with `tcbdbovflshift' if the values are new. */
+static bool tcbdbovfladdpage(TCBDB *bdb, BDBOVFL *ovfl, int pi, TCLIST *vals, int size){
+  assert(bdb && ovfl && pi >= 0 && pi <= ovfl->pnum && vals && size >= 0);
+  if(ovfl->pnum >= ovfl->anum){
+    ovfl->anum = ovfl->anum * 2 + 1;
+    TCREALLOC(ovfl->pages, ovfl->pages, sizeof(*ovfl->pages) * ovfl->anum);
+  }
+  BDBOVPG *page = ovfl->pages + pi;
+  memmove(page + 1, page, sizeof(*page) * (ovfl->pnum - pi));
+  ovfl->pnum++;
+  page->id = ++bdb->pnum;
+  page->num = TCLISTNUM(vals);
+  page->size = size;
+  page->base = (pi > 0) ? page[-1].base + page[-1].num : 0;
+  bool rv = tcbdbovpgsave(bdb, page->id, vals);
+  bool clk = BDBLOCKCACHE(bdb);
+  if(!tcmapputkeep(bdb->pagec, &(page->id), sizeof(page->id), &vals, sizeof(vals)))
+    tclistdel(vals);
+  if(clk) BDBUNLOCKCACHE(bdb);
+  return rv;
+}
+
+
+/* Delete overflowed values of a record.
+   `ovfl' specifies the overflowed values. */
+static void tcbdbovfldel(BDBOVFL *ovfl){
+  assert(ovfl);
+  TCFREE(ovfl->pages);
+  TCFREE(ovfl);
+}
+
+
+/* Load an overflow page.
+   `bdb' specifies the B+ tree database object.
+   `id' specifies the ID number of the page.
+   If successful, the return value is the list of values in the page, else, it is `NULL'. */
+static TCLIST *tcbdbovpgload(TCBDB *bdb, uint64_t id){
+  assert(bdb && id > 0);
+  bool clk = BDBLOCKCACHE(bdb);
+  int rsiz;
+  TCLIST **vp = (TCLIST **)tcmapget3(bdb->pagec, &id, sizeof(id), &rsiz);
+  if(vp){
+    TCLIST *vals = *vp;
+    if(clk) BDBUNLOCKCACHE(bdb);
+    return vals;
+  }
+  if(clk) BDBUNLOCKCACHE(bdb);
+  char hbuf[(sizeof(uint64_t)+1)*3];
+  int step = sprintf(hbuf, "+%llx", (unsigned long long)id);
+  char *rbuf = tchdbget(bdb->hdb, hbuf, step, &rsiz);
+  if(!rbuf){
+    tcbdbsetecode(bdb, TCEMISC, __FILE__, __LINE__, __func__);
+    return NULL;
+  }
+  TCLIST *vals = tclistnew2(BDBOVFLNUM);
+  const char *rp = rbuf;
+  while(rsiz > 0){
+    int vsiz;
+    TCREADVNUMBUF(rp, vsiz, step);
+    rp += step;
+    rsiz -= step;
+    if(vsiz > rsiz){
+      TCFREE(rbuf);
+      tclistdel(vals);
+      tcbdbsetecode(bdb, TCEMISC, __FILE__, __LINE__, __func__);
+      return NULL;
+    }
+    TCLISTPUSH(vals, rp, vsiz);
+    rp += vsiz;
+    rsiz -= vsiz;
+  }
+  TCFREE(rbuf);
+  clk = BDBLOCKCACHE(bdb);
+  if(!tcmapputkeep(bdb->pagec, &id, sizeof(id), &vals, sizeof(vals))){
+    tclistdel(vals);
+    vals = *(TCLIST **)tcmapget(bdb->pagec, &id, sizeof(id), &rsiz);
+  }
+  if(clk) BDBUNLOCKCACHE(bdb);
+  return vals;
+}
+
+
+/* Save an overflow page into the internal database.
+   `bdb' specifies the B+ tree database object.
+   `id' specifies the ID number of the page.
+   `vals' specifies the list of values in the page.
+   If successful, the return value is true, else, it is false. */
+static bool tcbdbovpgsave(TCBDB *bdb, uint64_t id, const TCLIST *vals){
+  assert(bdb && id > 0 && vals);
+  TCXSTR *rbuf = tcxstrnew3(BDBOVPGSIZ + BDBOVPGSIZ / 2);
+  char *wp;
+  int step;
+  int ln = TCLISTNUM(vals);
+  for(int i = 0; i < ln; i++){
+    const char *vbuf;
+    int vsiz;
+    TCLISTVAL(vbuf, vals, i, vsiz);
+    char nbuf[sizeof(int)+1];
+    wp = nbuf;
+    TCSETVNUMBUF(step, wp, vsiz);
+    TCXSTRCAT(rbuf, nbuf, step);
+    TCXSTRCAT(rbuf, vbuf, vsiz);
+  }
+  char hbuf[(sizeof(uint64_t)+1)*3];
+  step = sprintf(hbuf, "+%llx", (unsigned long long)id);
+  bool err = false;
+  if(!tchdbput(bdb->hdb, hbuf, step, TCXSTRPTR(rbuf), TCXSTRSIZE(rbuf))){
+    tcbdbsetecode(bdb, tchdbecode(bdb->hdb), __FILE__, __LINE__, __func__);
+    err = true;
+  }
+  tcxstrdel(rbuf);
+  return !err;
+}
+
+
+/* Remove an overflow page from the internal database and the cache.
+   `bdb' specifies the B+ tree database object.
+   `id' specifies the ID number of the page.
+   If successful, the return value is true, else, it is false. */
+static bool tcbdbovpgout(TCBDB *bdb, uint64_t id){
+  assert(bdb && id > 0);
+  bool clk = BDBLOCKCACHE(bdb);
+  int rsiz;
+  TCLIST **vp = (TCLIST **)tcmapget(bdb->pagec, &id, sizeof(id), &rsiz);
+  if(vp){
+    tclistdel(*vp);
+    tcmapout(bdb->pagec, &id, sizeof(id));
+  }
+  if(clk) BDBUNLOCKCACHE(bdb);
+  char hbuf[(sizeof(uint64_t)+1)*3];
+  int step = sprintf(hbuf, "+%llx", (unsigned long long)id);
+  if(!tchdbout(bdb->hdb, hbuf, step) && tchdbecode(bdb->hdb) != TCENOREC){
+    tcbdbsetecode(bdb, tchdbecode(bdb->hdb), __FILE__, __LINE__, __func__);
+    return false;
+  }
+  return true;
+}
+
+
+/* Release all cached overflow pages.
+   `bdb' specifies the B+ tree database object. */
+static void tcbdbovpgpurge(TCBDB *bdb){
+  assert(bdb);
+  if(!bdb->pagec) return;
+  bool clk = BDBLOCKCACHE(bdb);
+  int rsiz;
+  const char *kbuf;
+  tcmapiterinit(bdb->pagec);
+  while((kbuf = tcmapiternext(bdb->pagec, &rsiz)) != NULL)
+    tclistdel(*(TCLIST **)tcmapiterval(kbuf, &rsiz));
+  tcmapclear(bdb->pagec);
+  if(clk) BDBUNLOCKCACHE(bdb);
+}
+
+
+/* Adjust the caches for leaves and nodes.
+   `bdb' specifies the B+ tree database object.
+   The return value is true if successful, else, it is false. */
+static bool tcbdbcacheadjust(TCBDB *bdb){
+  bool err = false;
+  if(TCMAPRNUM(bdb->leafc) > bdb->lcnum){
+    TCDODEBUG(bdb->cnt_adjleafc++);
+    int ecode = tchdbecode(bdb->hdb);
+    bool clk = BDBLOCKCACHE(bdb);
+    TCMAP *leafc = bdb->leafc;
+    tcmapiterinit(leafc);
+    int dnum = tclmax(TCMAPRNUM(bdb->leafc) - bdb->lcnum, BDBCACHEOUT);
+    for(int i = 0; i < dnum; i++){
       int rsiz;
       if(!tcbdbleafcacheout(bdb, (BDBLEAF *)tcmapiterval(tcmapiternext(leafc, &rsiz), &rsiz)))
         err = true;
@@ -2885,6 +3959,20 @@ static bool tcbdbcacheadjust(TCBDB *bdb){
     if(!err && tchdbecode(bdb->hdb) != ecode)
       tcbdbsetecode(bdb, ecode, __FILE__, __LINE__, __func__);
   }
+  if(TCMAPRNUM(bdb->pagec) > bdb->lcnum){
+    bool clk = BDBLOCKCACHE(bdb);
+    TCMAP *pagec = bdb->pagec;
+    tcmapiterinit(pagec);
+    int dnum = tclmax(TCMAPRNUM(pagec) - bdb->lcnum, BDBCACHEOUT);
+    for(int i = 0; i < dnum; i++){
+      int rsiz;
+      const char *kbuf = tcmapiternext(pagec, &rsiz);
+      if(!kbuf) break;
+      tclistdel(*(TCLIST **)tcmapiterval(kbuf, &rsiz));
+      tcmapout(pagec, kbuf, rsiz);
+    }
+    if(clk) BDBUNLOCKCACHE(bdb);
+  }
   return !err;
 }
 
@@ -2905,6 +3993,7 @@ static void tcbdbcachepurge(TCBDB *bdb){
     for(int i = 0; i < ln; i++){
       BDBREC *rec = TCPTRLISTVAL(recs, i);
       if(rec->rest) tclistdel(rec->rest);
+      if(rec->ovfl) tcbdbovfldel(rec->ovfl);
       TCFREE(rec);
     }
     tcptrlistdel(recs);
@@ -2922,9 +4011,11 @@ static void tcbdbcachepurge(TCBDB *bdb){
       TCFREE(idx);
     }
     tcptrlistdel(idxs);
+    if(node->msgs) tctreedel(node->msgs);
     tcmapout(bdb->nodec, tmp, tsiz);
   }
   if(clk) BDBUNLOCKCACHE(bdb);
+  tcbdbovpgpurge(bdb);
 }
 
 
@@ -2970,6 +4061,9 @@ static bool tcbdbopenimpl(TCBDB *bdb, const char *path, int omode){
       bdb->cmp = tccmplexical;
       bdb->cmpop = NULL;
     }
+    bdb->ovpage = true;
+    bdb->ostat = true;
+    bdb->pnum = 0;
     tcbdbdumpmeta(bdb);
     if(!tcbdbleafsave(bdb, leaf)){
       tcmapdel(bdb->nodec);
@@ -2995,6 +4089,8 @@ static bool tcbdbopenimpl(TCBDB *bdb, const char *path, int omode){
     tchdbclose(bdb->hdb);
     return false;
   }
+  bdb->bnodes = tcmapnew2(bdb->ncnum + 1);
+  bdb->pagec = tcmapnew2(bdb->lcnum + 1);
   bdb->open = true;
   uint8_t hopts = tchdbopts(bdb->hdb);
   uint8_t opts = 0;
@@ -3026,8 +4122,10 @@ static bool tcbdbcloseimpl(TCBDB *bdb){
     TCFREE(bdb->rbopaque);
     bdb->tran = false;
     bdb->rbopaque = NULL;
-    if(!tchdbtranvoid(bdb->hdb)) err = true;
+    if(!(bdb->ovpage ? tchdbtranabort(bdb->hdb) : tchdbtranvoid(bdb->hdb))) err = true;
+    tcmapclear(bdb->bnodes);
   }
+  if(bdb->wmode && !tcbdbbufflush(bdb)) err = true;
   bdb->open = false;
   const char *vbuf;
   int vsiz;
@@ -3042,6 +4140,11 @@ static bool tcbdbcloseimpl(TCBDB *bdb){
     if(!tcbdbnodecacheout(bdb, (BDBNODE *)tcmapiterval(vbuf, &vsiz))) err = true;
   }
   if(bdb->wmode) tcbdbdumpmeta(bdb);
+  tcmapdel(bdb->bnodes);
+  bdb->bnodes = NULL;
+  tcbdbovpgpurge(bdb);
+  tcmapdel(bdb->pagec);
+  bdb->pagec = NULL;
   tcmapdel(bdb->nodec);
   tcmapdel(bdb->leafc);
   if(!tchdbclose(bdb->hdb)) err = true;
@@ -3068,10 +4171,13 @@ static bool tcbdbputimpl(TCBDB *bdb, const void *kbuf, int ksiz, const void *vbu
     if(!(leaf = tcbdbleafload(bdb, pid))) return false;
     hlid = 0;
   }
+  uint64_t ornum = bdb->rnum;
   if(!tcbdbleafaddrec(bdb, leaf, dmode, kbuf, ksiz, vbuf, vsiz)){
     if(!bdb->tran) tcbdbcacheadjust(bdb);
     return false;
   }
+  if(bdb->rnum != ornum &&
+     !tcbdbstatadd(bdb, leaf->id, kbuf, ksiz, (int64_t)(bdb->rnum - ornum))) return false;
   int rnum = TCPTRLISTNUM(leaf->recs);
   if(rnum > bdb->lmemb || (rnum > 1 && leaf->size > bdb->lsmax)){
     if(hlid > 0 && hlid != tcbdbsearchleaf(bdb, kbuf, ksiz)) return false;
@@ -3081,6 +4187,8 @@ static bool tcbdbputimpl(TCBDB *bdb, const void *kbuf, int ksiz, const void *vbu
     if(leaf->id == bdb->last) bdb->last = newleaf->id;
     uint64_t heir = leaf->id;
     uint64_t pid = newleaf->id;
+    uint64_t hrnum = tcbdbleafrnum(leaf);
+    uint64_t prnum = tcbdbleafrnum(newleaf);
     BDBREC *rec = TCPTRLISTVAL(newleaf->recs, 0);
     char *dbuf = (char *)rec + sizeof(*rec);
     int ksiz = rec->ksiz;
@@ -3090,7 +4198,8 @@ static bool tcbdbputimpl(TCBDB *bdb, const void *kbuf, int ksiz, const void *vbu
       BDBNODE *node;
       if(bdb->hnum < 1){
         node = tcbdbnodenew(bdb, heir);
-        tcbdbnodeaddidx(bdb, node, true, pid, kbuf, ksiz);
+        node->hrnum = hrnum;
+        tcbdbnodeaddidx(bdb, node, true, pid, prnum, kbuf, ksiz);
         bdb->root = node->id;
         TCFREE(kbuf);
         break;
@@ -3100,29 +4209,40 @@ static bool tcbdbputimpl(TCBDB *bdb, const void *kbuf, int ksiz, const void *vbu
         TCFREE(kbuf);
         return false;
       }
-      tcbdbnodeaddidx(bdb, node, false, pid, kbuf, ksiz);
+      tcbdbnodeaddidx(bdb, node, false, pid, prnum, kbuf, ksiz);
       TCFREE(kbuf);
+      uint64_t *np = tcbdbnoderef(node, heir);
+      if(np) *np -= prnum;
       TCPTRLIST *idxs = node->idxs;
       int ln = TCPTRLISTNUM(idxs);
       if(ln <= bdb->nmemb) break;
       int mid = ln / 2;
       BDBIDX *idx = TCPTRLISTVAL(idxs, mid);
       BDBNODE *newnode = tcbdbnodenew(bdb, idx->pid);
+      newnode->hrnum = idx->rnum;
       heir = node->id;
       pid = newnode->id;
+      prnum = idx->rnum;
       char *ebuf = (char *)idx + sizeof(*idx);
       TCMEMDUP(kbuf, ebuf, idx->ksiz);
       ksiz = idx->ksiz;
       for(int i = mid + 1; i < ln; i++){
         idx = TCPTRLISTVAL(idxs, i);
         char *ebuf = (char *)idx + sizeof(*idx);
-        tcbdbnodeaddidx(bdb, newnode, true, idx->pid, ebuf, idx->ksiz);
+        tcbdbnodeaddidx(bdb, newnode, true, idx->pid, idx->rnum, ebuf, idx->ksiz);
+        prnum += idx->rnum;
+      }
+      hrnum = node->hrnum;
+      for(int i = 0; i < mid; i++){
+        idx = TCPTRLISTVAL(idxs, i);
+        hrnum += idx->rnum;
       }
       ln = TCPTRLISTNUM(newnode->idxs);
       for(int i = 0; i <= ln; i++){
         idx = tcptrlistpop(idxs);
         TCFREE(idx);
       }
+      if(node->msgs) tcbdbbufdivide(bdb, node, newnode, kbuf, ksiz);
       node->dirty = true;
     }
     if(bdb->capnum > 0 && bdb->rnum > bdb->capnum){
@@ -3170,8 +4290,9 @@ static bool tcbdboutimpl(TCBDB *bdb, const char *kbuf, int ksiz){
     tcbdbsetecode(bdb, TCENOREC, __FILE__, __LINE__, __func__);
     return false;
   }
-  tcbdbremoverec(bdb, leaf, rec, ri);
+  bool rv = tcbdbremoverec(bdb, leaf, rec, ri);
   leaf->dirty = true;
+  if(!rv || !tcbdbstatadd(bdb, leaf->id, kbuf, ksiz, -1)) return false;
   if(TCPTRLISTNUM(leaf->recs) < 1){
     if(hlid > 0 && hlid != tcbdbsearchleaf(bdb, kbuf, ksiz)) return false;
     if(bdb->hnum > 0 && !tcbdbleafkill(bdb, leaf)) return false;
@@ -3201,21 +4322,34 @@ static bool tcbdboutlist(TCBDB *bdb, const char *kbuf, int ksiz){
     tcbdbsetecode(bdb, TCENOREC, __FILE__, __LINE__, __func__);
     return false;
   }
-  int rnum = 1;
+  int rnum = tcbdbrecvnum(rec);
   int rsiz = rec->ksiz + rec->vsiz;
   if(rec->rest){
     TCLIST *rest = rec->rest;
     int ln = TCLISTNUM(rec->rest);
-    rnum += ln;
     for(int i = 0; i < ln; i++){
       rsiz += TCLISTVALSIZ(rest, i);
     }
     tclistdel(rest);
   }
+  if(rec->ovfl){
+    bool rv = tcbdbrecpurge(bdb, rec);
+    tcbdbovfldel(rec->ovfl);
+    rec->ovfl = NULL;
+    if(!rv){
+      TCFREE(tcptrlistremove(leaf->recs, ri));
+      leaf->size -= rsiz;
+      leaf->dirty = true;
+      bdb->rnum -= rnum;
+      tcbdbstatadd(bdb, leaf->id, kbuf, ksiz, -rnum);
+      return false;
+    }
+  }
   TCFREE(tcptrlistremove(leaf->recs, ri));
   leaf->size -= rsiz;
   leaf->dirty = true;
   bdb->rnum -= rnum;
+  if(!tcbdbstatadd(bdb, leaf->id, kbuf, ksiz, -rnum)) return false;
   if(TCPTRLISTNUM(leaf->recs) < 1){
     if(hlid > 0 && hlid != tcbdbsearchleaf(bdb, kbuf, ksiz)) return false;
     if(bdb->hnum > 0 && !tcbdbleafkill(bdb, leaf)) return false;
@@ -3271,7 +4405,7 @@ static int tcbdbgetnum(TCBDB *bdb, const char *kbuf, int ksiz){
     tcbdbsetecode(bdb, TCENOREC, __FILE__, __LINE__, __func__);
     return 0;
   }
-  return rec->rest ? TCLISTNUM(rec->rest) + 1 : 1;
+  return tcbdbrecvnum(rec);
 }
 
 
@@ -3296,6 +4430,7 @@ static TCLIST *tcbdbgetlist(TCBDB *bdb, const char *kbuf, int ksiz){
   }
   TCLIST *vals;
   TCLIST *rest = rec->rest;
+  BDBOVFL *ovfl = rec->ovfl;
   if(rest){
     int ln = TCLISTNUM(rest);
     vals = tclistnew2(ln + 1);
@@ -3306,6 +4441,23 @@ static TCLIST *tcbdbgetlist(TCBDB *bdb, const char *kbuf, int ksiz){
       TCLISTVAL(vbuf, rest, i, vsiz);
       TCLISTPUSH(vals, vbuf, vsiz);
     }
+  } else if(ovfl){
+    vals = tclistnew2(ovfl->vnum + 1);
+    TCLISTPUSH(vals, (char *)rec + sizeof(*rec) + rec->ksiz + TCALIGNPAD(rec->ksiz), rec->vsiz);
+    for(int i = 0; i < ovfl->pnum; i++){
+      TCLIST *pvals = tcbdbovpgload(bdb, ovfl->pages[i].id);
+      if(!pvals){
+        tclistdel(vals);
+        return NULL;
+      }
+      int ln = TCLISTNUM(pvals);
+      for(int j = 0; j < ln; j++){
+        const char *vbuf;
+        int vsiz;
+        TCLISTVAL(vbuf, pvals, j, vsiz);
+        TCLISTPUSH(vals, vbuf, vsiz);
+      }
+    }
   } else {
     vals = tclistnew2(1);
     TCLISTPUSH(vals, (char *)rec + sizeof(*rec) + rec->ksiz + TCALIGNPAD(rec->ksiz), rec->vsiz);
@@ -3348,7 +4500,7 @@ static bool tcbdbrangeimpl(TCBDB *bdb, const char *bkbuf, int bksiz, bool binc,
     }
     if(bkbuf && !binc){
       if(cmp(kbuf, ksiz, bkbuf, bksiz, cmpop) == 0){
-        tcbdbcurnext(cur);
+        tcbdbcurnextimpl(cur);
         continue;
       }
       bkbuf = NULL;
@@ -3409,29 +4561,89 @@ static bool tcbdbrangefwm(TCBDB *bdb, const char *pbuf, int psiz, int max, TCLIS
 }
 
 
-/* Optimize the file of a B+ tree database object.
+/* Get the number of records before a key in a B+ tree database object.
    `bdb' specifies the B+ tree database object.
-   `lmemb' specifies the number of members in each leaf page.
-   `nmemb' specifies the number of members in each non-leaf page.
-   `bnum' specifies the number of elements of the bucket array.
-   `apow' specifies the size of record alignment by power of 2.
-   `fpow' specifies the maximum number of elements of the free block pool by power of 2.
-   `opts' specifies options by bitwise-or.
-   If successful, the return value is true, else, it is false. */
-static bool tcbdboptimizeimpl(TCBDB *bdb, int32_t lmemb, int32_t nmemb,
-                              int64_t bnum, int8_t apow, int8_t fpow, uint8_t opts){
-  assert(bdb);
-  const char *path = tchdbpath(bdb->hdb);
-  char *tpath = tcsprintf("%s%ctmp%c%llu", path, MYEXTCHR, MYEXTCHR, tchdbinode(bdb->hdb));
-  TCBDB *tbdb = tcbdbnew();
-  int dbgfd = tchdbdbgfd(bdb->hdb);
-  if(dbgfd >= 0) tcbdbsetdbgfd(tbdb, dbgfd);
-  tcbdbsetcmpfunc(tbdb, bdb->cmp, bdb->cmpop);
-  TCCODEC enc, dec;
-  void *encop, *decop;
-  tchdbcodecfunc(bdb->hdb, &enc, &encop, &dec, &decop);
-  if(enc && dec) tcbdbsetcodecfunc(tbdb, enc, encop, dec, decop);
-  if(lmemb < 1) lmemb = bdb->lmemb;
+   `kbuf' specifies the pointer to the region of the key.
+   `ksiz' specifies the size of the region of the key.
+   `inc' specifies whether the records of the key are counted or not.
+   `np' specifies the pointer to the variable into which the number is assigned.
+   If successful, the return value is true, else, it is false.
+   The nodes are descended with the numbers of records under their children.  If the database
+   has no such numbers, the leaves are scanned from the first one. */
+static bool tcbdbrankimpl(TCBDB *bdb, const char *kbuf, int ksiz, bool inc, uint64_t *np){
+  assert(bdb && kbuf && ksiz >= 0 && np);
+  uint64_t kpfx = tcbdbkeypfx(bdb, kbuf, ksiz);
+  uint64_t rank = 0;
+  uint64_t pid = bdb->root;
+  if(bdb->ostat){
+    while(pid > BDBNODEIDBASE){
+      BDBNODE *node = tcbdbnodeload(bdb, pid);
+      if(!node) return false;
+      int ci = tcbdbnodechild(bdb, node, kbuf, ksiz);
+      if(ci < 0){
+        pid = node->heir;
+        continue;
+      }
+      rank += node->hrnum;
+      TCPTRLIST *idxs = node->idxs;
+      for(int i = 0; i < ci; i++){
+        BDBIDX *idx = TCPTRLISTVAL(idxs, i);
+        rank += idx->rnum;
+      }
+      pid = ((BDBIDX *)TCPTRLISTVAL(idxs, ci))->pid;
+    }
+  } else {
+    pid = bdb->first;
+  }
+  while(pid > 0){
+    BDBLEAF *leaf = tcbdbleafload(bdb, pid);
+    if(!leaf) return false;
+    TCPTRLIST *recs = leaf->recs;
+    int ln = TCPTRLISTNUM(recs);
+    for(int i = 0; i < ln; i++){
+      BDBREC *rec = TCPTRLISTVAL(recs, i);
+      char *dbuf = (char *)rec + sizeof(*rec);
+      int rv;
+      BDBCMPKEY(rv, bdb, rec->pfx, dbuf, rec->ksiz, kpfx, kbuf, ksiz);
+      if(rv > 0 || (rv == 0 && !inc)){
+        *np = rank;
+        return true;
+      }
+      rank += tcbdbrecvnum(rec);
+    }
+    pid = bdb->ostat ? 0 : leaf->next;
+  }
+  *np = rank;
+  return true;
+}
+
+
+/* Optimize the file of a B+ tree database object.
+   `bdb' specifies the B+ tree database object.
+   `lmemb' specifies the number of members in each leaf page.
+   `nmemb' specifies the number of members in each non-leaf page.
+   `bnum' specifies the number of elements of the bucket array.
+   `apow' specifies the size of record alignment by power of 2.
+   `fpow' specifies the maximum number of elements of the free block pool by power of 2.
+   `opts' specifies options by bitwise-or.
+   If successful, the return value is true, else, it is false. */
+static bool tcbdboptimizeimpl(TCBDB *bdb, int32_t lmemb, int32_t nmemb,
+                              int64_t bnum, int8_t apow, int8_t fpow, uint8_t opts){
+  assert(bdb);
+  if(!tcbdbbufflush(bdb)) return false;
+  const char *path = tchdbpath(bdb->hdb);
+  char *tpath = tcsprintf("%s%ctmp%c%llu", path, MYEXTCHR, MYEXTCHR, tchdbinode(bdb->hdb));
+  TCBDB *tbdb = tcbdbnew();
+  int dbgfd = tchdbdbgfd(bdb->hdb);
+  if(dbgfd >= 0) tcbdbsetdbgfd(tbdb, dbgfd);
+  tcbdbsetcmpfunc(tbdb, bdb->cmp, bdb->cmpop);
+  bool par = bdb->ptnum > 1 && TCUSEPTHREAD;
+  if(par) tcbdbsetmutex(tbdb);
+  TCCODEC enc, dec;
+  void *encop, *decop;
+  tchdbcodecfunc(bdb->hdb, &enc, &encop, &dec, &decop);
+  if(enc && dec) tcbdbsetcodecfunc(tbdb, enc, encop, dec, decop);
+  if(lmemb < 1) lmemb = bdb->lmemb;
   if(nmemb < 1) nmemb = bdb->nmemb;
   if(bnum < 1) bnum = tchdbrnum(bdb->hdb) * 2 + 1;
   if(apow < 0) apow = tclog2l(tchdbalign(bdb->hdb));
@@ -3452,48 +4664,1517 @@ static bool tcbdboptimizeimpl(TCBDB *bdb, int32_t lmemb, int32_t nmemb,
     TCFREE(tpath);
     return false;
   }
-  memcpy(tcbdbopaque(tbdb), tcbdbopaque(bdb), BDBLEFTOPQSIZ);
+  memcpy(tcbdbopaque(tbdb), tcbdbopaque(bdb), BDBLEFTOPQSIZ);
+  bool err = false;
+  if(par){
+    if(!tcbdboptimizepar(bdb, tbdb)) err = true;
+  } else {
+    BDBPARCTX ctx;
+    tcbdbparinit(&ctx, bdb, bdb->rnum);
+    BDBCUR *cur = tcbdbcurnew(bdb);
+    tcbdbcurfirstimpl(cur);
+    const char *kbuf, *vbuf;
+    int ksiz, vsiz;
+    int cnt = 0;
+    while(!err && cur->id > 0 && tcbdbcurrecimpl(cur, &kbuf, &ksiz, &vbuf, &vsiz)){
+      if(!tcbdbputdup(tbdb, kbuf, ksiz, vbuf, vsiz)){
+        tcbdbsetecode(bdb, tcbdbecode(tbdb), __FILE__, __LINE__, __func__);
+        err = true;
+      }
+      tcbdbcurnextimpl(cur);
+      if((++cnt % 0xf == 0) && !tcbdbcacheadjust(bdb)) err = true;
+      if(!err && (bdb->pproc || bdb->plimit > 0) && cnt % 0xff == 0 &&
+         !tcbdbparstep(&ctx, 0xff)){
+        tcbdbsetecode(bdb, ctx.ecode, __FILE__, __LINE__, __func__);
+        err = true;
+      }
+    }
+    tcbdbcurdel(cur);
+    pthread_mutex_destroy(&ctx.mtx);
+  }
+  if(!tcbdbclose(tbdb)){
+    tcbdbsetecode(bdb, tcbdbecode(tbdb), __FILE__, __LINE__, __func__);
+    err = true;
+  }
+  bdb->lcnum = lcnum;
+  bdb->ncnum = ncnum;
+  tcbdbdel(tbdb);
+  if(unlink(path) == -1){
+    tcbdbsetecode(bdb, TCEUNLINK, __FILE__, __LINE__, __func__);
+    err = true;
+  }
+  if(rename(tpath, path) == -1){
+    tcbdbsetecode(bdb, TCERENAME, __FILE__, __LINE__, __func__);
+    err = true;
+  }
+  TCFREE(tpath);
+  if(err) return false;
+  tpath = tcstrdup(path);
+  int omode = (tchdbomode(bdb->hdb) & ~BDBOCREAT) & ~BDBOTRUNC;
+  if(!tcbdbcloseimpl(bdb)){
+    TCFREE(tpath);
+    return false;
+  }
+  bool rv = tcbdbopenimpl(bdb, tpath, omode);
+  TCFREE(tpath);
+  return rv;
+}
+
+
+/* Optimize a B+ tree database object by building partitions in parallel.
+   `bdb' specifies the B+ tree database object.
+   `tbdb' specifies the destination database object which is opened with mutual exclusion.
+   If successful, the return value is true, else, it is false.
+   Each partition consists of the leaves between the separator keys of upper nodes.  The leaves
+   and the nodes of each partition are made by bulk loading, and the roots of the partitions are
+   gathered under new nodes at last.  Thus, the depth of the tree can differ by partitions.
+   Reading the source is serialized unless the source has mutual exclusion control. */
+static bool tcbdboptimizepar(TCBDB *bdb, TCBDB *tbdb){
+  assert(bdb && tbdb);
+  if(!tcbdbmemsync(bdb, false)) return false;
+  int pnum;
+  uint64_t *starts = tcbdbleafparts(bdb, bdb->ptnum * BDBPARTMUL, &pnum);
+  if(!starts) return false;
+  BDBOPTPART *parts;
+  TCMALLOC(parts, sizeof(*parts) * pnum + 1);
+  for(int i = 0; i < pnum; i++){
+    BDBOPTPART *part = parts + i;
+    part->start = starts[i];
+    part->stop = (i < pnum - 1) ? starts[i+1] : 0;
+    part->leaf = NULL;
+    part->lvnum = 0;
+    part->first = 0;
+    part->last = 0;
+    part->root = 0;
+    part->kbuf = NULL;
+    part->ksiz = 0;
+    part->rnum = 0;
+  }
+  TCFREE(starts);
+  bool err = false;
+  BDBPARCTX ctx;
+  tcbdbparinit(&ctx, bdb, bdb->rnum);
+  ctx.tbdb = tbdb;
+  ctx.parts = parts;
+  ctx.pnum = pnum;
+  int tnum = tclmin(bdb->ptnum, pnum);
+  pthread_t *threads;
+  TCMALLOC(threads, sizeof(*threads) * tnum);
+  int cnt = 0;
+  while(cnt < tnum){
+    if(pthread_create(threads + cnt, NULL, tcbdboptimizethread, &ctx) != 0){
+      tcbdbparerr(&ctx, TCETHREAD);
+      break;
+    }
+    cnt++;
+  }
+  for(int i = 0; i < cnt; i++){
+    void *rv;
+    if(pthread_join(threads[i], &rv) != 0){
+      tcbdbparerr(&ctx, TCETHREAD);
+    } else if(rv){
+      err = true;
+    }
+  }
+  TCFREE(threads);
+  if(ctx.ecode != TCESUCCESS){
+    tcbdbsetecode(bdb, ctx.ecode, __FILE__, __LINE__, __func__);
+    err = true;
+  }
+  BDBOPTPART top;
+  top.leaf = NULL;
+  top.lvnum = 0;
+  top.root = 0;
+  top.rnum = 0;
+  BDBOPTPART *prev = NULL;
+  uint64_t rnum = 0;
+  for(int i = 0; !err && i < pnum; i++){
+    BDBOPTPART *part = parts + i;
+    if(part->first < 1) continue;
+    top.rnum = rnum;
+    rnum += part->rnum;
+    if(prev){
+      BDBLEAF *leaf = tcbdbleafload(tbdb, prev->last);
+      BDBLEAF *nleaf = leaf ? tcbdbleafload(tbdb, part->first) : NULL;
+      if(!nleaf){
+        tcbdbsetecode(bdb, tcbdbecode(tbdb), __FILE__, __LINE__, __func__);
+        err = true;
+        break;
+      }
+      leaf->next = part->first;
+      leaf->dirty = true;
+      nleaf->prev = prev->last;
+      nleaf->dirty = true;
+      if(!tcbdboptaddidx(&ctx, &top, 0, prev->root, part->root, part->kbuf, part->ksiz)){
+        tcbdbsetecode(bdb, ctx.ecode, __FILE__, __LINE__, __func__);
+        err = true;
+        break;
+      }
+      tcbdboptaddcnt(&top, part->rnum);
+    } else {
+      tbdb->first = part->first;
+    }
+    prev = part;
+  }
+  if(!tcbdboptfinish(&ctx, &top, !err)){
+    tcbdbsetecode(bdb, ctx.ecode, __FILE__, __LINE__, __func__);
+    err = true;
+  }
+  if(!err && prev){
+    BDBLEAF *leaf = tcbdbleafload(tbdb, tbdb->root);
+    if(leaf){
+      leaf->dead = true;
+      leaf->dirty = true;
+      tbdb->root = (top.root > 0) ? top.root : prev->root;
+      tbdb->last = prev->last;
+      tbdb->rnum = rnum;
+    } else {
+      tcbdbsetecode(bdb, tcbdbecode(tbdb), __FILE__, __LINE__, __func__);
+      err = true;
+    }
+  }
+  for(int i = 0; i < pnum; i++){
+    TCFREE(parts[i].kbuf);
+  }
+  TCFREE(parts);
+  pthread_mutex_destroy(&ctx.mtx);
+  return !err;
+}
+
+
+/* Process partitions of optimization in a worker thread.
+   `targ' specifies the pointer to the shared state.
+   The return value is `NULL' if successful or other on failure. */
+static void *tcbdboptimizethread(void *targ){
+  BDBPARCTX *ctx = targ;
+  TCBDB *bdb = ctx->bdb;
+  bool rlk = !bdb->mmtx;
+  bool err = false;
+  while(!err){
+    if(pthread_mutex_lock(&ctx->mtx) != 0){
+      tcbdbparerr(ctx, TCETHREAD);
+      err = true;
+      break;
+    }
+    int pi = ctx->cur++;
+    pthread_mutex_unlock(&ctx->mtx);
+    if(pi >= ctx->pnum) break;
+    BDBOPTPART *part = ctx->parts + pi;
+    uint64_t id = part->start;
+    while(!err && id > 0 && id != part->stop){
+      BDBLEAF leaf;
+      if(rlk && pthread_mutex_lock(&ctx->mtx) != 0){
+        tcbdbparerr(ctx, TCETHREAD);
+        err = true;
+        break;
+      }
+      bool rv = tcbdbleafread(bdb, id, &leaf);
+      if(rlk) pthread_mutex_unlock(&ctx->mtx);
+      if(!rv){
+        tcbdbparerr(ctx, TCEMISC);
+        err = true;
+        break;
+      }
+      uint64_t rnum = part->rnum;
+      TCPTRLIST *recs = leaf.recs;
+      int ln = TCPTRLISTNUM(recs);
+      for(int i = 0; i < ln; i++){
+        BDBREC *rec = TCPTRLISTVAL(recs, i);
+        if(!err && (!rec->ovfl || tcbdboptovfl(ctx, rec->ovfl, rlk)) &&
+           tcbdboptaddrec(ctx, part, rec)) continue;
+        if(rec->rest) tclistdel(rec->rest);
+        if(rec->ovfl) tcbdbovfldel(rec->ovfl);
+        TCFREE(rec);
+        err = true;
+      }
+      tcptrlistdel(recs);
+      if(!err && !tcbdbparstep(ctx, part->rnum - rnum)) err = true;
+      id = leaf.next;
+    }
+    if(!tcbdboptfinish(ctx, part, !err)) err = true;
+  }
+  return err ? "error" : NULL;
+}
+
+
+/* Create a new leaf of the destination of optimization.
+   `ctx' specifies the shared state.
+   `prev' specifies the ID number of the previous leaf.
+   The return value is the new leaf object, which is not cached. */
+static BDBLEAF *tcbdboptleafnew(BDBPARCTX *ctx, uint64_t prev){
+  assert(ctx);
+  TCBDB *tbdb = ctx->tbdb;
+  BDBLEAF *leaf;
+  TCMALLOC(leaf, sizeof(*leaf));
+  pthread_mutex_lock(&ctx->mtx);
+  leaf->id = ++tbdb->lnum;
+  pthread_mutex_unlock(&ctx->mtx);
+  leaf->recs = tcptrlistnew2(tbdb->lmemb + 1);
+  leaf->size = 0;
+  leaf->prev = prev;
+  leaf->next = 0;
+  leaf->dirty = true;
+  leaf->dead = false;
+  return leaf;
+}
+
+
+/* Create a new node of the destination of optimization.
+   `ctx' specifies the shared state.
+   `heir' specifies the ID of the child before the first index.
+   The return value is the new node object, which is not cached. */
+static BDBNODE *tcbdboptnodenew(BDBPARCTX *ctx, uint64_t heir){
+  assert(ctx && heir > 0);
+  TCBDB *tbdb = ctx->tbdb;
+  BDBNODE *node;
+  TCMALLOC(node, sizeof(*node));
+  pthread_mutex_lock(&ctx->mtx);
+  node->id = ++tbdb->nnum + BDBNODEIDBASE;
+  pthread_mutex_unlock(&ctx->mtx);
+  node->idxs = tcptrlistnew2(tbdb->nmemb + 1);
+  node->msgs = NULL;
+  node->msiz = 0;
+  node->heir = heir;
+  node->hrnum = 0;
+  node->dirty = true;
+  node->dead = false;
+  return node;
+}
+
+
+/* Append a record to a partition of optimization.
+   `ctx' specifies the shared state.
+   `part' specifies the partition.
+   `rec' specifies the record, whose ownership is moved to the partition if successful.
+   If successful, the return value is true, else, it is false. */
+static bool tcbdboptaddrec(BDBPARCTX *ctx, BDBOPTPART *part, BDBREC *rec){
+  assert(ctx && part && rec);
+  TCBDB *tbdb = ctx->tbdb;
+  char *dbuf = (char *)rec + sizeof(*rec);
+  int rsiz = rec->ksiz + rec->vsiz;
+  int rnum = 1;
+  TCLIST *rest = rec->rest;
+  if(rest){
+    int ln = TCLISTNUM(rest);
+    for(int i = 0; i < ln; i++){
+      rsiz += TCLISTVALSIZ(rest, i);
+    }
+    rnum += ln;
+  }
+  if(rec->ovfl) rnum += rec->ovfl->vnum;
+  BDBLEAF *leaf = part->leaf;
+  if(!leaf){
+    leaf = tcbdboptleafnew(ctx, 0);
+    part->leaf = leaf;
+    part->first = leaf->id;
+    TCMEMDUP(part->kbuf, dbuf, rec->ksiz);
+    part->ksiz = rec->ksiz;
+  } else {
+    int ln = TCPTRLISTNUM(leaf->recs);
+    if(ln >= tbdb->lmemb || (ln > 0 && leaf->size + rsiz > tbdb->lsmax)){
+      BDBLEAF *nleaf = tcbdboptleafnew(ctx, leaf->id);
+      leaf->next = nleaf->id;
+      part->leaf = nleaf;
+      bool err = false;
+      if(!tcbdbleafsave(tbdb, leaf)){
+        tcbdbparerr(ctx, tcbdbecode(tbdb));
+        err = true;
+      }
+      uint64_t lid = leaf->id;
+      TCPTRLIST *recs = leaf->recs;
+      for(int i = 0; i < ln; i++){
+        BDBREC *orec = TCPTRLISTVAL(recs, i);
+        if(orec->rest) tclistdel(orec->rest);
+        if(orec->ovfl) tcbdbovfldel(orec->ovfl);
+        TCFREE(orec);
+      }
+      tcptrlistdel(recs);
+      TCFREE(leaf);
+      leaf = nleaf;
+      if(!tcbdboptaddidx(ctx, part, 0, lid, leaf->id, dbuf, rec->ksiz)) err = true;
+      if(err) return false;
+    }
+  }
+  TCPTRLISTPUSH(leaf->recs, rec);
+  leaf->size += rsiz;
+  part->last = leaf->id;
+  part->rnum += rnum;
+  tcbdboptaddcnt(part, rnum);
+  return true;
+}
+
+
+/* Copy the overflow pages of a record to the destination of optimization.
+   `ctx' specifies the shared state.
+   `ovfl' specifies the overflowed values, whose references are replaced with the copies.
+   `rlk' specifies whether reading the source is serialized by the shared mutex.
+   If successful, the return value is true, else, it is false. */
+static bool tcbdboptovfl(BDBPARCTX *ctx, BDBOVFL *ovfl, bool rlk){
+  assert(ctx && ovfl);
+  TCBDB *bdb = ctx->bdb;
+  TCBDB *tbdb = ctx->tbdb;
+  for(int i = 0; i < ovfl->pnum; i++){
+    BDBOVPG *page = ovfl->pages + i;
+    char hbuf[(sizeof(uint64_t)+1)*3];
+    int step = sprintf(hbuf, "+%llx", (unsigned long long)page->id);
+    if(rlk && pthread_mutex_lock(&ctx->mtx) != 0){
+      tcbdbparerr(ctx, TCETHREAD);
+      return false;
+    }
+    int rsiz;
+    char *rbuf = tchdbget(bdb->hdb, hbuf, step, &rsiz);
+    if(rlk) pthread_mutex_unlock(&ctx->mtx);
+    if(!rbuf){
+      tcbdbparerr(ctx, TCEMISC);
+      return false;
+    }
+    pthread_mutex_lock(&ctx->mtx);
+    page->id = ++tbdb->pnum;
+    pthread_mutex_unlock(&ctx->mtx);
+    step = sprintf(hbuf, "+%llx", (unsigned long long)page->id);
+    bool rv = tchdbput(tbdb->hdb, hbuf, step, rbuf, rsiz);
+    TCFREE(rbuf);
+    if(!rv){
+      tcbdbparerr(ctx, tchdbecode(tbdb->hdb));
+      return false;
+    }
+  }
+  return true;
+}
+
+
+/* Append an index to a node of a partition of optimization.
+   `ctx' specifies the shared state.
+   `part' specifies the partition.
+   `lv' specifies the level of the node.
+   `prev' specifies the ID number of the page before the referred page.
+   `pid' specifies the ID number of the referred page.
+   `kbuf' specifies the pointer to the region of the key.
+   `ksiz' specifies the size of the region of the key.
+   If successful, the return value is true, else, it is false. */
+static bool tcbdboptaddidx(BDBPARCTX *ctx, BDBOPTPART *part, int lv, uint64_t prev, uint64_t pid,
+                           const char *kbuf, int ksiz){
+  assert(ctx && part && lv >= 0 && prev > 0 && pid > 0 && kbuf && ksiz >= 0);
+  TCBDB *tbdb = ctx->tbdb;
+  if(lv >= BDBLEVELMAX){
+    tcbdbparerr(ctx, TCEMISC);
+    return false;
+  }
+  BDBNODE *node = part->nodes[lv];
+  if(lv >= part->lvnum){
+    node = tcbdboptnodenew(ctx, prev);
+    node->hrnum = part->rnum;
+    part->nodes[lv] = node;
+    part->lvnum = lv + 1;
+  } else if(TCPTRLISTNUM(node->idxs) >= tbdb->nmemb){
+    BDBNODE *nnode = tcbdboptnodenew(ctx, pid);
+    part->nodes[lv] = nnode;
+    bool err = false;
+    if(!tcbdbnodesave(tbdb, node)){
+      tcbdbparerr(ctx, tcbdbecode(tbdb));
+      err = true;
+    }
+    uint64_t nid = node->id;
+    TCPTRLIST *idxs = node->idxs;
+    int ln = TCPTRLISTNUM(idxs);
+    for(int i = 0; i < ln; i++){
+      TCFREE(TCPTRLISTVAL(idxs, i));
+    }
+    tcptrlistdel(idxs);
+    TCFREE(node);
+    if(!tcbdboptaddidx(ctx, part, lv + 1, nid, nnode->id, kbuf, ksiz)) err = true;
+    return !err;
+  }
+  tcbdbnodeaddidx(tbdb, node, true, pid, 0, kbuf, ksiz);
+  return true;
+}
+
+
+/* Count records under the last pages of a partition of optimization.
+   `part' specifies the partition.
+   `rnum' specifies the number of the added records. */
+static void tcbdboptaddcnt(BDBOPTPART *part, uint64_t rnum){
+  assert(part);
+  for(int i = 0; i < part->lvnum; i++){
+    BDBNODE *node = part->nodes[i];
+    int ln = TCPTRLISTNUM(node->idxs);
+    if(ln > 0){
+      BDBIDX *idx = TCPTRLISTVAL(node->idxs, ln - 1);
+      idx->rnum += rnum;
+    } else {
+      node->hrnum += rnum;
+    }
+  }
+}
+
+
+/* Store the pages being filled of a partition of optimization.
+   `ctx' specifies the shared state.
+   `part' specifies the partition.
+   `save' specifies whether to save the pages or to discard them.
+   If successful, the return value is true, else, it is false. */
+static bool tcbdboptfinish(BDBPARCTX *ctx, BDBOPTPART *part, bool save){
+  assert(ctx && part);
+  TCBDB *tbdb = ctx->tbdb;
+  bool err = false;
+  BDBLEAF *leaf = part->leaf;
+  if(leaf){
+    if(save && !tcbdbleafsave(tbdb, leaf)){
+      tcbdbparerr(ctx, tcbdbecode(tbdb));
+      err = true;
+    }
+    part->root = leaf->id;
+    TCPTRLIST *recs = leaf->recs;
+    int ln = TCPTRLISTNUM(recs);
+    for(int i = 0; i < ln; i++){
+      BDBREC *rec = TCPTRLISTVAL(recs, i);
+      if(rec->rest) tclistdel(rec->rest);
+      if(rec->ovfl) tcbdbovfldel(rec->ovfl);
+      TCFREE(rec);
+    }
+    tcptrlistdel(recs);
+    TCFREE(leaf);
+    part->leaf = NULL;
+  }
+  for(int i = 0; i < part->lvnum; i++){
+    BDBNODE *node = part->nodes[i];
+    if(save && !tcbdbnodesave(tbdb, node)){
+      tcbdbparerr(ctx, tcbdbecode(tbdb));
+      err = true;
+    }
+    part->root = node->id;
+    TCPTRLIST *idxs = node->idxs;
+    int ln = TCPTRLISTNUM(idxs);
+    for(int j = 0; j < ln; j++){
+      TCFREE(TCPTRLISTVAL(idxs, j));
+    }
+    tcptrlistdel(idxs);
+    TCFREE(node);
+  }
+  part->lvnum = 0;
+  return !err;
+}
+
+
+/* Copy the database file of a B+ tree database object in parallel.
+   `bdb' specifies the B+ tree database object.
+   `path' specifies the path of the destination file.
+   If successful, the return value is true, else, it is false. */
+static bool tcbdbcopypar(TCBDB *bdb, const char *path){
+  assert(bdb && path);
+  int ifd = open(tchdbpath(bdb->hdb), O_RDONLY, BDBFILEMODE);
+  if(ifd == -1){
+    tcbdbsetecode(bdb, TCEOPEN, __FILE__, __LINE__, __func__);
+    return false;
+  }
+  struct stat sbuf;
+  if(fstat(ifd, &sbuf) == -1){
+    tcbdbsetecode(bdb, TCESTAT, __FILE__, __LINE__, __func__);
+    close(ifd);
+    return false;
+  }
+  int ofd = open(path, O_WRONLY | O_CREAT | O_TRUNC, BDBFILEMODE);
+  if(ofd == -1){
+    tcbdbsetecode(bdb, TCEOPEN, __FILE__, __LINE__, __func__);
+    close(ifd);
+    return false;
+  }
+  bool err = false;
+  if(ftruncate(ofd, sbuf.st_size) == -1){
+    tcbdbsetecode(bdb, TCETRUNC, __FILE__, __LINE__, __func__);
+    err = true;
+  }
+  BDBPARCTX ctx;
+  tcbdbparinit(&ctx, bdb, sbuf.st_size);
+  ctx.ifd = ifd;
+  ctx.ofd = ofd;
+  int tnum = bdb->ptnum;
+  pthread_t *threads;
+  TCMALLOC(threads, sizeof(*threads) * tnum);
+  int cnt = 0;
+  while(!err && cnt < tnum){
+    if(pthread_create(threads + cnt, NULL, tcbdbcopythread, &ctx) != 0){
+      tcbdbparerr(&ctx, TCETHREAD);
+      break;
+    }
+    cnt++;
+  }
+  for(int i = 0; i < cnt; i++){
+    void *rv;
+    if(pthread_join(threads[i], &rv) != 0) tcbdbparerr(&ctx, TCETHREAD);
+  }
+  TCFREE(threads);
+  pthread_mutex_destroy(&ctx.mtx);
+  if(ctx.ecode != TCESUCCESS){
+    tcbdbsetecode(bdb, ctx.ecode, __FILE__, __LINE__, __func__);
+    err = true;
+  }
+  if(close(ofd) == -1){
+    tcbdbsetecode(bdb, TCECLOSE, __FILE__, __LINE__, __func__);
+    err = true;
+  }
+  if(close(ifd) == -1){
+    tcbdbsetecode(bdb, TCECLOSE, __FILE__, __LINE__, __func__);
+    err = true;
+  }
+  if(!err){
+    TCHDB *hdb = tchdbnew();
+    if(!tchdbopen(hdb, path, HDBOWRITER | HDBONOLCK) || !tchdbclose(hdb)){
+      tcbdbsetecode(bdb, tchdbecode(hdb), __FILE__, __LINE__, __func__);
+      err = true;
+    }
+    tchdbdel(hdb);
+  }
+  return !err;
+}
+
+
+/* Copy chunks of a database file in a worker thread.
+   `targ' specifies the pointer to the shared state.
+   The return value is `NULL' if successful or other on failure. */
+static void *tcbdbcopythread(void *targ){
+  BDBPARCTX *ctx = targ;
+  char *buf;
+  TCMALLOC(buf, BDBCOPYBUFSIZ);
+  bool err = false;
+  while(!err){
+    if(pthread_mutex_lock(&ctx->mtx) != 0){
+      tcbdbparerr(ctx, TCETHREAD);
+      err = true;
+      break;
+    }
+    int64_t off = ctx->cur;
+    ctx->cur += BDBCOPYUNIT;
+    pthread_mutex_unlock(&ctx->mtx);
+    if(off >= ctx->total) break;
+    int64_t end = tclmin(off + BDBCOPYUNIT, ctx->total);
+    while(off < end){
+      int size = tclmin(end - off, BDBCOPYBUFSIZ);
+      int rb = pread(ctx->ifd, buf, size, off);
+      if(rb < 1){
+        if(rb == -1 && errno == EINTR) continue;
+        tcbdbparerr(ctx, TCEREAD);
+        err = true;
+        break;
+      }
+      const char *rp = buf;
+      int64_t woff = off;
+      int wsiz = rb;
+      while(wsiz > 0){
+        int wb = pwrite(ctx->ofd, rp, wsiz, woff);
+        if(wb == -1){
+          if(errno == EINTR) continue;
+          tcbdbparerr(ctx, TCEWRITE);
+          err = true;
+          break;
+        }
+        rp += wb;
+        woff += wb;
+        wsiz -= wb;
+      }
+      if(err) break;
+      off += rb;
+      if(!tcbdbparstep(ctx, rb)){
+        err = true;
+        break;
+      }
+    }
+  }
+  TCFREE(buf);
+  return err ? "error" : NULL;
+}
+
+
+/* Initialize the shared state of parallel maintenance.
+   `ctx' specifies the shared state.
+   `bdb' specifies the B+ tree database object.
+   `total' specifies the total amount of data. */
+static void tcbdbparinit(BDBPARCTX *ctx, TCBDB *bdb, int64_t total){
+  assert(ctx && bdb);
+  ctx->bdb = bdb;
+  ctx->tbdb = NULL;
+  pthread_mutex_init(&ctx->mtx, NULL);
+  ctx->parts = NULL;
+  ctx->pnum = 0;
+  ctx->ifd = -1;
+  ctx->ofd = -1;
+  ctx->cur = 0;
+  ctx->done = 0;
+  ctx->total = total;
+  ctx->stime = tctime();
+  ctx->ecode = TCESUCCESS;
+}
+
+
+/* Report progress of parallel maintenance and throttle it.
+   `ctx' specifies the shared state.
+   `inc' specifies the amount of newly processed data.
+   The return value is true to continue the process or false to stop it. */
+static bool tcbdbparstep(BDBPARCTX *ctx, int64_t inc){
+  assert(ctx && inc >= 0);
+  TCBDB *bdb = ctx->bdb;
+  if(pthread_mutex_lock(&ctx->mtx) != 0) return false;
+  ctx->done += inc;
+  int64_t done = ctx->done;
+  bool cont = ctx->ecode == TCESUCCESS;
+  if(cont && bdb->pproc && !bdb->pproc(done, ctx->total, bdb->pop)){
+    ctx->ecode = TCEMISC;
+    cont = false;
+  }
+  pthread_mutex_unlock(&ctx->mtx);
+  if(cont && bdb->plimit > 0){
+    double wsec = (double)done / bdb->plimit - (tctime() - ctx->stime);
+    if(wsec > 0) tcsleep(wsec);
+  }
+  return cont;
+}
+
+
+/* Record an error of parallel maintenance.
+   `ctx' specifies the shared state.
+   `ecode' specifies the error code. */
+static void tcbdbparerr(BDBPARCTX *ctx, int ecode){
+  assert(ctx);
+  pthread_mutex_lock(&ctx->mtx);
+  if(ctx->ecode == TCESUCCESS) ctx->ecode = (ecode != TCESUCCESS) ? ecode : TCEMISC;
+  pthread_mutex_unlock(&ctx->mtx);
+}
+
+
+/* Divide the leaves of a B+ tree database object into partitions.
+   `bdb' specifies the B+ tree database object.
+   `pmax' specifies the maximum number of partitions.
+   `np' specifies the pointer to the variable into which the number of partitions is assigned.
+   If successful, the return value is the array of the ID numbers of the first leaves of the
+   partitions in ascending order of keys, else, it is `NULL'.  Because the region of the return
+   value is allocated with the `malloc' call, it should be released with the `free' call.
+   Nodes are expanded level by level until there are `pmax' pages at least, and the partitions
+   begin at the leftmost leaves under pages taken at even intervals. */
+static uint64_t *tcbdbleafparts(TCBDB *bdb, int pmax, int *np){
+  assert(bdb && pmax > 0 && np);
+  TCLIST *pids = tclistnew();
+  TCLISTPUSH(pids, &(bdb->root), sizeof(bdb->root));
+  bool err = false;
+  bool deep = bdb->root > BDBNODEIDBASE;
+  while(!err && deep && TCLISTNUM(pids) < pmax){
+    TCLIST *npids = tclistnew2(TCLISTNUM(pids) * (bdb->nmemb + 1));
+    deep = false;
+    for(int i = 0; i < TCLISTNUM(pids); i++){
+      uint64_t pid = *(uint64_t *)TCLISTVALPTR(pids, i);
+      if(pid <= BDBNODEIDBASE){
+        TCLISTPUSH(npids, &pid, sizeof(pid));
+        continue;
+      }
+      BDBNODE *node = tcbdbnodeload(bdb, pid);
+      if(!node){
+        err = true;
+        break;
+      }
+      TCLISTPUSH(npids, &(node->heir), sizeof(node->heir));
+      if(node->heir > BDBNODEIDBASE) deep = true;
+      TCPTRLIST *idxs = node->idxs;
+      int ln = TCPTRLISTNUM(idxs);
+      for(int j = 0; j < ln; j++){
+        BDBIDX *idx = TCPTRLISTVAL(idxs, j);
+        TCLISTPUSH(npids, &(idx->pid), sizeof(idx->pid));
+        if(idx->pid > BDBNODEIDBASE) deep = true;
+      }
+    }
+    tclistdel(pids);
+    pids = npids;
+  }
+  int cnum = TCLISTNUM(pids);
+  int pnum = tclmin(cnum, pmax);
+  uint64_t *starts;
+  TCMALLOC(starts, sizeof(*starts) * pnum + 1);
+  for(int i = 0; !err && i < pnum; i++){
+    uint64_t pid = *(uint64_t *)TCLISTVALPTR(pids, (int)((int64_t)i * cnum / pnum));
+    while(pid > BDBNODEIDBASE){
+      BDBNODE *node = tcbdbnodeload(bdb, pid);
+      if(!node){
+        err = true;
+        break;
+      }
+      pid = node->heir;
+    }
+    starts[i] = pid;
+  }
+  tclistdel(pids);
+  if(err){
+    TCFREE(starts);
+    return NULL;
+  }
+  *np = pnum;
+  return starts;
+}
+
+
+/* Get the index of the child of a node corresponding a key.
+   `bdb' specifies the B+ tree database object.
+   `node' specifies the node object.
+   `kbuf' specifies the pointer to the region of the key.
+   `ksiz' specifies the size of the region of the key.
+   The return value is the index of the page index referring the child or -1 if the child is
+   the heir. */
+static int tcbdbnodechild(TCBDB *bdb, BDBNODE *node, const char *kbuf, int ksiz){
+  assert(bdb && node && kbuf && ksiz >= 0);
+  uint64_t kpfx = tcbdbkeypfx(bdb, kbuf, ksiz);
+  TCPTRLIST *idxs = node->idxs;
+  int left = 0;
+  int right = TCPTRLISTNUM(idxs);
+  while(left < right){
+    int mid = (left + right) / 2;
+    BDBIDX *idx = TCPTRLISTVAL(idxs, mid);
+    char *ebuf = (char *)idx + sizeof(*idx);
+    int rv;
+    BDBCMPKEY(rv, bdb, kpfx, kbuf, ksiz, idx->pfx, ebuf, idx->ksiz);
+    if(rv < 0){
+      right = mid;
+    } else {
+      left = mid + 1;
+    }
+  }
+  return left - 1;
+}
+
+
+/* Add a message to the buffer of a node.
+   `bdb' specifies the B+ tree database object.
+   `node' specifies the node object.
+   `kbuf' specifies the pointer to the region of the key.
+   `ksiz' specifies the size of the region of the key.
+   `mbuf' specifies the pointer to the region of the message.
+   `msiz' specifies the size of the region of the message.
+   The message is merged after the older message of the same key if it exists. */
+static void tcbdbbufadd(TCBDB *bdb, BDBNODE *node, const char *kbuf, int ksiz,
+                        const char *mbuf, int msiz){
+  assert(bdb && node && kbuf && ksiz >= 0 && mbuf && msiz > 0);
+  if(!node->msgs) node->msgs = tctreenew2(bdb->cmp, bdb->cmpop);
+  int osiz;
+  const char *obuf = tctreeget(node->msgs, kbuf, ksiz, &osiz);
+  if(obuf){
+    int nsiz;
+    char *nbuf = tcbdbmsgmerge(obuf, osiz, mbuf, msiz, &nsiz);
+    tctreeput(node->msgs, kbuf, ksiz, nbuf, nsiz);
+    node->msiz += nsiz - osiz;
+    TCFREE(nbuf);
+  } else {
+    tctreeput(node->msgs, kbuf, ksiz, mbuf, msiz);
+    node->msiz += ksiz + msiz;
+  }
+  node->dirty = true;
+  tcmapputkeep(bdb->bnodes, &(node->id), sizeof(node->id), "", 0);
+}
+
+
+/* Move buffered messages of a node into its new sibling.
+   `bdb' specifies the B+ tree database object.
+   `node' specifies the node object which has been divided.
+   `newnode' specifies the new node object.
+   `kbuf' specifies the pointer to the region of the separator key of the new node.
+   `ksiz' specifies the size of the region of the separator key of the new node. */
+static void tcbdbbufdivide(TCBDB *bdb, BDBNODE *node, BDBNODE *newnode,
+                           const char *kbuf, int ksiz){
+  assert(bdb && node && newnode && kbuf && ksiz >= 0);
+  TCTREE *msgs = node->msgs;
+  TCLIST *keys = tclistnew();
+  tctreeiterinit2(msgs, kbuf, ksiz);
+  const char *mkbuf;
+  int mksiz;
+  while((mkbuf = tctreeiternext(msgs, &mksiz)) != NULL){
+    int msiz;
+    const char *mbuf = tctreeiterval(mkbuf, &msiz);
+    tcbdbbufadd(bdb, newnode, mkbuf, mksiz, mbuf, msiz);
+    node->msiz -= mksiz + msiz;
+    TCLISTPUSH(keys, mkbuf, mksiz);
+  }
+  int ln = TCLISTNUM(keys);
+  for(int i = 0; i < ln; i++){
+    TCLISTVAL(mkbuf, keys, i, mksiz);
+    tctreeout(msgs, mkbuf, mksiz);
+  }
+  tclistdel(keys);
+}
+
+
+/* Post a message to the buffer of the root node.
+   `bdb' specifies the B+ tree database object.
+   `kbuf' specifies the pointer to the region of the key.
+   `ksiz' specifies the size of the region of the key.
+   `op' specifies the operation of the message.
+   `vbuf' specifies the pointer to the region of the value.
+   `vsiz' specifies the size of the region of the value.
+   If successful, the return value is true, else, it is false. */
+static bool tcbdbbufpost(TCBDB *bdb, const char *kbuf, int ksiz, int op,
+                         const char *vbuf, int vsiz){
+  assert(bdb && kbuf && ksiz >= 0 && vbuf && vsiz >= 0);
+  BDBNODE *node = tcbdbnodeload(bdb, bdb->root);
+  if(!node) return false;
+  char stack[BDBPAGEBUFSIZ];
+  char *mbuf;
+  if(vsiz < sizeof(stack) - TCNUMBUFSIZ){
+    mbuf = stack;
+  } else {
+    TCMALLOC(mbuf, vsiz + TCNUMBUFSIZ);
+  }
+  int msiz = tcbdbmsgpush(mbuf, 0, op, vbuf, vsiz);
+  tcbdbbufadd(bdb, node, kbuf, ksiz, mbuf, msiz);
+  if(mbuf != stack) TCFREE(mbuf);
+  bool err = false;
+  if(node->msiz > bdb->bsiz && !tcbdbbufdrain(bdb, node->id, false)) err = true;
+  if(!bdb->tran && !tcbdbcacheadjust(bdb)) err = true;
+  return !err;
+}
+
+
+/* Move buffered messages of a node down to its children.
+   `bdb' specifies the B+ tree database object.
+   `id' specifies the ID number of the node.
+   `all' specifies whether to move all messages or to move the messages of the child with the
+   most data while the buffer overflows.
+   If successful, the return value is true, else, it is false.
+   Messages moved to a leaf are applied to the records.  Messages moved to a node are merged
+   after the older messages there. */
+static bool tcbdbbufdrain(TCBDB *bdb, uint64_t id, bool all){
+  assert(bdb && id > BDBNODEIDBASE);
+  bool err = false;
+  while(!err){
+    BDBNODE *node = tcbdbnodeload(bdb, id);
+    if(!node) return false;
+    TCTREE *msgs = node->msgs;
+    if(!msgs || tctreernum(msgs) < 1){
+      if(msgs){
+        tctreedel(msgs);
+        node->msgs = NULL;
+        node->msiz = 0;
+      }
+      tcmapout(bdb->bnodes, &id, sizeof(id));
+      break;
+    }
+    if(!all && node->msiz <= bdb->bsiz) break;
+    TCPTRLIST *idxs = node->idxs;
+    int ln = TCPTRLISTNUM(idxs);
+    const char *kbuf;
+    int ksiz;
+    int ci;
+    tctreeiterinit(msgs);
+    if(all){
+      kbuf = tctreeiternext(msgs, &ksiz);
+      ci = tcbdbnodechild(bdb, node, kbuf, ksiz);
+    } else {
+      int *sizs;
+      TCMALLOC(sizs, sizeof(*sizs) * (ln + 1));
+      memset(sizs, 0, sizeof(*sizs) * (ln + 1));
+      int cur = -1;
+      while((kbuf = tctreeiternext(msgs, &ksiz)) != NULL){
+        uint64_t kpfx = tcbdbkeypfx(bdb, kbuf, ksiz);
+        while(cur + 1 < ln){
+          BDBIDX *idx = TCPTRLISTVAL(idxs, cur + 1);
+          char *ebuf = (char *)idx + sizeof(*idx);
+          int rv;
+          BDBCMPKEY(rv, bdb, kpfx, kbuf, ksiz, idx->pfx, ebuf, idx->ksiz);
+          if(rv < 0) break;
+          cur++;
+        }
+        int msiz;
+        tctreeiterval(kbuf, &msiz);
+        sizs[cur+1] += ksiz + msiz;
+      }
+      ci = -1;
+      for(int i = 1; i <= ln; i++){
+        if(sizs[i] > sizs[ci+1]) ci = i - 1;
+      }
+      TCFREE(sizs);
+    }
+    uint64_t pid;
+    if(ci >= 0){
+      BDBIDX *idx = TCPTRLISTVAL(idxs, ci);
+      pid = idx->pid;
+      tctreeiterinit2(msgs, (char *)idx + sizeof(*idx), idx->ksiz);
+    } else {
+      pid = node->heir;
+      tctreeiterinit(msgs);
+    }
+    BDBIDX *uidx = (ci + 1 < ln) ? TCPTRLISTVAL(idxs, ci + 1) : NULL;
+    TCLIST *batch = tclistnew();
+    while((kbuf = tctreeiternext(msgs, &ksiz)) != NULL){
+      if(uidx){
+        uint64_t kpfx = tcbdbkeypfx(bdb, kbuf, ksiz);
+        char *ebuf = (char *)uidx + sizeof(*uidx);
+        int rv;
+        BDBCMPKEY(rv, bdb, kpfx, kbuf, ksiz, uidx->pfx, ebuf, uidx->ksiz);
+        if(rv >= 0) break;
+      }
+      int msiz;
+      const char *mbuf = tctreeiterval(kbuf, &msiz);
+      TCLISTPUSH(batch, kbuf, ksiz);
+      TCLISTPUSH(batch, mbuf, msiz);
+    }
+    int bnum = TCLISTNUM(batch);
+    for(int i = 0; i < bnum; i += 2){
+      TCLISTVAL(kbuf, batch, i, ksiz);
+      node->msiz -= ksiz + TCLISTVALSIZ(batch, i + 1);
+      tctreeout(msgs, kbuf, ksiz);
+    }
+    node->dirty = true;
+    if(pid > BDBNODEIDBASE){
+      BDBNODE *child = tcbdbnodeload(bdb, pid);
+      if(child){
+        for(int i = 0; i < bnum; i += 2){
+          TCLISTVAL(kbuf, batch, i, ksiz);
+          tcbdbbufadd(bdb, child, kbuf, ksiz,
+                      TCLISTVALPTR(batch, i + 1), TCLISTVALSIZ(batch, i + 1));
+        }
+        if(!all && child->msiz > bdb->bsiz && !tcbdbbufdrain(bdb, pid, false)) err = true;
+      } else {
+        err = true;
+      }
+    } else {
+      for(int i = 0; !err && i < bnum; i += 2){
+        TCLISTVAL(kbuf, batch, i, ksiz);
+        if(!tcbdbbufapply(bdb, kbuf, ksiz,
+                          TCLISTVALPTR(batch, i + 1), TCLISTVALSIZ(batch, i + 1))) err = true;
+      }
+    }
+    tclistdel(batch);
+  }
+  return !err;
+}
+
+
+/* Apply all buffered messages of a B+ tree database object.
+   `bdb' specifies the B+ tree database object.
+   If successful, the return value is true, else, it is false. */
+static bool tcbdbbufflush(TCBDB *bdb){
+  assert(bdb);
+  if(!bdb->wmode) return true;
+  TCMAP *bnodes = bdb->bnodes;
+  while(TCMAPRNUM(bnodes) > 0){
+    tcmapiterinit(bnodes);
+    int rsiz;
+    const char *rp = tcmapiternext(bnodes, &rsiz);
+    uint64_t id;
+    memcpy(&id, rp, sizeof(id));
+    if(!tcbdbbufdrain(bdb, id, true)) return false;
+  }
+  return true;
+}
+
+
+/* Apply buffered messages of a key.
+   `bdb' specifies the B+ tree database object.
+   `kbuf' specifies the pointer to the region of the key.
+   `ksiz' specifies the size of the region of the key.
+   If successful, the return value is true, else, it is false. */
+static bool tcbdbbufsettle(TCBDB *bdb, const char *kbuf, int ksiz){
+  assert(bdb && kbuf && ksiz >= 0);
+  if(TCMAPRNUM(bdb->bnodes) < 1) return true;
+  if(tcbdbsearchleaf(bdb, kbuf, ksiz) < 1) return false;
+  int hnum = bdb->hnum;
+  char *mbuf = NULL;
+  int msiz = 0;
+  for(int i = 0; i < hnum; i++){
+    BDBNODE *node = tcbdbnodeload(bdb, bdb->hist[i]);
+    if(!node){
+      TCFREE(mbuf);
+      return false;
+    }
+    if(!node->msgs) continue;
+    int osiz;
+    const char *obuf = tctreeget(node->msgs, kbuf, ksiz, &osiz);
+    if(!obuf) continue;
+    if(mbuf){
+      int nsiz;
+      char *nbuf = tcbdbmsgmerge(obuf, osiz, mbuf, msiz, &nsiz);
+      TCFREE(mbuf);
+      mbuf = nbuf;
+      msiz = nsiz;
+    } else {
+      TCMEMDUP(mbuf, obuf, osiz);
+      msiz = osiz;
+    }
+    node->msiz -= ksiz + osiz;
+    tctreeout(node->msgs, kbuf, ksiz);
+    node->dirty = true;
+  }
+  if(!mbuf) return true;
+  bool rv = tcbdbbufapply(bdb, kbuf, ksiz, mbuf, msiz);
+  TCFREE(mbuf);
+  return rv;
+}
+
+
+/* Get the latest buffered operation of a key.
+   `bdb' specifies the B+ tree database object.
+   `kbuf' specifies the pointer to the region of the key.
+   `ksiz' specifies the size of the region of the key.
+   `vbp' specifies the pointer to the variable into which the pointer to the value of the
+   operation is assigned.
+   `vsp' specifies the pointer to the variable into which the size of the value is assigned.
+   The return value is the operation or -1 if no message of the key is buffered. */
+static int tcbdbbufpeek(TCBDB *bdb, const char *kbuf, int ksiz, const char **vbp, int *vsp){
+  assert(bdb && kbuf && ksiz >= 0 && vbp && vsp);
+  if(TCMAPRNUM(bdb->bnodes) < 1) return -1;
+  if(tcbdbsearchleaf(bdb, kbuf, ksiz) < 1) return -1;
+  for(int i = 0; i < bdb->hnum; i++){
+    BDBNODE *node = tcbdbnodeload(bdb, bdb->hist[i]);
+    if(!node) return -1;
+    if(!node->msgs) continue;
+    int msiz;
+    const char *rp = tctreeget(node->msgs, kbuf, ksiz, &msiz);
+    if(!rp) continue;
+    const char *ep = rp + msiz;
+    int op = -1;
+    while(rp < ep){
+      op = *(unsigned char *)(rp++);
+      int vsiz, step;
+      TCREADVNUMBUF(rp, vsiz, step);
+      rp += step;
+      *vbp = rp;
+      *vsp = vsiz;
+      rp += vsiz;
+    }
+    return op;
+  }
+  return -1;
+}
+
+
+/* Apply a message to the record of a key.
+   `bdb' specifies the B+ tree database object.
+   `kbuf' specifies the pointer to the region of the key.
+   `ksiz' specifies the size of the region of the key.
+   `mbuf' specifies the pointer to the region of the message.
+   `msiz' specifies the size of the region of the message.
+   If successful, the return value is true, else, it is false. */
+static bool tcbdbbufapply(TCBDB *bdb, const char *kbuf, int ksiz, const char *mbuf, int msiz){
+  assert(bdb && kbuf && ksiz >= 0 && mbuf && msiz >= 0);
+  const char *ep = mbuf + msiz;
+  bool err = false;
+  while(!err && mbuf < ep){
+    int op = *(unsigned char *)(mbuf++);
+    int vsiz, step;
+    TCREADVNUMBUF(mbuf, vsiz, step);
+    mbuf += step;
+    if(op == BDBMSGPUT){
+      if(!tcbdbputimpl(bdb, kbuf, ksiz, mbuf, vsiz, BDBPDOVER)) err = true;
+    } else if(op == BDBMSGCAT){
+      if(!tcbdbputimpl(bdb, kbuf, ksiz, mbuf, vsiz, BDBPDCAT)) err = true;
+    } else {
+      uint64_t pid = tcbdbsearchleaf(bdb, kbuf, ksiz);
+      BDBLEAF *leaf = (pid > 0) ? tcbdbleafload(bdb, pid) : NULL;
+      if(leaf){
+        int ri;
+        BDBREC *rec = tcbdbsearchrec(bdb, leaf, kbuf, ksiz, &ri);
+        if(rec){
+          if(!tcbdbremoverec(bdb, leaf, rec, ri) ||
+             !tcbdbstatadd(bdb, leaf->id, kbuf, ksiz, -1)) err = true;
+          leaf->dirty = true;
+        }
+      } else {
+        err = true;
+      }
+    }
+    mbuf += vsiz;
+  }
+  return !err;
+}
+
+
+/* Apply buffered messages before an operation which reads records.
+   `bdb' specifies the B+ tree database object.
+   `kbuf' specifies the pointer to the region of the key.  If it is `NULL', all messages are
+   applied.
+   `ksiz' specifies the size of the region of the key.
+   If successful, the return value is true, else, it is false.
+   The exclusive lock is taken only if some messages are found with the shared lock. */
+static bool tcbdbbufprep(TCBDB *bdb, const char *kbuf, int ksiz){
+  assert(bdb);
+  if(bdb->bsiz < 1) return true;
+  if(!BDBLOCKMETHOD(bdb, false)) return false;
+  bool pend = bdb->open && bdb->wmode &&
+    (kbuf ? tcbdbbufpending(bdb, kbuf, ksiz) : TCMAPRNUM(bdb->bnodes) > 0);
+  BDBUNLOCKMETHOD(bdb);
+  if(!pend) return true;
+  if(!BDBLOCKMETHOD(bdb, true)) return false;
+  bool err = false;
+  if(bdb->open && bdb->wmode && TCMAPRNUM(bdb->bnodes) > 0){
+    if(kbuf){
+      if(!tcbdbbufsettle(bdb, kbuf, ksiz)) err = true;
+    } else if(!tcbdbbufflush(bdb)){
+      err = true;
+    }
+  }
+  BDBUNLOCKMETHOD(bdb);
+  return !err;
+}
+
+
+/* Check whether messages of a key are buffered.
+   `bdb' specifies the B+ tree database object.
+   `kbuf' specifies the pointer to the region of the key.
+   `ksiz' specifies the size of the region of the key.
+   The return value is true if messages of the key are buffered or the path can not be loaded,
+   else, it is false.
+   Since neither the search history nor the order of the buffers is modified, this function can
+   be called with the shared lock. */
+static bool tcbdbbufpending(TCBDB *bdb, const char *kbuf, int ksiz){
+  assert(bdb && kbuf && ksiz >= 0);
+  if(TCMAPRNUM(bdb->bnodes) < 1) return false;
+  uint64_t pid = bdb->root;
+  while(pid > BDBNODEIDBASE){
+    BDBNODE *node = tcbdbnodeload(bdb, pid);
+    if(!node) return true;
+    int msiz;
+    if(node->msgs && tctreeget3(node->msgs, kbuf, ksiz, &msiz)) return true;
+    int ci = tcbdbnodechild(bdb, node, kbuf, ksiz);
+    pid = (ci >= 0) ? ((BDBIDX *)TCPTRLISTVAL(node->idxs, ci))->pid : node->heir;
+  }
+  return false;
+}
+
+
+/* Apply buffered messages of keys in a range.
+   `bdb' specifies the B+ tree database object.
+   `bkbuf' specifies the pointer to the region of the key of the beginning border.  If it is
+   `NULL', the first key is specified.
+   `bksiz' specifies the size of the region of the beginning key.
+   `binc' specifies whether the beginning border is inclusive or not.
+   `ekbuf' specifies the pointer to the region of the key of the ending border.  If it is
+   `NULL', the last key is specified.
+   `eksiz' specifies the size of the region of the ending key.
+   `einc' specifies whether the ending border is inclusive or not.
+   `fwm' specifies whether the range is of the keys beginning with the beginning key.  If it is
+   true, the ending border is ignored.
+   The return value is the number of settled keys or -1 on failure. */
+static int tcbdbbufsettlerange(TCBDB *bdb, const char *bkbuf, int bksiz, bool binc,
+                               const char *ekbuf, int eksiz, bool einc, bool fwm){
+  assert(bdb);
+  if(TCMAPRNUM(bdb->bnodes) < 1) return 0;
+  TCCMP cmp = bdb->cmp;
+  void *cmpop = bdb->cmpop;
+  TCLIST *ids = tcmapkeys(bdb->bnodes);
+  TCMAP *keys = tcmapnew2(TCMAPRNUM(bdb->bnodes) * 2 + 1);
+  const char *kbuf;
+  int ksiz;
   bool err = false;
-  BDBCUR *cur = tcbdbcurnew(bdb);
-  tcbdbcurfirstimpl(cur);
-  const char *kbuf, *vbuf;
-  int ksiz, vsiz;
-  int cnt = 0;
-  while(!err && cur->id > 0 && tcbdbcurrecimpl(cur, &kbuf, &ksiz, &vbuf, &vsiz)){
-    if(!tcbdbputdup(tbdb, kbuf, ksiz, vbuf, vsiz)){
-      tcbdbsetecode(bdb, tcbdbecode(tbdb), __FILE__, __LINE__, __func__);
+  int ln = TCLISTNUM(ids);
+  for(int i = 0; i < ln; i++){
+    uint64_t id;
+    memcpy(&id, TCLISTVALPTR(ids, i), sizeof(id));
+    BDBNODE *node = tcbdbnodeload(bdb, id);
+    if(!node){
       err = true;
+      break;
+    }
+    TCTREE *msgs = node->msgs;
+    if(!msgs) continue;
+    if(bkbuf){
+      tctreeiterinit2(msgs, bkbuf, bksiz);
+    } else {
+      tctreeiterinit(msgs);
+    }
+    while((kbuf = tctreeiternext(msgs, &ksiz)) != NULL){
+      if(fwm){
+        if(ksiz < bksiz || memcmp(kbuf, bkbuf, bksiz)) break;
+      } else {
+        if(bkbuf && !binc && cmp(kbuf, ksiz, bkbuf, bksiz, cmpop) == 0) continue;
+        if(ekbuf){
+          int rv = cmp(kbuf, ksiz, ekbuf, eksiz, cmpop);
+          if(einc ? rv > 0 : rv >= 0) break;
+        }
+      }
+      tcmapputkeep(keys, kbuf, ksiz, "", 0);
     }
-    tcbdbcurnextimpl(cur);
-    if((++cnt % 0xf == 0) && !tcbdbcacheadjust(bdb)) err = true;
   }
-  tcbdbcurdel(cur);
-  if(!tcbdbclose(tbdb)){
-    tcbdbsetecode(bdb, tcbdbecode(tbdb), __FILE__, __LINE__, __func__);
-    err = true;
+  tclistdel(ids);
+  int knum = TCMAPRNUM(keys);
+  tcmapiterinit(keys);
+  while(!err && (kbuf = tcmapiternext(keys, &ksiz)) != NULL){
+    if(!tcbdbbufsettle(bdb, kbuf, ksiz)) err = true;
   }
-  bdb->lcnum = lcnum;
-  bdb->ncnum = ncnum;
-  tcbdbdel(tbdb);
-  if(unlink(path) == -1){
-    tcbdbsetecode(bdb, TCEUNLINK, __FILE__, __LINE__, __func__);
-    err = true;
+  tcmapdel(keys);
+  return err ? -1 : knum;
+}
+
+
+/* Apply buffered messages of keys in a range before an operation which reads records.
+   `bdb' specifies the B+ tree database object.
+   `bkbuf' specifies the pointer to the region of the key of the beginning border.  If it is
+   `NULL', the first key is specified.
+   `bksiz' specifies the size of the region of the beginning key.
+   `binc' specifies whether the beginning border is inclusive or not.
+   `ekbuf' specifies the pointer to the region of the key of the ending border.  If it is
+   `NULL', the last key is specified.
+   `eksiz' specifies the size of the region of the ending key.
+   `einc' specifies whether the ending border is inclusive or not.
+   `fwm' specifies whether the range is of the keys beginning with the beginning key.
+   If successful, the return value is true, else, it is false. */
+static bool tcbdbbufpreprange(TCBDB *bdb, const char *bkbuf, int bksiz, bool binc,
+                              const char *ekbuf, int eksiz, bool einc, bool fwm){
+  assert(bdb);
+  if(bdb->bsiz < 1) return true;
+  if(!BDBLOCKMETHOD(bdb, false)) return false;
+  bool pend = bdb->open && bdb->wmode && TCMAPRNUM(bdb->bnodes) > 0;
+  BDBUNLOCKMETHOD(bdb);
+  if(!pend) return true;
+  if(!BDBLOCKMETHOD(bdb, true)) return false;
+  bool err = false;
+  if(bdb->open && bdb->wmode &&
+     tcbdbbufsettlerange(bdb, bkbuf, bksiz, binc, ekbuf, eksiz, einc, fwm) < 0) err = true;
+  BDBUNLOCKMETHOD(bdb);
+  return !err;
+}
+
+
+/* Apply buffered messages before an operation of a cursor object.
+   `cur' specifies the cursor object.
+   `mode' specifies the operation: `BDBBCFIRST', `BDBBCLAST', `BDBBCJUMP', `BDBBCJUMPB',
+   `BDBBCPREV', `BDBBCNEXT', or `BDBBCREAD'.
+   `kbuf' specifies the pointer to the region of the key to jump to.  It is used only with
+   `BDBBCJUMP' and `BDBBCJUMPB'.
+   `ksiz' specifies the size of the region of the key.
+   If successful, the return value is true, else, it is false.
+   Only the keys between the current position and the destination are settled.  Because a
+   settled message can move the destination, the destination is searched again until no more
+   message is settled.  The cursor is then put back to the record where it was. */
+static bool tcbdbbufprepcur(BDBCUR *cur, int mode, const char *kbuf, int ksiz){
+  assert(cur);
+  TCBDB *bdb = cur->bdb;
+  if(bdb->bsiz < 1) return true;
+  if(!BDBLOCKMETHOD(bdb, false)) return false;
+  bool pend = bdb->open && bdb->wmode && TCMAPRNUM(bdb->bnodes) > 0;
+  BDBUNLOCKMETHOD(bdb);
+  if(!pend) return true;
+  if(!BDBLOCKMETHOD(bdb, true)) return false;
+  if(!bdb->open || !bdb->wmode){
+    BDBUNLOCKMETHOD(bdb);
+    return true;
   }
-  if(rename(tpath, path) == -1){
-    tcbdbsetecode(bdb, TCERENAME, __FILE__, __LINE__, __func__);
-    err = true;
+  const char *rkbuf, *rvbuf;
+  int rksiz, rvsiz;
+  char *obuf = NULL;
+  int osiz = 0;
+  int ovidx = 0;
+  if(mode == BDBBCPREV || mode == BDBBCNEXT || mode == BDBBCREAD){
+    if(cur->id < 1 || !tcbdbcurrecimpl(cur, &rkbuf, &rksiz, &rvbuf, &rvsiz)){
+      BDBUNLOCKMETHOD(bdb);
+      return true;
+    }
+    TCMEMDUP(obuf, rkbuf, rksiz);
+    osiz = rksiz;
+    ovidx = cur->vidx;
   }
-  TCFREE(tpath);
-  if(err) return false;
-  tpath = tcstrdup(path);
-  int omode = (tchdbomode(bdb->hdb) & ~BDBOCREAT) & ~BDBOTRUNC;
-  if(!tcbdbcloseimpl(bdb)){
-    TCFREE(tpath);
-    return false;
+  bool err = false;
+  while(!err){
+    BDBCUR tcur = *cur;
+    bool hit;
+    switch(mode){
+      case BDBBCFIRST: hit = tcbdbcurfirstimpl(&tcur); break;
+      case BDBBCLAST: hit = tcbdbcurlastimpl(&tcur); break;
+      case BDBBCJUMP: hit = tcbdbcurjumpimpl(&tcur, kbuf, ksiz, true); break;
+      case BDBBCJUMPB: hit = tcbdbcurjumpimpl(&tcur, kbuf, ksiz, false); break;
+      case BDBBCPREV: hit = tcbdbcurprevimpl(&tcur); break;
+      case BDBBCNEXT: hit = tcbdbcurnextimpl(&tcur); break;
+      default: hit = false; break;
+    }
+    char *dbuf = NULL;
+    int dsiz = 0;
+    if(hit && tcur.id > 0 && tcbdbcurrecimpl(&tcur, &rkbuf, &rksiz, &rvbuf, &rvsiz)){
+      TCMEMDUP(dbuf, rkbuf, rksiz);
+      dsiz = rksiz;
+    }
+    int snum;
+    switch(mode){
+      case BDBBCFIRST:
+        snum = tcbdbbufsettlerange(bdb, NULL, 0, true, dbuf, dsiz, true, false);
+        break;
+      case BDBBCLAST:
+        snum = tcbdbbufsettlerange(bdb, dbuf, dsiz, true, NULL, 0, true, false);
+        break;
+      case BDBBCJUMP:
+        snum = tcbdbbufsettlerange(bdb, kbuf, ksiz, true, dbuf, dsiz, true, false);
+        break;
+      case BDBBCJUMPB:
+        snum = tcbdbbufsettlerange(bdb, dbuf, dsiz, true, kbuf, ksiz, true, false);
+        break;
+      case BDBBCPREV:
+        snum = tcbdbbufsettlerange(bdb, dbuf, dsiz, true, obuf, osiz, true, false);
+        break;
+      case BDBBCNEXT:
+        snum = tcbdbbufsettlerange(bdb, obuf, osiz, true, dbuf, dsiz, true, false);
+        break;
+      default:
+        snum = tcbdbbufsettlerange(bdb, obuf, osiz, true, obuf, osiz, true, false);
+        break;
+    }
+    TCFREE(dbuf);
+    if(snum < 0){
+      err = true;
+    } else if(snum < 1){
+      break;
+    } else if(obuf){
+      if(tcbdbcurjumpimpl(cur, obuf, osiz, true)){
+        if(tcbdbcurrecimpl(cur, &rkbuf, &rksiz, &rvbuf, &rvsiz) &&
+           bdb->cmp(rkbuf, rksiz, obuf, osiz, bdb->cmpop) == 0){
+          cur->vidx = ovidx;
+        } else if(mode == BDBBCNEXT){
+          cur->vidx = -1;
+        }
+      } else if(mode == BDBBCPREV && tcbdbcurlastimpl(cur)){
+        cur->vidx++;
+      }
+    }
   }
-  bool rv = tcbdbopenimpl(bdb, tpath, omode);
-  TCFREE(tpath);
-  return rv;
+  TCFREE(obuf);
+  BDBUNLOCKMETHOD(bdb);
+  return !err;
+}
+
+
+/* Remove a record of a B+ tree database object with the message buffer.
+   `bdb' specifies the B+ tree database object.
+   `kbuf' specifies the pointer to the region of the key.
+   `ksiz' specifies the size of the region of the key.
+   If successful, the return value is true, else, it is false. */
+static bool tcbdbbufout(TCBDB *bdb, const char *kbuf, int ksiz){
+  assert(bdb && kbuf && ksiz >= 0);
+  const char *vbuf;
+  int vsiz;
+  if(tcbdbbufpeek(bdb, kbuf, ksiz, &vbuf, &vsiz) == BDBMSGPUT)
+    return tcbdbbufpost(bdb, kbuf, ksiz, BDBMSGOUT, "", 0);
+  if(!tcbdbbufsettle(bdb, kbuf, ksiz)) return false;
+  return tcbdboutimpl(bdb, kbuf, ksiz);
+}
+
+
+/* Add a number to a record of a B+ tree database object with the message buffer.
+   `bdb' specifies the B+ tree database object.
+   `kbuf' specifies the pointer to the region of the key.
+   `ksiz' specifies the size of the region of the key.
+   `nbuf' specifies the pointer to the region of the number, into which the result is written.
+   `nsiz' specifies the size of the region of the number.
+   `dmode' specifies `BDBPDADDINT' or `BDBPDADDDBL'.
+   If successful, the return value is true, else, it is false. */
+static bool tcbdbbufaddnum(TCBDB *bdb, const char *kbuf, int ksiz, char *nbuf, int nsiz,
+                           int dmode){
+  assert(bdb && kbuf && ksiz >= 0 && nbuf && nsiz >= 0);
+  const char *vbuf;
+  int vsiz;
+  if(tcbdbbufpeek(bdb, kbuf, ksiz, &vbuf, &vsiz) == BDBMSGPUT){
+    if(vsiz != nsiz){
+      tcbdbsetecode(bdb, TCEKEEP, __FILE__, __LINE__, __func__);
+      return false;
+    }
+    if(dmode == BDBPDADDINT){
+      int onum, num;
+      memcpy(&onum, vbuf, sizeof(onum));
+      memcpy(&num, nbuf, sizeof(num));
+      if(num == 0){
+        memcpy(nbuf, &onum, sizeof(onum));
+        return true;
+      }
+      num += onum;
+      memcpy(nbuf, &num, sizeof(num));
+    } else {
+      double onum, num;
+      memcpy(&onum, vbuf, sizeof(onum));
+      memcpy(&num, nbuf, sizeof(num));
+      if(num == 0.0){
+        memcpy(nbuf, &onum, sizeof(onum));
+        return true;
+      }
+      num += onum;
+      memcpy(nbuf, &num, sizeof(num));
+    }
+    return tcbdbbufpost(bdb, kbuf, ksiz, BDBMSGPUT, nbuf, nsiz);
+  }
+  if(!tcbdbbufsettle(bdb, kbuf, ksiz)) return false;
+  return tcbdbputimpl(bdb, kbuf, ksiz, nbuf, nsiz, dmode);
+}
+
+
+/* Append an operation to a message.
+   `buf' specifies the region of the message, which should have enough room for the operation.
+   `size' specifies the size of the message.
+   `op' specifies the operation.
+   `vbuf' specifies the pointer to the region of the value.
+   `vsiz' specifies the size of the region of the value.
+   The return value is the new size of the message.
+   The operation is combined with the last one if the result of the sequence is the same. */
+static int tcbdbmsgpush(char *buf, int size, int op, const char *vbuf, int vsiz){
+  assert(buf && size >= 0 && vbuf && vsiz >= 0);
+  int lp = -1;
+  int lop = -1;
+  int lvp = 0;
+  int lvsiz = 0;
+  const char *rp = buf;
+  const char *ep = buf + size;
+  while(rp < ep){
+    lp = rp - buf;
+    lop = *(unsigned char *)(rp++);
+    int step;
+    TCREADVNUMBUF(rp, lvsiz, step);
+    rp += step;
+    lvp = rp - buf;
+    rp += lvsiz;
+  }
+  char *wp;
+  int step;
+  uint32_t lnum;
+  if(lop == BDBMSGPUT || lop == BDBMSGCAT){
+    if(op == BDBMSGOUT) return tcbdbmsgpush(buf, lp, op, vbuf, vsiz);
+    if(op == BDBMSGCAT){
+      char hbuf[TCNUMBUFSIZ];
+      lnum = lvsiz + vsiz;
+      TCSETVNUMBUF(step, hbuf, lnum);
+      wp = buf + lp + 1;
+      memmove(wp + step, buf + lvp, lvsiz);
+      memcpy(wp, hbuf, step);
+      wp += step + lvsiz;
+      memcpy(wp, vbuf, vsiz);
+      return wp + vsiz - buf;
+    }
+    size = lp;
+  }
+  wp = buf + size;
+  *(wp++) = op;
+  lnum = vsiz;
+  TCSETVNUMBUF(step, wp, lnum);
+  wp += step;
+  memcpy(wp, vbuf, vsiz);
+  return wp + vsiz - buf;
+}
+
+
+/* Merge two messages of the same key.
+   `obuf' specifies the pointer to the region of the older message.
+   `osiz' specifies the size of the region of the older message.
+   `nbuf' specifies the pointer to the region of the newer message.
+   `nsiz' specifies the size of the region of the newer message.
+   `sp' specifies the pointer to the variable into which the size of the region of the return
+   value is assigned.
+   The return value is the pointer to the region of the merged message.
+   Because the region of the return value is allocated with the `malloc' call, it should be
+   released with the `free' call when it is no longer in use. */
+static char *tcbdbmsgmerge(const char *obuf, int osiz, const char *nbuf, int nsiz, int *sp){
+  assert(obuf && osiz >= 0 && nbuf && nsiz >= 0 && sp);
+  char *buf;
+  TCMALLOC(buf, osiz + nsiz + 1);
+  memcpy(buf, obuf, osiz);
+  int size = osiz;
+  const char *rp = nbuf;
+  const char *ep = nbuf + nsiz;
+  while(rp < ep){
+    int op = *(unsigned char *)(rp++);
+    int vsiz, step;
+    TCREADVNUMBUF(rp, vsiz, step);
+    rp += step;
+    size = tcbdbmsgpush(buf, size, op, rp, vsiz);
+    rp += vsiz;
+  }
+  *sp = size;
+  return buf;
 }
 
 
@@ -3505,6 +6186,7 @@ static bool tcbdbvanishimpl(TCBDB *bdb){
   char *path = tcstrdup(tchdbpath(bdb->hdb));
   int omode = tchdbomode(bdb->hdb);
   bool err = false;
+  tcmapclear(bdb->bnodes);
   if(!tcbdbcloseimpl(bdb)) err = true;
   if(!tcbdbopenimpl(bdb, path, BDBOTRUNC | omode)) err = true;
   TCFREE(path);
@@ -3606,6 +6288,7 @@ static bool tcbdbcurlastimpl(BDBCUR *cur){
 static bool tcbdbcurjumpimpl(BDBCUR *cur, const char *kbuf, int ksiz, bool forward){
   assert(cur && kbuf && ksiz >= 0);
   TCBDB *bdb = cur->bdb;
+  uint64_t kpfx = tcbdbkeypfx(bdb, kbuf, ksiz);
   cur->clock = bdb->clock;
   uint64_t pid = tcbdbsearchleaf(bdb, kbuf, ksiz);
   if(pid < 1){
@@ -3635,7 +6318,7 @@ static bool tcbdbcurjumpimpl(BDBCUR *cur, const char *kbuf, int ksiz, bool forwa
     if(forward){
       cur->vidx = 0;
     } else {
-      cur->vidx = rec->rest ? TCLISTNUM(rec->rest) : 0;
+      cur->vidx = tcbdbrecvnum(rec) - 1;
     }
     return true;
   }
@@ -3646,26 +6329,18 @@ static bool tcbdbcurjumpimpl(BDBCUR *cur, const char *kbuf, int ksiz, bool forwa
   char *dbuf = (char *)rec + sizeof(*rec);
   if(forward){
     int rv;
-    if(bdb->cmp == tccmplexical){
-      TCCMPLEXICAL(rv, kbuf, ksiz, dbuf, rec->ksiz);
-    } else {
-      rv = bdb->cmp(kbuf, ksiz, dbuf, rec->ksiz, bdb->cmpop);
-    }
+    BDBCMPKEY(rv, bdb, kpfx, kbuf, ksiz, rec->pfx, dbuf, rec->ksiz);
     if(rv < 0){
       cur->vidx = 0;
       return true;
     }
-    cur->vidx = rec->rest ? TCLISTNUM(rec->rest) : 0;
+    cur->vidx = tcbdbrecvnum(rec) - 1;
     return tcbdbcurnextimpl(cur);
   }
   int rv;
-  if(bdb->cmp == tccmplexical){
-    TCCMPLEXICAL(rv, kbuf, ksiz, dbuf, rec->ksiz);
-  } else {
-    rv = bdb->cmp(kbuf, ksiz, dbuf, rec->ksiz, bdb->cmpop);
-  }
+  BDBCMPKEY(rv, bdb, kpfx, kbuf, ksiz, rec->pfx, dbuf, rec->ksiz);
   if(rv > 0){
-    cur->vidx = rec->rest ? TCLISTNUM(rec->rest) : 0;
+    cur->vidx = tcbdbrecvnum(rec) - 1;
     return true;
   }
   cur->vidx = 0;
@@ -3673,6 +6348,70 @@ static bool tcbdbcurjumpimpl(BDBCUR *cur, const char *kbuf, int ksiz, bool forwa
 }
 
 
+/* Move a cursor object to the record at a position.
+   `cur' specifies the cursor object.
+   `nth' specifies the position of the record counted from 0 in the order of keys.
+   If successful, the return value is true, else, it is false.
+   The nodes are descended with the numbers of records under their children.  If the database
+   has no such numbers, the leaves are scanned from the first one. */
+static bool tcbdbcurjumpnthimpl(BDBCUR *cur, uint64_t nth){
+  assert(cur);
+  TCBDB *bdb = cur->bdb;
+  cur->clock = bdb->clock;
+  cur->id = 0;
+  cur->kidx = 0;
+  cur->vidx = 0;
+  uint64_t pid = bdb->root;
+  if(nth >= bdb->rnum){
+    tcbdbsetecode(bdb, TCENOREC, __FILE__, __LINE__, __func__);
+    return false;
+  }
+  if(bdb->ostat){
+    while(pid > BDBNODEIDBASE){
+      BDBNODE *node = tcbdbnodeload(bdb, pid);
+      if(!node) return false;
+      if(nth < node->hrnum){
+        pid = node->heir;
+        continue;
+      }
+      nth -= node->hrnum;
+      TCPTRLIST *idxs = node->idxs;
+      int ln = TCPTRLISTNUM(idxs);
+      pid = 0;
+      for(int i = 0; i < ln; i++){
+        BDBIDX *idx = TCPTRLISTVAL(idxs, i);
+        if(nth < idx->rnum){
+          pid = idx->pid;
+          break;
+        }
+        nth -= idx->rnum;
+      }
+    }
+  } else {
+    pid = bdb->first;
+  }
+  while(pid > 0){
+    BDBLEAF *leaf = tcbdbleafload(bdb, pid);
+    if(!leaf) return false;
+    TCPTRLIST *recs = leaf->recs;
+    int ln = TCPTRLISTNUM(recs);
+    for(int i = 0; i < ln; i++){
+      int vnum = tcbdbrecvnum(TCPTRLISTVAL(recs, i));
+      if(nth < vnum){
+        cur->id = pid;
+        cur->kidx = i;
+        cur->vidx = nth;
+        return true;
+      }
+      nth -= vnum;
+    }
+    pid = leaf->next;
+  }
+  tcbdbsetecode(bdb, TCENOREC, __FILE__, __LINE__, __func__);
+  return false;
+}
+
+
 /* Adjust a cursor object forward to the suitable record.
    `cur' specifies the cursor object.
    `forward' specifies the direction is forward or not.
@@ -3732,7 +6471,7 @@ static bool tcbdbcuradjust(BDBCUR *cur, bool forward){
       }
     } else {
       BDBREC *rec = TCPTRLISTVAL(recs, cur->kidx);
-      int vnum = rec->rest ? TCLISTNUM(rec->rest) + 1 : 1;
+      int vnum = tcbdbrecvnum(rec);
       if(cur->vidx < 0){
         if(forward){
           cur->vidx = 0;
@@ -3811,7 +6550,7 @@ static bool tcbdbcurputimpl(BDBCUR *cur, const char *vbuf, int vsiz, int cpmode)
     return false;
   }
   BDBREC *rec = TCPTRLISTVAL(recs, cur->kidx);
-  int vnum = rec->rest ? TCLISTNUM(rec->rest) + 1 : 1;
+  int vnum = tcbdbrecvnum(rec);
   if(cur->vidx >= vnum){
     tcbdbsetecode(bdb, TCENOREC, __FILE__, __LINE__, __func__);
     return false;
@@ -3833,16 +6572,14 @@ static bool tcbdbcurputimpl(BDBCUR *cur, const char *vbuf, int vsiz, int cpmode)
       memcpy(dbuf + rec->ksiz + psiz, vbuf, vsiz);
       dbuf[rec->ksiz+psiz+vsiz] = '\0';
       rec->vsiz = vsiz;
-    } else {
-      leaf->size += vsiz - TCLISTVALSIZ(rec->rest, cur->vidx - 1);
-      tclistover(rec->rest, cur->vidx - 1, vbuf, vsiz);
+    } else if(!tcbdbrecover(bdb, leaf, rec, cur->vidx - 1, vbuf, vsiz)){
+      return false;
     }
     break;
   case BDBCPBEFORE:
-    leaf->size += vsiz;
     if(cur->vidx < 1){
-      if(!rec->rest) rec->rest = tclistnew2(1);
-      tclistunshift(rec->rest, dbuf + rec->ksiz + psiz, rec->vsiz);
+      if(!tcbdbrecinsert(bdb, leaf, rec, 0, dbuf + rec->ksiz + psiz, rec->vsiz)) return false;
+      leaf->size += vsiz - rec->vsiz;
       if(vsiz > rec->vsiz){
         TCREALLOC(rec, rec, sizeof(*rec) + rec->ksiz + psiz + vsiz + 1);
         if(rec != orec){
@@ -3853,20 +6590,20 @@ static bool tcbdbcurputimpl(BDBCUR *cur, const char *vbuf, int vsiz, int cpmode)
       memcpy(dbuf + rec->ksiz + psiz, vbuf, vsiz);
       dbuf[rec->ksiz+psiz+vsiz] = '\0';
       rec->vsiz = vsiz;
-    } else {
-      TCLISTINSERT(rec->rest, cur->vidx - 1, vbuf, vsiz);
+    } else if(!tcbdbrecinsert(bdb, leaf, rec, cur->vidx - 1, vbuf, vsiz)){
+      return false;
     }
     bdb->rnum++;
     break;
   case BDBCPAFTER:
-    leaf->size += vsiz;
-    if(!rec->rest) rec->rest = tclistnew2(1);
-    TCLISTINSERT(rec->rest, cur->vidx, vbuf, vsiz);
+    if(!tcbdbrecinsert(bdb, leaf, rec, cur->vidx, vbuf, vsiz)) return false;
     cur->vidx++;
     bdb->rnum++;
     break;
   }
   leaf->dirty = true;
+  if(cpmode != BDBCPCURRENT &&
+     !tcbdbstatadd(bdb, leaf->id, (char *)rec + sizeof(*rec), rec->ksiz, 1)) return false;
   return true;
 }
 
@@ -3896,16 +6633,18 @@ static bool tcbdbcuroutimpl(BDBCUR *cur){
   }
   BDBREC *rec = TCPTRLISTVAL(recs, cur->kidx);
   char *dbuf = (char *)rec + sizeof(*rec);
-  int vnum = rec->rest ? TCLISTNUM(rec->rest) + 1 : 1;
+  int vnum = tcbdbrecvnum(rec);
   if(cur->vidx >= vnum){
     tcbdbsetecode(bdb, TCENOREC, __FILE__, __LINE__, __func__);
     return false;
   }
-  if(rec->rest){
+  if(!tcbdbstatadd(bdb, leaf->id, dbuf, rec->ksiz, -1)) return false;
+  if(rec->rest || rec->ovfl){
     if(cur->vidx < 1){
-      leaf->size -= rec->vsiz;
       int vsiz;
-      char *vbuf = tclistshift(rec->rest, &vsiz);
+      char *vbuf = tcbdbrecremove(bdb, leaf, rec, 0, &vsiz);
+      if(!vbuf) return false;
+      leaf->size += vsiz - rec->vsiz;
       int psiz = TCALIGNPAD(rec->ksiz);
       if(vsiz > rec->vsiz){
         BDBREC *orec = rec;
@@ -3921,14 +6660,10 @@ static bool tcbdbcuroutimpl(BDBCUR *cur){
       TCFREE(vbuf);
     } else {
       int vsiz;
-      char *vbuf = tclistremove(rec->rest, cur->vidx - 1, &vsiz);
-      leaf->size -= vsiz;
+      char *vbuf = tcbdbrecremove(bdb, leaf, rec, cur->vidx - 1, &vsiz);
+      if(!vbuf) return false;
       TCFREE(vbuf);
     }
-    if(TCLISTNUM(rec->rest) < 1){
-      tclistdel(rec->rest);
-      rec->rest = NULL;
-    }
   } else {
     leaf->size -= rec->ksiz + rec->vsiz;
     if(TCPTRLISTNUM(recs) < 2){
@@ -3984,7 +6719,7 @@ static bool tcbdbcurrecimpl(BDBCUR *cur, const char **kbp, int *ksp, const char
   }
   BDBREC *rec = TCPTRLISTVAL(recs, cur->kidx);
   char *dbuf = (char *)rec + sizeof(*rec);
-  int vnum = rec->rest ? TCLISTNUM(rec->rest) + 1 : 1;
+  int vnum = tcbdbrecvnum(rec);
   if(cur->vidx >= vnum){
     tcbdbsetecode(bdb, TCENOREC, __FILE__, __LINE__, __func__);
     return false;
@@ -3992,7 +6727,7 @@ static bool tcbdbcurrecimpl(BDBCUR *cur, const char **kbp, int *ksp, const char
   *kbp = dbuf;
   *ksp = rec->ksiz;
   if(cur->vidx > 0){
-    *vbp = tclistval(rec->rest, cur->vidx - 1, vsp);
+    if(!(*vbp = tcbdbrecval(bdb, rec, cur->vidx, vsp))) return false;
   } else {
     *vbp = dbuf + rec->ksiz + TCALIGNPAD(rec->ksiz);
     *vsp = rec->vsiz;
@@ -4042,6 +6777,148 @@ static bool tcbdbforeachimpl(TCBDB *bdb, TCITER iter, void *op){
 }
 
 
+/* Process each record of a B+ tree database object by partitions in parallel.
+   `bdb' specifies the B+ tree database object.
+   `iter' specifies the pointer to the iterator function called for each record.
+   `ops' specifies the array of the opaque pointers of the workers.
+   `tnum' specifies the number of the workers.
+   `reduce' specifies the pointer to the reduce function or `NULL'.
+   `rop' specifies the opaque pointer given to the reduce function.
+   If successful, the return value is true, else, it is false.
+   Dirty pages are written into the internal database first, and each worker reads the leaves of
+   its partition without caching.  As dirty leaves can not be written out in a transaction, the
+   first worker processes all records by the calling thread then. */
+static bool tcbdbforeachparimpl(TCBDB *bdb, TCITER iter, void **ops, int tnum,
+                                TCREDUCE reduce, void *rop){
+  assert(bdb && iter && ops);
+  if(tnum < 1) tnum = 1;
+  if(tnum < 2 || bdb->tran){
+    bool rv = tcbdbforeachimpl(bdb, iter, ops[0]);
+    if(reduce){
+      for(int i = 0; i < tnum; i++){
+        reduce(ops[i], rop);
+      }
+    }
+    return rv;
+  }
+  if(bdb->wmode && !tcbdbmemsync(bdb, false)) return false;
+  int pnum;
+  uint64_t *starts = tcbdbleafparts(bdb, tnum, &pnum);
+  if(!starts) return false;
+  pthread_mutex_t rmtx;
+  bool rlk = !bdb->mmtx;
+  if(rlk && pthread_mutex_init(&rmtx, NULL) != 0){
+    tcbdbsetecode(bdb, TCETHREAD, __FILE__, __LINE__, __func__);
+    TCFREE(starts);
+    return false;
+  }
+  volatile bool stop = false;
+  BDBFEARG *args;
+  TCMALLOC(args, sizeof(*args) * pnum);
+  pthread_t *threads;
+  TCMALLOC(threads, sizeof(*threads) * pnum);
+  bool *runs;
+  TCMALLOC(runs, sizeof(*runs) * pnum);
+  for(int i = 0; i < pnum; i++){
+    BDBFEARG *arg = args + i;
+    arg->bdb = bdb;
+    arg->start = starts[i];
+    arg->next = (i < pnum - 1) ? starts[i+1] : 0;
+    arg->iter = iter;
+    arg->op = ops[i];
+    arg->rmtx = rlk ? &rmtx : NULL;
+    arg->stop = &stop;
+    arg->ecode = TCESUCCESS;
+    runs[i] = i > 0 && pthread_create(threads + i, NULL, tcbdbforeachthread, arg) == 0;
+  }
+  for(int i = 0; i < pnum; i++){
+    if(!runs[i]) tcbdbforeachpart(args + i);
+  }
+  bool err = false;
+  for(int i = 0; i < pnum; i++){
+    if(runs[i]){
+      void *rv;
+      if(pthread_join(threads[i], &rv) != 0){
+        tcbdbsetecode(bdb, TCETHREAD, __FILE__, __LINE__, __func__);
+        err = true;
+      }
+    }
+    if(args[i].ecode != TCESUCCESS){
+      tcbdbsetecode(bdb, args[i].ecode, __FILE__, __LINE__, __func__);
+      err = true;
+    }
+  }
+  if(reduce){
+    for(int i = 0; i < tnum; i++){
+      reduce(ops[i], rop);
+    }
+  }
+  TCFREE(runs);
+  TCFREE(threads);
+  TCFREE(args);
+  if(rlk) pthread_mutex_destroy(&rmtx);
+  TCFREE(starts);
+  return !err;
+}
+
+
+/* Process a partition of parallel iteration in a thread.
+   `targ' specifies the pointer to the argument structure of the worker.
+   The return value is always `NULL'. */
+static void *tcbdbforeachthread(void *targ){
+  assert(targ);
+  tcbdbforeachpart(targ);
+  return NULL;
+}
+
+
+/* Process the records of a partition of parallel iteration.
+   `arg' specifies the argument structure of the worker. */
+static void tcbdbforeachpart(BDBFEARG *arg){
+  assert(arg);
+  TCBDB *bdb = arg->bdb;
+  bool err = false;
+  uint64_t id = arg->start;
+  while(!err && id > 0 && id != arg->next && !*arg->stop){
+    BDBLEAF leaf;
+    if(arg->rmtx) pthread_mutex_lock(arg->rmtx);
+    bool rv = tcbdbleafread(bdb, id, &leaf);
+    if(arg->rmtx) pthread_mutex_unlock(arg->rmtx);
+    if(!rv){
+      err = true;
+      break;
+    }
+    TCPTRLIST *recs = leaf.recs;
+    int ln = TCPTRLISTNUM(recs);
+    for(int i = 0; i < ln; i++){
+      BDBREC *rec = TCPTRLISTVAL(recs, i);
+      const char *kbuf = (char *)rec + sizeof(*rec);
+      int vnum = tcbdbrecvnum(rec);
+      for(int j = 0; !err && !*arg->stop && j < vnum; j++){
+        int vsiz;
+        if(arg->rmtx) pthread_mutex_lock(arg->rmtx);
+        const char *vbuf = tcbdbrecval(bdb, rec, j, &vsiz);
+        if(arg->rmtx) pthread_mutex_unlock(arg->rmtx);
+        if(!vbuf){
+          err = true;
+        } else if(!arg->iter(kbuf, rec->ksiz, vbuf, vsiz, arg->op)){
+          *arg->stop = true;
+        }
+      }
+      if(rec->rest) tclistdel(rec->rest);
+      if(rec->ovfl) tcbdbovfldel(rec->ovfl);
+      TCFREE(rec);
+    }
+    tcptrlistdel(recs);
+    id = leaf.next;
+  }
+  if(err){
+    int ecode = tcbdbecode(bdb);
+    arg->ecode = (ecode != TCESUCCESS) ? ecode : TCEMISC;
+  }
+}
+
+
 
 /*************************************************************************************************
  * debugging functions
@@ -4133,6 +7010,8 @@ void tcbdbprintleaf(TCBDB *bdb, BDBLEAF *leaf){
         wp += sprintf(wp, ":%s", (char *)TCLISTVALPTR(rest, j));
       }
     }
+    BDBOVFL *ovfl = rec->ovfl;
+    if(ovfl) wp += sprintf(wp, ":<%d values in %d pages>", ovfl->vnum, ovfl->pnum);
   }
   *(wp++) = '\n';
   tcwrite(dbgfd, buf, wp - buf);
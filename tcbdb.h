@@ -75,6 +75,16 @@ typedef struct {                         /* type of structure for a B+ tree data
   bool tran;                             /* whether in the transaction */
   char *rbopaque;                        /* opaque for rollback */
   uint64_t clock;                        /* logical clock */
+  int32_t ptnum;                         /* number of threads for parallel maintenance */
+  int64_t plimit;                        /* maximum amount of data processed per second */
+  TCPROGRESS pproc;                      /* progress function for parallel maintenance */
+  void *pop;                             /* opaque object for the progress function */
+  int32_t bsiz;                          /* size of the message buffer of each node */
+  TCMAP *bnodes;                         /* IDs of nodes with buffered messages */
+  bool ovpage;                           /* whether duplicated values can overflow to pages */
+  uint64_t pnum;                         /* ID number of the last overflow page */
+  TCMAP *pagec;                          /* cache for overflow pages */
+  bool ostat;                            /* whether nodes count the records of their children */
   int64_t cnt_saveleaf;                  /* tesing counter for leaf save times */
   int64_t cnt_loadleaf;                  /* tesing counter for leaf load times */
   int64_t cnt_killleaf;                  /* tesing counter for leaf kill times */
@@ -175,7 +185,9 @@ bool tcbdbsetmutex(TCBDB *bdb);
    If it is not needed, `NULL' can be specified.
    If successful, the return value is true, else, it is false.
    The default comparison function compares keys of two records by lexical order.  The functions
-   `tctccmplexical' (dafault), `tctccmpdecimal', `tctccmpint32', and `tctccmpint64' are built-in.
+   `tccmplexical' (dafault), `tccmpdecimal', `tccmpint32', `tccmpint64', and `tccmpbeint' are
+   built-in.  Built-in functions are recorded in the database and keys are searched mostly by
+   comparing integers made of their leading bytes.
    Note that the comparison function should be set before the database is opened.  Moreover,
    user-defined comparison functions should be set every time the database is being opened. */
 bool tcbdbsetcmpfunc(TCBDB *bdb, TCCMP cmp, void *cmpop);
@@ -1083,6 +1095,63 @@ bool tcbdbcurjumpback(BDBCUR *cur, const void *kbuf, int ksiz);
 bool tcbdbcurjumpback2(BDBCUR *cur, const char *kstr);
 
 
+/* Get the number of records in a range of a B+ tree database object.
+   `bdb' specifies the B+ tree database object.
+   `bkbuf' specifies the pointer to the region of the key of the beginning border.  If it is
+   `NULL', the first record is specified.
+   `bksiz' specifies the size of the region of the beginning key.
+   `binc' specifies whether the beginning border is inclusive or not.
+   `ekbuf' specifies the pointer to the region of the key of the ending border.  If it is `NULL',
+   the last record is specified.
+   `eksiz' specifies the size of the region of the ending key.
+   `einc' specifies whether the ending border is inclusive or not.
+   If successful, the return value is the number of the corresponding records, else, it is -1.
+   Each of duplicated values of a key is counted as a record.  The number is calculated with the
+   counts kept in non-leaf nodes, so the cost does not depend on the width of the range.  For a
+   database created by an older version, leaves are scanned instead. */
+int64_t tcbdbrangecount(TCBDB *bdb, const void *bkbuf, int bksiz, bool binc,
+                        const void *ekbuf, int eksiz, bool einc);
+
+
+/* Get the number of records in a string range of a B+ tree database object.
+   `bdb' specifies the B+ tree database object.
+   `bkstr' specifies the string of the key of the beginning border.  If it is `NULL', the first
+   record is specified.
+   `binc' specifies whether the beginning border is inclusive or not.
+   `ekstr' specifies the string of the key of the ending border.  If it is `NULL', the last
+   record is specified.
+   `einc' specifies whether the ending border is inclusive or not.
+   If successful, the return value is the number of the corresponding records, else, it is -1. */
+int64_t tcbdbrangecount2(TCBDB *bdb, const char *bkstr, bool binc,
+                         const char *ekstr, bool einc);
+
+
+/* Get the rank of a key in a B+ tree database object.
+   `bdb' specifies the B+ tree database object.
+   `kbuf' specifies the pointer to the region of the key.
+   `ksiz' specifies the size of the region of the key.
+   If successful, the return value is the number of records whose keys are less than the
+   specified key, else, it is -1.  The key need not exist in the database. */
+int64_t tcbdbrank(TCBDB *bdb, const void *kbuf, int ksiz);
+
+
+/* Get the rank of a string key in a B+ tree database object.
+   `bdb' specifies the B+ tree database object.
+   `kstr' specifies the string of the key.
+   If successful, the return value is the number of records whose keys are less than the
+   specified key, else, it is -1. */
+int64_t tcbdbrank2(TCBDB *bdb, const char *kstr);
+
+
+/* Move a cursor object to the record at a position.
+   `cur' specifies the cursor object.
+   `nth' specifies the position of the record counted from 0 in the order of keys.
+   If successful, the return value is true, else, it is false.  False is returned if the
+   position is not less than the number of records.
+   Each of duplicated values of a key is counted as a record. */
+bool tcbdbcurjumpnth(BDBCUR *cur, uint64_t nth);
+
+
 /* Process each record atomically of a B+ tree database object.
    `bdb' specifies the B+ tree database object.
    `iter' specifies the pointer to the iterator function called for each record.  It receives
@@ -1099,6 +1168,70 @@ bool tcbdbcurjumpback2(BDBCUR *cur, const char *kstr);
 bool tcbdbforeach(TCBDB *bdb, TCITER iter, void *op);
 
 
+/* Process each record of a B+ tree database object by partitions in parallel.
+   `bdb' specifies the B+ tree database object.
+   `iter' specifies the pointer to the iterator function called for each record.  It receives
+   the same parameters as with `tcbdbforeach'.
+   `ops' specifies the array of arbitrary pointers.  Each worker gives its own element as the
+   fifth parameter of the iterator function.
+   `tnum' specifies the number of workers.  The array `ops' should have as many elements.
+   `reduce' specifies the pointer to the reduce function called for each worker after all
+   workers finish.  It receives the element of `ops' of the worker and `rop'.  If it is `NULL',
+   no reduce function is called.
+   `rop' specifies an arbitrary pointer to be given as a parameter of the reduce function.  If
+   it is not needed, `NULL' can be specified.
+   If successful, the return value is true, else, it is false.
+   The leaves are divided into ranges by the separator keys of the upper nodes, and each range
+   is processed by a worker thread in ascending order of keys.  When the iterator function
+   returns false, all workers stop.  The reduce function is called serially in ascending order
+   of the ranges.  In a transaction, all records are processed by the calling thread with the
+   first element of `ops'.  Because the iterator function is called by workers concurrently, it
+   should not modify any object shared among workers without synchronization.  Note that the
+   callback function can not perform any database operation because the function is called in
+   the critical section guarded by the same locks of database operations. */
+bool tcbdbforeachpar(TCBDB *bdb, TCITER iter, void **ops, int tnum, TCREDUCE reduce, void *rop);
+
+
+/* Set the parameters of parallel maintenance of a B+ tree database object.
+   `bdb' specifies the B+ tree database object.
+   `tnum' specifies the number of worker threads of `tcbdboptimize' and `tcbdbcopy'.  If it is
+   not more than 1, they are performed by the calling thread only.  It is 1 by default.
+   `limit' specifies the maximum amount of data processed per second, counted in records by
+   `tcbdboptimize' and in bytes by `tcbdbcopy'.  If it is not more than 0, the throughput is not
+   limited.  It is not limited by default.
+   `proc' specifies the pointer to the progress function or `NULL'.  It receives three
+   parameters.  The first parameter is the amount of processed data.  The second parameter is
+   the total amount of data.  The third parameter is the pointer to the optional opaque object.
+   It returns true to continue the process or false to stop it.
+   `op' specifies an arbitrary pointer to be given as a parameter of the progress function.  If
+   it is not needed, `NULL' can be specified.
+   If successful, the return value is true, else, it is false.
+   With plural threads, `tcbdboptimize' partitions the key space by the separator keys of the
+   upper nodes and builds the leaves and the nodes of each partition in parallel by bulk
+   loading, and `tcbdbcopy' copies disjoint regions of the file in parallel.  The progress
+   function is called by the worker threads in turn and can not perform any database
+   operation. */
+bool tcbdbsetparallel(TCBDB *bdb, int32_t tnum, int64_t limit, TCPROGRESS proc, void *op);
+
+
+/* Set the size of the message buffer of each node of a B+ tree database object.
+   `bdb' specifies the B+ tree database object which is not opened.
+   `bsiz' specifies the maximum size of the messages buffered in each node.  If it is not more
+   than 0, updating operations are applied to the leaves directly.  It is 0 by default.
+   If successful, the return value is true, else, it is false.
+   With the message buffer, `tcbdbput' and `tcbdbputcat' store their operations as messages in
+   the buffer of the root node.  When a buffer overflows, the messages of the child with the
+   most data are moved down in a batch, and they are applied to the leaf at the bottom.
+   `tcbdbout', `tcbdbaddint', and `tcbdbadddouble' are buffered when the latest message of the
+   key decides the result.  Other operations for a key apply the pending messages of the key
+   first, and operations for a range of keys apply all pending messages first.  The messages
+   are stored in the nodes when they are written back and all of them are applied by
+   `tcbdbsync', `tcbdbtranbegin', and `tcbdbclose'.  While the buffer is used, leaves which get
+   empty are not removed until the database is optimized.
+   Note that the tuning parameters of the database should be set before the database is opened. */
+bool tcbdbsetbuffer(TCBDB *bdb, int32_t bsiz);
+
+
 
 __TCBDB_CLINKAGEEND
 #endif                                   /* duplication check */
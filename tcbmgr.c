@@ -51,7 +51,8 @@ static int procget(const char *path, const char *kbuf, int ksiz, TCCMP cmp, int
 static int proclist(const char *path, TCCMP cmp, int omode, int max, bool pv, bool px, bool bk,
                     const char *jstr, const char *bstr, const char *estr, const char *fmstr);
 static int procoptimize(const char *path, int lmemb, int nmemb,
-                        int bnum, int apow, int fpow, TCCMP cmp, int opts, int omode, bool df);
+                        int bnum, int apow, int fpow, TCCMP cmp, int opts, int omode, bool df,
+                        int tnum, int64_t limit);
 static int procimporttsv(const char *path, const char *file, int omode, bool sc);
 static int procversion(void);
 
@@ -94,17 +95,17 @@ static void usage(void){
   fprintf(stderr, "%s: the command line utility of the B+ tree database API\n", g_progname);
   fprintf(stderr, "\n");
   fprintf(stderr, "usage:\n");
-  fprintf(stderr, "  %s create [-cd|-ci|-cj] [-tl] [-td|-tb|-tt|-tx] path"
+  fprintf(stderr, "  %s create [-cd|-ci|-cj|-cb] [-tl] [-td|-tb|-tt|-tx] path"
           " [lmemb [nmemb [bnum [apow [fpow]]]]]\n", g_progname);
   fprintf(stderr, "  %s inform [-nl|-nb] path\n", g_progname);
-  fprintf(stderr, "  %s put [-cd|-ci|-cj] [-nl|-nb] [-sx] [-dk|-dc|-dd|-db|-dai|-dad] path"
+  fprintf(stderr, "  %s put [-cd|-ci|-cj|-cb] [-nl|-nb] [-sx] [-dk|-dc|-dd|-db|-dai|-dad] path"
           " key value\n", g_progname);
-  fprintf(stderr, "  %s out [-cd|-ci|-cj] [-nl|-nb] [-sx] path key\n", g_progname);
-  fprintf(stderr, "  %s get [-cd|-ci|-cj] [-nl|-nb] [-sx] [-px] [-pz] path key\n", g_progname);
-  fprintf(stderr, "  %s list [-cd|-ci|-cj] [-nl|-nb] [-m num] [-bk] [-pv] [-px] [-j str]"
+  fprintf(stderr, "  %s out [-cd|-ci|-cj|-cb] [-nl|-nb] [-sx] path key\n", g_progname);
+  fprintf(stderr, "  %s get [-cd|-ci|-cj|-cb] [-nl|-nb] [-sx] [-px] [-pz] path key\n", g_progname);
+  fprintf(stderr, "  %s list [-cd|-ci|-cj|-cb] [-nl|-nb] [-m num] [-bk] [-pv] [-px] [-j str]"
           " [-rb bkey ekey] [-fm str] path\n", g_progname);
-  fprintf(stderr, "  %s optimize [-cd|-ci|-cj] [-tl] [-td|-tb|-tt|-tx] [-tz] [-nl|-nb] [-df]"
-          " path [lmemb [nmemb [bnum [apow [fpow]]]]]\n", g_progname);
+  fprintf(stderr, "  %s optimize [-cd|-ci|-cj|-cb] [-tl] [-td|-tb|-tt|-tx] [-tz] [-nl|-nb] [-df]"
+          " [-tn num] [-tr num] path [lmemb [nmemb [bnum [apow [fpow]]]]]\n", g_progname);
   fprintf(stderr, "  %s importtsv [-nl|-nb] [-sc] path [file]\n", g_progname);
   fprintf(stderr, "  %s version\n", g_progname);
   fprintf(stderr, "\n");
@@ -188,6 +189,8 @@ static int runcreate(int argc, char **argv){
         cmp = tccmpint32;
       } else if(!strcmp(argv[i], "-cj")){
         cmp = tccmpint64;
+      } else if(!strcmp(argv[i], "-cb")){
+        cmp = tccmpbeint;
       } else if(!strcmp(argv[i], "-tl")){
         opts |= BDBTLARGE;
       } else if(!strcmp(argv[i], "-td")){
@@ -270,6 +273,8 @@ static int runput(int argc, char **argv){
         cmp = tccmpint32;
       } else if(!strcmp(argv[i], "-cj")){
         cmp = tccmpint64;
+      } else if(!strcmp(argv[i], "-cb")){
+        cmp = tccmpbeint;
       } else if(!strcmp(argv[i], "-nl")){
         omode |= BDBONOLCK;
       } else if(!strcmp(argv[i], "-nb")){
@@ -335,6 +340,8 @@ static int runout(int argc, char **argv){
         cmp = tccmpint32;
       } else if(!strcmp(argv[i], "-cj")){
         cmp = tccmpint64;
+      } else if(!strcmp(argv[i], "-cb")){
+        cmp = tccmpbeint;
       } else if(!strcmp(argv[i], "-nl")){
         omode |= BDBONOLCK;
       } else if(!strcmp(argv[i], "-nb")){
@@ -384,6 +391,8 @@ static int runget(int argc, char **argv){
         cmp = tccmpint32;
       } else if(!strcmp(argv[i], "-cj")){
         cmp = tccmpint64;
+      } else if(!strcmp(argv[i], "-cb")){
+        cmp = tccmpbeint;
       } else if(!strcmp(argv[i], "-nl")){
         omode |= BDBONOLCK;
       } else if(!strcmp(argv[i], "-nb")){
@@ -441,6 +450,8 @@ static int runlist(int argc, char **argv){
         cmp = tccmpint32;
       } else if(!strcmp(argv[i], "-cj")){
         cmp = tccmpint64;
+      } else if(!strcmp(argv[i], "-cb")){
+        cmp = tccmpbeint;
       } else if(!strcmp(argv[i], "-nl")){
         omode |= BDBONOLCK;
       } else if(!strcmp(argv[i], "-nb")){
@@ -492,6 +503,8 @@ static int runoptimize(int argc, char **argv){
   int opts = UINT8_MAX;
   int omode = 0;
   bool df = false;
+  int tnum = 1;
+  int64_t limit = 0;
   for(int i = 2; i < argc; i++){
     if(!path && argv[i][0] == '-'){
       if(!strcmp(argv[i], "-cd")){
@@ -500,6 +513,8 @@ static int runoptimize(int argc, char **argv){
         cmp = tccmpint32;
       } else if(!strcmp(argv[i], "-cj")){
         cmp = tccmpint64;
+      } else if(!strcmp(argv[i], "-cb")){
+        cmp = tccmpbeint;
       } else if(!strcmp(argv[i], "-tl")){
         if(opts == UINT8_MAX) opts = 0;
         opts |= BDBTLARGE;
@@ -523,6 +538,12 @@ static int runoptimize(int argc, char **argv){
         omode |= BDBOLCKNB;
       } else if(!strcmp(argv[i], "-df")){
         df = true;
+      } else if(!strcmp(argv[i], "-tn")){
+        if(++i >= argc) usage();
+        tnum = tcatoix(argv[i]);
+      } else if(!strcmp(argv[i], "-tr")){
+        if(++i >= argc) usage();
+        limit = tcatoix(argv[i]);
       } else {
         usage();
       }
@@ -548,7 +569,8 @@ static int runoptimize(int argc, char **argv){
   int bnum = bstr ? tcatoix(bstr) : -1;
   int apow = astr ? tcatoix(astr) : -1;
   int fpow = fstr ? tcatoix(fstr) : -1;
-  int rv = procoptimize(path, lmemb, nmemb, bnum, apow, fpow, cmp, opts, omode, df);
+  int rv = procoptimize(path, lmemb, nmemb, bnum, apow, fpow, cmp, opts, omode, df,
+                        tnum, limit);
   return rv;
 }
 
@@ -649,6 +671,8 @@ static int procinform(const char *path, int omode){
     printf("int32");
   } else if(cmp == tccmpint64){
     printf("int64");
+  } else if(cmp == tccmpbeint){
+    printf("beint");
   } else {
     printf("custom");
   }
@@ -918,9 +942,11 @@ static int proclist(const char *path, TCCMP cmp, int omode, int max, bool pv, bo
 
 /* perform optimize command */
 static int procoptimize(const char *path, int lmemb, int nmemb,
-                        int bnum, int apow, int fpow, TCCMP cmp, int opts, int omode, bool df){
+                        int bnum, int apow, int fpow, TCCMP cmp, int opts, int omode, bool df,
+                        int tnum, int64_t limit){
   TCBDB *bdb = tcbdbnew();
   if(g_dbgfd >= 0) tcbdbsetdbgfd(bdb, g_dbgfd);
+  if(!tcbdbsetparallel(bdb, tnum, limit, NULL, NULL)) printerr(bdb);
   if(cmp && !tcbdbsetcmpfunc(bdb, cmp, NULL)) printerr(bdb);
   if(!tcbdbsetcodecfunc(bdb, _tc_recencode, NULL, _tc_recdecode, NULL)) printerr(bdb);
   if(!tcbdbopen(bdb, path, BDBOWRITER | omode)){
@@ -36,8 +36,11 @@ static void eprint(TCBDB *bdb, int line, const char *func);
 static void mprint(TCBDB *bdb);
 static void sysprint(void);
 static int myrand(int range);
+static int mybeint(char *buf, uint64_t num);
 static void *pdprocfunc(const void *vbuf, int vsiz, int *sp, void *op);
 static bool iterfunc(const void *kbuf, int ksiz, const void *vbuf, int vsiz, void *op);
+static bool itercount(const void *kbuf, int ksiz, const void *vbuf, int vsiz, void *op);
+static void reducecount(void *op, void *rop);
 static int runwrite(int argc, char **argv);
 static int runread(int argc, char **argv);
 static int runremove(int argc, char **argv);
@@ -47,7 +50,8 @@ static int runmisc(int argc, char **argv);
 static int runwicked(int argc, char **argv);
 static int procwrite(const char *path, int rnum, int lmemb, int nmemb, int bnum,
                      int apow, int fpow, bool mt, TCCMP cmp, int opts, int lcnum, int ncnum,
-                     int xmsiz, int dfunit, int lsmax, int capnum, int omode, bool rnd);
+                     int xmsiz, int dfunit, int lsmax, int capnum, int bsiz, int omode,
+                     bool rnd);
 static int procread(const char *path, bool mt, TCCMP cmp, int lcnum, int ncnum,
                     int xmsiz, int dfunit, int omode, bool wb, bool rnd);
 static int procremove(const char *path, bool mt, TCCMP cmp, int lcnum, int ncnum,
@@ -62,7 +66,8 @@ static int procqueue(const char *path, int rnum, int lmemb, int nmemb, int bnum,
                      int lcnum, int ncnum, int xmsiz, int dfunit, int lsmax, int capnum,
                      int omode);
 static int procmisc(const char *path, int rnum, bool mt, int opts, int omode);
-static int procwicked(const char *path, int rnum, bool mt, int opts, int omode);
+static int procwicked(const char *path, int rnum, bool mt, int opts, int omode, int tnum,
+                      int bsiz);
 
 
 /* main routine */
@@ -108,21 +113,22 @@ static void usage(void){
   fprintf(stderr, "%s: test cases of the B+ tree database API of Tokyo Cabinet\n", g_progname);
   fprintf(stderr, "\n");
   fprintf(stderr, "usage:\n");
-  fprintf(stderr, "  %s write [-mt] [-cd|-ci|-cj] [-tl] [-td|-tb|-tt|-tx] [-lc num] [-nc num]"
-          " [-xm num] [-df num] [-ls num] [-ca num] [-nl|-nb] [-rnd] path rnum"
+  fprintf(stderr, "  %s write [-mt] [-cd|-ci|-cj|-cb] [-tl] [-td|-tb|-tt|-tx] [-lc num] [-nc num]"
+          " [-xm num] [-df num] [-ls num] [-ca num] [-bf num] [-nl|-nb] [-rnd] path rnum"
           " [lmemb [nmemb [bnum [apow [fpow]]]]]\n", g_progname);
-  fprintf(stderr, "  %s read [-mt] [-cd|-ci|-cj] [-lc num] [-nc num] [-xm num] [-df num]"
+  fprintf(stderr, "  %s read [-mt] [-cd|-ci|-cj|-cb] [-lc num] [-nc num] [-xm num] [-df num]"
           " [-nl|-nb] [-wb] [-rnd] path\n", g_progname);
-  fprintf(stderr, "  %s remove [-mt] [-cd|-ci|-cj] [-lc num] [-nc num] [-xm num] [-df num]"
+  fprintf(stderr, "  %s remove [-mt] [-cd|-ci|-cj|-cb] [-lc num] [-nc num] [-xm num] [-df num]"
           " [-nl|-nb] [-rnd] path\n", g_progname);
-  fprintf(stderr, "  %s rcat [-mt] [-cd|-ci|-cj] [-tl] [-td|-tb|-tt|-tx] [-lc num] [-nc num]"
+  fprintf(stderr, "  %s rcat [-mt] [-cd|-ci|-cj|-cb] [-tl] [-td|-tb|-tt|-tx] [-lc num] [-nc num]"
           " [-xm num] [-df num] [-ls num] [-ca num] [-nl|-nb] [-pn num] [-dai|-dad|-rl|-ru]"
           " path rnum [lmemb [nmemb [bnum [apow [fpow]]]]]\n", g_progname);
-  fprintf(stderr, "  %s queue [-mt] [-cd|-ci|-cj] [-tl] [-td|-tb|-tt|-tx] [-lc num] [-nc num]"
+  fprintf(stderr, "  %s queue [-mt] [-cd|-ci|-cj|-cb] [-tl] [-td|-tb|-tt|-tx] [-lc num] [-nc num]"
           " [-xm num] [-df num] [-ls num] [-ca num] [-nl|-nb] path rnum"
           " [lmemb [nmemb [bnum [apow [fpow]]]]]\n", g_progname);
   fprintf(stderr, "  %s misc [-mt] [-tl] [-td|-tb|-tt|-tx] [-nl|-nb] path rnum\n", g_progname);
-  fprintf(stderr, "  %s wicked [-mt] [-tl] [-td|-tb|-tt|-tx] [-nl|-nb] path rnum\n", g_progname);
+  fprintf(stderr, "  %s wicked [-mt] [-tl] [-td|-tb|-tt|-tx] [-nl|-nb] [-tn num] [-bf num]"
+          " path rnum\n", g_progname);
   fprintf(stderr, "\n");
   exit(1);
 }
@@ -214,6 +220,16 @@ static int myrand(int range){
 }
 
 
+/* store a number as a big-endian integer of eight bytes */
+static int mybeint(char *buf, uint64_t num){
+  for(int i = sizeof(num) - 1; i >= 0; i--){
+    ((unsigned char *)buf)[i] = num & 0xff;
+    num >>= 8;
+  }
+  return sizeof(num);
+}
+
+
 /* duplication callback function */
 static void *pdprocfunc(const void *vbuf, int vsiz, int *sp, void *op){
   if(op){
@@ -255,6 +271,24 @@ static bool iterfunc(const void *kbuf, int ksiz, const void *vbuf, int vsiz, voi
 }
 
 
+/* iterator function to count records */
+static bool itercount(const void *kbuf, int ksiz, const void *vbuf, int vsiz, void *op){
+  int64_t *cnts = op;
+  cnts[0]++;
+  cnts[1] += ksiz + vsiz;
+  return true;
+}
+
+
+/* reduce function to sum up counts */
+static void reducecount(void *op, void *rop){
+  int64_t *cnts = op;
+  int64_t *sums = rop;
+  sums[0] += cnts[0];
+  sums[1] += cnts[1];
+}
+
+
 /* parse arguments of write command */
 static int runwrite(int argc, char **argv){
   char *path = NULL;
@@ -273,6 +307,7 @@ static int runwrite(int argc, char **argv){
   int dfunit = 0;
   int lsmax = 0;
   int capnum = 0;
+  int bsiz = 0;
   int omode = 0;
   bool rnd = false;
   for(int i = 2; i < argc; i++){
@@ -285,6 +320,8 @@ static int runwrite(int argc, char **argv){
         cmp = tccmpint32;
       } else if(!strcmp(argv[i], "-cj")){
         cmp = tccmpint64;
+      } else if(!strcmp(argv[i], "-cb")){
+        cmp = tccmpbeint;
       } else if(!strcmp(argv[i], "-tl")){
         opts |= BDBTLARGE;
       } else if(!strcmp(argv[i], "-td")){
@@ -313,6 +350,9 @@ static int runwrite(int argc, char **argv){
       } else if(!strcmp(argv[i], "-ca")){
         if(++i >= argc) usage();
         capnum = tcatoix(argv[i]);
+      } else if(!strcmp(argv[i], "-bf")){
+        if(++i >= argc) usage();
+        bsiz = tcatoix(argv[i]);
       } else if(!strcmp(argv[i], "-nl")){
         omode |= BDBONOLCK;
       } else if(!strcmp(argv[i], "-nb")){
@@ -349,7 +389,8 @@ static int runwrite(int argc, char **argv){
   int apow = astr ? tcatoix(astr) : -1;
   int fpow = fstr ? tcatoix(fstr) : -1;
   int rv = procwrite(path, rnum, lmemb, nmemb, bnum, apow, fpow,
-                     mt, cmp, opts, lcnum, ncnum, xmsiz, dfunit, lsmax, capnum, omode, rnd);
+                     mt, cmp, opts, lcnum, ncnum, xmsiz, dfunit, lsmax, capnum, bsiz, omode,
+                     rnd);
   return rv;
 }
 
@@ -376,6 +417,8 @@ static int runread(int argc, char **argv){
         cmp = tccmpint32;
       } else if(!strcmp(argv[i], "-cj")){
         cmp = tccmpint64;
+      } else if(!strcmp(argv[i], "-cb")){
+        cmp = tccmpbeint;
       } else if(!strcmp(argv[i], "-lc")){
         if(++i >= argc) usage();
         lcnum = tcatoix(argv[i]);
@@ -432,6 +475,8 @@ static int runremove(int argc, char **argv){
         cmp = tccmpint32;
       } else if(!strcmp(argv[i], "-cj")){
         cmp = tccmpint64;
+      } else if(!strcmp(argv[i], "-cb")){
+        cmp = tccmpbeint;
       } else if(!strcmp(argv[i], "-lc")){
         if(++i >= argc) usage();
         lcnum = tcatoix(argv[i]);
@@ -499,6 +544,8 @@ static int runrcat(int argc, char **argv){
         cmp = tccmpint32;
       } else if(!strcmp(argv[i], "-cj")){
         cmp = tccmpint64;
+      } else if(!strcmp(argv[i], "-cb")){
+        cmp = tccmpbeint;
       } else if(!strcmp(argv[i], "-tl")){
         opts |= BDBTLARGE;
       } else if(!strcmp(argv[i], "-td")){
@@ -606,6 +653,8 @@ static int runqueue(int argc, char **argv){
         cmp = tccmpint32;
       } else if(!strcmp(argv[i], "-cj")){
         cmp = tccmpint64;
+      } else if(!strcmp(argv[i], "-cb")){
+        cmp = tccmpbeint;
       } else if(!strcmp(argv[i], "-tl")){
         opts |= BDBTLARGE;
       } else if(!strcmp(argv[i], "-td")){
@@ -724,6 +773,8 @@ static int runwicked(int argc, char **argv){
   bool mt = false;
   int opts = 0;
   int omode = 0;
+  int tnum = 1;
+  int bsiz = 0;
   for(int i = 2; i < argc; i++){
     if(!path && argv[i][0] == '-'){
       if(!strcmp(argv[i], "-mt")){
@@ -742,6 +793,12 @@ static int runwicked(int argc, char **argv){
         omode |= BDBONOLCK;
       } else if(!strcmp(argv[i], "-nb")){
         omode |= BDBOLCKNB;
+      } else if(!strcmp(argv[i], "-tn")){
+        if(++i >= argc) usage();
+        tnum = tcatoix(argv[i]);
+      } else if(!strcmp(argv[i], "-bf")){
+        if(++i >= argc) usage();
+        bsiz = tcatoix(argv[i]);
       } else {
         usage();
       }
@@ -756,7 +813,7 @@ static int runwicked(int argc, char **argv){
   if(!path || !rstr) usage();
   int rnum = tcatoix(rstr);
   if(rnum < 1) usage();
-  int rv = procwicked(path, rnum, mt, opts, omode);
+  int rv = procwicked(path, rnum, mt, opts, omode, tnum, bsiz);
   return rv;
 }
 
@@ -764,12 +821,13 @@ static int runwicked(int argc, char **argv){
 /* perform write command */
 static int procwrite(const char *path, int rnum, int lmemb, int nmemb, int bnum,
                      int apow, int fpow, bool mt, TCCMP cmp, int opts, int lcnum, int ncnum,
-                     int xmsiz, int dfunit, int lsmax, int capnum, int omode, bool rnd){
+                     int xmsiz, int dfunit, int lsmax, int capnum, int bsiz, int omode,
+                     bool rnd){
   iprintf("<Writing Test>\n  seed=%u  path=%s  rnum=%d  lmemb=%d  nmemb=%d  bnum=%d  apow=%d"
           "  fpow=%d  mt=%d  cmp=%p  opts=%d  lcnum=%d  ncnum=%d  xmsiz=%d  dfunit=%d  lsmax=%d"
-          "  capnum=%d  omode=%d  rnd=%d\n\n",
+          "  capnum=%d  bsiz=%d  omode=%d  rnd=%d\n\n",
           g_randseed, path, rnum, lmemb, nmemb, bnum, apow, fpow, mt, (void *)(intptr_t)cmp,
-          opts, lcnum, ncnum, xmsiz, dfunit, lsmax, capnum, omode, rnd);
+          opts, lcnum, ncnum, xmsiz, dfunit, lsmax, capnum, bsiz, omode, rnd);
   bool err = false;
   double stime = tctime();
   TCBDB *bdb = tcbdbnew();
@@ -810,6 +868,10 @@ static int procwrite(const char *path, int rnum, int lmemb, int nmemb, int bnum,
     eprint(bdb, __LINE__, "tcbdbsetcapnum");
     err = true;
   }
+  if(!tcbdbsetbuffer(bdb, bsiz)){
+    eprint(bdb, __LINE__, "tcbdbsetbuffer");
+    err = true;
+  }
   if(!rnd) omode |= BDBOTRUNC;
   if(!tcbdbopen(bdb, path, BDBOWRITER | BDBOCREAT | omode)){
     eprint(bdb, __LINE__, "tcbdbopen");
@@ -828,6 +890,8 @@ static int procwrite(const char *path, int rnum, int lmemb, int nmemb, int bnum,
       int64_t llnum = rnd ? myrand(rnum) + 1 : i;
       memcpy(buf, &llnum, sizeof(llnum));
       len = sizeof(llnum);
+    } else if(cmp == tccmpbeint){
+      len = mybeint(buf, rnd ? myrand(rnum) + 1 : i);
     } else {
       len = sprintf(buf, "%08d", rnd ? myrand(rnum) + 1 : i);
     }
@@ -909,6 +973,8 @@ static int procread(const char *path, bool mt, TCCMP cmp, int lcnum, int ncnum,
       int64_t llnum = rnd ? myrand(rnum) + 1 : i;
       memcpy(kbuf, &llnum, sizeof(llnum));
       ksiz = sizeof(llnum);
+    } else if(cmp == tccmpbeint){
+      ksiz = mybeint(kbuf, rnd ? myrand(rnum) + 1 : i);
     } else {
       ksiz = sprintf(kbuf, "%08d", rnd ? myrand(rnum) + 1 : i);
     }
@@ -1002,6 +1068,8 @@ static int procremove(const char *path, bool mt, TCCMP cmp, int lcnum, int ncnum
       int64_t llnum = rnd ? myrand(rnum) + 1 : i;
       memcpy(kbuf, &llnum, sizeof(llnum));
       ksiz = sizeof(llnum);
+    } else if(cmp == tccmpbeint){
+      ksiz = mybeint(kbuf, rnd ? myrand(rnum) + 1 : i);
     } else {
       ksiz = sprintf(kbuf, "%08d", rnd ? myrand(rnum) + 1 : i);
     }
@@ -1172,6 +1240,8 @@ static int procrcat(const char *path, int rnum,
         int64_t llnum = myrand(pnum);
         memcpy(kbuf, &llnum, sizeof(llnum));
         ksiz = sizeof(llnum);
+      } else if(cmp == tccmpbeint){
+        ksiz = mybeint(kbuf, myrand(pnum));
       } else {
         ksiz = sprintf(kbuf, "%d", myrand(pnum));
       }
@@ -1295,6 +1365,8 @@ static int procqueue(const char *path, int rnum, int lmemb, int nmemb, int bnum,
       int64_t llnum = i;
       memcpy(buf, &llnum, sizeof(llnum));
       len = sizeof(llnum);
+    } else if(cmp == tccmpbeint){
+      len = mybeint(buf, i);
     } else {
       len = sprintf(buf, "%08d", i);
     }
@@ -1868,6 +1940,187 @@ static int procmisc(const char *path, int rnum, bool mt, int opts, int omode){
     eprint(bdb, __LINE__, "tcbdbcurput2");
     err = true;
   }
+  iprintf("checking overflowed duplication:\n");
+  TCLIST *dvals = tclistnew();
+  for(int i = 1; i <= rnum; i++){
+    char vbuf[RECBUFSIZ];
+    int vsiz = sprintf(vbuf, "%08d", i);
+    if(!tcbdbputdup(bdb, "dup", 3, vbuf, vsiz)){
+      eprint(bdb, __LINE__, "tcbdbputdup");
+      err = true;
+      break;
+    }
+    tclistpush(dvals, vbuf, vsiz);
+    if(rnum > 250 && i % (rnum / 250) == 0){
+      iputchar('.');
+      if(i == rnum || i % (rnum / 10) == 0) iprintf(" (%08d)\n", i);
+    }
+  }
+  if(!tcbdbcurjump(cur, "dup", 3)){
+    eprint(bdb, __LINE__, "tcbdbcurjump");
+    err = true;
+  }
+  int didx = 0;
+  while(!err && didx < tclistnum(dvals)){
+    switch(myrand(4)){
+    case 0:
+      if(!tcbdbcurout(cur)){
+        eprint(bdb, __LINE__, "tcbdbcurout");
+        err = true;
+      }
+      tcfree(tclistremove2(dvals, didx));
+      continue;
+    case 1:
+      if(!tcbdbcurput2(cur, "before", BDBCPBEFORE) || !tcbdbcurnext(cur)){
+        eprint(bdb, __LINE__, "tcbdbcurput2");
+        err = true;
+      }
+      tclistinsert2(dvals, didx++, "before");
+      break;
+    case 2:
+      if(!tcbdbcurput2(cur, "current", BDBCPCURRENT)){
+        eprint(bdb, __LINE__, "tcbdbcurput2");
+        err = true;
+      }
+      tclistover2(dvals, didx, "current");
+      break;
+    }
+    if(++didx < tclistnum(dvals) && !tcbdbcurnext(cur)){
+      eprint(bdb, __LINE__, "tcbdbcurnext");
+      err = true;
+    }
+  }
+  if(!tcbdbtranbegin(bdb)){
+    eprint(bdb, __LINE__, "tcbdbtranbegin");
+    err = true;
+  }
+  for(int i = 1; i <= rnum; i++){
+    if(!tcbdbputdup2(bdb, "dup", "aborted")){
+      eprint(bdb, __LINE__, "tcbdbputdup2");
+      err = true;
+      break;
+    }
+  }
+  if(!tcbdbtranabort(bdb)){
+    eprint(bdb, __LINE__, "tcbdbtranabort");
+    err = true;
+  }
+  TCLIST *vals = tcbdbget4(bdb, "dup", 3);
+  if(tclistnum(dvals) > 0){
+    if(!vals || tclistnum(vals) != tclistnum(dvals) ||
+       tcbdbvnum(bdb, "dup", 3) != tclistnum(dvals)){
+      eprint(bdb, __LINE__, "(validation)");
+      err = true;
+    } else {
+      for(int i = 0; i < tclistnum(dvals); i++){
+        if(strcmp(tclistval2(vals, i), tclistval2(dvals, i))){
+          eprint(bdb, __LINE__, "(validation)");
+          err = true;
+          break;
+        }
+      }
+    }
+  }
+  if(vals) tclistdel(vals);
+  tclistdel(dvals);
+  iprintf("checking parallel iteration:\n");
+  int64_t sums[2] = { 0, 0 };
+  if(!tcbdbforeach(bdb, itercount, sums)){
+    eprint(bdb, __LINE__, "tcbdbforeach");
+    err = true;
+  }
+  int tnum = myrand(4) + 2;
+  int64_t cnts[tnum][2];
+  void *pops[tnum];
+  for(int i = 0; i < tnum; i++){
+    cnts[i][0] = 0;
+    cnts[i][1] = 0;
+    pops[i] = cnts[i];
+  }
+  int64_t psums[2] = { 0, 0 };
+  if(!tcbdbforeachpar(bdb, itercount, pops, tnum, reducecount, psums)){
+    eprint(bdb, __LINE__, "tcbdbforeachpar");
+    err = true;
+  }
+  if(psums[0] != sums[0] || psums[1] != sums[1] || psums[0] != tcbdbrnum(bdb)){
+    eprint(bdb, __LINE__, "(validation)");
+    err = true;
+  }
+  if(!tcbdbvanish(bdb)){
+    eprint(bdb, __LINE__, "tcbdbvanish");
+    err = true;
+  }
+  iprintf("checking order statistics:\n");
+  for(int i = 1; i <= rnum; i++){
+    char kbuf[RECBUFSIZ];
+    int ksiz = sprintf(kbuf, "%08d", myrand(rnum));
+    if(!tcbdbputdup(bdb, kbuf, ksiz, kbuf, ksiz)){
+      eprint(bdb, __LINE__, "tcbdbputdup");
+      err = true;
+      break;
+    }
+    if(myrand(10) == 0){
+      ksiz = sprintf(kbuf, "%08d", myrand(rnum));
+      if(!tcbdbout(bdb, kbuf, ksiz) && tcbdbecode(bdb) != TCENOREC){
+        eprint(bdb, __LINE__, "tcbdbout");
+        err = true;
+        break;
+      }
+    }
+    if(rnum > 250 && i % (rnum / 250) == 0){
+      iputchar('.');
+      if(i == rnum || i % (rnum / 10) == 0) iprintf(" (%08d)\n", i);
+    }
+  }
+  if(tcbdbrangecount(bdb, NULL, 0, true, NULL, 0, true) != tcbdbrnum(bdb)){
+    eprint(bdb, __LINE__, "tcbdbrangecount");
+    err = true;
+  }
+  BDBCUR *ncur = tcbdbcurnew(bdb);
+  int64_t pos = 0;
+  int64_t krank = 0;
+  char *okbuf = NULL;
+  int oksiz = 0;
+  tcbdbcurfirst(cur);
+  while(!err && (kbuf = tcbdbcurkey(cur, &ksiz)) != NULL){
+    if(!okbuf || ksiz != oksiz || memcmp(kbuf, okbuf, ksiz)){
+      if(tcbdbrank(bdb, kbuf, ksiz) != pos){
+        eprint(bdb, __LINE__, "tcbdbrank");
+        err = true;
+      }
+      if(okbuf && tcbdbrangecount(bdb, okbuf, oksiz, true, kbuf, ksiz, false) != pos - krank){
+        eprint(bdb, __LINE__, "tcbdbrangecount");
+        err = true;
+      }
+      tcfree(okbuf);
+      okbuf = tcmemdup(kbuf, ksiz);
+      oksiz = ksiz;
+      krank = pos;
+    }
+    if(myrand(10) == 0){
+      int nksiz;
+      char *nkbuf;
+      if(!tcbdbcurjumpnth(ncur, pos) || !(nkbuf = tcbdbcurkey(ncur, &nksiz))){
+        eprint(bdb, __LINE__, "tcbdbcurjumpnth");
+        err = true;
+      } else {
+        if(nksiz != ksiz || memcmp(nkbuf, kbuf, ksiz)){
+          eprint(bdb, __LINE__, "(validation)");
+          err = true;
+        }
+        tcfree(nkbuf);
+      }
+    }
+    tcfree(kbuf);
+    pos++;
+    tcbdbcurnext(cur);
+  }
+  tcfree(okbuf);
+  if(pos != tcbdbrnum(bdb) || tcbdbcurjumpnth(ncur, pos)){
+    eprint(bdb, __LINE__, "(validation)");
+    err = true;
+  }
+  tcbdbcurdel(ncur);
   if(!tcbdbvanish(bdb)){
     eprint(bdb, __LINE__, "tcbdbvanish");
     err = true;
@@ -2184,9 +2437,10 @@ static int procmisc(const char *path, int rnum, bool mt, int opts, int omode){
 
 
 /* perform wicked command */
-static int procwicked(const char *path, int rnum, bool mt, int opts, int omode){
-  iprintf("<Wicked Writing Test>\n  seed=%u  path=%s  rnum=%d  mt=%d  opts=%d  omode=%d\n\n",
-          g_randseed, path, rnum, mt, opts, omode);
+static int procwicked(const char *path, int rnum, bool mt, int opts, int omode, int tnum,
+                      int bsiz){
+  iprintf("<Wicked Writing Test>\n  seed=%u  path=%s  rnum=%d  mt=%d  opts=%d  omode=%d"
+          "  tnum=%d  bsiz=%d\n\n", g_randseed, path, rnum, mt, opts, omode, tnum, bsiz);
   bool err = false;
   double stime = tctime();
   TCBDB *bdb = tcbdbnew();
@@ -2215,6 +2469,14 @@ static int procwicked(const char *path, int rnum, bool mt, int opts, int omode){
     eprint(bdb, __LINE__, "tcbdbsetdfunit");
     err = true;
   }
+  if(!tcbdbsetparallel(bdb, tnum, 0, NULL, NULL)){
+    eprint(bdb, __LINE__, "tcbdbsetparallel");
+    err = true;
+  }
+  if(!tcbdbsetbuffer(bdb, bsiz)){
+    eprint(bdb, __LINE__, "tcbdbsetbuffer");
+    err = true;
+  }
   if(!tcbdbopen(bdb, path, BDBOWRITER | BDBOCREAT | BDBOTRUNC | omode)){
     eprint(bdb, __LINE__, "tcbdbopen");
     err = true;
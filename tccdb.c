@@ -0,0 +1,930 @@
+/*************************************************************************************************
+ * The column database API of Tokyo Cabinet
+ *                                                      Copyright (C) 2006-2009 Mikio Hirabayashi
+ * This file is part of Tokyo Cabinet.
+ * Tokyo Cabinet is free software; you can redistribute it and/or modify it under the terms of
+ * the GNU Lesser General Public License as published by the Free Software Foundation; either
+ * version 2.1 of the License or any later version.  Tokyo Cabinet is distributed in the hope
+ * that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ * You should have received a copy of the GNU Lesser General Public License along with Tokyo
+ * Cabinet; if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307 USA.
+ *************************************************************************************************/
+
+
+#include "tcutil.h"
+#include "tcfdb.h"
+#include "tccdb.h"
+#include "myconf.h"
+
+#define CDBDEFLIMID    (1LL<<20)         // default limit ID number
+#define CDBCOLSUFFIX   "col"             // suffix of column files
+#define CDBIDMARK      "1"               // value marking an existing ID
+#define CDBHEADSIZ     256               // size of the header of each file
+#define CDBWSIZMAX     4                 // maximum size of the width region of each record
+#define CDBSPL1NUM     (1 << 16)         // number of entries of the first level directory
+#define CDBSPL2NUM     (1 << 14)         // number of entries of a second level directory
+#define CDBSPPGREC     (1 << 10)         // number of records in a page of the sparse layout
+#define CDBSPALIGN     4096              // alignment of regions of the sparse layout
+
+
+/* private macros */
+#define CDBLOCKMETHOD(TC_cdb, TC_wr) \
+  ((TC_cdb)->mmtx ? tccdblockmethod((TC_cdb), (TC_wr)) : true)
+#define CDBUNLOCKMETHOD(TC_cdb) \
+  ((TC_cdb)->mmtx ? tccdbunlockmethod(TC_cdb) : true)
+
+
+/* private function prototypes */
+static void tccdbclear(TCCDB *cdb);
+static int64_t tccdblimsiz(TCCDB *cdb, int width);
+static int tccdbfomode(TCCDB *cdb);
+static const char *tccdbtypename(int type);
+static bool tccdbopencol(TCCDB *cdb, const char *path, const char *name, int type, int width,
+                         int omode);
+static CDBCOL *tccdbfindcol(TCCDB *cdb, const char *name);
+static bool tccdbopenimpl(TCCDB *cdb, const char *path, int omode);
+static bool tccdbcloseimpl(TCCDB *cdb);
+static bool tccdbsetcolimpl(TCCDB *cdb, const char *name, int type, int width);
+static bool tccdbcheckval(TCCDB *cdb, CDBCOL *col, int vsiz);
+static bool tccdbputimpl(TCCDB *cdb, int64_t id, TCMAP *cols);
+static bool tccdbputcolimpl(TCCDB *cdb, int64_t id, CDBCOL *col, const void *vbuf, int vsiz);
+static bool tccdboutimpl(TCCDB *cdb, int64_t id);
+static TCMAP *tccdbgetimpl(TCCDB *cdb, int64_t id);
+static bool tccdbvanishimpl(TCCDB *cdb);
+static bool tccdblockmethod(TCCDB *cdb, bool wr);
+static bool tccdbunlockmethod(TCCDB *cdb);
+
+
+
+/*************************************************************************************************
+ * API
+ *************************************************************************************************/
+
+
+/* Get the message string corresponding to an error code. */
+const char *tccdberrmsg(int ecode){
+  return tcerrmsg(ecode);
+}
+
+
+/* Create a column database object. */
+TCCDB *tccdbnew(void){
+  TCCDB *cdb;
+  TCMALLOC(cdb, sizeof(*cdb));
+  tccdbclear(cdb);
+  cdb->fdb = tcfdbnew();
+  return cdb;
+}
+
+
+/* Delete a column database object. */
+void tccdbdel(TCCDB *cdb){
+  assert(cdb);
+  if(cdb->open) tccdbclose(cdb);
+  tcfdbdel(cdb->fdb);
+  if(cdb->mmtx){
+    pthread_rwlock_destroy(cdb->mmtx);
+    TCFREE(cdb->mmtx);
+  }
+  TCFREE(cdb);
+}
+
+
+/* Get the last happened error code of a column database object. */
+int tccdbecode(TCCDB *cdb){
+  assert(cdb);
+  return tcfdbecode(cdb->fdb);
+}
+
+
+/* Set mutual exclusion control of a column database object for threading. */
+bool tccdbsetmutex(TCCDB *cdb){
+  assert(cdb);
+  if(!TCUSEPTHREAD) return true;
+  if(cdb->mmtx || cdb->open){
+    tccdbsetecode(cdb, TCEINVALID, __FILE__, __LINE__, __func__);
+    return false;
+  }
+  TCMALLOC(cdb->mmtx, sizeof(pthread_rwlock_t));
+  if(pthread_rwlock_init(cdb->mmtx, NULL) != 0){
+    TCFREE(cdb->mmtx);
+    cdb->mmtx = NULL;
+    return false;
+  }
+  return tcfdbsetmutex(cdb->fdb);
+}
+
+
+/* Set the tuning parameters of a column database object. */
+bool tccdbtune(TCCDB *cdb, int64_t limid, uint8_t opts){
+  assert(cdb);
+  if(cdb->open){
+    tccdbsetecode(cdb, TCEINVALID, __FILE__, __LINE__, __func__);
+    return false;
+  }
+  cdb->limid = (limid > 0) ? limid : CDBDEFLIMID;
+  cdb->opts = opts;
+  return true;
+}
+
+
+/* Open a database file and connect a column database object. */
+bool tccdbopen(TCCDB *cdb, const char *path, int omode){
+  assert(cdb && path);
+  if(!CDBLOCKMETHOD(cdb, true)) return false;
+  if(cdb->open){
+    tccdbsetecode(cdb, TCEINVALID, __FILE__, __LINE__, __func__);
+    CDBUNLOCKMETHOD(cdb);
+    return false;
+  }
+  bool rv = tccdbopenimpl(cdb, path, omode);
+  CDBUNLOCKMETHOD(cdb);
+  return rv;
+}
+
+
+/* Close a column database object. */
+bool tccdbclose(TCCDB *cdb){
+  assert(cdb);
+  if(!CDBLOCKMETHOD(cdb, true)) return false;
+  if(!cdb->open){
+    tccdbsetecode(cdb, TCEINVALID, __FILE__, __LINE__, __func__);
+    CDBUNLOCKMETHOD(cdb);
+    return false;
+  }
+  bool rv = tccdbcloseimpl(cdb);
+  CDBUNLOCKMETHOD(cdb);
+  return rv;
+}
+
+
+/* Add a column to a column database object. */
+bool tccdbsetcol(TCCDB *cdb, const char *name, int type, int width){
+  assert(cdb && name);
+  if(!CDBLOCKMETHOD(cdb, true)) return false;
+  if(!cdb->open || !cdb->wmode){
+    tccdbsetecode(cdb, TCEINVALID, __FILE__, __LINE__, __func__);
+    CDBUNLOCKMETHOD(cdb);
+    return false;
+  }
+  bool rv = tccdbsetcolimpl(cdb, name, type, width);
+  CDBUNLOCKMETHOD(cdb);
+  return rv;
+}
+
+
+/* Store a record into a column database object. */
+bool tccdbput(TCCDB *cdb, int64_t id, TCMAP *cols){
+  assert(cdb && cols);
+  if(!CDBLOCKMETHOD(cdb, true)) return false;
+  if(!cdb->open || !cdb->wmode || id < 1){
+    tccdbsetecode(cdb, TCEINVALID, __FILE__, __LINE__, __func__);
+    CDBUNLOCKMETHOD(cdb);
+    return false;
+  }
+  bool rv = tccdbputimpl(cdb, id, cols);
+  CDBUNLOCKMETHOD(cdb);
+  return rv;
+}
+
+
+/* Store a column value of a record into a column database object. */
+bool tccdbputcol(TCCDB *cdb, int64_t id, const char *name, const void *vbuf, int vsiz){
+  assert(cdb && name && vbuf && vsiz >= 0);
+  if(!CDBLOCKMETHOD(cdb, true)) return false;
+  if(!cdb->open || !cdb->wmode || id < 1){
+    tccdbsetecode(cdb, TCEINVALID, __FILE__, __LINE__, __func__);
+    CDBUNLOCKMETHOD(cdb);
+    return false;
+  }
+  CDBCOL *col = tccdbfindcol(cdb, name);
+  if(!col || !tccdbcheckval(cdb, col, vsiz)){
+    if(!col) tccdbsetecode(cdb, TCEINVALID, __FILE__, __LINE__, __func__);
+    CDBUNLOCKMETHOD(cdb);
+    return false;
+  }
+  bool rv = tccdbputcolimpl(cdb, id, col, vbuf, vsiz);
+  CDBUNLOCKMETHOD(cdb);
+  return rv;
+}
+
+
+/* Remove a record of a column database object. */
+bool tccdbout(TCCDB *cdb, int64_t id){
+  assert(cdb);
+  if(!CDBLOCKMETHOD(cdb, true)) return false;
+  if(!cdb->open || !cdb->wmode || id < 1){
+    tccdbsetecode(cdb, TCEINVALID, __FILE__, __LINE__, __func__);
+    CDBUNLOCKMETHOD(cdb);
+    return false;
+  }
+  bool rv = tccdboutimpl(cdb, id);
+  CDBUNLOCKMETHOD(cdb);
+  return rv;
+}
+
+
+/* Retrieve a record in a column database object. */
+TCMAP *tccdbget(TCCDB *cdb, int64_t id){
+  assert(cdb);
+  if(!CDBLOCKMETHOD(cdb, false)) return NULL;
+  if(!cdb->open || id < 1){
+    tccdbsetecode(cdb, TCEINVALID, __FILE__, __LINE__, __func__);
+    CDBUNLOCKMETHOD(cdb);
+    return NULL;
+  }
+  TCMAP *rv = tccdbgetimpl(cdb, id);
+  CDBUNLOCKMETHOD(cdb);
+  return rv;
+}
+
+
+/* Retrieve a column value of a record in a column database object. */
+void *tccdbgetcol(TCCDB *cdb, int64_t id, const char *name, int *sp){
+  assert(cdb && name && sp);
+  if(!CDBLOCKMETHOD(cdb, false)) return NULL;
+  CDBCOL *col = cdb->open ? tccdbfindcol(cdb, name) : NULL;
+  if(!col || id < 1){
+    tccdbsetecode(cdb, TCEINVALID, __FILE__, __LINE__, __func__);
+    CDBUNLOCKMETHOD(cdb);
+    return NULL;
+  }
+  void *rv = tcfdbget(col->db, id, sp);
+  if(!rv) tccdbsetecode(cdb, tcfdbecode(col->db), __FILE__, __LINE__, __func__);
+  CDBUNLOCKMETHOD(cdb);
+  return rv;
+}
+
+
+/* Initialize the iterator of a column database object. */
+bool tccdbiterinit(TCCDB *cdb){
+  assert(cdb);
+  if(!CDBLOCKMETHOD(cdb, true)) return false;
+  if(!cdb->open){
+    tccdbsetecode(cdb, TCEINVALID, __FILE__, __LINE__, __func__);
+    CDBUNLOCKMETHOD(cdb);
+    return false;
+  }
+  bool rv = tcfdbiterinit(cdb->fdb);
+  CDBUNLOCKMETHOD(cdb);
+  return rv;
+}
+
+
+/* Get the next ID number of the iterator of a column database object. */
+uint64_t tccdbiternext(TCCDB *cdb){
+  assert(cdb);
+  if(!CDBLOCKMETHOD(cdb, true)) return 0;
+  if(!cdb->open){
+    tccdbsetecode(cdb, TCEINVALID, __FILE__, __LINE__, __func__);
+    CDBUNLOCKMETHOD(cdb);
+    return 0;
+  }
+  uint64_t rv = tcfdbiternext(cdb->fdb);
+  CDBUNLOCKMETHOD(cdb);
+  return rv;
+}
+
+
+/* Get range matching ID numbers in a column database object. */
+uint64_t *tccdbrange(TCCDB *cdb, int64_t lower, int64_t upper, int max, int *np){
+  assert(cdb && np);
+  if(!CDBLOCKMETHOD(cdb, false)) return false;
+  if(!cdb->open){
+    tccdbsetecode(cdb, TCEINVALID, __FILE__, __LINE__, __func__);
+    CDBUNLOCKMETHOD(cdb);
+    *np = 0;
+    return tcmalloc(1);
+  }
+  uint64_t *rv = tcfdbrange(cdb->fdb, lower, upper, max, np);
+  CDBUNLOCKMETHOD(cdb);
+  return rv;
+}
+
+
+/* Scan a column of records in a range of a column database object and aggregate matching ones. */
+bool tccdbscan(TCCDB *cdb, const char *name, int64_t lower, int64_t upper, int op,
+               const void *ebuf, int esiz, int tnum, FDBSCANRES *res){
+  assert(cdb && name && res);
+  if(!CDBLOCKMETHOD(cdb, false)) return false;
+  CDBCOL *col = cdb->open ? tccdbfindcol(cdb, name) : NULL;
+  if(!col){
+    tccdbsetecode(cdb, TCEINVALID, __FILE__, __LINE__, __func__);
+    CDBUNLOCKMETHOD(cdb);
+    return false;
+  }
+  int vtype;
+  switch(col->type){
+  case CDBCTINT:
+    vtype = FDBSVINT;
+    break;
+  case CDBCTLONG:
+    vtype = FDBSVLONG;
+    break;
+  case CDBCTDBL:
+    vtype = FDBSVDBL;
+    break;
+  default:
+    vtype = FDBSVSTR;
+    break;
+  }
+  bool rv = tcfdbscan(col->db, lower, upper, vtype, op, ebuf, esiz, tnum, res);
+  if(!rv) tccdbsetecode(cdb, tcfdbecode(col->db), __FILE__, __LINE__, __func__);
+  CDBUNLOCKMETHOD(cdb);
+  return rv;
+}
+
+
+/* Synchronize updated contents of a column database object with the files and the device. */
+bool tccdbsync(TCCDB *cdb){
+  assert(cdb);
+  if(!CDBLOCKMETHOD(cdb, true)) return false;
+  if(!cdb->open || !cdb->wmode){
+    tccdbsetecode(cdb, TCEINVALID, __FILE__, __LINE__, __func__);
+    CDBUNLOCKMETHOD(cdb);
+    return false;
+  }
+  bool err = false;
+  for(int i = 0; i < cdb->cnum; i++){
+    if(!tcfdbsync(cdb->cols[i].db)){
+      tccdbsetecode(cdb, tcfdbecode(cdb->cols[i].db), __FILE__, __LINE__, __func__);
+      err = true;
+    }
+  }
+  if(!tcfdbsync(cdb->fdb)) err = true;
+  CDBUNLOCKMETHOD(cdb);
+  return !err;
+}
+
+
+/* Remove all records of a column database object. */
+bool tccdbvanish(TCCDB *cdb){
+  assert(cdb);
+  if(!CDBLOCKMETHOD(cdb, true)) return false;
+  if(!cdb->open || !cdb->wmode){
+    tccdbsetecode(cdb, TCEINVALID, __FILE__, __LINE__, __func__);
+    CDBUNLOCKMETHOD(cdb);
+    return false;
+  }
+  bool rv = tccdbvanishimpl(cdb);
+  CDBUNLOCKMETHOD(cdb);
+  return rv;
+}
+
+
+/* Get the file path of a column database object. */
+const char *tccdbpath(TCCDB *cdb){
+  assert(cdb);
+  if(!CDBLOCKMETHOD(cdb, false)) return NULL;
+  if(!cdb->open){
+    tccdbsetecode(cdb, TCEINVALID, __FILE__, __LINE__, __func__);
+    CDBUNLOCKMETHOD(cdb);
+    return NULL;
+  }
+  const char *rv = tcfdbpath(cdb->fdb);
+  CDBUNLOCKMETHOD(cdb);
+  return rv;
+}
+
+
+/* Get the number of records of a column database object. */
+uint64_t tccdbrnum(TCCDB *cdb){
+  assert(cdb);
+  if(!CDBLOCKMETHOD(cdb, false)) return 0;
+  if(!cdb->open){
+    tccdbsetecode(cdb, TCEINVALID, __FILE__, __LINE__, __func__);
+    CDBUNLOCKMETHOD(cdb);
+    return 0;
+  }
+  uint64_t rv = tcfdbrnum(cdb->fdb);
+  CDBUNLOCKMETHOD(cdb);
+  return rv;
+}
+
+
+/* Get the total size of the database files of a column database object. */
+uint64_t tccdbfsiz(TCCDB *cdb){
+  assert(cdb);
+  if(!CDBLOCKMETHOD(cdb, false)) return 0;
+  if(!cdb->open){
+    tccdbsetecode(cdb, TCEINVALID, __FILE__, __LINE__, __func__);
+    CDBUNLOCKMETHOD(cdb);
+    return 0;
+  }
+  uint64_t rv = tcfdbfsiz(cdb->fdb);
+  for(int i = 0; i < cdb->cnum; i++){
+    rv += tcfdbfsiz(cdb->cols[i].db);
+  }
+  CDBUNLOCKMETHOD(cdb);
+  return rv;
+}
+
+
+
+/*************************************************************************************************
+ * features for experts
+ *************************************************************************************************/
+
+
+/* Set the error code of a column database object. */
+void tccdbsetecode(TCCDB *cdb, int ecode, const char *filename, int line, const char *func){
+  assert(cdb && filename && line >= 1 && func);
+  tcfdbsetecode(cdb->fdb, ecode, filename, line, func);
+}
+
+
+/* Set the file descriptor for debugging output. */
+void tccdbsetdbgfd(TCCDB *cdb, int fd){
+  assert(cdb && fd >= 0);
+  tcfdbsetdbgfd(cdb->fdb, fd);
+}
+
+
+/* Get the file descriptor for debugging output. */
+int tccdbdbgfd(TCCDB *cdb){
+  assert(cdb);
+  return tcfdbdbgfd(cdb->fdb);
+}
+
+
+/* Get the number of columns of a column database object. */
+int tccdbcolnum(TCCDB *cdb){
+  assert(cdb);
+  return cdb->cnum;
+}
+
+
+/* Get the name of a column of a column database object. */
+const char *tccdbcolname(TCCDB *cdb, int idx){
+  assert(cdb);
+  if(idx < 0 || idx >= cdb->cnum) return NULL;
+  return cdb->cols[idx].name;
+}
+
+
+/* Get the type of a column of a column database object. */
+int tccdbcoltype(TCCDB *cdb, const char *name){
+  assert(cdb && name);
+  CDBCOL *col = tccdbfindcol(cdb, name);
+  return col ? col->type : -1;
+}
+
+
+/* Get the width of a column of a column database object. */
+int tccdbcolwidth(TCCDB *cdb, const char *name){
+  assert(cdb && name);
+  CDBCOL *col = tccdbfindcol(cdb, name);
+  return col ? (int)tcfdbwidth(col->db) : -1;
+}
+
+
+/* Get the fixed-length database object of a column of a column database object. */
+TCFDB *tccdbcoldb(TCCDB *cdb, const char *name){
+  assert(cdb && name);
+  CDBCOL *col = tccdbfindcol(cdb, name);
+  return col ? col->db : NULL;
+}
+
+
+
+/*************************************************************************************************
+ * private features
+ *************************************************************************************************/
+
+
+/* Clear all members.
+   `cdb' specifies the column database object. */
+static void tccdbclear(TCCDB *cdb){
+  assert(cdb);
+  cdb->mmtx = NULL;
+  cdb->fdb = NULL;
+  cdb->open = false;
+  cdb->wmode = false;
+  cdb->limid = CDBDEFLIMID;
+  cdb->opts = 0;
+  cdb->cols = NULL;
+  cdb->cnum = 0;
+}
+
+
+/* Get the limit size of a file of a column database object.
+   `cdb' specifies the column database object.
+   `width' specifies the width of the values of the file.
+   The return value is the limit size enough for the limit ID number.
+   In the sparse layout, the size covers the worst case where every page and every table below
+   the limit ID number is populated, each of them aligned to the page size. */
+static int64_t tccdblimsiz(TCCDB *cdb, int width){
+  assert(cdb && width > 0);
+  int64_t rsiz = width + CDBWSIZMAX;
+  if(!(cdb->opts & CDBTSPARSE)) return CDBHEADSIZ + (cdb->limid + 1) * rsiz;
+  int64_t pnum = cdb->limid / CDBSPPGREC + 1;
+  int64_t tnum = pnum / CDBSPL2NUM + 1;
+  return CDBHEADSIZ + CDBSPL1NUM * sizeof(uint64_t) + CDBSPALIGN +
+    tnum * (CDBSPL2NUM * sizeof(uint64_t) + CDBSPALIGN) +
+    pnum * (CDBSPPGREC / 8 + CDBSPPGREC * rsiz + CDBSPALIGN);
+}
+
+
+/* Get the open mode of the column files of a column database object.
+   `cdb' specifies the column database object.
+   The return value is the open mode of the fixed-length database of the ID space. */
+static int tccdbfomode(TCCDB *cdb){
+  assert(cdb);
+  int omode = tcfdbomode(cdb->fdb);
+  return omode & (FDBOREADER | FDBOWRITER | FDBONOLCK | FDBOLCKNB);
+}
+
+
+/* Get the name of a column type.
+   `type' specifies the column type.
+   The return value is the name used as the suffix of the column file. */
+static const char *tccdbtypename(int type){
+  switch(type){
+  case CDBCTINT: return "int";
+  case CDBCTLONG: return "long";
+  case CDBCTDBL: return "dbl";
+  }
+  return "str";
+}
+
+
+/* Open the file of a column of a column database object.
+   `cdb' specifies the column database object.
+   `path' specifies the path of the column file.
+   `name' specifies the name of the column.
+   `type' specifies the type of the column.
+   `width' specifies the width of the values.
+   `omode' specifies the open mode of the column file.
+   If successful, the return value is true, else, it is false. */
+static bool tccdbopencol(TCCDB *cdb, const char *path, const char *name, int type, int width,
+                         int omode){
+  assert(cdb && path && name && width > 0);
+  TCFDB *fdb = tcfdbnew();
+  int dbgfd = tcfdbdbgfd(cdb->fdb);
+  if(dbgfd >= 0) tcfdbsetdbgfd(fdb, dbgfd);
+  if(cdb->mmtx) tcfdbsetmutex(fdb);
+  tcfdbtune(fdb, width, tccdblimsiz(cdb, width));
+  if(cdb->opts & CDBTSPARSE) tcfdbsetopts(fdb, FDBTSPARSE);
+  if(!tcfdbopen(fdb, path, omode)){
+    tccdbsetecode(cdb, tcfdbecode(fdb), __FILE__, __LINE__, __func__);
+    tcfdbdel(fdb);
+    return false;
+  }
+  TCREALLOC(cdb->cols, cdb->cols, sizeof(cdb->cols[0]) * (cdb->cnum + 1));
+  CDBCOL *col = cdb->cols + cdb->cnum;
+  col->name = tcstrdup(name);
+  col->type = type;
+  col->db = fdb;
+  cdb->cnum++;
+  return true;
+}
+
+
+/* Find a column of a column database object.
+   `cdb' specifies the column database object.
+   `name' specifies the name of the column.
+   The return value is the column object or `NULL' if it does not exist. */
+static CDBCOL *tccdbfindcol(TCCDB *cdb, const char *name){
+  assert(cdb && name);
+  for(int i = 0; i < cdb->cnum; i++){
+    if(!strcmp(cdb->cols[i].name, name)) return cdb->cols + i;
+  }
+  return NULL;
+}
+
+
+/* Open a database file and connect a column database object.
+   `cdb' specifies the column database object.
+   `path' specifies the path of the database file.
+   `omode' specifies the connection mode.
+   If successful, the return value is true, else, it is false. */
+static bool tccdbopenimpl(TCCDB *cdb, const char *path, int omode){
+  assert(cdb && path);
+  int fomode = 0;
+  if(omode & CDBOWRITER){
+    fomode = FDBOWRITER;
+    if(omode & CDBOCREAT) fomode |= FDBOCREAT;
+    if(omode & CDBOTRUNC) fomode |= FDBOTRUNC;
+    cdb->wmode = true;
+  } else {
+    fomode = FDBOREADER;
+    cdb->wmode = false;
+  }
+  if(omode & CDBONOLCK) fomode |= FDBONOLCK;
+  if(omode & CDBOLCKNB) fomode |= FDBOLCKNB;
+  tcfdbtune(cdb->fdb, sizeof(CDBIDMARK) - 1, tccdblimsiz(cdb, sizeof(CDBIDMARK) - 1));
+  if(cdb->opts & CDBTSPARSE) tcfdbsetopts(cdb->fdb, FDBTSPARSE);
+  if(!tcfdbopen(cdb->fdb, path, fomode)) return false;
+  cdb->opts = (tcfdbopts(cdb->fdb) & FDBTSPARSE) ? CDBTSPARSE : 0;
+  char *tpath = tcsprintf("%s%c%s%c*", path, MYEXTCHR, CDBCOLSUFFIX, MYEXTCHR);
+  if((omode & CDBOWRITER) && (omode & CDBOTRUNC)){
+    TCLIST *paths = tcglobpat(tpath);
+    int pnum = TCLISTNUM(paths);
+    for(int i = 0; i < pnum; i++){
+      unlink(TCLISTVALPTR(paths, i));
+    }
+    tclistdel(paths);
+  }
+  int comode = tccdbfomode(cdb);
+  bool err = false;
+  TCLIST *paths = tcglobpat(tpath);
+  int pnum = TCLISTNUM(paths);
+  for(int i = 0; !err && i < pnum; i++){
+    const char *cpath = TCLISTVALPTR(paths, i);
+    if(!tcstrfwm(cpath, path)) continue;
+    const char *rp = cpath + strlen(path);
+    if(*rp != MYEXTCHR) continue;
+    rp++;
+    if(!tcstrfwm(rp, CDBCOLSUFFIX)) continue;
+    rp += strlen(CDBCOLSUFFIX);
+    if(*rp != MYEXTCHR) continue;
+    rp++;
+    char *stem = tcstrdup(rp);
+    char *ep = strrchr(stem, MYEXTCHR);
+    if(ep){
+      *(ep++) = '\0';
+      int type = -1;
+      int width = 0;
+      if(!strcmp(ep, "int")){
+        type = CDBCTINT;
+        width = sizeof(int32_t);
+      } else if(!strcmp(ep, "long")){
+        type = CDBCTLONG;
+        width = sizeof(int64_t);
+      } else if(!strcmp(ep, "dbl")){
+        type = CDBCTDBL;
+        width = sizeof(double);
+      } else if(!strcmp(ep, "str")){
+        type = CDBCTSTR;
+        width = 1;
+      }
+      if(type >= 0){
+        int nsiz;
+        char *name = tcurldecode(stem, &nsiz);
+        if(!tccdbopencol(cdb, cpath, name, type, width, comode)) err = true;
+        TCFREE(name);
+      }
+    }
+    TCFREE(stem);
+  }
+  tclistdel(paths);
+  TCFREE(tpath);
+  if(err){
+    for(int i = 0; i < cdb->cnum; i++){
+      tcfdbdel(cdb->cols[i].db);
+      TCFREE(cdb->cols[i].name);
+    }
+    TCFREE(cdb->cols);
+    cdb->cols = NULL;
+    cdb->cnum = 0;
+    tcfdbclose(cdb->fdb);
+    return false;
+  }
+  cdb->open = true;
+  return true;
+}
+
+
+/* Close a column database object.
+   `cdb' specifies the column database object.
+   If successful, the return value is true, else, it is false. */
+static bool tccdbcloseimpl(TCCDB *cdb){
+  assert(cdb);
+  bool err = false;
+  for(int i = 0; i < cdb->cnum; i++){
+    CDBCOL *col = cdb->cols + i;
+    if(!tcfdbclose(col->db)){
+      tccdbsetecode(cdb, tcfdbecode(col->db), __FILE__, __LINE__, __func__);
+      err = true;
+    }
+    tcfdbdel(col->db);
+    TCFREE(col->name);
+  }
+  TCFREE(cdb->cols);
+  cdb->cols = NULL;
+  cdb->cnum = 0;
+  if(!tcfdbclose(cdb->fdb)) err = true;
+  cdb->open = false;
+  return !err;
+}
+
+
+/* Add a column to a column database object.
+   `cdb' specifies the column database object.
+   `name' specifies the name of the column.
+   `type' specifies the type of the column.
+   `width' specifies the width of the values of a string column.
+   If successful, the return value is true, else, it is false. */
+static bool tccdbsetcolimpl(TCCDB *cdb, const char *name, int type, int width){
+  assert(cdb && name);
+  switch(type){
+  case CDBCTINT:
+    width = sizeof(int32_t);
+    break;
+  case CDBCTLONG:
+    width = sizeof(int64_t);
+    break;
+  case CDBCTDBL:
+    width = sizeof(double);
+    break;
+  case CDBCTSTR:
+    break;
+  default:
+    width = 0;
+    break;
+  }
+  if(*name == '\0' || width < 1){
+    tccdbsetecode(cdb, TCEINVALID, __FILE__, __LINE__, __func__);
+    return false;
+  }
+  if(tccdbfindcol(cdb, name)){
+    tccdbsetecode(cdb, TCEKEEP, __FILE__, __LINE__, __func__);
+    return false;
+  }
+  TCXSTR *pbuf = tcxstrnew();
+  tcxstrprintf(pbuf, "%s%c%s%c%?%c%s", tcfdbpath(cdb->fdb), MYEXTCHR, CDBCOLSUFFIX, MYEXTCHR,
+               name, MYEXTCHR, tccdbtypename(type));
+  bool rv = tccdbopencol(cdb, TCXSTRPTR(pbuf), name, type, width,
+                         tccdbfomode(cdb) | FDBOCREAT | FDBOTRUNC);
+  tcxstrdel(pbuf);
+  return rv;
+}
+
+
+/* Check the size of a value of a column.
+   `cdb' specifies the column database object.
+   `col' specifies the column object.
+   `vsiz' specifies the size of the value.
+   If the size is acceptable, the return value is true, else, it is false. */
+static bool tccdbcheckval(TCCDB *cdb, CDBCOL *col, int vsiz){
+  assert(cdb && col);
+  bool ok;
+  switch(col->type){
+  case CDBCTINT:
+    ok = vsiz == sizeof(int32_t);
+    break;
+  case CDBCTLONG:
+    ok = vsiz == sizeof(int64_t);
+    break;
+  case CDBCTDBL:
+    ok = vsiz == sizeof(double);
+    break;
+  default:
+    ok = vsiz >= 0 && vsiz <= tcfdbwidth(col->db);
+    break;
+  }
+  if(!ok) tccdbsetecode(cdb, TCEINVALID, __FILE__, __LINE__, __func__);
+  return ok;
+}
+
+
+/* Store a record into a column database object.
+   `cdb' specifies the column database object.
+   `id' specifies the ID number.
+   `cols' specifies a map object containing columns.
+   If successful, the return value is true, else, it is false.
+   Every value is checked before any file is updated. */
+static bool tccdbputimpl(TCCDB *cdb, int64_t id, TCMAP *cols){
+  assert(cdb && id > 0 && cols);
+  tcmapiterinit(cols);
+  const char *kbuf;
+  int ksiz;
+  while((kbuf = tcmapiternext(cols, &ksiz)) != NULL){
+    int vsiz;
+    tcmapiterval(kbuf, &vsiz);
+    CDBCOL *col = tccdbfindcol(cdb, kbuf);
+    if(!col){
+      tccdbsetecode(cdb, TCEINVALID, __FILE__, __LINE__, __func__);
+      return false;
+    }
+    if(!tccdbcheckval(cdb, col, vsiz)) return false;
+  }
+  bool err = false;
+  for(int i = 0; i < cdb->cnum; i++){
+    CDBCOL *col = cdb->cols + i;
+    int vsiz;
+    const char *vbuf = tcmapget(cols, col->name, strlen(col->name), &vsiz);
+    if(vbuf){
+      if(!tcfdbput(col->db, id, vbuf, vsiz)){
+        tccdbsetecode(cdb, tcfdbecode(col->db), __FILE__, __LINE__, __func__);
+        err = true;
+      }
+    } else if(!tcfdbout(col->db, id) && tcfdbecode(col->db) != TCENOREC){
+      tccdbsetecode(cdb, tcfdbecode(col->db), __FILE__, __LINE__, __func__);
+      err = true;
+    }
+  }
+  if(!tcfdbput(cdb->fdb, id, CDBIDMARK, sizeof(CDBIDMARK) - 1)) err = true;
+  return !err;
+}
+
+
+/* Store a column value of a record into a column database object.
+   `cdb' specifies the column database object.
+   `id' specifies the ID number.
+   `col' specifies the column object.
+   `vbuf' specifies the pointer to the region of the value.
+   `vsiz' specifies the size of the region of the value.
+   If successful, the return value is true, else, it is false. */
+static bool tccdbputcolimpl(TCCDB *cdb, int64_t id, CDBCOL *col, const void *vbuf, int vsiz){
+  assert(cdb && id > 0 && col && vbuf && vsiz >= 0);
+  if(!tcfdbput(col->db, id, vbuf, vsiz)){
+    tccdbsetecode(cdb, tcfdbecode(col->db), __FILE__, __LINE__, __func__);
+    return false;
+  }
+  return tcfdbput(cdb->fdb, id, CDBIDMARK, sizeof(CDBIDMARK) - 1);
+}
+
+
+/* Remove a record of a column database object.
+   `cdb' specifies the column database object.
+   `id' specifies the ID number.
+   If successful, the return value is true, else, it is false. */
+static bool tccdboutimpl(TCCDB *cdb, int64_t id){
+  assert(cdb && id > 0);
+  if(!tcfdbout(cdb->fdb, id)) return false;
+  bool err = false;
+  for(int i = 0; i < cdb->cnum; i++){
+    CDBCOL *col = cdb->cols + i;
+    if(!tcfdbout(col->db, id) && tcfdbecode(col->db) != TCENOREC){
+      tccdbsetecode(cdb, tcfdbecode(col->db), __FILE__, __LINE__, __func__);
+      err = true;
+    }
+  }
+  return !err;
+}
+
+
+/* Retrieve a record in a column database object.
+   `cdb' specifies the column database object.
+   `id' specifies the ID number.
+   If successful, the return value is a map object of the columns, else, it is `NULL'. */
+static TCMAP *tccdbgetimpl(TCCDB *cdb, int64_t id){
+  assert(cdb && id > 0);
+  if(tcfdbvsiz(cdb->fdb, id) < 0) return NULL;
+  TCMAP *cols = tcmapnew2(cdb->cnum + 1);
+  for(int i = 0; i < cdb->cnum; i++){
+    CDBCOL *col = cdb->cols + i;
+    int vsiz;
+    char *vbuf = tcfdbget(col->db, id, &vsiz);
+    if(vbuf){
+      tcmapput(cols, col->name, strlen(col->name), vbuf, vsiz);
+      TCFREE(vbuf);
+    }
+  }
+  return cols;
+}
+
+
+/* Remove all records of a column database object.
+   `cdb' specifies the column database object.
+   If successful, the return value is true, else, it is false. */
+static bool tccdbvanishimpl(TCCDB *cdb){
+  assert(cdb);
+  bool err = false;
+  for(int i = 0; i < cdb->cnum; i++){
+    CDBCOL *col = cdb->cols + i;
+    if(!tcfdbvanish(col->db)){
+      tccdbsetecode(cdb, tcfdbecode(col->db), __FILE__, __LINE__, __func__);
+      err = true;
+    }
+  }
+  if(!tcfdbvanish(cdb->fdb)) err = true;
+  return !err;
+}
+
+
+/* Lock a method of the column database object.
+   `cdb' specifies the column database object.
+   `wr' specifies whether the lock is writer or not.
+   If successful, the return value is true, else, it is false. */
+static bool tccdblockmethod(TCCDB *cdb, bool wr){
+  assert(cdb);
+  if(wr ? pthread_rwlock_wrlock(cdb->mmtx) != 0 : pthread_rwlock_rdlock(cdb->mmtx) != 0){
+    tccdbsetecode(cdb, TCETHREAD, __FILE__, __LINE__, __func__);
+    return false;
+  }
+  TCTESTYIELD();
+  return true;
+}
+
+
+/* Unlock a method of the column database object.
+   `cdb' specifies the column database object.
+   If successful, the return value is true, else, it is false. */
+static bool tccdbunlockmethod(TCCDB *cdb){
+  assert(cdb);
+  if(pthread_rwlock_unlock(cdb->mmtx) != 0){
+    tccdbsetecode(cdb, TCETHREAD, __FILE__, __LINE__, __func__);
+    return false;
+  }
+  TCTESTYIELD();
+  return true;
+}
+
+
+
+// END OF FILE
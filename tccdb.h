@@ -0,0 +1,383 @@
+/*************************************************************************************************
+ * The column database API of Tokyo Cabinet
+ *                                                      Copyright (C) 2006-2009 Mikio Hirabayashi
+ * This file is part of Tokyo Cabinet.
+ * Tokyo Cabinet is free software; you can redistribute it and/or modify it under the terms of
+ * the GNU Lesser General Public License as published by the Free Software Foundation; either
+ * version 2.1 of the License or any later version.  Tokyo Cabinet is distributed in the hope
+ * that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ * You should have received a copy of the GNU Lesser General Public License along with Tokyo
+ * Cabinet; if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307 USA.
+ *************************************************************************************************/
+
+
+#ifndef _TCCDB_H                         /* duplication check */
+#define _TCCDB_H
+
+#if defined(__cplusplus)
+#define __TCCDB_CLINKAGEBEGIN extern "C" {
+#define __TCCDB_CLINKAGEEND }
+#else
+#define __TCCDB_CLINKAGEBEGIN
+#define __TCCDB_CLINKAGEEND
+#endif
+__TCCDB_CLINKAGEBEGIN
+
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+#include <limits.h>
+#include <math.h>
+#include <tcutil.h>
+#include <tcfdb.h>
+
+
+
+/*************************************************************************************************
+ * API
+ *************************************************************************************************/
+
+
+typedef struct {                         /* type of structure for a column */
+  char *name;                            /* column name */
+  int type;                              /* data type */
+  TCFDB *db;                             /* fixed-length database object of the values */
+} CDBCOL;
+
+typedef struct {                         /* type of structure for a column database */
+  void *mmtx;                            /* mutex for method */
+  TCFDB *fdb;                            /* fixed-length database object of the ID space */
+  bool open;                             /* whether the database is opened */
+  bool wmode;                            /* whether to be writable */
+  int64_t limid;                         /* limit ID number */
+  uint8_t opts;                          /* options */
+  CDBCOL *cols;                          /* column objects */
+  int cnum;                              /* number of the columns */
+} TCCDB;
+
+enum {                                   /* enumeration for tuning options */
+  CDBTSPARSE = 1 << 0                    /* use the sparse layout for every file */
+};
+
+enum {                                   /* enumeration for column types */
+  CDBCTINT,                              /* 32-bit integer */
+  CDBCTLONG,                             /* 64-bit integer */
+  CDBCTDBL,                              /* real number */
+  CDBCTSTR                               /* string of a fixed width */
+};
+
+enum {                                   /* enumeration for open modes */
+  CDBOREADER = 1 << 0,                   /* open as a reader */
+  CDBOWRITER = 1 << 1,                   /* open as a writer */
+  CDBOCREAT = 1 << 2,                    /* writer creating */
+  CDBOTRUNC = 1 << 3,                    /* writer truncating */
+  CDBONOLCK = 1 << 4,                    /* open without locking */
+  CDBOLCKNB = 1 << 5                     /* lock without blocking */
+};
+
+
+/* Get the message string corresponding to an error code.
+   `ecode' specifies the error code.
+   The return value is the message string of the error code. */
+const char *tccdberrmsg(int ecode);
+
+
+/* Create a column database object.
+   The return value is the new column database object. */
+TCCDB *tccdbnew(void);
+
+
+/* Delete a column database object.
+   `cdb' specifies the column database object.
+   If the database is not closed, it is closed implicitly.  Note that the deleted object and its
+   derivatives can not be used anymore. */
+void tccdbdel(TCCDB *cdb);
+
+
+/* Get the last happened error code of a column database object.
+   `cdb' specifies the column database object.
+   The return value is the last happened error code.
+   The following error code is defined: `TCESUCCESS' for success, `TCETHREAD' for threading
+   error, `TCEINVALID' for invalid operation, `TCENOFILE' for file not found, `TCENOPERM' for no
+   permission, `TCEMETA' for invalid meta data, `TCERHEAD' for invalid record header, `TCEOPEN'
+   for open error, `TCECLOSE' for close error, `TCETRUNC' for trunc error, `TCESYNC' for sync
+   error, `TCESTAT' for stat error, `TCESEEK' for seek error, `TCEREAD' for read error,
+   `TCEWRITE' for write error, `TCEMMAP' for mmap error, `TCELOCK' for lock error, `TCEUNLINK'
+   for unlink error, `TCERENAME' for rename error, `TCEMKDIR' for mkdir error, `TCERMDIR' for
+   rmdir error, `TCEKEEP' for existing record, `TCENOREC' for no record found, and `TCEMISC' for
+   miscellaneous error. */
+int tccdbecode(TCCDB *cdb);
+
+
+/* Set mutual exclusion control of a column database object for threading.
+   `cdb' specifies the column database object which is not opened.
+   If successful, the return value is true, else, it is false.
+   Note that the mutual exclusion control is needed if the object is shared by plural threads and
+   this function should be called before the database is opened. */
+bool tccdbsetmutex(TCCDB *cdb);
+
+
+/* Set the tuning parameters of a column database object.
+   `cdb' specifies the column database object which is not opened.
+   `limid' specifies the limit ID number.  If it is not more than 0, the default value is
+   specified.  The default value is 1048576.  The limit size of each file is derived from it and
+   from the width of the values.
+   `opts' specifies options by bitwise-or: `CDBTSPARSE' specifies that every file uses the sparse
+   layout of fixed-length databases, so that the size of each file depends on the number of
+   populated pages.  The limit ID number still bounds the size reserved for each file then.
+   If successful, the return value is true, else, it is false.
+   Note that the tuning parameters should be set before the database is opened. */
+bool tccdbtune(TCCDB *cdb, int64_t limid, uint8_t opts);
+
+
+/* Open a database file and connect a column database object.
+   `cdb' specifies the column database object which is not opened.
+   `path' specifies the path of the database file.  The file keeps the ID space and each column
+   is stored in a fixed-length database file whose name is composed of the path, "col", the
+   encoded column name, and the type name.
+   `omode' specifies the connection mode: `CDBOWRITER' as a writer, `CDBOREADER' as a reader.
+   If the mode is `CDBOWRITER', the following may be added by bitwise-or: `CDBOCREAT', which
+   means it creates a new database if not exist, `CDBOTRUNC', which means it creates a new
+   database regardless if one exists.  Both of `CDBOREADER' and `CDBOWRITER' can be added to by
+   bitwise-or: `CDBONOLCK', which means it opens the database file without file locking, or
+   `CDBOLCKNB', which means locking is performed without blocking.
+   If successful, the return value is true, else, it is false. */
+bool tccdbopen(TCCDB *cdb, const char *path, int omode);
+
+
+/* Close a column database object.
+   `cdb' specifies the column database object.
+   If successful, the return value is true, else, it is false.
+   Update of a database is assured to be written when the database is closed.  If a writer opens
+   a database but does not close it appropriately, the database will be broken. */
+bool tccdbclose(TCCDB *cdb);
+
+
+/* Add a column to a column database object.
+   `cdb' specifies the column database object connected as a writer.
+   `name' specifies the name of the column.  It should not be an empty string.
+   `type' specifies the type of the column: `CDBCTINT' for 32-bit integers, `CDBCTLONG' for 64-bit
+   integers, `CDBCTDBL' for real numbers, `CDBCTSTR' for strings.
+   `width' specifies the width of the values of a string column.  It is ignored for numeric
+   columns.
+   If successful, the return value is true, else, it is false.  If the column already exists,
+   this function has no effect and the error code is `TCEKEEP'.
+   Existing records have no value of the new column. */
+bool tccdbsetcol(TCCDB *cdb, const char *name, int type, int width);
+
+
+/* Store a record into a column database object.
+   `cdb' specifies the column database object connected as a writer.
+   `id' specifies the ID number.  It should be more than 0.
+   `cols' specifies a map object containing columns.  Values of numeric columns are in the native
+   binary format and their size should be that of the type.
+   If successful, the return value is true, else, it is false.
+   If a record with the same ID exists in the database, it is overwritten and the columns not in
+   the map are removed. */
+bool tccdbput(TCCDB *cdb, int64_t id, TCMAP *cols);
+
+
+/* Store a column value of a record into a column database object.
+   `cdb' specifies the column database object connected as a writer.
+   `id' specifies the ID number.  It should be more than 0.
+   `name' specifies the name of the column.
+   `vbuf' specifies the pointer to the region of the value.
+   `vsiz' specifies the size of the region of the value.
+   If successful, the return value is true, else, it is false.
+   The record is created if it does not exist.  The other columns are not changed. */
+bool tccdbputcol(TCCDB *cdb, int64_t id, const char *name, const void *vbuf, int vsiz);
+
+
+/* Remove a record of a column database object.
+   `cdb' specifies the column database object connected as a writer.
+   `id' specifies the ID number.
+   If successful, the return value is true, else, it is false. */
+bool tccdbout(TCCDB *cdb, int64_t id);
+
+
+/* Retrieve a record in a column database object.
+   `cdb' specifies the column database object.
+   `id' specifies the ID number.
+   If successful, the return value is a map object of the columns of the corresponding record.
+   `NULL' is returned if no record corresponds.
+   Because the object of the return value is created with the function `tcmapnew', it should be
+   deleted with the function `tcmapdel' when it is no longer in use. */
+TCMAP *tccdbget(TCCDB *cdb, int64_t id);
+
+
+/* Retrieve a column value of a record in a column database object.
+   `cdb' specifies the column database object.
+   `id' specifies the ID number.
+   `name' specifies the name of the column.
+   `sp' specifies the pointer to the variable into which the size of the region of the return
+   value is assigned.
+   If successful, the return value is the pointer to the region of the value.  `NULL' is returned
+   if the record or the column value does not exist.
+   Because an additional zero code is appended at the end of the region of the return value,
+   the return value can be treated as a character string.  Because the region of the return
+   value is allocated with the `malloc' call, it should be released with the `free' call when
+   it is no longer in use. */
+void *tccdbgetcol(TCCDB *cdb, int64_t id, const char *name, int *sp);
+
+
+/* Initialize the iterator of a column database object.
+   `cdb' specifies the column database object.
+   If successful, the return value is true, else, it is false.
+   The iterator is used in order to access the ID number of every record stored in a database. */
+bool tccdbiterinit(TCCDB *cdb);
+
+
+/* Get the next ID number of the iterator of a column database object.
+   `cdb' specifies the column database object.
+   If successful, the return value is the next ID number of the iterator, else, it is 0.  0 is
+   returned when no record is to be get out of the iterator.
+   It is possible to access every record by iteration of calling this function.  It is allowed to
+   update or remove records whose keys are fetched while the iteration.  The order of this
+   traversal is ascending of the ID number. */
+uint64_t tccdbiternext(TCCDB *cdb);
+
+
+/* Get range matching ID numbers in a column database object.
+   `cdb' specifies the column database object.
+   `lower' specifies the lower limit of the range.  If it is `FDBIDMIN', the minimum ID is
+   specified.
+   `upper' specifies the upper limit of the range.  If it is `FDBIDMAX', the maximum ID is
+   specified.
+   `max' specifies the maximum number of retrieved keys.  If it is negative, no limit is
+   specified.
+   `np' specifies the pointer to the variable into which the number of elements of the return
+   value is assigned.
+   If successful, the return value is the pointer to an array of ID numbers of the corresponding
+   records.  `NULL' is returned on failure.  This function does never fail.  It returns an empty
+   array even if no key corresponds.
+   Because the region of the return value is allocated with the `malloc' call, it should be
+   released with the `free' call when it is no longer in use. */
+uint64_t *tccdbrange(TCCDB *cdb, int64_t lower, int64_t upper, int max, int *np);
+
+
+/* Scan a column of records in a range of a column database object and aggregate matching ones.
+   `cdb' specifies the column database object.
+   `name' specifies the name of the column.
+   `lower' specifies the lower limit of the range.  If it is `FDBIDMIN', the minimum ID is
+   specified.
+   `upper' specifies the upper limit of the range.  If it is `FDBIDMAX', the maximum ID is
+   specified.
+   `op' specifies the condition as with `tcfdbscan'.
+   `ebuf' specifies the pointer to the region of the operand.
+   `esiz' specifies the size of the region of the operand.
+   `tnum' specifies the number of threads.
+   `res' specifies the pointer to the structure into which the result is stored.
+   If successful, the return value is true, else, it is false.
+   Only the file of the column is read.  Values of string columns are evaluated as decimal
+   strings. */
+bool tccdbscan(TCCDB *cdb, const char *name, int64_t lower, int64_t upper, int op,
+               const void *ebuf, int esiz, int tnum, FDBSCANRES *res);
+
+
+/* Synchronize updated contents of a column database object with the files and the device.
+   `cdb' specifies the column database object connected as a writer.
+   If successful, the return value is true, else, it is false. */
+bool tccdbsync(TCCDB *cdb);
+
+
+/* Remove all records of a column database object.
+   `cdb' specifies the column database object connected as a writer.
+   If successful, the return value is true, else, it is false.  The columns are kept. */
+bool tccdbvanish(TCCDB *cdb);
+
+
+/* Get the file path of a column database object.
+   `cdb' specifies the column database object.
+   The return value is the path of the database file or `NULL' if the object does not connect to
+   any database file. */
+const char *tccdbpath(TCCDB *cdb);
+
+
+/* Get the number of records of a column database object.
+   `cdb' specifies the column database object.
+   The return value is the number of records or 0 if the object does not connect to any database
+   file. */
+uint64_t tccdbrnum(TCCDB *cdb);
+
+
+/* Get the total size of the database files of a column database object.
+   `cdb' specifies the column database object.
+   The return value is the total size of the database files or 0 if the object does not connect
+   to any database file. */
+uint64_t tccdbfsiz(TCCDB *cdb);
+
+
+
+/*************************************************************************************************
+ * features for experts
+ *************************************************************************************************/
+
+
+/* Set the error code of a column database object.
+   `cdb' specifies the column database object.
+   `ecode' specifies the error code.
+   `file' specifies the file name of the code.
+   `line' specifies the line number of the code.
+   `func' specifies the function name of the code. */
+void tccdbsetecode(TCCDB *cdb, int ecode, const char *filename, int line, const char *func);
+
+
+/* Set the file descriptor for debugging output.
+   `cdb' specifies the column database object.
+   `fd' specifies the file descriptor for debugging output. */
+void tccdbsetdbgfd(TCCDB *cdb, int fd);
+
+
+/* Get the file descriptor for debugging output.
+   `cdb' specifies the column database object.
+   The return value is the file descriptor for debugging output. */
+int tccdbdbgfd(TCCDB *cdb);
+
+
+/* Get the number of columns of a column database object.
+   `cdb' specifies the column database object.
+   The return value is the number of columns. */
+int tccdbcolnum(TCCDB *cdb);
+
+
+/* Get the name of a column of a column database object.
+   `cdb' specifies the column database object.
+   `idx' specifies the index of the column.
+   The return value is the name of the column or `NULL' if the index is out of range. */
+const char *tccdbcolname(TCCDB *cdb, int idx);
+
+
+/* Get the type of a column of a column database object.
+   `cdb' specifies the column database object.
+   `name' specifies the name of the column.
+   The return value is the type of the column or -1 if the column does not exist. */
+int tccdbcoltype(TCCDB *cdb, const char *name);
+
+
+/* Get the width of a column of a column database object.
+   `cdb' specifies the column database object.
+   `name' specifies the name of the column.
+   The return value is the width of the values of the column or -1 if the column does not
+   exist. */
+int tccdbcolwidth(TCCDB *cdb, const char *name);
+
+
+/* Get the fixed-length database object of a column of a column database object.
+   `cdb' specifies the column database object.
+   `name' specifies the name of the column.
+   The return value is the fixed-length database object of the column or `NULL' if the column
+   does not exist. */
+TCFDB *tccdbcoldb(TCCDB *cdb, const char *name);
+
+
+
+__TCCDB_CLINKAGEEND
+#endif                                   /* duplication check */
+
+
+/* END OF FILE */
@@ -0,0 +1,732 @@
+/*************************************************************************************************
+ * The command line utility of the column database API
+ *                                                      Copyright (C) 2006-2009 Mikio Hirabayashi
+ * This file is part of Tokyo Cabinet.
+ * Tokyo Cabinet is free software; you can redistribute it and/or modify it under the terms of
+ * the GNU Lesser General Public License as published by the Free Software Foundation; either
+ * version 2.1 of the License or any later version.  Tokyo Cabinet is distributed in the hope
+ * that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ * You should have received a copy of the GNU Lesser General Public License along with Tokyo
+ * Cabinet; if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307 USA.
+ *************************************************************************************************/
+
+
+#include <tcutil.h>
+#include <tcfdb.h>
+#include <tccdb.h>
+#include "myconf.h"
+
+
+/* global variables */
+const char *g_progname;                  // program name
+int g_dbgfd;                             // debugging output
+
+
+/* function prototypes */
+int main(int argc, char **argv);
+static void usage(void);
+static void printerr(TCCDB *cdb);
+static char *encodeval(TCCDB *cdb, const char *name, const char *str, int *sp);
+static void printval(TCCDB *cdb, const char *name, const char *vbuf, int vsiz);
+static int runcreate(int argc, char **argv);
+static int runsetcol(int argc, char **argv);
+static int runinform(int argc, char **argv);
+static int runput(int argc, char **argv);
+static int runout(int argc, char **argv);
+static int runget(int argc, char **argv);
+static int runlist(int argc, char **argv);
+static int runscan(int argc, char **argv);
+static int runversion(int argc, char **argv);
+static int proccreate(const char *path, int64_t limid, int opts);
+static int procsetcol(const char *path, const char *name, int type, int width, int omode);
+static int procinform(const char *path, int omode);
+static int procput(const char *path, int64_t id, TCLIST *args, int omode);
+static int procout(const char *path, int64_t id, int omode);
+static int procget(const char *path, int64_t id, int omode);
+static int proclist(const char *path, int omode, int max, bool pv,
+                    const char *rlstr, const char *rustr);
+static int procscan(const char *path, int omode, int tnum, const char *rlstr, const char *rustr,
+                    const char *name, const char *opstr, const char *expr);
+static int procversion(void);
+
+
+/* main routine */
+int main(int argc, char **argv){
+  g_progname = argv[0];
+  g_dbgfd = -1;
+  const char *ebuf = getenv("TCDBGFD");
+  if(ebuf) g_dbgfd = tcatoix(ebuf);
+  if(argc < 2) usage();
+  int rv = 0;
+  if(!strcmp(argv[1], "create")){
+    rv = runcreate(argc, argv);
+  } else if(!strcmp(argv[1], "setcol")){
+    rv = runsetcol(argc, argv);
+  } else if(!strcmp(argv[1], "inform")){
+    rv = runinform(argc, argv);
+  } else if(!strcmp(argv[1], "put")){
+    rv = runput(argc, argv);
+  } else if(!strcmp(argv[1], "out")){
+    rv = runout(argc, argv);
+  } else if(!strcmp(argv[1], "get")){
+    rv = runget(argc, argv);
+  } else if(!strcmp(argv[1], "list")){
+    rv = runlist(argc, argv);
+  } else if(!strcmp(argv[1], "scan")){
+    rv = runscan(argc, argv);
+  } else if(!strcmp(argv[1], "version") || !strcmp(argv[1], "--version")){
+    rv = runversion(argc, argv);
+  } else {
+    usage();
+  }
+  return rv;
+}
+
+
+/* print the usage and exit */
+static void usage(void){
+  fprintf(stderr, "%s: the command line utility of the column database API\n", g_progname);
+  fprintf(stderr, "\n");
+  fprintf(stderr, "usage:\n");
+  fprintf(stderr, "  %s create [-ts] path [limid]\n", g_progname);
+  fprintf(stderr, "  %s setcol [-nl|-nb] path name type [width]\n", g_progname);
+  fprintf(stderr, "  %s inform [-nl|-nb] path\n", g_progname);
+  fprintf(stderr, "  %s put [-nl|-nb] path id [name value ...]\n", g_progname);
+  fprintf(stderr, "  %s out [-nl|-nb] path id\n", g_progname);
+  fprintf(stderr, "  %s get [-nl|-nb] path id\n", g_progname);
+  fprintf(stderr, "  %s list [-nl|-nb] [-m num] [-pv] [-rb lid uid] path\n", g_progname);
+  fprintf(stderr, "  %s scan [-nl|-nb] [-tn num] [-rb lid uid] path name [op [expr]]\n",
+          g_progname);
+  fprintf(stderr, "  %s version\n", g_progname);
+  fprintf(stderr, "\n");
+  exit(1);
+}
+
+
+/* print error information */
+static void printerr(TCCDB *cdb){
+  const char *path = cdb->open ? tccdbpath(cdb) : NULL;
+  int ecode = tccdbecode(cdb);
+  fprintf(stderr, "%s: %s: %d: %s\n", g_progname, path ? path : "-", ecode, tccdberrmsg(ecode));
+}
+
+
+/* encode a value in the binary form of a column */
+static char *encodeval(TCCDB *cdb, const char *name, const char *str, int *sp){
+  switch(tccdbcoltype(cdb, name)){
+  case CDBCTINT: {
+    int32_t num = tcatoi(str);
+    *sp = sizeof(num);
+    return tcmemdup(&num, sizeof(num));
+  }
+  case CDBCTLONG: {
+    int64_t num = tcatoi(str);
+    *sp = sizeof(num);
+    return tcmemdup(&num, sizeof(num));
+  }
+  case CDBCTDBL: {
+    double num = tcatof(str);
+    *sp = sizeof(num);
+    return tcmemdup(&num, sizeof(num));
+  }
+  }
+  *sp = strlen(str);
+  return tcmemdup(str, *sp);
+}
+
+
+/* print a value in the decimal form of a column */
+static void printval(TCCDB *cdb, const char *name, const char *vbuf, int vsiz){
+  switch(tccdbcoltype(cdb, name)){
+  case CDBCTINT:
+    if(vsiz == sizeof(int32_t)){
+      int32_t num;
+      memcpy(&num, vbuf, sizeof(num));
+      printf("%d", (int)num);
+      return;
+    }
+    break;
+  case CDBCTLONG:
+    if(vsiz == sizeof(int64_t)){
+      int64_t num;
+      memcpy(&num, vbuf, sizeof(num));
+      printf("%lld", (long long)num);
+      return;
+    }
+    break;
+  case CDBCTDBL:
+    if(vsiz == sizeof(double)){
+      double num;
+      memcpy(&num, vbuf, sizeof(num));
+      printf("%.3f", num);
+      return;
+    }
+    break;
+  }
+  fwrite(vbuf, 1, vsiz, stdout);
+}
+
+
+/* parse arguments of create command */
+static int runcreate(int argc, char **argv){
+  char *path = NULL;
+  char *lstr = NULL;
+  int opts = 0;
+  for(int i = 2; i < argc; i++){
+    if(!path && argv[i][0] == '-'){
+      if(!strcmp(argv[i], "-ts")){
+        opts |= CDBTSPARSE;
+      } else {
+        usage();
+      }
+    } else if(!path){
+      path = argv[i];
+    } else if(!lstr){
+      lstr = argv[i];
+    } else {
+      usage();
+    }
+  }
+  if(!path) usage();
+  int64_t limid = lstr ? tcatoix(lstr) : -1;
+  int rv = proccreate(path, limid, opts);
+  return rv;
+}
+
+
+/* parse arguments of setcol command */
+static int runsetcol(int argc, char **argv){
+  char *path = NULL;
+  char *name = NULL;
+  char *tstr = NULL;
+  char *wstr = NULL;
+  int omode = 0;
+  for(int i = 2; i < argc; i++){
+    if(!path && argv[i][0] == '-'){
+      if(!strcmp(argv[i], "-nl")){
+        omode |= CDBONOLCK;
+      } else if(!strcmp(argv[i], "-nb")){
+        omode |= CDBOLCKNB;
+      } else {
+        usage();
+      }
+    } else if(!path){
+      path = argv[i];
+    } else if(!name){
+      name = argv[i];
+    } else if(!tstr){
+      tstr = argv[i];
+    } else if(!wstr){
+      wstr = argv[i];
+    } else {
+      usage();
+    }
+  }
+  if(!path || !name || !tstr) usage();
+  int type = -1;
+  if(!tcstricmp(tstr, "int")){
+    type = CDBCTINT;
+  } else if(!tcstricmp(tstr, "long")){
+    type = CDBCTLONG;
+  } else if(!tcstricmp(tstr, "dbl") || !tcstricmp(tstr, "double")){
+    type = CDBCTDBL;
+  } else if(!tcstricmp(tstr, "str")){
+    type = CDBCTSTR;
+  } else {
+    usage();
+  }
+  int width = wstr ? tcatoix(wstr) : 0;
+  int rv = procsetcol(path, name, type, width, omode);
+  return rv;
+}
+
+
+/* parse arguments of inform command */
+static int runinform(int argc, char **argv){
+  char *path = NULL;
+  int omode = 0;
+  for(int i = 2; i < argc; i++){
+    if(!path && argv[i][0] == '-'){
+      if(!strcmp(argv[i], "-nl")){
+        omode |= CDBONOLCK;
+      } else if(!strcmp(argv[i], "-nb")){
+        omode |= CDBOLCKNB;
+      } else {
+        usage();
+      }
+    } else if(!path){
+      path = argv[i];
+    } else {
+      usage();
+    }
+  }
+  if(!path) usage();
+  int rv = procinform(path, omode);
+  return rv;
+}
+
+
+/* parse arguments of put command */
+static int runput(int argc, char **argv){
+  char *path = NULL;
+  char *idstr = NULL;
+  TCLIST *args = tcmpoollistnew(tcmpoolglobal());
+  int omode = 0;
+  for(int i = 2; i < argc; i++){
+    if(!path && argv[i][0] == '-'){
+      if(!strcmp(argv[i], "-nl")){
+        omode |= CDBONOLCK;
+      } else if(!strcmp(argv[i], "-nb")){
+        omode |= CDBOLCKNB;
+      } else {
+        usage();
+      }
+    } else if(!path){
+      path = argv[i];
+    } else if(!idstr){
+      idstr = argv[i];
+    } else {
+      tclistpush2(args, argv[i]);
+    }
+  }
+  if(!path || !idstr || tclistnum(args) % 2 != 0) usage();
+  int rv = procput(path, tcatoix(idstr), args, omode);
+  return rv;
+}
+
+
+/* parse arguments of out command */
+static int runout(int argc, char **argv){
+  char *path = NULL;
+  char *idstr = NULL;
+  int omode = 0;
+  for(int i = 2; i < argc; i++){
+    if(!path && argv[i][0] == '-'){
+      if(!strcmp(argv[i], "-nl")){
+        omode |= CDBONOLCK;
+      } else if(!strcmp(argv[i], "-nb")){
+        omode |= CDBOLCKNB;
+      } else {
+        usage();
+      }
+    } else if(!path){
+      path = argv[i];
+    } else if(!idstr){
+      idstr = argv[i];
+    } else {
+      usage();
+    }
+  }
+  if(!path || !idstr) usage();
+  int rv = procout(path, tcatoix(idstr), omode);
+  return rv;
+}
+
+
+/* parse arguments of get command */
+static int runget(int argc, char **argv){
+  char *path = NULL;
+  char *idstr = NULL;
+  int omode = 0;
+  for(int i = 2; i < argc; i++){
+    if(!path && argv[i][0] == '-'){
+      if(!strcmp(argv[i], "-nl")){
+        omode |= CDBONOLCK;
+      } else if(!strcmp(argv[i], "-nb")){
+        omode |= CDBOLCKNB;
+      } else {
+        usage();
+      }
+    } else if(!path){
+      path = argv[i];
+    } else if(!idstr){
+      idstr = argv[i];
+    } else {
+      usage();
+    }
+  }
+  if(!path || !idstr) usage();
+  int rv = procget(path, tcatoix(idstr), omode);
+  return rv;
+}
+
+
+/* parse arguments of list command */
+static int runlist(int argc, char **argv){
+  char *path = NULL;
+  int omode = 0;
+  int max = -1;
+  bool pv = false;
+  char *rlstr = NULL;
+  char *rustr = NULL;
+  for(int i = 2; i < argc; i++){
+    if(!path && argv[i][0] == '-'){
+      if(!strcmp(argv[i], "-nl")){
+        omode |= CDBONOLCK;
+      } else if(!strcmp(argv[i], "-nb")){
+        omode |= CDBOLCKNB;
+      } else if(!strcmp(argv[i], "-m")){
+        if(++i >= argc) usage();
+        max = tcatoix(argv[i]);
+      } else if(!strcmp(argv[i], "-pv")){
+        pv = true;
+      } else if(!strcmp(argv[i], "-rb")){
+        if(++i >= argc) usage();
+        rlstr = argv[i];
+        if(++i >= argc) usage();
+        rustr = argv[i];
+      } else {
+        usage();
+      }
+    } else if(!path){
+      path = argv[i];
+    } else {
+      usage();
+    }
+  }
+  if(!path) usage();
+  int rv = proclist(path, omode, max, pv, rlstr, rustr);
+  return rv;
+}
+
+
+/* parse arguments of scan command */
+static int runscan(int argc, char **argv){
+  char *path = NULL;
+  char *name = NULL;
+  char *opstr = NULL;
+  char *expr = NULL;
+  int omode = 0;
+  int tnum = 1;
+  char *rlstr = NULL;
+  char *rustr = NULL;
+  for(int i = 2; i < argc; i++){
+    if(!path && argv[i][0] == '-'){
+      if(!strcmp(argv[i], "-nl")){
+        omode |= CDBONOLCK;
+      } else if(!strcmp(argv[i], "-nb")){
+        omode |= CDBOLCKNB;
+      } else if(!strcmp(argv[i], "-tn")){
+        if(++i >= argc) usage();
+        tnum = tcatoix(argv[i]);
+      } else if(!strcmp(argv[i], "-rb")){
+        if(++i >= argc) usage();
+        rlstr = argv[i];
+        if(++i >= argc) usage();
+        rustr = argv[i];
+      } else {
+        usage();
+      }
+    } else if(!path){
+      path = argv[i];
+    } else if(!name){
+      name = argv[i];
+    } else if(!opstr){
+      opstr = argv[i];
+    } else if(!expr){
+      expr = argv[i];
+    } else {
+      usage();
+    }
+  }
+  if(!path || !name) usage();
+  int rv = procscan(path, omode, tnum, rlstr, rustr, name, opstr, expr);
+  return rv;
+}
+
+
+/* parse arguments of version command */
+static int runversion(int argc, char **argv){
+  int rv = procversion();
+  return rv;
+}
+
+
+/* perform create command */
+static int proccreate(const char *path, int64_t limid, int opts){
+  TCCDB *cdb = tccdbnew();
+  if(g_dbgfd >= 0) tccdbsetdbgfd(cdb, g_dbgfd);
+  if(!tccdbtune(cdb, limid, opts)){
+    printerr(cdb);
+    tccdbdel(cdb);
+    return 1;
+  }
+  if(!tccdbopen(cdb, path, CDBOWRITER | CDBOCREAT | CDBOTRUNC)){
+    printerr(cdb);
+    tccdbdel(cdb);
+    return 1;
+  }
+  bool err = false;
+  if(!tccdbclose(cdb)){
+    printerr(cdb);
+    err = true;
+  }
+  tccdbdel(cdb);
+  return err ? 1 : 0;
+}
+
+
+/* perform setcol command */
+static int procsetcol(const char *path, const char *name, int type, int width, int omode){
+  TCCDB *cdb = tccdbnew();
+  if(g_dbgfd >= 0) tccdbsetdbgfd(cdb, g_dbgfd);
+  if(!tccdbopen(cdb, path, CDBOWRITER | omode)){
+    printerr(cdb);
+    tccdbdel(cdb);
+    return 1;
+  }
+  bool err = false;
+  if(!tccdbsetcol(cdb, name, type, width)){
+    printerr(cdb);
+    err = true;
+  }
+  if(!tccdbclose(cdb)){
+    if(!err) printerr(cdb);
+    err = true;
+  }
+  tccdbdel(cdb);
+  return err ? 1 : 0;
+}
+
+
+/* perform inform command */
+static int procinform(const char *path, int omode){
+  TCCDB *cdb = tccdbnew();
+  if(g_dbgfd >= 0) tccdbsetdbgfd(cdb, g_dbgfd);
+  if(!tccdbopen(cdb, path, CDBOREADER | omode)){
+    printerr(cdb);
+    tccdbdel(cdb);
+    return 1;
+  }
+  bool err = false;
+  const char *npath = tccdbpath(cdb);
+  if(!npath) npath = "(unknown)";
+  printf("path: %s\n", npath);
+  printf("database type: column\n");
+  printf("options:");
+  if(cdb->opts & CDBTSPARSE) printf(" sparse");
+  printf("\n");
+  int cnum = tccdbcolnum(cdb);
+  for(int i = 0; i < cnum; i++){
+    const char *name = tccdbcolname(cdb, i);
+    const char *type = "str";
+    switch(tccdbcoltype(cdb, name)){
+    case CDBCTINT: type = "int"; break;
+    case CDBCTLONG: type = "long"; break;
+    case CDBCTDBL: type = "dbl"; break;
+    }
+    printf("column %d: %s (%s, %d)\n", i + 1, name, type, tccdbcolwidth(cdb, name));
+  }
+  printf("minimum ID number: %llu\n", (unsigned long long)tcfdbmin(cdb->fdb));
+  printf("maximum ID number: %llu\n", (unsigned long long)tcfdbmax(cdb->fdb));
+  printf("limit ID number: %llu\n", (unsigned long long)tcfdblimid(cdb->fdb));
+  printf("record number: %llu\n", (unsigned long long)tccdbrnum(cdb));
+  printf("file size: %llu\n", (unsigned long long)tccdbfsiz(cdb));
+  if(!tccdbclose(cdb)){
+    if(!err) printerr(cdb);
+    err = true;
+  }
+  tccdbdel(cdb);
+  return err ? 1 : 0;
+}
+
+
+/* perform put command */
+static int procput(const char *path, int64_t id, TCLIST *args, int omode){
+  TCCDB *cdb = tccdbnew();
+  if(g_dbgfd >= 0) tccdbsetdbgfd(cdb, g_dbgfd);
+  if(!tccdbopen(cdb, path, CDBOWRITER | omode)){
+    printerr(cdb);
+    tccdbdel(cdb);
+    return 1;
+  }
+  bool err = false;
+  TCMAP *cols = tcmapnew();
+  int anum = tclistnum(args);
+  for(int i = 0; i < anum - 1; i += 2){
+    const char *name = tclistval2(args, i);
+    int vsiz;
+    char *vbuf = encodeval(cdb, name, tclistval2(args, i + 1), &vsiz);
+    tcmapput(cols, name, strlen(name), vbuf, vsiz);
+    tcfree(vbuf);
+  }
+  if(!tccdbput(cdb, id, cols)){
+    printerr(cdb);
+    err = true;
+  }
+  tcmapdel(cols);
+  if(!tccdbclose(cdb)){
+    if(!err) printerr(cdb);
+    err = true;
+  }
+  tccdbdel(cdb);
+  return err ? 1 : 0;
+}
+
+
+/* perform out command */
+static int procout(const char *path, int64_t id, int omode){
+  TCCDB *cdb = tccdbnew();
+  if(g_dbgfd >= 0) tccdbsetdbgfd(cdb, g_dbgfd);
+  if(!tccdbopen(cdb, path, CDBOWRITER | omode)){
+    printerr(cdb);
+    tccdbdel(cdb);
+    return 1;
+  }
+  bool err = false;
+  if(!tccdbout(cdb, id)){
+    printerr(cdb);
+    err = true;
+  }
+  if(!tccdbclose(cdb)){
+    if(!err) printerr(cdb);
+    err = true;
+  }
+  tccdbdel(cdb);
+  return err ? 1 : 0;
+}
+
+
+/* perform get command */
+static int procget(const char *path, int64_t id, int omode){
+  TCCDB *cdb = tccdbnew();
+  if(g_dbgfd >= 0) tccdbsetdbgfd(cdb, g_dbgfd);
+  if(!tccdbopen(cdb, path, CDBOREADER | omode)){
+    printerr(cdb);
+    tccdbdel(cdb);
+    return 1;
+  }
+  bool err = false;
+  TCMAP *cols = tccdbget(cdb, id);
+  if(cols){
+    tcmapiterinit(cols);
+    const char *kbuf;
+    int ksiz;
+    while((kbuf = tcmapiternext(cols, &ksiz)) != NULL){
+      int vsiz;
+      const char *vbuf = tcmapiterval(kbuf, &vsiz);
+      printf("%s\t", kbuf);
+      printval(cdb, kbuf, vbuf, vsiz);
+      putchar('\n');
+    }
+    tcmapdel(cols);
+  } else {
+    printerr(cdb);
+    err = true;
+  }
+  if(!tccdbclose(cdb)){
+    if(!err) printerr(cdb);
+    err = true;
+  }
+  tccdbdel(cdb);
+  return err ? 1 : 0;
+}
+
+
+/* perform list command */
+static int proclist(const char *path, int omode, int max, bool pv,
+                    const char *rlstr, const char *rustr){
+  TCCDB *cdb = tccdbnew();
+  if(g_dbgfd >= 0) tccdbsetdbgfd(cdb, g_dbgfd);
+  if(!tccdbopen(cdb, path, CDBOREADER | omode)){
+    printerr(cdb);
+    tccdbdel(cdb);
+    return 1;
+  }
+  bool err = false;
+  int64_t lower = rlstr ? tcfdbkeytoid(rlstr, strlen(rlstr)) : FDBIDMIN;
+  int64_t upper = rustr ? tcfdbkeytoid(rustr, strlen(rustr)) : FDBIDMAX;
+  int num;
+  uint64_t *ids = tccdbrange(cdb, lower, upper, max, &num);
+  for(int i = 0; i < num; i++){
+    printf("%llu", (unsigned long long)ids[i]);
+    if(pv){
+      TCMAP *cols = tccdbget(cdb, ids[i]);
+      if(cols){
+        tcmapiterinit(cols);
+        const char *kbuf;
+        int ksiz;
+        while((kbuf = tcmapiternext(cols, &ksiz)) != NULL){
+          int vsiz;
+          const char *vbuf = tcmapiterval(kbuf, &vsiz);
+          printf("\t%s\t", kbuf);
+          printval(cdb, kbuf, vbuf, vsiz);
+        }
+        tcmapdel(cols);
+      }
+    }
+    putchar('\n');
+  }
+  tcfree(ids);
+  if(!tccdbclose(cdb)){
+    if(!err) printerr(cdb);
+    err = true;
+  }
+  tccdbdel(cdb);
+  return err ? 1 : 0;
+}
+
+
+/* perform scan command */
+static int procscan(const char *path, int omode, int tnum, const char *rlstr, const char *rustr,
+                    const char *name, const char *opstr, const char *expr){
+  int op = FDBSCALL;
+  if(opstr){
+    if(!tcstricmp(opstr, "all")){
+      op = FDBSCALL;
+    } else if(!tcstricmp(opstr, "streq")){
+      op = FDBSCSTREQ;
+    } else if(!tcstricmp(opstr, "strbw")){
+      op = FDBSCSTRBW;
+    } else if(!tcstricmp(opstr, "numeq")){
+      op = FDBSCNUMEQ;
+    } else if(!tcstricmp(opstr, "numbt")){
+      op = FDBSCNUMBT;
+    } else {
+      usage();
+    }
+  }
+  if(!expr) expr = "";
+  TCCDB *cdb = tccdbnew();
+  if(g_dbgfd >= 0) tccdbsetdbgfd(cdb, g_dbgfd);
+  if(!tccdbopen(cdb, path, CDBOREADER | omode)){
+    printerr(cdb);
+    tccdbdel(cdb);
+    return 1;
+  }
+  bool err = false;
+  int64_t lower = rlstr ? tcfdbkeytoid(rlstr, strlen(rlstr)) : FDBIDMIN;
+  int64_t upper = rustr ? tcfdbkeytoid(rustr, strlen(rustr)) : FDBIDMAX;
+  FDBSCANRES res;
+  if(tccdbscan(cdb, name, lower, upper, op, expr, strlen(expr), tnum, &res)){
+    printf("count: %llu\n", (unsigned long long)res.num);
+    printf("sum: %.3f\n", res.sum);
+    printf("min: %.3f\n", res.min);
+    printf("max: %.3f\n", res.max);
+  } else {
+    printerr(cdb);
+    err = true;
+  }
+  if(!tccdbclose(cdb)){
+    if(!err) printerr(cdb);
+    err = true;
+  }
+  tccdbdel(cdb);
+  return err ? 1 : 0;
+}
+
+
+/* perform version command */
+static int procversion(void){
+  printf("Tokyo Cabinet version %s (%d:%s) for %s\n",
+         tcversion, _TC_LIBVER, _TC_FORMATVER, TCSYSNAME);
+  printf("Copyright (C) 2006-2009 Mikio Hirabayashi\n");
+  return 0;
+}
+
+
+
+// END OF FILE
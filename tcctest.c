@@ -0,0 +1,706 @@
+/*************************************************************************************************
+ * The test cases of the column database API
+ *                                                      Copyright (C) 2006-2009 Mikio Hirabayashi
+ * This file is part of Tokyo Cabinet.
+ * Tokyo Cabinet is free software; you can redistribute it and/or modify it under the terms of
+ * the GNU Lesser General Public License as published by the Free Software Foundation; either
+ * version 2.1 of the License or any later version.  Tokyo Cabinet is distributed in the hope
+ * that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ * You should have received a copy of the GNU Lesser General Public License along with Tokyo
+ * Cabinet; if not, write to the Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA 02111-1307 USA.
+ *************************************************************************************************/
+
+
+#include <tcutil.h>
+#include <tcfdb.h>
+#include <tccdb.h>
+#include "myconf.h"
+
+#define RECBUFSIZ      48                // buffer for records
+#define STRCOLWIDTH    16                // width of the string column
+
+
+/* global variables */
+const char *g_progname;                  // program name
+unsigned int g_randseed;                 // random seed
+int g_dbgfd;                             // debugging output
+
+
+/* function prototypes */
+int main(int argc, char **argv);
+static void usage(void);
+static void iprintf(const char *format, ...);
+static void iputchar(int c);
+static void eprint(TCCDB *cdb, int line, const char *func);
+static void sysprint(void);
+static int myrand(int range);
+static TCMAP *makecols(int64_t id);
+static bool checkcols(TCMAP *cols, int64_t id);
+static int runwrite(int argc, char **argv);
+static int runread(int argc, char **argv);
+static int runremove(int argc, char **argv);
+static int runmisc(int argc, char **argv);
+static int procwrite(const char *path, int rnum, bool mt, int opts, int omode, bool rnd);
+static int procread(const char *path, bool mt, int omode, bool rnd);
+static int procremove(const char *path, bool mt, int omode, bool rnd);
+static int procmisc(const char *path, int rnum, bool mt, int opts, int omode);
+
+
+/* main routine */
+int main(int argc, char **argv){
+  g_progname = argv[0];
+  const char *ebuf = getenv("TCRNDSEED");
+  g_randseed = ebuf ? tcatoix(ebuf) : tctime() * 1000;
+  srand(g_randseed);
+  ebuf = getenv("TCDBGFD");
+  g_dbgfd = ebuf ? tcatoix(ebuf) : UINT16_MAX;
+  if(argc < 2) usage();
+  int rv = 0;
+  if(!strcmp(argv[1], "write")){
+    rv = runwrite(argc, argv);
+  } else if(!strcmp(argv[1], "read")){
+    rv = runread(argc, argv);
+  } else if(!strcmp(argv[1], "remove")){
+    rv = runremove(argc, argv);
+  } else if(!strcmp(argv[1], "misc")){
+    rv = runmisc(argc, argv);
+  } else {
+    usage();
+  }
+  if(rv != 0){
+    printf("FAILED:");
+    for(int i = 0; i < argc; i++){
+      printf(" %s", argv[i]);
+    }
+    printf("\n\n");
+  }
+  return rv;
+}
+
+
+/* print the usage and exit */
+static void usage(void){
+  fprintf(stderr, "%s: test cases of the column database API of Tokyo Cabinet\n", g_progname);
+  fprintf(stderr, "\n");
+  fprintf(stderr, "usage:\n");
+  fprintf(stderr, "  %s write [-mt] [-ts] [-nl|-nb] [-rnd] path rnum\n", g_progname);
+  fprintf(stderr, "  %s read [-mt] [-nl|-nb] [-rnd] path\n", g_progname);
+  fprintf(stderr, "  %s remove [-mt] [-nl|-nb] [-rnd] path\n", g_progname);
+  fprintf(stderr, "  %s misc [-mt] [-ts] [-nl|-nb] path rnum\n", g_progname);
+  fprintf(stderr, "\n");
+  exit(1);
+}
+
+
+/* print formatted information string and flush the buffer */
+static void iprintf(const char *format, ...){
+  va_list ap;
+  va_start(ap, format);
+  vprintf(format, ap);
+  fflush(stdout);
+  va_end(ap);
+}
+
+
+/* print a character and flush the buffer */
+static void iputchar(int c){
+  putchar(c);
+  fflush(stdout);
+}
+
+
+/* print error message of column database */
+static void eprint(TCCDB *cdb, int line, const char *func){
+  const char *path = cdb->open ? tccdbpath(cdb) : NULL;
+  int ecode = tccdbecode(cdb);
+  fprintf(stderr, "%s: %s: %d: %s: error: %d: %s\n",
+          g_progname, path ? path : "-", line, func, ecode, tccdberrmsg(ecode));
+}
+
+
+/* print system information */
+static void sysprint(void){
+  TCMAP *info = tcsysinfo();
+  if(info){
+    tcmapiterinit(info);
+    const char *kbuf;
+    while((kbuf = tcmapiternext2(info)) != NULL){
+      iprintf("sys_%s: %s\n", kbuf, tcmapiterval2(kbuf));
+    }
+    tcmapdel(info);
+  }
+}
+
+
+/* get a random number */
+static int myrand(int range){
+  if(range < 2) return 0;
+  int high = (unsigned int)rand() >> 4;
+  int low = range * (rand() / (RAND_MAX + 1.0));
+  low &= (unsigned int)INT_MAX >> 4;
+  return (high + low) % range;
+}
+
+
+/* make the columns of a record */
+static TCMAP *makecols(int64_t id){
+  TCMAP *cols = tcmapnew2(7);
+  int32_t inum = id;
+  tcmapput(cols, "num", 3, &inum, sizeof(inum));
+  int64_t lnum = id * 1000;
+  tcmapput(cols, "big", 3, &lnum, sizeof(lnum));
+  double dnum = id / 10.0;
+  tcmapput(cols, "val", 3, &dnum, sizeof(dnum));
+  char buf[RECBUFSIZ];
+  int len = sprintf(buf, "%08lld", (long long)id);
+  tcmapput(cols, "str", 3, buf, len);
+  return cols;
+}
+
+
+/* check the columns of a record */
+static bool checkcols(TCMAP *cols, int64_t id){
+  TCMAP *ecols = makecols(id);
+  bool ok = tcmaprnum(cols) == tcmaprnum(ecols);
+  tcmapiterinit(ecols);
+  const char *kbuf;
+  int ksiz;
+  while(ok && (kbuf = tcmapiternext(ecols, &ksiz)) != NULL){
+    int esiz;
+    const char *ebuf = tcmapiterval(kbuf, &esiz);
+    int vsiz;
+    const char *vbuf = tcmapget(cols, kbuf, ksiz, &vsiz);
+    if(!vbuf || vsiz != esiz || memcmp(vbuf, ebuf, esiz)) ok = false;
+  }
+  tcmapdel(ecols);
+  return ok;
+}
+
+
+/* parse arguments of write command */
+static int runwrite(int argc, char **argv){
+  char *path = NULL;
+  char *rstr = NULL;
+  bool mt = false;
+  int opts = 0;
+  int omode = 0;
+  bool rnd = false;
+  for(int i = 2; i < argc; i++){
+    if(!path && argv[i][0] == '-'){
+      if(!strcmp(argv[i], "-mt")){
+        mt = true;
+      } else if(!strcmp(argv[i], "-ts")){
+        opts |= CDBTSPARSE;
+      } else if(!strcmp(argv[i], "-nl")){
+        omode |= CDBONOLCK;
+      } else if(!strcmp(argv[i], "-nb")){
+        omode |= CDBOLCKNB;
+      } else if(!strcmp(argv[i], "-rnd")){
+        rnd = true;
+      } else {
+        usage();
+      }
+    } else if(!path){
+      path = argv[i];
+    } else if(!rstr){
+      rstr = argv[i];
+    } else {
+      usage();
+    }
+  }
+  if(!path || !rstr) usage();
+  int rnum = tcatoix(rstr);
+  if(rnum < 1) usage();
+  int rv = procwrite(path, rnum, mt, opts, omode, rnd);
+  return rv;
+}
+
+
+/* parse arguments of read command */
+static int runread(int argc, char **argv){
+  char *path = NULL;
+  bool mt = false;
+  int omode = 0;
+  bool rnd = false;
+  for(int i = 2; i < argc; i++){
+    if(!path && argv[i][0] == '-'){
+      if(!strcmp(argv[i], "-mt")){
+        mt = true;
+      } else if(!strcmp(argv[i], "-nl")){
+        omode |= CDBONOLCK;
+      } else if(!strcmp(argv[i], "-nb")){
+        omode |= CDBOLCKNB;
+      } else if(!strcmp(argv[i], "-rnd")){
+        rnd = true;
+      } else {
+        usage();
+      }
+    } else if(!path){
+      path = argv[i];
+    } else {
+      usage();
+    }
+  }
+  if(!path) usage();
+  int rv = procread(path, mt, omode, rnd);
+  return rv;
+}
+
+
+/* parse arguments of remove command */
+static int runremove(int argc, char **argv){
+  char *path = NULL;
+  bool mt = false;
+  int omode = 0;
+  bool rnd = false;
+  for(int i = 2; i < argc; i++){
+    if(!path && argv[i][0] == '-'){
+      if(!strcmp(argv[i], "-mt")){
+        mt = true;
+      } else if(!strcmp(argv[i], "-nl")){
+        omode |= CDBONOLCK;
+      } else if(!strcmp(argv[i], "-nb")){
+        omode |= CDBOLCKNB;
+      } else if(!strcmp(argv[i], "-rnd")){
+        rnd = true;
+      } else {
+        usage();
+      }
+    } else if(!path){
+      path = argv[i];
+    } else {
+      usage();
+    }
+  }
+  if(!path) usage();
+  int rv = procremove(path, mt, omode, rnd);
+  return rv;
+}
+
+
+/* parse arguments of misc command */
+static int runmisc(int argc, char **argv){
+  char *path = NULL;
+  char *rstr = NULL;
+  bool mt = false;
+  int opts = 0;
+  int omode = 0;
+  for(int i = 2; i < argc; i++){
+    if(!path && argv[i][0] == '-'){
+      if(!strcmp(argv[i], "-mt")){
+        mt = true;
+      } else if(!strcmp(argv[i], "-ts")){
+        opts |= CDBTSPARSE;
+      } else if(!strcmp(argv[i], "-nl")){
+        omode |= CDBONOLCK;
+      } else if(!strcmp(argv[i], "-nb")){
+        omode |= CDBOLCKNB;
+      } else {
+        usage();
+      }
+    } else if(!path){
+      path = argv[i];
+    } else if(!rstr){
+      rstr = argv[i];
+    } else {
+      usage();
+    }
+  }
+  if(!path || !rstr) usage();
+  int rnum = tcatoix(rstr);
+  if(rnum < 1) usage();
+  int rv = procmisc(path, rnum, mt, opts, omode);
+  return rv;
+}
+
+
+/* perform write command */
+static int procwrite(const char *path, int rnum, bool mt, int opts, int omode, bool rnd){
+  iprintf("<Writing Test>\n  seed=%u  path=%s  rnum=%d  mt=%d  opts=%d  omode=%d  rnd=%d\n\n",
+          g_randseed, path, rnum, mt, opts, omode, rnd);
+  bool err = false;
+  double stime = tctime();
+  TCCDB *cdb = tccdbnew();
+  if(g_dbgfd >= 0) tccdbsetdbgfd(cdb, g_dbgfd);
+  if(mt && !tccdbsetmutex(cdb)){
+    eprint(cdb, __LINE__, "tccdbsetmutex");
+    err = true;
+  }
+  if(!tccdbtune(cdb, rnum, opts)){
+    eprint(cdb, __LINE__, "tccdbtune");
+    err = true;
+  }
+  if(!rnd) omode |= CDBOTRUNC;
+  if(!tccdbopen(cdb, path, CDBOWRITER | CDBOCREAT | omode)){
+    eprint(cdb, __LINE__, "tccdbopen");
+    err = true;
+  }
+  if(!rnd || tccdbcolnum(cdb) < 1){
+    if(!tccdbsetcol(cdb, "num", CDBCTINT, 0) || !tccdbsetcol(cdb, "big", CDBCTLONG, 0) ||
+       !tccdbsetcol(cdb, "val", CDBCTDBL, 0) || !tccdbsetcol(cdb, "str", CDBCTSTR, STRCOLWIDTH)){
+      eprint(cdb, __LINE__, "tccdbsetcol");
+      err = true;
+    }
+  }
+  for(int i = 1; i <= rnum; i++){
+    int64_t id = rnd ? myrand(rnum) + 1 : i;
+    TCMAP *cols = makecols(id);
+    if(!tccdbput(cdb, id, cols)){
+      eprint(cdb, __LINE__, "tccdbput");
+      err = true;
+      tcmapdel(cols);
+      break;
+    }
+    tcmapdel(cols);
+    if(rnum > 250 && i % (rnum / 250) == 0){
+      iputchar('.');
+      if(i == rnum || i % (rnum / 10) == 0) iprintf(" (%08d)\n", i);
+    }
+  }
+  iprintf("column number: %d\n", tccdbcolnum(cdb));
+  iprintf("record number: %llu\n", (unsigned long long)tccdbrnum(cdb));
+  iprintf("size: %llu\n", (unsigned long long)tccdbfsiz(cdb));
+  sysprint();
+  if(!tccdbclose(cdb)){
+    eprint(cdb, __LINE__, "tccdbclose");
+    err = true;
+  }
+  tccdbdel(cdb);
+  iprintf("time: %.3f\n", tctime() - stime);
+  iprintf("%s\n\n", err ? "error" : "ok");
+  return err ? 1 : 0;
+}
+
+
+/* perform read command */
+static int procread(const char *path, bool mt, int omode, bool rnd){
+  iprintf("<Reading Test>\n  seed=%u  path=%s  mt=%d  omode=%d  rnd=%d\n\n",
+          g_randseed, path, mt, omode, rnd);
+  bool err = false;
+  double stime = tctime();
+  TCCDB *cdb = tccdbnew();
+  if(g_dbgfd >= 0) tccdbsetdbgfd(cdb, g_dbgfd);
+  if(mt && !tccdbsetmutex(cdb)){
+    eprint(cdb, __LINE__, "tccdbsetmutex");
+    err = true;
+  }
+  if(!tccdbopen(cdb, path, CDBOREADER | omode)){
+    eprint(cdb, __LINE__, "tccdbopen");
+    err = true;
+  }
+  int rnum = tccdbrnum(cdb);
+  for(int i = 1; i <= rnum; i++){
+    int64_t id = rnd ? myrand(rnum) + 1 : i;
+    TCMAP *cols = tccdbget(cdb, id);
+    if(cols){
+      if(!checkcols(cols, id)){
+        eprint(cdb, __LINE__, "checkcols");
+        err = true;
+        tcmapdel(cols);
+        break;
+      }
+      tcmapdel(cols);
+    } else if(!(rnd && tccdbecode(cdb) == TCENOREC)){
+      eprint(cdb, __LINE__, "tccdbget");
+      err = true;
+      break;
+    }
+    if(rnum > 250 && i % (rnum / 250) == 0){
+      iputchar('.');
+      if(i == rnum || i % (rnum / 10) == 0) iprintf(" (%08d)\n", i);
+    }
+  }
+  iprintf("column number: %d\n", tccdbcolnum(cdb));
+  iprintf("record number: %llu\n", (unsigned long long)tccdbrnum(cdb));
+  iprintf("size: %llu\n", (unsigned long long)tccdbfsiz(cdb));
+  sysprint();
+  if(!tccdbclose(cdb)){
+    eprint(cdb, __LINE__, "tccdbclose");
+    err = true;
+  }
+  tccdbdel(cdb);
+  iprintf("time: %.3f\n", tctime() - stime);
+  iprintf("%s\n\n", err ? "error" : "ok");
+  return err ? 1 : 0;
+}
+
+
+/* perform remove command */
+static int procremove(const char *path, bool mt, int omode, bool rnd){
+  iprintf("<Removing Test>\n  seed=%u  path=%s  mt=%d  omode=%d  rnd=%d\n\n",
+          g_randseed, path, mt, omode, rnd);
+  bool err = false;
+  double stime = tctime();
+  TCCDB *cdb = tccdbnew();
+  if(g_dbgfd >= 0) tccdbsetdbgfd(cdb, g_dbgfd);
+  if(mt && !tccdbsetmutex(cdb)){
+    eprint(cdb, __LINE__, "tccdbsetmutex");
+    err = true;
+  }
+  if(!tccdbopen(cdb, path, CDBOWRITER | omode)){
+    eprint(cdb, __LINE__, "tccdbopen");
+    err = true;
+  }
+  int rnum = tccdbrnum(cdb);
+  for(int i = 1; i <= rnum; i++){
+    int64_t id = rnd ? myrand(rnum) + 1 : i;
+    if(!tccdbout(cdb, id) && !(rnd && tccdbecode(cdb) == TCENOREC)){
+      eprint(cdb, __LINE__, "tccdbout");
+      err = true;
+      break;
+    }
+    if(rnum > 250 && i % (rnum / 250) == 0){
+      iputchar('.');
+      if(i == rnum || i % (rnum / 10) == 0) iprintf(" (%08d)\n", i);
+    }
+  }
+  iprintf("column number: %d\n", tccdbcolnum(cdb));
+  iprintf("record number: %llu\n", (unsigned long long)tccdbrnum(cdb));
+  iprintf("size: %llu\n", (unsigned long long)tccdbfsiz(cdb));
+  sysprint();
+  if(!tccdbclose(cdb)){
+    eprint(cdb, __LINE__, "tccdbclose");
+    err = true;
+  }
+  tccdbdel(cdb);
+  iprintf("time: %.3f\n", tctime() - stime);
+  iprintf("%s\n\n", err ? "error" : "ok");
+  return err ? 1 : 0;
+}
+
+
+/* perform misc command */
+static int procmisc(const char *path, int rnum, bool mt, int opts, int omode){
+  iprintf("<Miscellaneous Test>\n  seed=%u  path=%s  rnum=%d  mt=%d  opts=%d  omode=%d\n\n",
+          g_randseed, path, rnum, mt, opts, omode);
+  bool err = false;
+  double stime = tctime();
+  TCCDB *cdb = tccdbnew();
+  if(g_dbgfd >= 0) tccdbsetdbgfd(cdb, g_dbgfd);
+  if(mt && !tccdbsetmutex(cdb)){
+    eprint(cdb, __LINE__, "tccdbsetmutex");
+    err = true;
+  }
+  int64_t span = (opts & CDBTSPARSE) ? 100000 : 1;
+  if(!tccdbtune(cdb, rnum * span, opts)){
+    eprint(cdb, __LINE__, "tccdbtune");
+    err = true;
+  }
+  if(!tccdbopen(cdb, path, CDBOWRITER | CDBOCREAT | CDBOTRUNC | omode)){
+    eprint(cdb, __LINE__, "tccdbopen");
+    err = true;
+  }
+  iprintf("setting columns:\n");
+  if(!tccdbsetcol(cdb, "num", CDBCTINT, 0) || !tccdbsetcol(cdb, "big", CDBCTLONG, 0) ||
+     !tccdbsetcol(cdb, "val", CDBCTDBL, 0) || !tccdbsetcol(cdb, "str", CDBCTSTR, STRCOLWIDTH)){
+    eprint(cdb, __LINE__, "tccdbsetcol");
+    err = true;
+  }
+  if(tccdbsetcol(cdb, "num", CDBCTINT, 0) || tccdbecode(cdb) != TCEKEEP){
+    eprint(cdb, __LINE__, "tccdbsetcol");
+    err = true;
+  }
+  if(tccdbcolnum(cdb) != 4 || tccdbcoltype(cdb, "val") != CDBCTDBL ||
+     tccdbcolwidth(cdb, "str") != STRCOLWIDTH || tccdbcoltype(cdb, "none") != -1){
+    eprint(cdb, __LINE__, "tccdbcoltype");
+    err = true;
+  }
+  iprintf("writing:\n");
+  for(int i = 1; i <= rnum; i++){
+    int64_t id = (i - 1) * span + 1;
+    TCMAP *cols = makecols(id);
+    if(!tccdbput(cdb, id, cols)){
+      eprint(cdb, __LINE__, "tccdbput");
+      err = true;
+      tcmapdel(cols);
+      break;
+    }
+    tcmapdel(cols);
+    if(rnum > 250 && i % (rnum / 250) == 0){
+      iputchar('.');
+      if(i == rnum || i % (rnum / 10) == 0) iprintf(" (%08d)\n", i);
+    }
+  }
+  if(tccdbputcol(cdb, 1, "num", "x", 1) || tccdbecode(cdb) != TCEINVALID){
+    eprint(cdb, __LINE__, "tccdbputcol");
+    err = true;
+  }
+  iprintf("reading:\n");
+  for(int i = 1; i <= rnum; i++){
+    int64_t id = (i - 1) * span + 1;
+    TCMAP *cols = tccdbget(cdb, id);
+    if(!cols || !checkcols(cols, id)){
+      eprint(cdb, __LINE__, "tccdbget");
+      err = true;
+      if(cols) tcmapdel(cols);
+      break;
+    }
+    tcmapdel(cols);
+    int vsiz;
+    double *vp = tccdbgetcol(cdb, id, "val", &vsiz);
+    if(!vp || vsiz != sizeof(double) || *vp != id / 10.0){
+      eprint(cdb, __LINE__, "tccdbgetcol");
+      err = true;
+      tcfree(vp);
+      break;
+    }
+    tcfree(vp);
+    if(rnum > 250 && i % (rnum / 250) == 0){
+      iputchar('.');
+      if(i == rnum || i % (rnum / 10) == 0) iprintf(" (%08d)\n", i);
+    }
+  }
+  iprintf("scanning:\n");
+  for(int i = 1; i <= 20 && !err; i++){
+    int64_t lidx = myrand(rnum);
+    int64_t uidx = lidx + myrand(rnum - lidx);
+    int64_t lower = lidx * span + 1;
+    int64_t upper = uidx * span + 1;
+    int64_t cnt = uidx - lidx + 1;
+    double isum = 0.0;
+    for(int64_t j = lidx; j <= uidx; j++){
+      isum += j * span + 1;
+    }
+    int tnum = myrand(4) + 1;
+    FDBSCANRES res;
+    if(!tccdbscan(cdb, "num", lower, upper, FDBSCALL, NULL, 0, tnum, &res) ||
+       res.num != cnt || fabs(res.sum - isum) > 0.001 || res.min != lower || res.max != upper){
+      eprint(cdb, __LINE__, "tccdbscan");
+      err = true;
+    }
+    if(!tccdbscan(cdb, "big", lower, upper, FDBSCALL, NULL, 0, tnum, &res) ||
+       res.num != cnt || fabs(res.sum - isum * 1000) > isum * 1e-9 + 0.001){
+      eprint(cdb, __LINE__, "tccdbscan");
+      err = true;
+    }
+    if(!tccdbscan(cdb, "val", lower, upper, FDBSCALL, NULL, 0, tnum, &res) ||
+       res.num != cnt || fabs(res.sum - isum / 10) > isum * 1e-9 + 0.001){
+      eprint(cdb, __LINE__, "tccdbscan");
+      err = true;
+    }
+    char expr[RECBUFSIZ];
+    int esiz = sprintf(expr, "%08lld", (long long)lower);
+    if(!tccdbscan(cdb, "str", lower, upper, FDBSCSTREQ, expr, esiz, tnum, &res) ||
+       res.num != 1){
+      eprint(cdb, __LINE__, "tccdbscan");
+      err = true;
+    }
+  }
+  iprintf("removing:\n");
+  for(int i = 1; i <= rnum; i += 2){
+    int64_t id = (i - 1) * span + 1;
+    if(!tccdbout(cdb, id)){
+      eprint(cdb, __LINE__, "tccdbout");
+      err = true;
+      break;
+    }
+    if(tccdbget(cdb, id) || tccdbecode(cdb) != TCENOREC){
+      eprint(cdb, __LINE__, "tccdbget");
+      err = true;
+      break;
+    }
+  }
+  if(tccdbrnum(cdb) != rnum / 2){
+    eprint(cdb, __LINE__, "tccdbrnum");
+    err = true;
+  }
+  iprintf("storing partial records:\n");
+  for(int i = 1; i <= rnum; i += 2){
+    int64_t id = (i - 1) * span + 1;
+    int32_t num = id;
+    if(!tccdbputcol(cdb, id, "num", &num, sizeof(num))){
+      eprint(cdb, __LINE__, "tccdbputcol");
+      err = true;
+      break;
+    }
+    TCMAP *cols = tccdbget(cdb, id);
+    if(!cols || tcmaprnum(cols) != 1){
+      eprint(cdb, __LINE__, "tccdbget");
+      err = true;
+      if(cols) tcmapdel(cols);
+      break;
+    }
+    tcmapdel(cols);
+  }
+  if(tccdbrnum(cdb) != rnum){
+    eprint(cdb, __LINE__, "tccdbrnum");
+    err = true;
+  }
+  iprintf("traversing:\n");
+  if(!tccdbiterinit(cdb)){
+    eprint(cdb, __LINE__, "tccdbiterinit");
+    err = true;
+  }
+  int inum = 0;
+  uint64_t id;
+  while((id = tccdbiternext(cdb)) > 0){
+    inum++;
+  }
+  if(inum != rnum){
+    eprint(cdb, __LINE__, "tccdbiternext");
+    err = true;
+  }
+  int num;
+  uint64_t *ids = tccdbrange(cdb, FDBIDMIN, FDBIDMAX, -1, &num);
+  if(num != rnum){
+    eprint(cdb, __LINE__, "tccdbrange");
+    err = true;
+  }
+  tcfree(ids);
+  iprintf("reopening:\n");
+  if(!tccdbclose(cdb)){
+    eprint(cdb, __LINE__, "tccdbclose");
+    err = true;
+  }
+  if(!tccdbopen(cdb, path, CDBOWRITER | omode)){
+    eprint(cdb, __LINE__, "tccdbopen");
+    err = true;
+  }
+  if(tccdbcolnum(cdb) != 4 || tccdbcoltype(cdb, "big") != CDBCTLONG ||
+     tccdbcolwidth(cdb, "str") != STRCOLWIDTH || tccdbrnum(cdb) != rnum){
+    eprint(cdb, __LINE__, "tccdbcolnum");
+    err = true;
+  }
+  for(int i = 2; i <= rnum; i += 2){
+    int64_t id = (i - 1) * span + 1;
+    TCMAP *cols = tccdbget(cdb, id);
+    if(!cols || !checkcols(cols, id)){
+      eprint(cdb, __LINE__, "tccdbget");
+      err = true;
+      if(cols) tcmapdel(cols);
+      break;
+    }
+    tcmapdel(cols);
+  }
+  if(!tccdbsync(cdb)){
+    eprint(cdb, __LINE__, "tccdbsync");
+    err = true;
+  }
+  if(!tccdbvanish(cdb)){
+    eprint(cdb, __LINE__, "tccdbvanish");
+    err = true;
+  }
+  if(tccdbrnum(cdb) != 0){
+    eprint(cdb, __LINE__, "tccdbrnum");
+    err = true;
+  }
+  iprintf("column number: %d\n", tccdbcolnum(cdb));
+  iprintf("record number: %llu\n", (unsigned long long)tccdbrnum(cdb));
+  iprintf("size: %llu\n", (unsigned long long)tccdbfsiz(cdb));
+  sysprint();
+  if(!tccdbclose(cdb)){
+    eprint(cdb, __LINE__, "tccdbclose");
+    err = true;
+  }
+  tccdbdel(cdb);
+  iprintf("time: %.3f\n", tctime() - stime);
+  iprintf("%s\n\n", err ? "error" : "ok");
+  return err ? 1 : 0;
+}
+
+
+
+// END OF FILE
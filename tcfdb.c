@@ -25,12 +25,15 @@
 #define FDBHEADSIZ     256               // size of the reagion of the header
 #define FDBTYPEOFF     32                // offset of the region for the database type
 #define FDBFLAGSOFF    33                // offset of the region for the additional flags
+#define FDBOPTSOFF     34                // offset of the region for the options
 #define FDBRNUMOFF     48                // offset of the region for the record number
 #define FDBFSIZOFF     56                // offset of the region for the file size
 #define FDBWIDTHOFF    64                // offset of the region for the record width
 #define FDBLIMSIZOFF   72                // offset of the region for the limit size
 #define FDBMINOFF      80                // offset of the region for the minimum ID offset
 #define FDBMAXOFF      88                // offset of the region for the maximum ID offset
+#define FDBHEADOFF     96                // offset of the region for the head ID of a ring
+#define FDBTAILOFF     104               // offset of the region for the tail ID of a ring
 #define FDBOPAQUEOFF   128               // offset of the region for the opaque field
 
 #define FDBDEFWIDTH    255               // default value width
@@ -39,6 +42,22 @@
 #define FDBTRUNCALW    256               // number of record for truncate allowance
 #define FDBIDARYUNIT   2048              // size of ID array allocation unit
 #define FDBWALSUFFIX   "wal"             // suffix of write ahead logging file
+#define FDBCACHELINE   64                // size of a cache line for atomic operations
+
+#define FDBSPL1NUM     (1 << 16)         // number of entries of the first level directory
+#define FDBSPL2BITS    14                // bits of the index of the second level directory
+#define FDBSPPGBITS    10                // bits of the index of a record in a page
+#define FDBSPL2NUM     (1 << FDBSPL2BITS)  // number of entries of a second level directory
+#define FDBSPPGREC     (1 << FDBSPPGBITS)  // number of records in a page
+#define FDBSPBMSIZ     (FDBSPPGREC / 8)  // size of the presence bitmap of a page
+#define FDBSPALIGN     4096              // alignment of regions allocated for the directory
+#define FDBSCSEGPG     64                // number of pages of a segment of a parallel scan
+#define FDBMEMUNIT     (2LL<<20)         // unit of growth of an on-memory database
+#define FDBMEMTRYNUM   64                // number of tries to create a shared memory object
+#define FDBDEFPCNUM    128               // default number of cached pages
+#define FDBCACHEOUT    8                 // minimum number of pages purged at once
+#define FDBCPALIGN     16                // alignment of regions of compressed pages
+#define FDBCPHEADSIZ   (FDBSPBMSIZ + sizeof(uint32_t) * 2)  // size of the header of a compressed page
 
 enum {                                   // enumeration for duplication behavior
   FDBPDOVER,                             // overwrite an existing value
@@ -54,6 +73,40 @@ typedef struct {                         // type of structure for a duplication
   void *op;                              // opaque pointer
 } FDBPDPROCOP;
 
+typedef struct {                         // type of structure for a scan
+  TCFDB *fdb;                            // database object
+  uint64_t lower;                        // lower limit ID number
+  uint64_t upper;                        // upper limit ID number
+  int vtype;                             // type of the values
+  int op;                                // condition
+  const char *ebuf;                      // pointer to the operand
+  int esiz;                              // size of the operand
+  double lnum;                           // lower bound of numeric conditions
+  double unum;                           // upper bound of numeric conditions
+  int tnum;                              // number of workers
+} FDBSCANCTX;
+
+typedef struct {                         // type of structure for a worker of a scan
+  FDBSCANCTX *ctx;                       // scan context
+  int idx;                               // index of the worker
+  FDBSCANRES res;                        // partial result
+} FDBSCANARG;
+
+typedef struct {                         // type of structure for a worker of parallel iteration
+  TCFDB *fdb;                            // database object
+  uint64_t lower;                        // lower limit ID number of the partition
+  uint64_t upper;                        // upper limit ID number of the partition
+  TCITER iter;                           // iterator function
+  void *op;                              // opaque pointer of the worker
+  volatile bool *stop;                   // flag to stop all workers
+  int ecode;                             // error code of the worker
+} FDBFEARG;
+
+typedef struct {                         // type of structure for a cached page
+  unsigned char *buf;                    // region of the bitmap and the records
+  bool dirty;                            // whether to be written back
+} FDBCPAGE;
+
 
 /* private macros */
 #define FDBLOCKMETHOD(TC_fdb, TC_wr) \
@@ -76,8 +129,17 @@ typedef struct {                         // type of structure for a duplication
   ((TC_fdb)->mmtx ? tcfdblockwal(TC_fdb) : true)
 #define FDBUNLOCKWAL(TC_fdb) \
   ((TC_fdb)->mmtx ? tcfdbunlockwal(TC_fdb) : true)
+#define FDBLOCKCACHE(TC_fdb) \
+  ((TC_fdb)->mmtx ? tcfdblockcache(TC_fdb) : true)
+#define FDBUNLOCKCACHE(TC_fdb) \
+  ((TC_fdb)->mmtx ? tcfdbunlockcache(TC_fdb) : true)
 #define FDBTHREADYIELD(TC_fdb) \
   do { if((TC_fdb)->mmtx) sched_yield(); } while(false)
+#define FDBARYREC(TC_fdb, TC_id) \
+  ((TC_fdb)->array + (((TC_fdb)->opts & FDBTRING) ? \
+                      ((TC_id) - 1) % (TC_fdb)->capnum : (TC_id) - 1) * (TC_fdb)->rsiz)
+#define FDBHEADID(TC_fdb) \
+  (((TC_fdb)->opts & FDBTRING) ? (TC_fdb)->head : (TC_fdb)->max)
 
 
 /* private function prototypes */
@@ -89,21 +151,68 @@ static bool tcfdbwalinit(TCFDB *fdb);
 static bool tcfdbwalwrite(TCFDB *fdb, uint64_t off, int64_t size);
 static int tcfdbwalrestore(TCFDB *fdb, const char *path);
 static bool tcfdbwalremove(TCFDB *fdb, const char *path);
+static int tcfdbmemopen(void);
+static bool tcfdbmemgrow(TCFDB *fdb, int fd, uint64_t size);
+static uint64_t tcfdbmemalign(TCFDB *fdb, uint64_t size);
 static bool tcfdbopenimpl(TCFDB *fdb, const char *path, int omode);
+static bool tcfdbopenfd(TCFDB *fdb, const char *path, int omode, int fd);
 static bool tcfdbcloseimpl(TCFDB *fdb);
 static int64_t tcfdbprevid(TCFDB *fdb, int64_t id);
 static int64_t tcfdbnextid(TCFDB *fdb, int64_t id);
 static bool tcfdbputimpl(TCFDB *fdb, int64_t id, const void *vbuf, int vsiz, int dmode);
 static bool tcfdboutimpl(TCFDB *fdb, int64_t id);
 static const void *tcfdbgetimpl(TCFDB *fdb, int64_t id, int *sp);
+static unsigned char *tcfdbrecptr(TCFDB *fdb, int64_t id);
+static const void *tcfdbrecval(TCFDB *fdb, const unsigned char *rec, int *sp);
+static bool tcfdbrecmodify(TCFDB *fdb, int64_t id, unsigned char *rec);
+static uint64_t tcfdbspentry(TCFDB *fdb, uint64_t off);
+static uint64_t tcfdbsppage(TCFDB *fdb, uint64_t pn);
+static uint64_t tcfdbspextend(TCFDB *fdb, uint64_t size, int align);
+static bool tcfdbspsetentry(TCFDB *fdb, uint64_t off, uint64_t val);
+static unsigned char *tcfdbsppgptr(TCFDB *fdb, uint64_t pn);
+static const unsigned char *tcfdbspbitmap(TCFDB *fdb, uint64_t l2off, uint64_t pn);
+static unsigned char *tcfdbsprec(TCFDB *fdb, int64_t id, bool alloc);
+static bool tcfdbspsetbit(TCFDB *fdb, int64_t id, bool sign);
+static int tcfdbspbitnext(const unsigned char *bm, int bit);
+static int tcfdbspbitprev(const unsigned char *bm, int bit);
+static int64_t tcfdbspnextid(TCFDB *fdb, int64_t id);
+static int64_t tcfdbspprevid(TCFDB *fdb, int64_t id);
+static bool tcfdbpageexpand(TCFDB *fdb, uint64_t off, unsigned char *buf);
+static unsigned char *tcfdbpageload(TCFDB *fdb, uint64_t pn);
+static unsigned char *tcfdbpagenew(TCFDB *fdb, uint64_t pn);
+static void tcfdbpagedirty(TCFDB *fdb, uint64_t pn);
+static const unsigned char *tcfdbpageread(TCFDB *fdb, uint64_t pn, unsigned char *buf);
+static bool tcfdbpagesave(TCFDB *fdb, uint64_t pn, FDBCPAGE *page);
+static bool tcfdbcacheflush(TCFDB *fdb);
+static bool tcfdbcacheadjust(TCFDB *fdb);
+static void tcfdbcacheclear(TCFDB *fdb);
+static bool tcfdbringadvance(TCFDB *fdb, int64_t id);
+static void tcfdbringexpire(TCFDB *fdb, int64_t id);
+static void tcfdbringsetmeta(TCFDB *fdb);
+static void tcfdbringloadmeta(TCFDB *fdb);
+static unsigned char *tcfdbatomicptr(TCFDB *fdb, int64_t id, int vsiz);
+static int tcfdbaddatomic(TCFDB *fdb, int64_t id, void *vbuf, int vsiz, bool dbl);
+static bool tcfdbcasimpl(TCFDB *fdb, int64_t id, const void *obuf, int osiz,
+                         const void *nbuf, int nsiz);
+static bool tcfdbscanimpl(TCFDB *fdb, FDBSCANCTX *ctx, FDBSCANRES *res);
+static void *tcfdbscanthread(void *targ);
+static void tcfdbscanpart(FDBSCANARG *arg);
+static void tcfdbscanblock(FDBSCANCTX *ctx, const unsigned char *rec, const unsigned char *bm,
+                           int bit, int num, char *sbuf, FDBSCANRES *res);
 static bool tcfdbiterinitimpl(TCFDB *fdb);
 static uint64_t tcfdbiternextimpl(TCFDB *fdb);
 static uint64_t *tcfdbrangeimpl(TCFDB *fdb, int64_t lower, int64_t upper, int max, int *np);
 static bool tcfdboptimizeimpl(TCFDB *fdb, int32_t width, int64_t limsiz);
+static bool tcfdboptimizememimpl(TCFDB *fdb, int32_t width, int64_t limsiz);
 static bool tcfdbvanishimpl(TCFDB *fdb);
 static bool tcfdbcopyimpl(TCFDB *fdb, const char *path);
 static bool tcfdbiterjumpimpl(TCFDB *fdb, int64_t id);
-static bool tcfdbforeachimpl(TCFDB *fdb, TCITER iter, void *op);
+static bool tcfdbforeachimpl(TCFDB *fdb, uint64_t lower, uint64_t upper, TCITER iter, void *op,
+                             volatile bool *stop);
+static bool tcfdbforeachparimpl(TCFDB *fdb, TCITER iter, void **ops, int tnum,
+                                TCREDUCE reduce, void *rop);
+static void *tcfdbforeachthread(void *targ);
+static void tcfdbforeachpart(FDBFEARG *arg);
 static bool tcfdblockmethod(TCFDB *fdb, bool wr);
 static bool tcfdbunlockmethod(TCFDB *fdb);
 static bool tcfdblockattr(TCFDB *fdb);
@@ -114,6 +223,8 @@ static bool tcfdblockallrecords(TCFDB *fdb, bool wr);
 static bool tcfdbunlockallrecords(TCFDB *fdb);
 static bool tcfdblockwal(TCFDB *fdb);
 static bool tcfdbunlockwal(TCFDB *fdb);
+static bool tcfdblockcache(TCFDB *fdb);
+static bool tcfdbunlockcache(TCFDB *fdb);
 
 
 /* debugging function prototypes */
@@ -147,6 +258,7 @@ void tcfdbdel(TCFDB *fdb){
   if(fdb->fd >= 0) tcfdbclose(fdb);
   if(fdb->mmtx){
     pthread_key_delete(*(pthread_key_t *)fdb->eckey);
+    pthread_mutex_destroy(fdb->cmtx);
     pthread_mutex_destroy(fdb->wmtx);
     pthread_mutex_destroy(fdb->tmtx);
     for(int i = FDBRMTXNUM - 1; i >= 0; i--){
@@ -155,6 +267,7 @@ void tcfdbdel(TCFDB *fdb){
     pthread_mutex_destroy(fdb->amtx);
     pthread_rwlock_destroy(fdb->mmtx);
     TCFREE(fdb->eckey);
+    TCFREE(fdb->cmtx);
     TCFREE(fdb->wmtx);
     TCFREE(fdb->tmtx);
     TCFREE(fdb->rmtxs);
@@ -186,6 +299,7 @@ bool tcfdbsetmutex(TCFDB *fdb){
   TCMALLOC(fdb->rmtxs, sizeof(pthread_rwlock_t) * FDBRMTXNUM);
   TCMALLOC(fdb->tmtx, sizeof(pthread_mutex_t));
   TCMALLOC(fdb->wmtx, sizeof(pthread_mutex_t));
+  TCMALLOC(fdb->cmtx, sizeof(pthread_mutex_t));
   TCMALLOC(fdb->eckey, sizeof(pthread_key_t));
   bool err = false;
   if(pthread_rwlock_init(fdb->mmtx, NULL) != 0) err = true;
@@ -195,15 +309,18 @@ bool tcfdbsetmutex(TCFDB *fdb){
   }
   if(pthread_mutex_init(fdb->tmtx, NULL) != 0) err = true;
   if(pthread_mutex_init(fdb->wmtx, NULL) != 0) err = true;
+  if(pthread_mutex_init(fdb->cmtx, NULL) != 0) err = true;
   if(pthread_key_create(fdb->eckey, NULL) != 0) err = true;
   if(err){
     TCFREE(fdb->eckey);
+    TCFREE(fdb->cmtx);
     TCFREE(fdb->wmtx);
     TCFREE(fdb->tmtx);
     TCFREE(fdb->rmtxs);
     TCFREE(fdb->amtx);
     TCFREE(fdb->mmtx);
     fdb->eckey = NULL;
+    fdb->cmtx = NULL;
     fdb->wmtx = NULL;
     fdb->tmtx = NULL;
     fdb->rmtxs = NULL;
@@ -231,6 +348,35 @@ bool tcfdbtune(TCFDB *fdb, int32_t width, int64_t limsiz){
 }
 
 
+/* Set the tuning options of a fixed-length database object. */
+bool tcfdbsetopts(TCFDB *fdb, uint8_t opts){
+  assert(fdb);
+  if(fdb->fd >= 0){
+    tcfdbsetecode(fdb, TCEINVALID, __FILE__, __LINE__, __func__);
+    return false;
+  }
+  if(opts & FDBTPACK) opts |= FDBTSPARSE;
+  if((opts & FDBTSPARSE) && (opts & FDBTRING)){
+    tcfdbsetecode(fdb, TCEINVALID, __FILE__, __LINE__, __func__);
+    return false;
+  }
+  fdb->opts = opts;
+  return true;
+}
+
+
+/* Set the caching parameters of a fixed-length database object. */
+bool tcfdbsetcache(TCFDB *fdb, int32_t pcnum){
+  assert(fdb);
+  if(fdb->fd >= 0){
+    tcfdbsetecode(fdb, TCEINVALID, __FILE__, __LINE__, __func__);
+    return false;
+  }
+  if(pcnum > 0) fdb->pcnum = tclmax(pcnum, FDBCACHEOUT);
+  return true;
+}
+
+
 /* Open a database file and connect a fixed-length database object. */
 bool tcfdbopen(TCFDB *fdb, const char *path, int omode){
   assert(fdb && path);
@@ -240,6 +386,16 @@ bool tcfdbopen(TCFDB *fdb, const char *path, int omode){
     FDBUNLOCKMETHOD(fdb);
     return false;
   }
+  if(omode & FDBOMEMORY){
+    bool rv = false;
+    if(omode & FDBOWRITER){
+      rv = tcfdbopenimpl(fdb, path, omode);
+    } else {
+      tcfdbsetecode(fdb, TCEINVALID, __FILE__, __LINE__, __func__);
+    }
+    FDBUNLOCKMETHOD(fdb);
+    return rv;
+  }
   char *rpath = tcrealpath(path);
   if(!rpath){
     int ecode = TCEOPEN;
@@ -280,9 +436,11 @@ bool tcfdbclose(TCFDB *fdb){
     return false;
   }
   bool rv = tcfdbcloseimpl(fdb);
-  tcpathunlock(fdb->rpath);
-  TCFREE(fdb->rpath);
-  fdb->rpath = NULL;
+  if(fdb->rpath){
+    tcpathunlock(fdb->rpath);
+    TCFREE(fdb->rpath);
+    fdb->rpath = NULL;
+  }
   FDBUNLOCKMETHOD(fdb);
   return rv;
 }
@@ -304,7 +462,7 @@ bool tcfdbput(TCFDB *fdb, int64_t id, const void *vbuf, int vsiz){
   } else if(id == FDBIDMAX){
     id = fdb->max;
   } else if(id == FDBIDNEXT){
-    id = fdb->max + 1;
+    id = FDBHEADID(fdb) + 1;
   }
   if(id < 1 || id > fdb->limid){
     tcfdbsetecode(fdb, TCEINVALID, __FILE__, __LINE__, __func__);
@@ -317,7 +475,12 @@ bool tcfdbput(TCFDB *fdb, int64_t id, const void *vbuf, int vsiz){
   }
   bool rv = tcfdbputimpl(fdb, id, vbuf, vsiz, FDBPDOVER);
   FDBUNLOCKRECORD(fdb, id);
+  bool adj = fdb->pagec && TCMAPRNUM(fdb->pagec) > fdb->pcnum;
   FDBUNLOCKMETHOD(fdb);
+  if(adj && FDBLOCKMETHOD(fdb, true)){
+    if(!tcfdbcacheadjust(fdb)) rv = false;
+    FDBUNLOCKMETHOD(fdb);
+  }
   return rv;
 }
 
@@ -352,7 +515,7 @@ bool tcfdbputkeep(TCFDB *fdb, int64_t id, const void *vbuf, int vsiz){
   } else if(id == FDBIDMAX){
     id = fdb->max;
   } else if(id == FDBIDNEXT){
-    id = fdb->max + 1;
+    id = FDBHEADID(fdb) + 1;
   }
   if(id < 1 || id > fdb->limid){
     tcfdbsetecode(fdb, TCEINVALID, __FILE__, __LINE__, __func__);
@@ -365,7 +528,12 @@ bool tcfdbputkeep(TCFDB *fdb, int64_t id, const void *vbuf, int vsiz){
   }
   bool rv = tcfdbputimpl(fdb, id, vbuf, vsiz, FDBPDKEEP);
   FDBUNLOCKRECORD(fdb, id);
+  bool adj = fdb->pagec && TCMAPRNUM(fdb->pagec) > fdb->pcnum;
   FDBUNLOCKMETHOD(fdb);
+  if(adj && FDBLOCKMETHOD(fdb, true)){
+    if(!tcfdbcacheadjust(fdb)) rv = false;
+    FDBUNLOCKMETHOD(fdb);
+  }
   return rv;
 }
 
@@ -400,7 +568,7 @@ bool tcfdbputcat(TCFDB *fdb, int64_t id, const void *vbuf, int vsiz){
   } else if(id == FDBIDMAX){
     id = fdb->max;
   } else if(id == FDBIDNEXT){
-    id = fdb->max + 1;
+    id = FDBHEADID(fdb) + 1;
   }
   if(id < 1 || id > fdb->limid){
     tcfdbsetecode(fdb, TCEINVALID, __FILE__, __LINE__, __func__);
@@ -413,7 +581,12 @@ bool tcfdbputcat(TCFDB *fdb, int64_t id, const void *vbuf, int vsiz){
   }
   bool rv = tcfdbputimpl(fdb, id, vbuf, vsiz, FDBPDCAT);
   FDBUNLOCKRECORD(fdb, id);
+  bool adj = fdb->pagec && TCMAPRNUM(fdb->pagec) > fdb->pcnum;
   FDBUNLOCKMETHOD(fdb);
+  if(adj && FDBLOCKMETHOD(fdb, true)){
+    if(!tcfdbcacheadjust(fdb)) rv = false;
+    FDBUNLOCKMETHOD(fdb);
+  }
   return rv;
 }
 
@@ -457,6 +630,7 @@ bool tcfdbout(TCFDB *fdb, int64_t id){
   }
   bool rv = tcfdboutimpl(fdb, id);
   FDBUNLOCKRECORD(fdb, id);
+  if(!tcfdbcacheadjust(fdb)) rv = false;
   FDBUNLOCKMETHOD(fdb);
   return rv;
 }
@@ -502,7 +676,15 @@ void *tcfdbget(TCFDB *fdb, int64_t id, int *sp){
   const void *vbuf = tcfdbgetimpl(fdb, id, sp);
   char *rv = vbuf ? tcmemdup(vbuf, *sp) : NULL;
   FDBUNLOCKRECORD(fdb, id);
+  bool adj = fdb->pagec && TCMAPRNUM(fdb->pagec) > fdb->pcnum;
   FDBUNLOCKMETHOD(fdb);
+  if(adj && FDBLOCKMETHOD(fdb, true)){
+    if(!tcfdbcacheadjust(fdb)){
+      TCFREE(rv);
+      rv = NULL;
+    }
+    FDBUNLOCKMETHOD(fdb);
+  }
   return rv;
 }
 
@@ -554,7 +736,12 @@ int tcfdbget4(TCFDB *fdb, int64_t id, void *vbuf, int max){
     vsiz = -1;
   }
   FDBUNLOCKRECORD(fdb, id);
+  bool adj = fdb->pagec && TCMAPRNUM(fdb->pagec) > fdb->pcnum;
   FDBUNLOCKMETHOD(fdb);
+  if(adj && FDBLOCKMETHOD(fdb, true)){
+    if(!tcfdbcacheadjust(fdb)) vsiz = -1;
+    FDBUNLOCKMETHOD(fdb);
+  }
   return vsiz;
 }
 
@@ -586,7 +773,12 @@ int tcfdbvsiz(TCFDB *fdb, int64_t id){
   const void *vbuf = tcfdbgetimpl(fdb, id, &vsiz);
   if(!vbuf) vsiz = -1;
   FDBUNLOCKRECORD(fdb, id);
+  bool adj = fdb->pagec && TCMAPRNUM(fdb->pagec) > fdb->pcnum;
   FDBUNLOCKMETHOD(fdb);
+  if(adj && FDBLOCKMETHOD(fdb, true)){
+    if(!tcfdbcacheadjust(fdb)) vsiz = -1;
+    FDBUNLOCKMETHOD(fdb);
+  }
   return vsiz;
 }
 
@@ -800,20 +992,42 @@ int tcfdbaddint(TCFDB *fdb, int64_t id, int num){
   } else if(id == FDBIDMAX){
     id = fdb->max;
   } else if(id == FDBIDNEXT){
-    id = fdb->max + 1;
+    id = FDBHEADID(fdb) + 1;
   }
   if(id < 1 || id > fdb->limid){
     tcfdbsetecode(fdb, TCEINVALID, __FILE__, __LINE__, __func__);
     FDBUNLOCKMETHOD(fdb);
     return INT_MIN;
   }
+  if(TCUSEATOMIC && fdb->mmtx){
+    if(!FDBLOCKRECORD(fdb, false, id)){
+      FDBUNLOCKMETHOD(fdb);
+      return INT_MIN;
+    }
+    int arv = tcfdbaddatomic(fdb, id, &num, sizeof(num), false);
+    FDBUNLOCKRECORD(fdb, id);
+    if(arv != 0){
+      bool adj = fdb->pagec && TCMAPRNUM(fdb->pagec) > fdb->pcnum;
+      FDBUNLOCKMETHOD(fdb);
+      if(adj && FDBLOCKMETHOD(fdb, true)){
+        if(!tcfdbcacheadjust(fdb)) arv = -1;
+        FDBUNLOCKMETHOD(fdb);
+      }
+      return arv > 0 ? num : INT_MIN;
+    }
+  }
   if(!FDBLOCKRECORD(fdb, true, id)){
     FDBUNLOCKMETHOD(fdb);
     return INT_MIN;
   }
   bool rv = tcfdbputimpl(fdb, id, (char *)&num, sizeof(num), FDBPDADDINT);
   FDBUNLOCKRECORD(fdb, id);
+  bool adj = fdb->pagec && TCMAPRNUM(fdb->pagec) > fdb->pcnum;
   FDBUNLOCKMETHOD(fdb);
+  if(adj && FDBLOCKMETHOD(fdb, true)){
+    if(!tcfdbcacheadjust(fdb)) rv = false;
+    FDBUNLOCKMETHOD(fdb);
+  }
   return rv ? num : INT_MIN;
 }
 
@@ -834,24 +1048,224 @@ double tcfdbadddouble(TCFDB *fdb, int64_t id, double num){
   } else if(id == FDBIDMAX){
     id = fdb->max;
   } else if(id == FDBIDNEXT){
-    id = fdb->max + 1;
+    id = FDBHEADID(fdb) + 1;
   }
   if(id < 1 || id > fdb->limid){
     tcfdbsetecode(fdb, TCEINVALID, __FILE__, __LINE__, __func__);
     FDBUNLOCKMETHOD(fdb);
     return nan("");
   }
+  if(TCUSEATOMIC && fdb->mmtx){
+    if(!FDBLOCKRECORD(fdb, false, id)){
+      FDBUNLOCKMETHOD(fdb);
+      return nan("");
+    }
+    int arv = tcfdbaddatomic(fdb, id, &num, sizeof(num), true);
+    FDBUNLOCKRECORD(fdb, id);
+    if(arv != 0){
+      bool adj = fdb->pagec && TCMAPRNUM(fdb->pagec) > fdb->pcnum;
+      FDBUNLOCKMETHOD(fdb);
+      if(adj && FDBLOCKMETHOD(fdb, true)){
+        if(!tcfdbcacheadjust(fdb)) arv = -1;
+        FDBUNLOCKMETHOD(fdb);
+      }
+      return arv > 0 ? num : nan("");
+    }
+  }
   if(!FDBLOCKRECORD(fdb, true, id)){
     FDBUNLOCKMETHOD(fdb);
     return nan("");
   }
   bool rv = tcfdbputimpl(fdb, id, (char *)&num, sizeof(num), FDBPDADDDBL);
   FDBUNLOCKRECORD(fdb, id);
+  bool adj = fdb->pagec && TCMAPRNUM(fdb->pagec) > fdb->pcnum;
   FDBUNLOCKMETHOD(fdb);
+  if(adj && FDBLOCKMETHOD(fdb, true)){
+    if(!tcfdbcacheadjust(fdb)) rv = false;
+    FDBUNLOCKMETHOD(fdb);
+  }
   return rv ? num : nan("");
 }
 
 
+/* Replace the value of a record in a fixed-length database object only if it has the expected
+   value. */
+bool tcfdbcas(TCFDB *fdb, int64_t id, const void *obuf, int osiz, const void *nbuf, int nsiz){
+  assert(fdb && (obuf || nbuf));
+  if(!FDBLOCKMETHOD(fdb, id < 1)) return false;
+  if(fdb->fd < 0 || !(fdb->omode & FDBOWRITER)){
+    tcfdbsetecode(fdb, TCEINVALID, __FILE__, __LINE__, __func__);
+    FDBUNLOCKMETHOD(fdb);
+    return false;
+  }
+  if(id == FDBIDMIN){
+    id = fdb->min;
+  } else if(id == FDBIDPREV){
+    id = fdb->min - 1;
+  } else if(id == FDBIDMAX){
+    id = fdb->max;
+  } else if(id == FDBIDNEXT){
+    id = FDBHEADID(fdb) + 1;
+  }
+  if(id < 1 || id > fdb->limid){
+    tcfdbsetecode(fdb, TCEINVALID, __FILE__, __LINE__, __func__);
+    FDBUNLOCKMETHOD(fdb);
+    return false;
+  }
+  if(osiz > fdb->width) osiz = fdb->width;
+  if(nsiz > fdb->width) nsiz = fdb->width;
+#if TCUSEATOMIC
+  if(fdb->mmtx && obuf && nbuf && osiz == nsiz &&
+     (osiz == sizeof(uint32_t) || osiz == sizeof(uint64_t))){
+    if(!FDBLOCKRECORD(fdb, false, id)){
+      FDBUNLOCKMETHOD(fdb);
+      return false;
+    }
+    unsigned char *rp = tcfdbatomicptr(fdb, id, osiz);
+    if(rp){
+      bool rv = false;
+      if(tcfdbrecmodify(fdb, id, rp - fdb->wsiz)){
+        if(osiz == sizeof(uint32_t)){
+          uint32_t onum, nnum;
+          memcpy(&onum, obuf, sizeof(onum));
+          memcpy(&nnum, nbuf, sizeof(nnum));
+          rv = __sync_bool_compare_and_swap((uint32_t *)rp, onum, nnum);
+        } else {
+          uint64_t onum, nnum;
+          memcpy(&onum, obuf, sizeof(onum));
+          memcpy(&nnum, nbuf, sizeof(nnum));
+          rv = __sync_bool_compare_and_swap((uint64_t *)rp, onum, nnum);
+        }
+        if(rv){
+          TCDODEBUG(fdb->cnt_writerec++);
+        } else {
+          tcfdbsetecode(fdb, TCEKEEP, __FILE__, __LINE__, __func__);
+        }
+      }
+      FDBUNLOCKRECORD(fdb, id);
+      bool adj = fdb->pagec && TCMAPRNUM(fdb->pagec) > fdb->pcnum;
+      FDBUNLOCKMETHOD(fdb);
+      if(adj && FDBLOCKMETHOD(fdb, true)){
+        if(!tcfdbcacheadjust(fdb)) rv = false;
+        FDBUNLOCKMETHOD(fdb);
+      }
+      return rv;
+    }
+    FDBUNLOCKRECORD(fdb, id);
+  }
+#endif
+  if(!FDBLOCKRECORD(fdb, true, id)){
+    FDBUNLOCKMETHOD(fdb);
+    return false;
+  }
+  bool rv = tcfdbcasimpl(fdb, id, obuf, osiz, nbuf, nsiz);
+  FDBUNLOCKRECORD(fdb, id);
+  bool adj = fdb->pagec && TCMAPRNUM(fdb->pagec) > fdb->pcnum;
+  FDBUNLOCKMETHOD(fdb);
+  if(adj && FDBLOCKMETHOD(fdb, true)){
+    if(!tcfdbcacheadjust(fdb)) rv = false;
+    FDBUNLOCKMETHOD(fdb);
+  }
+  return rv;
+}
+
+
+/* Scan records in a range of a fixed-length database object and aggregate matching ones. */
+bool tcfdbscan(TCFDB *fdb, int64_t lower, int64_t upper, int vtype, int op,
+               const void *ebuf, int esiz, int tnum, FDBSCANRES *res){
+  assert(fdb && res);
+  if(!ebuf){
+    ebuf = "";
+    esiz = 0;
+  }
+  if(!FDBLOCKMETHOD(fdb, false)) return false;
+  if(fdb->fd < 0){
+    tcfdbsetecode(fdb, TCEINVALID, __FILE__, __LINE__, __func__);
+    FDBUNLOCKMETHOD(fdb);
+    return false;
+  }
+  if(lower == FDBIDMIN) lower = fdb->min;
+  if(upper == FDBIDMAX) upper = fdb->max;
+  if(lower < 0 || lower > fdb->limid || upper < 0 || upper > fdb->limid ||
+     vtype < FDBSVSTR || vtype > FDBSVDBL || op < FDBSCALL || op > FDBSCNUMBT || esiz < 0){
+    tcfdbsetecode(fdb, TCEINVALID, __FILE__, __LINE__, __func__);
+    FDBUNLOCKMETHOD(fdb);
+    return false;
+  }
+  FDBSCANCTX ctx;
+  ctx.fdb = fdb;
+  ctx.lower = tclmax(lower, fdb->min);
+  ctx.upper = tclmin(upper, fdb->max);
+  ctx.vtype = vtype;
+  ctx.op = op;
+  ctx.ebuf = ebuf;
+  ctx.esiz = esiz;
+  ctx.lnum = 0;
+  ctx.unum = 0;
+  if(op == FDBSCNUMEQ || op == FDBSCNUMBT){
+    char *expr = tcmemdup(ebuf, esiz);
+    ctx.lnum = tcatof(expr);
+    ctx.unum = ctx.lnum;
+    if(op == FDBSCNUMBT){
+      char *pv = expr;
+      while(*pv == ' ' || *pv == ','){
+        pv++;
+      }
+      while(*pv != '\0' && *pv != ' ' && *pv != ','){
+        pv++;
+      }
+      while(*pv == ' ' || *pv == ','){
+        pv++;
+      }
+      ctx.unum = tcatof(pv);
+      if(ctx.lnum > ctx.unum){
+        double swap = ctx.lnum;
+        ctx.lnum = ctx.unum;
+        ctx.unum = swap;
+      }
+    }
+    TCFREE(expr);
+  }
+  ctx.tnum = (tnum > 1 && TCUSEPTHREAD) ? tnum : 1;
+  if(!FDBLOCKALLRECORDS(fdb, false)){
+    FDBUNLOCKMETHOD(fdb);
+    return false;
+  }
+  bool rv = tcfdbscanimpl(fdb, &ctx, res);
+  FDBUNLOCKALLRECORDS(fdb);
+  FDBUNLOCKMETHOD(fdb);
+  return rv;
+}
+
+
+/* Remove records less than an ID number of a fixed-length database object. */
+bool tcfdbexpire(TCFDB *fdb, int64_t id){
+  assert(fdb);
+  if(!FDBLOCKMETHOD(fdb, true)) return false;
+  if(fdb->fd < 0 || !(fdb->omode & FDBOWRITER)){
+    tcfdbsetecode(fdb, TCEINVALID, __FILE__, __LINE__, __func__);
+    FDBUNLOCKMETHOD(fdb);
+    return false;
+  }
+  if(id == FDBIDMAX) id = FDBHEADID(fdb) + 1;
+  if(id < 1){
+    tcfdbsetecode(fdb, TCEINVALID, __FILE__, __LINE__, __func__);
+    FDBUNLOCKMETHOD(fdb);
+    return false;
+  }
+  bool err = false;
+  if(fdb->opts & FDBTRING){
+    tcfdbringexpire(fdb, tclmin(id, fdb->head + 1));
+  } else {
+    while(!err && fdb->min > 0 && (int64_t)fdb->min < id){
+      if(!tcfdboutimpl(fdb, fdb->min) || !tcfdbcacheadjust(fdb)) err = true;
+    }
+  }
+  FDBUNLOCKMETHOD(fdb);
+  return !err;
+}
+
+
 /* Synchronize updated contents of a fixed-length database object with the file and the device. */
 bool tcfdbsync(TCFDB *fdb){
   assert(fdb);
@@ -944,9 +1358,14 @@ bool tcfdbtranbegin(TCFDB *fdb){
     return false;
   }
   if(fdb->walfd < 0){
-    char *tpath = tcsprintf("%s%c%s", fdb->path, MYEXTCHR, FDBWALSUFFIX);
-    int walfd = open(tpath, O_RDWR | O_CREAT | O_TRUNC, FDBFILEMODE);
-    TCFREE(tpath);
+    int walfd;
+    if(fdb->omode & FDBOMEMORY){
+      walfd = tcfdbmemopen();
+    } else {
+      char *tpath = tcsprintf("%s%c%s", fdb->path, MYEXTCHR, FDBWALSUFFIX);
+      walfd = open(tpath, O_RDWR | O_CREAT | O_TRUNC, FDBFILEMODE);
+      TCFREE(tpath);
+    }
     if(walfd < 0){
       int ecode = TCEOPEN;
       switch(errno){
@@ -1004,6 +1423,7 @@ bool tcfdbtranabort(TCFDB *fdb){
     return false;
   }
   bool err = false;
+  if(fdb->pagec) tcfdbcacheclear(fdb);
   if(!tcfdbmemsync(fdb, false)) err = true;
   if(!tcfdbwalrestore(fdb, fdb->path)) err = true;
   char hbuf[FDBHEADSIZ];
@@ -1123,6 +1543,7 @@ bool tcfdbmemsync(TCFDB *fdb, bool phys){
     return false;
   }
   bool err = false;
+  if(fdb->pagec && !tcfdbcacheflush(fdb)) err = true;
   char hbuf[FDBHEADSIZ];
   tcfdbdumpmeta(fdb, hbuf);
   memcpy(fdb->map, hbuf, FDBOPAQUEOFF);
@@ -1162,6 +1583,30 @@ uint64_t tcfdbmax(TCFDB *fdb){
 }
 
 
+/* Get the head ID number of a fixed-length database object. */
+uint64_t tcfdbhead(TCFDB *fdb){
+  assert(fdb);
+  if(fdb->fd < 0){
+    tcfdbsetecode(fdb, TCEINVALID, __FILE__, __LINE__, __func__);
+    return 0;
+  }
+  if((fdb->opts & FDBTRING) && !(fdb->omode & FDBOWRITER)) tcfdbringloadmeta(fdb);
+  return FDBHEADID(fdb);
+}
+
+
+/* Get the tail ID number of a fixed-length database object. */
+uint64_t tcfdbtail(TCFDB *fdb){
+  assert(fdb);
+  if(fdb->fd < 0){
+    tcfdbsetecode(fdb, TCEINVALID, __FILE__, __LINE__, __func__);
+    return 0;
+  }
+  if((fdb->opts & FDBTRING) && !(fdb->omode & FDBOWRITER)) tcfdbringloadmeta(fdb);
+  return (fdb->opts & FDBTRING) ? fdb->tail : fdb->min;
+}
+
+
 /* Get the width of the value of each record of a fixed-length database object. */
 uint32_t tcfdbwidth(TCFDB *fdb){
   assert(fdb);
@@ -1250,6 +1695,17 @@ uint8_t tcfdbflags(TCFDB *fdb){
 }
 
 
+/* Get the options of a fixed-length database object. */
+uint8_t tcfdbopts(TCFDB *fdb){
+  assert(fdb);
+  if(fdb->fd < 0){
+    tcfdbsetecode(fdb, TCEINVALID, __FILE__, __LINE__, __func__);
+    return 0;
+  }
+  return fdb->opts;
+}
+
+
 /* Get the pointer to the opaque field of a fixed-length database object. */
 char *tcfdbopaque(TCFDB *fdb){
   assert(fdb);
@@ -1277,7 +1733,7 @@ bool tcfdbputproc(TCFDB *fdb, int64_t id, const void *vbuf, int vsiz, TCPDPROC p
   } else if(id == FDBIDMAX){
     id = fdb->max;
   } else if(id == FDBIDNEXT){
-    id = fdb->max + 1;
+    id = FDBHEADID(fdb) + 1;
   }
   if(id < 1 || id > fdb->limid){
     tcfdbsetecode(fdb, TCEINVALID, __FILE__, __LINE__, __func__);
@@ -1314,7 +1770,12 @@ bool tcfdbputproc(TCFDB *fdb, int64_t id, const void *vbuf, int vsiz, TCPDPROC p
   bool rv = tcfdbputimpl(fdb, id, vbuf, vsiz, FDBPDPROC);
   if(rbuf != stack) TCFREE(rbuf);
   FDBUNLOCKRECORD(fdb, id);
+  bool adj = fdb->pagec && TCMAPRNUM(fdb->pagec) > fdb->pcnum;
   FDBUNLOCKMETHOD(fdb);
+  if(adj && FDBLOCKMETHOD(fdb, true)){
+    if(!tcfdbcacheadjust(fdb)) rv = false;
+    FDBUNLOCKMETHOD(fdb);
+  }
   return rv;
 }
 
@@ -1339,6 +1800,7 @@ bool tcfdbiterinit2(TCFDB *fdb, int64_t id){
     return false;
   }
   bool rv = tcfdbiterjumpimpl(fdb, id);
+  if(!tcfdbcacheadjust(fdb)) rv = false;
   FDBUNLOCKMETHOD(fdb);
   return rv;
 }
@@ -1372,7 +1834,29 @@ bool tcfdbforeach(TCFDB *fdb, TCITER iter, void *op){
     return false;
   }
   FDBTHREADYIELD(fdb);
-  bool rv = tcfdbforeachimpl(fdb, iter, op);
+  bool stop = false;
+  bool rv = tcfdbforeachimpl(fdb, fdb->min, fdb->max, iter, op, &stop);
+  FDBUNLOCKALLRECORDS(fdb);
+  FDBUNLOCKMETHOD(fdb);
+  return rv;
+}
+
+
+/* Process each record of a fixed-length database object by partitions in parallel. */
+bool tcfdbforeachpar(TCFDB *fdb, TCITER iter, void **ops, int tnum, TCREDUCE reduce, void *rop){
+  assert(fdb && iter && ops);
+  if(!FDBLOCKMETHOD(fdb, false)) return false;
+  if(fdb->fd < 0){
+    tcfdbsetecode(fdb, TCEINVALID, __FILE__, __LINE__, __func__);
+    FDBUNLOCKMETHOD(fdb);
+    return false;
+  }
+  if(!FDBLOCKALLRECORDS(fdb, false)){
+    FDBUNLOCKMETHOD(fdb);
+    return false;
+  }
+  FDBTHREADYIELD(fdb);
+  bool rv = tcfdbforeachparimpl(fdb, iter, ops, tnum, reduce, rop);
   FDBUNLOCKALLRECORDS(fdb);
   FDBUNLOCKMETHOD(fdb);
   return rv;
@@ -1415,6 +1899,7 @@ static void tcfdbdumpmeta(TCFDB *fdb, char *hbuf){
   sprintf(hbuf, "%s\n%s:%d\n", FDBMAGICDATA, _TC_FORMATVER, _TC_LIBVER);
   memcpy(hbuf + FDBTYPEOFF, &(fdb->type), sizeof(fdb->type));
   memcpy(hbuf + FDBFLAGSOFF, &(fdb->flags), sizeof(fdb->flags));
+  memcpy(hbuf + FDBOPTSOFF, &(fdb->opts), sizeof(fdb->opts));
   uint64_t llnum;
   llnum = fdb->rnum;
   llnum = TCHTOILL(llnum);
@@ -1434,6 +1919,12 @@ static void tcfdbdumpmeta(TCFDB *fdb, char *hbuf){
   llnum = fdb->max;
   llnum = TCHTOILL(llnum);
   memcpy(hbuf + FDBMAXOFF, &llnum, sizeof(llnum));
+  llnum = fdb->head;
+  llnum = TCHTOILL(llnum);
+  memcpy(hbuf + FDBHEADOFF, &llnum, sizeof(llnum));
+  llnum = fdb->tail;
+  llnum = TCHTOILL(llnum);
+  memcpy(hbuf + FDBTAILOFF, &llnum, sizeof(llnum));
 }
 
 
@@ -1443,6 +1934,7 @@ static void tcfdbdumpmeta(TCFDB *fdb, char *hbuf){
 static void tcfdbloadmeta(TCFDB *fdb, const char *hbuf){
   memcpy(&(fdb->type), hbuf + FDBTYPEOFF, sizeof(fdb->type));
   memcpy(&(fdb->flags), hbuf + FDBFLAGSOFF, sizeof(fdb->flags));
+  memcpy(&(fdb->opts), hbuf + FDBOPTSOFF, sizeof(fdb->opts));
   uint64_t llnum;
   memcpy(&llnum, hbuf + FDBRNUMOFF, sizeof(llnum));
   fdb->rnum = TCITOHLL(llnum);
@@ -1456,6 +1948,10 @@ static void tcfdbloadmeta(TCFDB *fdb, const char *hbuf){
   fdb->min = TCITOHLL(llnum);
   memcpy(&llnum, hbuf + FDBMAXOFF, sizeof(llnum));
   fdb->max = TCITOHLL(llnum);
+  memcpy(&llnum, hbuf + FDBHEADOFF, sizeof(llnum));
+  fdb->head = TCITOHLL(llnum);
+  memcpy(&llnum, hbuf + FDBTAILOFF, sizeof(llnum));
+  fdb->tail = TCITOHLL(llnum);
 }
 
 
@@ -1468,10 +1964,12 @@ static void tcfdbclear(TCFDB *fdb){
   fdb->rmtxs = NULL;
   fdb->tmtx = NULL;
   fdb->wmtx = NULL;
+  fdb->cmtx = NULL;
   fdb->eckey = NULL;
   fdb->rpath = NULL;
   fdb->type = TCDBTFIXED;
   fdb->flags = 0;
+  fdb->opts = 0;
   fdb->width = FDBDEFWIDTH;
   fdb->limsiz = FDBDEFLIMSIZ;
   fdb->wsiz = 0;
@@ -1484,6 +1982,11 @@ static void tcfdbclear(TCFDB *fdb){
   fdb->fsiz = 0;
   fdb->min = 0;
   fdb->max = 0;
+  fdb->head = 0;
+  fdb->tail = 0;
+  fdb->capnum = 0;
+  fdb->pagec = NULL;
+  fdb->pcnum = FDBDEFPCNUM;
   fdb->iter = 0;
   fdb->map = NULL;
   fdb->array = NULL;
@@ -1594,9 +2097,20 @@ static bool tcfdbwalwrite(TCFDB *fdb, uint64_t off, int64_t size){
    If successful, the return value is true, else, it is false. */
 static int tcfdbwalrestore(TCFDB *fdb, const char *path){
   assert(fdb && path);
-  char *tpath = tcsprintf("%s%c%s", path, MYEXTCHR, FDBWALSUFFIX);
-  int walfd = open(tpath, O_RDONLY, FDBFILEMODE);
-  TCFREE(tpath);
+  int walfd;
+  if(fdb->fd >= 0 && (fdb->omode & FDBOMEMORY)){
+    if(fdb->walfd < 0) return false;
+    walfd = dup(fdb->walfd);
+    if(walfd >= 0 && lseek(walfd, 0, SEEK_SET) == -1){
+      tcfdbsetecode(fdb, TCESEEK, __FILE__, __LINE__, __func__);
+      close(walfd);
+      return false;
+    }
+  } else {
+    char *tpath = tcsprintf("%s%c%s", path, MYEXTCHR, FDBWALSUFFIX);
+    walfd = open(tpath, O_RDONLY, FDBFILEMODE);
+    TCFREE(tpath);
+  }
   if(walfd < 0) return false;
   bool err = false;
   uint64_t walsiz = 0;
@@ -1723,6 +2237,77 @@ static bool tcfdbwalremove(TCFDB *fdb, const char *path){
 }
 
 
+/* Create an anonymous memory object.
+   The return value is the file descriptor of the object or -1 on failure.
+   The object is released when the descriptor is closed.  Where `memfd_create' is not available,
+   a shared memory object is created and unlinked at once. */
+static int tcfdbmemopen(void){
+#if defined(MFD_CLOEXEC)
+  int fd = memfd_create("tcfdb", MFD_CLOEXEC);
+  if(fd >= 0 || errno != ENOSYS) return fd;
+#endif
+  char name[TCNUMBUFSIZ*2];
+  unsigned long long seed = tctime() * 1000000;
+  for(int i = 0; i < FDBMEMTRYNUM; i++){
+    sprintf(name, "/tcfdb-%d-%llu", (int)getpid(), seed + i);
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, FDBFILEMODE);
+    if(fd >= 0){
+      shm_unlink(name);
+      return fd;
+    }
+    if(errno != EEXIST) break;
+  }
+  return -1;
+}
+
+
+/* Grow the memory object of an on-memory database.
+   `fdb' specifies the fixed-length database object.
+   `fd' specifies the file descriptor of the memory object.
+   `size' specifies the new size of the object.  If it is not more than the current size, nothing
+   is done.
+   If successful, the return value is true, else, it is false.
+   The grown region is allocated at once so that lack of memory is reported as an error here
+   instead of raising a bus error when the mapped region is touched later. */
+static bool tcfdbmemgrow(TCFDB *fdb, int fd, uint64_t size){
+  assert(fdb && fd >= 0);
+  struct stat sbuf;
+  if(fstat(fd, &sbuf) == -1){
+    tcfdbsetecode(fdb, TCESTAT, __FILE__, __LINE__, __func__);
+    return false;
+  }
+  uint64_t osiz = sbuf.st_size;
+  if(size <= osiz) return true;
+  if(ftruncate(fd, size) == -1){
+    tcfdbsetecode(fdb, (errno == ENOSPC || errno == ENOMEM) ? TCEINVALID : TCETRUNC,
+                  __FILE__, __LINE__, __func__);
+    return false;
+  }
+  int ecode = posix_fallocate(fd, osiz, size - osiz);
+  if(ecode != 0){
+    if(ftruncate(fd, osiz) == -1){
+      tcfdbsetecode(fdb, TCETRUNC, __FILE__, __LINE__, __func__);
+      return false;
+    }
+    tcfdbsetecode(fdb, (ecode == ENOSPC || ecode == ENOMEM) ? TCEINVALID : TCETRUNC,
+                  __FILE__, __LINE__, __func__);
+    return false;
+  }
+  return true;
+}
+
+
+/* Get the size of the shared memory object to hold a region of an on-memory database.
+   `fdb' specifies the fixed-length database object.
+   `size' specifies the size of the region.
+   The return value is the size aligned to the growth unit within the limit size. */
+static uint64_t tcfdbmemalign(TCFDB *fdb, uint64_t size){
+  assert(fdb);
+  size = (size + FDBMEMUNIT - 1) / FDBMEMUNIT * FDBMEMUNIT;
+  return size < fdb->limsiz ? size : fdb->limsiz;
+}
+
+
 /* Open a database file and connect a fixed-length database object.
    `fdb' specifies the fixed-length database object.
    `path' specifies the path of the database file.
@@ -1735,7 +2320,7 @@ static bool tcfdbopenimpl(TCFDB *fdb, const char *path, int omode){
     mode = O_RDWR;
     if(omode & FDBOCREAT) mode |= O_CREAT;
   }
-  int fd = open(path, mode, FDBFILEMODE);
+  int fd = (omode & FDBOMEMORY) ? tcfdbmemopen() : open(path, mode, FDBFILEMODE);
   if(fd < 0){
     int ecode = TCEOPEN;
     switch(errno){
@@ -1746,14 +2331,26 @@ static bool tcfdbopenimpl(TCFDB *fdb, const char *path, int omode){
     tcfdbsetecode(fdb, ecode, __FILE__, __LINE__, __func__);
     return false;
   }
-  if(!(omode & FDBONOLCK)){
+  return tcfdbopenfd(fdb, path, omode, fd);
+}
+
+
+/* Connect a fixed-length database object to an opened database file.
+   `fdb' specifies the fixed-length database object.
+   `path' specifies the path of the database file.
+   `omode' specifies the connection mode.
+   `fd' specifies the file descriptor of the database file.  It is closed on failure.
+   If successful, the return value is true, else, it is false. */
+static bool tcfdbopenfd(TCFDB *fdb, const char *path, int omode, int fd){
+  assert(fdb && path && fd >= 0);
+  if(!(omode & (FDBONOLCK | FDBOMEMORY))){
     if(!tclock(fd, omode & FDBOWRITER, omode & FDBOLCKNB)){
       tcfdbsetecode(fdb, TCELOCK, __FILE__, __LINE__, __func__);
       close(fd);
       return false;
     }
   }
-  if((omode & FDBOWRITER) && (omode & FDBOTRUNC)){
+  if((omode & FDBOWRITER) && (omode & FDBOTRUNC) && !(omode & FDBOMEMORY)){
     if(ftruncate(fd, 0) == -1){
       tcfdbsetecode(fdb, TCETRUNC, __FILE__, __LINE__, __func__);
       close(fd);
@@ -1777,12 +2374,33 @@ static bool tcfdbopenimpl(TCFDB *fdb, const char *path, int omode){
     fdb->fsiz = FDBHEADSIZ;
     fdb->min = 0;
     fdb->max = 0;
+    fdb->head = 0;
+    fdb->tail = 0;
+    if(fdb->opts & FDBTRING){
+      fdb->fsiz = fdb->limsiz;
+      fdb->tail = 1;
+    } else if(fdb->opts & FDBTSPARSE){
+      fdb->fsiz += FDBSPL1NUM * sizeof(uint64_t);
+      uint64_t minsiz = fdb->fsiz + FDBSPL2NUM * sizeof(uint64_t) + FDBSPBMSIZ +
+        FDBSPPGREC * (fdb->width + sizeof(uint32_t)) + FDBSPALIGN * 2;
+      if(fdb->limsiz < minsiz) fdb->limsiz = tcpagealign(minsiz);
+    }
     tcfdbdumpmeta(fdb, hbuf);
     if(!tcwrite(fd, hbuf, FDBHEADSIZ)){
       tcfdbsetecode(fdb, TCEWRITE, __FILE__, __LINE__, __func__);
       close(fd);
       return false;
     }
+    if(omode & FDBOMEMORY){
+      if(!tcfdbmemgrow(fdb, fd, tcfdbmemalign(fdb, fdb->fsiz))){
+        close(fd);
+        return false;
+      }
+    } else if(fdb->fsiz > FDBHEADSIZ && ftruncate(fd, fdb->fsiz) == -1){
+      tcfdbsetecode(fdb, TCETRUNC, __FILE__, __LINE__, __func__);
+      close(fd);
+      return false;
+    }
     sbuf.st_size = fdb->fsiz;
   }
   if(lseek(fd, 0, SEEK_SET) == -1){
@@ -1822,7 +2440,7 @@ static bool tcfdbopenimpl(TCFDB *fdb, const char *path, int omode){
       close(fd);
       return false;
     }
-    if(sbuf.st_size > fdb->fsiz) fdb->fsiz = sbuf.st_size;
+    if(!(omode & FDBOMEMORY) && sbuf.st_size > fdb->fsiz) fdb->fsiz = sbuf.st_size;
   }
   void *map = mmap(0, fdb->limsiz, PROT_READ | ((omode & FDBOWRITER) ? PROT_WRITE : 0),
                    MAP_SHARED, fd, 0);
@@ -1831,6 +2449,9 @@ static bool tcfdbopenimpl(TCFDB *fdb, const char *path, int omode){
     close(fd);
     return false;
   }
+#if defined(MADV_HUGEPAGE)
+  if(omode & FDBOMEMORY) madvise(map, fdb->limsiz, MADV_HUGEPAGE);
+#endif
   if(fdb->width <= UINT8_MAX){
     fdb->wsiz = sizeof(uint8_t);
   } else if(fdb->width <= UINT16_MAX){
@@ -1839,7 +2460,13 @@ static bool tcfdbopenimpl(TCFDB *fdb, const char *path, int omode){
     fdb->wsiz = sizeof(uint32_t);
   }
   fdb->rsiz = fdb->width + fdb->wsiz;
-  fdb->limid = (fdb->limsiz - FDBHEADSIZ) / fdb->rsiz;
+  fdb->limid = (fdb->opts & FDBTSPARSE) ?
+    (uint64_t)FDBSPL1NUM << (FDBSPL2BITS + FDBSPPGBITS) : (fdb->limsiz - FDBHEADSIZ) / fdb->rsiz;
+  fdb->capnum = 0;
+  if(fdb->opts & FDBTRING){
+    fdb->capnum = fdb->limid;
+    fdb->limid = INT64_MAX;
+  }
   fdb->path = tcstrdup(path);
   fdb->fd = fd;
   fdb->omode = omode;
@@ -1853,6 +2480,7 @@ static bool tcfdbopenimpl(TCFDB *fdb, const char *path, int omode){
   fdb->tran = false;
   fdb->walfd = -1;
   fdb->walend = 0;
+  fdb->pagec = (fdb->opts & FDBTPACK) ? tcmapnew2(fdb->pcnum * 2 + 1) : NULL;
   if(fdb->omode & FDBOWRITER) tcfdbsetflag(fdb, FDBFOPEN, true);
   return true;
 }
@@ -1866,6 +2494,11 @@ static bool tcfdbcloseimpl(TCFDB *fdb){
   bool err = false;
   if(fdb->omode & FDBOWRITER) tcfdbsetflag(fdb, FDBFOPEN, false);
   if((fdb->omode & FDBOWRITER) && !tcfdbmemsync(fdb, false)) err = true;
+  if(fdb->pagec){
+    tcfdbcacheclear(fdb);
+    tcmapdel(fdb->pagec);
+    fdb->pagec = NULL;
+  }
   if(munmap(fdb->map, fdb->limsiz) == -1){
     tcfdbsetecode(fdb, TCEMMAP, __FILE__, __LINE__, __func__);
     err = true;
@@ -1879,7 +2512,7 @@ static bool tcfdbcloseimpl(TCFDB *fdb){
       tcfdbsetecode(fdb, TCECLOSE, __FILE__, __LINE__, __func__);
       err = true;
     }
-    if(!fdb->fatal && !tcfdbwalremove(fdb, fdb->path)) err = true;
+    if(!fdb->fatal && !(fdb->omode & FDBOMEMORY) && !tcfdbwalremove(fdb, fdb->path)) err = true;
   }
   if(close(fdb->fd) == -1){
     tcfdbsetecode(fdb, TCECLOSE, __FILE__, __LINE__, __func__);
@@ -1898,10 +2531,11 @@ static bool tcfdbcloseimpl(TCFDB *fdb){
    The return value is the ID number of the previous record or 0 if no record corresponds. */
 static int64_t tcfdbprevid(TCFDB *fdb, int64_t id){
   assert(fdb && id >= 0);
+  if(fdb->opts & FDBTSPARSE) return tcfdbspprevid(fdb, id);
   id--;
   while(id >= fdb->min){
     TCDODEBUG(fdb->cnt_readrec++);
-    unsigned char *rec = fdb->array + (id - 1) * (fdb->rsiz);
+    unsigned char *rec = FDBARYREC(fdb, id);
     unsigned char *rp = rec;
     uint32_t osiz;
     uint16_t snum;
@@ -1934,10 +2568,11 @@ static int64_t tcfdbprevid(TCFDB *fdb, int64_t id){
    The return value is the ID number of the next record or 0 if no record corresponds. */
 static int64_t tcfdbnextid(TCFDB *fdb, int64_t id){
   assert(fdb && id >= 0);
+  if(fdb->opts & FDBTSPARSE) return tcfdbspnextid(fdb, id);
   id++;
   while(id <= fdb->max){
     TCDODEBUG(fdb->cnt_readrec++);
-    unsigned char *rec = fdb->array + (id - 1) * (fdb->rsiz);
+    unsigned char *rec = FDBARYREC(fdb, id);
     unsigned char *rp = rec;
     uint32_t osiz;
     uint16_t snum;
@@ -1974,27 +2609,64 @@ static int64_t tcfdbnextid(TCFDB *fdb, int64_t id){
 static bool tcfdbputimpl(TCFDB *fdb, int64_t id, const void *vbuf, int vsiz, int dmode){
   assert(fdb && id > 0);
   if(vsiz > (int64_t)fdb->width) vsiz = fdb->width;
-  TCDODEBUG(fdb->cnt_readrec++);
-  unsigned char *rec = fdb->array + (id - 1) * (fdb->rsiz);
-  uint64_t nsiz = FDBHEADSIZ + id * fdb->rsiz;
-  if(nsiz > fdb->fsiz){
-    if(nsiz > fdb->limsiz){
+  if(fdb->opts & FDBTRING){
+    if(!FDBLOCKATTR(fdb)) return false;
+    if(id < fdb->tail){
       tcfdbsetecode(fdb, TCEINVALID, __FILE__, __LINE__, __func__);
+      FDBUNLOCKATTR(fdb);
       return false;
     }
-    if(!FDBLOCKATTR(fdb)) return false;
-    if(nsiz > fdb->fsiz){
+    if(id > fdb->head){
       if(vsiz < 0){
         tcfdbsetecode(fdb, TCENOREC, __FILE__, __LINE__, __func__);
         FDBUNLOCKATTR(fdb);
         return false;
       }
-      if(nsiz + fdb->rsiz * FDBTRUNCALW < fdb->limsiz) nsiz += fdb->rsiz * FDBTRUNCALW;
-      if(ftruncate(fdb->fd, nsiz) == -1){
-        tcfdbsetecode(fdb, TCETRUNC, __FILE__, __LINE__, __func__);
+      if(!tcfdbringadvance(fdb, id)){
+        FDBUNLOCKATTR(fdb);
+        return false;
+      }
+    }
+    FDBUNLOCKATTR(fdb);
+  }
+  TCDODEBUG(fdb->cnt_readrec++);
+  unsigned char *rec;
+  if(fdb->opts & FDBTSPARSE){
+    rec = tcfdbsprec(fdb, id, vsiz >= 0);
+    if(!rec){
+      if(vsiz < 0) tcfdbsetecode(fdb, TCENOREC, __FILE__, __LINE__, __func__);
+      return false;
+    }
+  } else {
+    rec = FDBARYREC(fdb, id);
+  }
+  uint64_t nsiz = FDBHEADSIZ + id * fdb->rsiz;
+  if(!(fdb->opts & (FDBTSPARSE | FDBTRING)) && nsiz > fdb->fsiz){
+    if(nsiz > fdb->limsiz){
+      tcfdbsetecode(fdb, TCEINVALID, __FILE__, __LINE__, __func__);
+      return false;
+    }
+    if(!FDBLOCKATTR(fdb)) return false;
+    if(nsiz > fdb->fsiz){
+      if(vsiz < 0){
+        tcfdbsetecode(fdb, TCENOREC, __FILE__, __LINE__, __func__);
         FDBUNLOCKATTR(fdb);
         return false;
       }
+      if(fdb->omode & FDBOMEMORY){
+        nsiz = tcfdbmemalign(fdb, nsiz);
+        if(!tcfdbmemgrow(fdb, fdb->fd, nsiz)){
+          FDBUNLOCKATTR(fdb);
+          return false;
+        }
+      } else {
+        if(nsiz + fdb->rsiz * FDBTRUNCALW < fdb->limsiz) nsiz += fdb->rsiz * FDBTRUNCALW;
+        if(ftruncate(fdb->fd, nsiz) == -1){
+          tcfdbsetecode(fdb, TCETRUNC, __FILE__, __LINE__, __func__);
+          FDBUNLOCKATTR(fdb);
+          return false;
+        }
+      }
       TCDODEBUG(fdb->cnt_truncfile++);
       fdb->fsiz = nsiz;
       unsigned char *wp = rec;
@@ -2055,7 +2727,7 @@ static bool tcfdbputimpl(TCFDB *fdb, int64_t id, const void *vbuf, int vsiz, int
       return false;
     }
     if(dmode == FDBPDCAT){
-      if(fdb->tran && !tcfdbwalwrite(fdb, (char *)rec - fdb->map, fdb->width)) return false;
+      if(!tcfdbrecmodify(fdb, id, rec)) return false;
       vsiz = tclmin(vsiz, fdb->width - osiz);
       unsigned char *wp = rec;
       int usiz = osiz + vsiz;
@@ -2093,7 +2765,7 @@ static bool tcfdbputimpl(TCFDB *fdb, int64_t id, const void *vbuf, int vsiz, int
         *(int *)vbuf = lnum;
         return true;
       }
-      if(fdb->tran && !tcfdbwalwrite(fdb, (char *)rec - fdb->map, fdb->width)) return false;
+      if(!tcfdbrecmodify(fdb, id, rec)) return false;
       lnum += *(int *)vbuf;
       *(int *)vbuf = lnum;
       memcpy(rp, &lnum, sizeof(lnum));
@@ -2111,7 +2783,7 @@ static bool tcfdbputimpl(TCFDB *fdb, int64_t id, const void *vbuf, int vsiz, int
         *(double *)vbuf = dnum;
         return true;
       }
-      if(fdb->tran && !tcfdbwalwrite(fdb, (char *)rec - fdb->map, fdb->width)) return false;
+      if(!tcfdbrecmodify(fdb, id, rec)) return false;
       dnum += *(double *)vbuf;
       *(double *)vbuf = dnum;
       memcpy(rp, &dnum, sizeof(dnum));
@@ -2123,10 +2795,14 @@ static bool tcfdbputimpl(TCFDB *fdb, int64_t id, const void *vbuf, int vsiz, int
       int nvsiz;
       char *nvbuf = procptr->proc(rp, osiz, &nvsiz, procptr->op);
       if(nvbuf == (void *)-1){
-        if(fdb->tran && !tcfdbwalwrite(fdb, (char *)rec - fdb->map, fdb->width)) return false;
+        if(!tcfdbrecmodify(fdb, id, rec)) return false;
         memset(rec, 0, fdb->wsiz + 1);
         TCDODEBUG(fdb->cnt_writerec++);
         if(!FDBLOCKATTR(fdb)) return false;
+        if((fdb->opts & FDBTSPARSE) && !tcfdbspsetbit(fdb, id, false)){
+          FDBUNLOCKATTR(fdb);
+          return false;
+        }
         fdb->rnum--;
         if(fdb->rnum < 1){
           fdb->min = 0;
@@ -2141,6 +2817,7 @@ static bool tcfdbputimpl(TCFDB *fdb, int64_t id, const void *vbuf, int vsiz, int
           if(id == fdb->min) fdb->min = tcfdbnextid(fdb, id);
           if(id == fdb->max) fdb->max = tcfdbprevid(fdb, id);
         }
+        if(fdb->opts & FDBTRING) tcfdbringsetmeta(fdb);
         FDBUNLOCKATTR(fdb);
         return true;
       }
@@ -2148,7 +2825,7 @@ static bool tcfdbputimpl(TCFDB *fdb, int64_t id, const void *vbuf, int vsiz, int
         tcfdbsetecode(fdb, TCEKEEP, __FILE__, __LINE__, __func__);
         return false;
       }
-      if(fdb->tran && !tcfdbwalwrite(fdb, (char *)rec - fdb->map, fdb->width)) return false;
+      if(!tcfdbrecmodify(fdb, id, rec)) return false;
       if(nvsiz > fdb->width) nvsiz = fdb->width;
       unsigned char *wp = rec;
       switch(fdb->wsiz){
@@ -2180,7 +2857,7 @@ static bool tcfdbputimpl(TCFDB *fdb, int64_t id, const void *vbuf, int vsiz, int
     tcfdbsetecode(fdb, TCENOREC, __FILE__, __LINE__, __func__);
     return false;
   }
-  if(fdb->tran && !tcfdbwalwrite(fdb, (char *)rec - fdb->map, fdb->width)) return false;
+  if(!tcfdbrecmodify(fdb, id, rec)) return false;
   unsigned char *wp = rec;
   switch(fdb->wsiz){
   case 1:
@@ -2205,9 +2882,14 @@ static bool tcfdbputimpl(TCFDB *fdb, int64_t id, const void *vbuf, int vsiz, int
   TCDODEBUG(fdb->cnt_writerec++);
   if(miss){
     if(!FDBLOCKATTR(fdb)) return false;
+    if((fdb->opts & FDBTSPARSE) && !tcfdbspsetbit(fdb, id, true)){
+      FDBUNLOCKATTR(fdb);
+      return false;
+    }
     fdb->rnum++;
     if(fdb->min < 1 || id < fdb->min) fdb->min = id;
     if(fdb->max < 1 || id > fdb->max) fdb->max = id;
+    if(fdb->opts & FDBTRING) tcfdbringsetmeta(fdb);
     FDBUNLOCKATTR(fdb);
   }
   return true;
@@ -2221,9 +2903,8 @@ static bool tcfdbputimpl(TCFDB *fdb, int64_t id, const void *vbuf, int vsiz, int
 static bool tcfdboutimpl(TCFDB *fdb, int64_t id){
   assert(fdb && id >= 0);
   TCDODEBUG(fdb->cnt_readrec++);
-  unsigned char *rec = fdb->array + (id - 1) * (fdb->rsiz);
-  uint64_t nsiz = FDBHEADSIZ + id * fdb->rsiz;
-  if(nsiz > fdb->fsiz){
+  unsigned char *rec = tcfdbrecptr(fdb, id);
+  if(!rec){
     tcfdbsetecode(fdb, TCENOREC, __FILE__, __LINE__, __func__);
     return false;
   }
@@ -2250,10 +2931,14 @@ static bool tcfdboutimpl(TCFDB *fdb, int64_t id){
     tcfdbsetecode(fdb, TCENOREC, __FILE__, __LINE__, __func__);
     return false;
   }
-  if(fdb->tran && !tcfdbwalwrite(fdb, (char *)rec - fdb->map, fdb->width)) return false;
+  if(!tcfdbrecmodify(fdb, id, rec)) return false;
   memset(rec, 0, fdb->wsiz + 1);
   TCDODEBUG(fdb->cnt_writerec++);
   if(!FDBLOCKATTR(fdb)) return false;
+  if((fdb->opts & FDBTSPARSE) && !tcfdbspsetbit(fdb, id, false)){
+    FDBUNLOCKATTR(fdb);
+    return false;
+  }
   fdb->rnum--;
   if(fdb->rnum < 1){
     fdb->min = 0;
@@ -2268,6 +2953,7 @@ static bool tcfdboutimpl(TCFDB *fdb, int64_t id){
     if(id == fdb->min) fdb->min = tcfdbnextid(fdb, id);
     if(id == fdb->max) fdb->max = tcfdbprevid(fdb, id);
   }
+  if(fdb->opts & FDBTRING) tcfdbringsetmeta(fdb);
   FDBUNLOCKATTR(fdb);
   return true;
 }
@@ -2283,13 +2969,42 @@ static bool tcfdboutimpl(TCFDB *fdb, int64_t id){
 static const void *tcfdbgetimpl(TCFDB *fdb, int64_t id, int *sp){
   assert(fdb && id >= 0 && sp);
   TCDODEBUG(fdb->cnt_readrec++);
-  unsigned char *rec = fdb->array + (id - 1) * (fdb->rsiz);
-  uint64_t nsiz = FDBHEADSIZ + id * fdb->rsiz;
-  if(nsiz > fdb->fsiz){
+  unsigned char *rec = tcfdbrecptr(fdb, id);
+  const void *vbuf = rec ? tcfdbrecval(fdb, rec, sp) : NULL;
+  if(!vbuf){
     tcfdbsetecode(fdb, TCENOREC, __FILE__, __LINE__, __func__);
-    return false;
+    return NULL;
   }
-  unsigned char *rp = rec;
+  return vbuf;
+}
+
+
+/* Get the pointer to a record.
+   `fdb' specifies the fixed-length database object.
+   `id' specifies the ID number.
+   The return value is the pointer to the record or `NULL' if the region of the record is not
+   allocated. */
+static unsigned char *tcfdbrecptr(TCFDB *fdb, int64_t id){
+  assert(fdb && id > 0);
+  if(fdb->opts & FDBTSPARSE) return tcfdbsprec(fdb, id, false);
+  if(fdb->opts & FDBTRING){
+    if(id < fdb->tail || id > fdb->head) return NULL;
+    return FDBARYREC(fdb, id);
+  }
+  if(FDBHEADSIZ + id * fdb->rsiz > fdb->fsiz) return NULL;
+  return fdb->array + (id - 1) * (fdb->rsiz);
+}
+
+
+/* Get the value of a record.
+   `fdb' specifies the fixed-length database object.
+   `rec' specifies the pointer to the record.
+   `sp' specifies the pointer to the variable into which the size of the region of the return
+   value is assigned.
+   The return value is the pointer to the region of the value or `NULL' if the slot is empty. */
+static const void *tcfdbrecval(TCFDB *fdb, const unsigned char *rec, int *sp){
+  assert(fdb && rec && sp);
+  const unsigned char *rp = rec;
   uint32_t osiz;
   uint16_t snum;
   uint32_t lnum;
@@ -2308,15 +3023,1051 @@ static const void *tcfdbgetimpl(TCFDB *fdb, int64_t id, int *sp){
     rp += sizeof(lnum);
     break;
   }
-  if(osiz == 0 && *rp == 0){
-    tcfdbsetecode(fdb, TCENOREC, __FILE__, __LINE__, __func__);
+  if(osiz == 0 && *rp == 0) return NULL;
+  *sp = osiz;
+  return rp;
+}
+
+
+/* Prepare a record to be modified.
+   `fdb' specifies the fixed-length database object.
+   `id' specifies the ID number.
+   `rec' specifies the pointer to the record.
+   If successful, the return value is true, else, it is false.
+   The record is logged if a transaction is running.  If pages are compressed, the page of the
+   record is marked to be written back instead, since the record lives in the page cache. */
+static bool tcfdbrecmodify(TCFDB *fdb, int64_t id, unsigned char *rec){
+  assert(fdb && id > 0 && rec);
+  if(fdb->pagec){
+    tcfdbpagedirty(fdb, (uint64_t)(id - 1) >> FDBSPPGBITS);
+    return true;
+  }
+  return !fdb->tran || tcfdbwalwrite(fdb, (char *)rec - fdb->map, fdb->rsiz);
+}
+
+
+/* Read an entry of the directory of the sparse layout.
+   `fdb' specifies the fixed-length database object.
+   `off' specifies the offset of the entry.
+   The return value is the offset of the region the entry refers to or 0 if it is empty. */
+static uint64_t tcfdbspentry(TCFDB *fdb, uint64_t off){
+  assert(fdb);
+  uint64_t llnum;
+  memcpy(&llnum, fdb->map + off, sizeof(llnum));
+  return TCITOHLL(llnum);
+}
+
+
+/* Get the offset of a page of the sparse layout.
+   `fdb' specifies the fixed-length database object.
+   `pn' specifies the page number.
+   The return value is the offset of the page or 0 if it is not allocated. */
+static uint64_t tcfdbsppage(TCFDB *fdb, uint64_t pn){
+  assert(fdb);
+  uint64_t off = tcfdbspentry(fdb, FDBHEADSIZ + (pn >> FDBSPL2BITS) * sizeof(uint64_t));
+  if(off < 1) return 0;
+  return tcfdbspentry(fdb, off + (pn & (FDBSPL2NUM - 1)) * sizeof(uint64_t));
+}
+
+
+/* Allocate a region at the end of the file of the sparse layout.
+   `fdb' specifies the fixed-length database object.
+   `size' specifies the size of the region.
+   `align' specifies the alignment of the offset.
+   The return value is the offset of the region filled with zero or 0 on failure.
+   The caller should hold the attribute lock. */
+static uint64_t tcfdbspextend(TCFDB *fdb, uint64_t size, int align){
+  assert(fdb && size > 0 && align > 0);
+  uint64_t off = (fdb->fsiz + align - 1) / align * align;
+  uint64_t nsiz = off + size;
+  if(nsiz > fdb->limsiz){
+    tcfdbsetecode(fdb, TCEINVALID, __FILE__, __LINE__, __func__);
+    return 0;
+  }
+  if(fdb->omode & FDBOMEMORY){
+    if(!tcfdbmemgrow(fdb, fdb->fd, tcfdbmemalign(fdb, nsiz))) return 0;
+  } else {
+    if(ftruncate(fdb->fd, nsiz) == -1){
+      tcfdbsetecode(fdb, TCETRUNC, __FILE__, __LINE__, __func__);
+      return 0;
+    }
+    TCDODEBUG(fdb->cnt_truncfile++);
+  }
+  fdb->fsiz = nsiz;
+  return off;
+}
+
+
+/* Write an entry of the directory of the sparse layout.
+   `fdb' specifies the fixed-length database object.
+   `off' specifies the offset of the entry.
+   `val' specifies the offset of the region the entry refers to.
+   If successful, the return value is true, else, it is false.
+   The caller should hold the attribute lock. */
+static bool tcfdbspsetentry(TCFDB *fdb, uint64_t off, uint64_t val){
+  assert(fdb && off > 0);
+  if(fdb->tran && !tcfdbwalwrite(fdb, off, sizeof(val))) return false;
+  uint64_t llnum = TCHTOILL(val);
+  memcpy(fdb->map + off, &llnum, sizeof(llnum));
+  return true;
+}
+
+
+/* Get the pointer to a page of the sparse layout.
+   `fdb' specifies the fixed-length database object.
+   `pn' specifies the page number.
+   The return value is the pointer to the presence bitmap followed by the records of the page or
+   `NULL' if the page is not allocated.  If pages are compressed, the page is expanded into the
+   page cache. */
+static unsigned char *tcfdbsppgptr(TCFDB *fdb, uint64_t pn){
+  assert(fdb);
+  if(fdb->pagec) return tcfdbpageload(fdb, pn);
+  uint64_t off = tcfdbsppage(fdb, pn);
+  return off > 0 ? (unsigned char *)fdb->map + off : NULL;
+}
+
+
+/* Get the presence bitmap of a page of the sparse layout.
+   `fdb' specifies the fixed-length database object.
+   `l2off' specifies the offset of the second level directory of the page.
+   `pn' specifies the page number.
+   The return value is the pointer to the bitmap or `NULL' if the page is not allocated.
+   Because the bitmap of a compressed page is kept raw at the head of its region, the page is not
+   expanded. */
+static const unsigned char *tcfdbspbitmap(TCFDB *fdb, uint64_t l2off, uint64_t pn){
+  assert(fdb && l2off > 0);
+  if(fdb->pagec){
+    const unsigned char *bm = NULL;
+    if(FDBLOCKCACHE(fdb)){
+      int vsiz;
+      const FDBCPAGE *page = tcmapget(fdb->pagec, &pn, sizeof(pn), &vsiz);
+      if(page) bm = page->buf;
+      FDBUNLOCKCACHE(fdb);
+    }
+    if(bm) return bm;
+  }
+  uint64_t off = tcfdbspentry(fdb, l2off + (pn & (FDBSPL2NUM - 1)) * sizeof(uint64_t));
+  return off > 0 ? (unsigned char *)fdb->map + off : NULL;
+}
+
+
+/* Get the pointer to a record of the sparse layout.
+   `fdb' specifies the fixed-length database object.
+   `id' specifies the ID number.
+   `alloc' specifies whether to allocate the page of the record if it is not allocated.
+   The return value is the pointer to the record or `NULL' if the page is not allocated.  If
+   allocation fails, the error code is set. */
+static unsigned char *tcfdbsprec(TCFDB *fdb, int64_t id, bool alloc){
+  assert(fdb && id > 0);
+  uint64_t pn = (uint64_t)(id - 1) >> FDBSPPGBITS;
+  unsigned char *pg = tcfdbsppgptr(fdb, pn);
+  if(!pg){
+    if(!alloc || !FDBLOCKATTR(fdb)) return NULL;
+    pg = tcfdbsppgptr(fdb, pn);
+    if(!pg){
+      uint64_t eoff = FDBHEADSIZ + (pn >> FDBSPL2BITS) * sizeof(uint64_t);
+      uint64_t l2off = tcfdbspentry(fdb, eoff);
+      if(l2off < 1){
+        l2off = tcfdbspextend(fdb, FDBSPL2NUM * sizeof(uint64_t), FDBSPALIGN);
+        if(l2off > 0 && !tcfdbspsetentry(fdb, eoff, l2off)) l2off = 0;
+      }
+      if(l2off > 0){
+        if(fdb->pagec){
+          pg = tcfdbpagenew(fdb, pn);
+        } else {
+          eoff = l2off + (pn & (FDBSPL2NUM - 1)) * sizeof(uint64_t);
+          uint64_t pgoff = tcfdbspextend(fdb, FDBSPBMSIZ + FDBSPPGREC * fdb->rsiz, FDBSPALIGN);
+          if(pgoff > 0 && tcfdbspsetentry(fdb, eoff, pgoff))
+            pg = (unsigned char *)fdb->map + pgoff;
+        }
+      }
+    }
+    FDBUNLOCKATTR(fdb);
+    if(!pg) return NULL;
+  }
+  return pg + FDBSPBMSIZ + ((uint64_t)(id - 1) & (FDBSPPGREC - 1)) * fdb->rsiz;
+}
+
+
+/* Set the presence bit of a record of the sparse layout.
+   `fdb' specifies the fixed-length database object.
+   `id' specifies the ID number.
+   `sign' specifies whether the record exists.
+   If successful, the return value is true, else, it is false.
+   The caller should hold the attribute lock. */
+static bool tcfdbspsetbit(TCFDB *fdb, int64_t id, bool sign){
+  assert(fdb && id > 0);
+  uint64_t pn = (uint64_t)(id - 1) >> FDBSPPGBITS;
+  unsigned char *pg = tcfdbsppgptr(fdb, pn);
+  if(!pg) return true;
+  int bit = (id - 1) & (FDBSPPGREC - 1);
+  unsigned char *bp = pg + bit / 8;
+  if(fdb->pagec){
+    tcfdbpagedirty(fdb, pn);
+  } else if(fdb->tran && !tcfdbwalwrite(fdb, (char *)bp - fdb->map, 1)){
     return false;
   }
-  *sp = osiz;
+  if(sign){
+    *bp |= 1 << (bit % 8);
+  } else {
+    *bp &= ~(1 << (bit % 8));
+  }
+  return true;
+}
+
+
+/* Find the first set bit at or after a position of a presence bitmap.
+   `bm' specifies the pointer to the bitmap.
+   `bit' specifies the position to start from.
+   The return value is the position of the set bit or -1 if there is none. */
+static int tcfdbspbitnext(const unsigned char *bm, int bit){
+  assert(bm && bit >= 0);
+  while(bit < FDBSPPGREC){
+    if(bit % 64 == 0){
+      uint64_t word;
+      memcpy(&word, bm + bit / 8, sizeof(word));
+      if(word == 0){
+        bit += 64;
+        continue;
+      }
+    }
+    if(bit % 8 == 0 && bm[bit/8] == 0){
+      bit += 8;
+      continue;
+    }
+    if(bm[bit/8] & (1 << (bit % 8))) return bit;
+    bit++;
+  }
+  return -1;
+}
+
+
+/* Find the last set bit at or before a position of a presence bitmap.
+   `bm' specifies the pointer to the bitmap.
+   `bit' specifies the position to start from.
+   The return value is the position of the set bit or -1 if there is none. */
+static int tcfdbspbitprev(const unsigned char *bm, int bit){
+  assert(bm && bit < FDBSPPGREC);
+  while(bit >= 0){
+    if(bit % 64 == 63){
+      uint64_t word;
+      memcpy(&word, bm + (bit - 63) / 8, sizeof(word));
+      if(word == 0){
+        bit -= 64;
+        continue;
+      }
+    }
+    if(bit % 8 == 7 && bm[bit/8] == 0){
+      bit -= 8;
+      continue;
+    }
+    if(bm[bit/8] & (1 << (bit % 8))) return bit;
+    bit--;
+  }
+  return -1;
+}
+
+
+/* Get the next record of a record of the sparse layout.
+   `fdb' specifies the fixed-length database object.
+   `id' specifies the ID number.
+   The return value is the ID number of the next record or 0 if no record corresponds.
+   Unallocated directories and pages are skipped as a whole. */
+static int64_t tcfdbspnextid(TCFDB *fdb, int64_t id){
+  assert(fdb && id >= 0);
+  uint64_t idx = id;
+  while(idx < fdb->max){
+    TCDODEBUG(fdb->cnt_readrec++);
+    uint64_t pn = idx >> FDBSPPGBITS;
+    uint64_t l2off = tcfdbspentry(fdb, FDBHEADSIZ + (pn >> FDBSPL2BITS) * sizeof(uint64_t));
+    if(l2off < 1){
+      idx = ((pn >> FDBSPL2BITS) + 1) << (FDBSPL2BITS + FDBSPPGBITS);
+      continue;
+    }
+    const unsigned char *bm = tcfdbspbitmap(fdb, l2off, pn);
+    if(bm){
+      int bit = tcfdbspbitnext(bm, idx & (FDBSPPGREC - 1));
+      if(bit >= 0){
+        idx = (pn << FDBSPPGBITS) + bit;
+        return idx < fdb->max ? idx + 1 : 0;
+      }
+    }
+    idx = (pn + 1) << FDBSPPGBITS;
+  }
+  return 0;
+}
+
+
+/* Get the previous record of a record of the sparse layout.
+   `fdb' specifies the fixed-length database object.
+   `id' specifies the ID number.
+   The return value is the ID number of the previous record or 0 if no record corresponds.
+   Unallocated directories and pages are skipped as a whole. */
+static int64_t tcfdbspprevid(TCFDB *fdb, int64_t id){
+  assert(fdb && id >= 0);
+  if(id < 2 || fdb->min < 1) return 0;
+  int64_t idx = id - 2;
+  while(idx >= (int64_t)fdb->min - 1){
+    TCDODEBUG(fdb->cnt_readrec++);
+    uint64_t pn = (uint64_t)idx >> FDBSPPGBITS;
+    uint64_t l2off = tcfdbspentry(fdb, FDBHEADSIZ + (pn >> FDBSPL2BITS) * sizeof(uint64_t));
+    if(l2off < 1){
+      idx = (int64_t)((pn >> FDBSPL2BITS) << (FDBSPL2BITS + FDBSPPGBITS)) - 1;
+      continue;
+    }
+    const unsigned char *bm = tcfdbspbitmap(fdb, l2off, pn);
+    if(bm){
+      int bit = tcfdbspbitprev(bm, idx & (FDBSPPGREC - 1));
+      if(bit >= 0){
+        idx = (int64_t)(pn << FDBSPPGBITS) + bit;
+        return idx >= (int64_t)fdb->min - 1 ? idx + 1 : 0;
+      }
+    }
+    idx = (int64_t)(pn << FDBSPPGBITS) - 1;
+  }
+  return 0;
+}
+
+
+/* Expand a compressed page of the sparse layout.
+   `fdb' specifies the fixed-length database object.
+   `off' specifies the offset of the region of the compressed page.
+   `buf' specifies the buffer into which the bitmap and the records are written.
+   If successful, the return value is true, else, it is false. */
+static bool tcfdbpageexpand(TCFDB *fdb, uint64_t off, unsigned char *buf){
+  assert(fdb && off > 0 && buf);
+  const unsigned char *rp = (unsigned char *)fdb->map + off;
+  uint32_t lnum;
+  memcpy(&lnum, rp + FDBSPBMSIZ, sizeof(lnum));
+  int zsiz = TCITOHL(lnum);
+  int rsiz = FDBSPPGREC * fdb->rsiz;
+  if(zsiz < 0 || zsiz > rsiz || off + FDBCPHEADSIZ + zsiz > fdb->fsiz){
+    tcfdbsetecode(fdb, TCEMISC, __FILE__, __LINE__, __func__);
+    return false;
+  }
+  memcpy(buf, rp, FDBSPBMSIZ);
+  rp += FDBCPHEADSIZ;
+  if(zsiz == rsiz){
+    memcpy(buf + FDBSPBMSIZ, rp, rsiz);
+    return true;
+  }
+  int dsiz;
+  char *dbuf = tcpackdecode((const char *)rp, zsiz, &dsiz);
+  if(dsiz != rsiz){
+    tcfdbsetecode(fdb, TCEMISC, __FILE__, __LINE__, __func__);
+    TCFREE(dbuf);
+    return false;
+  }
+  memcpy(buf + FDBSPBMSIZ, dbuf, rsiz);
+  TCFREE(dbuf);
+  return true;
+}
+
+
+/* Get a page of the sparse layout through the page cache.
+   `fdb' specifies the fixed-length database object.
+   `pn' specifies the page number.
+   The return value is the pointer to the bitmap followed by the records of the cached page or
+   `NULL' if the page is not allocated.
+   The page is expanded into the cache if it is not cached. */
+static unsigned char *tcfdbpageload(TCFDB *fdb, uint64_t pn){
+  assert(fdb);
+  if(!FDBLOCKCACHE(fdb)) return NULL;
+  int vsiz;
+  const FDBCPAGE *page = tcmapget3(fdb->pagec, &pn, sizeof(pn), &vsiz);
+  unsigned char *buf = page ? page->buf : NULL;
+  if(!buf){
+    uint64_t off = tcfdbsppage(fdb, pn);
+    if(off > 0){
+      TCMALLOC(buf, FDBSPBMSIZ + FDBSPPGREC * fdb->rsiz);
+      if(tcfdbpageexpand(fdb, off, buf)){
+        FDBCPAGE npage;
+        npage.buf = buf;
+        npage.dirty = false;
+        tcmapputkeep(fdb->pagec, &pn, sizeof(pn), &npage, sizeof(npage));
+      } else {
+        TCFREE(buf);
+        buf = NULL;
+      }
+    }
+  }
+  FDBUNLOCKCACHE(fdb);
+  return buf;
+}
+
+
+/* Create an empty page of the sparse layout in the page cache.
+   `fdb' specifies the fixed-length database object.
+   `pn' specifies the page number.
+   The return value is the pointer to the bitmap followed by the records of the cached page.
+   The caller should hold the attribute lock.  The region in the file is allocated when the page
+   is written back. */
+static unsigned char *tcfdbpagenew(TCFDB *fdb, uint64_t pn){
+  assert(fdb);
+  if(!FDBLOCKCACHE(fdb)) return NULL;
+  FDBCPAGE page;
+  TCCALLOC(page.buf, 1, FDBSPBMSIZ + FDBSPPGREC * fdb->rsiz);
+  page.dirty = true;
+  tcmapput(fdb->pagec, &pn, sizeof(pn), &page, sizeof(page));
+  FDBUNLOCKCACHE(fdb);
+  return page.buf;
+}
+
+
+/* Mark a cached page of the sparse layout to be written back.
+   `fdb' specifies the fixed-length database object.
+   `pn' specifies the page number. */
+static void tcfdbpagedirty(TCFDB *fdb, uint64_t pn){
+  assert(fdb);
+  if(!FDBLOCKCACHE(fdb)) return;
+  int vsiz;
+  FDBCPAGE *page = (FDBCPAGE *)tcmapget(fdb->pagec, &pn, sizeof(pn), &vsiz);
+  if(page) page->dirty = true;
+  FDBUNLOCKCACHE(fdb);
+}
+
+
+/* Read a page of the sparse layout without caching it.
+   `fdb' specifies the fixed-length database object.
+   `pn' specifies the page number.
+   `buf' specifies the buffer into which the page is expanded if it is not cached.
+   The return value is the pointer to the bitmap followed by the records of the page or `NULL' if
+   the page is not allocated.
+   This is used by scanning functions so that a full scan does not sweep the cache. */
+static const unsigned char *tcfdbpageread(TCFDB *fdb, uint64_t pn, unsigned char *buf){
+  assert(fdb && buf);
+  const unsigned char *pg = NULL;
+  if(FDBLOCKCACHE(fdb)){
+    int vsiz;
+    const FDBCPAGE *page = tcmapget(fdb->pagec, &pn, sizeof(pn), &vsiz);
+    if(page) pg = page->buf;
+    FDBUNLOCKCACHE(fdb);
+  }
+  if(pg) return pg;
+  uint64_t off = tcfdbsppage(fdb, pn);
+  if(off < 1 || !tcfdbpageexpand(fdb, off, buf)) return NULL;
+  return buf;
+}
+
+
+/* Write back a cached page of the sparse layout.
+   `fdb' specifies the fixed-length database object.
+   `pn' specifies the page number.
+   `page' specifies the cached page.
+   If successful, the return value is true, else, it is false.
+   The caller should hold the attribute lock and the cache lock.  The records are compressed
+   and stored raw if it does not shrink them.  The region is rewritten in place if it has enough
+   capacity, else a larger one is allocated at the end of the file and the old one is left until
+   the database is optimized. */
+static bool tcfdbpagesave(TCFDB *fdb, uint64_t pn, FDBCPAGE *page){
+  assert(fdb && page);
+  uint64_t eoff = tcfdbspentry(fdb, FDBHEADSIZ + (pn >> FDBSPL2BITS) * sizeof(uint64_t));
+  if(eoff < 1){
+    tcfdbsetecode(fdb, TCEMISC, __FILE__, __LINE__, __func__);
+    return false;
+  }
+  eoff += (pn & (FDBSPL2NUM - 1)) * sizeof(uint64_t);
+  int rsiz = FDBSPPGREC * fdb->rsiz;
+  int zsiz;
+  char *zbuf = tcpackencode((char *)page->buf + FDBSPBMSIZ, rsiz, &zsiz);
+  const char *zp = zbuf;
+  if(zsiz >= rsiz){
+    zp = (char *)page->buf + FDBSPBMSIZ;
+    zsiz = rsiz;
+  }
+  uint64_t off = tcfdbspentry(fdb, eoff);
+  uint32_t lnum;
+  int cap = 0;
+  if(off > 0){
+    memcpy(&lnum, fdb->map + off + FDBSPBMSIZ + sizeof(lnum), sizeof(lnum));
+    cap = TCITOHL(lnum);
+  }
+  bool err = false;
+  bool moved = false;
+  if(off < 1 || cap < zsiz){
+    cap = tclmin(tclmax(zsiz, cap * 2), rsiz);
+    off = tcfdbspextend(fdb, FDBCPHEADSIZ + cap, FDBCPALIGN);
+    if(off < 1) err = true;
+    moved = true;
+  } else if(fdb->tran && !tcfdbwalwrite(fdb, off, FDBCPHEADSIZ + zsiz)){
+    err = true;
+  }
+  if(!err){
+    unsigned char *wp = (unsigned char *)fdb->map + off;
+    memcpy(wp, page->buf, FDBSPBMSIZ);
+    wp += FDBSPBMSIZ;
+    lnum = TCHTOIL(zsiz);
+    memcpy(wp, &lnum, sizeof(lnum));
+    wp += sizeof(lnum);
+    lnum = TCHTOIL(cap);
+    memcpy(wp, &lnum, sizeof(lnum));
+    wp += sizeof(lnum);
+    memcpy(wp, zp, zsiz);
+    TCDODEBUG(fdb->cnt_writerec++);
+    if(moved && !tcfdbspsetentry(fdb, eoff, off)) err = true;
+  }
+  TCFREE(zbuf);
+  if(!err) page->dirty = false;
+  return !err;
+}
+
+
+/* Write back all updated pages in the page cache.
+   `fdb' specifies the fixed-length database object.
+   If successful, the return value is true, else, it is false. */
+static bool tcfdbcacheflush(TCFDB *fdb){
+  assert(fdb);
+  if(!FDBLOCKATTR(fdb)) return false;
+  if(!FDBLOCKCACHE(fdb)){
+    FDBUNLOCKATTR(fdb);
+    return false;
+  }
+  bool err = false;
+  tcmapiterinit(fdb->pagec);
+  const char *kbuf;
+  int ksiz;
+  while((kbuf = tcmapiternext(fdb->pagec, &ksiz)) != NULL){
+    int vsiz;
+    FDBCPAGE *page = (FDBCPAGE *)tcmapiterval(kbuf, &vsiz);
+    uint64_t pn;
+    memcpy(&pn, kbuf, sizeof(pn));
+    if(page->dirty && !tcfdbpagesave(fdb, pn, page)) err = true;
+  }
+  FDBUNLOCKCACHE(fdb);
+  FDBUNLOCKATTR(fdb);
+  return !err;
+}
+
+
+/* Adjust the page cache to the limit.
+   `fdb' specifies the fixed-length database object.
+   If successful, the return value is true, else, it is false.
+   The caller should hold the method lock as a writer.  The least recently used pages are purged
+   and written back if they are updated. */
+static bool tcfdbcacheadjust(TCFDB *fdb){
+  assert(fdb);
+  if(!fdb->pagec || TCMAPRNUM(fdb->pagec) <= fdb->pcnum) return true;
+  if(!FDBLOCKATTR(fdb)) return false;
+  if(!FDBLOCKCACHE(fdb)){
+    FDBUNLOCKATTR(fdb);
+    return false;
+  }
+  bool err = false;
+  int dnum = tclmax(TCMAPRNUM(fdb->pagec) - fdb->pcnum, FDBCACHEOUT);
+  tcmapiterinit(fdb->pagec);
+  const char *kbuf;
+  int ksiz;
+  for(int i = 0; i < dnum && (kbuf = tcmapiternext(fdb->pagec, &ksiz)) != NULL; i++){
+    int vsiz;
+    FDBCPAGE *page = (FDBCPAGE *)tcmapiterval(kbuf, &vsiz);
+    uint64_t pn;
+    memcpy(&pn, kbuf, sizeof(pn));
+    if(page->dirty && !tcfdbpagesave(fdb, pn, page)){
+      err = true;
+      break;
+    }
+    TCFREE(page->buf);
+    tcmapout(fdb->pagec, &pn, sizeof(pn));
+  }
+  FDBUNLOCKCACHE(fdb);
+  FDBUNLOCKATTR(fdb);
+  return !err;
+}
+
+
+/* Discard all pages in the page cache.
+   `fdb' specifies the fixed-length database object.
+   The updated pages are not written back. */
+static void tcfdbcacheclear(TCFDB *fdb){
+  assert(fdb);
+  tcmapiterinit(fdb->pagec);
+  const char *kbuf;
+  int ksiz;
+  while((kbuf = tcmapiternext(fdb->pagec, &ksiz)) != NULL){
+    int vsiz;
+    FDBCPAGE *page = (FDBCPAGE *)tcmapiterval(kbuf, &vsiz);
+    TCFREE(page->buf);
+  }
+  tcmapclear(fdb->pagec);
+}
+
+
+/* Advance the head of the ring buffer.
+   `fdb' specifies the fixed-length database object.
+   `id' specifies the ID number of the new head, which is more than the current head.
+   If successful, the return value is true, else, it is false.
+   The caller should hold the attribute lock.  The records falling out of the capacity are
+   expired and the slots from the current head to the new head are cleared. */
+static bool tcfdbringadvance(TCFDB *fdb, int64_t id){
+  assert(fdb && id > (int64_t)fdb->head);
+  if(id - (int64_t)fdb->capnum + 1 > (int64_t)fdb->tail)
+    tcfdbringexpire(fdb, id - fdb->capnum + 1);
+  for(int64_t cid = tclmax(fdb->head + 1, fdb->tail); cid <= id; cid++){
+    unsigned char *rec = FDBARYREC(fdb, cid);
+    int i = 0;
+    while(i <= fdb->wsiz && rec[i] == 0){
+      i++;
+    }
+    if(i > fdb->wsiz) continue;
+    if(!tcfdbrecmodify(fdb, cid, rec)) return false;
+    memset(rec, 0, fdb->wsiz + 1);
+    TCDODEBUG(fdb->cnt_writerec++);
+  }
+  fdb->head = id;
+  return true;
+}
+
+
+/* Advance the tail of the ring buffer.
+   `fdb' specifies the fixed-length database object.
+   `id' specifies the ID number of the new tail.
+   The caller should hold the attribute lock or the method lock as a writer.  The slots of the
+   expired records are only read to count them and reused as they are by later records. */
+static void tcfdbringexpire(TCFDB *fdb, int64_t id){
+  assert(fdb && id > 0);
+  if(id <= (int64_t)fdb->tail) return;
+  if(fdb->rnum > 0 && (int64_t)fdb->min < id){
+    int64_t eid = tclmin(id - 1, (int64_t)fdb->max);
+    for(int64_t cid = fdb->min; cid <= eid; cid++){
+      TCDODEBUG(fdb->cnt_readrec++);
+      const unsigned char *rec = FDBARYREC(fdb, cid);
+      for(int i = 0; i <= fdb->wsiz; i++){
+        if(rec[i] != 0){
+          fdb->rnum--;
+          break;
+        }
+      }
+    }
+    if(fdb->rnum < 1){
+      fdb->min = 0;
+      fdb->max = 0;
+    } else {
+      fdb->min = tcfdbnextid(fdb, id - 1);
+    }
+  }
+  fdb->tail = id;
+  tcfdbringsetmeta(fdb);
+}
+
+
+/* Publish the counters of the ring buffer into the header of the mapped region.
+   `fdb' specifies the fixed-length database object connected as a writer. */
+static void tcfdbringsetmeta(TCFDB *fdb){
+  assert(fdb);
+  uint64_t llnum;
+  llnum = TCHTOILL(fdb->rnum);
+  memcpy(fdb->map + FDBRNUMOFF, &llnum, sizeof(llnum));
+  llnum = TCHTOILL(fdb->min);
+  memcpy(fdb->map + FDBMINOFF, &llnum, sizeof(llnum));
+  llnum = TCHTOILL(fdb->max);
+  memcpy(fdb->map + FDBMAXOFF, &llnum, sizeof(llnum));
+  llnum = TCHTOILL(fdb->tail);
+  memcpy(fdb->map + FDBTAILOFF, &llnum, sizeof(llnum));
+  llnum = TCHTOILL(fdb->head);
+  memcpy(fdb->map + FDBHEADOFF, &llnum, sizeof(llnum));
+}
+
+
+/* Reload the counters of the ring buffer from the header of the mapped region.
+   `fdb' specifies the fixed-length database object. */
+static void tcfdbringloadmeta(TCFDB *fdb){
+  assert(fdb);
+  uint64_t llnum;
+  memcpy(&llnum, fdb->map + FDBHEADOFF, sizeof(llnum));
+  fdb->head = TCITOHLL(llnum);
+  memcpy(&llnum, fdb->map + FDBTAILOFF, sizeof(llnum));
+  fdb->tail = TCITOHLL(llnum);
+  memcpy(&llnum, fdb->map + FDBMAXOFF, sizeof(llnum));
+  fdb->max = TCITOHLL(llnum);
+  memcpy(&llnum, fdb->map + FDBMINOFF, sizeof(llnum));
+  fdb->min = TCITOHLL(llnum);
+  memcpy(&llnum, fdb->map + FDBRNUMOFF, sizeof(llnum));
+  fdb->rnum = TCITOHLL(llnum);
+}
+
+
+/* Get the aligned value region of a record for an atomic operation.
+   `fdb' specifies the fixed-length database object.
+   `id' specifies the ID number.
+   `vsiz' specifies the size of the value, which is also the required alignment.
+   The return value is the pointer to the value region or `NULL' if the record does not exist, if
+   the size of its value differs, or if the region is not aligned.  Because locked instructions
+   of x86 work on unaligned operands, only regions over a cache line are rejected there.
+   The caller should hold the lock of the record at least as a reader. */
+static unsigned char *tcfdbatomicptr(TCFDB *fdb, int64_t id, int vsiz){
+  assert(fdb && id > 0 && vsiz > 0);
+  unsigned char *rp = tcfdbrecptr(fdb, id);
+  if(!rp) return NULL;
+  uint32_t osiz;
+  uint16_t snum;
+  uint32_t lnum;
+  switch(fdb->wsiz){
+  case 1:
+    osiz = *(rp++);
+    break;
+  case 2:
+    memcpy(&snum, rp, sizeof(snum));
+    osiz = TCITOHS(snum);
+    rp += sizeof(snum);
+    break;
+  default:
+    memcpy(&lnum, rp, sizeof(lnum));
+    osiz = TCITOHL(lnum);
+    rp += sizeof(lnum);
+    break;
+  }
+  if(osiz != vsiz) return NULL;
+#if defined(__i386__) || defined(__x86_64__)
+  if((uintptr_t)rp / FDBCACHELINE != ((uintptr_t)rp + vsiz - 1) / FDBCACHELINE) return NULL;
+#else
+  if((uintptr_t)rp % vsiz != 0) return NULL;
+#endif
   return rp;
 }
 
 
+/* Add a number to the value of a record with an atomic instruction.
+   `fdb' specifies the fixed-length database object.
+   `id' specifies the ID number.
+   `vbuf' specifies the pointer to the additional number.  The summation is assigned to it.
+   `vsiz' specifies the size of the number.
+   `dbl' specifies whether the number is a real number.
+   The return value is 1 if the value is added, 0 if the record is not suitable for the atomic
+   operation, or -1 on failure.
+   The caller should hold the lock of the record as a reader.  Because modifiers of the size
+   header of a record hold the lock as a writer, only the value region is raced on here. */
+static int tcfdbaddatomic(TCFDB *fdb, int64_t id, void *vbuf, int vsiz, bool dbl){
+  assert(fdb && id > 0 && vbuf && vsiz > 0);
+#if TCUSEATOMIC
+  unsigned char *rp = tcfdbatomicptr(fdb, id, vsiz);
+  if(!rp) return 0;
+  TCDODEBUG(fdb->cnt_readrec++);
+  if(dbl){
+    if(sizeof(double) != sizeof(uint64_t)) return 0;
+    double num;
+    memcpy(&num, vbuf, sizeof(num));
+    if(num == 0.0){
+      memcpy(vbuf, rp, sizeof(num));
+      return 1;
+    }
+    if(!tcfdbrecmodify(fdb, id, rp - fdb->wsiz)) return -1;
+    uint64_t onum, nnum;
+    double sum;
+    do {
+      onum = *(volatile uint64_t *)rp;
+      memcpy(&sum, &onum, sizeof(sum));
+      sum += num;
+      memcpy(&nnum, &sum, sizeof(nnum));
+    } while(!__sync_bool_compare_and_swap((uint64_t *)rp, onum, nnum));
+    memcpy(vbuf, &sum, sizeof(sum));
+  } else {
+    int num = *(int *)vbuf;
+    if(num == 0){
+      memcpy(vbuf, rp, sizeof(num));
+      return 1;
+    }
+    if(!tcfdbrecmodify(fdb, id, rp - fdb->wsiz)) return -1;
+    *(int *)vbuf = __sync_add_and_fetch((int *)rp, num);
+  }
+  TCDODEBUG(fdb->cnt_writerec++);
+  return 1;
+#else
+  return 0;
+#endif
+}
+
+
+/* Replace the value of a record only if it has the expected value.
+   `fdb' specifies the fixed-length database object.
+   `id' specifies the ID number.
+   `obuf' specifies the pointer to the region of the expected value.  If it is `NULL', the record
+   is expected not to exist.
+   `osiz' specifies the size of the region of the expected value.
+   `nbuf' specifies the pointer to the region of the new value.  If it is `NULL', the record is
+   removed.
+   `nsiz' specifies the size of the region of the new value.
+   If successful, the return value is true, else, it is false. */
+static bool tcfdbcasimpl(TCFDB *fdb, int64_t id, const void *obuf, int osiz,
+                         const void *nbuf, int nsiz){
+  assert(fdb && id > 0 && (obuf || nbuf));
+  if(!obuf) return tcfdbputimpl(fdb, id, nbuf, nsiz, FDBPDKEEP);
+  int vsiz;
+  const char *vbuf = tcfdbgetimpl(fdb, id, &vsiz);
+  if(!vbuf) return false;
+  if(vsiz != osiz || memcmp(vbuf, obuf, osiz)){
+    tcfdbsetecode(fdb, TCEKEEP, __FILE__, __LINE__, __func__);
+    return false;
+  }
+  return nbuf ? tcfdbputimpl(fdb, id, nbuf, nsiz, FDBPDOVER) : tcfdboutimpl(fdb, id);
+}
+
+
+/* Scan records in a range and aggregate matching ones.
+   `fdb' specifies the fixed-length database object.
+   `ctx' specifies the scan context.
+   `res' specifies the pointer to the structure of the result.
+   If successful, the return value is true, else, it is false.
+   The range is divided into segments of pages and the workers take them by turns, so that
+   clustered records of a sparse database are also shared out. */
+static bool tcfdbscanimpl(TCFDB *fdb, FDBSCANCTX *ctx, FDBSCANRES *res){
+  assert(fdb && ctx && res);
+  res->num = 0;
+  res->sum = 0;
+  res->min = 0;
+  res->max = 0;
+  if(fdb->min < 1 || ctx->lower > ctx->upper) return true;
+  uint64_t snum = ((ctx->upper - 1) >> FDBSPPGBITS) / FDBSCSEGPG -
+    ((ctx->lower - 1) >> FDBSPPGBITS) / FDBSCSEGPG + 1;
+  if(ctx->tnum > snum) ctx->tnum = snum;
+  FDBSCANARG *args;
+  TCMALLOC(args, sizeof(*args) * ctx->tnum);
+  pthread_t *threads;
+  TCMALLOC(threads, sizeof(*threads) * ctx->tnum);
+  bool *runs;
+  TCMALLOC(runs, sizeof(*runs) * ctx->tnum);
+  for(int i = 0; i < ctx->tnum; i++){
+    args[i].ctx = ctx;
+    args[i].idx = i;
+    runs[i] = i > 0 && pthread_create(threads + i, NULL, tcfdbscanthread, args + i) == 0;
+  }
+  for(int i = 0; i < ctx->tnum; i++){
+    if(!runs[i]) tcfdbscanpart(args + i);
+  }
+  bool err = false;
+  for(int i = 0; i < ctx->tnum; i++){
+    if(runs[i]){
+      void *rv;
+      if(pthread_join(threads[i], &rv) != 0){
+        tcfdbsetecode(fdb, TCETHREAD, __FILE__, __LINE__, __func__);
+        err = true;
+      }
+    }
+    FDBSCANRES *part = &args[i].res;
+    if(part->num < 1) continue;
+    if(res->num < 1){
+      res->min = part->min;
+      res->max = part->max;
+    } else {
+      if(part->min < res->min) res->min = part->min;
+      if(part->max > res->max) res->max = part->max;
+    }
+    res->num += part->num;
+    res->sum += part->sum;
+  }
+  TCFREE(runs);
+  TCFREE(threads);
+  TCFREE(args);
+  return !err;
+}
+
+
+/* Scan records in a thread.
+   `targ' specifies the pointer to the argument structure of the worker.
+   The return value is always `NULL'. */
+static void *tcfdbscanthread(void *targ){
+  assert(targ);
+  tcfdbscanpart(targ);
+  return NULL;
+}
+
+
+/* Scan the segments assigned to a worker.
+   `arg' specifies the argument structure of the worker. */
+static void tcfdbscanpart(FDBSCANARG *arg){
+  assert(arg);
+  FDBSCANCTX *ctx = arg->ctx;
+  TCFDB *fdb = ctx->fdb;
+  FDBSCANRES *res = &arg->res;
+  res->num = 0;
+  res->sum = 0;
+  res->min = HUGE_VAL;
+  res->max = -HUGE_VAL;
+  char *sbuf;
+  TCMALLOC(sbuf, fdb->width + 1);
+  unsigned char *pbuf = NULL;
+  if(fdb->pagec) TCMALLOC(pbuf, FDBSPBMSIZ + FDBSPPGREC * fdb->rsiz);
+  bool sparse = fdb->opts & FDBTSPARSE;
+  uint64_t fpn = (ctx->lower - 1) >> FDBSPPGBITS;
+  uint64_t lpn = (ctx->upper - 1) >> FDBSPPGBITS;
+  for(uint64_t seg = fpn / FDBSCSEGPG + arg->idx; seg <= lpn / FDBSCSEGPG; seg += ctx->tnum){
+    uint64_t l2off = 0;
+    if(sparse){
+      l2off = tcfdbspentry(fdb, FDBHEADSIZ + ((seg * FDBSCSEGPG) >> FDBSPL2BITS) *
+                           sizeof(uint64_t));
+      if(l2off < 1) continue;
+    }
+    uint64_t pn = tclmax(seg * FDBSCSEGPG, fpn);
+    uint64_t epn = tclmin(seg * FDBSCSEGPG + FDBSCSEGPG - 1, lpn);
+    while(pn <= epn){
+      uint64_t first = tclmax(pn << FDBSPPGBITS, ctx->lower - 1);
+      uint64_t last = tclmin((pn << FDBSPPGBITS) + FDBSPPGREC - 1, ctx->upper - 1);
+      int bit = first & (FDBSPPGREC - 1);
+      if(sparse){
+        const unsigned char *bm = NULL;
+        if(pbuf){
+          bm = tcfdbpageread(fdb, pn, pbuf);
+        } else {
+          uint64_t pgoff = tcfdbspentry(fdb, l2off + (pn & (FDBSPL2NUM - 1)) * sizeof(uint64_t));
+          if(pgoff > 0) bm = (unsigned char *)fdb->map + pgoff;
+        }
+        if(bm) tcfdbscanblock(ctx, bm + FDBSPBMSIZ + bit * fdb->rsiz, bm, bit, last - first + 1,
+                              sbuf, res);
+      } else if(fdb->opts & FDBTRING){
+        uint64_t slot = first % fdb->capnum;
+        int num = last - first + 1;
+        int fnum = tclmin(num, fdb->capnum - slot);
+        tcfdbscanblock(ctx, fdb->array + slot * fdb->rsiz, NULL, bit, fnum, sbuf, res);
+        if(fnum < num) tcfdbscanblock(ctx, fdb->array, NULL, bit + fnum, num - fnum, sbuf, res);
+      } else {
+        tcfdbscanblock(ctx, fdb->array + first * fdb->rsiz, NULL, bit, last - first + 1,
+                       sbuf, res);
+      }
+      pn++;
+    }
+  }
+  TCFREE(pbuf);
+  TCFREE(sbuf);
+  if(res->num < 1){
+    res->min = 0;
+    res->max = 0;
+  }
+}
+
+
+/* Scan a block of consecutive records.
+   `ctx' specifies the scan context.
+   `rec' specifies the pointer to the first record.
+   `bm' specifies the presence bitmap of the page or `NULL' for the dense layout.
+   `bit' specifies the position of the first record in the page.
+   `num' specifies the number of the records, which is not more than the records of a page.
+   `sbuf' specifies the buffer for decimal strings, whose size is more than the width.
+   `res' specifies the pointer to the structure of the result to be accumulated.
+   The records are gathered into flat arrays first so that the conditions and the aggregation
+   run as straight loops over them, which the compiler can vectorize. */
+static void tcfdbscanblock(FDBSCANCTX *ctx, const unsigned char *rec, const unsigned char *bm,
+                           int bit, int num, char *sbuf, FDBSCANRES *res){
+  assert(ctx && rec && bit >= 0 && num > 0 && num <= FDBSPPGREC && sbuf && res);
+  TCFDB *fdb = ctx->fdb;
+  int wsiz = fdb->wsiz;
+  int rsiz = fdb->rsiz;
+  unsigned char hits[FDBSPPGREC];
+  double nums[FDBSPPGREC];
+  if(bm){
+    for(int i = 0; i < num; i++){
+      int pos = bit + i;
+      hits[i] = (bm[pos/8] >> (pos % 8)) & 1;
+    }
+  } else {
+    for(int i = 0; i < num; i++){
+      const unsigned char *rp = rec + i * rsiz;
+      hits[i] = rp[0] | rp[wsiz];
+      for(int j = 1; j < wsiz; j++){
+        hits[i] |= rp[j];
+      }
+      hits[i] = hits[i] != 0;
+    }
+  }
+  int vtype = ctx->vtype;
+  int op = ctx->op;
+  for(int i = 0; i < num; i++){
+    nums[i] = 0;
+    if(!hits[i]) continue;
+    const unsigned char *rp = rec + i * rsiz;
+    uint32_t vsiz;
+    uint16_t snum;
+    uint32_t lnum;
+    switch(wsiz){
+    case 1:
+      vsiz = *rp;
+      break;
+    case 2:
+      memcpy(&snum, rp, sizeof(snum));
+      vsiz = TCITOHS(snum);
+      break;
+    default:
+      memcpy(&lnum, rp, sizeof(lnum));
+      vsiz = TCITOHL(lnum);
+      break;
+    }
+    rp += wsiz;
+    if(op == FDBSCSTREQ){
+      if(vsiz != ctx->esiz || memcmp(rp, ctx->ebuf, vsiz)) hits[i] = 0;
+    } else if(op == FDBSCSTRBW){
+      if(vsiz < ctx->esiz || memcmp(rp, ctx->ebuf, ctx->esiz)) hits[i] = 0;
+    }
+    if(!hits[i]) continue;
+    int32_t inum;
+    int64_t llnum;
+    switch(vtype){
+    case FDBSVINT:
+      if(vsiz == sizeof(inum)){
+        memcpy(&inum, rp, sizeof(inum));
+        nums[i] = inum;
+      } else {
+        hits[i] = 0;
+      }
+      break;
+    case FDBSVLONG:
+      if(vsiz == sizeof(llnum)){
+        memcpy(&llnum, rp, sizeof(llnum));
+        nums[i] = llnum;
+      } else {
+        hits[i] = 0;
+      }
+      break;
+    case FDBSVDBL:
+      if(vsiz == sizeof(nums[i])){
+        memcpy(nums + i, rp, sizeof(nums[i]));
+      } else {
+        hits[i] = 0;
+      }
+      break;
+    default:
+      memcpy(sbuf, rp, vsiz);
+      sbuf[vsiz] = '\0';
+      nums[i] = tcatof(sbuf);
+      break;
+    }
+  }
+  if(op == FDBSCNUMEQ || op == FDBSCNUMBT){
+    double lower = ctx->lnum;
+    double upper = ctx->unum;
+    for(int i = 0; i < num; i++){
+      hits[i] &= (nums[i] >= lower) & (nums[i] <= upper);
+    }
+  }
+  uint64_t cnt = 0;
+  double sums[4] = { 0, 0, 0, 0 };
+  double mins[4] = { res->min, res->min, res->min, res->min };
+  double maxs[4] = { res->max, res->max, res->max, res->max };
+  int i = 0;
+  for(; i + 4 <= num; i += 4){
+    for(int j = 0; j < 4; j++){
+      bool hit = hits[i+j];
+      double val = nums[i+j];
+      cnt += hit;
+      sums[j] += hit ? val : 0;
+      mins[j] = (hit && val < mins[j]) ? val : mins[j];
+      maxs[j] = (hit && val > maxs[j]) ? val : maxs[j];
+    }
+  }
+  for(; i < num; i++){
+    bool hit = hits[i];
+    double val = nums[i];
+    cnt += hit;
+    sums[0] += hit ? val : 0;
+    mins[0] = (hit && val < mins[0]) ? val : mins[0];
+    maxs[0] = (hit && val > maxs[0]) ? val : maxs[0];
+  }
+  res->num += cnt;
+  res->sum += (sums[0] + sums[1]) + (sums[2] + sums[3]);
+  for(int j = 0; j < 4; j++){
+    if(mins[j] < res->min) res->min = mins[j];
+    if(maxs[j] > res->max) res->max = maxs[j];
+  }
+}
+
+
 /* Initialize the iterator of a fixed-length database object.
    `fdb' specifies the fixed-length database object.
    If successful, the return value is true, else, it is false. */
@@ -2360,16 +4111,13 @@ static uint64_t *tcfdbrangeimpl(TCFDB *fdb, int64_t lower, int64_t upper, int ma
   uint64_t *ids;
   TCMALLOC(ids, anum * sizeof(*ids));
   int num = 0;
-  for(int64_t i = lower; i <= upper && num < max; i++){
-    int vsiz;
-    const void *vbuf = tcfdbgetimpl(fdb, i, &vsiz);
-    if(vbuf){
-      if(num >= anum){
-        anum *= 2;
-        TCREALLOC(ids, ids, anum * sizeof(*ids));
-      }
-      ids[num++] = i;
+  for(int64_t i = tcfdbnextid(fdb, lower - 1); i > 0 && i <= upper && num < max;
+      i = tcfdbnextid(fdb, i)){
+    if(num >= anum){
+      anum *= 2;
+      TCREALLOC(ids, ids, anum * sizeof(*ids));
     }
+    ids[num++] = i;
   }
   *np = num;
   return ids;
@@ -2383,12 +4131,15 @@ static uint64_t *tcfdbrangeimpl(TCFDB *fdb, int64_t lower, int64_t upper, int ma
    If successful, the return value is true, else, it is false. */
 static bool tcfdboptimizeimpl(TCFDB *fdb, int32_t width, int64_t limsiz){
   assert(fdb);
+  if(fdb->omode & FDBOMEMORY) return tcfdboptimizememimpl(fdb, width, limsiz);
   char *tpath = tcsprintf("%s%ctmp%c%llu", fdb->path, MYEXTCHR, MYEXTCHR, fdb->inode);
   TCFDB *tfdb = tcfdbnew();
   tfdb->dbgfd = fdb->dbgfd;
   if(width < 1) width = fdb->width;
   if(limsiz < 1) limsiz = fdb->limsiz;
   tcfdbtune(tfdb, width, limsiz);
+  tcfdbsetopts(tfdb, fdb->opts);
+  tcfdbsetcache(tfdb, fdb->pcnum);
   if(!tcfdbopen(tfdb, tpath, FDBOWRITER | FDBOCREAT | FDBOTRUNC)){
     tcfdbsetecode(fdb, tfdb->ecode, __FILE__, __LINE__, __func__);
     tcfdbdel(tfdb);
@@ -2396,14 +4147,14 @@ static bool tcfdboptimizeimpl(TCFDB *fdb, int32_t width, int64_t limsiz){
     return false;
   }
   bool err = false;
-  int64_t max = fdb->max;
-  for(int i = fdb->min; !err && i <= max; i++){
+  for(int64_t i = fdb->min; !err && i > 0; i = tcfdbnextid(fdb, i)){
     int vsiz;
     const void *vbuf = tcfdbgetimpl(fdb, i, &vsiz);
     if(vbuf && !tcfdbput(tfdb, i, vbuf, vsiz)){
       tcfdbsetecode(fdb, tfdb->ecode, __FILE__, __LINE__, __func__);
       err = true;
     }
+    if(!tcfdbcacheadjust(fdb)) err = true;
   }
   if(!tcfdbclose(tfdb)){
     tcfdbsetecode(fdb, tfdb->ecode, __FILE__, __LINE__, __func__);
@@ -2432,6 +4183,63 @@ static bool tcfdboptimizeimpl(TCFDB *fdb, int32_t width, int64_t limsiz){
 }
 
 
+/* Optimize an on-memory fixed-length database object.
+   `fdb' specifies the fixed-length database object.
+   `width' specifies the width of the value of each record.
+   `limsiz' specifies the limit size of the database.
+   If successful, the return value is true, else, it is false.
+   The records are copied once into a new memory object, which then replaces the old one. */
+static bool tcfdboptimizememimpl(TCFDB *fdb, int32_t width, int64_t limsiz){
+  assert(fdb);
+  TCFDB *tfdb = tcfdbnew();
+  tfdb->dbgfd = fdb->dbgfd;
+  if(width < 1) width = fdb->width;
+  if(limsiz < 1) limsiz = fdb->limsiz;
+  tcfdbtune(tfdb, width, limsiz);
+  tcfdbsetopts(tfdb, fdb->opts);
+  tcfdbsetcache(tfdb, fdb->pcnum);
+  if(!tcfdbopen(tfdb, fdb->path, FDBOWRITER | FDBOMEMORY)){
+    tcfdbsetecode(fdb, tfdb->ecode, __FILE__, __LINE__, __func__);
+    tcfdbdel(tfdb);
+    return false;
+  }
+  bool err = false;
+  for(int64_t i = fdb->min; !err && i > 0; i = tcfdbnextid(fdb, i)){
+    int vsiz;
+    const void *vbuf = tcfdbgetimpl(fdb, i, &vsiz);
+    if(vbuf && !tcfdbputimpl(tfdb, i, vbuf, vsiz, FDBPDOVER)){
+      tcfdbsetecode(fdb, tfdb->ecode, __FILE__, __LINE__, __func__);
+      err = true;
+    }
+    if(!tcfdbcacheadjust(fdb)) err = true;
+    if(!tcfdbcacheadjust(tfdb)){
+      tcfdbsetecode(fdb, tfdb->ecode, __FILE__, __LINE__, __func__);
+      err = true;
+    }
+  }
+  int fd = err ? -1 : dup(tfdb->fd);
+  if(!err && fd < 0){
+    tcfdbsetecode(fdb, TCEOPEN, __FILE__, __LINE__, __func__);
+    err = true;
+  }
+  if(!tcfdbclose(tfdb)){
+    tcfdbsetecode(fdb, tfdb->ecode, __FILE__, __LINE__, __func__);
+    err = true;
+  }
+  tcfdbdel(tfdb);
+  if(err){
+    if(fd >= 0) close(fd);
+    return false;
+  }
+  char *path = tcstrdup(fdb->path);
+  int omode = fdb->omode & ~FDBOTRUNC;
+  if(!tcfdbcloseimpl(fdb)) err = true;
+  if(!tcfdbopenfd(fdb, path, omode, fd)) err = true;
+  TCFREE(path);
+  return !err;
+}
+
+
 /* Remove all records of a fixed-length database object.
    `fdb' specifies the fixed-length database object.
    If successful, the return value is true, else, it is false. */
@@ -2458,7 +4266,22 @@ static bool tcfdbcopyimpl(TCFDB *fdb, const char *path){
     if(!tcfdbmemsync(fdb, false)) err = true;
     tcfdbsetflag(fdb, FDBFOPEN, false);
   }
-  if(*path == '@'){
+  if(fdb->omode & FDBOMEMORY){
+    int fd = (*path == '@') ? -1 : open(path, O_WRONLY | O_CREAT | O_TRUNC, FDBFILEMODE);
+    if(fd >= 0){
+      if(!tcwrite(fd, fdb->map, fdb->fsiz)){
+        tcfdbsetecode(fdb, TCEWRITE, __FILE__, __LINE__, __func__);
+        err = true;
+      }
+      if(close(fd) == -1){
+        tcfdbsetecode(fdb, TCECLOSE, __FILE__, __LINE__, __func__);
+        err = true;
+      }
+    } else {
+      tcfdbsetecode(fdb, (*path == '@') ? TCEINVALID : TCEOPEN, __FILE__, __LINE__, __func__);
+      err = true;
+    }
+  } else if(*path == '@'){
     char tsbuf[TCNUMBUFSIZ];
     sprintf(tsbuf, "%llu", (unsigned long long)(tctime() * 1000000));
     const char *args[3];
@@ -2504,29 +4327,144 @@ static bool tcfdbiterjumpimpl(TCFDB *fdb, int64_t id){
 
 /* Process each record atomically of a fixed-length database object.
    `fdb' specifies the fixed-length database object.
+   `lower' specifies the lower limit ID number of records to be processed.
+   `upper' specifies the upper limit ID number of records to be processed.
    `iter' specifies the pointer to the iterator function called for each record.
    `op' specifies an arbitrary pointer to be given as a parameter of the iterator function.
+   `stop' specifies the pointer to the flag to stop iteration, which is set when the iterator
+   function returns false.
    If successful, the return value is true, else, it is false. */
-static bool tcfdbforeachimpl(TCFDB *fdb, TCITER iter, void *op){
+static bool tcfdbforeachimpl(TCFDB *fdb, uint64_t lower, uint64_t upper, TCITER iter, void *op,
+                             volatile bool *stop){
+  assert(fdb && iter && stop);
   bool err = false;
-  uint64_t id = fdb->min;
-  while(id > 0){
+  unsigned char *pbuf = NULL;
+  if(fdb->pagec) TCMALLOC(pbuf, FDBSPBMSIZ + FDBSPPGREC * fdb->rsiz);
+  uint64_t pn = UINT64_MAX;
+  const unsigned char *pg = NULL;
+  uint64_t id = (lower <= fdb->min) ? fdb->min : tcfdbnextid(fdb, lower - 1);
+  while(id > 0 && id <= upper && !*stop){
     int vsiz;
-    const void *vbuf = tcfdbgetimpl(fdb, id, &vsiz);
+    const void *vbuf;
+    if(pbuf){
+      if(((id - 1) >> FDBSPPGBITS) != pn){
+        pn = (id - 1) >> FDBSPPGBITS;
+        pg = tcfdbpageread(fdb, pn, pbuf);
+      }
+      vbuf = pg ? tcfdbrecval(fdb, pg + FDBSPBMSIZ + ((id - 1) & (FDBSPPGREC - 1)) * fdb->rsiz,
+                              &vsiz) : NULL;
+    } else {
+      vbuf = tcfdbgetimpl(fdb, id, &vsiz);
+    }
     if(vbuf){
       char kbuf[TCNUMBUFSIZ];
       int ksiz = sprintf(kbuf, "%llu", (unsigned long long)id);
-      if(!iter(kbuf, ksiz, vbuf, vsiz, op)) break;
+      if(!iter(kbuf, ksiz, vbuf, vsiz, op)){
+        *stop = true;
+        break;
+      }
     } else {
       tcfdbsetecode(fdb, TCEMISC, __FILE__, __LINE__, __func__);
       err = true;
     }
     id = tcfdbnextid(fdb, id);
   }
+  TCFREE(pbuf);
+  return !err;
+}
+
+
+/* Process each record of a fixed-length database object by partitions in parallel.
+   `fdb' specifies the fixed-length database object.
+   `iter' specifies the pointer to the iterator function called for each record.
+   `ops' specifies the array of the opaque pointers of the workers.
+   `tnum' specifies the number of the workers.
+   `reduce' specifies the pointer to the reduce function or `NULL'.
+   `rop' specifies the opaque pointer given to the reduce function.
+   If successful, the return value is true, else, it is false.
+   The range of ID numbers is divided into ranges of the same width, whose boundaries are
+   aligned to pages of a sparse database so that no page is read by two workers. */
+static bool tcfdbforeachparimpl(TCFDB *fdb, TCITER iter, void **ops, int tnum,
+                                TCREDUCE reduce, void *rop){
+  assert(fdb && iter && ops);
+  if(tnum < 1) tnum = 1;
+  uint64_t span = (fdb->min > 0) ? fdb->max - fdb->min + 1 : 0;
+  volatile bool stop = false;
+  FDBFEARG *args;
+  TCMALLOC(args, sizeof(*args) * tnum);
+  pthread_t *threads;
+  TCMALLOC(threads, sizeof(*threads) * tnum);
+  bool *runs;
+  TCMALLOC(runs, sizeof(*runs) * tnum);
+  uint64_t lower = fdb->min;
+  for(int i = 0; i < tnum; i++){
+    FDBFEARG *arg = args + i;
+    uint64_t next = fdb->min + span * (i + 1) / tnum;
+    if((fdb->opts & FDBTSPARSE) && i < tnum - 1 && next > 0)
+      next = tclmax(next - ((next - 1) & (FDBSPPGREC - 1)), lower);
+    arg->fdb = fdb;
+    arg->lower = lower;
+    arg->upper = (next > lower) ? next - 1 : 0;
+    arg->iter = iter;
+    arg->op = ops[i];
+    arg->stop = &stop;
+    arg->ecode = TCESUCCESS;
+    lower = next;
+    runs[i] = i > 0 && span > 0 &&
+      pthread_create(threads + i, NULL, tcfdbforeachthread, arg) == 0;
+  }
+  for(int i = 0; i < tnum; i++){
+    if(!runs[i] && span > 0) tcfdbforeachpart(args + i);
+  }
+  bool err = false;
+  for(int i = 0; i < tnum; i++){
+    if(runs[i]){
+      void *rv;
+      if(pthread_join(threads[i], &rv) != 0){
+        tcfdbsetecode(fdb, TCETHREAD, __FILE__, __LINE__, __func__);
+        err = true;
+      }
+    }
+    if(args[i].ecode != TCESUCCESS){
+      tcfdbsetecode(fdb, args[i].ecode, __FILE__, __LINE__, __func__);
+      err = true;
+    }
+  }
+  if(reduce){
+    for(int i = 0; i < tnum; i++){
+      reduce(ops[i], rop);
+    }
+  }
+  TCFREE(runs);
+  TCFREE(threads);
+  TCFREE(args);
   return !err;
 }
 
 
+/* Process a partition of parallel iteration in a thread.
+   `targ' specifies the pointer to the argument structure of the worker.
+   The return value is always `NULL'. */
+static void *tcfdbforeachthread(void *targ){
+  assert(targ);
+  tcfdbforeachpart(targ);
+  return NULL;
+}
+
+
+/* Process the records of a partition of parallel iteration.
+   `arg' specifies the argument structure of the worker. */
+static void tcfdbforeachpart(FDBFEARG *arg){
+  assert(arg);
+  TCFDB *fdb = arg->fdb;
+  if(arg->upper < arg->lower) return;
+  if(!tcfdbforeachimpl(fdb, arg->lower, arg->upper, arg->iter, arg->op, arg->stop)){
+    int ecode = tcfdbecode(fdb);
+    arg->ecode = (ecode != TCESUCCESS) ? ecode : TCEMISC;
+  }
+}
+
+
 /* Lock a method of the fixed-length database object.
    `fdb' specifies the fixed-length database object.
    `wr' specifies whether the lock is writer or not.
@@ -2590,6 +4528,7 @@ static bool tcfdbunlockattr(TCFDB *fdb){
    If successful, the return value is true, else, it is false. */
 static bool tcfdblockrecord(TCFDB *fdb, bool wr, uint64_t id){
   assert(fdb && id > 0);
+  if(fdb->opts & FDBTRING) id = (id - 1) % fdb->capnum;
   if(wr ? pthread_rwlock_wrlock((pthread_rwlock_t *)fdb->rmtxs + id % FDBRMTXNUM) != 0 :
      pthread_rwlock_rdlock((pthread_rwlock_t *)fdb->rmtxs + id % FDBRMTXNUM) != 0){
     tcfdbsetecode(fdb, TCETHREAD, __FILE__, __LINE__, __func__);
@@ -2605,6 +4544,7 @@ static bool tcfdblockrecord(TCFDB *fdb, bool wr, uint64_t id){
    If successful, the return value is true, else, it is false. */
 static bool tcfdbunlockrecord(TCFDB *fdb, uint64_t id){
   assert(fdb);
+  if(fdb->opts & FDBTRING) id = (id - 1) % fdb->capnum;
   if(pthread_rwlock_unlock((pthread_rwlock_t *)fdb->rmtxs + id % FDBRMTXNUM) != 0){
     tcfdbsetecode(fdb, TCETHREAD, __FILE__, __LINE__, __func__);
     return false;
@@ -2681,6 +4621,34 @@ static bool tcfdbunlockwal(TCFDB *fdb){
 }
 
 
+/* Lock the page cache of the fixed-length database object.
+   `fdb' specifies the fixed-length database object.
+   If successful, the return value is true, else, it is false. */
+static bool tcfdblockcache(TCFDB *fdb){
+  assert(fdb);
+  if(pthread_mutex_lock(fdb->cmtx) != 0){
+    tcfdbsetecode(fdb, TCETHREAD, __FILE__, __LINE__, __func__);
+    return false;
+  }
+  TCTESTYIELD();
+  return true;
+}
+
+
+/* Unlock the page cache of the fixed-length database object.
+   `fdb' specifies the fixed-length database object.
+   If successful, the return value is true, else, it is false. */
+static bool tcfdbunlockcache(TCFDB *fdb){
+  assert(fdb);
+  if(pthread_mutex_unlock(fdb->cmtx) != 0){
+    tcfdbsetecode(fdb, TCETHREAD, __FILE__, __LINE__, __func__);
+    return false;
+  }
+  TCTESTYIELD();
+  return true;
+}
+
+
 
 /*************************************************************************************************
  * debugging functions
@@ -2701,10 +4669,12 @@ void tcfdbprintmeta(TCFDB *fdb){
   wp += sprintf(wp, " rmtxs=%p", (void *)fdb->rmtxs);
   wp += sprintf(wp, " tmtx=%p", (void *)fdb->tmtx);
   wp += sprintf(wp, " wmtx=%p", (void *)fdb->wmtx);
+  wp += sprintf(wp, " cmtx=%p", (void *)fdb->cmtx);
   wp += sprintf(wp, " eckey=%p", (void *)fdb->eckey);
   wp += sprintf(wp, " rpath=%s", fdb->rpath ? fdb->rpath : "-");
   wp += sprintf(wp, " type=%02X", fdb->type);
   wp += sprintf(wp, " flags=%02X", fdb->flags);
+  wp += sprintf(wp, " opts=%02X", fdb->opts);
   wp += sprintf(wp, " width=%u", fdb->width);
   wp += sprintf(wp, " limsiz=%llu", (unsigned long long)fdb->limsiz);
   wp += sprintf(wp, " wsiz=%u", fdb->wsiz);
@@ -2717,6 +4687,11 @@ void tcfdbprintmeta(TCFDB *fdb){
   wp += sprintf(wp, " fsiz=%llu", (unsigned long long)fdb->fsiz);
   wp += sprintf(wp, " min=%llu", (unsigned long long)fdb->min);
   wp += sprintf(wp, " max=%llu", (unsigned long long)fdb->max);
+  wp += sprintf(wp, " head=%llu", (unsigned long long)fdb->head);
+  wp += sprintf(wp, " tail=%llu", (unsigned long long)fdb->tail);
+  wp += sprintf(wp, " capnum=%llu", (unsigned long long)fdb->capnum);
+  wp += sprintf(wp, " pagec=%p", (void *)fdb->pagec);
+  wp += sprintf(wp, " pcnum=%d", fdb->pcnum);
   wp += sprintf(wp, " iter=%llu", (unsigned long long)fdb->iter);
   wp += sprintf(wp, " map=%p", (void *)fdb->map);
   wp += sprintf(wp, " array=%p", (void *)fdb->array);
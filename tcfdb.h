@@ -48,10 +48,12 @@ typedef struct {                         /* type of structure for a fixed-length
   void *rmtxs;                           /* mutexes for records */
   void *tmtx;                            /* mutex for transaction */
   void *wmtx;                            /* mutex for write ahead logging */
+  void *cmtx;                            /* mutex for the page cache */
   void *eckey;                           /* key for thread specific error code */
   char *rpath;                           /* real path for locking */
   uint8_t type;                          /* database type */
   uint8_t flags;                         /* additional flags */
+  uint8_t opts;                          /* options */
   uint32_t width;                        /* width of the value of each record */
   uint64_t limsiz;                       /* limit size of the file */
   int wsiz;                              /* size of the width region */
@@ -64,6 +66,11 @@ typedef struct {                         /* type of structure for a fixed-length
   uint64_t fsiz;                         /* size of the database file */
   uint64_t min;                          /* minimum ID number */
   uint64_t max;                          /* maximum ID number */
+  uint64_t head;                         /* ID number of the head of the ring buffer */
+  uint64_t tail;                         /* ID number of the tail of the ring buffer */
+  uint64_t capnum;                       /* number of the slots of the ring buffer */
+  TCMAP *pagec;                          /* cache for compressed pages */
+  int32_t pcnum;                         /* maximum number of cached pages */
   uint64_t iter;                         /* ID number of the iterator */
   char *map;                             /* pointer to the mapped memory */
   unsigned char *array;                  /* pointer to the array region */
@@ -85,6 +92,12 @@ enum {                                   /* enumeration for additional flags */
   FDBFFATAL = 1 << 1                     /* whetehr with fatal error */
 };
 
+enum {                                   /* enumeration for tuning options */
+  FDBTSPARSE = 1 << 0,                   /* store records in pages allocated on demand */
+  FDBTRING = 1 << 1,                     /* reuse the slots as a ring buffer */
+  FDBTPACK = 1 << 2                      /* compress the pages of the sparse layout */
+};
+
 enum {                                   /* enumeration for open modes */
   FDBOREADER = 1 << 0,                   /* open as a reader */
   FDBOWRITER = 1 << 1,                   /* open as a writer */
@@ -92,7 +105,8 @@ enum {                                   /* enumeration for open modes */
   FDBOTRUNC = 1 << 3,                    /* writer truncating */
   FDBONOLCK = 1 << 4,                    /* open without locking */
   FDBOLCKNB = 1 << 5,                    /* lock without blocking */
-  FDBOTSYNC = 1 << 6                     /* synchronize every transaction */
+  FDBOTSYNC = 1 << 6,                    /* synchronize every transaction */
+  FDBOMEMORY = 1 << 7                    /* keep the database on memory */
 };
 
 enum {                                   /* enumeration for ID constants */
@@ -102,6 +116,28 @@ enum {                                   /* enumeration for ID constants */
   FDBIDNEXT = -4                         /* greater by one than the miximum */
 };
 
+enum {                                   /* enumeration for scan conditions */
+  FDBSCALL,                              /* every record */
+  FDBSCSTREQ,                            /* value is equal to */
+  FDBSCSTRBW,                            /* value begins with */
+  FDBSCNUMEQ,                            /* number is equal to */
+  FDBSCNUMBT                             /* number is between two bounds */
+};
+
+enum {                                   /* enumeration for value types of scans */
+  FDBSVSTR,                              /* decimal string */
+  FDBSVINT,                              /* 32-bit integer in the native byte order */
+  FDBSVLONG,                             /* 64-bit integer in the native byte order */
+  FDBSVDBL                               /* real number in the native format */
+};
+
+typedef struct {                         /* type of structure for the result of a scan */
+  uint64_t num;                          /* number of matching records */
+  double sum;                            /* summation of the numbers */
+  double min;                            /* minimum of the numbers */
+  double max;                            /* maximum of the numbers */
+} FDBSCANRES;
+
 
 /* Get the message string corresponding to an error code.
    `ecode' specifies the error code.
@@ -155,6 +191,35 @@ bool tcfdbsetmutex(TCFDB *fdb);
 bool tcfdbtune(TCFDB *fdb, int32_t width, int64_t limsiz);
 
 
+/* Set the tuning options of a fixed-length database object.
+   `fdb' specifies the fixed-length database object which is not opened.
+   `opts' specifies options by bitwise-or: `FDBTSPARSE' specifies that records are stored in
+   pages allocated on the first write and located through a two-level directory, so that the
+   size of the file depends on the number of populated pages rather than on the maximum ID
+   number, and iteration skips empty pages.  The ID number can be up to 2^40 then.  `FDBTRING'
+   specifies that the slots within the limit size are reused as a ring buffer, so that the ID
+   number increases without limit and storing a record beyond the head expires the records which
+   fall out of the capacity.  `FDBTSPARSE' and `FDBTRING' are exclusive.  `FDBTPACK' specifies
+   that each page of the sparse layout is compressed by run-length encoding in the file and
+   expanded into the page cache on access, which suits values padded with zero.  `FDBTPACK'
+   implies `FDBTSPARSE'.
+   If successful, the return value is true, else, it is false.
+   Note that the options should be set before the database is opened.  The options of an
+   existing database are read from the file. */
+bool tcfdbsetopts(TCFDB *fdb, uint8_t opts);
+
+
+/* Set the caching parameters of a fixed-length database object.
+   `fdb' specifies the fixed-length database object which is not opened.
+   `pcnum' specifies the maximum number of pages to be cached.  If it is not more than 0, the
+   default value is specified.  The default value is 128.
+   If successful, the return value is true, else, it is false.
+   Note that the caching parameters should be set before the database is opened.  The page cache
+   is used only if the option `FDBTPACK' is specified.  Updated pages are written back when they
+   are purged from the cache, when the database is synchronized, and when it is closed. */
+bool tcfdbsetcache(TCFDB *fdb, int32_t pcnum);
+
+
 /* Open a database file and connect a fixed-length database object.
    `fdb' specifies the fixed-length database object which is not opened.
    `path' specifies the path of the database file.
@@ -164,8 +229,13 @@ bool tcfdbtune(TCFDB *fdb, int32_t width, int64_t limsiz);
    database regardless if one exists, `FDBOTSYNC', which means every transaction synchronizes
    updated contents with the device.  Both of `FDBOREADER' and `FDBOWRITER' can be added to by
    bitwise-or: `FDBONOLCK', which means it opens the database file without file locking, or
-   `FDBOLCKNB', which means locking is performed without blocking.
-   If successful, the return value is true, else, it is false. */
+   `FDBOLCKNB', which means locking is performed without blocking.  `FDBOMEMORY' can be added to
+   `FDBOWRITER' by bitwise-or, which means a new database is created on anonymous shared memory
+   growing in units of huge pages and `path' is used only as the name of the database.
+   If successful, the return value is true, else, it is false.
+   An on-memory database is discarded when it is closed.  Use `tcfdbcopy' to save it into a
+   file.  Memory for an on-memory database is reserved each time it grows, and a store fails if
+   the memory can not be reserved. */
 bool tcfdbopen(TCFDB *fdb, const char *path, int omode);
 
 
@@ -581,6 +651,71 @@ int tcfdbaddint(TCFDB *fdb, int64_t id, int num);
 double tcfdbadddouble(TCFDB *fdb, int64_t id, double num);
 
 
+/* Replace the value of a record in a fixed-length database object only if it has the expected
+   value.
+   `fdb' specifies the fixed-length database object connected as a writer.
+   `id' specifies the ID number.  It should be more than 0.  If it is `FDBIDMIN', the minimum ID
+   number of existing records is specified.  If it is `FDBIDPREV', the number less by one than
+   the minimum ID number of existing records is specified.  If it is `FDBIDMAX', the maximum ID
+   number of existing records is specified.  If it is `FDBIDNEXT', the number greater by one than
+   the maximum ID number of existing records is specified.
+   `obuf' specifies the pointer to the region of the expected value.  If it is `NULL', the record
+   is expected not to exist.
+   `osiz' specifies the size of the region of the expected value.  If the size is greater than
+   the width tuning parameter of the database, the size is cut down to the width.
+   `nbuf' specifies the pointer to the region of the new value.  If it is `NULL', the record is
+   removed.
+   `nsiz' specifies the size of the region of the new value.  If the size is greater than the
+   width tuning parameter of the database, the size is cut down to the width.
+   If successful, the return value is true, else, it is false.  If the current value differs from
+   the expected one, this function has no effect and the error code is `TCEKEEP'.  If a value is
+   expected but no record corresponds, the error code is `TCENOREC'.
+   If the database is shared by threads and both values are of 4 or 8 bytes, the comparison and
+   the replacement are performed by an atomic instruction without excluding readers of the
+   record.  `tcfdbaddint' and `tcfdbadddouble' also work that way on existing records. */
+bool tcfdbcas(TCFDB *fdb, int64_t id, const void *obuf, int osiz, const void *nbuf, int nsiz);
+
+
+/* Scan records in a range of a fixed-length database object and aggregate matching ones.
+   `fdb' specifies the fixed-length database object.
+   `lower' specifies the lower limit of the range.  If it is `FDBIDMIN', the minimum ID is
+   specified.
+   `upper' specifies the upper limit of the range.  If it is `FDBIDMAX', the maximum ID is
+   specified.
+   `vtype' specifies the type of the values: `FDBSVSTR' for decimal strings, `FDBSVINT' for 32-bit
+   integers as stored by `tcfdbaddint', `FDBSVLONG' for 64-bit integers, `FDBSVDBL' for real
+   numbers as stored by `tcfdbadddouble'.  Records whose size differs from the size of a binary
+   type are ignored.
+   `op' specifies the condition: `FDBSCALL' for every record, `FDBSCSTREQ' for values equal to
+   the operand, `FDBSCSTRBW' for values beginning with the operand, `FDBSCNUMEQ' for numbers equal
+   to the operand, `FDBSCNUMBT' for numbers between two bounds in the operand.
+   `ebuf' specifies the pointer to the region of the operand.  Numeric operands are decimal
+   strings and the two bounds of `FDBSCNUMBT' are separated by a space or a comma.  It can be
+   `NULL' for `FDBSCALL'.
+   `esiz' specifies the size of the region of the operand.
+   `tnum' specifies the number of threads to scan disjoint parts of the range.  If it is not more
+   than 1, the calling thread scans the whole range.
+   `res' specifies the pointer to the structure into which the number of matching records and
+   the summation, the minimum, and the maximum of their numbers are stored.  The minimum and the
+   maximum are 0 if no record matches.
+   If successful, the return value is true, else, it is false.
+   Records are read in blocks straight from the mapped region and unallocated pages of the sparse
+   layout are skipped as a whole. */
+bool tcfdbscan(TCFDB *fdb, int64_t lower, int64_t upper, int vtype, int op,
+               const void *ebuf, int esiz, int tnum, FDBSCANRES *res);
+
+
+/* Remove records less than an ID number of a fixed-length database object.
+   `fdb' specifies the fixed-length database object connected as a writer.
+   `id' specifies the ID number of the new tail.  Records whose ID numbers are less than it are
+   removed.  If it is `FDBIDMAX', all records are removed.
+   If successful, the return value is true, else, it is false.
+   If the database is a ring buffer, the tail is just advanced and the regions of the expired
+   records are reused later as they are, so that no record is written but the header.  Otherwise,
+   the records are removed one by one. */
+bool tcfdbexpire(TCFDB *fdb, int64_t id);
+
+
 /* Synchronize updated contents of a fixed-length database object with the file and the device.
    `fdb' specifies the fixed-length database object connected as a writer.
    If successful, the return value is true, else, it is false.
@@ -717,6 +852,27 @@ uint64_t tcfdbmin(TCFDB *fdb);
 uint64_t tcfdbmax(TCFDB *fdb);
 
 
+/* Get the head ID number of a fixed-length database object.
+   `fdb' specifies the fixed-length database object.
+   The return value is the ID number of the last record stored at the head of the ring buffer,
+   or the maximum ID number of records if the database is not a ring buffer.  0 is returned if
+   the object does not connect to any database file.
+   If the object is connected as a reader of a ring buffer, the head and the tail are reloaded
+   from the header, which the writer keeps up to date, so that a reader in another process can
+   follow the records appended.  A record at the tail can be overwritten while it is
+   being read, so that the tail should be checked again after reading it. */
+uint64_t tcfdbhead(TCFDB *fdb);
+
+
+/* Get the tail ID number of a fixed-length database object.
+   `fdb' specifies the fixed-length database object.
+   The return value is the least ID number which is not expired in the ring buffer, or the
+   minimum ID number of records if the database is not a ring buffer.  0 is returned if the
+   object does not connect to any database file.
+   The tail is reloaded as with the function `tcfdbhead'. */
+uint64_t tcfdbtail(TCFDB *fdb);
+
+
 /* Get the width of the value of each record of a fixed-length database object.
    `fdb' specifies the fixed-length database object.
    The return value is the width of the value of each record or 0 if the object does not connect
@@ -770,6 +926,12 @@ uint8_t tcfdbtype(TCFDB *fdb);
 uint8_t tcfdbflags(TCFDB *fdb);
 
 
+/* Get the options of a fixed-length database object.
+   `fdb' specifies the fixed-length database object.
+   The return value is the options. */
+uint8_t tcfdbopts(TCFDB *fdb);
+
+
 /* Get the pointer to the opaque field of a fixed-length database object.
    `fdb' specifies the fixed-length database object.
    The return value is the pointer to the opaque field whose size is 128 bytes. */
@@ -849,6 +1011,29 @@ bool tcfdbiterinit4(TCFDB *fdb, const char *kstr);
 bool tcfdbforeach(TCFDB *fdb, TCITER iter, void *op);
 
 
+/* Process each record of a fixed-length database object by partitions in parallel.
+   `fdb' specifies the fixed-length database object.
+   `iter' specifies the pointer to the iterator function called for each record.  It receives
+   the same parameters as with `tcfdbforeach'.
+   `ops' specifies the array of arbitrary pointers.  Each worker gives its own element as the
+   fifth parameter of the iterator function.
+   `tnum' specifies the number of workers.  The array `ops' should have as many elements.
+   `reduce' specifies the pointer to the reduce function called for each worker after all
+   workers finish.  It receives the element of `ops' of the worker and `rop'.  If it is `NULL',
+   no reduce function is called.
+   `rop' specifies an arbitrary pointer to be given as a parameter of the reduce function.  If
+   it is not needed, `NULL' can be specified.
+   If successful, the return value is true, else, it is false.
+   The range of ID numbers is divided into ranges of the same width, and each range is
+   processed by a worker thread in ascending order.  When the iterator function returns false,
+   all workers stop.  The reduce function is called serially in ascending order of the ranges.
+   Because the iterator function is called by workers concurrently, it should not modify any
+   object shared among workers without synchronization.  Note that the callback function can
+   not perform any database operation because the function is called in the critical section
+   guarded by the same locks of database operations. */
+bool tcfdbforeachpar(TCFDB *fdb, TCITER iter, void **ops, int tnum, TCREDUCE reduce, void *rop);
+
+
 /* Generate the ID number from arbitrary binary data.
    `kbuf' specifies the pointer to the region of the key.
    `ksiz' specifies the size of the region of the key.
@@ -36,17 +36,20 @@ static int runput(int argc, char **argv);
 static int runout(int argc, char **argv);
 static int runget(int argc, char **argv);
 static int runlist(int argc, char **argv);
+static int runscan(int argc, char **argv);
 static int runoptimize(int argc, char **argv);
 static int runimporttsv(int argc, char **argv);
 static int runversion(int argc, char **argv);
-static int proccreate(const char *path, int width, int64_t limsiz);
+static int proccreate(const char *path, int width, int64_t limsiz, int opts);
 static int procinform(const char *path, int omode);
 static int procput(const char *path, const char *kbuf, int ksiz, const char *vbuf, int vsiz,
                    int omode, int dmode);
-static int procout(const char *path, const char *kbuf, int ksiz, int omode);
+static int procout(const char *path, const char *kbuf, int ksiz, int omode, bool ex);
 static int procget(const char *path, const char *kbuf, int ksiz, int omode, bool px, bool pz);
 static int proclist(const char *path, int omode, int max, bool pv, bool px,
                     const char *rlstr, const char *rustr, const char *ristr);
+static int procscan(const char *path, int omode, int vtype, int tnum,
+                    const char *rlstr, const char *rustr, const char *opstr, const char *expr);
 static int procoptimize(const char *path, int width, int64_t limsiz, int omode);
 static int procimporttsv(const char *path, const char *file, int omode, bool sc);
 static int procversion(void);
@@ -72,6 +75,8 @@ int main(int argc, char **argv){
     rv = runget(argc, argv);
   } else if(!strcmp(argv[1], "list")){
     rv = runlist(argc, argv);
+  } else if(!strcmp(argv[1], "scan")){
+    rv = runscan(argc, argv);
   } else if(!strcmp(argv[1], "optimize")){
     rv = runoptimize(argc, argv);
   } else if(!strcmp(argv[1], "importtsv")){
@@ -90,13 +95,15 @@ static void usage(void){
   fprintf(stderr, "%s: the command line utility of the fixed-length database API\n", g_progname);
   fprintf(stderr, "\n");
   fprintf(stderr, "usage:\n");
-  fprintf(stderr, "  %s create path [width [limsiz]]\n", g_progname);
+  fprintf(stderr, "  %s create [-ts|-tr|-tp] path [width [limsiz]]\n", g_progname);
   fprintf(stderr, "  %s inform [-nl|-nb] path\n", g_progname);
   fprintf(stderr, "  %s put [-nl|-nb] [-sx] [-dk|-dc|-dai|-dad] path key value\n", g_progname);
-  fprintf(stderr, "  %s out [-nl|-nb] [-sx] path key\n", g_progname);
+  fprintf(stderr, "  %s out [-nl|-nb] [-sx] [-ex] path key\n", g_progname);
   fprintf(stderr, "  %s get [-nl|-nb] [-sx] [-px] [-pz] path key\n", g_progname);
   fprintf(stderr, "  %s list [-nl|-nb] [-m num] [-pv] [-px] [-rb lkey ukey] [-ri str] path\n",
           g_progname);
+  fprintf(stderr, "  %s scan [-nl|-nb] [-vi|-vl|-vd] [-tn num] [-rb lkey ukey] path [op [expr]]\n",
+          g_progname);
   fprintf(stderr, "  %s optimize [-nl|-nb] path [width [limsiz]]\n", g_progname);
   fprintf(stderr, "  %s importtsv [-nl|-nb] [-sc] path [file]\n", g_progname);
   fprintf(stderr, "  %s version\n", g_progname);
@@ -162,9 +169,18 @@ static int runcreate(int argc, char **argv){
   char *path = NULL;
   char *wstr = NULL;
   char *lstr = NULL;
+  int opts = 0;
   for(int i = 2; i < argc; i++){
     if(!path && argv[i][0] == '-'){
-      usage();
+      if(!strcmp(argv[i], "-ts")){
+        opts |= FDBTSPARSE;
+      } else if(!strcmp(argv[i], "-tr")){
+        opts |= FDBTRING;
+      } else if(!strcmp(argv[i], "-tp")){
+        opts |= FDBTSPARSE | FDBTPACK;
+      } else {
+        usage();
+      }
     } else if(!path){
       path = argv[i];
     } else if(!wstr){
@@ -178,7 +194,7 @@ static int runcreate(int argc, char **argv){
   if(!path) usage();
   int width = wstr ? tcatoix(wstr) : -1;
   int64_t limsiz = lstr ? tcatoix(lstr) : -1;
-  int rv = proccreate(path, width, limsiz);
+  int rv = proccreate(path, width, limsiz, opts);
   return rv;
 }
 
@@ -270,6 +286,7 @@ static int runout(int argc, char **argv){
   char *key = NULL;
   int omode = 0;
   bool sx = false;
+  bool ex = false;
   for(int i = 2; i < argc; i++){
     if(!path && argv[i][0] == '-'){
       if(!strcmp(argv[i], "-nl")){
@@ -278,6 +295,8 @@ static int runout(int argc, char **argv){
         omode |= FDBOLCKNB;
       } else if(!strcmp(argv[i], "-sx")){
         sx = true;
+      } else if(!strcmp(argv[i], "-ex")){
+        ex = true;
       } else {
         usage();
       }
@@ -298,7 +317,7 @@ static int runout(int argc, char **argv){
     ksiz = strlen(key);
     kbuf = tcmemdup(key, ksiz);
   }
-  int rv = procout(path, kbuf, ksiz, omode);
+  int rv = procout(path, kbuf, ksiz, omode, ex);
   tcfree(kbuf);
   return rv;
 }
@@ -396,6 +415,55 @@ static int runlist(int argc, char **argv){
 }
 
 
+/* parse arguments of scan command */
+static int runscan(int argc, char **argv){
+  char *path = NULL;
+  char *opstr = NULL;
+  char *expr = NULL;
+  int omode = 0;
+  int vtype = FDBSVSTR;
+  int tnum = 1;
+  char *rlstr = NULL;
+  char *rustr = NULL;
+  for(int i = 2; i < argc; i++){
+    if(!path && argv[i][0] == '-'){
+      if(!strcmp(argv[i], "-nl")){
+        omode |= FDBONOLCK;
+      } else if(!strcmp(argv[i], "-nb")){
+        omode |= FDBOLCKNB;
+      } else if(!strcmp(argv[i], "-vi")){
+        vtype = FDBSVINT;
+      } else if(!strcmp(argv[i], "-vl")){
+        vtype = FDBSVLONG;
+      } else if(!strcmp(argv[i], "-vd")){
+        vtype = FDBSVDBL;
+      } else if(!strcmp(argv[i], "-tn")){
+        if(++i >= argc) usage();
+        tnum = tcatoix(argv[i]);
+      } else if(!strcmp(argv[i], "-rb")){
+        if(++i >= argc) usage();
+        rlstr = argv[i];
+        if(++i >= argc) usage();
+        rustr = argv[i];
+      } else {
+        usage();
+      }
+    } else if(!path){
+      path = argv[i];
+    } else if(!opstr){
+      opstr = argv[i];
+    } else if(!expr){
+      expr = argv[i];
+    } else {
+      usage();
+    }
+  }
+  if(!path) usage();
+  int rv = procscan(path, omode, vtype, tnum, rlstr, rustr, opstr, expr);
+  return rv;
+}
+
+
 /* parse arguments of optimize command */
 static int runoptimize(int argc, char **argv){
   char *path = NULL;
@@ -468,10 +536,10 @@ static int runversion(int argc, char **argv){
 
 
 /* perform create command */
-static int proccreate(const char *path, int width, int64_t limsiz){
+static int proccreate(const char *path, int width, int64_t limsiz, int opts){
   TCFDB *fdb = tcfdbnew();
   if(g_dbgfd >= 0) tcfdbsetdbgfd(fdb, g_dbgfd);
-  if(!tcfdbtune(fdb, width, limsiz)){
+  if(!tcfdbtune(fdb, width, limsiz) || !tcfdbsetopts(fdb, opts)){
     printerr(fdb);
     tcfdbdel(fdb);
     return 1;
@@ -517,8 +585,18 @@ static int procinform(const char *path, int omode){
   if(flags & FDBFOPEN) printf(" open");
   if(flags & FDBFFATAL) printf(" fatal");
   printf("\n");
+  uint8_t opts = tcfdbopts(fdb);
+  printf("options:");
+  if(opts & FDBTSPARSE) printf(" sparse");
+  if(opts & FDBTRING) printf(" ring");
+  if(opts & FDBTPACK) printf(" pack");
+  printf("\n");
   printf("minimum ID number: %llu\n", (unsigned long long)tcfdbmin(fdb));
   printf("maximum ID number: %llu\n", (unsigned long long)tcfdbmax(fdb));
+  if(opts & FDBTRING){
+    printf("tail ID number: %llu\n", (unsigned long long)tcfdbtail(fdb));
+    printf("head ID number: %llu\n", (unsigned long long)tcfdbhead(fdb));
+  }
   printf("width of the value: %u\n", (unsigned int)tcfdbwidth(fdb));
   printf("limit file size: %llu\n", (unsigned long long)tcfdblimsiz(fdb));
   printf("limit ID number: %llu\n", (unsigned long long)tcfdblimid(fdb));
@@ -590,7 +668,7 @@ static int procput(const char *path, const char *kbuf, int ksiz, const char *vbu
 
 
 /* perform out command */
-static int procout(const char *path, const char *kbuf, int ksiz, int omode){
+static int procout(const char *path, const char *kbuf, int ksiz, int omode, bool ex){
   TCFDB *fdb = tcfdbnew();
   if(g_dbgfd >= 0) tcfdbsetdbgfd(fdb, g_dbgfd);
   if(!tcfdbopen(fdb, path, FDBOWRITER | omode)){
@@ -599,7 +677,12 @@ static int procout(const char *path, const char *kbuf, int ksiz, int omode){
     return 1;
   }
   bool err = false;
-  if(!tcfdbout2(fdb, kbuf, ksiz)){
+  if(ex){
+    if(!tcfdbexpire(fdb, tcfdbkeytoid(kbuf, ksiz))){
+      printerr(fdb);
+      err = true;
+    }
+  } else if(!tcfdbout2(fdb, kbuf, ksiz)){
     printerr(fdb);
     err = true;
   }
@@ -701,6 +784,55 @@ static int proclist(const char *path, int omode, int max, bool pv, bool px,
 }
 
 
+/* perform scan command */
+static int procscan(const char *path, int omode, int vtype, int tnum,
+                    const char *rlstr, const char *rustr, const char *opstr, const char *expr){
+  int op = FDBSCALL;
+  if(opstr){
+    if(!tcstricmp(opstr, "all")){
+      op = FDBSCALL;
+    } else if(!tcstricmp(opstr, "streq")){
+      op = FDBSCSTREQ;
+    } else if(!tcstricmp(opstr, "strbw")){
+      op = FDBSCSTRBW;
+    } else if(!tcstricmp(opstr, "numeq")){
+      op = FDBSCNUMEQ;
+    } else if(!tcstricmp(opstr, "numbt")){
+      op = FDBSCNUMBT;
+    } else {
+      usage();
+    }
+  }
+  if(!expr) expr = "";
+  TCFDB *fdb = tcfdbnew();
+  if(g_dbgfd >= 0) tcfdbsetdbgfd(fdb, g_dbgfd);
+  if(!tcfdbopen(fdb, path, FDBOREADER | omode)){
+    printerr(fdb);
+    tcfdbdel(fdb);
+    return 1;
+  }
+  bool err = false;
+  int64_t lower = rlstr ? tcfdbkeytoid(rlstr, strlen(rlstr)) : FDBIDMIN;
+  int64_t upper = rustr ? tcfdbkeytoid(rustr, strlen(rustr)) : FDBIDMAX;
+  FDBSCANRES res;
+  if(tcfdbscan(fdb, lower, upper, vtype, op, expr, strlen(expr), tnum, &res)){
+    printf("count: %llu\n", (unsigned long long)res.num);
+    printf("sum: %.3f\n", res.sum);
+    printf("min: %.3f\n", res.min);
+    printf("max: %.3f\n", res.max);
+  } else {
+    printerr(fdb);
+    err = true;
+  }
+  if(!tcfdbclose(fdb)){
+    if(!err) printerr(fdb);
+    err = true;
+  }
+  tcfdbdel(fdb);
+  return err ? 1 : 0;
+}
+
+
 /* perform optimize command */
 static int procoptimize(const char *path, int width, int64_t limsiz, int omode){
   TCFDB *fdb = tcfdbnew();
@@ -59,6 +59,13 @@ typedef struct {                         // type of structure for typical thread
   int id;
 } TARGTYPICAL;
 
+typedef struct {                         // type of structure for counter thread
+  TCFDB *fdb;
+  int rnum;
+  int cnum;
+  int id;
+} TARGCOUNTER;
+
 
 /* global variables */
 const char *g_progname;                  // program name
@@ -82,6 +89,7 @@ static int runread(int argc, char **argv);
 static int runremove(int argc, char **argv);
 static int runwicked(int argc, char **argv);
 static int runtypical(int argc, char **argv);
+static int runcounter(int argc, char **argv);
 static int procwrite(const char *path, int tnum, int rnum, int width, int64_t limsiz,
                      int omode, bool rnd);
 static int procread(const char *path, int tnum, int omode, bool wb, bool rnd);
@@ -89,11 +97,13 @@ static int procremove(const char *path, int tnum, int omode, bool rnd);
 static int procwicked(const char *path, int tnum, int rnum, int omode, bool nc);
 static int proctypical(const char *path, int tnum, int rnum, int width, int64_t limsiz,
                        int omode, bool nc, int rratio);
+static int proccounter(const char *path, int tnum, int rnum, int cnum, int omode, bool tx);
 static void *threadwrite(void *targ);
 static void *threadread(void *targ);
 static void *threadremove(void *targ);
 static void *threadwicked(void *targ);
 static void *threadtypical(void *targ);
+static void *threadcounter(void *targ);
 
 
 /* main routine */
@@ -116,6 +126,8 @@ int main(int argc, char **argv){
     rv = runwicked(argc, argv);
   } else if(!strcmp(argv[1], "typical")){
     rv = runtypical(argc, argv);
+  } else if(!strcmp(argv[1], "counter")){
+    rv = runcounter(argc, argv);
   } else {
     usage();
   }
@@ -142,6 +154,7 @@ static void usage(void){
   fprintf(stderr, "  %s wicked [-nl|-nb] [-nc] path tnum rnum\n", g_progname);
   fprintf(stderr, "  %s typical [-nl|-nb] [-nc] [-rr num] path tnum rnum [width [limsiz]]\n",
           g_progname);
+  fprintf(stderr, "  %s counter [-nl|-nb] [-tx] path tnum rnum [cnum]\n", g_progname);
   fprintf(stderr, "\n");
   exit(1);
 }
@@ -431,6 +444,47 @@ static int runtypical(int argc, char **argv){
 }
 
 
+/* parse arguments of counter command */
+static int runcounter(int argc, char **argv){
+  char *path = NULL;
+  char *tstr = NULL;
+  char *rstr = NULL;
+  char *cstr = NULL;
+  int omode = 0;
+  bool tx = false;
+  for(int i = 2; i < argc; i++){
+    if(!path && argv[i][0] == '-'){
+      if(!strcmp(argv[i], "-nl")){
+        omode |= FDBONOLCK;
+      } else if(!strcmp(argv[i], "-nb")){
+        omode |= FDBOLCKNB;
+      } else if(!strcmp(argv[i], "-tx")){
+        tx = true;
+      } else {
+        usage();
+      }
+    } else if(!path){
+      path = argv[i];
+    } else if(!tstr){
+      tstr = argv[i];
+    } else if(!rstr){
+      rstr = argv[i];
+    } else if(!cstr){
+      cstr = argv[i];
+    } else {
+      usage();
+    }
+  }
+  if(!path || !tstr || !rstr) usage();
+  int tnum = tcatoix(tstr);
+  int rnum = tcatoix(rstr);
+  int cnum = cstr ? tcatoix(cstr) : 100;
+  if(tnum < 1 || rnum < 1 || cnum < 1) usage();
+  int rv = proccounter(path, tnum, rnum, cnum, omode, tx);
+  return rv;
+}
+
+
 /* perform write command */
 static int procwrite(const char *path, int tnum, int rnum, int width, int64_t limsiz,
                      int omode, bool rnd){
@@ -810,6 +864,119 @@ static int proctypical(const char *path, int tnum, int rnum, int width, int64_t
 }
 
 
+/* perform counter command */
+static int proccounter(const char *path, int tnum, int rnum, int cnum, int omode, bool tx){
+  iprintf("<Counter Test>\n  seed=%u  path=%s  tnum=%d  rnum=%d  cnum=%d  omode=%d  tx=%d\n\n",
+          g_randseed, path, tnum, rnum, cnum, omode, tx);
+  bool err = false;
+  double stime = tctime();
+  TCFDB *fdb = tcfdbnew();
+  if(g_dbgfd >= 0) tcfdbsetdbgfd(fdb, g_dbgfd);
+  if(!tcfdbsetmutex(fdb)){
+    eprint(fdb, __LINE__, "tcfdbsetmutex");
+    err = true;
+  }
+  if(!tcfdbtune(fdb, sizeof(int64_t), -1)){
+    eprint(fdb, __LINE__, "tcfdbtune");
+    err = true;
+  }
+  if(!tcfdbopen(fdb, path, FDBOWRITER | FDBOCREAT | FDBOTRUNC | omode)){
+    eprint(fdb, __LINE__, "tcfdbopen");
+    err = true;
+  }
+  for(int i = 1; i <= cnum; i++){
+    int inum = 0;
+    double dnum = 0.0;
+    int64_t lnum = 0;
+    if(!tcfdbput(fdb, i, &inum, sizeof(inum)) ||
+       !tcfdbput(fdb, cnum + i, &dnum, sizeof(dnum)) ||
+       !tcfdbcas(fdb, cnum * 2 + i, NULL, 0, &lnum, sizeof(lnum))){
+      eprint(fdb, __LINE__, "tcfdbput");
+      err = true;
+      break;
+    }
+  }
+  if(tx && !tcfdbtranbegin(fdb)){
+    eprint(fdb, __LINE__, "tcfdbtranbegin");
+    err = true;
+  }
+  TARGCOUNTER targs[tnum];
+  pthread_t threads[tnum];
+  if(tnum == 1){
+    targs[0].fdb = fdb;
+    targs[0].rnum = rnum;
+    targs[0].cnum = cnum;
+    targs[0].id = 0;
+    if(threadcounter(targs) != NULL) err = true;
+  } else {
+    for(int i = 0; i < tnum; i++){
+      targs[i].fdb = fdb;
+      targs[i].rnum = rnum;
+      targs[i].cnum = cnum;
+      targs[i].id = i;
+      if(pthread_create(threads + i, NULL, threadcounter, targs + i) != 0){
+        eprint(fdb, __LINE__, "pthread_create");
+        targs[i].id = -1;
+        err = true;
+      }
+    }
+    for(int i = 0; i < tnum; i++){
+      if(targs[i].id == -1) continue;
+      void *rv;
+      if(pthread_join(threads[i], &rv) != 0){
+        eprint(fdb, __LINE__, "pthread_join");
+        err = true;
+      } else if(rv){
+        err = true;
+      }
+    }
+  }
+  if(tx && !tcfdbtranabort(fdb)){
+    eprint(fdb, __LINE__, "tcfdbtranabort");
+    err = true;
+  }
+  int64_t itotal = 0;
+  double dtotal = 0.0;
+  int64_t ltotal = 0;
+  for(int i = 1; i <= cnum && !err; i++){
+    int64_t ecnt = tx ? 0 : (int64_t)tnum * (rnum / cnum + (i <= rnum % cnum ? 1 : 0));
+    int vsiz;
+    int inum = 0;
+    double dnum = 0.0;
+    int64_t lnum = 0;
+    if(tcfdbget4(fdb, i, &inum, sizeof(inum)) != sizeof(inum) ||
+       tcfdbget4(fdb, cnum + i, &dnum, sizeof(dnum)) != sizeof(dnum) ||
+       (vsiz = tcfdbget4(fdb, cnum * 2 + i, &lnum, sizeof(lnum))) != sizeof(lnum)){
+      eprint(fdb, __LINE__, "tcfdbget4");
+      err = true;
+    } else if(inum != ecnt || dnum != ecnt * 0.5 || lnum != ecnt){
+      eprint(fdb, __LINE__, "(validation)");
+      err = true;
+    }
+    itotal += inum;
+    dtotal += dnum;
+    ltotal += lnum;
+  }
+  if(!err){
+    iprintf("integer total: %lld\n", (long long)itotal);
+    iprintf("real total: %.1f\n", dtotal);
+    iprintf("cas total: %lld\n", (long long)ltotal);
+  }
+  iprintf("record number: %llu\n", (unsigned long long)tcfdbrnum(fdb));
+  iprintf("size: %llu\n", (unsigned long long)tcfdbfsiz(fdb));
+  mprint(fdb);
+  sysprint();
+  if(!tcfdbclose(fdb)){
+    eprint(fdb, __LINE__, "tcfdbclose");
+    err = true;
+  }
+  tcfdbdel(fdb);
+  iprintf("time: %.3f\n", tctime() - stime);
+  iprintf("%s\n\n", err ? "error" : "ok");
+  return err ? 1 : 0;
+}
+
+
 /* thread the write function */
 static void *threadwrite(void *targ){
   TCFDB *fdb = ((TARGWRITE *)targ)->fdb;
@@ -1216,5 +1383,45 @@ static void *threadtypical(void *targ){
 }
 
 
+/* thread the counter function */
+static void *threadcounter(void *targ){
+  TCFDB *fdb = ((TARGCOUNTER *)targ)->fdb;
+  int rnum = ((TARGCOUNTER *)targ)->rnum;
+  int cnum = ((TARGCOUNTER *)targ)->cnum;
+  int id = ((TARGCOUNTER *)targ)->id;
+  bool err = false;
+  for(int i = 1; i <= rnum && !err; i++){
+    int64_t cid = (i - 1) % cnum + 1;
+    if(tcfdbaddint(fdb, cid, 1) == INT_MIN){
+      eprint(fdb, __LINE__, "tcfdbaddint");
+      err = true;
+    }
+    if(isnan(tcfdbadddouble(fdb, cnum + cid, 0.5))){
+      eprint(fdb, __LINE__, "tcfdbadddouble");
+      err = true;
+    }
+    while(!err){
+      int64_t onum;
+      if(tcfdbget4(fdb, cnum * 2 + cid, &onum, sizeof(onum)) != sizeof(onum)){
+        eprint(fdb, __LINE__, "tcfdbget4");
+        err = true;
+        break;
+      }
+      int64_t nnum = onum + 1;
+      if(tcfdbcas(fdb, cnum * 2 + cid, &onum, sizeof(onum), &nnum, sizeof(nnum))) break;
+      if(tcfdbecode(fdb) != TCEKEEP){
+        eprint(fdb, __LINE__, "tcfdbcas");
+        err = true;
+      }
+    }
+    if(id == 0 && rnum > 250 && i % (rnum / 250) == 0){
+      iputchar('.');
+      if(i == rnum || i % (rnum / 10) == 0) iprintf(" (%08d)\n", i);
+    }
+  }
+  return err ? "error" : NULL;
+}
+
+
 
 // END OF FILE
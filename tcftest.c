@@ -39,20 +39,26 @@ static void sysprint(void);
 static int myrand(int range);
 static void *pdprocfunc(const void *vbuf, int vsiz, int *sp, void *op);
 static bool iterfunc(const void *kbuf, int ksiz, const void *vbuf, int vsiz, void *op);
+static bool itercount(const void *kbuf, int ksiz, const void *vbuf, int vsiz, void *op);
+static void reducecount(void *op, void *rop);
+static bool scanref(TCFDB *fdb, int64_t lower, int64_t upper, int vtype, int op,
+                    const char *ebuf, int esiz, FDBSCANRES *res);
 static int runwrite(int argc, char **argv);
 static int runread(int argc, char **argv);
 static int runremove(int argc, char **argv);
 static int runrcat(int argc, char **argv);
 static int runmisc(int argc, char **argv);
 static int runwicked(int argc, char **argv);
+static int runring(int argc, char **argv);
 static int procwrite(const char *path, int rnum, int width, int64_t limsiz,
-                     bool mt, int omode, bool rnd);
+                     bool mt, int opts, int omode, bool rnd);
 static int procread(const char *path, bool mt, int omode, bool wb, bool rnd);
 static int procremove(const char *path, bool mt, int omode, bool rnd);
 static int procrcat(const char *path, int rnum, int width, int64_t limsiz,
                     bool mt, int omode, int pnum, bool dai, bool dad, bool rl, bool ru);
-static int procmisc(const char *path, int rnum, bool mt, int omode);
-static int procwicked(const char *path, int rnum, bool mt, int omode);
+static int procmisc(const char *path, int rnum, bool mt, int opts, int omode);
+static int procwicked(const char *path, int rnum, bool mt, int opts, int omode);
+static int procring(const char *path, int rnum, bool mt, int omode);
 
 
 /* main routine */
@@ -77,6 +83,8 @@ int main(int argc, char **argv){
     rv = runmisc(argc, argv);
   } else if(!strcmp(argv[1], "wicked")){
     rv = runwicked(argc, argv);
+  } else if(!strcmp(argv[1], "ring")){
+    rv = runring(argc, argv);
   } else {
     usage();
   }
@@ -97,13 +105,15 @@ static void usage(void){
           g_progname);
   fprintf(stderr, "\n");
   fprintf(stderr, "usage:\n");
-  fprintf(stderr, "  %s write [-mt] [-nl|-nb] [-rnd] path rnum [width [limsiz]]\n", g_progname);
+  fprintf(stderr, "  %s write [-mt] [-ts|-tp] [-nl|-nb] [-rnd] path rnum [width [limsiz]]\n",
+          g_progname);
   fprintf(stderr, "  %s read [-mt] [-nl|-nb] [-wb] [-rnd] path\n", g_progname);
   fprintf(stderr, "  %s remove [-mt] [-nl|-nb] [-rnd] path\n", g_progname);
   fprintf(stderr, "  %s rcat [-mt] [-nl|-nb] [-pn num] [-dai|-dad|-rl|-ru]"
           " path rnum [width [limsiz]]\n", g_progname);
-  fprintf(stderr, "  %s misc [-mt] [-nl|-nb] path rnum\n", g_progname);
-  fprintf(stderr, "  %s wicked [-mt] [-nl|-nb] path rnum\n", g_progname);
+  fprintf(stderr, "  %s misc [-mt] [-ts|-tp] [-nl|-nb] path rnum\n", g_progname);
+  fprintf(stderr, "  %s wicked [-mt] [-ts|-tp] [-nl|-nb] [-om] path rnum\n", g_progname);
+  fprintf(stderr, "  %s ring [-mt] [-nl|-nb] [-om] path rnum\n", g_progname);
   fprintf(stderr, "\n");
   exit(1);
 }
@@ -214,6 +224,101 @@ static bool iterfunc(const void *kbuf, int ksiz, const void *vbuf, int vsiz, voi
 }
 
 
+/* iterator function to count records */
+static bool itercount(const void *kbuf, int ksiz, const void *vbuf, int vsiz, void *op){
+  int64_t *cnts = op;
+  cnts[0]++;
+  cnts[1] += ksiz + vsiz;
+  return true;
+}
+
+
+/* reduce function to sum up counts */
+static void reducecount(void *op, void *rop){
+  int64_t *cnts = op;
+  int64_t *sums = rop;
+  sums[0] += cnts[0];
+  sums[1] += cnts[1];
+}
+
+
+/* aggregate records in the way of the scan function one by one */
+static bool scanref(TCFDB *fdb, int64_t lower, int64_t upper, int vtype, int op,
+                    const char *ebuf, int esiz, FDBSCANRES *res){
+  res->num = 0;
+  res->sum = 0;
+  res->min = 0;
+  res->max = 0;
+  double lnum = 0;
+  double unum = 0;
+  if(op == FDBSCNUMEQ || op == FDBSCNUMBT){
+    char *expr = tcmemdup(ebuf, esiz);
+    lnum = tcatof(expr);
+    const char *pv = strchr(expr, ',');
+    unum = (op == FDBSCNUMBT && pv) ? tcatof(pv + 1) : lnum;
+    if(lnum > unum){
+      double swap = lnum;
+      lnum = unum;
+      unum = swap;
+    }
+    tcfree(expr);
+  }
+  int inum;
+  uint64_t *ids = tcfdbrange(fdb, lower, upper, -1, &inum);
+  bool err = false;
+  for(int i = 0; i < inum; i++){
+    int vsiz;
+    char *vbuf = tcfdbget(fdb, ids[i], &vsiz);
+    if(!vbuf){
+      err = true;
+      break;
+    }
+    bool hit = true;
+    if(op == FDBSCSTREQ){
+      hit = vsiz == esiz && !memcmp(vbuf, ebuf, esiz);
+    } else if(op == FDBSCSTRBW){
+      hit = vsiz >= esiz && !memcmp(vbuf, ebuf, esiz);
+    }
+    double num = 0;
+    if(vtype == FDBSVINT){
+      int32_t tnum;
+      if(vsiz == sizeof(tnum)){
+        memcpy(&tnum, vbuf, sizeof(tnum));
+        num = tnum;
+      } else {
+        hit = false;
+      }
+    } else if(vtype == FDBSVLONG){
+      int64_t tnum;
+      if(vsiz == sizeof(tnum)){
+        memcpy(&tnum, vbuf, sizeof(tnum));
+        num = tnum;
+      } else {
+        hit = false;
+      }
+    } else if(vtype == FDBSVDBL){
+      if(vsiz == sizeof(num)){
+        memcpy(&num, vbuf, sizeof(num));
+      } else {
+        hit = false;
+      }
+    } else {
+      num = tcatof(vbuf);
+    }
+    if((op == FDBSCNUMEQ || op == FDBSCNUMBT) && !(num >= lnum && num <= unum)) hit = false;
+    if(hit){
+      if(res->num < 1 || num < res->min) res->min = num;
+      if(res->num < 1 || num > res->max) res->max = num;
+      res->num++;
+      res->sum += num;
+    }
+    tcfree(vbuf);
+  }
+  tcfree(ids);
+  return !err;
+}
+
+
 /* parse arguments of write command */
 static int runwrite(int argc, char **argv){
   char *path = NULL;
@@ -221,12 +326,17 @@ static int runwrite(int argc, char **argv){
   char *wstr = NULL;
   char *lstr = NULL;
   bool mt = false;
+  int opts = 0;
   int omode = 0;
   bool rnd = false;
   for(int i = 2; i < argc; i++){
     if(!path && argv[i][0] == '-'){
       if(!strcmp(argv[i], "-mt")){
         mt = true;
+      } else if(!strcmp(argv[i], "-ts")){
+        opts |= FDBTSPARSE;
+      } else if(!strcmp(argv[i], "-tp")){
+        opts |= FDBTSPARSE | FDBTPACK;
       } else if(!strcmp(argv[i], "-nl")){
         omode |= FDBONOLCK;
       } else if(!strcmp(argv[i], "-nb")){
@@ -253,7 +363,7 @@ static int runwrite(int argc, char **argv){
   if(rnum < 1) usage();
   int width = wstr ? tcatoix(wstr) : -1;
   int64_t limsiz = lstr ? tcatoix(lstr) : -1;
-  int rv = procwrite(path, rnum, width, limsiz, mt, omode, rnd);
+  int rv = procwrite(path, rnum, width, limsiz, mt, opts, omode, rnd);
   return rv;
 }
 
@@ -385,11 +495,16 @@ static int runmisc(int argc, char **argv){
   char *path = NULL;
   char *rstr = NULL;
   bool mt = false;
+  int opts = 0;
   int omode = 0;
   for(int i = 2; i < argc; i++){
     if(!path && argv[i][0] == '-'){
       if(!strcmp(argv[i], "-mt")){
         mt = true;
+      } else if(!strcmp(argv[i], "-ts")){
+        opts |= FDBTSPARSE;
+      } else if(!strcmp(argv[i], "-tp")){
+        opts |= FDBTSPARSE | FDBTPACK;
       } else if(!strcmp(argv[i], "-nl")){
         omode |= FDBONOLCK;
       } else if(!strcmp(argv[i], "-nb")){
@@ -408,13 +523,53 @@ static int runmisc(int argc, char **argv){
   if(!path || !rstr) usage();
   int rnum = tcatoix(rstr);
   if(rnum < 1) usage();
-  int rv = procmisc(path, rnum, mt, omode);
+  int rv = procmisc(path, rnum, mt, opts, omode);
   return rv;
 }
 
 
 /* parse arguments of wicked command */
 static int runwicked(int argc, char **argv){
+  char *path = NULL;
+  char *rstr = NULL;
+  bool mt = false;
+  int opts = 0;
+  int omode = 0;
+  for(int i = 2; i < argc; i++){
+    if(!path && argv[i][0] == '-'){
+      if(!strcmp(argv[i], "-mt")){
+        mt = true;
+      } else if(!strcmp(argv[i], "-ts")){
+        opts |= FDBTSPARSE;
+      } else if(!strcmp(argv[i], "-tp")){
+        opts |= FDBTSPARSE | FDBTPACK;
+      } else if(!strcmp(argv[i], "-nl")){
+        omode |= FDBONOLCK;
+      } else if(!strcmp(argv[i], "-nb")){
+        omode |= FDBOLCKNB;
+      } else if(!strcmp(argv[i], "-om")){
+        omode |= FDBOMEMORY;
+      } else {
+        usage();
+      }
+    } else if(!path){
+      path = argv[i];
+    } else if(!rstr){
+      rstr = argv[i];
+    } else {
+      usage();
+    }
+  }
+  if(!path || !rstr) usage();
+  int rnum = tcatoix(rstr);
+  if(rnum < 1) usage();
+  int rv = procwicked(path, rnum, mt, opts, omode);
+  return rv;
+}
+
+
+/* parse arguments of ring command */
+static int runring(int argc, char **argv){
   char *path = NULL;
   char *rstr = NULL;
   bool mt = false;
@@ -427,6 +582,8 @@ static int runwicked(int argc, char **argv){
         omode |= FDBONOLCK;
       } else if(!strcmp(argv[i], "-nb")){
         omode |= FDBOLCKNB;
+      } else if(!strcmp(argv[i], "-om")){
+        omode |= FDBOMEMORY;
       } else {
         usage();
       }
@@ -441,16 +598,17 @@ static int runwicked(int argc, char **argv){
   if(!path || !rstr) usage();
   int rnum = tcatoix(rstr);
   if(rnum < 1) usage();
-  int rv = procwicked(path, rnum, mt, omode);
+  int rv = procring(path, rnum, mt, omode);
   return rv;
 }
 
 
 /* perform write command */
 static int procwrite(const char *path, int rnum, int width, int64_t limsiz,
-                     bool mt, int omode, bool rnd){
-  iprintf("<Writing Test>\n  seed=%u  path=%s  rnum=%d  width=%d  limsiz=%lld  mt=%d  omode=%d"
-          "  rnd=%d\n\n", g_randseed, path, rnum, width, (long long)limsiz, mt, omode, rnd);
+                     bool mt, int opts, int omode, bool rnd){
+  iprintf("<Writing Test>\n  seed=%u  path=%s  rnum=%d  width=%d  limsiz=%lld  mt=%d  opts=%d"
+          "  omode=%d  rnd=%d\n\n",
+          g_randseed, path, rnum, width, (long long)limsiz, mt, opts, omode, rnd);
   bool err = false;
   double stime = tctime();
   TCFDB *fdb = tcfdbnew();
@@ -463,6 +621,10 @@ static int procwrite(const char *path, int rnum, int width, int64_t limsiz,
     eprint(fdb, __LINE__, "tcfdbtune");
     err = true;
   }
+  if(!tcfdbsetopts(fdb, opts)){
+    eprint(fdb, __LINE__, "tcfdbsetopts");
+    err = true;
+  }
   if(!rnd) omode |= FDBOTRUNC;
   if(!tcfdbopen(fdb, path, FDBOWRITER | FDBOCREAT | omode)){
     eprint(fdb, __LINE__, "tcfdbopen");
@@ -733,9 +895,9 @@ static int procrcat(const char *path, int rnum, int width, int64_t limsiz,
 
 
 /* perform misc command */
-static int procmisc(const char *path, int rnum, bool mt, int omode){
-  iprintf("<Miscellaneous Test>\n  seed=%u  path=%s  rnum=%d  mt=%d  omode=%d\n\n",
-          g_randseed, path, rnum, mt, omode);
+static int procmisc(const char *path, int rnum, bool mt, int opts, int omode){
+  iprintf("<Miscellaneous Test>\n  seed=%u  path=%s  rnum=%d  mt=%d  opts=%d  omode=%d\n\n",
+          g_randseed, path, rnum, mt, opts, omode);
   bool err = false;
   double stime = tctime();
   TCFDB *fdb = tcfdbnew();
@@ -744,10 +906,19 @@ static int procmisc(const char *path, int rnum, bool mt, int omode){
     eprint(fdb, __LINE__, "tcfdbsetmutex");
     err = true;
   }
-  if(!tcfdbtune(fdb, RECBUFSIZ, EXHEADSIZ + (RECBUFSIZ + sizeof(int)) * rnum)){
+  if(!tcfdbtune(fdb, RECBUFSIZ, (opts & FDBTSPARSE) ?
+                 -1 : EXHEADSIZ + (RECBUFSIZ + sizeof(int)) * rnum)){
     eprint(fdb, __LINE__, "tcfdbtune");
     err = true;
   }
+  if(!tcfdbsetopts(fdb, opts)){
+    eprint(fdb, __LINE__, "tcfdbsetopts");
+    err = true;
+  }
+  if(!tcfdbsetcache(fdb, 8)){
+    eprint(fdb, __LINE__, "tcfdbsetcache");
+    err = true;
+  }
   if(!tcfdbopen(fdb, path, FDBOWRITER | FDBOCREAT | FDBOTRUNC | omode)){
     eprint(fdb, __LINE__, "tcfdbopen");
     err = true;
@@ -1052,6 +1223,29 @@ static int procmisc(const char *path, int rnum, bool mt, int omode){
     eprint(fdb, __LINE__, "(validation)");
     err = true;
   }
+  iprintf("checking parallel iteration:\n");
+  int64_t sums[2] = { 0, 0 };
+  if(!tcfdbforeach(fdb, itercount, sums)){
+    eprint(fdb, __LINE__, "tcfdbforeach");
+    err = true;
+  }
+  int tnum = myrand(4) + 2;
+  int64_t cnts[tnum][2];
+  void *pops[tnum];
+  for(int i = 0; i < tnum; i++){
+    cnts[i][0] = 0;
+    cnts[i][1] = 0;
+    pops[i] = cnts[i];
+  }
+  int64_t psums[2] = { 0, 0 };
+  if(!tcfdbforeachpar(fdb, itercount, pops, tnum, reducecount, psums)){
+    eprint(fdb, __LINE__, "tcfdbforeachpar");
+    err = true;
+  }
+  if(psums[0] != sums[0] || psums[1] != sums[1] || psums[0] != tcfdbrnum(fdb)){
+    eprint(fdb, __LINE__, "(validation)");
+    err = true;
+  }
   if(myrand(10) == 0 && !tcfdbsync(fdb)){
     eprint(fdb, __LINE__, "tcfdbsync");
     err = true;
@@ -1112,7 +1306,7 @@ static int procmisc(const char *path, int rnum, bool mt, int omode){
     int ksiz = sprintf(kbuf, "%d", myrand(rnum) + 1);
     char vbuf[RECBUFSIZ];
     int vsiz = sprintf(vbuf, "[%d]", myrand(rnum) + 1);
-    switch(myrand(7)){
+    switch(myrand(8)){
     case 0:
       if(!tcfdbput2(fdb, kbuf, ksiz, vbuf, vsiz)){
         eprint(fdb, __LINE__, "tcfdbput2");
@@ -1175,6 +1369,33 @@ static int procmisc(const char *path, int rnum, bool mt, int omode){
       }
       tcmapout(map, kbuf, ksiz);
       break;
+    case 7:
+      if(myrand(3) == 0){
+        int osiz;
+        bool exist = tcmapget(map, kbuf, ksiz, &osiz) != NULL;
+        if(tcfdbcas(fdb, tcfdbkeytoid(kbuf, ksiz), exist ? NULL : vbuf, vsiz, vbuf, vsiz) ||
+           tcfdbecode(fdb) != (exist ? TCEKEEP : TCENOREC)){
+          eprint(fdb, __LINE__, "tcfdbcas");
+          err = true;
+        }
+      } else {
+        int osiz;
+        const char *obuf = tcmapget(map, kbuf, ksiz, &osiz);
+        if(obuf && myrand(2) == 0){
+          if(!tcfdbcas(fdb, tcfdbkeytoid(kbuf, ksiz), obuf, osiz, NULL, 0)){
+            eprint(fdb, __LINE__, "tcfdbcas");
+            err = true;
+          }
+          tcmapout(map, kbuf, ksiz);
+        } else {
+          if(!tcfdbcas(fdb, tcfdbkeytoid(kbuf, ksiz), obuf, osiz, vbuf, vsiz)){
+            eprint(fdb, __LINE__, "tcfdbcas");
+            err = true;
+          }
+          tcmapput(map, kbuf, ksiz, vbuf, vsiz);
+        }
+      }
+      break;
     }
     if(rnum > 250 && i % (rnum / 250) == 0){
       iputchar('.');
@@ -1197,7 +1418,7 @@ static int procmisc(const char *path, int rnum, bool mt, int omode){
     int ksiz = sprintf(kbuf, "%d", myrand(rnum) + 1);
     char vbuf[RECBUFSIZ];
     int vsiz = sprintf(vbuf, "[%d]", myrand(rnum) + 1);
-    switch(myrand(7)){
+    switch(myrand(8)){
     case 0:
       if(!tcfdbput2(fdb, kbuf, ksiz, vbuf, vsiz)){
         eprint(fdb, __LINE__, "tcfdbput2");
@@ -1252,6 +1473,21 @@ static int procmisc(const char *path, int rnum, bool mt, int omode){
         err = true;
       }
       break;
+    case 7:
+      if(myrand(2) == 0){
+        int osiz = 0;
+        char *obuf = tcfdbget2(fdb, kbuf, ksiz, &osiz);
+        if(!tcfdbcas(fdb, tcfdbkeytoid(kbuf, ksiz), obuf, osiz, vbuf, vsiz)){
+          eprint(fdb, __LINE__, "tcfdbcas");
+          err = true;
+        }
+        tcfree(obuf);
+      } else if(!tcfdbcas(fdb, tcfdbkeytoid(kbuf, ksiz), vbuf, vsiz, NULL, 0) &&
+                tcfdbecode(fdb) != TCEKEEP && tcfdbecode(fdb) != TCENOREC){
+        eprint(fdb, __LINE__, "tcfdbcas");
+        err = true;
+      }
+      break;
     }
     if(rnum > 250 && i % (rnum / 250) == 0){
       iputchar('.');
@@ -1321,6 +1557,129 @@ static int procmisc(const char *path, int rnum, bool mt, int omode){
     eprint(fdb, __LINE__, "tcfdbvanish");
     err = true;
   }
+  if(opts & FDBTSPARSE){
+    iprintf("checking sparse IDs:\n");
+    int64_t ids[] = { 1, 1025, 1LL << 20, (1LL << 32) + 7, tcfdblimid(fdb) - 1, tcfdblimid(fdb) };
+    int inum = sizeof(ids) / sizeof(*ids);
+    for(int i = inum - 1; i >= 0; i--){
+      char vbuf[RECBUFSIZ];
+      int vsiz = sprintf(vbuf, "%lld", (long long)ids[i]);
+      if(!tcfdbput(fdb, ids[i], vbuf, vsiz)){
+        eprint(fdb, __LINE__, "tcfdbput");
+        err = true;
+      }
+    }
+    if(tcfdbrnum(fdb) != inum || tcfdbfsiz(fdb) > (1 << 24)){
+      eprint(fdb, __LINE__, "(validation)");
+      err = true;
+    }
+    if(!tcfdbiterinit(fdb)){
+      eprint(fdb, __LINE__, "tcfdbiterinit");
+      err = true;
+    }
+    for(int i = 0; i < inum; i++){
+      if(tcfdbiternext(fdb) != ids[i]){
+        eprint(fdb, __LINE__, "tcfdbiternext");
+        err = true;
+      }
+    }
+    int rsiz;
+    uint64_t *rids = tcfdbrange(fdb, 2, FDBIDMAX, -1, &rsiz);
+    if(rsiz != inum - 1 || rids[0] != ids[1] || rids[rsiz-1] != ids[inum-1]){
+      eprint(fdb, __LINE__, "tcfdbrange");
+      err = true;
+    }
+    tcfree(rids);
+    for(int i = 0; i < inum; i++){
+      if(!tcfdbout(fdb, ids[i])){
+        eprint(fdb, __LINE__, "tcfdbout");
+        err = true;
+      }
+      if(i < inum - 1 && (!tcfdbiterinit(fdb) || tcfdbiternext(fdb) != ids[i+1])){
+        eprint(fdb, __LINE__, "tcfdbiternext");
+        err = true;
+      }
+    }
+    if(tcfdbrnum(fdb) != 0){
+      eprint(fdb, __LINE__, "(validation)");
+      err = true;
+    }
+  }
+  iprintf("checking scan:\n");
+  for(int i = 0; i < rnum; i++){
+    int64_t id = (opts & FDBTSPARSE) ? i % 64 + 1 + (i / 64) * 100000LL : i + 1;
+    int num = myrand(1000) - 500;
+    char vbuf[RECBUFSIZ];
+    int vsiz;
+    if(i % 4 == 0){
+      int32_t tnum = num;
+      memcpy(vbuf, &tnum, sizeof(tnum));
+      vsiz = sizeof(tnum);
+    } else if(i % 4 == 1){
+      int64_t tnum = num + 500;
+      memcpy(vbuf, &tnum, sizeof(tnum));
+      vsiz = sizeof(tnum);
+    } else if(i % 4 == 2){
+      double tnum = num / 4.0;
+      memcpy(vbuf, &tnum, sizeof(tnum));
+      vsiz = sizeof(tnum);
+    } else {
+      vsiz = sprintf(vbuf, "%d", num);
+    }
+    if(!tcfdbput(fdb, id, vbuf, vsiz)){
+      eprint(fdb, __LINE__, "tcfdbput");
+      err = true;
+      break;
+    }
+    if(rnum > 250 && (i + 1) % (rnum / 250) == 0){
+      iputchar('.');
+      if(i + 1 == rnum || (i + 1) % (rnum / 10) == 0) iprintf(" (%08d)\n", i + 1);
+    }
+  }
+  for(int i = 0; i < 100; i++){
+    int64_t lower = myrand(10) > 0 ? myrand(tcfdbmax(fdb)) + 1 : FDBIDMIN;
+    int64_t upper = myrand(10) > 0 ? lower + myrand(tcfdbmax(fdb)) : FDBIDMAX;
+    if(lower == FDBIDMIN && upper != FDBIDMAX) upper = FDBIDMAX;
+    if(upper > (int64_t)tcfdblimid(fdb)) upper = tcfdblimid(fdb);
+    int vtype = myrand(4);
+    int op = myrand(5);
+    char ebuf[RECBUFSIZ];
+    int esiz = 0;
+    if(op == FDBSCSTREQ || op == FDBSCSTRBW){
+      int vsiz;
+      char *vbuf = tcfdbget(fdb, FDBIDMIN, &vsiz);
+      if(vbuf){
+        esiz = (op == FDBSCSTRBW) ? myrand(vsiz + 1) : vsiz;
+        memcpy(ebuf, vbuf, esiz);
+        tcfree(vbuf);
+      }
+    } else if(op == FDBSCNUMEQ){
+      esiz = sprintf(ebuf, "%d", myrand(1000) - 500);
+    } else if(op == FDBSCNUMBT){
+      esiz = sprintf(ebuf, "%d,%d", myrand(1000) - 500, myrand(1000) - 500);
+    }
+    FDBSCANRES res, ref;
+    if(!tcfdbscan(fdb, lower, upper, vtype, op, ebuf, esiz, myrand(4) + 1, &res)){
+      eprint(fdb, __LINE__, "tcfdbscan");
+      err = true;
+      break;
+    }
+    if(!scanref(fdb, lower, upper, vtype, op, ebuf, esiz, &ref)){
+      eprint(fdb, __LINE__, "tcfdbget");
+      err = true;
+      break;
+    }
+    if(res.num != ref.num || fabs(res.sum - ref.sum) > fabs(ref.sum) * 1e-9 + 0.001 ||
+       res.min != ref.min || res.max != ref.max){
+      eprint(fdb, __LINE__, "tcfdbscan");
+      err = true;
+      break;
+    }
+  }
+  if(!tcfdbvanish(fdb)){
+    eprint(fdb, __LINE__, "tcfdbvanish");
+    err = true;
+  }
   if(rnum >= 100){
     if(!tcfdbtranbegin(fdb)){
       eprint(fdb, __LINE__, "tcfdbtranbegin");
@@ -1368,9 +1727,9 @@ static int procmisc(const char *path, int rnum, bool mt, int omode){
 
 
 /* perform wicked command */
-static int procwicked(const char *path, int rnum, bool mt, int omode){
-  iprintf("<Wicked Writing Test>\n  seed=%u  path=%s  rnum=%d  mt=%d  omode=%d\n\n",
-          g_randseed, path, rnum, mt, omode);
+static int procwicked(const char *path, int rnum, bool mt, int opts, int omode){
+  iprintf("<Wicked Writing Test>\n  seed=%u  path=%s  rnum=%d  mt=%d  opts=%d  omode=%d\n\n",
+          g_randseed, path, rnum, mt, opts, omode);
   bool err = false;
   double stime = tctime();
   TCFDB *fdb = tcfdbnew();
@@ -1379,10 +1738,19 @@ static int procwicked(const char *path, int rnum, bool mt, int omode){
     eprint(fdb, __LINE__, "tcfdbsetmutex");
     err = true;
   }
-  if(!tcfdbtune(fdb, RECBUFSIZ * 2, EXHEADSIZ + (RECBUFSIZ * 2 + sizeof(int)) * rnum)){
+  if(!tcfdbtune(fdb, RECBUFSIZ * 2, (opts & FDBTSPARSE) ?
+                 -1 : EXHEADSIZ + (RECBUFSIZ * 2 + sizeof(int)) * rnum)){
     eprint(fdb, __LINE__, "tcfdbtune");
     err = true;
   }
+  if(!tcfdbsetopts(fdb, opts)){
+    eprint(fdb, __LINE__, "tcfdbsetopts");
+    err = true;
+  }
+  if(!tcfdbsetcache(fdb, 16)){
+    eprint(fdb, __LINE__, "tcfdbsetcache");
+    err = true;
+  }
   if(!tcfdbopen(fdb, path, FDBOWRITER | FDBOCREAT | FDBOTRUNC | omode)){
     eprint(fdb, __LINE__, "tcfdbopen");
     err = true;
@@ -1562,13 +1930,15 @@ static int procwicked(const char *path, int rnum, bool mt, int omode){
     }
     if(i % 50 == 0) iprintf(" (%08d)\n", i);
     if(i == rnum / 2){
-      if(!tcfdbclose(fdb)){
-        eprint(fdb, __LINE__, "tcfdbclose");
-        err = true;
-      }
-      if(!tcfdbopen(fdb, path, FDBOWRITER | omode)){
-        eprint(fdb, __LINE__, "tcfdbopen");
-        err = true;
+      if(!(omode & FDBOMEMORY)){
+        if(!tcfdbclose(fdb)){
+          eprint(fdb, __LINE__, "tcfdbclose");
+          err = true;
+        }
+        if(!tcfdbopen(fdb, path, FDBOWRITER | omode)){
+          eprint(fdb, __LINE__, "tcfdbopen");
+          err = true;
+        }
       }
     } else if(i == rnum / 4){
       char *npath = tcsprintf("%s-tmp", path);
@@ -1577,7 +1947,7 @@ static int procwicked(const char *path, int rnum, bool mt, int omode){
         err = true;
       }
       TCFDB *nfdb = tcfdbnew();
-      if(!tcfdbopen(nfdb, npath, FDBOREADER | omode)){
+      if(!tcfdbopen(nfdb, npath, FDBOREADER | (omode & ~FDBOMEMORY))){
         eprint(nfdb, __LINE__, "tcfdbopen");
         err = true;
       }
@@ -1687,5 +2057,216 @@ static int procwicked(const char *path, int rnum, bool mt, int omode){
 }
 
 
+/* perform ring command */
+static int procring(const char *path, int rnum, bool mt, int omode){
+  iprintf("<Ring Buffer Test>\n  seed=%u  path=%s  rnum=%d  mt=%d  omode=%d\n\n",
+          g_randseed, path, rnum, mt, omode);
+  bool err = false;
+  double stime = tctime();
+  TCFDB *fdb = tcfdbnew();
+  if(g_dbgfd >= 0) tcfdbsetdbgfd(fdb, g_dbgfd);
+  if(mt && !tcfdbsetmutex(fdb)){
+    eprint(fdb, __LINE__, "tcfdbsetmutex");
+    err = true;
+  }
+  if(!tcfdbtune(fdb, RECBUFSIZ / 4, EXHEADSIZ + (RECBUFSIZ / 4 + 1) * (rnum / 4 + 1))){
+    eprint(fdb, __LINE__, "tcfdbtune");
+    err = true;
+  }
+  if(!tcfdbsetopts(fdb, FDBTRING)){
+    eprint(fdb, __LINE__, "tcfdbsetopts");
+    err = true;
+  }
+  if(!tcfdbopen(fdb, path, FDBOWRITER | FDBOCREAT | FDBOTRUNC | omode)){
+    eprint(fdb, __LINE__, "tcfdbopen");
+    err = true;
+  }
+  int64_t capnum = fdb->capnum;
+  TCMAP *outs = tcmapnew();
+  iprintf("appending:\n");
+  for(int i = 1; i <= rnum; i++){
+    char vbuf[RECBUFSIZ];
+    int vsiz = sprintf(vbuf, "%d", i);
+    if(!tcfdbput(fdb, FDBIDNEXT, vbuf, vsiz)){
+      eprint(fdb, __LINE__, "tcfdbput");
+      err = true;
+      break;
+    }
+    if(tcfdbhead(fdb) != i){
+      eprint(fdb, __LINE__, "tcfdbhead");
+      err = true;
+      break;
+    }
+    if(myrand(10) == 0){
+      int64_t id = i - myrand(capnum);
+      if(tcfdbout(fdb, id)){
+        tcmapput(outs, &id, sizeof(id), "", 0);
+      } else if(tcfdbecode(fdb) != TCENOREC && tcfdbecode(fdb) != TCEINVALID){
+        eprint(fdb, __LINE__, "tcfdbout");
+        err = true;
+        break;
+      }
+    }
+    if(rnum > 250 && i % (rnum / 250) == 0){
+      iputchar('.');
+      if(i == rnum || i % (rnum / 10) == 0) iprintf(" (%08d)\n", i);
+    }
+  }
+  if(tcfdbtail(fdb) != tclmax(rnum - capnum + 1, 1)){
+    eprint(fdb, __LINE__, "tcfdbtail");
+    err = true;
+  }
+  iprintf("expiring:\n");
+  int64_t tail = tclmax(rnum - capnum / 2, 1);
+  if(!tcfdbexpire(fdb, tail)){
+    eprint(fdb, __LINE__, "tcfdbexpire");
+    err = true;
+  }
+  if(tcfdbtail(fdb) != tclmax(tail, tclmax(rnum - capnum + 1, 1))){
+    eprint(fdb, __LINE__, "tcfdbtail");
+    err = true;
+  }
+  tail = tcfdbtail(fdb);
+  if(tail > 1 && (tcfdbput(fdb, tail - 1, "x", 1) || tcfdbecode(fdb) != TCEINVALID)){
+    eprint(fdb, __LINE__, "tcfdbput");
+    err = true;
+  }
+  iprintf("checking:\n");
+  uint64_t cnum = 0;
+  double csum = 0;
+  for(int i = 1; i <= rnum && !err; i++){
+    int64_t id = i;
+    int vsiz;
+    char *vbuf = tcfdbget(fdb, id, &vsiz);
+    if(id >= tail && !tcmapget(outs, &id, sizeof(id), &vsiz)){
+      if(!vbuf || tcatoi(vbuf) != i){
+        eprint(fdb, __LINE__, "tcfdbget");
+        err = true;
+      }
+      cnum++;
+      csum += i;
+    } else if(vbuf || tcfdbecode(fdb) != TCENOREC){
+      eprint(fdb, __LINE__, "tcfdbget");
+      err = true;
+    }
+    tcfree(vbuf);
+    if(rnum > 250 && i % (rnum / 250) == 0){
+      iputchar('.');
+      if(i == rnum || i % (rnum / 10) == 0) iprintf(" (%08d)\n", i);
+    }
+  }
+  if(tcfdbrnum(fdb) != cnum){
+    eprint(fdb, __LINE__, "(validation)");
+    err = true;
+  }
+  FDBSCANRES res;
+  if(!tcfdbscan(fdb, FDBIDMIN, FDBIDMAX, FDBSVSTR, FDBSCALL, NULL, 0, myrand(4) + 1, &res)){
+    eprint(fdb, __LINE__, "tcfdbscan");
+    err = true;
+  } else if(res.num != cnum || res.sum != csum){
+    eprint(fdb, __LINE__, "(validation)");
+    err = true;
+  }
+  iprintf("transaction:\n");
+  if(!tcfdbtranbegin(fdb)){
+    eprint(fdb, __LINE__, "tcfdbtranbegin");
+    err = true;
+  }
+  for(int i = 1; i <= capnum / 2; i++){
+    if(!tcfdbput(fdb, FDBIDNEXT, "*", 1)){
+      eprint(fdb, __LINE__, "tcfdbput");
+      err = true;
+      break;
+    }
+  }
+  if(!tcfdbtranabort(fdb)){
+    eprint(fdb, __LINE__, "tcfdbtranabort");
+    err = true;
+  }
+  if(tcfdbhead(fdb) != rnum || tcfdbtail(fdb) != tail || tcfdbrnum(fdb) != cnum){
+    eprint(fdb, __LINE__, "(validation)");
+    err = true;
+  }
+  if(!(omode & FDBOMEMORY)){
+    iprintf("reopening:\n");
+    if(!tcfdbclose(fdb)){
+      eprint(fdb, __LINE__, "tcfdbclose");
+      err = true;
+    }
+    if(!tcfdbopen(fdb, path, FDBOREADER | omode)){
+      eprint(fdb, __LINE__, "tcfdbopen");
+      err = true;
+    }
+    if(tcfdbhead(fdb) != rnum || tcfdbtail(fdb) != tail || tcfdbrnum(fdb) != cnum){
+      eprint(fdb, __LINE__, "(validation)");
+      err = true;
+    }
+    if(!tcfdbclose(fdb)){
+      eprint(fdb, __LINE__, "tcfdbclose");
+      err = true;
+    }
+    if(!tcfdbopen(fdb, path, FDBOWRITER | omode)){
+      eprint(fdb, __LINE__, "tcfdbopen");
+      err = true;
+    }
+  }
+  iprintf("iterating:\n");
+  if(!tcfdbiterinit(fdb)){
+    eprint(fdb, __LINE__, "tcfdbiterinit");
+    err = true;
+  }
+  uint64_t inum = 0;
+  uint64_t lid = 0;
+  uint64_t id;
+  while((id = tcfdbiternext(fdb)) > 0){
+    if(id <= lid || id < tail){
+      eprint(fdb, __LINE__, "tcfdbiternext");
+      err = true;
+      break;
+    }
+    lid = id;
+    inum++;
+  }
+  if(inum != cnum){
+    eprint(fdb, __LINE__, "(validation)");
+    err = true;
+  }
+  iprintf("wrapping:\n");
+  for(int i = 1; i <= capnum; i++){
+    if(!tcfdbput(fdb, FDBIDNEXT, "+", 1)){
+      eprint(fdb, __LINE__, "tcfdbput");
+      err = true;
+      break;
+    }
+  }
+  if(tcfdbhead(fdb) != rnum + capnum || tcfdbtail(fdb) != rnum + 1 || tcfdbrnum(fdb) != capnum){
+    eprint(fdb, __LINE__, "(validation)");
+    err = true;
+  }
+  if(!tcfdbput(fdb, rnum + capnum * 3, "/", 1) || tcfdbrnum(fdb) != 1 ||
+     tcfdbmin(fdb) != rnum + capnum * 3){
+    eprint(fdb, __LINE__, "tcfdbput");
+    err = true;
+  }
+  if(!tcfdbexpire(fdb, FDBIDMAX) || tcfdbrnum(fdb) != 0){
+    eprint(fdb, __LINE__, "tcfdbexpire");
+    err = true;
+  }
+  iprintf("record number: %llu\n", (unsigned long long)tcfdbrnum(fdb));
+  iprintf("size: %llu\n", (unsigned long long)tcfdbfsiz(fdb));
+  mprint(fdb);
+  sysprint();
+  tcmapdel(outs);
+  if(!tcfdbclose(fdb)){
+    eprint(fdb, __LINE__, "tcfdbclose");
+    err = true;
+  }
+  tcfdbdel(fdb);
+  iprintf("time: %.3f\n", tctime() - stime);
+  iprintf("%s\n\n", err ? "error" : "ok");
+  return err ? 1 : 0;
+}
+
+
 
 // END OF FILE
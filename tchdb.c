@@ -95,6 +95,16 @@ typedef struct {                         // type of structure for a duplication
   void *op;                              // opaque pointer
 } HDBPDPROCOP;
 
+typedef struct {                         // type of structure for a worker of parallel iteration
+  TCHDB *hdb;                            // database object
+  uint64_t lower;                        // offset where the partition begins
+  uint64_t upper;                        // offset where the next partition begins
+  TCITER iter;                           // iterator function
+  void *op;                              // opaque pointer of the worker
+  volatile bool *stop;                   // flag to stop all workers
+  int ecode;                             // error code of the worker
+} HDBFEARG;
+
 
 /* private macros */
 #define HDBLOCKMETHOD(TC_hdb, TC_wr) \
@@ -180,7 +190,13 @@ static bool tchdbvanishimpl(TCHDB *hdb);
 static bool tchdbcopyimpl(TCHDB *hdb, const char *path);
 static bool tchdbdefragimpl(TCHDB *hdb, int64_t step);
 static bool tchdbiterjumpimpl(TCHDB *hdb, const char *kbuf, int ksiz);
-static bool tchdbforeachimpl(TCHDB *hdb, TCITER iter, void *op);
+static bool tchdbforeachimpl(TCHDB *hdb, uint64_t off, uint64_t end, TCITER iter, void *op,
+                             volatile bool *stop);
+static bool tchdbforeachparimpl(TCHDB *hdb, TCITER iter, void **ops, int tnum,
+                                TCREDUCE reduce, void *rop);
+static void *tchdbforeachthread(void *targ);
+static void tchdbforeachpart(HDBFEARG *arg);
+static bool tchdbforeachseek(TCHDB *hdb, uint64_t off, uint64_t end, uint64_t *offp);
 static bool tchdblockmethod(TCHDB *hdb, bool wr);
 static bool tchdbunlockmethod(TCHDB *hdb);
 static bool tchdblockrecord(TCHDB *hdb, uint8_t bidx, bool wr);
@@ -1784,7 +1800,33 @@ bool tchdbforeach(TCHDB *hdb, TCITER iter, void *op){
     return false;
   }
   HDBTHREADYIELD(hdb);
-  bool rv = tchdbforeachimpl(hdb, iter, op);
+  bool stop = false;
+  bool rv = tchdbforeachimpl(hdb, hdb->frec, hdb->fsiz, iter, op, &stop);
+  HDBUNLOCKALLRECORDS(hdb);
+  HDBUNLOCKMETHOD(hdb);
+  return rv;
+}
+
+
+/* Process each record of a hash database object by partitions in parallel. */
+bool tchdbforeachpar(TCHDB *hdb, TCITER iter, void **ops, int tnum, TCREDUCE reduce, void *rop){
+  assert(hdb && iter && ops);
+  if(!HDBLOCKMETHOD(hdb, false)) return false;
+  if(hdb->fd < 0){
+    tchdbsetecode(hdb, TCEINVALID, __FILE__, __LINE__, __func__);
+    HDBUNLOCKMETHOD(hdb);
+    return false;
+  }
+  if(hdb->async && !tchdbflushdrp(hdb)){
+    HDBUNLOCKMETHOD(hdb);
+    return false;
+  }
+  if(!HDBLOCKALLRECORDS(hdb, false)){
+    HDBUNLOCKMETHOD(hdb);
+    return false;
+  }
+  HDBTHREADYIELD(hdb);
+  bool rv = tchdbforeachparimpl(hdb, iter, ops, tnum, reduce, rop);
   HDBUNLOCKALLRECORDS(hdb);
   HDBUNLOCKMETHOD(hdb);
   return rv;
@@ -4774,17 +4816,20 @@ static bool tchdbiterjumpimpl(TCHDB *hdb, const char *kbuf, int ksiz){
 
 /* Process each record atomically of a hash database object.
    `hdb' specifies the hash database object.
+   `off' specifies the offset of the first record.
+   `end' specifies the offset where records to be processed end.
    `func' specifies the pointer to the iterator function called for each record.
    `op' specifies an arbitrary pointer to be given as a parameter of the iterator function.
+   `stop' specifies the pointer to the flag to stop iteration, which is set when the iterator
+   function returns false.
    If successful, the return value is true, else, it is false. */
-static bool tchdbforeachimpl(TCHDB *hdb, TCITER iter, void *op){
-  assert(hdb && iter);
+static bool tchdbforeachimpl(TCHDB *hdb, uint64_t off, uint64_t end, TCITER iter, void *op,
+                             volatile bool *stop){
+  assert(hdb && iter && stop);
   bool err = false;
-  uint64_t off = hdb->frec;
   TCHREC rec;
   char rbuf[HDBIOBUFSIZ];
-  bool cont = true;
-  while(cont && off < hdb->fsiz){
+  while(!*stop && off < end){
     rec.off = off;
     if(!tchdbreadrec(hdb, &rec, rbuf)){
       err = true;
@@ -4809,14 +4854,14 @@ static bool tchdbforeachimpl(TCHDB *hdb, TCITER iter, void *op){
             zbuf = hdb->dec(rec.vbuf, rec.vsiz, &zsiz, hdb->decop);
           }
           if(zbuf){
-            cont = iter(rec.kbuf, rec.ksiz, zbuf, zsiz, op);
+            if(!iter(rec.kbuf, rec.ksiz, zbuf, zsiz, op)) *stop = true;
             TCFREE(zbuf);
           } else {
             tchdbsetecode(hdb, TCEMISC, __FILE__, __LINE__, __func__);
             err = true;
           }
         } else {
-          cont = iter(rec.kbuf, rec.ksiz, rec.vbuf, rec.vsiz, op);
+          if(!iter(rec.kbuf, rec.ksiz, rec.vbuf, rec.vsiz, op)) *stop = true;
         }
       }
       TCFREE(rec.bbuf);
@@ -4826,6 +4871,190 @@ static bool tchdbforeachimpl(TCHDB *hdb, TCITER iter, void *op){
 }
 
 
+/* Process each record of a hash database object by partitions in parallel.
+   `hdb' specifies the hash database object.
+   `iter' specifies the pointer to the iterator function called for each record.
+   `ops' specifies the array of the opaque pointers of the workers.
+   `tnum' specifies the number of the workers.
+   `reduce' specifies the pointer to the reduce function or `NULL'.
+   `rop' specifies the opaque pointer given to the reduce function.
+   If successful, the return value is true, else, it is false.
+   The region of records is divided into ranges of the same size and the calling thread works
+   for the first one. */
+static bool tchdbforeachparimpl(TCHDB *hdb, TCITER iter, void **ops, int tnum,
+                                TCREDUCE reduce, void *rop){
+  assert(hdb && iter && ops);
+  if(tnum < 1) tnum = 1;
+  uint64_t range = hdb->fsiz - hdb->frec;
+  volatile bool stop = false;
+  HDBFEARG *args;
+  TCMALLOC(args, sizeof(*args) * tnum);
+  pthread_t *threads;
+  TCMALLOC(threads, sizeof(*threads) * tnum);
+  bool *runs;
+  TCMALLOC(runs, sizeof(*runs) * tnum);
+  for(int i = 0; i < tnum; i++){
+    HDBFEARG *arg = args + i;
+    arg->hdb = hdb;
+    arg->lower = hdb->frec + range * i / tnum;
+    arg->upper = hdb->frec + range * (i + 1) / tnum;
+    arg->iter = iter;
+    arg->op = ops[i];
+    arg->stop = &stop;
+    arg->ecode = TCESUCCESS;
+    runs[i] = i > 0 && pthread_create(threads + i, NULL, tchdbforeachthread, arg) == 0;
+  }
+  for(int i = 0; i < tnum; i++){
+    if(!runs[i]) tchdbforeachpart(args + i);
+  }
+  bool err = false;
+  for(int i = 0; i < tnum; i++){
+    if(runs[i]){
+      void *rv;
+      if(pthread_join(threads[i], &rv) != 0){
+        tchdbsetecode(hdb, TCETHREAD, __FILE__, __LINE__, __func__);
+        err = true;
+      }
+    }
+    if(args[i].ecode != TCESUCCESS){
+      tchdbsetecode(hdb, args[i].ecode, __FILE__, __LINE__, __func__);
+      err = true;
+    }
+  }
+  if(reduce){
+    for(int i = 0; i < tnum; i++){
+      reduce(ops[i], rop);
+    }
+  }
+  TCFREE(runs);
+  TCFREE(threads);
+  TCFREE(args);
+  return !err;
+}
+
+
+/* Process a partition of parallel iteration in a thread.
+   `targ' specifies the pointer to the argument structure of the worker.
+   The return value is always `NULL'. */
+static void *tchdbforeachthread(void *targ){
+  assert(targ);
+  tchdbforeachpart(targ);
+  return NULL;
+}
+
+
+/* Process the records of a partition of parallel iteration.
+   `arg' specifies the argument structure of the worker. */
+static void tchdbforeachpart(HDBFEARG *arg){
+  assert(arg);
+  TCHDB *hdb = arg->hdb;
+  uint64_t off;
+  if(!tchdbforeachseek(hdb, arg->lower, arg->upper, &off) ||
+     !tchdbforeachimpl(hdb, off, arg->upper, arg->iter, arg->op, arg->stop)){
+    int ecode = tchdbecode(hdb);
+    arg->ecode = (ecode != TCESUCCESS) ? ecode : TCEMISC;
+  }
+}
+
+
+/* Find the first record in a region of a hash database object.
+   `hdb' specifies the hash database object.
+   `off' specifies the offset where the search begins.
+   `end' specifies the offset where the search ends.
+   `offp' specifies the pointer to the variable into which the offset of the first record or
+   `end' if no record is found is assigned.
+   If successful, the return value is true, else, it is false.
+   As the offset can be in the middle of a record, data which looks like the header of a record
+   at an aligned offset is accepted only if the collision tree of its key leads to the same
+   offset. */
+static bool tchdbforeachseek(TCHDB *hdb, uint64_t off, uint64_t end, uint64_t *offp){
+  assert(hdb && offp);
+  if(off <= hdb->frec){
+    *offp = tclmin(hdb->frec, end);
+    return true;
+  }
+  *offp = end;
+  uint64_t align = hdb->align;
+  off = (off + align - 1) & ~(align - 1);
+  int hmin = sizeof(uint8_t) * 2 + (hdb->ba64 ? sizeof(uint64_t) : sizeof(uint32_t)) * 2 +
+    sizeof(uint16_t) + sizeof(uint8_t) * 2;
+  char rbuf[HDBIOBUFSIZ], tbuf[HDBIOBUFSIZ];
+  for(; off < end; off += align){
+    int rsiz = tclmin(hdb->runit, hdb->fsiz - off);
+    if(rsiz < hmin) break;
+    if(!tchdbseekreadtry(hdb, off, rbuf, rsiz)) return false;
+    if(*(uint8_t *)rbuf != HDBMAGICREC) continue;
+    if(rsiz < HDBMAXHSIZ) memset(rbuf + rsiz, 0, HDBMAXHSIZ - rsiz);
+    const char *rp = rbuf + sizeof(uint8_t);
+    uint8_t hash = *(uint8_t *)(rp++);
+    rp += (hdb->ba64 ? sizeof(uint64_t) : sizeof(uint32_t)) * 2;
+    uint16_t snum;
+    memcpy(&snum, rp, sizeof(snum));
+    uint64_t psiz = TCITOHS(snum);
+    rp += sizeof(snum);
+    uint32_t lnum;
+    int step;
+    TCREADVNUMBUF(rp, lnum, step);
+    uint64_t ksiz = lnum;
+    rp += step;
+    TCREADVNUMBUF(rp, lnum, step);
+    uint64_t vsiz = lnum;
+    rp += step;
+    uint64_t hsiz = rp - rbuf;
+    if(hsiz > rsiz || ksiz > INT_MAX || off + hsiz + ksiz + vsiz + psiz > hdb->fsiz) continue;
+    char *kbuf = NULL;
+    const char *kp = rbuf + hsiz;
+    if(hsiz + ksiz > rsiz){
+      TCMALLOC(kbuf, ksiz + 1);
+      if(!tchdbseekreadtry(hdb, off + hsiz, kbuf, ksiz)){
+        TCFREE(kbuf);
+        return false;
+      }
+      kp = kbuf;
+    }
+    uint8_t khash;
+    uint64_t bidx = tchdbbidx(hdb, kp, ksiz, &khash);
+    uint64_t roff = (khash == hash) ? tchdbgetbucket(hdb, bidx) : 0;
+    bool err = false;
+    while(roff > 0 && roff != off){
+      TCHREC rec;
+      rec.off = roff;
+      if(!tchdbreadrec(hdb, &rec, tbuf)){
+        err = true;
+        break;
+      }
+      if(hash > rec.hash){
+        roff = rec.left;
+      } else if(hash < rec.hash){
+        roff = rec.right;
+      } else {
+        if(!rec.kbuf && !tchdbreadrecbody(hdb, &rec)){
+          TCFREE(rec.bbuf);
+          err = true;
+          break;
+        }
+        int kcmp = tcreckeycmp(kp, ksiz, rec.kbuf, rec.ksiz);
+        TCFREE(rec.bbuf);
+        if(kcmp > 0){
+          roff = rec.left;
+        } else if(kcmp < 0){
+          roff = rec.right;
+        } else {
+          roff = 0;
+        }
+      }
+    }
+    TCFREE(kbuf);
+    if(err) return false;
+    if(roff == off){
+      *offp = off;
+      break;
+    }
+  }
+  return true;
+}
+
+
 /* Lock a method of the hash database object.
    `hdb' specifies the hash database object.
    `wr' specifies whether the lock is writer or not.
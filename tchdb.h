@@ -862,6 +862,29 @@ bool tchdbiterinit3(TCHDB *hdb, const char *kstr);
 bool tchdbforeach(TCHDB *hdb, TCITER iter, void *op);
 
 
+/* Process each record of a hash database object by partitions in parallel.
+   `hdb' specifies the hash database object.
+   `iter' specifies the pointer to the iterator function called for each record.  It receives
+   the same parameters as with `tchdbforeach'.
+   `ops' specifies the array of arbitrary pointers.  Each worker gives its own element as the
+   fifth parameter of the iterator function.
+   `tnum' specifies the number of workers.  The array `ops' should have as many elements.
+   `reduce' specifies the pointer to the reduce function called for each worker after all
+   workers finish.  It receives two parameters.  The first parameter is the element of `ops' of
+   the worker.  The second parameter is `rop'.  If it is `NULL', no reduce function is called.
+   `rop' specifies an arbitrary pointer to be given as a parameter of the reduce function.  If
+   it is not needed, `NULL' can be specified.
+   If successful, the return value is true, else, it is false.
+   The region of records in the file is divided into ranges of offsets of the same size, and
+   each range is processed by a worker thread.  When the iterator function returns false, all
+   workers stop.  The reduce function is called serially in the order of the ranges.  Because
+   the iterator function is called by workers concurrently, it should not modify any object
+   shared among workers without synchronization.  Note that the callback function can not
+   perform any database operation because the function is called in the critical section
+   guarded by the same locks of database operations. */
+bool tchdbforeachpar(TCHDB *hdb, TCITER iter, void **ops, int tnum, TCREDUCE reduce, void *rop);
+
+
 /* Void the transaction of a hash database object.
    `hdb' specifies the hash database object connected as a writer.
    If successful, the return value is true, else, it is false.
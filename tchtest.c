@@ -38,6 +38,8 @@ static void sysprint(void);
 static int myrand(int range);
 static void *pdprocfunc(const void *vbuf, int vsiz, int *sp, void *op);
 static bool iterfunc(const void *kbuf, int ksiz, const void *vbuf, int vsiz, void *op);
+static bool itercount(const void *kbuf, int ksiz, const void *vbuf, int vsiz, void *op);
+static void reducecount(void *op, void *rop);
 static int runwrite(int argc, char **argv);
 static int runread(int argc, char **argv);
 static int runremove(int argc, char **argv);
@@ -231,6 +233,24 @@ static bool iterfunc(const void *kbuf, int ksiz, const void *vbuf, int vsiz, voi
 }
 
 
+/* iterator function to count records */
+static bool itercount(const void *kbuf, int ksiz, const void *vbuf, int vsiz, void *op){
+  int64_t *cnts = op;
+  cnts[0]++;
+  cnts[1] += ksiz + vsiz;
+  return true;
+}
+
+
+/* reduce function to sum up counts */
+static void reducecount(void *op, void *rop){
+  int64_t *cnts = op;
+  int64_t *sums = rop;
+  sums[0] += cnts[0];
+  sums[1] += cnts[1];
+}
+
+
 /* parse arguments of write command */
 static int runwrite(int argc, char **argv){
   char *path = NULL;
@@ -1367,6 +1387,29 @@ static int procmisc(const char *path, int rnum, bool mt, int opts, int omode){
     eprint(hdb, __LINE__, "(validation)");
     err = true;
   }
+  iprintf("checking parallel iteration:\n");
+  int64_t sums[2] = { 0, 0 };
+  if(!tchdbforeach(hdb, itercount, sums)){
+    eprint(hdb, __LINE__, "tchdbforeach");
+    err = true;
+  }
+  int tnum = myrand(4) + 2;
+  int64_t cnts[tnum][2];
+  void *pops[tnum];
+  for(int i = 0; i < tnum; i++){
+    cnts[i][0] = 0;
+    cnts[i][1] = 0;
+    pops[i] = cnts[i];
+  }
+  int64_t psums[2] = { 0, 0 };
+  if(!tchdbforeachpar(hdb, itercount, pops, tnum, reducecount, psums)){
+    eprint(hdb, __LINE__, "tchdbforeachpar");
+    err = true;
+  }
+  if(psums[0] != sums[0] || psums[1] != sums[1] || psums[0] != tchdbrnum(hdb)){
+    eprint(hdb, __LINE__, "(validation)");
+    err = true;
+  }
   if(myrand(10) == 0 && !tchdbsync(hdb)){
     eprint(hdb, __LINE__, "tchdbsync");
     err = true;
@@ -38,13 +38,50 @@
 #define TDBIDXICCMAX   (64LL<<20)        // maximum size of the index cache
 #define TDBIDXICCSYNC  0.01              // ratio of cache synchronization
 #define TDBIDXQGUNIT   3                 // unit number of the q-gram index
+#define TDBIDXQGBNUM   128               // number of postings in each block of the q-gram index
+#define TDBIDXQGMAGIC  0xd8              // magic number of packed q-gram postings
+#define TDBIDXNUMSIZ   8                 // size of the key of a binary numeric index
 #define TDBFTSUNITMAX  32                // maximum number of full-text search units
-#define TDBFTSOCRUNIT  8192              // maximum number of full-text search units
-#define TDBFTSBMNUM    524287            // number of elements of full-text search bitmap
 #define TDBNUMCNTCOL   "_num"            // column name of number counting
 #define TDBCOLBUFSIZ   1024              // size of a buffer for a column value
 #define TDBHINTUSIZ    256               // unit size of the hint string
 #define TDBORDRATIO    0.2               // ratio of records to use the order index
+#define TDBCOVRATIO    8                 // ratio of index records to sort by the order index
+#define TDBOPQFMTOFF   8                 // offset of the row format in the opaque field
+#define TDBCDICSUFFIX  "cdic"            // suffix of column dictionary file
+#define TDBCDICMODE    00644             // permission of created column dictionary files
+#define TDBCOLSPARSE   0x80              // flag of the sparse offset table of the columnar format
+#define TDBCOLNUMMAX   24                // maximum size of a typed numeric value
+#define TDBCOLNUMBUFSIZ  64              // size of a buffer for a typed numeric value
+#define TDBIDXSTMAGIC  0xd7              // magic number of index statistics
+#define TDBIDXSTPNUM   6                 // number of positions of index statistics
+#define TDBIDXSTOFF    12                // offset of the positions of index statistics
+#define TDBESTDIVE     1024              // maximum number of index records to count exactly
+#define TDBINTRATIO    16                // ratio of estimations to use an auxiliary index
+#define TDBAGGRUNIT    64                // unit number of the states of aggregation
+#define TDBAGGRRBITS   8                 // number of bits of the registers of distinct values
+#define TDBAGGRRNUM    (1<<TDBAGGRRBITS) // number of the registers of distinct values
+#define TDBRANKUNIT    64                // unit number of the records of ranked search
+#define TDBRANKK1      1.2               // saturation of the term frequency of ranked search
+#define TDBRANKB       0.75              // normalization of the length of ranked search
+
+enum {                                   // enumeration for row formats
+  TDBRFMAP,                              // serialized map
+  TDBRFCOLUMNAR                          // columnar
+};
+
+enum {                                   // enumeration for field types of the columnar format
+  TDBCFSTR = 1,                          // string
+  TDBCFINT,                              // integer
+  TDBCFDBL                               // real number
+};
+
+enum {                                   // enumeration for traversal modes of a query cursor
+  TDBCMSCAN,                             // whole table
+  TDBCMINDEX,                            // index of a condition
+  TDBCMORDER,                            // index of the ordering column
+  TDBCMLIST                              // materialized result
+};
 
 enum {                                   // enumeration for duplication behavior
   TDBPDOVER,                             // overwrite an existing value
@@ -59,25 +96,118 @@ typedef struct {                         // type of structure for a sort key
   int vsiz;                              // size of the value
 } TDBSORTKEY;
 
+typedef struct {                         // type of structure for a field of the columnar format
+  int32_t id;                            // identifier of the column
+  const char *vbuf;                      // pointer to the value
+  int vsiz;                              // size of the value
+} TDBCOLFIELD;
+
 typedef struct {                         // type of structure for a full-text search unit
   TCLIST *tokens;                        // q-gram tokens
   bool sign;                             // positive sign
 } TDBFTSUNIT;
 
-typedef struct {                         // type of structure for a full-text string occurrence
-  const char *pkbuf;                     // primary key string
-  int32_t pksiz;                         // size of the primary key
-  int32_t off;                           // offset of the token
-  uint16_t seq;                          // sequence number
-  uint16_t hash;                         // hash value for counting sort
-} TDBFTSSTROCR;
-
-typedef struct {                         // type of structure for a full-text number occurrence
-  int64_t pkid;                          // primery key number
-  int32_t off;                           // offset of the token
-  uint16_t seq;                          // sequence number
-  uint16_t hash;                         // hash value for counting sort
-} TDBFTSNUMOCR;
+typedef struct {                         // type of structure for a posting of a q-gram
+  int64_t pkid;                          // number of the primary key
+  const char *pkbuf;                     // string of the primary key or `NULL' if numeric
+  int32_t pksiz;                         // size of the string of the primary key
+  int32_t oidx;                          // index of the first offset
+  int32_t onum;                          // number of the offsets
+} TDBQGPOST;
+
+typedef struct {                         // type of structure for an array of q-gram postings
+  TDBQGPOST *posts;                      // array of the postings
+  int pnum;                              // number of the postings
+  int panum;                             // number of allocated postings
+  int32_t *offs;                         // array of the offsets
+  int onum;                              // number of the offsets
+  int oanum;                             // number of allocated offsets
+} TDBQGARY;
+
+typedef struct {                         // type of structure for a q-gram of a phrase search
+  char token[TDBIDXQGUNIT*3+1];          // string of the q-gram
+  int tsiz;                              // size of the string
+  int pos;                               // position in the phrase
+  TDBQGARY tary;                         // postings of the plain list
+  char *tbuf;                            // copy of the plain list in the database
+  int ti;                                // cursor in the plain list
+  TDBQGPOST *tpost;                      // current posting of the plain list or `NULL'
+  BDBCUR *cur;                           // cursor of the blocks or `NULL'
+  TCXSTR *kxstr;                         // buffer of a key
+  TCXSTR *bkey;                          // key of the current block
+  char *bbuf;                            // value of the current block
+  TDBQGARY bary;                         // postings of the current block
+  int bi;                                // cursor in the current block
+  TDBQGPOST *bpost;                      // current posting of the blocks or `NULL'
+  bool bend;                             // whether the blocks are exhausted
+  int64_t dnum;                          // number of the postings
+  int64_t bnum;                          // number of the blocks
+  int64_t bread;                         // number of the read blocks
+} TDBQGLIST;
+
+typedef struct {                         // type of structure for statistics of an index
+  int64_t snum;                          // number of entries at sampling
+  int64_t knum;                          // number of distinct keys at sampling
+  uint64_t poss[TDBIDXSTPNUM];           // positions of the minimum, quantiles, and maximum
+} TDBIDXSTAT;
+
+typedef struct {                         // type of structure for a worker of parallel iteration
+  TCTDB *tdb;                            // table database object
+  TCITER iter;                           // iterator function
+  void *op;                              // opaque pointer of the worker
+} TDBFEOP;
+
+typedef struct {                         // type of structure for a worker of parallel scan
+  TDBQRY *qry;                           // query object
+  TDBCOND *ucond;                        // only alive condition or `NULL'
+  TCLIST *res;                           // result of the worker
+  TCLIST *svals;                         // sort values of the result or `NULL'
+  pthread_mutex_t *mutex;                // mutex for the number of hits or `NULL'
+  int *hnp;                              // pointer to the number of hits of all workers
+  int max;                               // maximum number of hits
+} TDBSCANOP;
+
+typedef struct {                         // type of structure for the state of an aggregated group
+  int64_t num;                           // number of records
+  int64_t vnum;                          // number of records having the aggregated column
+  double sum;                            // summation of the values
+  double min;                            // minimum of the values
+  double max;                            // maximum of the values
+  uint8_t regs[TDBAGGRRNUM];             // registers of the distinct values
+} TDBAGGRST;
+
+typedef struct {                         // type of structure for a worker of aggregation
+  TDBQRY *qry;                           // query object
+  const char *gname;                     // name of the grouping column or `NULL'
+  int gnsiz;                             // size of the name of the grouping column
+  const char *aname;                     // name of the aggregated column or `NULL'
+  int ansiz;                             // size of the name of the aggregated column
+  TCMAP *groups;                         // map of the group values and the indices of the states
+  TDBAGGRST *states;                     // states of the groups
+  int snum;                              // number of the states
+  int sanum;                             // number of allocated states
+} TDBAGGROP;
+
+typedef struct {                         // type of structure for a term of ranked search
+  TDBQGLIST *lists;                      // postings of the q-grams of a phrase or `NULL'
+  int lnum;                              // number of the postings of the q-grams
+  TDBQGLIST *dlist;                      // driving postings of the q-grams
+  TDBQGARY ary;                          // materialized postings
+  TCLIST *bufs;                          // regions referred to by the materialized postings
+  int ai;                                // cursor of the materialized postings
+  const TDBQGPOST *post;                 // current posting or `NULL'
+  int tf;                                // frequency of the term in the current record
+  int64_t df;                            // number of the records having the term
+  double idf;                            // inverse document frequency of the term
+  double ub;                             // upper bound of the score of the term
+} TDBRANKTERM;
+
+typedef struct {                         // type of structure for a record of ranked search
+  char *pkbuf;                           // primary key string
+  int pksiz;                             // size of the primary key
+  TDBQGPOST post;                        // posting of the primary key
+  double score;                          // score of the relevance
+} TDBRANKREC;
 
 
 /* private macros */
@@ -99,6 +229,21 @@ static TCMAP *tctdbgetimpl(TCTDB *tdb, const void *pkbuf, int pksiz);
 static char *tctdbgetonecol(TCTDB *tdb, const void *pkbuf, int pksiz,
                             const void *nbuf, int nsiz, int *sp);
 static double tctdbaddnumber(TCTDB *tdb, const void *pkbuf, int pksiz, double num);
+static bool tctdbcdicload(TCTDB *tdb);
+static bool tctdbcdicsave(TCTDB *tdb, int start);
+static char *tctdbrowdump(TCTDB *tdb, TCMAP *cols, int *sp);
+static char *tctdbrowdumpcol(TCTDB *tdb, TCMAP *cols, int *sp);
+static int tctdbrowcmpfield(const TDBCOLFIELD *a, const TDBCOLFIELD *b);
+static int tctdbrowfieldenc(const char *vbuf, int vsiz, char *buf);
+static const char *tctdbrowfielddec(const char *fbuf, int fsiz, char *nbuf, int *sp);
+static TCMAP *tctdbrowload(TCTDB *tdb, const char *cbuf, int csiz);
+static TCMAP *tctdbrowloadpart(TCTDB *tdb, const char *cbuf, int csiz,
+                               TDBCOND *conds, int cnum);
+static char *tctdbrowloadone(TCTDB *tdb, const char *cbuf, int csiz,
+                             const char *nbuf, int nsiz, int *sp);
+static int tctdbrowhead(const char *cbuf, int csiz, int *np, int *wp, bool *spp);
+static uint32_t tctdbrowoff(const char *rp, int width);
+static const char *tctdbrowfield(const char *cbuf, int csiz, int id, int *sp);
 static bool tctdboptimizeimpl(TCTDB *tdb, int64_t bnum, int8_t apow, int8_t fpow, uint8_t opts);
 static bool tctdbvanishimpl(TCTDB *tdb);
 static bool tctdbcopyimpl(TCTDB *tdb, const char *path);
@@ -108,23 +253,76 @@ static bool tctdbtranabortimpl(TCTDB *tdb);
 static bool tctdbsetindeximpl(TCTDB *tdb, const char *name, int type);
 static int64_t tctdbgenuidimpl(TCTDB *tdb, int64_t inc);
 static TCLIST *tctdbqrysearchimpl(TDBQRY *qry);
-static TCMAP *tctdbqryidxfetch(TDBQRY *qry, TDBCOND *cond, TDBIDX *idx);
+static TCMAP *tctdbqryidxfetch(TDBQRY *qry, TDBCOND *cond, TDBIDX *idx, int lim);
+static int64_t tctdbqryidxestimate(TDBQRY *qry, TDBCOND *cond, TDBIDX *idx);
+static TCMAP *tctdbqryidxand(TCMAP *amap, TCMAP *bmap);
+static TCLIST *tctdbqrynumranges(TDBCOND *cond, int type);
+static void tctdbqrynumrange(int type, int64_t lower, int64_t upper, char *buf);
+static bool tctdbqrycondretire(TDBCOND *cond, int type);
+static int64_t tctdbqrycompestimate(TDBQRY *qry, TDBIDX *idx, TCXSTR *pxstr, const char *rbuf);
+static int tctdbqrycompplan(TDBQRY *qry, TDBIDX *idx, TDBCOND **uconds, TCXSTR *pxstr,
+                            char *rbuf, bool *rp);
+static TDBIDX *tctdbqryorderidx(TCTDB *tdb, const char *oname, int otype, bool *ascp);
+static TDBQRYCUR *tctdbqrycurnewimpl(TDBQRY *qry, bool order);
+static TDBIDX *tctdbqrycuridx(TDBQRYCUR *cur);
+static void tctdbqryaggrinit(TDBAGGROP *aop, TDBQRY *qry, const char *gname, const char *aname);
+static TDBAGGRST *tctdbqryaggrstate(TDBAGGROP *aop, const char *gbuf, int gsiz);
+static void tctdbqryaggrrow(TDBAGGROP *aop, const char *pkbuf, int pksiz,
+                            const char *cbuf, int csiz);
+static bool tctdbqryaggriter(const void *kbuf, int ksiz, const void *vbuf, int vsiz, void *op);
+static void tctdbqryaggrmerge(TDBAGGROP *aop, TDBAGGROP *sop);
+static uint64_t tctdbqryaggrhash(const char *buf, int size);
+static int64_t tctdbqryaggrdistinct(const uint8_t *regs);
+static TCMAP *tctdbqryrankimpl(TDBQRY *qry, TDBIDX *idx, const char *expr, int max);
+static void tctdbqryrankopen(TDBRANKTERM *term, TDBIDX *idx, const char *word, int wsiz);
+static void tctdbqryrankclose(TDBRANKTERM *term);
+static bool tctdbqryranknext(TDBRANKTERM *term);
+static int tctdbqryrankseek(TDBRANKTERM *term, const TDBQGPOST *post);
+static double tctdbqryrankscore(const TDBRANKTERM *term, int tf, double norm);
+static int tctdbqryrankcmpterm(const TDBRANKTERM *a, const TDBRANKTERM *b);
+static int tctdbqryrankcmprec(const TDBRANKREC *a, const TDBRANKREC *b);
+static void tctdbqryrankheap(TDBRANKREC *recs, int rnum, int ridx);
+static TCLIST *tctdbqrycursegs(TDBCOND *cond, TDBIDX *idx);
+static void tctdbqrycurseek(TDBQRYCUR *cur, TDBIDX *idx, BDBCUR *bcur);
+static int tctdbqrycurcheck(TDBQRYCUR *cur, TDBIDX *idx, const char *kbuf, int ksiz);
+static void *tctdbqrycurnextimpl(TDBQRYCUR *cur, int *sp);
+static void *tctdbqrycurnextidx(TDBQRYCUR *cur, int *sp);
+static void *tctdbqrycurnextscan(TDBQRYCUR *cur, int *sp);
+static bool tctdbqrycurjumpimpl(TDBQRYCUR *cur, const char *pkbuf, int pksiz);
+static TCLIST *tctdbqryscanpar(TDBQRY *qry, TDBCOND *ucond, int max, bool all, TCLIST **svp);
+static bool tctdbqryscaniter(const void *kbuf, int ksiz, const void *vbuf, int vsiz, void *op);
+static bool tctdbqryscanmatch(TDBQRY *qry, TDBCOND *ucond, const char *pkbuf, int pksiz,
+                              const char *cbuf, int csiz);
+static void tctdbqryscansval(TDBQRY *qry, TCLIST *svals, const char *cbuf, int csiz);
 static bool tctdbqryonecondmatch(TDBQRY *qry, TDBCOND *cond, const char *pkbuf, int pksiz);
 static bool tctdbqryallcondmatch(TDBQRY *qry, const char *pkbuf, int pksiz);
+static void tctdbqrycondcompile(TDBCOND *cond);
+static void tctdbqrycondclear(TDBCOND *cond);
 static bool tctdbqrycondmatch(TDBCOND *cond, const char *vbuf, int vsiz);
 static bool tctdbqrycondcheckstrand(const char *tval, const char *oval);
 static bool tctdbqrycondcheckstror(const char *tval, const char *oval);
 static bool tctdbqrycondcheckstroreq(const char *vbuf, const char *expr);
-static bool tctdbqrycondchecknumbt(const char *vbuf, const char *expr);
-static bool tctdbqrycondchecknumoreq(const char *vbuf, const char *expr);
+static bool tctdbqrycondchecknumbt(const char *vbuf, const int64_t *nums);
+static bool tctdbqrycondchecknumoreq(const char *vbuf, const int64_t *nums, int numnum);
 static bool tctdbqrycondcheckfts(const char *vbuf, int vsiz, TDBCOND *cond);
 static int tdbcmppkeynumasc(const TCLISTDATUM *a, const TCLISTDATUM *b);
 static int tdbcmppkeynumdesc(const TCLISTDATUM *a, const TCLISTDATUM *b);
+static int tdbcmpnumasc(const void *a, const void *b);
 static int tdbcmpsortkeystrasc(const TDBSORTKEY *a, const TDBSORTKEY *b);
 static int tdbcmpsortkeystrdesc(const TDBSORTKEY *a, const TDBSORTKEY *b);
 static int tdbcmpsortkeynumasc(const TDBSORTKEY *a, const TDBSORTKEY *b);
 static int tdbcmpsortkeynumdesc(const TDBSORTKEY *a, const TDBSORTKEY *b);
 static uint16_t tctdbidxhash(const char *pkbuf, int pksiz);
+static uint64_t tctdbidxnumenc(int type, const char *str);
+static double tctdbidxnumreal(const char *str);
+static uint64_t tctdbidxnumdouble(double num);
+static void tctdbidxnumkey(uint64_t num, char *buf);
+static void tctdbidxkey(TDBIDX *idx, const char *pkbuf, int pksiz, const char *vbuf, int vsiz,
+                        TCXSTR *xstr);
+static void tctdbidxstatset(TDBIDX *idx);
+static bool tctdbidxstatget(TDBIDX *idx, TDBIDXSTAT *stat);
+static uint64_t tctdbidxstatpos(int type, const char *vbuf, int vsiz);
+static double tctdbidxstatrange(TDBIDXSTAT *stat, uint64_t lower, uint64_t upper);
 static bool tctdbidxput(TCTDB *tdb, const void *pkbuf, int pksiz, TCMAP *cols);
 static bool tctdbidxputone(TCTDB *tdb, TDBIDX *idx, const char *pkbuf, int pksiz, uint16_t hash,
                            const char *vbuf, int vsiz);
@@ -135,10 +333,18 @@ static bool tctdbidxputqgram(TCTDB *tdb, TDBIDX *idx, const char *pkbuf, int pks
 static bool tctdbidxout(TCTDB *tdb, const void *pkbuf, int pksiz, TCMAP *cols);
 static bool tctdbidxoutone(TCTDB *tdb, TDBIDX *idx, const char *pkbuf, int pksiz, uint16_t hash,
                            const char *vbuf, int vsiz);
+static bool tctdbidxoutdup(TCTDB *tdb, TDBIDX *idx, const char *kbuf, int ksiz,
+                           const char *pkbuf, int pksiz);
 static bool tctdbidxouttoken(TCTDB *tdb, TDBIDX *idx, const char *pkbuf, int pksiz,
                              const char *vbuf, int vsiz);
 static bool tctdbidxoutqgram(TCTDB *tdb, TDBIDX *idx, const char *pkbuf, int pksiz,
                              const char *vbuf, int vsiz);
+static bool tctdbidxhascomp(TCTDB *tdb);
+static TCLIST *tctdbidxcompcols(const char *name);
+static bool tctdbidxcompkey(TDBIDX *idx, TCMAP *cols, uint16_t hash, TCXSTR *xstr);
+static bool tctdbidxcomp(TCTDB *tdb, const void *pkbuf, int pksiz, TCMAP *ocols, TCMAP *ncols);
+static bool tctdbidxcompone(TCTDB *tdb, TDBIDX *idx, const char *pkbuf, int pksiz,
+                            TCMAP *ocols, TCMAP *ncols);
 static bool tctdbidxsyncicc(TCTDB *tdb, TDBIDX *idx, bool all);
 static int tctdbidxcmpkey(const char **a, const char **b);
 static TCMAP *tctdbidxgetbytokens(TCTDB *tdb, TDBIDX *idx, const TCLIST *tokens, int op,
@@ -146,11 +352,50 @@ static TCMAP *tctdbidxgetbytokens(TCTDB *tdb, TDBIDX *idx, const TCLIST *tokens,
 static TCMAP *tctdbidxgetbyfts(TCTDB *tdb, TDBIDX *idx, TDBCOND *cond, TCXSTR *hint);
 static void tctdbidxgetbyftsunion(TDBIDX *idx, const TCLIST *tokens, bool sign,
                                   TCMAP *ores, TCMAP *nres, TCXSTR *hint);
-static int tctdbidxftscmpstrocr(TDBFTSSTROCR *a, TDBFTSSTROCR *b);
-static int tctdbidxftscmpnumocr(TDBFTSNUMOCR *a, TDBFTSNUMOCR *b);
+static bool tctdbidxftsmatch(TCMAP *ores, TCMAP *nres, TCMAP *uniq, bool sign,
+                             const char *pkbuf, int pksiz);
+static bool tctdbidxqgpacked(TDBIDX *idx);
+static bool tctdbidxqgpack(TCTDB *tdb, TDBIDX *idx);
+static bool tctdbidxqgblkout(TCTDB *tdb, TDBIDX *idx, const char *token, int tsiz,
+                             int64_t pkid, const char *pkbuf, int pksiz);
+static bool tctdbidxqgdiradd(TCTDB *tdb, TDBIDX *idx, const char *token, int tsiz,
+                             int64_t dnum, int64_t bnum);
+static void tctdbidxqgkey(TCXSTR *xstr, const char *token, int tsiz, const TDBQGPOST *post);
+static int tctdbidxqgcmppost(const TDBQGPOST *a, const TDBQGPOST *b);
+static int tctdbidxqgcmpoff(const int32_t *a, const int32_t *b);
+static void tctdbidxqgaryinit(TDBQGARY *ary);
+static void tctdbidxqgaryclear(TDBQGARY *ary);
+static void tctdbidxqgaryfree(TDBQGARY *ary);
+static void tctdbidxqgaryadd(TDBQGARY *ary, int64_t pkid, const char *pkbuf, int pksiz);
+static void tctdbidxqgaryaddoff(TDBQGARY *ary, int32_t off);
+static void tctdbidxqgarynorm(TDBQGARY *ary);
+static int tctdbidxqgarygallop(const TDBQGARY *ary, int start, const TDBQGPOST *post);
+static bool tctdbidxqgdecraw(TDBQGARY *ary, const char *buf, int size);
+static bool tctdbidxqgdecblock(TDBQGARY *ary, const char *buf, int size);
+static void tctdbidxqgencblock(TCXSTR *xstr, const TDBQGARY *ary, int begin, int end);
+static void tctdbidxqglistopen(TDBQGLIST *list, TDBIDX *idx, const char *token, int pos);
+static void tctdbidxqglistclose(TDBQGLIST *list);
+static bool tctdbidxqglistload(TDBQGLIST *list);
+static bool tctdbidxqglistnext(TDBQGLIST *list);
+static bool tctdbidxqglistseek(TDBQGLIST *list, const TDBQGPOST *post);
+static bool tctdbidxqglisthasoff(const TDBQGLIST *list, int32_t off);
+static TDBQGLIST *tctdbidxqgphraseopen(TDBIDX *idx, const uint16_t *ary, int anum, int *np);
+static int tctdbidxqgphrasecnt(const TDBQGLIST *lists, int lnum, int max);
+static void tctdbidxqgprefix(TDBIDX *idx, const char *word, int wsiz, TDBQGARY *ary,
+                             TCLIST *bufs);
+static bool tctdbidxqgdectoken(TDBQGARY *ary, const char *buf, int size);
+static void tctdbidxqgpostset(TDBQGPOST *post, const char *pkbuf, int pksiz);
+static bool tctdbidxlenput(TCTDB *tdb, TDBIDX *idx, const char *pkbuf, int pksiz, int len);
+static bool tctdbidxlenout(TCTDB *tdb, TDBIDX *idx, const char *pkbuf, int pksiz);
+static int tctdbidxlenget(TDBIDX *idx, const TDBQGPOST *post, TCXSTR *kxstr);
+static bool tctdbidxlenadd(TCTDB *tdb, TDBIDX *idx, int64_t rnum, int64_t tlen);
+static bool tctdbidxlenstat(TDBIDX *idx, int64_t *rnp, int64_t *tlp);
 static TDBFTSUNIT *tctdbftsparseexpr(const char *expr, int esiz, int op, int *np);
 static bool tctdbdefragimpl(TCTDB *tdb, int64_t step);
 static bool tctdbforeachimpl(TCTDB *tdb, TCITER iter, void *op);
+static bool tctdbforeachparimpl(TCTDB *tdb, TCITER iter, void **ops, int tnum,
+                                TCREDUCE reduce, void *rop);
+static bool tctdbforeachiter(const void *kbuf, int ksiz, const void *vbuf, int vsiz, void *op);
 static int tctdbqryprocoutcb(const void *pkbuf, int pksiz, TCMAP *cols, void *op);
 static bool tctdblockmethod(TCTDB *tdb, bool wr);
 static bool tctdbunlockmethod(TCTDB *tdb);
@@ -556,7 +801,7 @@ TCMAP *tctdbiternext3(TCTDB *tdb){
   TCXSTR *vstr = tcxstrnew();
   TCMAP *cols = NULL;
   if(tchdbiternext3(tdb->hdb, kstr, vstr)){
-    cols = tcmapload(TCXSTRPTR(vstr), TCXSTRSIZE(vstr));
+    cols = tctdbrowload(tdb, TCXSTRPTR(vstr), TCXSTRSIZE(vstr));
     tcmapput(cols, "", 0, TCXSTRPTR(kstr), TCXSTRSIZE(kstr));
   }
   tcxstrdel(vstr);
@@ -786,6 +1031,9 @@ uint64_t tctdbfsiz(TCTDB *tdb){
     switch(idx->type){
     case TDBITLEXICAL:
     case TDBITDECIMAL:
+    case TDBITINT64:
+    case TDBITDOUBLE:
+    case TDBITCOMPOSITE:
     case TDBITTOKEN:
     case TDBITQGRAM:
       rv += tcbdbfsiz(idx->db);
@@ -846,6 +1094,7 @@ TDBQRY *tctdbqrynew(TCTDB *tdb){
   qry->skip = 0;
   qry->hint = tcxstrnew3(TDBHINTUSIZ);
   qry->count = 0;
+  qry->plan = NULL;
   return qry;
 }
 
@@ -859,23 +1108,12 @@ void tctdbqrydel(TDBQRY *qry){
   int cnum = qry->cnum;
   for(int i = 0; i < cnum; i++){
     TDBCOND *cond = conds + i;
-    if(cond->ftsunits){
-      TDBFTSUNIT *ftsunits = cond->ftsunits;
-      int ftsnum = cond->ftsnum;
-      for(int j = 0; j < ftsnum; j++){
-        TDBFTSUNIT *ftsunit = ftsunits + j;
-        tclistdel(ftsunit->tokens);
-      }
-      TCFREE(ftsunits);
-    }
-    if(cond->regex){
-      regfree(cond->regex);
-      TCFREE(cond->regex);
-    }
+    tctdbqrycondclear(cond);
     TCFREE(cond->expr);
     TCFREE(cond->name);
   }
   TCFREE(conds);
+  if(qry->plan) TCFREE(qry->plan);
   TCFREE(qry);
 }
 
@@ -905,27 +1143,31 @@ void tctdbqryaddcond(TDBQRY *qry, const char *name, int op, const char *expr){
   cond->noidx = noidx;
   TCMEMDUP(cond->expr, expr, esiz);
   cond->esiz = esiz;
-  cond->regex = NULL;
-  if(op == TDBQCSTRRX){
-    const char *rxstr = expr;
-    int rxopt = REG_EXTENDED | REG_NOSUB;
-    if(*rxstr == '*'){
-      rxopt |= REG_ICASE;
-      rxstr++;
-    }
-    regex_t rxbuf;
-    if(regcomp(&rxbuf, rxstr, rxopt) == 0){
-      TCMALLOC(cond->regex, sizeof(rxbuf));
-      memcpy(cond->regex, &rxbuf, sizeof(rxbuf));
-    }
+  cond->ftsop = op;
+  tctdbqrycondcompile(cond);
+  qry->cnum++;
+  if(qry->plan){
+    TCFREE(qry->plan);
+    qry->plan = NULL;
   }
-  cond->ftsunits = NULL;
-  cond->ftsnum = 0;
-  if(op >= TDBQCFTSPH && op <= TDBQCFTSEX){
-    cond->op = TDBQCFTSPH;
-    cond->ftsunits = tctdbftsparseexpr(expr, esiz, op, &(cond->ftsnum));
+}
+
+
+/* Bind a new operand expression to a condition of a query object. */
+bool tctdbqrybind(TDBQRY *qry, int index, const char *expr){
+  assert(qry && expr);
+  if(index < 0 || index >= qry->cnum){
+    tctdbsetecode(qry->tdb, TCEINVALID, __FILE__, __LINE__, __func__);
+    return false;
   }
-  qry->cnum++;
+  TDBCOND *cond = qry->conds + index;
+  tctdbqrycondclear(cond);
+  TCFREE(cond->expr);
+  int esiz = strlen(expr);
+  TCMEMDUP(cond->expr, expr, esiz);
+  cond->esiz = esiz;
+  tctdbqrycondcompile(cond);
+  return true;
 }
 
 
@@ -1189,6 +1431,199 @@ TCLIST *tctdbmetasearch(TDBQRY **qrys, int num, int type){
 }
 
 
+/* Create a cursor of a query object. */
+TDBQRYCUR *tctdbqrycurnew(TDBQRY *qry){
+  assert(qry);
+  TCTDB *tdb = qry->tdb;
+  if(!TDBLOCKMETHOD(tdb, false)) return NULL;
+  if(!tdb->open){
+    tctdbsetecode(tdb, TCEINVALID, __FILE__, __LINE__, __func__);
+    TDBUNLOCKMETHOD(tdb);
+    return NULL;
+  }
+  TDBQRYCUR *cur = tctdbqrycurnewimpl(qry, true);
+  TDBUNLOCKMETHOD(tdb);
+  return cur;
+}
+
+
+/* Delete a query cursor object. */
+void tctdbqrycurdel(TDBQRYCUR *cur){
+  assert(cur);
+  if(cur->res) tclistdel(cur->res);
+  tcxstrdel(cur->pkey);
+  tcxstrdel(cur->ikey);
+  if(cur->segs) tclistdel(cur->segs);
+  TCFREE(cur->iname);
+  TCFREE(cur);
+}
+
+
+/* Move a query cursor object to the position just after a record. */
+bool tctdbqrycurjump(TDBQRYCUR *cur, const void *pkbuf, int pksiz){
+  assert(cur && pkbuf && pksiz >= 0);
+  TCTDB *tdb = cur->qry->tdb;
+  if(!TDBLOCKMETHOD(tdb, false)) return false;
+  if(!tdb->open){
+    tctdbsetecode(tdb, TCEINVALID, __FILE__, __LINE__, __func__);
+    TDBUNLOCKMETHOD(tdb);
+    return false;
+  }
+  bool rv = tctdbqrycurjumpimpl(cur, pkbuf, pksiz);
+  TDBUNLOCKMETHOD(tdb);
+  return rv;
+}
+
+
+/* Get the primary key of the next record of a query cursor object. */
+void *tctdbqrycurnext(TDBQRYCUR *cur, int *sp){
+  assert(cur && sp);
+  TCTDB *tdb = cur->qry->tdb;
+  if(!TDBLOCKMETHOD(tdb, false)) return NULL;
+  if(!tdb->open){
+    tctdbsetecode(tdb, TCEINVALID, __FILE__, __LINE__, __func__);
+    TDBUNLOCKMETHOD(tdb);
+    return NULL;
+  }
+  void *rv = tctdbqrycurnextimpl(cur, sp);
+  TDBUNLOCKMETHOD(tdb);
+  return rv;
+}
+
+
+/* Get the primary key string of the next record of a query cursor object. */
+char *tctdbqrycurnext2(TDBQRYCUR *cur){
+  assert(cur);
+  int pksiz;
+  return tctdbqrycurnext(cur, &pksiz);
+}
+
+
+/* Aggregate the records corresponding to a query object by groups. */
+TCMAP *tctdbqryaggr(TDBQRY *qry, const char *gname, const char *aname){
+  assert(qry);
+  TCTDB *tdb = qry->tdb;
+  if(!TDBLOCKMETHOD(tdb, false)) return tcmapnew2(1);
+  if(!tdb->open){
+    tctdbsetecode(tdb, TCEINVALID, __FILE__, __LINE__, __func__);
+    TDBUNLOCKMETHOD(tdb);
+    return tcmapnew2(1);
+  }
+  TCHDB *hdb = tdb->hdb;
+  TDBQRYCUR *cur = tctdbqrycurnewimpl(qry, false);
+  TCXSTR *hint = qry->hint;
+  TDBAGGROP aop;
+  tctdbqryaggrinit(&aop, qry, gname, aname);
+  if(cur->mode == TDBCMSCAN && TCUSEPTHREAD && tdb->stnum > 1){
+    int tnum = tdb->stnum;
+    tcxstrprintf(hint, "parallel scanning: %d\n", tnum);
+    TDBAGGROP *aops;
+    TCMALLOC(aops, sizeof(*aops) * tnum);
+    void **ops;
+    TCMALLOC(ops, sizeof(*ops) * tnum);
+    ops[0] = &aop;
+    for(int i = 1; i < tnum; i++){
+      tctdbqryaggrinit(aops + i, qry, gname, aname);
+      ops[i] = aops + i;
+    }
+    if(!tchdbforeachpar(hdb, tctdbqryaggriter, ops, tnum, NULL, NULL))
+      tctdbsetecode(tdb, tchdbecode(hdb), __FILE__, __LINE__, __func__);
+    for(int i = 1; i < tnum; i++){
+      tctdbqryaggrmerge(&aop, aops + i);
+      tcmapdel(aops[i].groups);
+      TCFREE(aops[i].states);
+    }
+    TCFREE(ops);
+    TCFREE(aops);
+  } else if(cur->mode == TDBCMSCAN){
+    char *lkbuf = NULL;
+    int lksiz = 0;
+    char *pkbuf;
+    int pksiz;
+    const char *cbuf;
+    int csiz;
+    while((pkbuf = tchdbgetnext3(hdb, lkbuf, lksiz, &pksiz, &cbuf, &csiz)) != NULL){
+      if(tctdbqryscanmatch(qry, NULL, pkbuf, pksiz, cbuf, csiz))
+        tctdbqryaggrrow(&aop, pkbuf, pksiz, cbuf, csiz);
+      TCFREE(lkbuf);
+      lkbuf = pkbuf;
+      lksiz = pksiz;
+    }
+    TCFREE(lkbuf);
+  } else {
+    cur->skip = 0;
+    cur->left = INT_MAX;
+    char *pkbuf;
+    int pksiz;
+    while((pkbuf = tctdbqrycurnextimpl(cur, &pksiz)) != NULL){
+      int csiz;
+      char *cbuf = tchdbget(hdb, pkbuf, pksiz, &csiz);
+      if(cbuf){
+        tctdbqryaggrrow(&aop, pkbuf, pksiz, cbuf, csiz);
+        TCFREE(cbuf);
+      }
+      TCFREE(pkbuf);
+    }
+  }
+  tctdbqrycurdel(cur);
+  TCMAP *res = tcmapnew2(aop.snum + 1);
+  int64_t count = 0;
+  tcmapiterinit(aop.groups);
+  const char *gbuf;
+  int gsiz;
+  while((gbuf = tcmapiternext(aop.groups, &gsiz)) != NULL){
+    int sidx;
+    int vsiz;
+    memcpy(&sidx, tcmapiterval(gbuf, &vsiz), sizeof(sidx));
+    TDBAGGRST *st = aop.states + sidx;
+    TDBAGGR aggr;
+    aggr.num = st->num;
+    aggr.vnum = st->vnum;
+    aggr.sum = st->sum;
+    aggr.min = st->min;
+    aggr.max = st->max;
+    aggr.dnum = tclmin(tctdbqryaggrdistinct(st->regs), aname ? st->vnum : st->num);
+    tcmapput(res, gbuf, gsiz, &aggr, sizeof(aggr));
+    count += st->num;
+  }
+  tcmapdel(aop.groups);
+  TCFREE(aop.states);
+  tcxstrprintf(hint, "aggregated groups: %d\n", (int)TCMAPRNUM(res));
+  qry->count = tclmin(count, INT_MAX);
+  TDBUNLOCKMETHOD(tdb);
+  return res;
+}
+
+
+
+/* Rank the records corresponding to a query object by the relevance to full-text search words. */
+TCMAP *tctdbqryrank(TDBQRY *qry, const char *name, const char *expr, int max){
+  assert(qry && name && expr);
+  TCTDB *tdb = qry->tdb;
+  if(!TDBLOCKMETHOD(tdb, false)) return tcmapnew2(1);
+  if(!tdb->open){
+    tctdbsetecode(tdb, TCEINVALID, __FILE__, __LINE__, __func__);
+    TDBUNLOCKMETHOD(tdb);
+    return tcmapnew2(1);
+  }
+  TDBIDX *idx = NULL;
+  for(int i = 0; i < tdb->inum; i++){
+    TDBIDX *tidx = tdb->idxs + i;
+    if((tidx->type == TDBITTOKEN || tidx->type == TDBITQGRAM) && !strcmp(tidx->name, name)){
+      idx = tidx;
+      break;
+    }
+  }
+  if(!idx){
+    tctdbsetecode(tdb, TCEINVALID, __FILE__, __LINE__, __func__);
+    TDBUNLOCKMETHOD(tdb);
+    return tcmapnew2(1);
+  }
+  TCMAP *res = tctdbqryrankimpl(qry, idx, expr, max >= 0 ? max : INT_MAX);
+  TDBUNLOCKMETHOD(tdb);
+  return res;
+}
+
 
 /*************************************************************************************************
  * features for experts
@@ -1248,6 +1683,9 @@ bool tctdbmemsync(TCTDB *tdb, bool phys){
     switch(idx->type){
     case TDBITLEXICAL:
     case TDBITDECIMAL:
+    case TDBITINT64:
+    case TDBITDOUBLE:
+    case TDBITCOMPOSITE:
     case TDBITTOKEN:
     case TDBITQGRAM:
       if(!tcbdbmemsync(idx->db, phys)){
@@ -1414,6 +1852,16 @@ bool tctdbsetuidseed(TCTDB *tdb, int64_t seed){
 }
 
 
+/* Set the number of threads of parallel scan of a table database object. */
+bool tctdbsetparallel(TCTDB *tdb, int32_t tnum){
+  assert(tdb);
+  if(!TDBLOCKMETHOD(tdb, true)) return false;
+  tdb->stnum = (tnum > 1) ? tnum : 1;
+  TDBUNLOCKMETHOD(tdb);
+  return true;
+}
+
+
 /* Set the custom codec functions of a table database object. */
 bool tctdbsetcodecfunc(TCTDB *tdb, TCCODEC enc, void *encop, TCCODEC dec, void *decop){
   assert(tdb && enc && dec);
@@ -1549,6 +1997,22 @@ bool tctdbforeach(TCTDB *tdb, TCITER iter, void *op){
 }
 
 
+/* Process each record of a table database object by partitions in parallel. */
+bool tctdbforeachpar(TCTDB *tdb, TCITER iter, void **ops, int tnum, TCREDUCE reduce, void *rop){
+  assert(tdb && iter && ops);
+  if(!TDBLOCKMETHOD(tdb, false)) return false;
+  if(!tdb->open){
+    tctdbsetecode(tdb, TCEINVALID, __FILE__, __LINE__, __func__);
+    TDBUNLOCKMETHOD(tdb);
+    return false;
+  }
+  TDBTHREADYIELD(tdb);
+  bool rv = tctdbforeachparimpl(tdb, iter, ops, tnum, reduce, rop);
+  TDBUNLOCKMETHOD(tdb);
+  return rv;
+}
+
+
 /* Process each record corresponding to a query object with non-atomic fashion. */
 bool tctdbqryproc2(TDBQRY *qry, TDBQRYPROC proc, void *op){
   assert(qry && proc);
@@ -1654,6 +2118,12 @@ int tctdbstrtoindextype(const char *str){
     type = TDBITTOKEN;
   } else if(!tcstricmp(str, "QGR") || !tcstricmp(str, "QGRAM") || !tcstricmp(str, "FTS")){
     type = TDBITQGRAM;
+  } else if(!tcstricmp(str, "I64") || !tcstricmp(str, "INT64") || !tcstricmp(str, "INT")){
+    type = TDBITINT64;
+  } else if(!tcstricmp(str, "DBL") || !tcstricmp(str, "DOUBLE") || !tcstricmp(str, "REAL")){
+    type = TDBITDOUBLE;
+  } else if(!tcstricmp(str, "CMP") || !tcstricmp(str, "COMPOSITE")){
+    type = TDBITCOMPOSITE;
   } else if(!tcstricmp(str, "OPT") || !tcstricmp(str, "OPTIMIZE")){
     type = TDBITOPT;
   } else if(!tcstricmp(str, "VOID") || !tcstricmp(str, "NULL")){
@@ -1862,6 +2332,9 @@ static void tctdbclear(TCTDB *tdb){
   tdb->idxs = NULL;
   tdb->inum = 0;
   tdb->tran = false;
+  tdb->stnum = 1;
+  tdb->cdic = NULL;
+  tdb->cnames = NULL;
 }
 
 
@@ -1915,6 +2388,9 @@ static bool tctdbopenimpl(TCTDB *tdb, const char *path, int omode){
       unlink(TCLISTVALPTR(paths, i));
     }
     tclistdel(paths);
+    char *cpath = tcsprintf("%s%c%s", path, MYEXTCHR, TDBCDICSUFFIX);
+    unlink(cpath);
+    TCFREE(cpath);
   }
   TCLIST *paths = tcglobpat(tpath);
   int pnum = TCLISTNUM(paths);
@@ -1937,7 +2413,8 @@ static bool tctdbopenimpl(TCTDB *tdb, const char *path, int omode){
     *(ep++) = '\0';
     int nsiz;
     char *name = tcurldecode(stem, &nsiz);
-    if(!strcmp(ep, "lex") || !strcmp(ep, "dec") || !strcmp(ep, "tok") || !strcmp(ep, "qgr")){
+    if(!strcmp(ep, "lex") || !strcmp(ep, "dec") || !strcmp(ep, "tok") || !strcmp(ep, "qgr") ||
+       !strcmp(ep, "i64") || !strcmp(ep, "dbl") || !strcmp(ep, "cmp")){
       TCBDB *bdb = tcbdbnew();
       if(dbgfd >= 0) tcbdbsetdbgfd(bdb, dbgfd);
       if(tdb->mmtx) tcbdbsetmutex(bdb);
@@ -1955,13 +2432,22 @@ static bool tctdbopenimpl(TCTDB *tdb, const char *path, int omode){
           idxs[inum].type = TDBITTOKEN;
         } else if(!strcmp(ep, "qgr")){
           idxs[inum].type = TDBITQGRAM;
+        } else if(!strcmp(ep, "i64")){
+          idxs[inum].type = TDBITINT64;
+        } else if(!strcmp(ep, "dbl")){
+          idxs[inum].type = TDBITDOUBLE;
+        } else if(!strcmp(ep, "cmp")){
+          idxs[inum].type = TDBITCOMPOSITE;
         }
         idxs[inum].db = bdb;
         idxs[inum].cc = NULL;
+        idxs[inum].cols = NULL;
         if(idxs[inum].type == TDBITTOKEN){
           idxs[inum].cc = tcmapnew2(TDBIDXICCBNUM);
         } else if(idxs[inum].type == TDBITQGRAM){
           idxs[inum].cc = tcmapnew2(TDBIDXICCBNUM);
+        } else if(idxs[inum].type == TDBITCOMPOSITE){
+          idxs[inum].cols = tctdbidxcompcols(name);
         }
         inum++;
       } else {
@@ -1982,6 +2468,20 @@ static bool tctdbopenimpl(TCTDB *tdb, const char *path, int omode){
   if(hopts & HDBTBZIP) opts |= TDBTBZIP;
   if(hopts & HDBTTCBS) opts |= TDBTTCBS;
   if(hopts & HDBTEXCODEC) opts |= TDBTEXCODEC;
+  char *opq = tchdbopaque(tdb->hdb);
+  bool fresh = false;
+  if((omode & TDBOWRITER) && (tdb->opts & TDBTCOLUMNAR) && tchdbrnum(tdb->hdb) < 1 &&
+     opq[TDBOPQFMTOFF] != TDBRFCOLUMNAR){
+    opq[TDBOPQFMTOFF] = TDBRFCOLUMNAR;
+    fresh = true;
+  }
+  if(opq[TDBOPQFMTOFF] == TDBRFCOLUMNAR){
+    opts |= TDBTCOLUMNAR;
+    if(!tctdbcdicload(tdb) || (fresh && !tctdbcdicsave(tdb, 0))){
+      tctdbcloseimpl(tdb);
+      return false;
+    }
+  }
   tdb->opts = opts;
   tdb->tran = false;
   return true;
@@ -2012,6 +2512,9 @@ static bool tctdbcloseimpl(TCTDB *tdb){
     switch(idx->type){
     case TDBITLEXICAL:
     case TDBITDECIMAL:
+    case TDBITINT64:
+    case TDBITDOUBLE:
+    case TDBITCOMPOSITE:
     case TDBITTOKEN:
     case TDBITQGRAM:
       if(!tcbdbclose(idx->db)){
@@ -2021,9 +2524,18 @@ static bool tctdbcloseimpl(TCTDB *tdb){
       tcbdbdel(idx->db);
       break;
     }
+    if(idx->cols) tclistdel(idx->cols);
     TCFREE(idx->name);
   }
   TCFREE(idxs);
+  if(tdb->cdic){
+    tcmapdel(tdb->cdic);
+    tdb->cdic = NULL;
+  }
+  if(tdb->cnames){
+    tclistdel(tdb->cnames);
+    tdb->cnames = NULL;
+  }
   if(!tchdbclose(tdb->hdb)) err = true;
   tdb->open = false;
   return !err;
@@ -2048,24 +2560,30 @@ static bool tctdbputimpl(TCTDB *tdb, const void *pkbuf, int pksiz, TCMAP *cols,
       TCFREE(obuf);
       return false;
     }
-    TCMAP *ocols = tcmapload(obuf, osiz);
+    TCMAP *ocols = tctdbrowload(tdb, obuf, osiz);
     if(dmode == TDBPDCAT){
       TCMAP *ncols = tcmapnew2(TCMAPRNUM(cols) + 1);
       tcmapiterinit(cols);
       const char *kbuf;
       int ksiz;
+      TCMAP *pcols = tctdbidxhascomp(tdb) ? tcmapdup(ocols) : NULL;
       while((kbuf = tcmapiternext(cols, &ksiz)) != NULL){
         int vsiz;
         const char *vbuf = tcmapiterval(kbuf, &vsiz);
         if(tcmapputkeep(ocols, kbuf, ksiz, vbuf, vsiz)) tcmapput(ncols, kbuf, ksiz, vbuf, vsiz);
       }
       if(!tctdbidxput(tdb, pkbuf, pksiz, ncols)) err = true;
+      if(pcols){
+        if(!tctdbidxcomp(tdb, pkbuf, pksiz, pcols, ocols)) err = true;
+        tcmapdel(pcols);
+      }
       tcmapdel(ncols);
       int csiz;
-      char *cbuf = tcmapdump(ocols, &csiz);
-      if(!tchdbput(tdb->hdb, pkbuf, pksiz, cbuf, csiz)) err = true;
+      char *cbuf = tctdbrowdump(tdb, ocols, &csiz);
+      if(!cbuf || !tchdbput(tdb->hdb, pkbuf, pksiz, cbuf, csiz)) err = true;
       TCFREE(cbuf);
     } else {
+      if(!tctdbidxcomp(tdb, pkbuf, pksiz, ocols, cols)) err = true;
       TCMAP *ncols = tcmapnew2(TCMAPRNUM(cols) + 1);
       tcmapiterinit(cols);
       const char *kbuf;
@@ -2085,17 +2603,18 @@ static bool tctdbputimpl(TCTDB *tdb, const void *pkbuf, int pksiz, TCMAP *cols,
       if(!tctdbidxput(tdb, pkbuf, pksiz, ncols)) err = true;
       tcmapdel(ncols);
       int csiz;
-      char *cbuf = tcmapdump(cols, &csiz);
-      if(!tchdbput(tdb->hdb, pkbuf, pksiz, cbuf, csiz)) err = true;
+      char *cbuf = tctdbrowdump(tdb, cols, &csiz);
+      if(!cbuf || !tchdbput(tdb->hdb, pkbuf, pksiz, cbuf, csiz)) err = true;
       TCFREE(cbuf);
     }
     tcmapdel(ocols);
     TCFREE(obuf);
   } else {
     if(!tctdbidxput(tdb, pkbuf, pksiz, cols)) err = true;
+    if(!tctdbidxcomp(tdb, pkbuf, pksiz, NULL, cols)) err = true;
     int csiz;
-    char *cbuf = tcmapdump(cols, &csiz);
-    if(!tchdbput(tdb->hdb, pkbuf, pksiz, cbuf, csiz)) err = true;
+    char *cbuf = tctdbrowdump(tdb, cols, &csiz);
+    if(!cbuf || !tchdbput(tdb->hdb, pkbuf, pksiz, cbuf, csiz)) err = true;
     TCFREE(cbuf);
   }
   return !err;
@@ -2113,8 +2632,9 @@ static bool tctdboutimpl(TCTDB *tdb, const char *pkbuf, int pksiz){
   char *cbuf = tchdbget(tdb->hdb, pkbuf, pksiz, &csiz);
   if(!cbuf) return false;
   bool err = false;
-  TCMAP *cols = tcmapload(cbuf, csiz);
+  TCMAP *cols = tctdbrowload(tdb, cbuf, csiz);
   if(!tctdbidxout(tdb, pkbuf, pksiz, cols)) err = true;
+  if(!tctdbidxcomp(tdb, pkbuf, pksiz, cols, NULL)) err = true;
   if(!tchdbout(tdb->hdb, pkbuf, pksiz)) err = true;
   tcmapdel(cols);
   TCFREE(cbuf);
@@ -2132,7 +2652,7 @@ static TCMAP *tctdbgetimpl(TCTDB *tdb, const void *pkbuf, int pksiz){
   int csiz;
   char *cbuf = tchdbget(tdb->hdb, pkbuf, pksiz, &csiz);
   if(!cbuf) return NULL;
-  TCMAP *cols = tcmapload(cbuf, csiz);
+  TCMAP *cols = tctdbrowload(tdb, cbuf, csiz);
   TCFREE(cbuf);
   return cols;
 }
@@ -2154,7 +2674,7 @@ static char *tctdbgetonecol(TCTDB *tdb, const void *pkbuf, int pksiz,
   int csiz;
   char *cbuf = tchdbget(tdb->hdb, pkbuf, pksiz, &csiz);
   if(!cbuf) return NULL;
-  void *rv = tcmaploadone(cbuf, csiz, nbuf, nsiz, sp);
+  void *rv = tctdbrowloadone(tdb, cbuf, csiz, nbuf, nsiz, sp);
   TCFREE(cbuf);
   return rv;
 }
@@ -2170,7 +2690,7 @@ static double tctdbaddnumber(TCTDB *tdb, const void *pkbuf, int pksiz, double nu
   assert(tdb && pkbuf && pksiz >= 0);
   int csiz;
   char *cbuf = tchdbget(tdb->hdb, pkbuf, pksiz, &csiz);
-  TCMAP *cols = cbuf ? tcmapload(cbuf, csiz) : tcmapnew2(1);
+  TCMAP *cols = cbuf ? tctdbrowload(tdb, cbuf, csiz) : tcmapnew2(1);
   if(cbuf){
     const char *vbuf = tcmapget2(cols, TDBNUMCNTCOL);
     if(vbuf) num += tcatof(vbuf);
@@ -2196,112 +2716,685 @@ static double tctdbaddnumber(TCTDB *tdb, const void *pkbuf, int pksiz, double nu
 }
 
 
-/* Optimize the file of a table database object.
+/* Load the column dictionary of a table database object.
    `tdb' specifies the table database object.
-   `bnum' specifies the number of elements of the bucket array.
-   `apow' specifies the size of record alignment by power of 2.
-   `fpow' specifies the maximum number of elements of the free block pool by power of 2.
-   `opts' specifies options by bitwise-or.
-   If successful, the return value is true, else, it is false. */
-static bool tctdboptimizeimpl(TCTDB *tdb, int64_t bnum, int8_t apow, int8_t fpow, uint8_t opts){
+   If successful, the return value is true, else, it is false.
+   A name broken by an interrupted appending is discarded, and it is cut off from the file if the
+   database is writable. */
+static bool tctdbcdicload(TCTDB *tdb){
   assert(tdb);
   bool err = false;
-  TCHDB *hdb = tdb->hdb;
-  TDBIDX *idxs = tdb->idxs;
-  int inum = tdb->inum;
-  for(int i = 0; i < inum; i++){
-    TDBIDX *idx = idxs + i;
-    switch(idx->type){
-    case TDBITTOKEN:
-    case TDBITQGRAM:
-      tcmapclear(idx->cc);
-      break;
+  char *path = tcsprintf("%s%c%s", tchdbpath(tdb->hdb), MYEXTCHR, TDBCDICSUFFIX);
+  int size;
+  char *buf = tcreadfile(path, 0, &size);
+  TCLIST *cnames = tclistnew();
+  if(buf){
+    const char *rp = buf;
+    const char *ep = buf + size;
+    while(rp < ep){
+      int nsiz, step;
+      TCREADVNUMBUF(rp, nsiz, step);
+      if(nsiz < 0 || step > ep - rp || nsiz > ep - rp - step) break;
+      rp += step;
+      TCLISTPUSH(cnames, rp, nsiz);
+      rp += nsiz;
+    }
+    if(rp < ep && tdb->wmode && truncate(path, rp - buf) == -1){
+      tctdbsetecode(tdb, TCETRUNC, __FILE__, __LINE__, __func__);
+      err = true;
     }
-  }
-  for(int i = 0; i < inum; i++){
-    TDBIDX *idx = idxs + i;
-    switch(idx->type){
-    case TDBITLEXICAL:
-    case TDBITDECIMAL:
-    case TDBITTOKEN:
-    case TDBITQGRAM:
-      if(!tcbdbvanish(idx->db)){
-        tctdbsetecode(tdb, tcbdbecode(idx->db), __FILE__, __LINE__, __func__);
-        err = true;
-      }
-      break;
+    TCFREE(buf);
+  } else {
+    struct stat sbuf;
+    if(stat(path, &sbuf) == 0){
+      tctdbsetecode(tdb, TCEREAD, __FILE__, __LINE__, __func__);
+      err = true;
     }
   }
-  const char *path = tchdbpath(tdb->hdb);
-  char *tpath = tcsprintf("%s%ctmp%c%llu", path, MYEXTCHR, MYEXTCHR, tchdbinode(tdb->hdb));
-  TCHDB *thdb = tchdbnew();
-  tchdbsettype(thdb, TCDBTTABLE);
-  int dbgfd = tchdbdbgfd(tdb->hdb);
-  if(dbgfd >= 0) tchdbsetdbgfd(thdb, dbgfd);
-  TCCODEC enc, dec;
-  void *encop, *decop;
-  tchdbcodecfunc(hdb, &enc, &encop, &dec, &decop);
-  if(enc && dec) tchdbsetcodecfunc(thdb, enc, encop, dec, decop);
-  if(bnum < 1) bnum = tchdbrnum(hdb) * 2 + 1;
-  if(apow < 0) apow = tclog2l(tchdbalign(hdb));
-  if(fpow < 0) fpow = tclog2l(tchdbfbpmax(hdb));
-  if(opts == UINT8_MAX) opts = tdb->opts;
-  uint8_t hopts = 0;
-  if(opts & TDBTLARGE) hopts |= HDBTLARGE;
-  if(opts & TDBTDEFLATE) hopts |= HDBTDEFLATE;
-  if(opts & TDBTBZIP) hopts |= HDBTBZIP;
-  if(opts & TDBTTCBS) hopts |= HDBTTCBS;
-  if(opts & TDBTEXCODEC) hopts |= HDBTEXCODEC;
-  tchdbtune(thdb, bnum, apow, fpow, hopts);
-  if(tchdbopen(thdb, tpath, HDBOWRITER | HDBOCREAT | HDBOTRUNC)){
-    memcpy(tchdbopaque(thdb), tchdbopaque(hdb), TDBOPAQUESIZ + TDBLEFTOPQSIZ);
-    if(!tchdbiterinit(hdb)) err = true;
-    TCXSTR *kxstr = tcxstrnew();
-    TCXSTR *vxstr = tcxstrnew();
-    while(tchdbiternext3(hdb, kxstr, vxstr)){
-      TCMAP *cols = tcmapload(TCXSTRPTR(vxstr), TCXSTRSIZE(vxstr));
-      if(!tctdbidxput(tdb, TCXSTRPTR(kxstr), TCXSTRSIZE(kxstr), cols)) err = true;
-      tcmapdel(cols);
-      if(!tchdbput(thdb, TCXSTRPTR(kxstr), TCXSTRSIZE(kxstr),
-                   TCXSTRPTR(vxstr), TCXSTRSIZE(vxstr))){
-        tctdbsetecode(tdb, tchdbecode(thdb), __FILE__, __LINE__, __func__);
-        err = true;
-      }
-    }
-    tcxstrdel(vxstr);
-    tcxstrdel(kxstr);
-    if(!tchdbclose(thdb)){
-      tctdbsetecode(tdb, tchdbecode(thdb), __FILE__, __LINE__, __func__);
+  int cnum = TCLISTNUM(cnames);
+  TCMAP *cdic = tcmapnew2(cnum * 2 + 1);
+  for(int i = 0; i < cnum; i++){
+    int nsiz;
+    const char *nbuf = tclistval(cnames, i, &nsiz);
+    int32_t id = i;
+    tcmapputkeep(cdic, nbuf, nsiz, &id, sizeof(id));
+  }
+  if(tdb->cdic) tcmapdel(tdb->cdic);
+  if(tdb->cnames) tclistdel(tdb->cnames);
+  tdb->cdic = cdic;
+  tdb->cnames = cnames;
+  TCFREE(path);
+  return !err;
+}
+
+
+/* Save the column dictionary of a table database object.
+   `tdb' specifies the table database object.
+   `start' specifies the index of the first column name which is not stored in the file.  If it
+   is 0, the whole file is rewritten.
+   If successful, the return value is true, else, it is false.
+   Because new names are appended to the file, the cost of adding a column name does not depend
+   on the size of the dictionary.  The appended names are synchronized with the device before
+   any record refers to them, and the file is cut back to the previous length on failure. */
+static bool tctdbcdicsave(TCTDB *tdb, int start){
+  assert(tdb && tdb->cnames && start >= 0);
+  bool err = false;
+  char *path = tcsprintf("%s%c%s", tchdbpath(tdb->hdb), MYEXTCHR, TDBCDICSUFFIX);
+  if(start > 0){
+    TCLIST *cnames = tdb->cnames;
+    int cnum = TCLISTNUM(cnames);
+    TCXSTR *xstr = tcxstrnew();
+    for(int i = start; i < cnum; i++){
+      int nsiz;
+      const char *nbuf = tclistval(cnames, i, &nsiz);
+      char numbuf[TCNUMBUFSIZ];
+      int step;
+      TCSETVNUMBUF(step, numbuf, nsiz);
+      TCXSTRCAT(xstr, numbuf, step);
+      TCXSTRCAT(xstr, nbuf, nsiz);
+    }
+    int fd = open(path, O_WRONLY | O_CREAT | O_APPEND, TDBCDICMODE);
+    if(fd == -1){
+      tctdbsetecode(tdb, TCEOPEN, __FILE__, __LINE__, __func__);
       err = true;
-    }
-    if(!err){
-      if(unlink(path) == -1){
-        tctdbsetecode(tdb, TCEUNLINK, __FILE__, __LINE__, __func__);
+    } else {
+      off_t osiz = lseek(fd, 0, SEEK_END);
+      if(osiz == -1){
+        tctdbsetecode(tdb, TCESEEK, __FILE__, __LINE__, __func__);
+        err = true;
+      } else if(!tcwrite(fd, TCXSTRPTR(xstr), TCXSTRSIZE(xstr))){
+        tctdbsetecode(tdb, TCEWRITE, __FILE__, __LINE__, __func__);
+        err = true;
+      } else if(fsync(fd) == -1){
+        tctdbsetecode(tdb, TCESYNC, __FILE__, __LINE__, __func__);
         err = true;
       }
-      if(rename(tpath, path) == -1){
-        tctdbsetecode(tdb, TCERENAME, __FILE__, __LINE__, __func__);
+      if(err && osiz != -1 && ftruncate(fd, osiz) == -1){
+        tctdbsetecode(tdb, TCETRUNC, __FILE__, __LINE__, __func__);
+      }
+      if(close(fd) == -1){
+        tctdbsetecode(tdb, TCECLOSE, __FILE__, __LINE__, __func__);
         err = true;
       }
-      char *npath = tcstrdup(path);
-      int omode = (tchdbomode(hdb) & ~HDBOCREAT) & ~HDBOTRUNC;
-      if(!tchdbclose(hdb)) err = true;
-      if(!tchdbopen(hdb, npath, omode)) err = true;
-      TCFREE(npath);
     }
+    tcxstrdel(xstr);
   } else {
-    tctdbsetecode(tdb, tchdbecode(thdb), __FILE__, __LINE__, __func__);
-    err = true;
+    char *tpath = tcsprintf("%s%ctmp", path, MYEXTCHR);
+    int size;
+    char *buf = tclistdump(tdb->cnames, &size);
+    if(!tcwritefile(tpath, buf, size)){
+      tctdbsetecode(tdb, TCEWRITE, __FILE__, __LINE__, __func__);
+      err = true;
+    } else if(rename(tpath, path) == -1){
+      tctdbsetecode(tdb, TCERENAME, __FILE__, __LINE__, __func__);
+      unlink(tpath);
+      err = true;
+    }
+    TCFREE(buf);
+    TCFREE(tpath);
   }
-  tchdbdel(thdb);
-  TCFREE(tpath);
-  for(int i = 0; i < inum; i++){
-    TDBIDX *idx = idxs + i;
-    switch(idx->type){
-    case TDBITTOKEN:
+  TCFREE(path);
+  return !err;
+}
+
+
+/* Serialize the columns of a record of a table database object.
+   `tdb' specifies the table database object.
+   `cols' specifies a map object containing columns.
+   `sp' specifies the pointer to the variable into which the size of the region of the return
+   value is assigned.
+   If successful, the return value is the pointer to the region of the result serial region, else,
+   it is `NULL'. */
+static char *tctdbrowdump(TCTDB *tdb, TCMAP *cols, int *sp){
+  assert(tdb && cols && sp);
+  if(tdb->opts & TDBTCOLUMNAR) return tctdbrowdumpcol(tdb, cols, sp);
+  return tcmapdump(cols, sp);
+}
+
+
+/* Serialize the columns of a record in the columnar format.
+   `tdb' specifies the table database object.
+   `cols' specifies a map object containing columns.
+   `sp' specifies the pointer to the variable into which the size of the region of the return
+   value is assigned.
+   If successful, the return value is the pointer to the region of the result serial region, else,
+   it is `NULL'.  The region begins with the number of entries, the width of each offset, and the
+   offset table.  The dense table has the end offsets of the fields indexed by the column
+   identifiers, where an empty field means that the column is absent.  If the record has only a
+   few of the columns of the dictionary, the sparse table, which has pairs of the identifier and
+   the end offset of each present column in ascending order of the identifiers, is used instead
+   and the width is flagged with `TDBCOLSPARSE'. */
+static char *tctdbrowdumpcol(TCTDB *tdb, TCMAP *cols, int *sp){
+  assert(tdb && tdb->cdic && tdb->cnames && cols && sp);
+  TCMAP *cdic = tdb->cdic;
+  TCLIST *cnames = tdb->cnames;
+  int onum = TCLISTNUM(cnames);
+  int cnum = TCMAPRNUM(cols);
+  TDBCOLFIELD *fields;
+  TCMALLOC(fields, sizeof(*fields) * cnum + 1);
+  int fnum = 0;
+  tcmapiterinit(cols);
+  const char *kbuf;
+  int ksiz;
+  while(fnum < cnum && (kbuf = tcmapiternext(cols, &ksiz)) != NULL){
+    int isiz;
+    const int32_t *ip = tcmapget(cdic, kbuf, ksiz, &isiz);
+    int32_t id;
+    if(ip){
+      id = *ip;
+    } else {
+      id = TCLISTNUM(cnames);
+      TCLISTPUSH(cnames, kbuf, ksiz);
+      tcmapput(cdic, kbuf, ksiz, &id, sizeof(id));
+    }
+    TDBCOLFIELD *field = fields + fnum++;
+    field->id = id;
+    field->vbuf = tcmapiterval(kbuf, &field->vsiz);
+  }
+  if(TCLISTNUM(cnames) > onum && !tctdbcdicsave(tdb, onum)){
+    while(TCLISTNUM(cnames) > onum){
+      int nsiz;
+      char *nbuf = tclistpop(cnames, &nsiz);
+      tcmapout(cdic, nbuf, nsiz);
+      TCFREE(nbuf);
+    }
+    TCFREE(fields);
+    return NULL;
+  }
+  if(fnum > 1) qsort(fields, fnum, sizeof(*fields),
+                     (int (*)(const void *, const void *))tctdbrowcmpfield);
+  int snum = fnum > 0 ? fields[fnum-1].id + 1 : 0;
+  uint32_t *ends;
+  TCMALLOC(ends, sizeof(*ends) * fnum + 1);
+  TCXSTR *dxstr = tcxstrnew();
+  for(int i = 0; i < fnum; i++){
+    TDBCOLFIELD *field = fields + i;
+    char nbuf[TDBCOLNUMBUFSIZ];
+    int nsiz = tctdbrowfieldenc(field->vbuf, field->vsiz, nbuf);
+    if(nsiz > 0){
+      TCXSTRCAT(dxstr, nbuf, nsiz);
+    } else {
+      char tag = TDBCFSTR;
+      TCXSTRCAT(dxstr, &tag, 1);
+      TCXSTRCAT(dxstr, field->vbuf, field->vsiz);
+    }
+    ends[i] = TCXSTRSIZE(dxstr);
+  }
+  int dsiz = TCXSTRSIZE(dxstr);
+  int width = dsiz > UINT16_MAX ? sizeof(uint32_t) : sizeof(uint16_t);
+  int esiz = sizeof(uint32_t) + width;
+  bool sparse = (int64_t)fnum * esiz < (int64_t)snum * width;
+  int tnum = sparse ? fnum : snum;
+  if(!sparse) esiz = width;
+  char *buf;
+  TCMALLOC(buf, sizeof(int) * 2 + 1 + (int64_t)tnum * esiz + dsiz + 1);
+  char *wp = buf;
+  int step;
+  TCSETVNUMBUF(step, wp, tnum);
+  wp += step;
+  *(wp++) = sparse ? width | TDBCOLSPARSE : width;
+  int fidx = 0;
+  for(int i = 0; i < tnum; i++){
+    uint32_t end;
+    if(sparse){
+      uint32_t id = TCHTOIL(fields[i].id);
+      memcpy(wp, &id, sizeof(id));
+      wp += sizeof(id);
+      end = ends[i];
+    } else {
+      if(fidx < fnum && fields[fidx].id == i) fidx++;
+      end = fidx > 0 ? ends[fidx-1] : 0;
+    }
+    if(width == sizeof(uint16_t)){
+      uint16_t num = TCHTOIS(end);
+      memcpy(wp, &num, sizeof(num));
+    } else {
+      uint32_t num = TCHTOIL(end);
+      memcpy(wp, &num, sizeof(num));
+    }
+    wp += width;
+  }
+  memcpy(wp, TCXSTRPTR(dxstr), dsiz);
+  wp += dsiz;
+  tcxstrdel(dxstr);
+  TCFREE(ends);
+  TCFREE(fields);
+  *sp = wp - buf;
+  return buf;
+}
+
+
+/* Compare two fields of the columnar format by the column identifiers.
+   `a' specifies the pointer to one field.
+   `b' specifies the pointer to the other field.
+   The return value is positive if the former is big, negative if the latter is big, 0 if both
+   are equivalent. */
+static int tctdbrowcmpfield(const TDBCOLFIELD *a, const TDBCOLFIELD *b){
+  assert(a && b);
+  return a->id < b->id ? -1 : a->id > b->id;
+}
+
+
+/* Encode a column value into a typed numeric field of the columnar format.
+   `vbuf' specifies the pointer to the region of the value.
+   `vsiz' specifies the size of the region of the value.
+   `buf' specifies the buffer into which the field is written.  It should be more than
+   `TDBCOLNUMBUFSIZ' bytes.
+   The return value is the size of the field, or 0 if the value should be stored as a string.
+   Only canonical decimal notations which can be restored exactly are typed. */
+static int tctdbrowfieldenc(const char *vbuf, int vsiz, char *buf){
+  assert(vbuf && vsiz >= 0 && buf);
+  if(vsiz < 1 || vsiz > TDBCOLNUMMAX) return 0;
+  const char *rp = vbuf;
+  const char *ep = vbuf + vsiz;
+  if(*rp == '-') rp++;
+  int inum = 0;
+  int fnum = -1;
+  while(rp < ep){
+    if(*rp >= '0' && *rp <= '9'){
+      if(fnum < 0){
+        inum++;
+      } else {
+        fnum++;
+      }
+    } else if(*rp == '.' && fnum < 0){
+      fnum = 0;
+    } else {
+      return 0;
+    }
+    rp++;
+  }
+  if(inum < 1) return 0;
+  char tbuf[TDBCOLNUMBUFSIZ];
+  memcpy(tbuf, vbuf, vsiz);
+  tbuf[vsiz] = '\0';
+  char nbuf[TDBCOLNUMBUFSIZ];
+  if(fnum < 0){
+    if(vsiz > TDBCOLNUMMAX - 5) return 0;
+    long long num = tcatoi(tbuf);
+    if(num < -(1LL << 62) || num >= (1LL << 62)) return 0;
+    int len = sprintf(nbuf, "%lld", num);
+    if(len != vsiz || memcmp(nbuf, vbuf, vsiz)) return 0;
+    uint64_t znum = num < 0 ? ((uint64_t)(-(num + 1)) << 1) | 1 : (uint64_t)num << 1;
+    buf[0] = TDBCFINT;
+    int step;
+    TCSETVNUMBUF64(step, buf + 1, znum);
+    return step + 1;
+  }
+  if(fnum < 1 || vsiz + 1 < (int)sizeof(uint64_t) + 2) return 0;
+  double num = strtod(tbuf, NULL);
+  int len = sprintf(nbuf, "%.*f", fnum, num);
+  if(len != vsiz || memcmp(nbuf, vbuf, vsiz)) return 0;
+  buf[0] = TDBCFDBL;
+  buf[1] = fnum;
+  uint64_t bits;
+  memcpy(&bits, &num, sizeof(bits));
+  bits = TCHTOILL(bits);
+  memcpy(buf + 2, &bits, sizeof(bits));
+  return sizeof(bits) + 2;
+}
+
+
+/* Decode a field of the columnar format into a column value.
+   `fbuf' specifies the pointer to the region of the field.
+   `fsiz' specifies the size of the region of the field.
+   `nbuf' specifies the buffer into which a typed numeric value is written.  It should be more
+   than `TDBCOLNUMBUFSIZ' bytes.
+   `sp' specifies the pointer to the variable into which the size of the region of the return
+   value is assigned.
+   If successful, the return value is the pointer to the region of the value, which is either in
+   the field or in the buffer.  `NULL' is returned if the field is broken. */
+static const char *tctdbrowfielddec(const char *fbuf, int fsiz, char *nbuf, int *sp){
+  assert(fbuf && fsiz > 0 && nbuf && sp);
+  switch(*(unsigned char *)fbuf){
+  case TDBCFSTR:
+    *sp = fsiz - 1;
+    return fbuf + 1;
+  case TDBCFINT:
+    if(fsiz > 1){
+      int64_t znum;
+      int step;
+      TCREADVNUMBUF64(fbuf + 1, znum, step);
+      if(step + 1 != fsiz) break;
+      uint64_t unum = znum;
+      long long num = (unum & 1) ? -(long long)(unum >> 1) - 1 : (long long)(unum >> 1);
+      *sp = sprintf(nbuf, "%lld", num);
+      return nbuf;
+    }
+    break;
+  case TDBCFDBL:
+    if(fsiz == sizeof(uint64_t) + 2){
+      int fnum = *(unsigned char *)(fbuf + 1);
+      if(fnum > TDBCOLNUMMAX) break;
+      uint64_t bits;
+      memcpy(&bits, fbuf + 2, sizeof(bits));
+      bits = TCITOHLL(bits);
+      double num;
+      memcpy(&num, &bits, sizeof(num));
+      if(!isfinite(num) || num >= 1e25 || num <= -1e25) break;
+      *sp = sprintf(nbuf, "%.*f", fnum, num);
+      return nbuf;
+    }
+    break;
+  }
+  return NULL;
+}
+
+
+/* Deserialize the columns of a record of a table database object.
+   `tdb' specifies the table database object.
+   `cbuf' specifies the pointer to the region of the serialized columns.
+   `csiz' specifies the size of the region of the serialized columns.
+   The return value is a map object of the columns. */
+static TCMAP *tctdbrowload(TCTDB *tdb, const char *cbuf, int csiz){
+  assert(tdb && cbuf && csiz >= 0);
+  if(!(tdb->opts & TDBTCOLUMNAR)) return tcmapload(cbuf, csiz);
+  TCLIST *cnames = tdb->cnames;
+  int nnum = TCLISTNUM(cnames);
+  int snum, width;
+  bool sparse;
+  int hsiz = tctdbrowhead(cbuf, csiz, &snum, &width, &sparse);
+  if(hsiz < 0) hsiz = 0;
+  int esiz = sizeof(uint32_t) + width;
+  const char *tp = cbuf + hsiz - (int64_t)snum * esiz;
+  TCMAP *cols = tcmapnew2((sparse ? snum : tclmin(snum, nnum)) + 1);
+  for(int i = 0; i < snum; i++){
+    uint32_t id = sparse ? tctdbrowoff(tp + (int64_t)i * esiz, sizeof(uint32_t)) : i;
+    if(id >= (uint32_t)nnum) continue;
+    int fsiz;
+    const char *fbuf = tctdbrowfield(cbuf, csiz, id, &fsiz);
+    if(!fbuf) continue;
+    char nbuf[TDBCOLNUMBUFSIZ];
+    int vsiz;
+    const char *vbuf = tctdbrowfielddec(fbuf, fsiz, nbuf, &vsiz);
+    if(!vbuf) continue;
+    int ksiz;
+    const char *kbuf = tclistval(cnames, id, &ksiz);
+    tcmapput(cols, kbuf, ksiz, vbuf, vsiz);
+  }
+  return cols;
+}
+
+
+/* Deserialize the columns referred by conditions of a record of a table database object.
+   `tdb' specifies the table database object.
+   `cbuf' specifies the pointer to the region of the serialized columns.
+   `csiz' specifies the size of the region of the serialized columns.
+   `conds' specifies the array of the condition objects.
+   `cnum' specifies the number of the condition objects.
+   The return value is a map object of the columns.  Other columns may be also contained. */
+static TCMAP *tctdbrowloadpart(TCTDB *tdb, const char *cbuf, int csiz,
+                               TDBCOND *conds, int cnum){
+  assert(tdb && cbuf && csiz >= 0 && conds && cnum >= 0);
+  if(!(tdb->opts & TDBTCOLUMNAR)) return tcmapload(cbuf, csiz);
+  TCMAP *cdic = tdb->cdic;
+  TCMAP *cols = tcmapnew2(cnum + 1);
+  for(int i = 0; i < cnum; i++){
+    TDBCOND *cond = conds + i;
+    if(cond->nsiz < 1) continue;
+    int isiz;
+    const int32_t *ip = tcmapget(cdic, cond->name, cond->nsiz, &isiz);
+    if(!ip) continue;
+    int fsiz;
+    const char *fbuf = tctdbrowfield(cbuf, csiz, *ip, &fsiz);
+    if(!fbuf) continue;
+    char nbuf[TDBCOLNUMBUFSIZ];
+    int vsiz;
+    const char *vbuf = tctdbrowfielddec(fbuf, fsiz, nbuf, &vsiz);
+    if(vbuf) tcmapputkeep(cols, cond->name, cond->nsiz, vbuf, vsiz);
+  }
+  return cols;
+}
+
+
+/* Extract the value of a column of a serialized record of a table database object.
+   `tdb' specifies the table database object.
+   `cbuf' specifies the pointer to the region of the serialized columns.
+   `csiz' specifies the size of the region of the serialized columns.
+   `nbuf' specifies the pointer to the region of the column name.
+   `nsiz' specifies the size of the region of the column name.
+   `sp' specifies the pointer to the variable into which the size of the region of the return
+   value is assigned.
+   If successful, the return value is the pointer to the region of the value of the column.
+   Because the region of the return value is allocated with the `malloc' call, it should be
+   released with the `free' call when it is no longer in use. */
+static char *tctdbrowloadone(TCTDB *tdb, const char *cbuf, int csiz,
+                             const char *nbuf, int nsiz, int *sp){
+  assert(tdb && cbuf && csiz >= 0 && nbuf && nsiz >= 0 && sp);
+  if(!(tdb->opts & TDBTCOLUMNAR)) return tcmaploadone(cbuf, csiz, nbuf, nsiz, sp);
+  int isiz;
+  const int32_t *ip = tcmapget(tdb->cdic, nbuf, nsiz, &isiz);
+  if(!ip) return NULL;
+  int fsiz;
+  const char *fbuf = tctdbrowfield(cbuf, csiz, *ip, &fsiz);
+  if(!fbuf) return NULL;
+  char numbuf[TDBCOLNUMBUFSIZ];
+  int vsiz;
+  const char *vbuf = tctdbrowfielddec(fbuf, fsiz, numbuf, &vsiz);
+  if(!vbuf) return NULL;
+  char *rv;
+  TCMEMDUP(rv, vbuf, vsiz);
+  *sp = vsiz;
+  return rv;
+}
+
+
+/* Parse the header of a serialized record in the columnar format.
+   `cbuf' specifies the pointer to the region of the serialized columns.
+   `csiz' specifies the size of the region of the serialized columns.
+   `np' specifies the pointer to the variable into which the number of the entries of the offset
+   table is assigned.
+   `wp' specifies the pointer to the variable into which the width of each offset is assigned.
+   `spp' specifies the pointer to the variable into which whether the offset table is sparse is
+   assigned.
+   The return value is the size of the header including the offset table, or -1 if the region is
+   broken. */
+static int tctdbrowhead(const char *cbuf, int csiz, int *np, int *wp, bool *spp){
+  assert(cbuf && csiz >= 0 && np && wp && spp);
+  *np = 0;
+  *wp = 0;
+  *spp = false;
+  if(csiz < 2) return -1;
+  int num, step;
+  TCREADVNUMBUF(cbuf, num, step);
+  if(num < 0 || step >= csiz) return -1;
+  int flags = *(unsigned char *)(cbuf + step);
+  int width = flags & ~TDBCOLSPARSE;
+  if(width != sizeof(uint16_t) && width != sizeof(uint32_t)) return -1;
+  bool sparse = flags & TDBCOLSPARSE;
+  int64_t hsiz = step + 1 + (int64_t)num * (sparse ? sizeof(uint32_t) + width : width);
+  if(hsiz > csiz) return -1;
+  *np = num;
+  *wp = width;
+  *spp = sparse;
+  return hsiz;
+}
+
+
+/* Read a number of an offset table of a serialized record in the columnar format.
+   `rp' specifies the pointer to the region of the number.
+   `width' specifies the width of the number.
+   The return value is the number. */
+static uint32_t tctdbrowoff(const char *rp, int width){
+  assert(rp && width > 0);
+  if(width == sizeof(uint16_t)){
+    uint16_t num;
+    memcpy(&num, rp, sizeof(num));
+    return TCITOHS(num);
+  }
+  uint32_t num;
+  memcpy(&num, rp, sizeof(num));
+  return TCITOHL(num);
+}
+
+
+/* Locate a field of a serialized record in the columnar format.
+   `cbuf' specifies the pointer to the region of the serialized columns.
+   `csiz' specifies the size of the region of the serialized columns.
+   `id' specifies the identifier of the column.
+   `sp' specifies the pointer to the variable into which the size of the region of the return
+   value is assigned.
+   If successful, the return value is the pointer to the region of the field.  `NULL' is returned
+   if the column is absent.  The sparse offset table is searched by binary search. */
+static const char *tctdbrowfield(const char *cbuf, int csiz, int id, int *sp){
+  assert(cbuf && csiz >= 0 && id >= 0 && sp);
+  int num, width;
+  bool sparse;
+  int hsiz = tctdbrowhead(cbuf, csiz, &num, &width, &sparse);
+  if(hsiz < 0) return NULL;
+  int esiz = sparse ? sizeof(uint32_t) + width : width;
+  const char *tp = cbuf + hsiz - (int64_t)num * esiz;
+  int idx = id;
+  if(sparse){
+    int lo = 0;
+    int hi = num;
+    while(lo < hi){
+      int mid = lo + (hi - lo) / 2;
+      if(tctdbrowoff(tp + (int64_t)mid * esiz, sizeof(uint32_t)) < (uint32_t)id){
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    if(lo >= num || tctdbrowoff(tp + (int64_t)lo * esiz, sizeof(uint32_t)) != (uint32_t)id)
+      return NULL;
+    idx = lo;
+    tp += sizeof(uint32_t);
+  } else if(id >= num){
+    return NULL;
+  }
+  uint32_t beg = idx > 0 ? tctdbrowoff(tp + (int64_t)(idx - 1) * esiz, width) : 0;
+  uint32_t end = tctdbrowoff(tp + (int64_t)idx * esiz, width);
+  if(beg >= end || end > csiz - hsiz) return NULL;
+  *sp = end - beg;
+  return cbuf + hsiz + beg;
+}
+
+
+/* Optimize the file of a table database object.
+   `tdb' specifies the table database object.
+   `bnum' specifies the number of elements of the bucket array.
+   `apow' specifies the size of record alignment by power of 2.
+   `fpow' specifies the maximum number of elements of the free block pool by power of 2.
+   `opts' specifies options by bitwise-or.
+   If successful, the return value is true, else, it is false. */
+static bool tctdboptimizeimpl(TCTDB *tdb, int64_t bnum, int8_t apow, int8_t fpow, uint8_t opts){
+  assert(tdb);
+  bool err = false;
+  TCHDB *hdb = tdb->hdb;
+  TDBIDX *idxs = tdb->idxs;
+  int inum = tdb->inum;
+  for(int i = 0; i < inum; i++){
+    TDBIDX *idx = idxs + i;
+    switch(idx->type){
+    case TDBITTOKEN:
+    case TDBITQGRAM:
+      tcmapclear(idx->cc);
+      break;
+    }
+  }
+  for(int i = 0; i < inum; i++){
+    TDBIDX *idx = idxs + i;
+    switch(idx->type){
+    case TDBITLEXICAL:
+    case TDBITDECIMAL:
+    case TDBITINT64:
+    case TDBITDOUBLE:
+    case TDBITCOMPOSITE:
+    case TDBITTOKEN:
     case TDBITQGRAM:
+      if(!tcbdbvanish(idx->db)){
+        tctdbsetecode(tdb, tcbdbecode(idx->db), __FILE__, __LINE__, __func__);
+        err = true;
+      }
+      break;
+    }
+  }
+  const char *path = tchdbpath(tdb->hdb);
+  char *tpath = tcsprintf("%s%ctmp%c%llu", path, MYEXTCHR, MYEXTCHR, tchdbinode(tdb->hdb));
+  TCHDB *thdb = tchdbnew();
+  tchdbsettype(thdb, TCDBTTABLE);
+  int dbgfd = tchdbdbgfd(tdb->hdb);
+  if(dbgfd >= 0) tchdbsetdbgfd(thdb, dbgfd);
+  TCCODEC enc, dec;
+  void *encop, *decop;
+  tchdbcodecfunc(hdb, &enc, &encop, &dec, &decop);
+  if(enc && dec) tchdbsetcodecfunc(thdb, enc, encop, dec, decop);
+  if(bnum < 1) bnum = tchdbrnum(hdb) * 2 + 1;
+  if(apow < 0) apow = tclog2l(tchdbalign(hdb));
+  if(fpow < 0) fpow = tclog2l(tchdbfbpmax(hdb));
+  if(opts == UINT8_MAX) opts = tdb->opts;
+  uint8_t hopts = 0;
+  if(opts & TDBTLARGE) hopts |= HDBTLARGE;
+  if(opts & TDBTDEFLATE) hopts |= HDBTDEFLATE;
+  if(opts & TDBTBZIP) hopts |= HDBTBZIP;
+  if(opts & TDBTTCBS) hopts |= HDBTTCBS;
+  if(opts & TDBTEXCODEC) hopts |= HDBTEXCODEC;
+  tchdbtune(thdb, bnum, apow, fpow, hopts);
+  bool conv = (opts & TDBTCOLUMNAR) != (tdb->opts & TDBTCOLUMNAR);
+  if(conv && (opts & TDBTCOLUMNAR) && !tdb->cdic && !tctdbcdicload(tdb)) err = true;
+  if(!err && tchdbopen(thdb, tpath, HDBOWRITER | HDBOCREAT | HDBOTRUNC)){
+    char *opq = tchdbopaque(thdb);
+    memcpy(opq, tchdbopaque(hdb), TDBOPAQUESIZ + TDBLEFTOPQSIZ);
+    opq[TDBOPQFMTOFF] = (opts & TDBTCOLUMNAR) ? TDBRFCOLUMNAR : TDBRFMAP;
+    if(!tchdbiterinit(hdb)) err = true;
+    TCXSTR *kxstr = tcxstrnew();
+    TCXSTR *vxstr = tcxstrnew();
+    while(tchdbiternext3(hdb, kxstr, vxstr)){
+      TCMAP *cols = tctdbrowload(tdb, TCXSTRPTR(vxstr), TCXSTRSIZE(vxstr));
+      if(!tctdbidxput(tdb, TCXSTRPTR(kxstr), TCXSTRSIZE(kxstr), cols)) err = true;
+      if(!tctdbidxcomp(tdb, TCXSTRPTR(kxstr), TCXSTRSIZE(kxstr), NULL, cols)) err = true;
+      int csiz = TCXSTRSIZE(vxstr);
+      char *cbuf = NULL;
+      if(conv){
+        cbuf = (opts & TDBTCOLUMNAR) ? tctdbrowdumpcol(tdb, cols, &csiz) : tcmapdump(cols, &csiz);
+        if(!cbuf) err = true;
+      }
+      tcmapdel(cols);
+      if((!conv || cbuf) && !tchdbput(thdb, TCXSTRPTR(kxstr), TCXSTRSIZE(kxstr),
+                                      cbuf ? cbuf : TCXSTRPTR(vxstr), csiz)){
+        tctdbsetecode(tdb, tchdbecode(thdb), __FILE__, __LINE__, __func__);
+        err = true;
+      }
+      TCFREE(cbuf);
+    }
+    tcxstrdel(vxstr);
+    tcxstrdel(kxstr);
+    if(!tchdbclose(thdb)){
+      tctdbsetecode(tdb, tchdbecode(thdb), __FILE__, __LINE__, __func__);
+      err = true;
+    }
+    if(!err){
+      if(unlink(path) == -1){
+        tctdbsetecode(tdb, TCEUNLINK, __FILE__, __LINE__, __func__);
+        err = true;
+      }
+      if(rename(tpath, path) == -1){
+        tctdbsetecode(tdb, TCERENAME, __FILE__, __LINE__, __func__);
+        err = true;
+      }
+      char *npath = tcstrdup(path);
+      int omode = (tchdbomode(hdb) & ~HDBOCREAT) & ~HDBOTRUNC;
+      if(!tchdbclose(hdb)) err = true;
+      if(!tchdbopen(hdb, npath, omode)) err = true;
+      TCFREE(npath);
+      tdb->opts = (tdb->opts & ~TDBTCOLUMNAR) | (opts & TDBTCOLUMNAR);
+    }
+  } else if(!err){
+    tctdbsetecode(tdb, tchdbecode(thdb), __FILE__, __LINE__, __func__);
+    err = true;
+  }
+  tchdbdel(thdb);
+  TCFREE(tpath);
+  for(int i = 0; i < inum; i++){
+    TDBIDX *idx = idxs + i;
+    switch(idx->type){
+    case TDBITTOKEN:
       if(!tctdbidxsyncicc(tdb, idx, true)) err = true;
       break;
+    case TDBITQGRAM:
+      if(!tctdbidxqgpack(tdb, idx)) err = true;
+      break;
     }
   }
   for(int i = 0; i < inum; i++){
@@ -2309,6 +3402,9 @@ static bool tctdboptimizeimpl(TCTDB *tdb, int64_t bnum, int8_t apow, int8_t fpow
     switch(idx->type){
     case TDBITLEXICAL:
     case TDBITDECIMAL:
+    case TDBITINT64:
+    case TDBITDOUBLE:
+    case TDBITCOMPOSITE:
     case TDBITTOKEN:
     case TDBITQGRAM:
       if(!tcbdboptimize(idx->db, -1, -1, -1, -1, -1, UINT8_MAX)){
@@ -2317,6 +3413,7 @@ static bool tctdboptimizeimpl(TCTDB *tdb, int64_t bnum, int8_t apow, int8_t fpow
       }
       break;
     }
+    if(!err) tctdbidxstatset(idx);
   }
   return !err;
 }
@@ -2329,6 +3426,7 @@ static bool tctdbvanishimpl(TCTDB *tdb){
   assert(tdb);
   bool err = false;
   if(!tchdbvanish(tdb->hdb)) err = true;
+  if(tdb->opts & TDBTCOLUMNAR) tchdbopaque(tdb->hdb)[TDBOPQFMTOFF] = TDBRFCOLUMNAR;
   TDBIDX *idxs = tdb->idxs;
   int inum = tdb->inum;
   for(int i = 0; i < inum; i++){
@@ -2345,6 +3443,9 @@ static bool tctdbvanishimpl(TCTDB *tdb){
     switch(idx->type){
     case TDBITLEXICAL:
     case TDBITDECIMAL:
+    case TDBITINT64:
+    case TDBITDOUBLE:
+    case TDBITCOMPOSITE:
     case TDBITTOKEN:
     case TDBITQGRAM:
       if(!tcbdbvanish(idx->db)){
@@ -2367,6 +3468,16 @@ static bool tctdbcopyimpl(TCTDB *tdb, const char *path){
   bool err = false;
   if(!tchdbcopy(tdb->hdb, path)) err = true;
   const char *opath = tchdbpath(tdb->hdb);
+  if(tdb->cnames && *path != '@'){
+    char *cpath = tcsprintf("%s%c%s", opath, MYEXTCHR, TDBCDICSUFFIX);
+    char *tpath = tcsprintf("%s%c%s", path, MYEXTCHR, TDBCDICSUFFIX);
+    if(!tccopyfile(cpath, tpath)){
+      tctdbsetecode(tdb, TCEMISC, __FILE__, __LINE__, __func__);
+      err = true;
+    }
+    TCFREE(tpath);
+    TCFREE(cpath);
+  }
   TDBIDX *idxs = tdb->idxs;
   int inum = tdb->inum;
   for(int i = 0; i < inum; i++){
@@ -2384,6 +3495,9 @@ static bool tctdbcopyimpl(TCTDB *tdb, const char *path){
     switch(idx->type){
     case TDBITLEXICAL:
     case TDBITDECIMAL:
+    case TDBITINT64:
+    case TDBITDOUBLE:
+    case TDBITCOMPOSITE:
     case TDBITTOKEN:
     case TDBITQGRAM:
       if(*path == '@'){
@@ -2436,6 +3550,9 @@ static bool tctdbtranbeginimpl(TCTDB *tdb){
     switch(idx->type){
     case TDBITLEXICAL:
     case TDBITDECIMAL:
+    case TDBITINT64:
+    case TDBITDOUBLE:
+    case TDBITCOMPOSITE:
     case TDBITTOKEN:
     case TDBITQGRAM:
       if(!tcbdbtranbegin(idx->db)){
@@ -2473,6 +3590,9 @@ static bool tctdbtrancommitimpl(TCTDB *tdb){
     switch(idx->type){
     case TDBITLEXICAL:
     case TDBITDECIMAL:
+    case TDBITINT64:
+    case TDBITDOUBLE:
+    case TDBITCOMPOSITE:
     case TDBITTOKEN:
     case TDBITQGRAM:
       if(!tcbdbtrancommit(idx->db)){
@@ -2509,6 +3629,9 @@ static bool tctdbtranabortimpl(TCTDB *tdb){
     switch(idx->type){
     case TDBITLEXICAL:
     case TDBITDECIMAL:
+    case TDBITINT64:
+    case TDBITDOUBLE:
+    case TDBITCOMPOSITE:
     case TDBITTOKEN:
     case TDBITQGRAM:
       if(!tcbdbtranabort(idx->db)){
@@ -2536,6 +3659,7 @@ static bool tctdbsetindeximpl(TCTDB *tdb, const char *name, int type){
     keep = true;
   }
   bool done = false;
+  TCBDB *sdb = NULL;
   TDBIDX *idxs = tdb->idxs;
   int inum = tdb->inum;
   for(int i = 0; i < inum; i++){
@@ -2549,13 +3673,18 @@ static bool tctdbsetindeximpl(TCTDB *tdb, const char *name, int type){
       if(type == TDBITOPT){
         switch(idx->type){
         case TDBITTOKEN:
-        case TDBITQGRAM:
           if(!tctdbidxsyncicc(tdb, idx, true)) err = true;
           break;
+        case TDBITQGRAM:
+          if(!tctdbidxqgpack(tdb, idx)) err = true;
+          break;
         }
         switch(idx->type){
         case TDBITLEXICAL:
         case TDBITDECIMAL:
+        case TDBITINT64:
+        case TDBITDOUBLE:
+        case TDBITCOMPOSITE:
         case TDBITTOKEN:
         case TDBITQGRAM:
           if(!tcbdboptimize(idx->db, -1, -1, -1, -1, -1, UINT8_MAX)){
@@ -2564,6 +3693,7 @@ static bool tctdbsetindeximpl(TCTDB *tdb, const char *name, int type){
           }
           break;
         }
+        if(!err) tctdbidxstatset(idx);
         done = true;
         break;
       }
@@ -2573,19 +3703,27 @@ static bool tctdbsetindeximpl(TCTDB *tdb, const char *name, int type){
         tcmapdel(idx->cc);
         break;
       }
-      switch(idx->type){
-      case TDBITLEXICAL:
-      case TDBITDECIMAL:
-      case TDBITTOKEN:
-      case TDBITQGRAM:
-        path = tcbdbpath(idx->db);
-        if(path && unlink(path)){
-          tctdbsetecode(tdb, TCEUNLINK, __FILE__, __LINE__, __func__);
-          err = true;
+      if(idx->type == TDBITDECIMAL && (type == TDBITINT64 || type == TDBITDOUBLE)){
+        sdb = idx->db;
+      } else {
+        switch(idx->type){
+        case TDBITLEXICAL:
+        case TDBITDECIMAL:
+        case TDBITINT64:
+        case TDBITDOUBLE:
+        case TDBITCOMPOSITE:
+        case TDBITTOKEN:
+        case TDBITQGRAM:
+          path = tcbdbpath(idx->db);
+          if(path && unlink(path)){
+            tctdbsetecode(tdb, TCEUNLINK, __FILE__, __LINE__, __func__);
+            err = true;
+          }
+          tcbdbdel(idx->db);
+          break;
         }
-        tcbdbdel(idx->db);
-        break;
       }
+      if(idx->cols) tclistdel(idx->cols);
       TCFREE(idx->name);
       tdb->inum--;
       inum = tdb->inum;
@@ -2605,6 +3743,7 @@ static bool tctdbsetindeximpl(TCTDB *tdb, const char *name, int type){
   tcxstrprintf(pbuf, "%s%c%s%c%?", tchdbpath(tdb->hdb), MYEXTCHR, TDBIDXSUFFIX, MYEXTCHR, name);
   TCREALLOC(tdb->idxs, tdb->idxs, sizeof(tdb->idxs[0]) * (inum + 1));
   TDBIDX *idx = tdb->idxs + inum;
+  idx->cols = NULL;
   int homode = tchdbomode(tdb->hdb);
   int bomode = BDBOWRITER | BDBOCREAT | BDBOTRUNC;
   if(homode & HDBONOLCK) bomode |= BDBONOLCK;
@@ -2661,6 +3800,49 @@ static bool tctdbsetindeximpl(TCTDB *tdb, const char *name, int type){
     }
     tdb->inum++;
     break;
+  case TDBITINT64:
+  case TDBITDOUBLE:
+    idx->db = tcbdbnew();
+    idx->name = tcstrdup(name);
+    tcxstrprintf(pbuf, "%c%s", MYEXTCHR, type == TDBITINT64 ? "i64" : "dbl");
+    if(dbgfd >= 0) tcbdbsetdbgfd(idx->db, dbgfd);
+    if(tdb->mmtx) tcbdbsetmutex(idx->db);
+    if(enc && dec) tcbdbsetcodecfunc(idx->db, enc, encop, dec, decop);
+    tcbdbtune(idx->db, TDBIDXLMEMB, TDBIDXNMEMB, bbnum, -1, -1, bopts);
+    tcbdbsetcache(idx->db, tdb->lcnum, tdb->ncnum);
+    tcbdbsetxmsiz(idx->db, bxmsiz);
+    tcbdbsetdfunit(idx->db, tchdbdfunit(tdb->hdb));
+    tcbdbsetlsmax(idx->db, TDBIDXLSMAX);
+    if(!tcbdbopen(idx->db, TCXSTRPTR(pbuf), bomode)){
+      tctdbsetecode(tdb, tcbdbecode(idx->db), __FILE__, __LINE__, __func__);
+      err = true;
+    }
+    tdb->inum++;
+    break;
+  case TDBITCOMPOSITE:
+    idx->cols = tctdbidxcompcols(name);
+    if(!idx->cols){
+      tctdbsetecode(tdb, TCEINVALID, __FILE__, __LINE__, __func__);
+      err = true;
+      break;
+    }
+    idx->db = tcbdbnew();
+    idx->name = tcstrdup(name);
+    tcxstrprintf(pbuf, "%ccmp", MYEXTCHR);
+    if(dbgfd >= 0) tcbdbsetdbgfd(idx->db, dbgfd);
+    if(tdb->mmtx) tcbdbsetmutex(idx->db);
+    if(enc && dec) tcbdbsetcodecfunc(idx->db, enc, encop, dec, decop);
+    tcbdbtune(idx->db, TDBIDXLMEMB, TDBIDXNMEMB, bbnum, -1, -1, bopts);
+    tcbdbsetcache(idx->db, tdb->lcnum, tdb->ncnum);
+    tcbdbsetxmsiz(idx->db, bxmsiz);
+    tcbdbsetdfunit(idx->db, tchdbdfunit(tdb->hdb));
+    tcbdbsetlsmax(idx->db, TDBIDXLSMAX);
+    if(!tcbdbopen(idx->db, TCXSTRPTR(pbuf), bomode)){
+      tctdbsetecode(tdb, tcbdbecode(idx->db), __FILE__, __LINE__, __func__);
+      err = true;
+    }
+    tdb->inum++;
+    break;
   case TDBITTOKEN:
     idx->db = tcbdbnew();
     idx->cc = tcmapnew2(TDBIDXICCBNUM);
@@ -2705,15 +3887,38 @@ static bool tctdbsetindeximpl(TCTDB *tdb, const char *name, int type){
     break;
   }
   idx->type = type;
-  if(!err){
-    TCHDB *hdb = tdb->hdb;
-    if(!tchdbiterinit(hdb)) err = true;
-    void *db = idx->db;
-    TCXSTR *kxstr = tcxstrnew();
-    TCXSTR *vxstr = tcxstrnew();
-    int nsiz = strlen(name);
+  if(!err && sdb){
+    BDBCUR *cur = tcbdbcurnew(sdb);
+    tcbdbcurfirst(cur);
+    const char *kbuf;
+    int ksiz;
+    while((kbuf = tcbdbcurkey3(cur, &ksiz)) != NULL){
+      int vsiz;
+      const char *vbuf = tcbdbcurval3(cur, &vsiz);
+      if(*name == '\0'){
+        uint16_t hash = tctdbidxhash(vbuf, vsiz);
+        if(!tctdbidxputone(tdb, idx, vbuf, vsiz, hash, vbuf, vsiz)) err = true;
+      } else if(ksiz > 3){
+        uint16_t hash = ((uint8_t *)kbuf)[ksiz-2] << 8 | ((uint8_t *)kbuf)[ksiz-1];
+        if(!tctdbidxputone(tdb, idx, vbuf, vsiz, hash, kbuf, ksiz - 3)) err = true;
+      }
+      tcbdbcurnext(cur);
+    }
+    tcbdbcurdel(cur);
+  } else if(!err){
+    TCHDB *hdb = tdb->hdb;
+    if(!tchdbiterinit(hdb)) err = true;
+    void *db = idx->db;
+    TCXSTR *kxstr = tcxstrnew();
+    TCXSTR *vxstr = tcxstrnew();
+    int nsiz = strlen(name);
     while(tchdbiternext3(hdb, kxstr, vxstr)){
-      if(nsiz < 1){
+      if(type == TDBITCOMPOSITE){
+        TCMAP *cols = tctdbrowload(tdb, TCXSTRPTR(vxstr), TCXSTRSIZE(vxstr));
+        if(!tctdbidxcompone(tdb, idx, TCXSTRPTR(kxstr), TCXSTRSIZE(kxstr), NULL, cols))
+          err = true;
+        tcmapdel(cols);
+      } else if(nsiz < 1){
         const char *pkbuf = TCXSTRPTR(kxstr);
         int pksiz = TCXSTRSIZE(kxstr);
         switch(type){
@@ -2724,6 +3929,11 @@ static bool tctdbsetindeximpl(TCTDB *tdb, const char *name, int type){
             err = true;
           }
           break;
+        case TDBITINT64:
+        case TDBITDOUBLE:
+          if(!tctdbidxputone(tdb, idx, pkbuf, pksiz, tctdbidxhash(pkbuf, pksiz), pkbuf, pksiz))
+            err = true;
+          break;
         case TDBITTOKEN:
           if(!tctdbidxputtoken(tdb, idx, pkbuf, pksiz, pkbuf, pksiz)) err = true;
           break;
@@ -2736,11 +3946,14 @@ static bool tctdbsetindeximpl(TCTDB *tdb, const char *name, int type){
         int pksiz = TCXSTRSIZE(kxstr);
         uint16_t hash = tctdbidxhash(pkbuf, pksiz);
         int vsiz;
-        char *vbuf = tcmaploadone(TCXSTRPTR(vxstr), TCXSTRSIZE(vxstr), name, nsiz, &vsiz);
+        char *vbuf = tctdbrowloadone(tdb, TCXSTRPTR(vxstr), TCXSTRSIZE(vxstr),
+                                     name, nsiz, &vsiz);
         if(vbuf){
           switch(type){
           case TDBITLEXICAL:
           case TDBITDECIMAL:
+          case TDBITINT64:
+          case TDBITDOUBLE:
             if(!tctdbidxputone(tdb, idx, pkbuf, pksiz, hash, vbuf, vsiz)) err = true;
             break;
           case TDBITTOKEN:
@@ -2757,6 +3970,16 @@ static bool tctdbsetindeximpl(TCTDB *tdb, const char *name, int type){
     tcxstrdel(vxstr);
     tcxstrdel(kxstr);
   }
+  if(!err && type == TDBITQGRAM && !tctdbidxqgpack(tdb, idx)) err = true;
+  if(!err) tctdbidxstatset(idx);
+  if(sdb){
+    const char *path = tcbdbpath(sdb);
+    if(!err && path && unlink(path)){
+      tctdbsetecode(tdb, TCEUNLINK, __FILE__, __LINE__, __func__);
+      err = true;
+    }
+    tcbdbdel(sdb);
+  }
   tcxstrdel(pbuf);
   return !err;
 }
@@ -2801,6 +4024,7 @@ static TCLIST *tctdbqrysearchimpl(TDBQRY *qry){
   int otype = qry->otype;
   TCXSTR *hint = qry->hint;
   TCLIST *res = NULL;
+  TCLIST *svals = NULL;
   for(int i = 0; i < cnum; i++){
     TDBCOND *cond = conds + i;
     cond->alive = true;
@@ -2809,10 +4033,15 @@ static TCLIST *tctdbqrysearchimpl(TDBQRY *qry){
   bool isord = oname != NULL;
   TDBCOND *mcond = NULL;
   TDBIDX *midx = NULL;
-  TDBCOND *ncond = NULL;
-  TDBIDX *nidx = NULL;
   TDBCOND *scond = NULL;
   TDBIDX *sidx = NULL;
+  TDBCOND **pconds;
+  TCMALLOC(pconds, sizeof(*pconds) * cnum + 1);
+  TDBIDX **pidxs;
+  TCMALLOC(pidxs, sizeof(*pidxs) * cnum + 1);
+  int pnum = 0;
+  int nnum = 0;
+  int64_t mest = -1;
   for(int i = 0; i < cnum; i++){
     TDBCOND *cond = conds + i;
     if(!cond->sign || cond->noidx) continue;
@@ -2825,13 +4054,8 @@ static TCLIST *tctdbqrysearchimpl(TDBQRY *qry){
           case TDBQCSTREQ:
           case TDBQCSTRBW:
           case TDBQCSTROREQ:
-            if(!mcond){
-              mcond = cond;
-              midx = idx;
-            } else if(!ncond){
-              ncond = cond;
-              nidx = idx;
-            }
+            pconds[pnum] = cond;
+            pidxs[pnum++] = idx;
             break;
           default:
             if(!scond){
@@ -2850,13 +4074,8 @@ static TCLIST *tctdbqrysearchimpl(TDBQRY *qry){
           case TDBQCNUMLE:
           case TDBQCNUMBT:
           case TDBQCNUMOREQ:
-            if(!mcond){
-              mcond = cond;
-              midx = idx;
-            } else if(!ncond){
-              ncond = cond;
-              nidx = idx;
-            }
+            pconds[pnum] = cond;
+            pidxs[pnum++] = idx;
             break;
           default:
             if(!scond){
@@ -2866,30 +4085,35 @@ static TCLIST *tctdbqrysearchimpl(TDBQRY *qry){
             break;
           }
           break;
+        case TDBITINT64:
+        case TDBITDOUBLE:
+          switch(cond->op){
+          case TDBQCNUMEQ:
+          case TDBQCNUMGT:
+          case TDBQCNUMGE:
+          case TDBQCNUMLT:
+          case TDBQCNUMLE:
+          case TDBQCNUMBT:
+          case TDBQCNUMOREQ:
+            pconds[pnum] = cond;
+            pidxs[pnum++] = idx;
+            break;
+          }
+          break;
         case TDBITTOKEN:
           switch(cond->op){
           case TDBQCSTRAND:
           case TDBQCSTROR:
-            if(!mcond){
-              mcond = cond;
-              midx = idx;
-            } else if(!ncond){
-              ncond = cond;
-              nidx = idx;
-            }
+            pconds[pnum] = cond;
+            pidxs[pnum++] = idx;
             break;
           }
           break;
         case TDBITQGRAM:
           switch(cond->op){
           case TDBQCFTSPH:
-            if(!mcond){
-              mcond = cond;
-              midx = idx;
-            } else if(!ncond){
-              ncond = cond;
-              nidx = idx;
-            }
+            pconds[pnum] = cond;
+            pidxs[pnum++] = idx;
             break;
           }
           break;
@@ -2897,15 +4121,180 @@ static TCLIST *tctdbqrysearchimpl(TDBQRY *qry){
       }
     }
   }
-  if(mcond){
+  bool cached = false;
+  if(pnum > 1 && qry->plan && qry->plan[0] == pnum){
+    int *plan = qry->plan;
+    cached = true;
+    for(int i = 0; i < pnum; i++){
+      TDBCOND *cond = conds + plan[2+i];
+      int j = i;
+      while(j < pnum && pconds[j] != cond){
+        j++;
+      }
+      if(j >= pnum){
+        cached = false;
+        break;
+      }
+      pconds[j] = pconds[i];
+      pconds[i] = cond;
+      TDBIDX *idx = pidxs[j];
+      pidxs[j] = pidxs[i];
+      pidxs[i] = idx;
+    }
+    if(cached){
+      nnum = plan[1];
+      tcxstrprintf(hint, "reusing the cached plan\n");
+    }
+  }
+  if(pnum > 1 && !cached){
+    int64_t *ests;
+    TCMALLOC(ests, sizeof(*ests) * pnum);
+    int64_t rnum = tchdbrnum(hdb);
+    double ratio = 1.0;
+    for(int i = 0; i < pnum; i++){
+      TDBCOND *cond = pconds[i];
+      TDBIDX *idx = pidxs[i];
+      int64_t est = tctdbqryidxestimate(qry, cond, idx);
+      ratio *= rnum > 0 ? tclmin(est, rnum) / (double)rnum : 0.0;
+      int j = i;
+      while(j > 0 && ests[j-1] > est){
+        ests[j] = ests[j-1];
+        pconds[j] = pconds[j-1];
+        pidxs[j] = pidxs[j-1];
+        j--;
+      }
+      ests[j] = est;
+      pconds[j] = cond;
+      pidxs[j] = idx;
+    }
+    tcxstrprintf(hint, "estimated result set size: %lld\n", (long long)(rnum * ratio + 0.5));
+    mest = ests[0];
+    for(int i = 1; i < pnum; i++){
+      TDBIDX *idx = pidxs[i];
+      bool inv = idx->type == TDBITTOKEN || idx->type == TDBITQGRAM;
+      if((ests[i] < rnum || inv) && ests[i] <= ests[0] * TDBINTRATIO){
+        TDBCOND *cond = pconds[i];
+        nnum++;
+        pconds[i] = pconds[nnum];
+        pidxs[i] = pidxs[nnum];
+        pconds[nnum] = cond;
+        pidxs[nnum] = idx;
+      }
+    }
+    TCFREE(ests);
+    if(qry->plan) TCFREE(qry->plan);
+    TCMALLOC(qry->plan, sizeof(qry->plan[0]) * (pnum + 2));
+    qry->plan[0] = pnum;
+    qry->plan[1] = nnum;
+    for(int i = 0; i < pnum; i++){
+      qry->plan[2+i] = pconds[i] - conds;
+    }
+  }
+  if(pnum > 0){
+    mcond = pconds[0];
+    midx = pidxs[0];
+  }
+  TDBIDX *cidx = NULL;
+  TDBCOND **cconds = NULL;
+  int ccnum = 0;
+  TCXSTR *cxstr = NULL;
+  char crbuf[TDBIDXNUMSIZ*2];
+  bool crange = false;
+  for(int i = 0; i < inum; i++){
+    TDBIDX *idx = idxs + i;
+    if(idx->type != TDBITCOMPOSITE || !idx->cols) continue;
+    TDBCOND **uconds;
+    TCMALLOC(uconds, sizeof(*uconds) * (TCLISTNUM((TCLIST *)idx->cols) + 1));
+    TCXSTR *pxstr = tcxstrnew();
+    char rbuf[TDBIDXNUMSIZ*2];
+    bool range;
+    int unum = tctdbqrycompplan(qry, idx, uconds, pxstr, rbuf, &range);
+    if(unum > ccnum){
+      if(cconds) TCFREE(cconds);
+      if(cxstr) tcxstrdel(cxstr);
+      cidx = idx;
+      cconds = uconds;
+      ccnum = unum;
+      cxstr = pxstr;
+      memcpy(crbuf, rbuf, sizeof(crbuf));
+      crange = range;
+    } else {
+      TCFREE(uconds);
+      tcxstrdel(pxstr);
+    }
+  }
+  if(cidx && mcond){
+    int64_t cest = tctdbqrycompestimate(qry, cidx, cxstr, crange ? crbuf : NULL);
+    if(mest < 0) mest = tctdbqryidxestimate(qry, mcond, midx);
+    if(cest > mest || (cest == mest && ccnum < 2)){
+      tcxstrprintf(hint, "skipping a composite index: \"%s\"\n", cidx->name);
+      cidx = NULL;
+    }
+  }
+  if(cidx){
     res = tclistnew();
-    mcond->alive = false;
-    acnum--;
+    for(int i = 0; i < ccnum; i++){
+      if(tctdbqrycondretire(cconds[i], *(char *)TCLISTVALPTR((TCLIST *)cidx->cols, i))) acnum--;
+    }
+    TDBCOND *ucond = NULL;
+    for(int i = 0; i < cnum; i++){
+      TDBCOND *cond = conds + i;
+      if(!cond->alive) continue;
+      if(ucond){
+        ucond = NULL;
+        break;
+      }
+      ucond = cond;
+    }
+    tcxstrprintf(hint, "using a composite index: \"%s\" asc (%s)\n",
+                 cidx->name, crange ? "prefix and range" : "prefix");
+    tcxstrprintf(hint, "composite matching columns: %d\n", ccnum);
+    bool all = oname != NULL;
+    if(!all && max < INT_MAX) tcxstrprintf(hint, "limited matching: %d\n", max);
+    const char *pbuf = TCXSTRPTR(cxstr);
+    int psiz = TCXSTRSIZE(cxstr);
+    BDBCUR *cur = tcbdbcurnew(cidx->db);
+    if(crange){
+      TCXSTRCAT(cxstr, crbuf, TDBIDXNUMSIZ);
+      pbuf = TCXSTRPTR(cxstr);
+      tcbdbcurjump(cur, pbuf, psiz + TDBIDXNUMSIZ);
+    } else {
+      tcbdbcurjump(cur, pbuf, psiz);
+    }
+    const char *kbuf;
+    int ksiz;
+    while((all || TCLISTNUM(res) < max) && (kbuf = tcbdbcurkey3(cur, &ksiz)) != NULL){
+      if(ksiz < psiz || memcmp(kbuf, pbuf, psiz)) break;
+      if(crange && (ksiz < psiz + TDBIDXNUMSIZ ||
+                    memcmp(kbuf + psiz, crbuf + TDBIDXNUMSIZ, TDBIDXNUMSIZ) > 0)) break;
+      int vsiz;
+      const char *vbuf = tcbdbcurval3(cur, &vsiz);
+      if(acnum < 1){
+        TCLISTPUSH(res, vbuf, vsiz);
+      } else if(ucond){
+        if(tctdbqryonecondmatch(qry, ucond, vbuf, vsiz)) TCLISTPUSH(res, vbuf, vsiz);
+      } else if(tctdbqryallcondmatch(qry, vbuf, vsiz)){
+        TCLISTPUSH(res, vbuf, vsiz);
+      }
+      tcbdbcurnext(cur);
+    }
+    tcbdbcurdel(cur);
+  }
+  if(cconds) TCFREE(cconds);
+  if(cxstr) tcxstrdel(cxstr);
+  if(!res && mcond){
+    res = tclistnew();
+    if(tctdbqrycondretire(mcond, midx->type)) acnum--;
     TCMAP *nmap = NULL;
-    if(ncond){
-      ncond->alive = false;
-      acnum--;
-      nmap = tctdbqryidxfetch(qry, ncond, nidx);
+    if(nnum > 0){
+      for(int i = 1; i <= nnum; i++){
+        if(tctdbqrycondretire(pconds[i], pidxs[i]->type)) acnum--;
+      }
+      nmap = tctdbqryidxfetch(qry, pconds[1], pidxs[1], INT_MAX);
+      for(int i = 2; i <= nnum && TCMAPRNUM(nmap) > 0; i++){
+        nmap = tctdbqryidxand(nmap, tctdbqryidxfetch(qry, pconds[i], pidxs[i], INT_MAX));
+        tcxstrprintf(hint, "intersected result set size: %lld\n", (long long)TCMAPRNUM(nmap));
+      }
       max = tclmin(max, TCMAPRNUM(nmap));
     }
     const char *expr = mcond->expr;
@@ -2921,7 +4310,64 @@ static TCLIST *tctdbqrysearchimpl(TDBQRY *qry){
       ucond = cond;
     }
     bool trim = *midx->name != '\0';
-    if(mcond->op == TDBQCSTREQ){
+    if(midx->type == TDBITINT64 || midx->type == TDBITDOUBLE){
+      bool asc = true;
+      bool all = oname != NULL;
+      if(oname && !strcmp(oname, mcond->name)){
+        if(otype == TDBQONUMASC){
+          all = false;
+          oname = NULL;
+        } else if(otype == TDBQONUMDESC){
+          asc = false;
+          all = false;
+          oname = NULL;
+        }
+      }
+      tcxstrprintf(hint, "using an index: \"%s\" %s (binary)\n",
+                   mcond->name, asc ? "asc" : "desc");
+      if(!all && max < INT_MAX) tcxstrprintf(hint, "limited matching: %d\n", max);
+      TCLIST *ranges = tctdbqrynumranges(mcond, midx->type);
+      BDBCUR *cur = tcbdbcurnew(midx->db);
+      int rnum = TCLISTNUM(ranges);
+      for(int i = 0; (all || TCLISTNUM(res) < max) && i < rnum; i++){
+        const char *range = TCLISTVALPTR(ranges, asc ? i : rnum - i - 1);
+        if(asc){
+          tcbdbcurjump(cur, range, TDBIDXNUMSIZ);
+        } else {
+          char ubuf[TDBIDXNUMSIZ+2];
+          memcpy(ubuf, range + TDBIDXNUMSIZ, TDBIDXNUMSIZ);
+          ubuf[TDBIDXNUMSIZ] = 0xff;
+          ubuf[TDBIDXNUMSIZ+1] = 0xff;
+          tcbdbcurjumpback(cur, ubuf, sizeof(ubuf));
+        }
+        const char *kbuf;
+        int ksiz;
+        while((all || TCLISTNUM(res) < max) && (kbuf = tcbdbcurkey3(cur, &ksiz)) != NULL){
+          if(ksiz < TDBIDXNUMSIZ) break;
+          if(asc ? memcmp(kbuf, range + TDBIDXNUMSIZ, TDBIDXNUMSIZ) > 0 :
+             memcmp(kbuf, range, TDBIDXNUMSIZ) < 0) break;
+          int vsiz;
+          const char *vbuf = tcbdbcurval3(cur, &vsiz);
+          int nsiz;
+          if(!nmap || tcmapget(nmap, vbuf, vsiz, &nsiz)){
+            if(acnum < 1){
+              TCLISTPUSH(res, vbuf, vsiz);
+            } else if(ucond){
+              if(tctdbqryonecondmatch(qry, ucond, vbuf, vsiz)) TCLISTPUSH(res, vbuf, vsiz);
+            } else if(tctdbqryallcondmatch(qry, vbuf, vsiz)){
+              TCLISTPUSH(res, vbuf, vsiz);
+            }
+          }
+          if(asc){
+            tcbdbcurnext(cur);
+          } else {
+            tcbdbcurprev(cur);
+          }
+        }
+      }
+      tcbdbcurdel(cur);
+      tclistdel(ranges);
+    } else if(mcond->op == TDBQCSTREQ){
       tcxstrprintf(hint, "using an index: \"%s\" asc (STREQ)\n", mcond->name);
       BDBCUR *cur = tcbdbcurnew(midx->db);
       tcbdbcurjump(cur, expr, esiz + trim);
@@ -3355,6 +4801,8 @@ static TCLIST *tctdbqrysearchimpl(TDBQRY *qry){
     }
     if(nmap) tcmapdel(nmap);
   }
+  TCFREE(pidxs);
+  TCFREE(pconds);
   if(!res && scond){
     res = tclistnew();
     scond->alive = false;
@@ -3454,38 +4902,8 @@ static TCLIST *tctdbqrysearchimpl(TDBQRY *qry){
     if(!all) oname = NULL;
   }
   if(!res && oname && max < tchdbrnum(hdb) * TDBORDRATIO){
-    TDBIDX *oidx = NULL;
-    bool asc = true;
-    for(int i = 0; !oidx && i < inum; i++){
-      TDBIDX *idx = idxs + i;
-      if(strcmp(idx->name, oname)) continue;
-      switch(idx->type){
-      case TDBITLEXICAL:
-        switch(otype){
-        case TDBQOSTRASC:
-          oidx = idx;
-          asc = true;
-          break;
-        case TDBQOSTRDESC:
-          oidx = idx;
-          asc = false;
-          break;
-        }
-        break;
-      case TDBITDECIMAL:
-        switch(otype){
-        case TDBQONUMASC:
-          oidx = idx;
-          asc = true;
-          break;
-        case TDBQONUMDESC:
-          oidx = idx;
-          asc = false;
-          break;
-        }
-        break;
-      }
-    }
+    bool asc;
+    TDBIDX *oidx = tctdbqryorderidx(tdb, oname, otype, &asc);
     if(oidx){
       res = tclistnew();
       TDBCOND *ucond = NULL;
@@ -3556,7 +4974,6 @@ static TCLIST *tctdbqrysearchimpl(TDBQRY *qry){
   }
   if(!res){
     tcxstrprintf(hint, "scanning the whole table\n");
-    res = tclistnew();
     TDBCOND *ucond = NULL;
     for(int i = 0; i < cnum; i++){
       TDBCOND *cond = conds + i;
@@ -3567,72 +4984,33 @@ static TCLIST *tctdbqrysearchimpl(TDBQRY *qry){
       }
       ucond = cond;
     }
-    char *lkbuf = NULL;
-    int lksiz = 0;
-    char *pkbuf;
-    int pksiz;
-    const char *cbuf;
-    int csiz;
     bool all = oname != NULL;
     if(!all && max < INT_MAX) tcxstrprintf(hint, "limited matching: %d\n", max);
-    while((all || TCLISTNUM(res) < max) &&
-          (pkbuf = tchdbgetnext3(hdb, lkbuf, lksiz, &pksiz, &cbuf, &csiz)) != NULL){
-      if(ucond){
-        if(ucond->nsiz < 1){
-          char *tkbuf;
-          TCMEMDUP(tkbuf, pkbuf, pksiz);
-          if(tctdbqrycondmatch(ucond, tkbuf, pksiz) == ucond->sign)
-            TCLISTPUSH(res, pkbuf, pksiz);
-          TCFREE(tkbuf);
-        } else {
-          int vsiz;
-          char *vbuf = tcmaploadone(cbuf, csiz, ucond->name, ucond->nsiz, &vsiz);
-          if(vbuf){
-            if(tctdbqrycondmatch(ucond, vbuf, vsiz) == ucond->sign)
-              TCLISTPUSH(res, pkbuf, pksiz);
-            TCFREE(vbuf);
-          } else {
-            if(!ucond->sign) TCLISTPUSH(res, pkbuf, pksiz);
-          }
-        }
-      } else {
-        TCMAP *cols = tcmapload(cbuf, csiz);
-        bool ok = true;
-        for(int i = 0; i < cnum; i++){
-          TDBCOND *cond = conds + i;
-          if(cond->nsiz < 1){
-            char *tkbuf;
-            TCMEMDUP(tkbuf, pkbuf, pksiz);
-            if(tctdbqrycondmatch(cond, tkbuf, pksiz) != cond->sign){
-              TCFREE(tkbuf);
-              ok = false;
-              break;
-            }
-            TCFREE(tkbuf);
-          } else {
-            int vsiz;
-            const char *vbuf = tcmapget(cols, cond->name, cond->nsiz, &vsiz);
-            if(vbuf){
-              if(tctdbqrycondmatch(cond, vbuf, vsiz) != cond->sign){
-                ok = false;
-                break;
-              }
-            } else {
-              if(cond->sign){
-                ok = false;
-                break;
-              }
-            }
-          }
+    if(oname && *oname != '\0') tcxstrprintf(hint, "capturing sort values: \"%s\"\n", oname);
+    if(TCUSEPTHREAD && tdb->stnum > 1){
+      tcxstrprintf(hint, "parallel scanning: %d\n", tdb->stnum);
+      res = tctdbqryscanpar(qry, ucond, max, all, (oname && *oname != '\0') ? &svals : NULL);
+    } else {
+      res = tclistnew();
+      if(oname && *oname != '\0') svals = tclistnew();
+      char *lkbuf = NULL;
+      int lksiz = 0;
+      char *pkbuf;
+      int pksiz;
+      const char *cbuf;
+      int csiz;
+      while((all || TCLISTNUM(res) < max) &&
+            (pkbuf = tchdbgetnext3(hdb, lkbuf, lksiz, &pksiz, &cbuf, &csiz)) != NULL){
+        if(tctdbqryscanmatch(qry, ucond, pkbuf, pksiz, cbuf, csiz)){
+          TCLISTPUSH(res, pkbuf, pksiz);
+          if(svals) tctdbqryscansval(qry, svals, cbuf, csiz);
         }
-        if(ok) TCLISTPUSH(res, pkbuf, pksiz);
-        tcmapdel(cols);
+        TCFREE(lkbuf);
+        lkbuf = pkbuf;
+        lksiz = pksiz;
       }
       TCFREE(lkbuf);
-      lkbuf = pkbuf;
-      lksiz = pksiz;
     }
-    TCFREE(lkbuf);
   }
   int rnum = TCLISTNUM(res);
   tcxstrprintf(hint, "result set size: %d\n", rnum);
@@ -3655,59 +5033,116 @@ static TCLIST *tctdbqrysearchimpl(TDBQRY *qry){
         break;
       }
     } else {
-      tcxstrprintf(hint, "sorting the result set: \"%s\"\n", oname);
-      TDBSORTKEY *keys;
-      TCMALLOC(keys, sizeof(*keys) * rnum + 1);
-      int onsiz = strlen(oname);
-      for(int i = 0; i < rnum; i++){
-        TDBSORTKEY *key = keys + i;
+      bool asc;
+      TDBIDX *oidx = svals ? NULL : tctdbqryorderidx(tdb, oname, otype, &asc);
+      if(oidx && oidx->type != TDBITLEXICAL && oidx->type != TDBITINT64) oidx = NULL;
+      if(oidx){
+        int64_t inum = tcbdbrnum(oidx->db);
+        if(max < rnum) inum = inum * max / rnum + 1;
+        if(inum > (int64_t)rnum * TDBCOVRATIO) oidx = NULL;
+      }
+      if(oidx){
+        tcxstrprintf(hint, "sorting the result set by an index: \"%s\" %s (covering)\n",
+                     oname, asc ? "asc" : "desc");
+        TCMAP *rmap = tcmapnew2(rnum / 4 + 1);
+        for(int i = 0; i < rnum; i++){
+          const char *kbuf;
+          int ksiz;
+          TCLISTVAL(kbuf, res, i, ksiz);
+          tcmapputkeep(rmap, kbuf, ksiz, "", 0);
+        }
+        TCLIST *nres = tclistnew2(tclmin(rnum, max) + 1);
+        BDBCUR *cur = tcbdbcurnew(oidx->db);
+        if(asc){
+          tcbdbcurfirst(cur);
+        } else {
+          tcbdbcurlast(cur);
+        }
+        int vsiz;
+        const char *vbuf;
+        while(TCLISTNUM(nres) < max && TCMAPRNUM(rmap) > 0 &&
+              (vbuf = tcbdbcurval3(cur, &vsiz)) != NULL){
+          if(tcmapout(rmap, vbuf, vsiz)) TCLISTPUSH(nres, vbuf, vsiz);
+          if(asc){
+            tcbdbcurnext(cur);
+          } else {
+            tcbdbcurprev(cur);
+          }
+        }
+        tcbdbcurdel(cur);
+        tcmapiterinit(rmap);
         const char *kbuf;
         int ksiz;
-        TCLISTVAL(kbuf, res, i, ksiz);
-        char *vbuf = NULL;
-        int vsiz = 0;
-        int csiz;
-        char *cbuf = tchdbget(hdb, kbuf, ksiz, &csiz);
-        if(cbuf){
-          vbuf = tcmaploadone(cbuf, csiz, oname, onsiz, &vsiz);
-          TCFREE(cbuf);
+        while(TCLISTNUM(nres) < max && (kbuf = tcmapiternext(rmap, &ksiz)) != NULL){
+          TCLISTPUSH(nres, kbuf, ksiz);
         }
-        key->kbuf = kbuf;
-        key->ksiz = ksiz;
-        key->vbuf = vbuf;
-        key->vsiz = vsiz;
-      }
-      int (*compar)(const TDBSORTKEY *a, const TDBSORTKEY *b) = NULL;
-      switch(otype){
-      case TDBQOSTRASC:
-        compar = tdbcmpsortkeystrasc;
-        break;
-      case TDBQOSTRDESC:
-        compar = tdbcmpsortkeystrdesc;
-        break;
-      case TDBQONUMASC:
-        compar = tdbcmpsortkeynumasc;
-        break;
-      case TDBQONUMDESC:
-        compar = tdbcmpsortkeynumdesc;
-        break;
-      }
-      if(compar){
-        if(max <= rnum / 16){
-          tctopsort(keys, rnum, sizeof(*keys), max, (int (*)(const void *, const void *))compar);
-        } else {
-          qsort(keys, rnum, sizeof(*keys), (int (*)(const void *, const void *))compar);
+        tcmapdel(rmap);
+        tclistdel(res);
+        res = nres;
+      } else {
+        tcxstrprintf(hint, "sorting the result set: \"%s\"\n", oname);
+        TDBSORTKEY *keys;
+        TCMALLOC(keys, sizeof(*keys) * rnum + 1);
+        int onsiz = strlen(oname);
+        for(int i = 0; i < rnum; i++){
+          TDBSORTKEY *key = keys + i;
+          const char *kbuf;
+          int ksiz;
+          TCLISTVAL(kbuf, res, i, ksiz);
+          char *vbuf = NULL;
+          int vsiz = 0;
+          if(svals){
+            int ssiz = TCLISTVALSIZ(svals, i);
+            if(ssiz > 0){
+              vbuf = (char *)TCLISTVALPTR(svals, i);
+              vsiz = ssiz - 1;
+            }
+          } else {
+            int csiz;
+            char *cbuf = tchdbget(hdb, kbuf, ksiz, &csiz);
+            if(cbuf){
+              vbuf = tctdbrowloadone(tdb, cbuf, csiz, oname, onsiz, &vsiz);
+              TCFREE(cbuf);
+            }
+          }
+          key->kbuf = kbuf;
+          key->ksiz = ksiz;
+          key->vbuf = vbuf;
+          key->vsiz = vsiz;
         }
+        int (*compar)(const TDBSORTKEY *a, const TDBSORTKEY *b) = NULL;
+        switch(otype){
+        case TDBQOSTRASC:
+          compar = tdbcmpsortkeystrasc;
+          break;
+        case TDBQOSTRDESC:
+          compar = tdbcmpsortkeystrdesc;
+          break;
+        case TDBQONUMASC:
+          compar = tdbcmpsortkeynumasc;
+          break;
+        case TDBQONUMDESC:
+          compar = tdbcmpsortkeynumdesc;
+          break;
+        }
+        if(compar){
+          if(max <= rnum / 16){
+            tctopsort(keys, rnum, sizeof(*keys), max, (int (*)(const void *, const void *))compar);
+          } else {
+            qsort(keys, rnum, sizeof(*keys), (int (*)(const void *, const void *))compar);
+          }
+        }
+        int onum = compar ? tclmin(rnum, max) : rnum;
+        TCLIST *nres = tclistnew2(onum + 1);
+        for(int i = 0; i < rnum; i++){
+          TDBSORTKEY *key = keys + i;
+          if(i < onum) TCLISTPUSH(nres, key->kbuf, key->ksiz);
+          if(!svals) TCFREE(key->vbuf);
+        }
+        tclistdel(res);
+        res = nres;
+        TCFREE(keys);
       }
-      TCLIST *nres = tclistnew2(rnum);
-      for(int i = 0; i < rnum; i++){
-        TDBSORTKEY *key = keys + i;
-        TCLISTPUSH(nres, key->kbuf, key->ksiz);
-        TCFREE(key->vbuf);
-      }
-      tclistdel(res);
-      res = nres;
-      TCFREE(keys);
     }
   } else if(isord){
     tcxstrprintf(hint, "leaving the index order\n");
@@ -3729,6 +5164,7 @@ static TCLIST *tctdbqrysearchimpl(TDBQRY *qry){
       TCFREE(tclistpop(res, &rsiz));
     }
   }
+  if(svals) tclistdel(svals);
   qry->count = TCLISTNUM(res);
   return res;
 }
@@ -3738,23 +5174,46 @@ static TCLIST *tctdbqrysearchimpl(TDBQRY *qry){
    `qry' specifies the query object.
    `cond' specifies the condition object.
    `idx' specifies an index object.
+   `lim' specifies the maximum number of the fetched keys.  If it is less than `INT_MAX', the
+   search is a sampling for estimation and no hint is recorded.  It is not applied to inverted
+   indices.
    The return value is a map object containing primary keys of the corresponding records. */
-static TCMAP *tctdbqryidxfetch(TDBQRY *qry, TDBCOND *cond, TDBIDX *idx){
-  assert(qry && cond && idx);
+static TCMAP *tctdbqryidxfetch(TDBQRY *qry, TDBCOND *cond, TDBIDX *idx, int lim){
+  assert(qry && cond && idx && lim >= 0);
   TCTDB *tdb = qry->tdb;
   TCHDB *hdb = tdb->hdb;
-  TCXSTR *hint = qry->hint;
+  TCXSTR *hint = lim < INT_MAX ? NULL : qry->hint;
   const char *expr = cond->expr;
   int esiz = cond->esiz;
   bool trim = *idx->name != '\0';
   TCMAP *nmap = tcmapnew2(tclmin(TDBDEFBNUM, tchdbrnum(hdb)) / 4 + 1);
-  if(cond->op == TDBQCSTREQ){
-    tcxstrprintf(hint, "using an auxiliary index: \"%s\" one (STREQ)\n", cond->name);
+  if(idx->type == TDBITINT64 || idx->type == TDBITDOUBLE){
+    if(hint) tcxstrprintf(hint, "using an auxiliary index: \"%s\" asc (binary)\n", cond->name);
+    TCLIST *ranges = tctdbqrynumranges(cond, idx->type);
+    BDBCUR *cur = tcbdbcurnew(idx->db);
+    int rnum = TCLISTNUM(ranges);
+    for(int i = 0; i < rnum; i++){
+      const char *range = TCLISTVALPTR(ranges, i);
+      tcbdbcurjump(cur, range, TDBIDXNUMSIZ);
+      const char *kbuf;
+      int ksiz;
+      while(TCMAPRNUM(nmap) < lim && (kbuf = tcbdbcurkey3(cur, &ksiz)) != NULL){
+        if(ksiz < TDBIDXNUMSIZ || memcmp(kbuf, range + TDBIDXNUMSIZ, TDBIDXNUMSIZ) > 0) break;
+        int vsiz;
+        const char *vbuf = tcbdbcurval3(cur, &vsiz);
+        tcmapputkeep(nmap, vbuf, vsiz, "", 0);
+        tcbdbcurnext(cur);
+      }
+    }
+    tcbdbcurdel(cur);
+    tclistdel(ranges);
+  } else if(cond->op == TDBQCSTREQ){
+    if(hint) tcxstrprintf(hint, "using an auxiliary index: \"%s\" one (STREQ)\n", cond->name);
     BDBCUR *cur = tcbdbcurnew(idx->db);
     tcbdbcurjump(cur, expr, esiz + trim);
     const char *kbuf;
     int ksiz;
-    while((kbuf = tcbdbcurkey3(cur, &ksiz)) != NULL){
+    while(TCMAPRNUM(nmap) < lim && (kbuf = tcbdbcurkey3(cur, &ksiz)) != NULL){
       if(trim) ksiz -= 3;
       if(ksiz == esiz && !memcmp(kbuf, expr, esiz)){
         int vsiz;
@@ -3767,12 +5226,12 @@ static TCMAP *tctdbqryidxfetch(TDBQRY *qry, TDBCOND *cond, TDBIDX *idx){
     }
     tcbdbcurdel(cur);
   } else if(cond->op == TDBQCSTRBW){
-    tcxstrprintf(hint, "using an auxiliary index: \"%s\" asc (STRBW)\n", cond->name);
+    if(hint) tcxstrprintf(hint, "using an auxiliary index: \"%s\" asc (STRBW)\n", cond->name);
     BDBCUR *cur = tcbdbcurnew(idx->db);
     tcbdbcurjump(cur, expr, esiz + trim);
     const char *kbuf;
     int ksiz;
-    while((kbuf = tcbdbcurkey3(cur, &ksiz)) != NULL){
+    while(TCMAPRNUM(nmap) < lim && (kbuf = tcbdbcurkey3(cur, &ksiz)) != NULL){
       if(trim) ksiz -= 3;
       if(ksiz >= esiz && !memcmp(kbuf, expr, esiz)){
         int vsiz;
@@ -3785,7 +5244,7 @@ static TCMAP *tctdbqryidxfetch(TDBQRY *qry, TDBCOND *cond, TDBIDX *idx){
     }
     tcbdbcurdel(cur);
   } else if(cond->op == TDBQCSTROREQ){
-    tcxstrprintf(hint, "using an auxiliary index: \"%s\" skip (STROREQ)\n", cond->name);
+    if(hint) tcxstrprintf(hint, "using an auxiliary index: \"%s\" skip (STROREQ)\n", cond->name);
     TCLIST *tokens = tcstrsplit(expr, "\t\n\r ,");
     tclistsort(tokens);
     for(int i = 1; i < TCLISTNUM(tokens); i++){
@@ -3804,7 +5263,7 @@ static TCMAP *tctdbqryidxfetch(TDBQRY *qry, TDBCOND *cond, TDBIDX *idx){
       tcbdbcurjump(cur, token, tsiz + trim);
       const char *kbuf;
       int ksiz;
-      while((kbuf = tcbdbcurkey3(cur, &ksiz)) != NULL){
+      while(TCMAPRNUM(nmap) < lim && (kbuf = tcbdbcurkey3(cur, &ksiz)) != NULL){
         if(trim) ksiz -= 3;
         if(ksiz == tsiz && !memcmp(kbuf, token, tsiz)){
           int vsiz;
@@ -3819,14 +5278,14 @@ static TCMAP *tctdbqryidxfetch(TDBQRY *qry, TDBCOND *cond, TDBIDX *idx){
     }
     tclistdel(tokens);
   } else if(cond->op == TDBQCNUMEQ){
-    tcxstrprintf(hint, "using an auxiliary index: \"%s\" asc (NUMEQ)\n", cond->name);
+    if(hint) tcxstrprintf(hint, "using an auxiliary index: \"%s\" asc (NUMEQ)\n", cond->name);
     int64_t xnum = tcatoi(expr);
     BDBCUR *cur = tcbdbcurnew(idx->db);
     char numbuf[TCNUMBUFSIZ];
     int ksiz = sprintf(numbuf, "\x01%lld", (long long)xnum);
     tcbdbcurjump(cur, numbuf, ksiz);
     const char *kbuf;
-    while((kbuf = tcbdbcurkey3(cur, &ksiz)) != NULL){
+    while(TCMAPRNUM(nmap) < lim && (kbuf = tcbdbcurkey3(cur, &ksiz)) != NULL){
       if(tcatoi(kbuf) == xnum){
         int vsiz;
         const char *vbuf = tcbdbcurval3(cur, &vsiz);
@@ -3838,14 +5297,15 @@ static TCMAP *tctdbqryidxfetch(TDBQRY *qry, TDBCOND *cond, TDBIDX *idx){
     }
     tcbdbcurdel(cur);
   } else if(cond->op == TDBQCNUMGT || cond->op == TDBQCNUMGE){
-    tcxstrprintf(hint, "using an auxiliary index: \"%s\" asc (NUMGT/NUMGE)\n", cond->name);
+    if(hint) tcxstrprintf(hint, "using an auxiliary index: \"%s\" asc (NUMGT/NUMGE)\n",
+                          cond->name);
     int64_t xnum = tcatoi(expr);
     BDBCUR *cur = tcbdbcurnew(idx->db);
     char numbuf[TCNUMBUFSIZ];
     int ksiz = sprintf(numbuf, "\x01%lld", (long long)xnum);
     tcbdbcurjump(cur, numbuf, ksiz);
     const char *kbuf;
-    while((kbuf = tcbdbcurkey3(cur, &ksiz)) != NULL){
+    while(TCMAPRNUM(nmap) < lim && (kbuf = tcbdbcurkey3(cur, &ksiz)) != NULL){
       if(cond->op == TDBQCNUMGE || tcatoi(kbuf) > xnum){
         int vsiz;
         const char *vbuf = tcbdbcurval3(cur, &vsiz);
@@ -3855,14 +5315,15 @@ static TCMAP *tctdbqryidxfetch(TDBQRY *qry, TDBCOND *cond, TDBIDX *idx){
     }
     tcbdbcurdel(cur);
   } else if(cond->op == TDBQCNUMLT || cond->op == TDBQCNUMLE){
-    tcxstrprintf(hint, "using an auxiliary index: \"%s\" desc (NUMLT/NUMLE)\n", cond->name);
+    if(hint) tcxstrprintf(hint, "using an auxiliary index: \"%s\" desc (NUMLT/NUMLE)\n",
+                          cond->name);
     int64_t xnum = tcatoi(expr);
     BDBCUR *cur = tcbdbcurnew(idx->db);
     char numbuf[TCNUMBUFSIZ];
     int ksiz = sprintf(numbuf, "\x7f%lld", (long long)xnum);
     tcbdbcurjumpback(cur, numbuf, ksiz);
     const char *kbuf;
-    while((kbuf = tcbdbcurkey3(cur, &ksiz)) != NULL){
+    while(TCMAPRNUM(nmap) < lim && (kbuf = tcbdbcurkey3(cur, &ksiz)) != NULL){
       if(cond->op == TDBQCNUMLE || tcatoi(kbuf) < xnum){
         int vsiz;
         const char *vbuf = tcbdbcurval3(cur, &vsiz);
@@ -3872,7 +5333,7 @@ static TCMAP *tctdbqryidxfetch(TDBQRY *qry, TDBCOND *cond, TDBIDX *idx){
     }
     tcbdbcurdel(cur);
   } else if(cond->op == TDBQCNUMBT){
-    tcxstrprintf(hint, "using an auxiliary index: \"%s\" asc (NUMBT)\n", cond->name);
+    if(hint) tcxstrprintf(hint, "using an auxiliary index: \"%s\" asc (NUMBT)\n", cond->name);
     while(*expr == ' ' || *expr == ','){
       expr++;
     }
@@ -3897,7 +5358,7 @@ static TCMAP *tctdbqryidxfetch(TDBQRY *qry, TDBCOND *cond, TDBIDX *idx){
     int ksiz = sprintf(numbuf, "\x01%lld", (long long)lower);
     tcbdbcurjump(cur, numbuf, ksiz);
     const char *kbuf;
-    while((kbuf = tcbdbcurkey3(cur, &ksiz)) != NULL){
+    while(TCMAPRNUM(nmap) < lim && (kbuf = tcbdbcurkey3(cur, &ksiz)) != NULL){
       if(tcatoi(kbuf) > upper) break;
       int vsiz;
       const char *vbuf = tcbdbcurval3(cur, &vsiz);
@@ -3906,7 +5367,7 @@ static TCMAP *tctdbqryidxfetch(TDBQRY *qry, TDBCOND *cond, TDBIDX *idx){
     }
     tcbdbcurdel(cur);
   } else if(cond->op == TDBQCNUMOREQ){
-    tcxstrprintf(hint, "using an auxiliary index: \"%s\" skip (NUMOREQ)\n", cond->name);
+    if(hint) tcxstrprintf(hint, "using an auxiliary index: \"%s\" skip (NUMOREQ)\n", cond->name);
     BDBCUR *cur = tcbdbcurnew(idx->db);
     TCLIST *tokens = tcstrsplit(expr, "\t\n\r ,");
     tclistsortex(tokens, tdbcmppkeynumasc);
@@ -3927,7 +5388,7 @@ static TCMAP *tctdbqryidxfetch(TDBQRY *qry, TDBCOND *cond, TDBIDX *idx){
       int ksiz = sprintf(numbuf, "\x01%lld", (long long)xnum);
       tcbdbcurjump(cur, numbuf, ksiz);
       const char *kbuf;
-      while((kbuf = tcbdbcurkey3(cur, &ksiz)) != NULL){
+      while(TCMAPRNUM(nmap) < lim && (kbuf = tcbdbcurkey3(cur, &ksiz)) != NULL){
         if(tcatoi(kbuf) == xnum){
           int vsiz;
           const char *vbuf = tcbdbcurval3(cur, &vsiz);
@@ -3941,7 +5402,7 @@ static TCMAP *tctdbqryidxfetch(TDBQRY *qry, TDBCOND *cond, TDBIDX *idx){
     tclistdel(tokens);
     tcbdbcurdel(cur);
   } else if(cond->op == TDBQCSTRAND || cond->op == TDBQCSTROR){
-    tcxstrprintf(hint, "using an auxiliary index: \"%s\" inverted (%s)\n",
+    if(hint) tcxstrprintf(hint, "using an auxiliary index: \"%s\" inverted (%s)\n",
                  cond->name, cond->op == TDBQCSTRAND ? "STRAND" : "STROR");
     TCLIST *tokens = tcstrsplit(expr, "\t\n\r ,");
     tclistsort(tokens);
@@ -3955,227 +5416,2001 @@ static TCMAP *tctdbqryidxfetch(TDBQRY *qry, TDBCOND *cond, TDBIDX *idx){
     nmap = tctdbidxgetbytokens(tdb, idx, tokens, cond->op, hint);
     tclistdel(tokens);
   } else if(cond->op == TDBQCFTSPH){
-    tcxstrprintf(hint, "using an auxiliary index: \"%s\" inverted (FTS)\n", cond->name);
+    if(hint) tcxstrprintf(hint, "using an auxiliary index: \"%s\" inverted (FTS)\n", cond->name);
     tcmapdel(nmap);
     nmap = tctdbidxgetbyfts(tdb, idx, cond, hint);
   }
-  tcxstrprintf(hint, "auxiliary result set size: %lld\n", (long long)TCMAPRNUM(nmap));
+  if(hint) tcxstrprintf(hint, "auxiliary result set size: %lld\n", (long long)TCMAPRNUM(nmap));
   return nmap;
 }
 
 
-/* Check matching of one condition and a record.
+/* Estimate the number of records matching a condition by an index.
    `qry' specifies the query object.
    `cond' specifies the condition object.
-   `pkbuf' specifies the pointer to the region of the primary key.
-   `pksiz' specifies the size of the region of the primary key.
-   If they matches, the return value is true, else it is false. */
-static bool tctdbqryonecondmatch(TDBQRY *qry, TDBCOND *cond, const char *pkbuf, int pksiz){
-  assert(qry && cond && pkbuf && pksiz >= 0);
-  if(cond->nsiz < 1) return tctdbqrycondmatch(cond, pkbuf, pksiz) == cond->sign;
-  int csiz;
-  char *cbuf = tchdbget(qry->tdb->hdb, pkbuf, pksiz, &csiz);
-  if(!cbuf) return false;
-  bool rv;
-  int vsiz;
-  char *vbuf = tcmaploadone(cbuf, csiz, cond->name, cond->nsiz, &vsiz);
-  if(vbuf){
-    rv = tctdbqrycondmatch(cond, vbuf, vsiz) == cond->sign;
-    TCFREE(vbuf);
-  } else {
-    rv = !cond->sign;
-  }
-  TCFREE(cbuf);
-  return rv;
-}
-
-
-/* Check matching of all conditions and a record.
-   `qry' specifies the query object.
-   `pkbuf' specifies the pointer to the region of the primary key.
-   `pksiz' specifies the size of the region of the primary key.
-   If they matches, the return value is true, else it is false. */
-static bool tctdbqryallcondmatch(TDBQRY *qry, const char *pkbuf, int pksiz){
-  assert(qry && pkbuf && pksiz >= 0);
-  TCTDB *tdb = qry->tdb;
-  TDBCOND *conds = qry->conds;
-  int cnum = qry->cnum;
-  int csiz;
-  char *cbuf = tchdbget(tdb->hdb, pkbuf, pksiz, &csiz);
-  if(!cbuf) return false;
-  TCMAP *cols = tcmapload(cbuf, csiz);
-  bool ok = true;
-  for(int i = 0; i < cnum; i++){
-    TDBCOND *cond = conds + i;
-    if(!cond->alive) continue;
-    if(cond->nsiz < 1){
-      if(tctdbqrycondmatch(cond, pkbuf, pksiz) != cond->sign){
-        ok = false;
-        break;
-      }
-    } else {
-      int vsiz;
-      const char *vbuf = tcmapget(cols, cond->name, cond->nsiz, &vsiz);
-      if(vbuf){
-        if(tctdbqrycondmatch(cond, vbuf, vsiz) != cond->sign){
-          ok = false;
-          break;
+   `idx' specifies an index object.
+   The return value is the estimated number of the corresponding records.  It is exact if the
+   index holds less than `TDBESTDIVE' matching records, else it is derived from the statistics
+   of the index. */
+static int64_t tctdbqryidxestimate(TDBQRY *qry, TDBCOND *cond, TDBIDX *idx){
+  assert(qry && cond && idx);
+  TCXSTR *hint = qry->hint;
+  const char *how = "guess";
+  int64_t est = tchdbrnum(qry->tdb->hdb);
+  if(idx->type != TDBITTOKEN && idx->type != TDBITQGRAM){
+    TCMAP *nmap = tctdbqryidxfetch(qry, cond, idx, TDBESTDIVE);
+    int64_t dnum = TCMAPRNUM(nmap);
+    tcmapdel(nmap);
+    TDBIDXSTAT stat;
+    if(dnum < TDBESTDIVE){
+      est = dnum;
+      how = "exact";
+    } else if(tctdbidxstatget(idx, &stat)){
+      double ent = tcbdbrnum(idx->db);
+      double knum = stat.knum * ent / stat.snum;
+      if(knum < 1) knum = 1;
+      double num = 0;
+      if(cond->op == TDBQCSTREQ){
+        num = ent / knum;
+      } else if(cond->op == TDBQCSTRBW){
+        char ubuf[TDBIDXNUMSIZ];
+        memset(ubuf, 0xff, sizeof(ubuf));
+        memcpy(ubuf, cond->expr, tclmin(cond->esiz, sizeof(ubuf)));
+        num = ent * tctdbidxstatrange(&stat, tctdbidxstatpos(idx->type, cond->expr, cond->esiz),
+                                      tctdbidxstatpos(idx->type, ubuf, sizeof(ubuf)));
+      } else if(cond->op == TDBQCSTROREQ){
+        TCLIST *tokens = tcstrsplit(cond->expr, "\t\n\r ,");
+        for(int i = 0; i < TCLISTNUM(tokens); i++){
+          if(TCLISTVALSIZ(tokens, i) > 0) num += ent / knum;
         }
+        tclistdel(tokens);
       } else {
-        if(cond->sign){
-          ok = false;
-          break;
+        TCLIST *ranges = tctdbqrynumranges(cond, idx->type == TDBITDECIMAL ?
+                                           TDBITDOUBLE : idx->type);
+        bool one = cond->op == TDBQCNUMEQ || cond->op == TDBQCNUMOREQ;
+        for(int i = 0; i < TCLISTNUM(ranges); i++){
+          const char *range = TCLISTVALPTR(ranges, i);
+          uint64_t lower = tctdbidxstatpos(TDBITINT64, range, TDBIDXNUMSIZ);
+          uint64_t upper = tctdbidxstatpos(TDBITINT64, range + TDBIDXNUMSIZ, TDBIDXNUMSIZ);
+          num += (one || lower == upper) ? ent / knum :
+            ent * tctdbidxstatrange(&stat, lower, upper);
         }
+        tclistdel(ranges);
       }
+      est = num > dnum ? num + 0.5 : dnum;
+      how = "stats";
+    } else {
+      est = tclmax(tcbdbrnum(idx->db), dnum);
     }
   }
-  tcmapdel(cols);
-  TCFREE(cbuf);
-  return ok;
+  tcxstrprintf(hint, "estimated records: \"%s\" %lld (%s)\n", cond->name, (long long)est, how);
+  return est;
 }
 
 
-/* Check matching of a operand expression and a column value.
+/* Intersect two sets of primary keys fetched from indices.
+   `amap' specifies a map object of primary keys.
+   `bmap' specifies another map object of primary keys.
+   The return value is a map object of the primary keys contained in both.  The smaller set is
+   iterated and each key is probed in the larger one.  Both of the given objects are deleted. */
+static TCMAP *tctdbqryidxand(TCMAP *amap, TCMAP *bmap){
+  assert(amap && bmap);
+  if(TCMAPRNUM(amap) > TCMAPRNUM(bmap)){
+    TCMAP *swap = amap;
+    amap = bmap;
+    bmap = swap;
+  }
+  TCMAP *res = tcmapnew2(TCMAPRNUM(amap) + 1);
+  tcmapiterinit(amap);
+  const char *kbuf;
+  int ksiz;
+  while((kbuf = tcmapiternext(amap, &ksiz)) != NULL){
+    int vsiz;
+    if(tcmapget(bmap, kbuf, ksiz, &vsiz)) tcmapputkeep(res, kbuf, ksiz, "", 0);
+  }
+  tcmapdel(bmap);
+  tcmapdel(amap);
+  return res;
+}
+
+
+/* Get the key ranges of a binary numeric index matching a condition.
    `cond' specifies the condition object.
-   `vbuf' specifies the column value.
-   `vsiz' specifies the size of the column value.
-   If they matches, the return value is true, else it is false. */
-static bool tctdbqrycondmatch(TDBCOND *cond, const char *vbuf, int vsiz){
-  assert(cond && vbuf && vsiz >= 0);
-  bool hit = false;
+   `type' specifies the index type.
+   The return value is a list object of the ranges in ascending order, which do not overlap.  Each
+   element is the lower key and the upper key, both inclusive and `TDBIDXNUMSIZ' bytes.  Because
+   the object of the return value is created with the function `tclistnew', it should be deleted
+   with the function `tclistdel' when it is no longer in use. */
+static TCLIST *tctdbqrynumranges(TDBCOND *cond, int type){
+  assert(cond);
+  const char *expr = cond->expr;
+  TCLIST *ranges = tclistnew();
+  char rbuf[TDBIDXNUMSIZ*2];
+  if(cond->op == TDBQCNUMOREQ){
+    TCLIST *tokens = tcstrsplit(expr, "\t\n\r ,");
+    int tnum = TCLISTNUM(tokens);
+    for(int i = 0; i < tnum; i++){
+      const char *token = TCLISTVALPTR(tokens, i);
+      if(*token == '\0') continue;
+      int64_t xnum = tcatoi(token);
+      tctdbqrynumrange(type, xnum, xnum, rbuf);
+      TCLISTPUSH(ranges, rbuf, sizeof(rbuf));
+    }
+    tclistdel(tokens);
+    tclistsort(ranges);
+    for(int i = 1; i < TCLISTNUM(ranges); i++){
+      char *prev = (char *)TCLISTVALPTR(ranges, i - 1);
+      const char *range = TCLISTVALPTR(ranges, i);
+      if(memcmp(range, prev + TDBIDXNUMSIZ, TDBIDXNUMSIZ) <= 0){
+        if(memcmp(range + TDBIDXNUMSIZ, prev + TDBIDXNUMSIZ, TDBIDXNUMSIZ) > 0)
+          memcpy(prev + TDBIDXNUMSIZ, range + TDBIDXNUMSIZ, TDBIDXNUMSIZ);
+        TCFREE(tclistremove2(ranges, i));
+        i--;
+      }
+    }
+    return ranges;
+  }
+  int64_t lower = INT64_MIN;
+  int64_t upper = INT64_MAX;
   switch(cond->op){
-  case TDBQCSTREQ:
-    hit = vsiz == cond->esiz && !memcmp(vbuf, cond->expr, cond->esiz);
-    break;
-  case TDBQCSTRINC:
-    hit = strstr(vbuf, cond->expr) != NULL;
-    break;
-  case TDBQCSTRBW:
-    hit = tcstrfwm(vbuf, cond->expr);
-    break;
-  case TDBQCSTREW:
-    hit = tcstrbwm(vbuf, cond->expr);
-    break;
-  case TDBQCSTRAND:
-    hit = tctdbqrycondcheckstrand(vbuf, cond->expr);
-    break;
-  case TDBQCSTROR:
-    hit = tctdbqrycondcheckstror(vbuf, cond->expr);
-    break;
-  case TDBQCSTROREQ:
-    hit = tctdbqrycondcheckstroreq(vbuf, cond->expr);
-    break;
-  case TDBQCSTRRX:
-    hit = cond->regex && regexec(cond->regex, vbuf, 0, NULL, 0) == 0;
-    break;
   case TDBQCNUMEQ:
-    hit = tcatoi(vbuf) == tcatoi(cond->expr);
+    lower = tcatoi(expr);
+    upper = lower;
     break;
   case TDBQCNUMGT:
-    hit = tcatoi(vbuf) > tcatoi(cond->expr);
+    lower = tcatoi(expr);
+    if(lower == INT64_MAX) return ranges;
+    lower++;
     break;
   case TDBQCNUMGE:
-    hit = tcatoi(vbuf) >= tcatoi(cond->expr);
+    lower = tcatoi(expr);
     break;
   case TDBQCNUMLT:
-    hit = tcatoi(vbuf) < tcatoi(cond->expr);
+    upper = tcatoi(expr);
+    if(upper == INT64_MIN) return ranges;
+    upper--;
     break;
   case TDBQCNUMLE:
-    hit = tcatoi(vbuf) <= tcatoi(cond->expr);
+    upper = tcatoi(expr);
     break;
   case TDBQCNUMBT:
-    hit = tctdbqrycondchecknumbt(vbuf, cond->expr);
-    break;
-  case TDBQCNUMOREQ:
-    hit = tctdbqrycondchecknumoreq(vbuf, cond->expr);
-    break;
-  case TDBQCFTSPH:
-    hit = tctdbqrycondcheckfts(vbuf, vsiz, cond);
+    while(*expr == ' ' || *expr == ','){
+      expr++;
+    }
+    const char *pv = expr;
+    while(*pv != '\0' && *pv != ' ' && *pv != ','){
+      pv++;
+    }
+    if(*pv != ' ' && *pv != ',') pv = " ";
+    pv++;
+    while(*pv == ' ' || *pv == ','){
+      pv++;
+    }
+    lower = tcatoi(expr);
+    upper = tcatoi(pv);
+    if(lower > upper){
+      int64_t swap = lower;
+      lower = upper;
+      upper = swap;
+    }
     break;
+  default:
+    return ranges;
   }
-  return hit;
+  tctdbqrynumrange(type, lower, upper, rbuf);
+  TCLISTPUSH(ranges, rbuf, sizeof(rbuf));
+  return ranges;
 }
 
 
-/* Check whether a string includes all tokens in another string.
-   `vbuf' specifies the column value.
-   `expr' specifies the operand expression.
-   If they matches, the return value is true, else it is false. */
-static bool tctdbqrycondcheckstrand(const char *vbuf, const char *expr){
-  assert(vbuf && expr);
-  const unsigned char *sp = (unsigned char *)expr;
-  while(*sp != '\0'){
-    while((*sp != '\0' && *sp <= ' ') || *sp == ','){
-      sp++;
-    }
-    const unsigned char *ep = sp;
-    while(*ep > ' ' && *ep != ','){
-      ep++;
-    }
-    if(ep > sp){
-      bool hit = false;
-      const unsigned char *rp = (unsigned char *)vbuf;
-      while(*rp != '\0'){
-        const unsigned char *pp;
-        for(pp = sp; pp < ep; pp++, rp++){
-          if(*pp != *rp) break;
+/* Make the key range of a binary numeric index matching an integer range.
+   `type' specifies the index type.
+   `lower' specifies the lower limit of the integer range.  `INT64_MIN' means no limit.
+   `upper' specifies the upper limit of the integer range.  `INT64_MAX' means no limit.
+   `buf' specifies the buffer into which the lower key and the upper key are written.
+   Numeric conditions compare the integer parts of values, so the range of a real number index
+   covers every value whose integer part is in the integer range.  Because the keys are rounded,
+   the range also covers the adjacent integers and the conditions served by it should be checked
+   again. */
+static void tctdbqrynumrange(int type, int64_t lower, int64_t upper, char *buf){
+  assert(lower <= upper && buf);
+  uint64_t lnum, unum;
+  if(type == TDBITDOUBLE){
+    lnum = lower == INT64_MIN ? 0 : tctdbidxnumdouble(lower - 1);
+    unum = upper == INT64_MAX ? UINT64_MAX : tctdbidxnumdouble(upper + 1);
+  } else {
+    lnum = (uint64_t)lower ^ (1ULL << 63);
+    unum = (uint64_t)upper ^ (1ULL << 63);
+  }
+  tctdbidxnumkey(lnum, buf);
+  tctdbidxnumkey(unum, buf + TDBIDXNUMSIZ);
+}
+
+
+/* Retire a condition served by an index of a query.
+   `cond' specifies the condition object.
+   `type' specifies the type of the index, or the type of the column of a composite index.
+   The return value is true if the condition is retired, or false if it is kept alive.
+   The keys of a real number index only approximate the values compared by numeric conditions,
+   so a condition served by it is kept alive to be checked on each record. */
+static bool tctdbqrycondretire(TDBCOND *cond, int type){
+  assert(cond);
+  if(type == TDBITDOUBLE) return false;
+  cond->alive = false;
+  return true;
+}
+
+
+/* Estimate the number of records matching a scan of a composite index.
+   `qry' specifies the query object.
+   `idx' specifies the composite index object.
+   `pxstr' specifies the string object of the key prefix of matching records.
+   `rbuf' specifies the numeric range of the column after the prefix.  If it is `NULL', the range
+   is not used.
+   The return value is the number of the index records in the scanned region.  It is counted with
+   the counts kept in the nodes of the index, so the cost does not depend on the result size. */
+static int64_t tctdbqrycompestimate(TDBQRY *qry, TDBIDX *idx, TCXSTR *pxstr, const char *rbuf){
+  assert(qry && idx && pxstr);
+  TCXSTR *lxstr = tcxstrnew();
+  TCXSTRCAT(lxstr, TCXSTRPTR(pxstr), TCXSTRSIZE(pxstr));
+  TCXSTR *uxstr = tcxstrnew();
+  TCXSTRCAT(uxstr, TCXSTRPTR(pxstr), TCXSTRSIZE(pxstr));
+  if(rbuf){
+    TCXSTRCAT(lxstr, rbuf, TDBIDXNUMSIZ);
+    TCXSTRCAT(uxstr, rbuf + TDBIDXNUMSIZ, TDBIDXNUMSIZ);
+  }
+  char *ubuf = (char *)TCXSTRPTR(uxstr);
+  int usiz = TCXSTRSIZE(uxstr);
+  while(usiz > 0 && ((unsigned char *)ubuf)[usiz-1] == 0xff){
+    usiz--;
+  }
+  if(usiz > 0) ubuf[usiz-1]++;
+  int64_t est = tcbdbrangecount(idx->db, TCXSTRPTR(lxstr), TCXSTRSIZE(lxstr), true,
+                                usiz > 0 ? ubuf : NULL, usiz, false);
+  if(est < 0) est = tcbdbrnum(idx->db);
+  tcxstrdel(uxstr);
+  tcxstrdel(lxstr);
+  tcxstrprintf(qry->hint, "estimated records: \"%s\" %lld (composite)\n",
+               idx->name, (long long)est);
+  return est;
+}
+
+
+/* Plan a scan of a composite index for a query.
+   `qry' specifies the query object.
+   `idx' specifies the composite index object.
+   `uconds' specifies an array into which the conditions served by the index are written.  It
+   should have as many elements as the columns of the index.
+   `pxstr' specifies the string object into which the key prefix of matching records is written.
+   `rbuf' specifies the buffer into which the numeric range of the last column is written.
+   `rp' specifies the pointer to the variable into which whether `rbuf' is used is assigned.
+   The return value is the number of the conditions served by the index.  Conditions of equality
+   on leading columns form the prefix, and a condition of range on the next column ends it. */
+static int tctdbqrycompplan(TDBQRY *qry, TDBIDX *idx, TDBCOND **uconds, TCXSTR *pxstr,
+                            char *rbuf, bool *rp){
+  assert(qry && idx && uconds && pxstr && rbuf && rp);
+  *rp = false;
+  TCLIST *ccols = idx->cols;
+  if(!ccols) return 0;
+  TDBCOND *conds = qry->conds;
+  int cnum = qry->cnum;
+  int ccnum = TCLISTNUM(ccols);
+  int unum = 0;
+  for(int i = 0; i < ccnum; i++){
+    const char *cbuf;
+    int csiz;
+    TCLISTVAL(cbuf, ccols, i, csiz);
+    int ctype = *cbuf;
+    TDBCOND *econd = NULL;
+    TDBCOND *rcond = NULL;
+    for(int j = 0; j < cnum; j++){
+      TDBCOND *cond = conds + j;
+      if(!cond->alive || !cond->sign || cond->noidx) continue;
+      if(cond->nsiz != csiz - 1 || memcmp(cond->name, cbuf + 1, csiz - 1)) continue;
+      if(ctype == TDBITLEXICAL){
+        if(cond->op == TDBQCSTREQ){
+          if(!econd) econd = cond;
+        } else if(cond->op == TDBQCSTRBW){
+          if(!rcond) rcond = cond;
         }
-        if(pp == ep && (*rp <= ' ' || *rp == ',')){
-          hit = true;
+      } else {
+        switch(cond->op){
+        case TDBQCNUMEQ:
+          if(ctype == TDBITINT64){
+            if(!econd) econd = cond;
+          } else {
+            if(!rcond) rcond = cond;
+          }
+          break;
+        case TDBQCNUMGT:
+        case TDBQCNUMGE:
+        case TDBQCNUMLT:
+        case TDBQCNUMLE:
+        case TDBQCNUMBT:
+          if(!rcond) rcond = cond;
           break;
         }
-        while(*rp > ' ' && *rp != ','){
-          rp++;
-        }
-        while((*rp != '\0' && *rp <= ' ') || *rp == ','){
-          rp++;
+      }
+    }
+    if(econd){
+      uconds[unum++] = econd;
+      TCXSTRCAT(pxstr, "\1", 1);
+      if(ctype == TDBITLEXICAL){
+        TCXSTRCAT(pxstr, econd->expr, econd->esiz);
+        TCXSTRCAT(pxstr, "\0", 1);
+      } else {
+        char nbuf[TDBIDXNUMSIZ];
+        tctdbidxnumkey(tctdbidxnumenc(ctype, econd->expr), nbuf);
+        TCXSTRCAT(pxstr, nbuf, TDBIDXNUMSIZ);
+      }
+      continue;
+    }
+    if(rcond){
+      uconds[unum++] = rcond;
+      TCXSTRCAT(pxstr, "\1", 1);
+      if(ctype == TDBITLEXICAL){
+        TCXSTRCAT(pxstr, rcond->expr, rcond->esiz);
+      } else {
+        TCLIST *ranges = tctdbqrynumranges(rcond, ctype);
+        if(TCLISTNUM(ranges) > 0){
+          memcpy(rbuf, TCLISTVALPTR(ranges, 0), TDBIDXNUMSIZ * 2);
+        } else {
+          memset(rbuf, 0xff, TDBIDXNUMSIZ);
+          memset(rbuf + TDBIDXNUMSIZ, 0, TDBIDXNUMSIZ);
         }
+        tclistdel(ranges);
+        *rp = true;
       }
-      if(!hit) return false;
     }
-    sp = ep;
+    break;
   }
-  return true;
+  return unum;
 }
 
 
-/* Check whether a string includes at least one token in another string.
-   `vbuf' specifies the target value.
-   `expr' specifies the operation value.
-   If they matches, the return value is true, else it is false. */
-static bool tctdbqrycondcheckstror(const char *vbuf, const char *expr){
-  assert(vbuf && expr);
-  const unsigned char *sp = (unsigned char *)expr;
-  while(*sp != '\0'){
-    while((*sp != '\0' && *sp <= ' ') || *sp == ','){
-      sp++;
+/* Get the index to be used for ordering of a query.
+   `tdb' specifies the table database object.
+   `oname' specifies the column name for ordering.
+   `otype' specifies the type of order.
+   `ascp' specifies the pointer to the variable into which whether the index is read in
+   ascending order is assigned.
+   The return value is the index object or `NULL' if no index serves the order. */
+static TDBIDX *tctdbqryorderidx(TCTDB *tdb, const char *oname, int otype, bool *ascp){
+  assert(tdb && oname && ascp);
+  TDBIDX *idxs = tdb->idxs;
+  int inum = tdb->inum;
+  *ascp = true;
+  for(int i = 0; i < inum; i++){
+    TDBIDX *idx = idxs + i;
+    if(strcmp(idx->name, oname)) continue;
+    switch(idx->type){
+    case TDBITLEXICAL:
+      switch(otype){
+      case TDBQOSTRASC:
+        *ascp = true;
+        return idx;
+      case TDBQOSTRDESC:
+        *ascp = false;
+        return idx;
+      }
+      break;
+    case TDBITDECIMAL:
+    case TDBITINT64:
+    case TDBITDOUBLE:
+      switch(otype){
+      case TDBQONUMASC:
+        *ascp = true;
+        return idx;
+      case TDBQONUMDESC:
+        *ascp = false;
+        return idx;
+      }
+      break;
     }
-    const unsigned char *ep = sp;
-    while(*ep > ' ' && *ep != ','){
-      ep++;
+  }
+  return NULL;
+}
+
+
+/* Create a cursor of a query object.
+   `qry' specifies the query object.
+   `order' specifies whether to keep the order of the query.
+   The return value is the new cursor object. */
+static TDBQRYCUR *tctdbqrycurnewimpl(TDBQRY *qry, bool order){
+  assert(qry);
+  TCTDB *tdb = qry->tdb;
+  TDBQRYCUR *cur;
+  TCMALLOC(cur, sizeof(*cur));
+  cur->qry = qry;
+  cur->mode = TDBCMSCAN;
+  cur->iname = NULL;
+  cur->itype = TDBITVOID;
+  cur->mcond = NULL;
+  cur->asc = true;
+  cur->segs = NULL;
+  cur->sidx = 0;
+  cur->ikey = tcxstrnew();
+  cur->pkey = tcxstrnew();
+  cur->res = NULL;
+  cur->ridx = 0;
+  cur->begun = false;
+  cur->ahead = false;
+  cur->done = false;
+  cur->skip = qry->skip;
+  cur->left = qry->max;
+  TCXSTR *hint = qry->hint;
+  tcxstrclear(hint);
+  TDBIDX *midx = NULL;
+  if(order && qry->oname){
+    bool asc;
+    TDBIDX *oidx = tctdbqryorderidx(tdb, qry->oname, qry->otype, &asc);
+    if(oidx && tcbdbrnum(oidx->db) >= tchdbrnum(tdb->hdb)){
+      cur->mode = TDBCMORDER;
+      cur->asc = asc;
+      midx = oidx;
+      tcxstrprintf(hint, "using an index: \"%s\" %s (cursor order)\n",
+                   oidx->name, asc ? "asc" : "desc");
+    } else {
+      cur->mode = TDBCMLIST;
+      cur->skip = 0;
+      cur->left = INT_MAX;
+      tcxstrprintf(hint, "materializing the result (cursor)\n");
     }
-    if(ep > sp){
-      bool hit = false;
-      const unsigned char *rp = (unsigned char *)vbuf;
-      while(*rp != '\0'){
-        const unsigned char *pp;
-        for(pp = sp; pp < ep; pp++, rp++){
-          if(*pp != *rp) break;
-        }
-        if(pp == ep && (*rp <= ' ' || *rp == ',')){
-          hit = true;
+  } else {
+    TDBCOND *conds = qry->conds;
+    int cnum = qry->cnum;
+    TDBIDX *idxs = tdb->idxs;
+    int inum = tdb->inum;
+    int64_t mest = INT64_MAX;
+    int pnum = 0;
+    for(int i = 0; i < cnum; i++){
+      TDBCOND *cond = conds + i;
+      if(!cond->sign || cond->noidx) continue;
+      for(int j = 0; j < inum; j++){
+        TDBIDX *idx = idxs + j;
+        if(strcmp(cond->name, idx->name)) continue;
+        bool ok = false;
+        switch(idx->type){
+        case TDBITLEXICAL:
+          ok = cond->op == TDBQCSTREQ || cond->op == TDBQCSTRBW || cond->op == TDBQCSTROREQ;
+          break;
+        case TDBITDECIMAL:
+        case TDBITINT64:
+        case TDBITDOUBLE:
+          ok = cond->op >= TDBQCNUMEQ && cond->op <= TDBQCNUMOREQ;
           break;
         }
-        while(*rp > ' ' && *rp != ','){
-          rp++;
+        if(!ok) continue;
+        if(pnum++ < 1){
+          cur->mcond = cond;
+          midx = idx;
+          continue;
         }
-        while((*rp != '\0' && *rp <= ' ') || *rp == ','){
-          rp++;
+        if(pnum == 2) mest = tctdbqryidxestimate(qry, cur->mcond, midx);
+        int64_t est = tctdbqryidxestimate(qry, cond, idx);
+        if(est < mest){
+          cur->mcond = cond;
+          midx = idx;
+          mest = est;
         }
       }
-      if(hit) return true;
     }
-    sp = ep;
+    if(midx){
+      cur->mode = TDBCMINDEX;
+      cur->segs = tctdbqrycursegs(cur->mcond, midx);
+      tcxstrprintf(hint, "using an index: \"%s\" asc (cursor)\n", midx->name);
+    } else {
+      tcxstrprintf(hint, "scanning the whole table (cursor)\n");
+    }
+  }
+  if(midx){
+    cur->iname = tcstrdup(midx->name);
+    cur->itype = midx->type;
+  }
+  return cur;
+}
+
+
+/* Get the index traversed by a query cursor.
+   `cur' specifies the cursor object.
+   The return value is the index object or `NULL' if it has been removed. */
+static TDBIDX *tctdbqrycuridx(TDBQRYCUR *cur){
+  assert(cur);
+  TCTDB *tdb = cur->qry->tdb;
+  TDBIDX *idxs = tdb->idxs;
+  int inum = tdb->inum;
+  for(int i = 0; i < inum; i++){
+    TDBIDX *idx = idxs + i;
+    if(idx->type == cur->itype && !strcmp(idx->name, cur->iname)) return idx;
+  }
+  return NULL;
+}
+
+
+/* Get the key segments of an index matching the driving condition of a query cursor.
+   `cond' specifies the condition object.
+   `idx' specifies the index object.
+   The return value is a list object of the segments in ascending order.  Each element is a range
+   of `tctdbqrynumranges' for a binary numeric index, a column value for a lexical index, or the
+   jump key of a decimal index.  Because the object of the return value is created with the
+   function `tclistnew', it should be deleted with the function `tclistdel' when it is no longer
+   in use. */
+static TCLIST *tctdbqrycursegs(TDBCOND *cond, TDBIDX *idx){
+  assert(cond && idx);
+  if(idx->type == TDBITINT64 || idx->type == TDBITDOUBLE)
+    return tctdbqrynumranges(cond, idx->type);
+  TCLIST *segs = tclistnew();
+  if(idx->type == TDBITLEXICAL){
+    if(cond->op == TDBQCSTROREQ){
+      TCLIST *tokens = tcstrsplit(cond->expr, "\t\n\r ,");
+      tclistsort(tokens);
+      int tnum = TCLISTNUM(tokens);
+      for(int i = 0; i < tnum; i++){
+        const char *token;
+        int tsiz;
+        TCLISTVAL(token, tokens, i, tsiz);
+        if(tsiz < 1) continue;
+        if(i > 0 && !strcmp(token, TCLISTVALPTR(tokens, i - 1))) continue;
+        TCLISTPUSH(segs, token, tsiz);
+      }
+      tclistdel(tokens);
+    } else {
+      TCLISTPUSH(segs, cond->expr, cond->esiz);
+    }
+    return segs;
+  }
+  char numbuf[TCNUMBUFSIZ];
+  switch(cond->op){
+  case TDBQCNUMLT:
+  case TDBQCNUMLE:
+    TCLISTPUSH(segs, "", 0);
+    break;
+  case TDBQCNUMOREQ:
+    for(int i = 0; i < cond->numnum; i++){
+      if(i > 0 && cond->nums[i] == cond->nums[i-1]) continue;
+      int nsiz = sprintf(numbuf, "\x01%lld", (long long)cond->nums[i]);
+      TCLISTPUSH(segs, numbuf, nsiz);
+    }
+    break;
+  default:
+    TCLISTPUSH(segs, numbuf, sprintf(numbuf, "\x01%lld", (long long)cond->nums[0]));
+    break;
+  }
+  return segs;
+}
+
+
+/* Move the B+ tree cursor of an index to the beginning of the current segment of a query cursor.
+   `cur' specifies the query cursor object.
+   `idx' specifies the index object.
+   `bcur' specifies the cursor object of the index. */
+static void tctdbqrycurseek(TDBQRYCUR *cur, TDBIDX *idx, BDBCUR *bcur){
+  assert(cur && idx && bcur);
+  if(cur->mode == TDBCMORDER){
+    if(cur->asc){
+      tcbdbcurfirst(bcur);
+    } else {
+      tcbdbcurlast(bcur);
+    }
+    return;
+  }
+  const char *sbuf;
+  int ssiz;
+  TCLISTVAL(sbuf, cur->segs, cur->sidx, ssiz);
+  switch(idx->type){
+  case TDBITINT64:
+  case TDBITDOUBLE:
+    tcbdbcurjump(bcur, sbuf, TDBIDXNUMSIZ);
+    break;
+  case TDBITLEXICAL:
+    tcbdbcurjump(bcur, sbuf, ssiz + (*idx->name != '\0'));
+    break;
+  default:
+    if(ssiz > 0){
+      tcbdbcurjump(bcur, sbuf, ssiz);
+    } else {
+      tcbdbcurfirst(bcur);
+    }
+    break;
+  }
+}
+
+
+/* Check a key of an index against the current segment of a query cursor.
+   `cur' specifies the query cursor object.
+   `idx' specifies the index object.
+   `kbuf' specifies the pointer to the region of the key.
+   `ksiz' specifies the size of the region of the key.
+   The return value is 1 if the record of the key is a candidate, 0 if it should be skipped, or -1
+   if the segment is exhausted. */
+static int tctdbqrycurcheck(TDBQRYCUR *cur, TDBIDX *idx, const char *kbuf, int ksiz){
+  assert(cur && idx && kbuf && ksiz >= 0);
+  if(cur->mode == TDBCMORDER) return 1;
+  const char *sbuf;
+  int ssiz;
+  TCLISTVAL(sbuf, cur->segs, cur->sidx, ssiz);
+  TDBCOND *cond = cur->mcond;
+  switch(idx->type){
+  case TDBITINT64:
+  case TDBITDOUBLE:
+    if(ksiz < TDBIDXNUMSIZ || memcmp(kbuf, sbuf + TDBIDXNUMSIZ, TDBIDXNUMSIZ) > 0) return -1;
+    return 1;
+  case TDBITLEXICAL:
+    if(*idx->name != '\0') ksiz -= 3;
+    if(cond->op == TDBQCSTRBW) return (ksiz >= ssiz && !memcmp(kbuf, sbuf, ssiz)) ? 1 : -1;
+    return (ksiz == ssiz && !memcmp(kbuf, sbuf, ssiz)) ? 1 : -1;
+  }
+  int64_t knum = tcatoi(kbuf);
+  int64_t xnum = cond->nums[0];
+  switch(cond->op){
+  case TDBQCNUMEQ:
+    return knum == xnum ? 1 : -1;
+  case TDBQCNUMOREQ:
+    return knum == tcatoi(sbuf + 1) ? 1 : -1;
+  case TDBQCNUMGT:
+    return knum > xnum ? 1 : 0;
+  case TDBQCNUMLT:
+    if(knum > xnum) return -1;
+    return knum < xnum ? 1 : 0;
+  case TDBQCNUMLE:
+    return knum > xnum ? -1 : 1;
+  case TDBQCNUMBT:
+    return knum > cond->nums[1] ? -1 : 1;
+  }
+  return 1;
+}
+
+
+/* Get the primary key of the next record of a query cursor object.
+   `cur' specifies the cursor object.
+   `sp' specifies the pointer to the variable into which the size of the region of the return
+   value is assigned.
+   If successful, the return value is the pointer to the region of the primary key of the next
+   corresponding record, else, it is `NULL'. */
+static void *tctdbqrycurnextimpl(TDBQRYCUR *cur, int *sp){
+  assert(cur && sp);
+  if(cur->done || cur->left < 1) return NULL;
+  if(cur->mode == TDBCMSCAN) return tctdbqrycurnextscan(cur, sp);
+  if(cur->mode != TDBCMLIST) return tctdbqrycurnextidx(cur, sp);
+  if(!cur->res) cur->res = tctdbqrysearchimpl(cur->qry);
+  if(cur->ridx >= TCLISTNUM(cur->res)){
+    cur->done = true;
+    return NULL;
+  }
+  const char *pkbuf;
+  int pksiz;
+  TCLISTVAL(pkbuf, cur->res, cur->ridx, pksiz);
+  cur->ridx++;
+  char *rv;
+  TCMEMDUP(rv, pkbuf, pksiz);
+  *sp = pksiz;
+  return rv;
+}
+
+
+/* Get the primary key of the next record of a query cursor object traversing an index.
+   `cur' specifies the cursor object.
+   `sp' specifies the pointer to the variable into which the size of the region of the return
+   value is assigned.
+   If successful, the return value is the pointer to the region of the primary key of the next
+   corresponding record, else, it is `NULL'.
+   No cursor of the index is kept between calls.  The position is restored by jumping to the last
+   returned key and passing the records of the same key up to the last returned primary key, so
+   that the index can be updated between calls. */
+static void *tctdbqrycurnextidx(TDBQRYCUR *cur, int *sp){
+  assert(cur && sp);
+  TDBQRY *qry = cur->qry;
+  TCTDB *tdb = qry->tdb;
+  TDBIDX *idx = tctdbqrycuridx(cur);
+  if(!idx){
+    tctdbsetecode(tdb, TCEINVALID, __FILE__, __LINE__, __func__);
+    cur->done = true;
+    return NULL;
+  }
+  TDBCOND *conds = qry->conds;
+  int cnum = qry->cnum;
+  int acnum = 0;
+  for(int i = 0; i < cnum; i++){
+    conds[i].alive = true;
+    if(conds + i != cur->mcond || !tctdbqrycondretire(conds + i, idx->type)) acnum++;
+  }
+  bool asc = cur->asc;
+  BDBCUR *bcur = tcbdbcurnew(idx->db);
+  const char *kbuf;
+  int ksiz;
+  const char *vbuf;
+  int vsiz;
+  if(cur->begun){
+    const char *ibuf = TCXSTRPTR(cur->ikey);
+    int isiz = TCXSTRSIZE(cur->ikey);
+    const char *pkbuf = TCXSTRPTR(cur->pkey);
+    int pksiz = TCXSTRSIZE(cur->pkey);
+    if(asc){
+      tcbdbcurjump(bcur, ibuf, isiz);
+    } else {
+      tcbdbcurjumpback(bcur, ibuf, isiz);
+    }
+    while((kbuf = tcbdbcurkey3(bcur, &ksiz)) != NULL && ksiz == isiz && !memcmp(kbuf, ibuf, isiz)){
+      vbuf = tcbdbcurval3(bcur, &vsiz);
+      bool last = vsiz == pksiz && !memcmp(vbuf, pkbuf, pksiz);
+      if(asc){
+        tcbdbcurnext(bcur);
+      } else {
+        tcbdbcurprev(bcur);
+      }
+      if(last) break;
+    }
+  } else {
+    cur->begun = true;
+    tctdbqrycurseek(cur, idx, bcur);
+  }
+  char *rv = NULL;
+  while(!rv){
+    kbuf = tcbdbcurkey3(bcur, &ksiz);
+    int ck = kbuf ? tctdbqrycurcheck(cur, idx, kbuf, ksiz) : -1;
+    if(ck < 0){
+      if(cur->mode == TDBCMINDEX && cur->sidx < TCLISTNUM(cur->segs) - 1){
+        cur->sidx++;
+        tctdbqrycurseek(cur, idx, bcur);
+        continue;
+      }
+      cur->done = true;
+      break;
+    }
+    if(ck > 0){
+      vbuf = tcbdbcurval3(bcur, &vsiz);
+      if(acnum < 1 || tctdbqryallcondmatch(qry, vbuf, vsiz)){
+        if(cur->skip > 0){
+          cur->skip--;
+        } else {
+          tcxstrclear(cur->ikey);
+          TCXSTRCAT(cur->ikey, kbuf, ksiz);
+          tcxstrclear(cur->pkey);
+          TCXSTRCAT(cur->pkey, vbuf, vsiz);
+          TCMEMDUP(rv, vbuf, vsiz);
+          *sp = vsiz;
+          cur->left--;
+        }
+      }
+    }
+    if(asc){
+      tcbdbcurnext(bcur);
+    } else {
+      tcbdbcurprev(bcur);
+    }
+  }
+  tcbdbcurdel(bcur);
+  return rv;
+}
+
+
+/* Get the primary key of the next record of a query cursor object scanning the whole table.
+   `cur' specifies the cursor object.
+   `sp' specifies the pointer to the variable into which the size of the region of the return
+   value is assigned.
+   If successful, the return value is the pointer to the region of the primary key of the next
+   corresponding record, else, it is `NULL'.
+   The key of the record next to a returned one is fetched in advance, so that the returned
+   record can be removed before the next call. */
+static void *tctdbqrycurnextscan(TDBQRYCUR *cur, int *sp){
+  assert(cur && sp);
+  TDBQRY *qry = cur->qry;
+  TCHDB *hdb = qry->tdb->hdb;
+  while(true){
+    char *rbuf, *cbuf;
+    int rsiz, csiz;
+    const char *vbuf;
+    int vsiz;
+    if(cur->ahead){
+      cur->ahead = false;
+      rsiz = TCXSTRSIZE(cur->pkey);
+      TCMEMDUP(rbuf, TCXSTRPTR(cur->pkey), rsiz);
+      cbuf = tchdbget(hdb, rbuf, rsiz, &csiz);
+      if(!cbuf){
+        TCFREE(rbuf);
+        break;
+      }
+      vbuf = cbuf;
+      vsiz = csiz;
+    } else {
+      const char *pkbuf = cur->begun ? TCXSTRPTR(cur->pkey) : NULL;
+      rbuf = tchdbgetnext3(hdb, pkbuf, TCXSTRSIZE(cur->pkey), &rsiz, &vbuf, &vsiz);
+      if(!rbuf) break;
+      cbuf = NULL;
+    }
+    cur->begun = true;
+    tcxstrclear(cur->pkey);
+    TCXSTRCAT(cur->pkey, rbuf, rsiz);
+    bool hit = tctdbqryscanmatch(qry, NULL, rbuf, rsiz, vbuf, vsiz);
+    if(cbuf) TCFREE(cbuf);
+    TCFREE(rbuf);
+    if(!hit) continue;
+    if(cur->skip > 0){
+      cur->skip--;
+      continue;
+    }
+    char *rv;
+    TCMEMDUP(rv, TCXSTRPTR(cur->pkey), TCXSTRSIZE(cur->pkey));
+    *sp = TCXSTRSIZE(cur->pkey);
+    cur->left--;
+    int nsiz;
+    char *nbuf = tchdbgetnext(hdb, rv, *sp, &nsiz);
+    if(nbuf){
+      tcxstrclear(cur->pkey);
+      TCXSTRCAT(cur->pkey, nbuf, nsiz);
+      TCFREE(nbuf);
+      cur->ahead = true;
+    } else {
+      cur->done = true;
+    }
+    return rv;
+  }
+  cur->done = true;
+  return NULL;
+}
+
+
+/* Move a query cursor object to the position just after a record.
+   `cur' specifies the cursor object.
+   `pkbuf' specifies the pointer to the region of the primary key.
+   `pksiz' specifies the size of the region of the primary key.
+   If successful, the return value is true, else, it is false. */
+static bool tctdbqrycurjumpimpl(TDBQRYCUR *cur, const char *pkbuf, int pksiz){
+  assert(cur && pkbuf && pksiz >= 0);
+  TDBQRY *qry = cur->qry;
+  TCTDB *tdb = qry->tdb;
+  if(cur->mode == TDBCMLIST){
+    if(!cur->res) cur->res = tctdbqrysearchimpl(qry);
+    int rnum = TCLISTNUM(cur->res);
+    for(int i = 0; i < rnum; i++){
+      const char *rbuf;
+      int rsiz;
+      TCLISTVAL(rbuf, cur->res, i, rsiz);
+      if(rsiz == pksiz && !memcmp(rbuf, pkbuf, pksiz)){
+        cur->ridx = i + 1;
+        cur->done = false;
+        return true;
+      }
+    }
+    tctdbsetecode(tdb, TCENOREC, __FILE__, __LINE__, __func__);
+    return false;
+  }
+  TCHDB *hdb = tdb->hdb;
+  int csiz;
+  char *cbuf = tchdbget(hdb, pkbuf, pksiz, &csiz);
+  if(!cbuf){
+    tctdbsetecode(tdb, TCENOREC, __FILE__, __LINE__, __func__);
+    return false;
+  }
+  if(cur->mode == TDBCMSCAN){
+    TCFREE(cbuf);
+    int nsiz;
+    char *nbuf = tchdbgetnext(hdb, pkbuf, pksiz, &nsiz);
+    tcxstrclear(cur->pkey);
+    if(nbuf){
+      TCXSTRCAT(cur->pkey, nbuf, nsiz);
+      TCFREE(nbuf);
+    }
+    cur->begun = true;
+    cur->ahead = nbuf != NULL;
+    cur->done = !nbuf;
+    return true;
+  }
+  TDBIDX *idx = tctdbqrycuridx(cur);
+  if(!idx){
+    TCFREE(cbuf);
+    tctdbsetecode(tdb, TCEINVALID, __FILE__, __LINE__, __func__);
+    return false;
+  }
+  char *vbuf = NULL;
+  int vsiz = pksiz;
+  if(*idx->name != '\0'){
+    vbuf = tctdbrowloadone(tdb, cbuf, csiz, idx->name, strlen(idx->name), &vsiz);
+    if(!vbuf || vsiz < 1){
+      TCFREE(vbuf);
+      TCFREE(cbuf);
+      tctdbsetecode(tdb, TCENOREC, __FILE__, __LINE__, __func__);
+      return false;
+    }
+  }
+  TCFREE(cbuf);
+  TCXSTR *kxstr = tcxstrnew();
+  tctdbidxkey(idx, pkbuf, pksiz, vbuf ? vbuf : pkbuf, vsiz, kxstr);
+  TCFREE(vbuf);
+  bool hit = cur->mode == TDBCMORDER;
+  for(int i = 0; !hit && i < TCLISTNUM(cur->segs); i++){
+    cur->sidx = i;
+    hit = tctdbqrycurcheck(cur, idx, TCXSTRPTR(kxstr), TCXSTRSIZE(kxstr)) > 0;
+  }
+  if(hit){
+    tcxstrclear(cur->ikey);
+    TCXSTRCAT(cur->ikey, TCXSTRPTR(kxstr), TCXSTRSIZE(kxstr));
+    tcxstrclear(cur->pkey);
+    TCXSTRCAT(cur->pkey, pkbuf, pksiz);
+    cur->begun = true;
+    cur->done = false;
+  } else {
+    tctdbsetecode(tdb, TCENOREC, __FILE__, __LINE__, __func__);
+  }
+  tcxstrdel(kxstr);
+  return hit;
+}
+
+
+
+/* Initialize a worker of aggregation.
+   `aop' specifies the structure of the worker.
+   `qry' specifies the query object.
+   `gname' specifies the name of the grouping column or `NULL'.
+   `aname' specifies the name of the aggregated column or `NULL'. */
+static void tctdbqryaggrinit(TDBAGGROP *aop, TDBQRY *qry, const char *gname, const char *aname){
+  assert(aop && qry);
+  aop->qry = qry;
+  aop->gname = gname;
+  aop->gnsiz = gname ? strlen(gname) : 0;
+  aop->aname = aname;
+  aop->ansiz = aname ? strlen(aname) : 0;
+  aop->groups = tcmapnew();
+  aop->snum = 0;
+  aop->sanum = TDBAGGRUNIT;
+  TCMALLOC(aop->states, sizeof(*aop->states) * aop->sanum);
+}
+
+
+/* Get the state of a group of a worker of aggregation.
+   `aop' specifies the structure of the worker.
+   `gbuf' specifies the pointer to the region of the group value.
+   `gsiz' specifies the size of the region of the group value.
+   The return value is the state of the group, which is created if it does not exist.  It is
+   valid until another group is created. */
+static TDBAGGRST *tctdbqryaggrstate(TDBAGGROP *aop, const char *gbuf, int gsiz){
+  assert(aop && gbuf && gsiz >= 0);
+  int sidx;
+  int vsiz;
+  const char *vbuf = tcmapget(aop->groups, gbuf, gsiz, &vsiz);
+  if(vbuf){
+    memcpy(&sidx, vbuf, sizeof(sidx));
+    return aop->states + sidx;
+  }
+  if(aop->snum >= aop->sanum){
+    aop->sanum *= 2;
+    TCREALLOC(aop->states, aop->states, sizeof(*aop->states) * aop->sanum);
+  }
+  sidx = aop->snum++;
+  TDBAGGRST *st = aop->states + sidx;
+  memset(st, 0, sizeof(*st));
+  tcmapput(aop->groups, gbuf, gsiz, &sidx, sizeof(sidx));
+  return st;
+}
+
+
+/* Accumulate a record into a worker of aggregation.
+   `aop' specifies the structure of the worker.
+   `pkbuf' specifies the pointer to the region of the primary key.
+   `pksiz' specifies the size of the region of the primary key.
+   `cbuf' specifies the pointer to the region of the serialized columns.
+   `csiz' specifies the size of the region of the serialized columns. */
+static void tctdbqryaggrrow(TDBAGGROP *aop, const char *pkbuf, int pksiz,
+                            const char *cbuf, int csiz){
+  assert(aop && pkbuf && pksiz >= 0 && cbuf && csiz >= 0);
+  TCTDB *tdb = aop->qry->tdb;
+  char *gbuf = NULL;
+  int gsiz = 0;
+  if(aop->gname) gbuf = tctdbrowloadone(tdb, cbuf, csiz, aop->gname, aop->gnsiz, &gsiz);
+  TDBAGGRST *st = tctdbqryaggrstate(aop, gbuf ? gbuf : "", gbuf ? gsiz : 0);
+  TCFREE(gbuf);
+  st->num++;
+  const char *dbuf = pkbuf;
+  int dsiz = pksiz;
+  char *vbuf = NULL;
+  if(aop->aname){
+    int vsiz;
+    vbuf = tctdbrowloadone(tdb, cbuf, csiz, aop->aname, aop->ansiz, &vsiz);
+    if(!vbuf) return;
+    double num = tcatof(vbuf);
+    if(st->vnum < 1){
+      st->min = num;
+      st->max = num;
+    } else if(num < st->min){
+      st->min = num;
+    } else if(num > st->max){
+      st->max = num;
+    }
+    st->sum += num;
+    st->vnum++;
+    dbuf = vbuf;
+    dsiz = vsiz;
+  }
+  uint64_t hash = tctdbqryaggrhash(dbuf, dsiz);
+  int ridx = hash >> (64 - TDBAGGRRBITS);
+  hash <<= TDBAGGRRBITS;
+  int rank = 1;
+  while(rank <= 64 - TDBAGGRRBITS && !(hash & (1ULL << 63))){
+    hash <<= 1;
+    rank++;
+  }
+  if(rank > st->regs[ridx]) st->regs[ridx] = rank;
+  TCFREE(vbuf);
+}
+
+
+/* Accumulate a record for a worker of parallel aggregation.
+   `kbuf' specifies the pointer to the region of the primary key.
+   `ksiz' specifies the size of the region of the primary key.
+   `vbuf' specifies the pointer to the region of the serialized columns.
+   `vsiz' specifies the size of the region of the serialized columns.
+   `op' specifies the pointer to the structure of the worker.
+   The return value is always true. */
+static bool tctdbqryaggriter(const void *kbuf, int ksiz, const void *vbuf, int vsiz, void *op){
+  assert(kbuf && ksiz >= 0 && vbuf && vsiz >= 0 && op);
+  TDBAGGROP *aop = op;
+  if(tctdbqryscanmatch(aop->qry, NULL, kbuf, ksiz, vbuf, vsiz))
+    tctdbqryaggrrow(aop, kbuf, ksiz, vbuf, vsiz);
+  return true;
+}
+
+
+/* Merge the groups of a worker of aggregation into another.
+   `aop' specifies the structure of the destination worker.
+   `sop' specifies the structure of the source worker. */
+static void tctdbqryaggrmerge(TDBAGGROP *aop, TDBAGGROP *sop){
+  assert(aop && sop);
+  tcmapiterinit(sop->groups);
+  const char *gbuf;
+  int gsiz;
+  while((gbuf = tcmapiternext(sop->groups, &gsiz)) != NULL){
+    int sidx;
+    int vsiz;
+    memcpy(&sidx, tcmapiterval(gbuf, &vsiz), sizeof(sidx));
+    TDBAGGRST *sst = sop->states + sidx;
+    TDBAGGRST *st = tctdbqryaggrstate(aop, gbuf, gsiz);
+    if(sst->vnum > 0){
+      if(st->vnum < 1 || sst->min < st->min) st->min = sst->min;
+      if(st->vnum < 1 || sst->max > st->max) st->max = sst->max;
+    }
+    st->num += sst->num;
+    st->vnum += sst->vnum;
+    st->sum += sst->sum;
+    for(int i = 0; i < TDBAGGRRNUM; i++){
+      if(sst->regs[i] > st->regs[i]) st->regs[i] = sst->regs[i];
+    }
+  }
+}
+
+
+/* Get the hash value of a value to be counted distinctly.
+   `buf' specifies the pointer to the region of the value.
+   `size' specifies the size of the region of the value.
+   The return value is the 64-bit hash value. */
+static uint64_t tctdbqryaggrhash(const char *buf, int size){
+  assert(buf && size >= 0);
+  uint64_t hash = 14695981039346656037ULL;
+  const unsigned char *rp = (const unsigned char *)buf;
+  while(size-- > 0){
+    hash = (hash ^ *(rp++)) * 1099511628211ULL;
+  }
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccdULL;
+  hash ^= hash >> 33;
+  hash *= 0xc4ceb9fe1a85ec53ULL;
+  hash ^= hash >> 33;
+  return hash;
+}
+
+
+/* Estimate the number of distinct values from the registers of a group.
+   `regs' specifies the array of the registers.
+   The return value is the estimated number. */
+static int64_t tctdbqryaggrdistinct(const uint8_t *regs){
+  assert(regs);
+  double sum = 0;
+  int znum = 0;
+  for(int i = 0; i < TDBAGGRRNUM; i++){
+    sum += ldexp(1.0, -regs[i]);
+    if(regs[i] < 1) znum++;
+  }
+  double rnum = TDBAGGRRNUM;
+  double est = 0.7213 / (1.0 + 1.079 / rnum) * rnum * rnum / sum;
+  if(est <= rnum * 2.5 && znum > 0) est = rnum * log(rnum / znum);
+  return llround(est);
+}
+
+
+/* Rank the records corresponding to a query object by the relevance to full-text search words.
+   `qry' specifies the query object.
+   `idx' specifies the token inverted index or the q-gram inverted index.
+   `expr' specifies the string of the words separated by spaces or commas.
+   `max' specifies the maximum number of the result.
+   The return value is a map object of the primary keys and the scores of the result.
+   The score is calculated by the BM25 formula, and the top records are collected by the MaxScore
+   strategy, which skips the records which cannot exceed the score of the last record. */
+static TCMAP *tctdbqryrankimpl(TDBQRY *qry, TDBIDX *idx, const char *expr, int max){
+  assert(qry && idx && expr && max >= 0);
+  TCTDB *tdb = qry->tdb;
+  TCHDB *hdb = tdb->hdb;
+  TCXSTR *hint = qry->hint;
+  tcxstrclear(hint);
+  char *str;
+  if(idx->type == TDBITQGRAM){
+    int len = strlen(expr);
+    uint16_t *ary;
+    TCMALLOC(ary, sizeof(*ary) * (len + 1));
+    int anum;
+    tcstrutftoucs(expr, ary, &anum);
+    anum = tcstrucsnorm(ary, anum, TCUNSPACE | TCUNLOWER | TCUNNOACC | TCUNWIDTH);
+    TCMALLOC(str, anum * 3 + 1);
+    tcstrucstoutf(ary, anum, str);
+    TCFREE(ary);
+  } else {
+    str = tcstrdup(expr);
+  }
+  TCMAP *words = tcmapnew2(TDBRANKUNIT);
+  const unsigned char *sp = (unsigned char *)str;
+  while(*sp != '\0'){
+    while((*sp != '\0' && *sp <= ' ') || *sp == ','){
+      sp++;
+    }
+    const unsigned char *ep = sp;
+    while(*ep > ' ' && *ep != ','){
+      ep++;
+    }
+    if(ep > sp) tcmapputkeep(words, sp, ep - sp, "", 0);
+    sp = ep;
+  }
+  int64_t rnum, tlen;
+  if(!tctdbidxlenstat(idx, &rnum, &tlen)){
+    rnum = tchdbrnum(hdb);
+    tlen = 0;
+  }
+  double avglen = rnum > 0 ? (double)tlen / rnum : 0.0;
+  TDBRANKTERM *terms;
+  TCMALLOC(terms, sizeof(*terms) * (TCMAPRNUM(words) + 1));
+  int tnum = 0;
+  tcmapiterinit(words);
+  const char *word;
+  int wsiz;
+  while((word = tcmapiternext(words, &wsiz)) != NULL){
+    TDBRANKTERM *term = terms + tnum;
+    tctdbqryrankopen(term, idx, word, wsiz);
+    tcxstrprintf(hint, "ranking term: \"%s\" %lld\n", word, (long long)term->df);
+    if(term->df < 1){
+      tctdbqryrankclose(term);
+      continue;
+    }
+    double num = tclmax(rnum, term->df);
+    term->idf = log(1.0 + (num - term->df + 0.5) / (term->df + 0.5));
+    term->ub = term->idf * (TDBRANKK1 + 1.0);
+    tnum++;
+  }
+  if(tnum > 1) qsort(terms, tnum, sizeof(*terms),
+                     (int (*)(const void *, const void *))tctdbqryrankcmpterm);
+  double *cums;
+  TCMALLOC(cums, sizeof(*cums) * (tnum + 1));
+  double *parts;
+  TCMALLOC(parts, sizeof(*parts) * (tnum + 1));
+  double sum = 0.0;
+  for(int i = 0; i < tnum; i++){
+    sum += terms[i].ub;
+    cums[i] = sum;
+    tctdbqryranknext(terms + i);
+  }
+  int ranum = TDBRANKUNIT;
+  TDBRANKREC *recs;
+  TCMALLOC(recs, sizeof(*recs) * ranum);
+  int rrnum = 0;
+  int ess = 0;
+  double thres = 0.0;
+  int64_t snum = 0;
+  TCXSTR *ckey = tcxstrnew();
+  TCXSTR *kxstr = tcxstrnew();
+  while(max > 0){
+    const TDBQGPOST *cand = NULL;
+    for(int i = ess; i < tnum; i++){
+      const TDBQGPOST *post = terms[i].post;
+      if(post && (!cand || tctdbidxqgcmppost(post, cand) < 0)) cand = post;
+    }
+    if(!cand) break;
+    TDBQGPOST cpost = *cand;
+    tcxstrclear(ckey);
+    if(cpost.pkbuf){
+      TCXSTRCAT(ckey, cpost.pkbuf, cpost.pksiz);
+      cpost.pkbuf = TCXSTRPTR(ckey);
+    } else {
+      tcxstrprintf(ckey, "%lld", (long long)cpost.pkid);
+    }
+    const char *pkbuf = TCXSTRPTR(ckey);
+    int pksiz = TCXSTRSIZE(ckey);
+    bool full = rrnum >= max;
+    double bound = ess > 0 ? cums[ess-1] : 0.0;
+    for(int i = ess; i < tnum; i++){
+      if(terms[i].post && tctdbidxqgcmppost(terms[i].post, &cpost) == 0) bound += terms[i].ub;
+    }
+    if(!full || bound > thres){
+      int len = tctdbidxlenget(idx, &cpost, kxstr);
+      double norm = len >= 0 && avglen > 0.0 ?
+        1.0 - TDBRANKB + TDBRANKB * len / avglen : 1.0;
+      double partial = 0.0;
+      for(int i = ess; i < tnum; i++){
+        parts[i] = 0.0;
+        if(terms[i].post && tctdbidxqgcmppost(terms[i].post, &cpost) == 0){
+          parts[i] = tctdbqryrankscore(terms + i, terms[i].tf, norm);
+          partial += parts[i];
+        }
+      }
+      bool hit = true;
+      for(int i = ess - 1; i >= 0; i--){
+        if(full && partial + cums[i] <= thres){
+          hit = false;
+          break;
+        }
+        int tf = tctdbqryrankseek(terms + i, &cpost);
+        parts[i] = tf > 0 ? tctdbqryrankscore(terms + i, tf, norm) : 0.0;
+        partial += parts[i];
+      }
+      if(hit){
+        snum++;
+        double score = 0.0;
+        for(int i = 0; i < tnum; i++){
+          score += parts[i];
+        }
+        if(!full || score > thres){
+          if(qry->cnum > 0){
+            int csiz;
+            char *cbuf = tchdbget(hdb, pkbuf, pksiz, &csiz);
+            if(cbuf){
+              if(!tctdbqryscanmatch(qry, NULL, pkbuf, pksiz, cbuf, csiz)) hit = false;
+              TCFREE(cbuf);
+            } else {
+              hit = false;
+            }
+          }
+          if(hit){
+            TDBRANKREC rec;
+            TCMEMDUP(rec.pkbuf, pkbuf, pksiz);
+            rec.pksiz = pksiz;
+            rec.post = cpost;
+            if(rec.post.pkbuf) rec.post.pkbuf = rec.pkbuf;
+            rec.score = score;
+            if(!full){
+              if(rrnum >= ranum){
+                ranum *= 2;
+                TCREALLOC(recs, recs, sizeof(*recs) * ranum);
+              }
+              recs[rrnum++] = rec;
+              if(rrnum >= max){
+                for(int i = rrnum / 2 - 1; i >= 0; i--){
+                  tctdbqryrankheap(recs, rrnum, i);
+                }
+              }
+            } else {
+              TCFREE(recs[0].pkbuf);
+              recs[0] = rec;
+              tctdbqryrankheap(recs, rrnum, 0);
+            }
+            if(rrnum >= max){
+              thres = recs[0].score;
+              while(ess < tnum && cums[ess] <= thres){
+                ess++;
+              }
+            }
+          }
+        }
+      }
+    }
+    for(int i = ess; i < tnum; i++){
+      if(terms[i].post && tctdbidxqgcmppost(terms[i].post, &cpost) == 0)
+        tctdbqryranknext(terms + i);
+    }
+  }
+  tcxstrdel(kxstr);
+  tcxstrdel(ckey);
+  if(rrnum > 1) qsort(recs, rrnum, sizeof(*recs),
+                      (int (*)(const void *, const void *))tctdbqryrankcmprec);
+  TCMAP *res = tcmapnew2(rrnum + 1);
+  for(int i = 0; i < rrnum; i++){
+    char vbuf[TCNUMBUFSIZ*2];
+    int vsiz = sprintf(vbuf, "%.6f", recs[i].score);
+    tcmapput(res, recs[i].pkbuf, recs[i].pksiz, vbuf, vsiz);
+    TCFREE(recs[i].pkbuf);
+  }
+  TCFREE(recs);
+  for(int i = 0; i < tnum; i++){
+    tctdbqryrankclose(terms + i);
+  }
+  TCFREE(parts);
+  TCFREE(cums);
+  TCFREE(terms);
+  tcmapdel(words);
+  TCFREE(str);
+  tcxstrprintf(hint, "scored records: %lld\n", (long long)snum);
+  qry->count = rrnum;
+  return res;
+}
+
+
+/* Open a term of ranked search.
+   `term' specifies the structure of the term.
+   `idx' specifies the token inverted index or the q-gram inverted index.
+   `word' specifies the string of the word.
+   `wsiz' specifies the size of the string.
+   A word of a q-gram inverted index which is not shorter than the unit number is treated as a
+   phrase whose postings are read lazily.  The postings of the other words are read at once. */
+static void tctdbqryrankopen(TDBRANKTERM *term, TDBIDX *idx, const char *word, int wsiz){
+  assert(term && idx && word && wsiz >= 0);
+  term->lists = NULL;
+  term->lnum = 0;
+  term->dlist = NULL;
+  tctdbidxqgaryinit(&term->ary);
+  term->bufs = tclistnew();
+  term->ai = -1;
+  term->post = NULL;
+  term->tf = 0;
+  term->df = 0;
+  term->idf = 0.0;
+  term->ub = 0.0;
+  if(idx->type == TDBITQGRAM){
+    uint16_t *ary;
+    TCMALLOC(ary, sizeof(*ary) * (wsiz + TDBIDXQGUNIT));
+    int anum;
+    tcstrutftoucs(word, ary, &anum);
+    for(int i = 0; i < TDBIDXQGUNIT; i++){
+      ary[anum+i] = 0;
+    }
+    if(anum >= TDBIDXQGUNIT){
+      term->lists = tctdbidxqgphraseopen(idx, ary, anum, &term->lnum);
+      term->dlist = term->lists;
+      for(int i = 1; i < term->lnum; i++){
+        if(term->lists[i].dnum < term->dlist->dnum) term->dlist = term->lists + i;
+      }
+      term->df = term->dlist->dnum;
+    } else {
+      tctdbidxqgprefix(idx, word, wsiz, &term->ary, term->bufs);
+    }
+    TCFREE(ary);
+  } else {
+    int csiz;
+    const char *cbuf = tcmapget(idx->cc, word, wsiz, &csiz);
+    if(cbuf) tctdbidxqgdectoken(&term->ary, cbuf, csiz);
+    cbuf = tcbdbget3(idx->db, word, wsiz, &csiz);
+    if(cbuf){
+      TCLISTPUSH(term->bufs, cbuf, csiz);
+      TCLISTVAL(cbuf, term->bufs, TCLISTNUM(term->bufs) - 1, csiz);
+      tctdbidxqgdectoken(&term->ary, cbuf, csiz);
+    }
+  }
+  if(!term->lists){
+    tctdbidxqgarynorm(&term->ary);
+    term->df = term->ary.pnum;
+  }
+}
+
+
+/* Close a term of ranked search.
+   `term' specifies the structure of the term. */
+static void tctdbqryrankclose(TDBRANKTERM *term){
+  assert(term);
+  if(term->lists){
+    for(int i = 0; i < term->lnum; i++){
+      tctdbidxqglistclose(term->lists + i);
+    }
+    TCFREE(term->lists);
+  }
+  tclistdel(term->bufs);
+  tctdbidxqgaryfree(&term->ary);
+}
+
+
+/* Move a term of ranked search to the next record having it.
+   `term' specifies the structure of the term.
+   If successful, the return value is true, else, it is false.  The current posting and the
+   frequency of the term are set. */
+static bool tctdbqryranknext(TDBRANKTERM *term){
+  assert(term);
+  if(term->lists){
+    TDBQGLIST *dlist = term->dlist;
+    while(tctdbidxqglistnext(dlist)){
+      const TDBQGPOST *post = dlist->tpost ? dlist->tpost : dlist->bpost;
+      bool hit = true;
+      for(int i = 0; hit && i < term->lnum; i++){
+        if(term->lists + i != dlist && !tctdbidxqglistseek(term->lists + i, post)) hit = false;
+      }
+      if(!hit) continue;
+      int tf = tctdbidxqgphrasecnt(term->lists, term->lnum, INT_MAX);
+      if(tf > 0){
+        term->post = post;
+        term->tf = tf;
+        return true;
+      }
+    }
+  } else if(term->ai < term->ary.pnum && ++term->ai < term->ary.pnum){
+    term->post = term->ary.posts + term->ai;
+    term->tf = term->post->onum;
+    return true;
+  }
+  term->post = NULL;
+  term->tf = 0;
+  return false;
+}
+
+
+/* Get the frequency of a term of ranked search in a record.
+   `term' specifies the structure of the term.
+   `post' specifies the posting of the primary key of the record.
+   The return value is the frequency of the term in the record.
+   The postings are searched forward from the current position, so that a term in the ascending
+   order of the primary keys is evaluated without reading the skipped posting blocks. */
+static int tctdbqryrankseek(TDBRANKTERM *term, const TDBQGPOST *post){
+  assert(term && post);
+  term->post = NULL;
+  if(term->lists){
+    for(int i = 0; i < term->lnum; i++){
+      if(!tctdbidxqglistseek(term->lists + i, post)) return 0;
+    }
+    return tctdbidxqgphrasecnt(term->lists, term->lnum, INT_MAX);
+  }
+  TDBQGARY *ary = &term->ary;
+  term->ai = tctdbidxqgarygallop(ary, tclmax(term->ai, 0), post);
+  if(term->ai < ary->pnum && tctdbidxqgcmppost(ary->posts + term->ai, post) == 0)
+    return ary->posts[term->ai].onum;
+  return 0;
+}
+
+
+/* Calculate the score of a term of ranked search in a record.
+   `term' specifies the structure of the term.
+   `tf' specifies the frequency of the term in the record.
+   `norm' specifies the ratio of the normalized length of the record.
+   The return value is the score. */
+static double tctdbqryrankscore(const TDBRANKTERM *term, int tf, double norm){
+  assert(term && tf >= 0 && norm > 0.0);
+  return term->idf * tf * (TDBRANKK1 + 1.0) / (tf + TDBRANKK1 * norm);
+}
+
+
+/* Compare two terms of ranked search by the upper bounds of the scores.
+   `a' specifies the pointer to one term.
+   `b' specifies the pointer to the other term.
+   The return value is positive if the former is big, negative if the latter is big, 0 if both
+   are equivalent. */
+static int tctdbqryrankcmpterm(const TDBRANKTERM *a, const TDBRANKTERM *b){
+  assert(a && b);
+  return (a->ub > b->ub) - (a->ub < b->ub);
+}
+
+
+/* Compare two records of ranked search in the order of the result.
+   `a' specifies the pointer to one record.
+   `b' specifies the pointer to the other record.
+   The return value is positive if the former is ranked lower, negative if the latter is ranked
+   lower, 0 if both are equivalent.  Records of the same score are ranked by the primary keys. */
+static int tctdbqryrankcmprec(const TDBRANKREC *a, const TDBRANKREC *b){
+  assert(a && b);
+  if(a->score > b->score) return -1;
+  if(a->score < b->score) return 1;
+  return tctdbidxqgcmppost(&a->post, &b->post);
+}
+
+
+/* Restore the heap property of the records of ranked search downward from a node.
+   `recs' specifies the array of the records, whose first element is ranked the lowest.
+   `rnum' specifies the number of the records.
+   `ridx' specifies the index of the node. */
+static void tctdbqryrankheap(TDBRANKREC *recs, int rnum, int ridx){
+  assert(recs && rnum >= 0 && ridx >= 0);
+  while(true){
+    int cidx = ridx * 2 + 1;
+    if(cidx >= rnum) break;
+    if(cidx + 1 < rnum && tctdbqryrankcmprec(recs + cidx + 1, recs + cidx) > 0) cidx++;
+    if(tctdbqryrankcmprec(recs + cidx, recs + ridx) <= 0) break;
+    TDBRANKREC swap = recs[ridx];
+    recs[ridx] = recs[cidx];
+    recs[cidx] = swap;
+    ridx = cidx;
+  }
+}
+
+
+/* Scan the whole table for a query object by partitions in parallel.
+   `qry' specifies the query object.
+   `ucond' specifies the only alive condition or `NULL' to check all conditions.
+   `max' specifies the maximum number of the result.
+   `all' specifies whether to ignore the maximum number of the result.
+   `svp' specifies the pointer to the variable into which a list object of the values of the
+   ordering column of the result is assigned.  If it is `NULL', the values are not captured.
+   The return value is a list object of the primary keys of the corresponding records.
+   The region of records is divided by `tchdbforeachpar' and the results of the workers are
+   concatenated in the order of the offsets.  Because the caller does not release the object
+   of the return value, it should be deleted with the function `tclistdel' when it is no longer
+   in use. */
+static TCLIST *tctdbqryscanpar(TDBQRY *qry, TDBCOND *ucond, int max, bool all, TCLIST **svp){
+  assert(qry);
+  TCTDB *tdb = qry->tdb;
+  int tnum = tdb->stnum;
+  bool lim = !all && max < INT_MAX;
+  pthread_mutex_t mutex;
+  if(lim && pthread_mutex_init(&mutex, NULL) != 0){
+    tctdbsetecode(tdb, TCETHREAD, __FILE__, __LINE__, __func__);
+    return tclistnew();
+  }
+  int hnum = 0;
+  TDBSCANOP *sops;
+  TCMALLOC(sops, sizeof(*sops) * tnum);
+  void **ops;
+  TCMALLOC(ops, sizeof(*ops) * tnum);
+  for(int i = 0; i < tnum; i++){
+    TDBSCANOP *sop = sops + i;
+    sop->qry = qry;
+    sop->ucond = ucond;
+    sop->res = tclistnew();
+    sop->svals = svp ? tclistnew() : NULL;
+    sop->mutex = lim ? &mutex : NULL;
+    sop->hnp = &hnum;
+    sop->max = max;
+    ops[i] = sop;
+  }
+  if(!tchdbforeachpar(tdb->hdb, tctdbqryscaniter, ops, tnum, NULL, NULL))
+    tctdbsetecode(tdb, tchdbecode(tdb->hdb), __FILE__, __LINE__, __func__);
+  TCLIST *res = sops[0].res;
+  TCLIST *svals = sops[0].svals;
+  for(int i = 1; i < tnum; i++){
+    TCLIST *wres = sops[i].res;
+    int wnum = TCLISTNUM(wres);
+    for(int j = 0; j < wnum; j++){
+      const char *pkbuf;
+      int pksiz;
+      TCLISTVAL(pkbuf, wres, j, pksiz);
+      TCLISTPUSH(res, pkbuf, pksiz);
+    }
+    tclistdel(wres);
+    TCLIST *wsvals = sops[i].svals;
+    if(wsvals){
+      int wnum = TCLISTNUM(wsvals);
+      for(int j = 0; j < wnum; j++){
+        const char *vbuf;
+        int vsiz;
+        TCLISTVAL(vbuf, wsvals, j, vsiz);
+        TCLISTPUSH(svals, vbuf, vsiz);
+      }
+      tclistdel(wsvals);
+    }
+  }
+  if(svp) *svp = svals;
+  TCFREE(ops);
+  TCFREE(sops);
+  if(lim) pthread_mutex_destroy(&mutex);
+  return res;
+}
+
+
+/* Check a record for a worker of parallel scan.
+   `kbuf' specifies the pointer to the region of the primary key.
+   `ksiz' specifies the size of the region of the primary key.
+   `vbuf' specifies the pointer to the region of the serialized columns.
+   `vsiz' specifies the size of the region of the serialized columns.
+   `op' specifies the pointer to the structure of the worker.
+   The return value is true to continue the scan or false to stop all workers. */
+static bool tctdbqryscaniter(const void *kbuf, int ksiz, const void *vbuf, int vsiz, void *op){
+  assert(kbuf && ksiz >= 0 && vbuf && vsiz >= 0 && op);
+  TDBSCANOP *sop = op;
+  if(!tctdbqryscanmatch(sop->qry, sop->ucond, kbuf, ksiz, vbuf, vsiz)) return true;
+  if(!sop->mutex){
+    TCLISTPUSH(sop->res, kbuf, ksiz);
+    if(sop->svals) tctdbqryscansval(sop->qry, sop->svals, vbuf, vsiz);
+    return true;
+  }
+  if(pthread_mutex_lock(sop->mutex) != 0) return false;
+  if(*sop->hnp < sop->max){
+    TCLISTPUSH(sop->res, kbuf, ksiz);
+    if(sop->svals) tctdbqryscansval(sop->qry, sop->svals, vbuf, vsiz);
+    (*sop->hnp)++;
+  }
+  bool cont = *sop->hnp < sop->max;
+  pthread_mutex_unlock(sop->mutex);
+  return cont;
+}
+
+
+/* Check matching of the conditions and a serialized record of full scan.
+   `qry' specifies the query object.
+   `ucond' specifies the only alive condition or `NULL' to check all conditions.
+   `pkbuf' specifies the pointer to the region of the primary key.
+   `pksiz' specifies the size of the region of the primary key.
+   `cbuf' specifies the pointer to the region of the serialized columns.
+   `csiz' specifies the size of the region of the serialized columns.
+   If they matches, the return value is true, else it is false. */
+static bool tctdbqryscanmatch(TDBQRY *qry, TDBCOND *ucond, const char *pkbuf, int pksiz,
+                              const char *cbuf, int csiz){
+  assert(qry && pkbuf && pksiz >= 0 && cbuf && csiz >= 0);
+  if(ucond){
+    bool rv;
+    if(ucond->nsiz < 1){
+      char *tkbuf;
+      TCMEMDUP(tkbuf, pkbuf, pksiz);
+      rv = tctdbqrycondmatch(ucond, tkbuf, pksiz) == ucond->sign;
+      TCFREE(tkbuf);
+    } else {
+      int vsiz;
+      char *vbuf = tctdbrowloadone(qry->tdb, cbuf, csiz, ucond->name, ucond->nsiz, &vsiz);
+      if(vbuf){
+        rv = tctdbqrycondmatch(ucond, vbuf, vsiz) == ucond->sign;
+        TCFREE(vbuf);
+      } else {
+        rv = !ucond->sign;
+      }
+    }
+    return rv;
+  }
+  TDBCOND *conds = qry->conds;
+  int cnum = qry->cnum;
+  TCMAP *cols = tctdbrowloadpart(qry->tdb, cbuf, csiz, conds, cnum);
+  bool ok = true;
+  for(int i = 0; i < cnum; i++){
+    TDBCOND *cond = conds + i;
+    if(cond->nsiz < 1){
+      char *tkbuf;
+      TCMEMDUP(tkbuf, pkbuf, pksiz);
+      if(tctdbqrycondmatch(cond, tkbuf, pksiz) != cond->sign){
+        TCFREE(tkbuf);
+        ok = false;
+        break;
+      }
+      TCFREE(tkbuf);
+    } else {
+      int vsiz;
+      const char *vbuf = tcmapget(cols, cond->name, cond->nsiz, &vsiz);
+      if(vbuf){
+        if(tctdbqrycondmatch(cond, vbuf, vsiz) != cond->sign){
+          ok = false;
+          break;
+        }
+      } else {
+        if(cond->sign){
+          ok = false;
+          break;
+        }
+      }
+    }
+  }
+  tcmapdel(cols);
+  return ok;
+}
+
+
+/* Capture the value of the ordering column of a serialized record of full scan.
+   `qry' specifies the query object.
+   `svals' specifies the list object of sort values.
+   `cbuf' specifies the pointer to the region of the serialized columns.
+   `csiz' specifies the size of the region of the serialized columns.
+   Each element holds the value followed by a zero code, or is empty if the column is absent. */
+static void tctdbqryscansval(TDBQRY *qry, TCLIST *svals, const char *cbuf, int csiz){
+  assert(qry && qry->oname && svals && cbuf && csiz >= 0);
+  int vsiz;
+  char *vbuf = tctdbrowloadone(qry->tdb, cbuf, csiz, qry->oname, strlen(qry->oname), &vsiz);
+  if(vbuf){
+    TCLISTPUSH(svals, vbuf, vsiz + 1);
+    TCFREE(vbuf);
+  } else {
+    TCLISTPUSH(svals, "", 0);
+  }
+}
+
+
+/* Check matching of one condition and a record.
+   `qry' specifies the query object.
+   `cond' specifies the condition object.
+   `pkbuf' specifies the pointer to the region of the primary key.
+   `pksiz' specifies the size of the region of the primary key.
+   If they matches, the return value is true, else it is false. */
+static bool tctdbqryonecondmatch(TDBQRY *qry, TDBCOND *cond, const char *pkbuf, int pksiz){
+  assert(qry && cond && pkbuf && pksiz >= 0);
+  if(cond->nsiz < 1) return tctdbqrycondmatch(cond, pkbuf, pksiz) == cond->sign;
+  int csiz;
+  char *cbuf = tchdbget(qry->tdb->hdb, pkbuf, pksiz, &csiz);
+  if(!cbuf) return false;
+  bool rv;
+  int vsiz;
+  char *vbuf = tctdbrowloadone(qry->tdb, cbuf, csiz, cond->name, cond->nsiz, &vsiz);
+  if(vbuf){
+    rv = tctdbqrycondmatch(cond, vbuf, vsiz) == cond->sign;
+    TCFREE(vbuf);
+  } else {
+    rv = !cond->sign;
+  }
+  TCFREE(cbuf);
+  return rv;
+}
+
+
+/* Check matching of all conditions and a record.
+   `qry' specifies the query object.
+   `pkbuf' specifies the pointer to the region of the primary key.
+   `pksiz' specifies the size of the region of the primary key.
+   If they matches, the return value is true, else it is false. */
+static bool tctdbqryallcondmatch(TDBQRY *qry, const char *pkbuf, int pksiz){
+  assert(qry && pkbuf && pksiz >= 0);
+  TCTDB *tdb = qry->tdb;
+  TDBCOND *conds = qry->conds;
+  int cnum = qry->cnum;
+  int csiz;
+  char *cbuf = tchdbget(tdb->hdb, pkbuf, pksiz, &csiz);
+  if(!cbuf) return false;
+  TCMAP *cols = tctdbrowloadpart(tdb, cbuf, csiz, conds, cnum);
+  bool ok = true;
+  for(int i = 0; i < cnum; i++){
+    TDBCOND *cond = conds + i;
+    if(!cond->alive) continue;
+    if(cond->nsiz < 1){
+      if(tctdbqrycondmatch(cond, pkbuf, pksiz) != cond->sign){
+        ok = false;
+        break;
+      }
+    } else {
+      int vsiz;
+      const char *vbuf = tcmapget(cols, cond->name, cond->nsiz, &vsiz);
+      if(vbuf){
+        if(tctdbqrycondmatch(cond, vbuf, vsiz) != cond->sign){
+          ok = false;
+          break;
+        }
+      } else {
+        if(cond->sign){
+          ok = false;
+          break;
+        }
+      }
+    }
+  }
+  tcmapdel(cols);
+  TCFREE(cbuf);
+  return ok;
+}
+
+
+/* Compile the operand expression of a condition.
+   `cond' specifies the condition object.  Its operand expression and the operation type of
+   full-text search are set.
+   The regular expression, the full-text search units, and the numbers which the evaluation of
+   the operation needs are prepared. */
+static void tctdbqrycondcompile(TDBCOND *cond){
+  assert(cond);
+  const char *expr = cond->expr;
+  int op = cond->ftsop;
+  cond->regex = NULL;
+  cond->ftsunits = NULL;
+  cond->ftsnum = 0;
+  cond->nums = NULL;
+  cond->numnum = 0;
+  if(op == TDBQCSTRRX){
+    const char *rxstr = expr;
+    int rxopt = REG_EXTENDED | REG_NOSUB;
+    if(*rxstr == '*'){
+      rxopt |= REG_ICASE;
+      rxstr++;
+    }
+    regex_t rxbuf;
+    if(regcomp(&rxbuf, rxstr, rxopt) == 0){
+      TCMALLOC(cond->regex, sizeof(rxbuf));
+      memcpy(cond->regex, &rxbuf, sizeof(rxbuf));
+    }
+  } else if(op >= TDBQCNUMEQ && op <= TDBQCNUMLE){
+    TCMALLOC(cond->nums, sizeof(cond->nums[0]));
+    cond->nums[0] = tcatoi(expr);
+    cond->numnum = 1;
+  } else if(op == TDBQCNUMBT){
+    while(*expr == ' ' || *expr == ','){
+      expr++;
+    }
+    const char *pv = expr;
+    while(*pv != '\0' && *pv != ' ' && *pv != ','){
+      pv++;
+    }
+    if(*pv != ' ' && *pv != ',') pv = " ";
+    pv++;
+    while(*pv == ' ' || *pv == ','){
+      pv++;
+    }
+    int64_t lower = tcatoi(expr);
+    int64_t upper = tcatoi(pv);
+    if(lower > upper){
+      int64_t swap = lower;
+      lower = upper;
+      upper = swap;
+    }
+    TCMALLOC(cond->nums, sizeof(cond->nums[0]) * 2);
+    cond->nums[0] = lower;
+    cond->nums[1] = upper;
+    cond->numnum = 2;
+  } else if(op == TDBQCNUMOREQ){
+    TCMALLOC(cond->nums, sizeof(cond->nums[0]) * (cond->esiz / 2 + 1));
+    const char *sp = expr;
+    while(*sp != '\0'){
+      while(*sp == ' ' || *sp == ','){
+        sp++;
+      }
+      const char *ep = sp;
+      while(*ep != '\0' && *ep != ' ' && *ep != ','){
+        ep++;
+      }
+      if(ep > sp) cond->nums[cond->numnum++] = tcatoi(sp);
+      sp = ep;
+    }
+    qsort(cond->nums, cond->numnum, sizeof(cond->nums[0]), tdbcmpnumasc);
+  } else if(op >= TDBQCFTSPH && op <= TDBQCFTSEX){
+    cond->op = TDBQCFTSPH;
+    cond->ftsunits = tctdbftsparseexpr(expr, cond->esiz, op, &(cond->ftsnum));
+  }
+}
+
+
+/* Release the compiled operand expression of a condition.
+   `cond' specifies the condition object. */
+static void tctdbqrycondclear(TDBCOND *cond){
+  assert(cond);
+  if(cond->ftsunits){
+    TDBFTSUNIT *ftsunits = cond->ftsunits;
+    int ftsnum = cond->ftsnum;
+    for(int i = 0; i < ftsnum; i++){
+      TDBFTSUNIT *ftsunit = ftsunits + i;
+      tclistdel(ftsunit->tokens);
+    }
+    TCFREE(ftsunits);
+    cond->ftsunits = NULL;
+    cond->ftsnum = 0;
+  }
+  if(cond->regex){
+    regfree(cond->regex);
+    TCFREE(cond->regex);
+    cond->regex = NULL;
+  }
+  if(cond->nums){
+    TCFREE(cond->nums);
+    cond->nums = NULL;
+    cond->numnum = 0;
+  }
+}
+
+
+/* Check matching of a operand expression and a column value.
+   `cond' specifies the condition object.
+   `vbuf' specifies the column value.
+   `vsiz' specifies the size of the column value.
+   If they matches, the return value is true, else it is false. */
+static bool tctdbqrycondmatch(TDBCOND *cond, const char *vbuf, int vsiz){
+  assert(cond && vbuf && vsiz >= 0);
+  bool hit = false;
+  switch(cond->op){
+  case TDBQCSTREQ:
+    hit = vsiz == cond->esiz && !memcmp(vbuf, cond->expr, cond->esiz);
+    break;
+  case TDBQCSTRINC:
+    hit = strstr(vbuf, cond->expr) != NULL;
+    break;
+  case TDBQCSTRBW:
+    hit = tcstrfwm(vbuf, cond->expr);
+    break;
+  case TDBQCSTREW:
+    hit = tcstrbwm(vbuf, cond->expr);
+    break;
+  case TDBQCSTRAND:
+    hit = tctdbqrycondcheckstrand(vbuf, cond->expr);
+    break;
+  case TDBQCSTROR:
+    hit = tctdbqrycondcheckstror(vbuf, cond->expr);
+    break;
+  case TDBQCSTROREQ:
+    hit = tctdbqrycondcheckstroreq(vbuf, cond->expr);
+    break;
+  case TDBQCSTRRX:
+    hit = cond->regex && regexec(cond->regex, vbuf, 0, NULL, 0) == 0;
+    break;
+  case TDBQCNUMEQ:
+    hit = tcatoi(vbuf) == cond->nums[0];
+    break;
+  case TDBQCNUMGT:
+    hit = tcatoi(vbuf) > cond->nums[0];
+    break;
+  case TDBQCNUMGE:
+    hit = tcatoi(vbuf) >= cond->nums[0];
+    break;
+  case TDBQCNUMLT:
+    hit = tcatoi(vbuf) < cond->nums[0];
+    break;
+  case TDBQCNUMLE:
+    hit = tcatoi(vbuf) <= cond->nums[0];
+    break;
+  case TDBQCNUMBT:
+    hit = tctdbqrycondchecknumbt(vbuf, cond->nums);
+    break;
+  case TDBQCNUMOREQ:
+    hit = tctdbqrycondchecknumoreq(vbuf, cond->nums, cond->numnum);
+    break;
+  case TDBQCFTSPH:
+    hit = tctdbqrycondcheckfts(vbuf, vsiz, cond);
+    break;
+  }
+  return hit;
+}
+
+
+/* Check whether a string includes all tokens in another string.
+   `vbuf' specifies the column value.
+   `expr' specifies the operand expression.
+   If they matches, the return value is true, else it is false. */
+static bool tctdbqrycondcheckstrand(const char *vbuf, const char *expr){
+  assert(vbuf && expr);
+  const unsigned char *sp = (unsigned char *)expr;
+  while(*sp != '\0'){
+    while((*sp != '\0' && *sp <= ' ') || *sp == ','){
+      sp++;
+    }
+    const unsigned char *ep = sp;
+    while(*ep > ' ' && *ep != ','){
+      ep++;
+    }
+    if(ep > sp){
+      bool hit = false;
+      const unsigned char *rp = (unsigned char *)vbuf;
+      while(*rp != '\0'){
+        const unsigned char *pp;
+        for(pp = sp; pp < ep; pp++, rp++){
+          if(*pp != *rp) break;
+        }
+        if(pp == ep && (*rp <= ' ' || *rp == ',')){
+          hit = true;
+          break;
+        }
+        while(*rp > ' ' && *rp != ','){
+          rp++;
+        }
+        while((*rp != '\0' && *rp <= ' ') || *rp == ','){
+          rp++;
+        }
+      }
+      if(!hit) return false;
+    }
+    sp = ep;
+  }
+  return true;
+}
+
+
+/* Check whether a string includes at least one token in another string.
+   `vbuf' specifies the target value.
+   `expr' specifies the operation value.
+   If they matches, the return value is true, else it is false. */
+static bool tctdbqrycondcheckstror(const char *vbuf, const char *expr){
+  assert(vbuf && expr);
+  const unsigned char *sp = (unsigned char *)expr;
+  while(*sp != '\0'){
+    while((*sp != '\0' && *sp <= ' ') || *sp == ','){
+      sp++;
+    }
+    const unsigned char *ep = sp;
+    while(*ep > ' ' && *ep != ','){
+      ep++;
+    }
+    if(ep > sp){
+      bool hit = false;
+      const unsigned char *rp = (unsigned char *)vbuf;
+      while(*rp != '\0'){
+        const unsigned char *pp;
+        for(pp = sp; pp < ep; pp++, rp++){
+          if(*pp != *rp) break;
+        }
+        if(pp == ep && (*rp <= ' ' || *rp == ',')){
+          hit = true;
+          break;
+        }
+        while(*rp > ' ' && *rp != ','){
+          rp++;
+        }
+        while((*rp != '\0' && *rp <= ' ') || *rp == ','){
+          rp++;
+        }
+      }
+      if(hit) return true;
+    }
+    sp = ep;
   }
   return false;
 }
@@ -4210,54 +7445,35 @@ static bool tctdbqrycondcheckstroreq(const char *vbuf, const char *expr){
 }
 
 
-/* Check whether a decimal string is between two tokens in another string.
+/* Check whether a number is between two numbers.
    `vbuf' specifies the target value.
-   `expr' specifies the operation value.
+   `nums' specifies the array of the lower and the upper numbers.
    If they matches, the return value is true, else it is false. */
-static bool tctdbqrycondchecknumbt(const char *vbuf, const char *expr){
-  assert(vbuf && expr);
-  while(*expr == ' ' || *expr == ','){
-    expr++;
-  }
-  const char *pv = expr;
-  while(*pv != '\0' && *pv != ' ' && *pv != ','){
-    pv++;
-  }
-  if(*pv != ' ' && *pv != ',') pv = " ";
-  pv++;
-  while(*pv == ' ' || *pv == ','){
-    pv++;
-  }
-  int64_t val = tcatoi(vbuf);
-  int64_t lower = tcatoi(expr);
-  int64_t upper = tcatoi(pv);
-  if(lower > upper){
-    int64_t swap = lower;
-    lower = upper;
-    upper = swap;
-  }
-  return val >= lower && val <= upper;
+static bool tctdbqrycondchecknumbt(const char *vbuf, const int64_t *nums){
+  assert(vbuf && nums);
+  int64_t vnum = tcatoi(vbuf);
+  return vnum >= nums[0] && vnum <= nums[1];
 }
 
 
-/* Check whether a number is equal to at least one token in another string.
+/* Check whether a number is equal to at least one of numbers.
    `vbuf' specifies the target value.
-   `expr' specifies the operation value.
+   `nums' specifies the array of the numbers in ascending order.
+   `numnum' specifies the number of elements of the array.
    If they matches, the return value is true, else it is false. */
-static bool tctdbqrycondchecknumoreq(const char *vbuf, const char *expr){
-  assert(vbuf && expr);
+static bool tctdbqrycondchecknumoreq(const char *vbuf, const int64_t *nums, int numnum){
+  assert(vbuf && numnum >= 0);
   int64_t vnum = tcatoi(vbuf);
-  const char *sp = expr;
-  while(*sp != '\0'){
-    while(*sp == ' ' || *sp == ','){
-      sp++;
-    }
-    const char *ep = sp;
-    while(*ep != '\0' && *ep != ' ' && *ep != ','){
-      ep++;
+  int left = 0;
+  int right = numnum;
+  while(left < right){
+    int mid = (left + right) / 2;
+    if(nums[mid] == vnum) return true;
+    if(nums[mid] < vnum){
+      left = mid + 1;
+    } else {
+      right = mid;
     }
-    if(ep > sp && vnum == tcatoi(sp)) return true;
-    sp = ep;
   }
   return false;
 }
@@ -4333,6 +7549,18 @@ static int tdbcmppkeynumdesc(const TCLISTDATUM *a, const TCLISTDATUM *b){
 }
 
 
+/* Compare two numbers by ascending order.
+   `a' specifies the pointer to a number.
+   `b' specifies the pointer to the other number.
+   The return value is positive if the former is big, negative if the latter is big, 0 if both
+   are equivalent. */
+static int tdbcmpnumasc(const void *a, const void *b){
+  int64_t anum = *(int64_t *)a;
+  int64_t bnum = *(int64_t *)b;
+  return anum < bnum ? -1 : anum > bnum ? 1 : 0;
+}
+
+
 /* Compare two sort keys by string ascending.
    `a' specifies a key.
    `b' specifies of the other key.
@@ -4431,6 +7659,104 @@ static uint16_t tctdbidxhash(const char *pkbuf, int pksiz){
 }
 
 
+/* Encode a column value into the order-preserving number of a binary numeric index.
+   `type' specifies the index type.
+   `str' specifies the string of the column value.
+   The return value is the number whose unsigned order is the same as the numeric order. */
+static uint64_t tctdbidxnumenc(int type, const char *str){
+  assert(str);
+  if(type == TDBITDOUBLE) return tctdbidxnumdouble(tctdbidxnumreal(str));
+  return (uint64_t)tcatoi(str) ^ (1ULL << 63);
+}
+
+
+/* Convert a column value into the real number of a binary numeric index.
+   `str' specifies the string of the column value.
+   The return value is the real number.  The integer part is parsed by `tcatoi' as numeric
+   conditions do and only the digits of the fraction are added, so that an exponent or a special
+   name never moves a value away from the integer part which the conditions compare. */
+static double tctdbidxnumreal(const char *str){
+  assert(str);
+  int64_t inum = tcatoi(str);
+  while(*str > '\0' && *str <= ' '){
+    str++;
+  }
+  bool neg = *str == '-';
+  if(*str == '-' || *str == '+') str++;
+  while(*str >= '0' && *str <= '9'){
+    str++;
+  }
+  long double fnum = 0;
+  if(*str == '.'){
+    str++;
+    long double base = 10;
+    while(*str >= '0' && *str <= '9'){
+      fnum += (*str - '0') / base;
+      base *= 10;
+      str++;
+    }
+  }
+  return neg ? inum - fnum : inum + fnum;
+}
+
+
+/* Encode a real number into the order-preserving number of a binary numeric index.
+   `num' specifies the real number.  Negative zero is regarded as zero.
+   The return value is the number whose unsigned order is the same as the numeric order. */
+static uint64_t tctdbidxnumdouble(double num){
+  if(num == 0.0) num = 0.0;
+  uint64_t bits;
+  memcpy(&bits, &num, sizeof(bits));
+  return (bits >> 63) ? ~bits : bits | (1ULL << 63);
+}
+
+
+/* Serialize the number of a binary numeric index into a key.
+   `num' specifies the encoded number.
+   `buf' specifies the buffer into which the key of `TDBIDXNUMSIZ' bytes is written.  The key is
+   big-endian so that lexical comparison follows the number. */
+static void tctdbidxnumkey(uint64_t num, char *buf){
+  assert(buf);
+  for(int i = TDBIDXNUMSIZ - 1; i >= 0; i--){
+    buf[i] = num & 0xff;
+    num >>= 8;
+  }
+}
+
+
+/* Make the key of an index for a record.
+   `idx' specifies the index object of the lexical, decimal, or binary numeric type.
+   `pkbuf' specifies the pointer to the region of the primary key.
+   `pksiz' specifies the size of the region of the primary key.
+   `vbuf' specifies the pointer to the region of the column value.
+   `vsiz' specifies the size of the region of the column value.
+   `xstr' specifies the string object into which the key is written. */
+static void tctdbidxkey(TDBIDX *idx, const char *pkbuf, int pksiz, const char *vbuf, int vsiz,
+                        TCXSTR *xstr){
+  assert(idx && pkbuf && pksiz >= 0 && vbuf && vsiz >= 0 && xstr);
+  tcxstrclear(xstr);
+  uint16_t hash = tctdbidxhash(pkbuf, pksiz);
+  char hbuf[2];
+  hbuf[0] = hash >> 8;
+  hbuf[1] = hash & 0xff;
+  if(idx->type == TDBITINT64 || idx->type == TDBITDOUBLE){
+    char *nbuf;
+    TCMEMDUP(nbuf, vbuf, vsiz);
+    char kbuf[TDBIDXNUMSIZ];
+    tctdbidxnumkey(tctdbidxnumenc(idx->type, nbuf), kbuf);
+    TCFREE(nbuf);
+    TCXSTRCAT(xstr, kbuf, TDBIDXNUMSIZ);
+    TCXSTRCAT(xstr, hbuf, sizeof(hbuf));
+  } else if(*idx->name == '\0'){
+    TCXSTRCAT(xstr, pkbuf, pksiz);
+  } else {
+    TCXSTRCAT(xstr, vbuf, vsiz);
+    TCXSTRCAT(xstr, "", 1);
+    TCXSTRCAT(xstr, hbuf, sizeof(hbuf));
+  }
+}
+
+
 /* Add a record into indices of a table database object.
    `tdb' specifies the table database object.
    `pkbuf' specifies the pointer to the region of the primary key.
@@ -4462,6 +7788,10 @@ static bool tctdbidxput(TCTDB *tdb, const void *pkbuf, int pksiz, TCMAP *cols){
         err = true;
       }
       break;
+    case TDBITINT64:
+    case TDBITDOUBLE:
+      if(!tctdbidxputone(tdb, idx, pkbuf, pksiz, hash, rbuf, pksiz)) err = true;
+      break;
     case TDBITTOKEN:
       if(!tctdbidxputtoken(tdb, idx, pkbuf, pksiz, pkbuf, pksiz)) err = true;
       break;
@@ -4483,6 +7813,8 @@ static bool tctdbidxput(TCTDB *tdb, const void *pkbuf, int pksiz, TCMAP *cols){
       switch(idx->type){
       case TDBITLEXICAL:
       case TDBITDECIMAL:
+      case TDBITINT64:
+      case TDBITDOUBLE:
         if(!tctdbidxputone(tdb, idx, pkbuf, pksiz, hash, vbuf, vsiz)) err = true;
         break;
       case TDBITTOKEN:
@@ -4498,6 +7830,153 @@ static bool tctdbidxput(TCTDB *tdb, const void *pkbuf, int pksiz, TCMAP *cols){
 }
 
 
+/* Collect the statistics of an index and store them into its opaque region.
+   `idx' specifies the index object.
+   The number of entries, the number of distinct column values, and the positions of the
+   minimum, the equi-depth quantiles, and the maximum are recorded.  Only lexical, decimal, and
+   binary numeric indices are supported. */
+static void tctdbidxstatset(TDBIDX *idx){
+  assert(idx);
+  switch(idx->type){
+  case TDBITLEXICAL:
+  case TDBITDECIMAL:
+  case TDBITINT64:
+  case TDBITDOUBLE:
+    break;
+  default:
+    return;
+  }
+  char *opq = tcbdbopaque(idx->db);
+  if(!opq) return;
+  memset(opq, 0, TDBIDXSTOFF + TDBIDXSTPNUM * sizeof(uint64_t));
+  int64_t snum = tcbdbrnum(idx->db);
+  if(snum < 1) return;
+  bool bin = idx->type == TDBITINT64 || idx->type == TDBITDOUBLE;
+  bool trim = *idx->name != '\0';
+  uint64_t poss[TDBIDXSTPNUM];
+  int pnum = 0;
+  int64_t knum = 0;
+  int64_t cnt = 0;
+  uint64_t pos = 0;
+  TCXSTR *pxstr = tcxstrnew();
+  BDBCUR *cur = tcbdbcurnew(idx->db);
+  tcbdbcurfirst(cur);
+  const char *kbuf;
+  int ksiz;
+  while((kbuf = tcbdbcurkey3(cur, &ksiz)) != NULL){
+    int vsiz = bin ? tclmin(ksiz, TDBIDXNUMSIZ) : trim ? tclmax(ksiz - 3, 0) : ksiz;
+    if(knum < 1 || vsiz != TCXSTRSIZE(pxstr) || memcmp(kbuf, TCXSTRPTR(pxstr), vsiz)){
+      tcxstrclear(pxstr);
+      TCXSTRCAT(pxstr, kbuf, vsiz);
+      pos = tctdbidxstatpos(idx->type, kbuf, vsiz);
+      if(knum < 1) poss[pnum++] = pos;
+      knum++;
+    }
+    cnt++;
+    while(pnum < TDBIDXSTPNUM - 1 && cnt * (TDBIDXSTPNUM - 1) >= snum * pnum){
+      poss[pnum++] = pos;
+    }
+    tcbdbcurnext(cur);
+  }
+  tcbdbcurdel(cur);
+  tcxstrdel(pxstr);
+  if(knum < 1) return;
+  while(pnum < TDBIDXSTPNUM){
+    poss[pnum++] = pos;
+  }
+  opq[0] = TDBIDXSTMAGIC;
+  opq[1] = TDBIDXSTPNUM;
+  uint32_t lnum = TCHTOIL(tclmin(cnt, UINT32_MAX));
+  memcpy(opq + 4, &lnum, sizeof(lnum));
+  lnum = TCHTOIL(tclmin(knum, UINT32_MAX));
+  memcpy(opq + 8, &lnum, sizeof(lnum));
+  for(int i = 0; i < TDBIDXSTPNUM; i++){
+    uint64_t llnum = TCHTOILL(poss[i]);
+    memcpy(opq + TDBIDXSTOFF + i * sizeof(llnum), &llnum, sizeof(llnum));
+  }
+}
+
+
+/* Get the statistics of an index.
+   `idx' specifies the index object.
+   `stat' specifies the structure into which the statistics are written.
+   If the index has valid statistics, the return value is true, else, it is false. */
+static bool tctdbidxstatget(TDBIDX *idx, TDBIDXSTAT *stat){
+  assert(idx && stat);
+  switch(idx->type){
+  case TDBITLEXICAL:
+  case TDBITDECIMAL:
+  case TDBITINT64:
+  case TDBITDOUBLE:
+    break;
+  default:
+    return false;
+  }
+  const char *opq = tcbdbopaque(idx->db);
+  if(!opq || *(uint8_t *)opq != TDBIDXSTMAGIC || opq[1] != TDBIDXSTPNUM) return false;
+  uint32_t lnum;
+  memcpy(&lnum, opq + 4, sizeof(lnum));
+  stat->snum = TCITOHL(lnum);
+  memcpy(&lnum, opq + 8, sizeof(lnum));
+  stat->knum = TCITOHL(lnum);
+  if(stat->snum < 1 || stat->knum < 1) return false;
+  for(int i = 0; i < TDBIDXSTPNUM; i++){
+    uint64_t llnum;
+    memcpy(&llnum, opq + TDBIDXSTOFF + i * sizeof(llnum), sizeof(llnum));
+    stat->poss[i] = TCITOHLL(llnum);
+  }
+  return true;
+}
+
+
+/* Get the position of a column value in the order of an index.
+   `type' specifies the index type.
+   `vbuf' specifies the pointer to the region of the column value or the binary numeric key.
+   `vsiz' specifies the size of the region.
+   The return value is the number whose unsigned order approximates the order of the index. */
+static uint64_t tctdbidxstatpos(int type, const char *vbuf, int vsiz){
+  assert(vbuf && vsiz >= 0);
+  if(type == TDBITDECIMAL){
+    char nbuf[TCNUMBUFSIZ];
+    vsiz = tclmin(vsiz, sizeof(nbuf) - 1);
+    memcpy(nbuf, vbuf, vsiz);
+    nbuf[vsiz] = '\0';
+    return tctdbidxnumenc(TDBITDOUBLE, nbuf);
+  }
+  uint64_t pos = 0;
+  for(int i = 0; i < TDBIDXNUMSIZ; i++){
+    pos = (pos << 8) | (i < vsiz ? ((uint8_t *)vbuf)[i] : 0);
+  }
+  return pos;
+}
+
+
+/* Get the ratio of index entries in a range of positions.
+   `stat' specifies the statistics of the index.
+   `lower' specifies the lower position, inclusive.
+   `upper' specifies the upper position, inclusive.
+   The return value is the ratio of entries, interpolated linearly in each quantile bucket. */
+static double tctdbidxstatrange(TDBIDXSTAT *stat, uint64_t lower, uint64_t upper){
+  assert(stat);
+  const uint64_t *poss = stat->poss;
+  int bnum = TDBIDXSTPNUM - 1;
+  double sum = 0;
+  for(int i = 0; i < bnum; i++){
+    uint64_t bl = poss[i];
+    uint64_t bu = poss[i+1];
+    if(lower > upper || upper < bl || lower > bu) continue;
+    if(bu <= bl){
+      sum += 1.0;
+      continue;
+    }
+    uint64_t cl = lower > bl ? lower : bl;
+    uint64_t cu = upper < bu ? upper : bu;
+    sum += ((double)(cu - cl) + 1.0) / ((double)(bu - bl) + 1.0);
+  }
+  return sum / bnum;
+}
+
+
 /* Add a column of a record into an index of a table database object.
    `tdb' specifies the table database object.
    `idx' specifies the index object.
@@ -4522,6 +8001,12 @@ static bool tctdbidxputone(TCTDB *tdb, TDBIDX *idx, const char *pkbuf, int pksiz
   rbuf[vsiz] = '\0';
   rbuf[vsiz+1] = hash >> 8;
   rbuf[vsiz+2] = hash & 0xff;
+  if(idx->type == TDBITINT64 || idx->type == TDBITDOUBLE){
+    tctdbidxnumkey(tctdbidxnumenc(idx->type, rbuf), rbuf);
+    rbuf[TDBIDXNUMSIZ] = hash >> 8;
+    rbuf[TDBIDXNUMSIZ+1] = hash & 0xff;
+    rsiz = TDBIDXNUMSIZ + 2;
+  }
   if(!tcbdbputdup(idx->db, rbuf, rsiz, pkbuf, pksiz)){
     tctdbsetecode(tdb, tcbdbecode(idx->db), __FILE__, __LINE__, __func__);
     err = true;
@@ -4573,6 +8058,7 @@ static bool tctdbidxputtoken(TCTDB *tdb, TDBIDX *idx, const char *pkbuf, int pks
     wp += pksiz;
     rsiz = wp - rbuf;
   }
+  int tnum = 0;
   const unsigned char *sp = (unsigned char *)vbuf;
   while(*sp != '\0'){
     while((*sp != '\0' && *sp <= ' ') || *sp == ','){
@@ -4582,10 +8068,14 @@ static bool tctdbidxputtoken(TCTDB *tdb, TDBIDX *idx, const char *pkbuf, int pks
     while(*ep > ' ' && *ep != ','){
       ep++;
     }
-    if(ep > sp) tcmapputcat3(cc, sp, ep - sp, rbuf, rsiz);
+    if(ep > sp){
+      tcmapputcat3(cc, sp, ep - sp, rbuf, rsiz);
+      tnum++;
+    }
     sp = ep;
   }
   if(rbuf != stack) TCFREE(rbuf);
+  if(tnum > 0 && !tctdbidxlenput(tdb, idx, pkbuf, pksiz, tnum)) err = true;
   if(tcmapmsiz(cc) > tdb->iccmax && !tctdbidxsyncicc(tdb, idx, false)) err = true;
   return !err;
 }
@@ -4651,6 +8141,7 @@ static bool tctdbidxputqgram(TCTDB *tdb, TDBIDX *idx, const char *pkbuf, int pks
   }
   TCFREE(ary);
   if(rbuf != stack) TCFREE(rbuf);
+  if(anum > 0 && !tctdbidxlenput(tdb, idx, pkbuf, pksiz, anum)) err = true;
   if(tcmapmsiz(cc) > tdb->iccmax && !tctdbidxsyncicc(tdb, idx, false)) err = true;
   return !err;
 }
@@ -4687,6 +8178,10 @@ static bool tctdbidxout(TCTDB *tdb, const void *pkbuf, int pksiz, TCMAP *cols){
         err = true;
       }
       break;
+    case TDBITINT64:
+    case TDBITDOUBLE:
+      if(!tctdbidxoutone(tdb, idx, pkbuf, pksiz, hash, rbuf, pksiz)) err = true;
+      break;
     case TDBITTOKEN:
       if(!tctdbidxouttoken(tdb, idx, pkbuf, pksiz, rbuf, pksiz)) err = true;
       break;
@@ -4708,6 +8203,8 @@ static bool tctdbidxout(TCTDB *tdb, const void *pkbuf, int pksiz, TCMAP *cols){
       switch(idx->type){
       case TDBITLEXICAL:
       case TDBITDECIMAL:
+      case TDBITINT64:
+      case TDBITDOUBLE:
         if(!tctdbidxoutone(tdb, idx, pkbuf, pksiz, hash, vbuf, vsiz)) err = true;
         break;
       case TDBITTOKEN:
@@ -4747,20 +8244,44 @@ static bool tctdbidxoutone(TCTDB *tdb, TDBIDX *idx, const char *pkbuf, int pksiz
   rbuf[vsiz] = '\0';
   rbuf[vsiz+1] = hash >> 8;
   rbuf[vsiz+2] = hash & 0xff;
+  if(idx->type == TDBITINT64 || idx->type == TDBITDOUBLE){
+    tctdbidxnumkey(tctdbidxnumenc(idx->type, rbuf), rbuf);
+    rbuf[TDBIDXNUMSIZ] = hash >> 8;
+    rbuf[TDBIDXNUMSIZ+1] = hash & 0xff;
+    rsiz = TDBIDXNUMSIZ + 2;
+  }
+  if(!tctdbidxoutdup(tdb, idx, rbuf, rsiz, pkbuf, pksiz)) err = true;
+  if(rbuf != stack) TCFREE(rbuf);
+  return !err;
+}
+
+
+/* Remove the record of a primary key from the duplicated records of an index.
+   `tdb' specifies the table database object.
+   `idx' specifies the index object.
+   `kbuf' specifies the pointer to the region of the index key.
+   `ksiz' specifies the size of the region of the index key.
+   `pkbuf' specifies the pointer to the region of the primary key.
+   `pksiz' specifies the size of the region of the primary key.
+   If successful, the return value is true, else, it is false. */
+static bool tctdbidxoutdup(TCTDB *tdb, TDBIDX *idx, const char *kbuf, int ksiz,
+                           const char *pkbuf, int pksiz){
+  assert(tdb && idx && kbuf && ksiz >= 0 && pkbuf && pksiz >= 0);
+  bool err = false;
   int ovsiz;
-  const char *ovbuf = tcbdbget3(idx->db, rbuf, rsiz, &ovsiz);
+  const char *ovbuf = tcbdbget3(idx->db, kbuf, ksiz, &ovsiz);
   if(ovbuf && ovsiz == pksiz && !memcmp(ovbuf, pkbuf, ovsiz)){
-    if(!tcbdbout(idx->db, rbuf, rsiz)){
+    if(!tcbdbout(idx->db, kbuf, ksiz)){
       tctdbsetecode(tdb, tcbdbecode(idx->db), __FILE__, __LINE__, __func__);
       err = true;
     }
   } else {
     BDBCUR *cur = tcbdbcurnew(idx->db);
-    if(tcbdbcurjump(cur, rbuf, rsiz)){
+    if(tcbdbcurjump(cur, kbuf, ksiz)){
       int oksiz;
       const char *okbuf;
       while((okbuf = tcbdbcurkey3(cur, &oksiz)) != NULL){
-        if(oksiz != rsiz || memcmp(okbuf, rbuf, oksiz)) break;
+        if(oksiz != ksiz || memcmp(okbuf, kbuf, oksiz)) break;
         ovbuf = tcbdbcurval3(cur, &ovsiz);
         if(ovsiz == pksiz && !memcmp(ovbuf, pkbuf, ovsiz)){
           if(!tcbdbcurout(cur)){
@@ -4777,7 +8298,165 @@ static bool tctdbidxoutone(TCTDB *tdb, TDBIDX *idx, const char *pkbuf, int pksiz
     }
     tcbdbcurdel(cur);
   }
-  if(rbuf != stack) TCFREE(rbuf);
+  return !err;
+}
+
+
+/* Check whether a table database object has composite indices.
+   `tdb' specifies the table database object.
+   The return value is true if at least one composite index exists, else, it is false. */
+static bool tctdbidxhascomp(TCTDB *tdb){
+  assert(tdb);
+  TDBIDX *idxs = tdb->idxs;
+  int inum = tdb->inum;
+  for(int i = 0; i < inum; i++){
+    if(idxs[i].type == TDBITCOMPOSITE) return true;
+  }
+  return false;
+}
+
+
+/* Parse the name of a composite index into its column list.
+   `name' specifies the name of the index, which is column names separated by commas.  Each
+   column name can be followed by a colon and the type name "lexical", "int64", or "double".
+   The return value is a list object of the columns or `NULL' if the name is invalid.  Each
+   element is a byte of the column type followed by the column name.  Because the object of the
+   return value is created with the function `tclistnew', it should be deleted with the function
+   `tclistdel' when it is no longer in use. */
+static TCLIST *tctdbidxcompcols(const char *name){
+  assert(name);
+  TCLIST *tokens = tcstrsplit(name, ",");
+  int tnum = TCLISTNUM(tokens);
+  TCLIST *cols = tclistnew2(tnum);
+  TCXSTR *xstr = tcxstrnew();
+  bool err = tnum < 2;
+  for(int i = 0; !err && i < tnum; i++){
+    const char *token;
+    int tsiz;
+    TCLISTVAL(token, tokens, i, tsiz);
+    int type = TDBITLEXICAL;
+    const char *pv = strrchr(token, ':');
+    if(pv){
+      type = tctdbstrtoindextype(pv + 1);
+      tsiz = pv - token;
+    }
+    if(tsiz < 1 || (type != TDBITLEXICAL && type != TDBITINT64 && type != TDBITDOUBLE)){
+      err = true;
+      break;
+    }
+    char tc = type;
+    tcxstrclear(xstr);
+    TCXSTRCAT(xstr, &tc, 1);
+    TCXSTRCAT(xstr, token, tsiz);
+    TCLISTPUSH(cols, TCXSTRPTR(xstr), TCXSTRSIZE(xstr));
+  }
+  tcxstrdel(xstr);
+  tclistdel(tokens);
+  if(err){
+    tclistdel(cols);
+    return NULL;
+  }
+  return cols;
+}
+
+
+/* Make the key of a composite index.
+   `idx' specifies the index object.
+   `cols' specifies a map object containing all columns of a record.
+   `hash' specifies the hash value of the primary key.
+   `xstr' specifies the string object into which the key is written.
+   The return value is true if the record is to be indexed, else, it is false.
+   Each column is a byte of 0x01 followed by the value, or a byte of 0x00 if the column is
+   absent.  Strings are terminated by a zero byte and numbers are binary numeric keys, so that
+   lexical order of the keys follows the column order.  A record without the first column is not
+   indexed. */
+static bool tctdbidxcompkey(TDBIDX *idx, TCMAP *cols, uint16_t hash, TCXSTR *xstr){
+  assert(idx && cols && xstr);
+  TCLIST *ccols = idx->cols;
+  if(!ccols) return false;
+  int cnum = TCLISTNUM(ccols);
+  for(int i = 0; i < cnum; i++){
+    const char *cbuf;
+    int csiz;
+    TCLISTVAL(cbuf, ccols, i, csiz);
+    int vsiz;
+    const char *vbuf = tcmapget(cols, cbuf + 1, csiz - 1, &vsiz);
+    if(!vbuf){
+      if(i < 1) return false;
+      TCXSTRCAT(xstr, "\0", 1);
+      continue;
+    }
+    TCXSTRCAT(xstr, "\1", 1);
+    if(*cbuf == TDBITLEXICAL){
+      TCXSTRCAT(xstr, vbuf, vsiz);
+      TCXSTRCAT(xstr, "\0", 1);
+    } else {
+      char nbuf[TDBIDXNUMSIZ];
+      tctdbidxnumkey(tctdbidxnumenc(*cbuf, vbuf), nbuf);
+      TCXSTRCAT(xstr, nbuf, TDBIDXNUMSIZ);
+    }
+  }
+  char hbuf[2];
+  hbuf[0] = hash >> 8;
+  hbuf[1] = hash & 0xff;
+  TCXSTRCAT(xstr, hbuf, sizeof(hbuf));
+  return true;
+}
+
+
+/* Update composite indices of a table database object for a record.
+   `tdb' specifies the table database object.
+   `pkbuf' specifies the pointer to the region of the primary key.
+   `pksiz' specifies the size of the region of the primary key.
+   `ocols' specifies a map object containing all old columns.  If it is `NULL', the record is new.
+   `ncols' specifies a map object containing all new columns.  If it is `NULL', the record is
+   removed.
+   If successful, the return value is true, else, it is false. */
+static bool tctdbidxcomp(TCTDB *tdb, const void *pkbuf, int pksiz, TCMAP *ocols, TCMAP *ncols){
+  assert(tdb && pkbuf && pksiz >= 0);
+  bool err = false;
+  TDBIDX *idxs = tdb->idxs;
+  int inum = tdb->inum;
+  for(int i = 0; i < inum; i++){
+    TDBIDX *idx = idxs + i;
+    if(idx->type != TDBITCOMPOSITE) continue;
+    if(!tctdbidxcompone(tdb, idx, pkbuf, pksiz, ocols, ncols)) err = true;
+  }
+  return !err;
+}
+
+
+/* Update a composite index of a table database object for a record.
+   `tdb' specifies the table database object.
+   `idx' specifies the index object.
+   `pkbuf' specifies the pointer to the region of the primary key.
+   `pksiz' specifies the size of the region of the primary key.
+   `ocols' specifies a map object containing all old columns.  If it is `NULL', the record is new.
+   `ncols' specifies a map object containing all new columns.  If it is `NULL', the record is
+   removed.
+   If successful, the return value is true, else, it is false. */
+static bool tctdbidxcompone(TCTDB *tdb, TDBIDX *idx, const char *pkbuf, int pksiz,
+                            TCMAP *ocols, TCMAP *ncols){
+  assert(tdb && idx && pkbuf && pksiz >= 0);
+  bool err = false;
+  uint16_t hash = tctdbidxhash(pkbuf, pksiz);
+  TCXSTR *oxstr = tcxstrnew();
+  TCXSTR *nxstr = tcxstrnew();
+  bool oidx = ocols && tctdbidxcompkey(idx, ocols, hash, oxstr);
+  bool nidx = ncols && tctdbidxcompkey(idx, ncols, hash, nxstr);
+  if(oidx && nidx && TCXSTRSIZE(oxstr) == TCXSTRSIZE(nxstr) &&
+     !memcmp(TCXSTRPTR(oxstr), TCXSTRPTR(nxstr), TCXSTRSIZE(oxstr))){
+    oidx = false;
+    nidx = false;
+  }
+  if(oidx && !tctdbidxoutdup(tdb, idx, TCXSTRPTR(oxstr), TCXSTRSIZE(oxstr), pkbuf, pksiz))
+    err = true;
+  if(nidx && !tcbdbputdup(idx->db, TCXSTRPTR(nxstr), TCXSTRSIZE(nxstr), pkbuf, pksiz)){
+    tctdbsetecode(tdb, tcbdbecode(idx->db), __FILE__, __LINE__, __func__);
+    err = true;
+  }
+  tcxstrdel(nxstr);
+  tcxstrdel(oxstr);
   return !err;
 }
 
@@ -4886,58 +8565,233 @@ static bool tctdbidxouttoken(TCTDB *tdb, TDBIDX *idx, const char *pkbuf, int pks
       }
       tcmapput(cc, sp, len, TCXSTRPTR(xstr), TCXSTRSIZE(xstr));
     }
-    sp = ep;
+    sp = ep;
+  }
+  tcxstrdel(xstr);
+  if(!tctdbidxlenout(tdb, idx, pkbuf, pksiz)) err = true;
+  if(tcmapmsiz(cc) > tdb->iccmax && !tctdbidxsyncicc(tdb, idx, false)) err = true;
+  return !err;
+}
+
+
+/* Remove a column of a record from a q-gram inverted index of a table database object.
+   `tdb' specifies the table database object.
+   `idx' specifies the index object.
+   `pkbuf' specifies the pointer to the region of the primary key.
+   `pksiz' specifies the size of the region of the primary key.
+   `vbuf' specifies the pointer to the region of the column value.
+   `vsiz' specifies the size of the region of the column value.
+   If successful, the return value is true, else, it is false. */
+static bool tctdbidxoutqgram(TCTDB *tdb, TDBIDX *idx, const char *pkbuf, int pksiz,
+                             const char *vbuf, int vsiz){
+  assert(tdb && idx && pkbuf && pksiz >= 0 && vbuf && vsiz >= 0);
+  bool err = false;
+  TCBDB *db = idx->db;
+  TCMAP *cc = idx->cc;
+  uint64_t pkid = 0;
+  for(int i = 0; i < pksiz; i++){
+    int c = pkbuf[i];
+    if(c >= '0' && c <= '9'){
+      pkid = pkid * 10 + c - '0';
+    } else {
+      pkid = 0;
+      break;
+    }
+  }
+  if(pksiz > 0 && *pkbuf == '0') pkid = 0;
+  bool packed = tctdbidxqgpacked(idx);
+  TCXSTR *xstr = tcxstrnew();
+  uint16_t *ary;
+  TCMALLOC(ary, sizeof(*ary) * (vsiz + TDBIDXQGUNIT));
+  int anum;
+  tcstrutftoucs(vbuf, ary, &anum);
+  anum = tcstrucsnorm(ary, anum, TCUNSPACE | TCUNLOWER | TCUNNOACC | TCUNWIDTH);
+  for(int i = 0; i < TDBIDXQGUNIT; i++){
+    ary[anum+i] = 0;
+  }
+  char token[TDBIDXQGUNIT*3+1];
+  for(int i = 0; i < anum; i++){
+    tcstrucstoutf(ary + i, TDBIDXQGUNIT, token);
+    int tsiz = strlen(token);
+    tcxstrclear(xstr);
+    int csiz;
+    const char *cbuf = tcmapget(cc, token, tsiz, &csiz);
+    if(cbuf){
+      while(csiz > 0){
+        const char *pv = cbuf;
+        bool ok = true;
+        if(*cbuf == '\0'){
+          cbuf++;
+          csiz--;
+          int tsiz, step;
+          TCREADVNUMBUF(cbuf, tsiz, step);
+          cbuf += step;
+          csiz -= step;
+          if(tsiz == pksiz && !memcmp(cbuf, pkbuf, tsiz)) ok = false;
+          cbuf += tsiz;
+          csiz -= tsiz;
+        } else {
+          int64_t tid;
+          int step;
+          TCREADVNUMBUF64(cbuf, tid, step);
+          if(tid == pkid) ok = false;
+          cbuf += step;
+          csiz -= step;
+        }
+        if(csiz > 0){
+          int off, step;
+          TCREADVNUMBUF(cbuf, off, step);
+          cbuf += step;
+          csiz -= step;
+          if(ok) TCXSTRCAT(xstr, pv, cbuf - pv);
+        }
+      }
+      if(csiz != 0){
+        tctdbsetecode(tdb, TCEMISC, __FILE__, __LINE__, __func__);
+        err = true;
+      }
+    }
+    cbuf = tcbdbget3(db, token, tsiz, &csiz);
+    if(cbuf){
+      while(csiz > 0){
+        const char *pv = cbuf;
+        bool ok = true;
+        if(*cbuf == '\0'){
+          cbuf++;
+          csiz--;
+          int tsiz, step;
+          TCREADVNUMBUF(cbuf, tsiz, step);
+          cbuf += step;
+          csiz -= step;
+          if(tsiz == pksiz && !memcmp(cbuf, pkbuf, tsiz)) ok = false;
+          cbuf += tsiz;
+          csiz -= tsiz;
+        } else {
+          int64_t tid;
+          int step;
+          TCREADVNUMBUF64(cbuf, tid, step);
+          if(tid == pkid) ok = false;
+          cbuf += step;
+          csiz -= step;
+        }
+        if(csiz > 0){
+          int off, step;
+          TCREADVNUMBUF(cbuf, off, step);
+          cbuf += step;
+          csiz -= step;
+          if(ok) TCXSTRCAT(xstr, pv, cbuf - pv);
+        }
+      }
+      if(csiz != 0){
+        tctdbsetecode(tdb, TCEMISC, __FILE__, __LINE__, __func__);
+        err = true;
+      }
+      if(!tcbdbout(db, token, tsiz)){
+        tctdbsetecode(tdb, tcbdbecode(db), __FILE__, __LINE__, __func__);
+        err = true;
+      }
+    }
+    tcmapput(cc, token, tsiz, TCXSTRPTR(xstr), TCXSTRSIZE(xstr));
+    if(packed && !tctdbidxqgblkout(tdb, idx, token, tsiz, pkid, pkbuf, pksiz)) err = true;
+  }
+  TCFREE(ary);
+  tcxstrdel(xstr);
+  if(!tctdbidxlenout(tdb, idx, pkbuf, pksiz)) err = true;
+  if(tcmapmsiz(cc) > tdb->iccmax && !tctdbidxsyncicc(tdb, idx, false)) err = true;
+  return !err;
+}
+
+
+/* Synchronize updated contents of an inverted cache of a table database object.
+   `tdb' specifies the table database object.
+   `idx' specifies the index object.
+   `all' specifies whether to sync all tokens.
+   If successful, the return value is true, else, it is false. */
+static bool tctdbidxsyncicc(TCTDB *tdb, TDBIDX *idx, bool all){
+  assert(tdb && idx);
+  TCBDB *db = idx->db;
+  TCMAP *cc = idx->cc;
+  int rnum = TCMAPRNUM(cc);
+  if(rnum < 1) return true;
+  bool err = false;
+  const char **keys;
+  TCMALLOC(keys, sizeof(*keys) * rnum);
+  int knum = 0;
+  int64_t usiz = tcmapmsiz(cc) - sizeof(void *) * TDBIDXICCBNUM;
+  int64_t max = all ? INT64_MAX : usiz * tdb->iccsync;
+  int64_t sum = 0;
+  const char *kbuf;
+  int ksiz;
+  tcmapiterinit(cc);
+  while(sum < max && (kbuf = tcmapiternext(cc, &ksiz)) != NULL){
+    int vsiz;
+    tcmapiterval(kbuf, &vsiz);
+    keys[knum++] = kbuf;
+    sum += sizeof(TCMAPREC) + sizeof(void *) + ksiz + vsiz;
+  }
+  qsort(keys, knum, sizeof(*keys), (int(*)(const void *, const void *))tctdbidxcmpkey);
+  for(int i = 0; i < knum; i++){
+    const char *kbuf = keys[i];
+    int ksiz = strlen(kbuf);
+    int vsiz;
+    const char *vbuf = tcmapget(cc, kbuf, ksiz, &vsiz);
+    if(vsiz > 0 && !tcbdbputcat(db, kbuf, ksiz, vbuf, vsiz)){
+      tctdbsetecode(tdb, tcbdbecode(db), __FILE__, __LINE__, __func__);
+      err = true;
+    }
+    tcmapout(cc, kbuf, ksiz);
   }
-  tcxstrdel(xstr);
-  if(tcmapmsiz(cc) > tdb->iccmax && !tctdbidxsyncicc(tdb, idx, false)) err = true;
+  TCFREE(keys);
   return !err;
 }
 
 
-/* Remove a column of a record from a q-gram inverted index of a table database object.
+/* Compare two index search keys in lexical order.
+   `a' specifies the pointer to one element.
+   `b' specifies the pointer to the other element.
+   The return value is positive if the former is big, negative if the latter is big, 0 if both
+   are equivalent. */
+static int tctdbidxcmpkey(const char **a, const char **b){
+  assert(a && b);
+  const unsigned char *ap = (unsigned char *)*a;
+  const unsigned char *bp = (unsigned char *)*b;
+  while(true){
+    if(*ap == '\0') return *bp == '\0' ? 0 : -1;
+    if(*bp == '\0') return *ap == '\0' ? 0 : 1;
+    if(*ap != *bp) return *ap - *bp;
+    ap++;
+    bp++;
+  }
+  return 0;
+}
+
+
+/* Retrieve records by a token inverted index of a table database object.
    `tdb' specifies the table database object.
    `idx' specifies the index object.
-   `pkbuf' specifies the pointer to the region of the primary key.
-   `pksiz' specifies the size of the region of the primary key.
-   `vbuf' specifies the pointer to the region of the column value.
-   `vsiz' specifies the size of the region of the column value.
-   If successful, the return value is true, else, it is false. */
-static bool tctdbidxoutqgram(TCTDB *tdb, TDBIDX *idx, const char *pkbuf, int pksiz,
-                             const char *vbuf, int vsiz){
-  assert(tdb && idx && pkbuf && pksiz >= 0 && vbuf && vsiz >= 0);
-  bool err = false;
+   `token' specifies the list object of tokens.
+   `op' specifies the operation type.
+   `hint' specifies the hint object.
+   The return value is a map object of the primary keys of the corresponding records. */
+static TCMAP *tctdbidxgetbytokens(TCTDB *tdb, TDBIDX *idx, const TCLIST *tokens, int op,
+                                  TCXSTR *hint){
+  assert(tdb && idx && tokens && hint);
   TCBDB *db = idx->db;
   TCMAP *cc = idx->cc;
-  uint64_t pkid = 0;
-  for(int i = 0; i < pksiz; i++){
-    int c = pkbuf[i];
-    if(c >= '0' && c <= '9'){
-      pkid = pkid * 10 + c - '0';
-    } else {
-      pkid = 0;
-      break;
-    }
-  }
-  TCXSTR *xstr = tcxstrnew();
-  uint16_t *ary;
-  TCMALLOC(ary, sizeof(*ary) * (vsiz + TDBIDXQGUNIT));
-  int anum;
-  tcstrutftoucs(vbuf, ary, &anum);
-  anum = tcstrucsnorm(ary, anum, TCUNSPACE | TCUNLOWER | TCUNNOACC | TCUNWIDTH);
-  for(int i = 0; i < TDBIDXQGUNIT; i++){
-    ary[anum+i] = 0;
-  }
-  char token[TDBIDXQGUNIT*3+1];
-  for(int i = 0; i < anum; i++){
-    tcstrucstoutf(ary + i, TDBIDXQGUNIT, token);
-    int tsiz = strlen(token);
-    tcxstrclear(xstr);
+  int tnum = TCLISTNUM(tokens);
+  TCMAP *res = tcmapnew();
+  int cnt = 0;
+  for(int i = 0; i < tnum; i++){
+    const char *token;
+    int tsiz;
+    TCLISTVAL(token, tokens, i, tsiz);
+    if(tsiz < 1) continue;
+    int onum = 0;
+    TCMAP *wring = (cnt > 0 && op == TDBQCSTRAND) ? tcmapnew() : NULL;
     int csiz;
     const char *cbuf = tcmapget(cc, token, tsiz, &csiz);
     if(cbuf){
       while(csiz > 0){
-        const char *pv = cbuf;
-        bool ok = true;
         if(*cbuf == '\0'){
           cbuf++;
           csiz--;
@@ -4945,35 +8799,39 @@ static bool tctdbidxoutqgram(TCTDB *tdb, TDBIDX *idx, const char *pkbuf, int pks
           TCREADVNUMBUF(cbuf, tsiz, step);
           cbuf += step;
           csiz -= step;
-          if(tsiz == pksiz && !memcmp(cbuf, pkbuf, tsiz)) ok = false;
+          if(cnt < 1){
+            tcmapput(res, cbuf, tsiz, "", 0);
+          } else if(wring){
+            int rsiz;
+            if(tcmapget(res, cbuf, tsiz, &rsiz)) tcmapput(wring, cbuf, tsiz, "", 0);
+          } else {
+            tcmapput(res, cbuf, tsiz, "", 0);
+          }
           cbuf += tsiz;
           csiz -= tsiz;
         } else {
           int64_t tid;
           int step;
           TCREADVNUMBUF64(cbuf, tid, step);
-          if(tid == pkid) ok = false;
-          cbuf += step;
-          csiz -= step;
-        }
-        if(csiz > 0){
-          int off, step;
-          TCREADVNUMBUF(cbuf, off, step);
+          char pkbuf[TCNUMBUFSIZ];
+          int pksiz = sprintf(pkbuf, "%lld", (long long)tid);
+          if(cnt < 1){
+            tcmapput(res, pkbuf, pksiz, "", 0);
+          } else if(wring){
+            int rsiz;
+            if(tcmapget(res, pkbuf, pksiz, &rsiz)) tcmapput(wring, pkbuf, pksiz, "", 0);
+          } else {
+            tcmapput(res, pkbuf, pksiz, "", 0);
+          }
           cbuf += step;
           csiz -= step;
-          if(ok) TCXSTRCAT(xstr, pv, cbuf - pv);
         }
-      }
-      if(csiz != 0){
-        tctdbsetecode(tdb, TCEMISC, __FILE__, __LINE__, __func__);
-        err = true;
+        onum++;
       }
     }
     cbuf = tcbdbget3(db, token, tsiz, &csiz);
     if(cbuf){
       while(csiz > 0){
-        const char *pv = cbuf;
-        bool ok = true;
         if(*cbuf == '\0'){
           cbuf++;
           csiz--;
@@ -4981,802 +8839,1217 @@ static bool tctdbidxoutqgram(TCTDB *tdb, TDBIDX *idx, const char *pkbuf, int pks
           TCREADVNUMBUF(cbuf, tsiz, step);
           cbuf += step;
           csiz -= step;
-          if(tsiz == pksiz && !memcmp(cbuf, pkbuf, tsiz)) ok = false;
+          if(cnt < 1){
+            tcmapput(res, cbuf, tsiz, "", 0);
+          } else if(wring){
+            int rsiz;
+            if(tcmapget(res, cbuf, tsiz, &rsiz)) tcmapput(wring, cbuf, tsiz, "", 0);
+          } else {
+            tcmapput(res, cbuf, tsiz, "", 0);
+          }
           cbuf += tsiz;
           csiz -= tsiz;
         } else {
           int64_t tid;
           int step;
           TCREADVNUMBUF64(cbuf, tid, step);
-          if(tid == pkid) ok = false;
+          char pkbuf[TCNUMBUFSIZ];
+          int pksiz = sprintf(pkbuf, "%lld", (long long)tid);
+          if(cnt < 1){
+            tcmapput(res, pkbuf, pksiz, "", 0);
+          } else if(wring){
+            int rsiz;
+            if(tcmapget(res, pkbuf, pksiz, &rsiz)) tcmapput(wring, pkbuf, pksiz, "", 0);
+          } else {
+            tcmapput(res, pkbuf, pksiz, "", 0);
+          }
           cbuf += step;
           csiz -= step;
         }
-        if(csiz > 0){
-          int off, step;
-          TCREADVNUMBUF(cbuf, off, step);
-          cbuf += step;
-          csiz -= step;
-          if(ok) TCXSTRCAT(xstr, pv, cbuf - pv);
+        onum++;
+      }
+    }
+    if(wring){
+      tcmapdel(res);
+      res = wring;
+    }
+    tcxstrprintf(hint, "token occurrence: \"%s\" %d\n", token, onum);
+    cnt++;
+  }
+  return res;
+}
+
+
+/* Retrieve records by a token inverted index of a table database object.
+   `tdb' specifies the table database object.
+   `idx' specifies the index object.
+   `cond' specifies the condition object.
+   `hint' specifies the hint object.
+   The return value is a map object of the primary keys of the corresponding records. */
+static TCMAP *tctdbidxgetbyfts(TCTDB *tdb, TDBIDX *idx, TDBCOND *cond, TCXSTR *hint){
+  assert(tdb && idx && cond && hint);
+  TDBFTSUNIT *ftsunits = cond->ftsunits;
+  int ftsnum = cond->ftsnum;
+  if(ftsnum < 1) return tcmapnew2(1);
+  if(!ftsunits[0].sign) return tcmapnew2(1);
+  TCMAP *res = tcmapnew();
+  tctdbidxgetbyftsunion(idx, ftsunits->tokens, true, NULL, res, hint);
+  for(int i = 1; i < ftsnum; i++){
+    TDBFTSUNIT *ftsunit = ftsunits + i;
+    if(ftsunit->sign){
+      TCMAP *nres = tcmapnew2(TCMAPRNUM(res) + 1);
+      tctdbidxgetbyftsunion(idx, ftsunit->tokens, true, res, nres, hint);
+      tcmapdel(res);
+      res = nres;
+    } else {
+      tctdbidxgetbyftsunion(idx, ftsunit->tokens, false, res, NULL, hint);
+    }
+  }
+  return res;
+}
+
+
+/* Retrieve union records by a token inverted index of a table database object.
+   `idx' specifies the index object.
+   `tokens' specifies a list object of the union tokens.
+   `sign' specifies the logical sign.
+   `ores' specifies a map object of old primary keys.
+   `nres' specifies a map object of new primary keys.
+   `hint' specifies the hint object. */
+static void tctdbidxgetbyftsunion(TDBIDX *idx, const TCLIST *tokens, bool sign,
+                                  TCMAP *ores, TCMAP *nres, TCXSTR *hint){
+  assert(idx && tokens && hint);
+  int tnum = TCLISTNUM(tokens);
+  for(int i = 0; i < tnum; i++){
+    const char *word;
+    int wsiz;
+    TCLISTVAL(word, tokens, i, wsiz);
+    uint16_t *ary;
+    TCMALLOC(ary, sizeof(*ary) * (wsiz + TDBIDXQGUNIT));
+    int anum;
+    tcstrutftoucs(word, ary, &anum);
+    for(int j = 0; j < TDBIDXQGUNIT; j++){
+      ary[anum+j] = 0;
+    }
+    if(anum >= TDBIDXQGUNIT){
+      int lnum;
+      TDBQGLIST *lists = tctdbidxqgphraseopen(idx, ary, anum, &lnum);
+      TDBQGLIST *dlist = lists;
+      for(int j = 1; j < lnum; j++){
+        if(lists[j].dnum < dlist->dnum) dlist = lists + j;
+      }
+      int onum = 0;
+      while(tctdbidxqglistnext(dlist)){
+        const TDBQGPOST *post = dlist->tpost ? dlist->tpost : dlist->bpost;
+        const char *pkbuf = post->pkbuf;
+        int pksiz = post->pksiz;
+        char numbuf[TCNUMBUFSIZ];
+        if(!pkbuf){
+          pksiz = sprintf(numbuf, "%lld", (long long)post->pkid);
+          pkbuf = numbuf;
+        }
+        int rsiz;
+        if(ores && !tcmapget(ores, pkbuf, pksiz, &rsiz)) continue;
+        bool hit = true;
+        for(int j = 0; hit && j < lnum; j++){
+          if(lists + j != dlist && !tctdbidxqglistseek(lists + j, post)) hit = false;
+        }
+        if(!hit || tctdbidxqgphrasecnt(lists, lnum, 1) < 1) continue;
+        onum++;
+        tctdbidxftsmatch(ores, nres, NULL, sign, pkbuf, pksiz);
+      }
+      tcxstrprintf(hint, "token occurrence: \"%s\" %d\n", word, onum);
+      int64_t bread = 0;
+      int64_t bnum = 0;
+      for(int j = 0; j < lnum; j++){
+        bread += lists[j].bread;
+        bnum += lists[j].bnum;
+        tctdbidxqglistclose(lists + j);
+      }
+      if(bnum > 0)
+        tcxstrprintf(hint, "reading posting blocks: \"%s\" %lld of %lld\n",
+                     word, (long long)bread, (long long)bnum);
+      TCFREE(lists);
+    } else {
+      int onum = 0;
+      TCMAP *uniq = (i > 0 || ores) ? tcmapnew2(UINT16_MAX) : NULL;
+      TDBQGARY qary;
+      tctdbidxqgaryinit(&qary);
+      TCLIST *bufs = tclistnew();
+      tctdbidxqgprefix(idx, word, wsiz, &qary, bufs);
+      for(int j = 0; j < qary.pnum; j++){
+        const TDBQGPOST *post = qary.posts + j;
+        char numbuf[TCNUMBUFSIZ];
+        if(post->pkbuf){
+          if(tctdbidxftsmatch(ores, nres, uniq, sign, post->pkbuf, post->pksiz)) onum++;
+        } else {
+          int pksiz = sprintf(numbuf, "%lld", (long long)post->pkid);
+          if(tctdbidxftsmatch(ores, nres, uniq, sign, numbuf, pksiz)) onum++;
         }
       }
-      if(csiz != 0){
-        tctdbsetecode(tdb, TCEMISC, __FILE__, __LINE__, __func__);
+      tclistdel(bufs);
+      tctdbidxqgaryfree(&qary);
+      tcxstrprintf(hint, "token occurrence: \"%s\" %d\n",
+                   word, uniq ? (int)tcmaprnum(uniq) : onum);
+      if(uniq) tcmapdel(uniq);
+    }
+    TCFREE(ary);
+  }
+}
+
+
+/* Apply a primary key matching a union token of full-text search.
+   `ores' specifies a map object of old primary keys or `NULL'.
+   `nres' specifies a map object of new primary keys.
+   `uniq' specifies a map object to collect unique primary keys or `NULL'.
+   `sign' specifies the logical sign.
+   `pkbuf' specifies the pointer to the region of the primary key.
+   `pksiz' specifies the size of the region of the primary key.
+   The return value is true if the key is newly added into the new map, else, it is false. */
+static bool tctdbidxftsmatch(TCMAP *ores, TCMAP *nres, TCMAP *uniq, bool sign,
+                             const char *pkbuf, int pksiz){
+  assert(pkbuf && pksiz >= 0);
+  bool rv = false;
+  if(ores){
+    int rsiz;
+    if(tcmapget(ores, pkbuf, pksiz, &rsiz)){
+      if(sign){
+        tcmapputkeep(nres, pkbuf, pksiz, "", 0);
+      } else {
+        tcmapout(ores, pkbuf, pksiz);
+      }
+    }
+  } else {
+    rv = tcmapputkeep(nres, pkbuf, pksiz, "", 0);
+  }
+  if(uniq) tcmapputkeep(uniq, pkbuf, pksiz, "", 0);
+  return rv;
+}
+
+
+/* Check whether a q-gram inverted index has packed posting blocks.
+   `idx' specifies the index object.
+   The return value is true if the index has been packed, else, it is false. */
+static bool tctdbidxqgpacked(TDBIDX *idx){
+  assert(idx);
+  const char *opq = tcbdbopaque(idx->db);
+  return opq && *(uint8_t *)opq == TDBIDXQGMAGIC;
+}
+
+
+/* Pack the postings of a q-gram inverted index of a table database object.
+   `tdb' specifies the table database object.
+   `idx' specifies the index object.
+   If successful, the return value is true, else, it is false.
+   The plain list of each q-gram is merged with the blocks of the q-gram and stored again as
+   blocks sorted by the primary key.  Each block is stored with the key of the q-gram followed by
+   a null code and the first primary key of the block, so that the tree works as the skip pointers
+   of the blocks.  The number of the postings and the number of the blocks are stored with the key
+   of the q-gram followed by a null code. */
+static bool tctdbidxqgpack(TCTDB *tdb, TDBIDX *idx){
+  assert(tdb && idx);
+  if(!tctdbidxsyncicc(tdb, idx, true)) return false;
+  TCBDB *db = idx->db;
+  bool err = false;
+  TCLIST *tokens = tclistnew();
+  BDBCUR *cur = tcbdbcurnew(db);
+  tcbdbcurfirst(cur);
+  const char *kbuf;
+  int ksiz;
+  while((kbuf = tcbdbcurkey3(cur, &ksiz)) != NULL){
+    if(!memchr(kbuf, '\0', ksiz)) TCLISTPUSH(tokens, kbuf, ksiz);
+    tcbdbcurnext(cur);
+  }
+  TDBQGARY ary;
+  tctdbidxqgaryinit(&ary);
+  TCLIST *bufs = tclistnew();
+  TCLIST *okeys = tclistnew();
+  TCXSTR *kxstr = tcxstrnew();
+  TCXSTR *vxstr = tcxstrnew();
+  int tnum = TCLISTNUM(tokens);
+  for(int i = 0; !err && i < tnum; i++){
+    const char *token;
+    int tsiz;
+    TCLISTVAL(token, tokens, i, tsiz);
+    tctdbidxqgaryclear(&ary);
+    tclistclear(bufs);
+    tclistclear(okeys);
+    const char *vbuf;
+    int vsiz;
+    vbuf = tcbdbget3(db, token, tsiz, &vsiz);
+    if(vbuf){
+      TCLISTPUSH(bufs, vbuf, vsiz);
+      TCLISTVAL(vbuf, bufs, TCLISTNUM(bufs) - 1, vsiz);
+      if(!tctdbidxqgdecraw(&ary, vbuf, vsiz)) err = true;
+    }
+    tctdbidxqgkey(kxstr, token, tsiz, NULL);
+    tcbdbcurjump(cur, TCXSTRPTR(kxstr), TCXSTRSIZE(kxstr));
+    while((kbuf = tcbdbcurkey3(cur, &ksiz)) != NULL){
+      if(ksiz <= tsiz || memcmp(kbuf, TCXSTRPTR(kxstr), tsiz + 1)) break;
+      TCLISTPUSH(okeys, kbuf, ksiz);
+      if(ksiz > tsiz + 1 && (vbuf = tcbdbcurval3(cur, &vsiz)) != NULL){
+        TCLISTPUSH(bufs, vbuf, vsiz);
+        TCLISTVAL(vbuf, bufs, TCLISTNUM(bufs) - 1, vsiz);
+        if(!tctdbidxqgdecblock(&ary, vbuf, vsiz)) err = true;
+      }
+      tcbdbcurnext(cur);
+    }
+    if(err){
+      tctdbsetecode(tdb, TCEMISC, __FILE__, __LINE__, __func__);
+      break;
+    }
+    tctdbidxqgarynorm(&ary);
+    int onum = TCLISTNUM(okeys);
+    for(int j = 0; j < onum; j++){
+      TCLISTVAL(kbuf, okeys, j, ksiz);
+      if(!tcbdbout(db, kbuf, ksiz)){
+        tctdbsetecode(tdb, tcbdbecode(db), __FILE__, __LINE__, __func__);
         err = true;
       }
-      if(!tcbdbout(db, token, tsiz)){
+    }
+    if(!tcbdbout(db, token, tsiz)){
+      tctdbsetecode(tdb, tcbdbecode(db), __FILE__, __LINE__, __func__);
+      err = true;
+    }
+    int64_t bnum = 0;
+    for(int j = 0; j < ary.pnum; j += TDBIDXQGBNUM){
+      tctdbidxqgkey(kxstr, token, tsiz, ary.posts + j);
+      tctdbidxqgencblock(vxstr, &ary, j, tclmin(j + TDBIDXQGBNUM, ary.pnum));
+      if(!tcbdbput(db, TCXSTRPTR(kxstr), TCXSTRSIZE(kxstr), TCXSTRPTR(vxstr), TCXSTRSIZE(vxstr))){
         tctdbsetecode(tdb, tcbdbecode(db), __FILE__, __LINE__, __func__);
         err = true;
       }
+      bnum++;
     }
-    tcmapput(cc, token, tsiz, TCXSTRPTR(xstr), TCXSTRSIZE(xstr));
+    if(bnum > 0 && !tctdbidxqgdiradd(tdb, idx, token, tsiz, ary.pnum, bnum)) err = true;
+  }
+  tcxstrdel(vxstr);
+  tcxstrdel(kxstr);
+  tclistdel(okeys);
+  tclistdel(bufs);
+  tctdbidxqgaryfree(&ary);
+  tcbdbcurdel(cur);
+  tclistdel(tokens);
+  if(!err){
+    char *opq = tcbdbopaque(db);
+    if(opq) *(uint8_t *)opq = TDBIDXQGMAGIC;
   }
-  TCFREE(ary);
-  tcxstrdel(xstr);
-  if(tcmapmsiz(cc) > tdb->iccmax && !tctdbidxsyncicc(tdb, idx, false)) err = true;
   return !err;
 }
 
 
-/* Synchronize updated contents of an inverted cache of a table database object.
+/* Remove a record from the posting blocks of a q-gram of a table database object.
    `tdb' specifies the table database object.
    `idx' specifies the index object.
-   `all' specifies whether to sync all tokens.
+   `token' specifies the string of the q-gram.
+   `tsiz' specifies the size of the string.
+   `pkid' specifies the number of the primary key or 0 if the primary key is not numeric.
+   `pkbuf' specifies the pointer to the region of the primary key.
+   `pksiz' specifies the size of the region of the primary key.
    If successful, the return value is true, else, it is false. */
-static bool tctdbidxsyncicc(TCTDB *tdb, TDBIDX *idx, bool all){
-  assert(tdb && idx);
+static bool tctdbidxqgblkout(TCTDB *tdb, TDBIDX *idx, const char *token, int tsiz,
+                             int64_t pkid, const char *pkbuf, int pksiz){
+  assert(tdb && idx && token && tsiz >= 0 && pkbuf && pksiz >= 0);
   TCBDB *db = idx->db;
-  TCMAP *cc = idx->cc;
-  int rnum = TCMAPRNUM(cc);
-  if(rnum < 1) return true;
+  TDBQGPOST post;
+  post.pkid = pkid;
+  post.pkbuf = pkid > 0 ? NULL : pkbuf;
+  post.pksiz = pkid > 0 ? 0 : pksiz;
+  TCXSTR *kxstr = tcxstrnew();
+  tctdbidxqgkey(kxstr, token, tsiz, &post);
+  BDBCUR *cur = tcbdbcurnew(db);
+  char *okbuf = NULL;
+  int oksiz = 0;
+  char *ovbuf = NULL;
+  int ovsiz = 0;
+  if(tcbdbcurjumpback(cur, TCXSTRPTR(kxstr), TCXSTRSIZE(kxstr))){
+    const char *kbuf = tcbdbcurkey3(cur, &oksiz);
+    if(kbuf && oksiz > tsiz + 1 && !memcmp(kbuf, TCXSTRPTR(kxstr), tsiz + 1)){
+      okbuf = tcmemdup(kbuf, oksiz);
+      const char *vbuf = tcbdbcurval3(cur, &ovsiz);
+      if(vbuf) ovbuf = tcmemdup(vbuf, ovsiz);
+    }
+  }
+  tcbdbcurdel(cur);
   bool err = false;
-  const char **keys;
-  TCMALLOC(keys, sizeof(*keys) * rnum);
-  int knum = 0;
-  int64_t usiz = tcmapmsiz(cc) - sizeof(void *) * TDBIDXICCBNUM;
-  int64_t max = all ? INT64_MAX : usiz * tdb->iccsync;
-  int64_t sum = 0;
-  const char *kbuf;
-  int ksiz;
-  tcmapiterinit(cc);
-  while(sum < max && (kbuf = tcmapiternext(cc, &ksiz)) != NULL){
-    int vsiz;
-    tcmapiterval(kbuf, &vsiz);
-    keys[knum++] = kbuf;
-    sum += sizeof(TCMAPREC) + sizeof(void *) + ksiz + vsiz;
+  if(ovbuf){
+    TDBQGARY ary;
+    tctdbidxqgaryinit(&ary);
+    if(tctdbidxqgdecblock(&ary, ovbuf, ovsiz)){
+      int pi = tctdbidxqgarygallop(&ary, 0, &post);
+      if(pi < ary.pnum && tctdbidxqgcmppost(ary.posts + pi, &post) == 0){
+        ary.pnum--;
+        memmove(ary.posts + pi, ary.posts + pi + 1, sizeof(*ary.posts) * (ary.pnum - pi));
+        if(pi == 0 && !tcbdbout(db, okbuf, oksiz)){
+          tctdbsetecode(tdb, tcbdbecode(db), __FILE__, __LINE__, __func__);
+          err = true;
+        }
+        if(ary.pnum > 0){
+          TCXSTR *vxstr = tcxstrnew();
+          tctdbidxqgencblock(vxstr, &ary, 0, ary.pnum);
+          tctdbidxqgkey(kxstr, token, tsiz, ary.posts);
+          if(!tcbdbput(db, TCXSTRPTR(kxstr), TCXSTRSIZE(kxstr),
+                       TCXSTRPTR(vxstr), TCXSTRSIZE(vxstr))){
+            tctdbsetecode(tdb, tcbdbecode(db), __FILE__, __LINE__, __func__);
+            err = true;
+          }
+          tcxstrdel(vxstr);
+        }
+        if(!tctdbidxqgdiradd(tdb, idx, token, tsiz, -1, ary.pnum > 0 ? 0 : -1)) err = true;
+      }
+    } else {
+      tctdbsetecode(tdb, TCEMISC, __FILE__, __LINE__, __func__);
+      err = true;
+    }
+    tctdbidxqgaryfree(&ary);
+    TCFREE(ovbuf);
   }
-  qsort(keys, knum, sizeof(*keys), (int(*)(const void *, const void *))tctdbidxcmpkey);
-  for(int i = 0; i < knum; i++){
-    const char *kbuf = keys[i];
-    int ksiz = strlen(kbuf);
-    int vsiz;
-    const char *vbuf = tcmapget(cc, kbuf, ksiz, &vsiz);
-    if(vsiz > 0 && !tcbdbputcat(db, kbuf, ksiz, vbuf, vsiz)){
+  if(okbuf) TCFREE(okbuf);
+  tcxstrdel(kxstr);
+  return !err;
+}
+
+
+/* Add the numbers of the directory record of a q-gram of a table database object.
+   `tdb' specifies the table database object.
+   `idx' specifies the index object.
+   `token' specifies the string of the q-gram.
+   `tsiz' specifies the size of the string.
+   `dnum' specifies the additional number of the postings.
+   `bnum' specifies the additional number of the blocks.
+   If successful, the return value is true, else, it is false.
+   If the number of the postings is not positive, the record is removed. */
+static bool tctdbidxqgdiradd(TCTDB *tdb, TDBIDX *idx, const char *token, int tsiz,
+                             int64_t dnum, int64_t bnum){
+  assert(tdb && idx && token && tsiz >= 0);
+  TCBDB *db = idx->db;
+  char kbuf[TDBIDXQGUNIT*3+2];
+  memcpy(kbuf, token, tsiz);
+  kbuf[tsiz] = '\0';
+  int vsiz;
+  const char *vbuf = tcbdbget3(db, kbuf, tsiz + 1, &vsiz);
+  if(vbuf){
+    int64_t num;
+    int step;
+    TCREADVNUMBUF64(vbuf, num, step);
+    dnum += num;
+    TCREADVNUMBUF64(vbuf + step, num, step);
+    bnum += num;
+  }
+  bool err = false;
+  if(dnum > 0){
+    char vstack[TCNUMBUFSIZ*2];
+    int step;
+    TCSETVNUMBUF64(step, vstack, dnum);
+    vsiz = step;
+    TCSETVNUMBUF64(step, vstack + vsiz, tclmax(bnum, 1));
+    vsiz += step;
+    if(!tcbdbput(db, kbuf, tsiz + 1, vstack, vsiz)){
       tctdbsetecode(tdb, tcbdbecode(db), __FILE__, __LINE__, __func__);
       err = true;
     }
-    tcmapout(cc, kbuf, ksiz);
+  } else if(vbuf && !tcbdbout(db, kbuf, tsiz + 1)){
+    tctdbsetecode(tdb, tcbdbecode(db), __FILE__, __LINE__, __func__);
+    err = true;
   }
-  TCFREE(keys);
   return !err;
 }
 
 
-/* Compare two index search keys in lexical order.
-   `a' specifies the pointer to one element.
-   `b' specifies the pointer to the other element.
+/* Make the key of the posting blocks of a q-gram.
+   `xstr' specifies the string object into which the key is written.
+   `token' specifies the string of the q-gram.
+   `tsiz' specifies the size of the string.
+   `post' specifies the first posting of a block or `NULL' for the directory record.
+   Numeric primary keys are encoded in big endian after a null code and sorted before the others,
+   which are encoded as they are after the code 0x01. */
+static void tctdbidxqgkey(TCXSTR *xstr, const char *token, int tsiz, const TDBQGPOST *post){
+  assert(xstr && token && tsiz >= 0);
+  tcxstrclear(xstr);
+  TCXSTRCAT(xstr, token, tsiz);
+  TCXSTRCAT(xstr, "", 1);
+  if(!post) return;
+  if(post->pkbuf){
+    TCXSTRCAT(xstr, "\x01", 1);
+    TCXSTRCAT(xstr, post->pkbuf, post->pksiz);
+  } else {
+    unsigned char nbuf[TDBIDXNUMSIZ+1];
+    uint64_t num = post->pkid;
+    nbuf[0] = 0x00;
+    for(int i = TDBIDXNUMSIZ; i > 0; i--){
+      nbuf[i] = num & 0xff;
+      num >>= 8;
+    }
+    TCXSTRCAT(xstr, nbuf, sizeof(nbuf));
+  }
+}
+
+
+/* Compare two postings of a q-gram in the order of the keys of the posting blocks.
+   `a' specifies the pointer to one posting.
+   `b' specifies the pointer to the other posting.
    The return value is positive if the former is big, negative if the latter is big, 0 if both
    are equivalent. */
-static int tctdbidxcmpkey(const char **a, const char **b){
+static int tctdbidxqgcmppost(const TDBQGPOST *a, const TDBQGPOST *b){
   assert(a && b);
-  const unsigned char *ap = (unsigned char *)*a;
-  const unsigned char *bp = (unsigned char *)*b;
-  while(true){
-    if(*ap == '\0') return *bp == '\0' ? 0 : -1;
-    if(*bp == '\0') return *ap == '\0' ? 0 : 1;
-    if(*ap != *bp) return *ap - *bp;
-    ap++;
-    bp++;
+  if(!a->pkbuf){
+    if(b->pkbuf) return -1;
+    if(a->pkid < b->pkid) return -1;
+    return a->pkid > b->pkid ? 1 : 0;
   }
-  return 0;
+  if(!b->pkbuf) return 1;
+  int rv = memcmp(a->pkbuf, b->pkbuf, tclmin(a->pksiz, b->pksiz));
+  if(rv != 0) return rv;
+  return a->pksiz - b->pksiz;
 }
 
 
-/* Retrieve records by a token inverted index of a table database object.
-   `tdb' specifies the table database object.
+/* Compare two offsets of a q-gram.
+   `a' specifies the pointer to one offset.
+   `b' specifies the pointer to the other offset.
+   The return value is positive if the former is big, negative if the latter is big, 0 if both
+   are equivalent. */
+static int tctdbidxqgcmpoff(const int32_t *a, const int32_t *b){
+  assert(a && b);
+  return (*a > *b) - (*a < *b);
+}
+
+
+/* Initialize an array of q-gram postings.
+   `ary' specifies the array object. */
+static void tctdbidxqgaryinit(TDBQGARY *ary){
+  assert(ary);
+  ary->panum = TDBIDXQGBNUM;
+  TCMALLOC(ary->posts, sizeof(*ary->posts) * ary->panum);
+  ary->pnum = 0;
+  ary->oanum = TDBIDXQGBNUM;
+  TCMALLOC(ary->offs, sizeof(*ary->offs) * ary->oanum);
+  ary->onum = 0;
+}
+
+
+/* Clear an array of q-gram postings.
+   `ary' specifies the array object. */
+static void tctdbidxqgaryclear(TDBQGARY *ary){
+  assert(ary);
+  ary->pnum = 0;
+  ary->onum = 0;
+}
+
+
+/* Release the regions of an array of q-gram postings.
+   `ary' specifies the array object. */
+static void tctdbidxqgaryfree(TDBQGARY *ary){
+  assert(ary);
+  TCFREE(ary->offs);
+  TCFREE(ary->posts);
+}
+
+
+/* Add a posting to an array of q-gram postings.
+   `ary' specifies the array object.
+   `pkid' specifies the number of the primary key.
+   `pkbuf' specifies the pointer to the region of the primary key or `NULL' if it is numeric.
+   `pksiz' specifies the size of the region of the primary key. */
+static void tctdbidxqgaryadd(TDBQGARY *ary, int64_t pkid, const char *pkbuf, int pksiz){
+  assert(ary);
+  if(ary->pnum >= ary->panum){
+    ary->panum *= 2;
+    TCREALLOC(ary->posts, ary->posts, sizeof(*ary->posts) * ary->panum);
+  }
+  TDBQGPOST *post = ary->posts + ary->pnum++;
+  post->pkid = pkid;
+  post->pkbuf = pkbuf;
+  post->pksiz = pkbuf ? pksiz : 0;
+  post->oidx = ary->onum;
+  post->onum = 0;
+}
+
+
+/* Add an offset to the last posting of an array of q-gram postings.
+   `ary' specifies the array object.
+   `off' specifies the offset. */
+static void tctdbidxqgaryaddoff(TDBQGARY *ary, int32_t off){
+  assert(ary && ary->pnum > 0);
+  if(ary->onum >= ary->oanum){
+    ary->oanum *= 2;
+    TCREALLOC(ary->offs, ary->offs, sizeof(*ary->offs) * ary->oanum);
+  }
+  ary->offs[ary->onum++] = off;
+  ary->posts[ary->pnum-1].onum++;
+}
+
+
+/* Normalize an array of q-gram postings.
+   `ary' specifies the array object.
+   The postings are sorted, those of the same primary key are merged, and the offsets of each
+   posting are sorted without duplication. */
+static void tctdbidxqgarynorm(TDBQGARY *ary){
+  assert(ary);
+  TDBQGPOST *posts = ary->posts;
+  int pnum = ary->pnum;
+  if(pnum > 1) qsort(posts, pnum, sizeof(*posts),
+                     (int (*)(const void *, const void *))tctdbidxqgcmppost);
+  int32_t *offs;
+  TCMALLOC(offs, sizeof(*offs) * (ary->onum + 1));
+  int onum = 0;
+  int nnum = 0;
+  int i = 0;
+  while(i < pnum){
+    int oidx = onum;
+    int j = i;
+    while(j < pnum && tctdbidxqgcmppost(posts + i, posts + j) == 0){
+      memcpy(offs + onum, ary->offs + posts[j].oidx, sizeof(*offs) * posts[j].onum);
+      onum += posts[j].onum;
+      j++;
+    }
+    int num = onum - oidx;
+    if(num > 1){
+      qsort(offs + oidx, num, sizeof(*offs),
+            (int (*)(const void *, const void *))tctdbidxqgcmpoff);
+      onum = oidx + 1;
+      for(int k = oidx + 1; k < oidx + num; k++){
+        if(offs[k] != offs[onum-1]) offs[onum++] = offs[k];
+      }
+    }
+    posts[nnum] = posts[i];
+    posts[nnum].oidx = oidx;
+    posts[nnum].onum = onum - oidx;
+    nnum++;
+    i = j;
+  }
+  TCFREE(ary->offs);
+  ary->offs = offs;
+  ary->onum = onum;
+  ary->oanum = ary->onum + 1;
+  ary->pnum = nnum;
+}
+
+
+/* Search an array of sorted q-gram postings by galloping.
+   `ary' specifies the array object.
+   `start' specifies the index from which the search begins.
+   `post' specifies the posting to be searched for.
+   The return value is the index of the first posting not less than the specified one. */
+static int tctdbidxqgarygallop(const TDBQGARY *ary, int start, const TDBQGPOST *post){
+  assert(ary && start >= 0 && post);
+  const TDBQGPOST *posts = ary->posts;
+  int pnum = ary->pnum;
+  if(start > pnum || (start > 0 && tctdbidxqgcmppost(posts + start - 1, post) >= 0)) start = 0;
+  int lo = start;
+  int hi = start;
+  int step = 1;
+  while(hi < pnum && tctdbidxqgcmppost(posts + hi, post) < 0){
+    lo = hi + 1;
+    hi += step;
+    step *= 2;
+  }
+  if(hi > pnum) hi = pnum;
+  while(lo < hi){
+    int mid = lo + (hi - lo) / 2;
+    if(tctdbidxqgcmppost(posts + mid, post) < 0){
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+
+/* Decode a plain posting list of a q-gram into an array of q-gram postings.
+   `ary' specifies the array object.
+   `buf' specifies the pointer to the region of the list.
+   `size' specifies the size of the region.
+   If successful, the return value is true, else, it is false.
+   Each occurrence is added as a posting with one offset. */
+static bool tctdbidxqgdecraw(TDBQGARY *ary, const char *buf, int size){
+  assert(ary && buf && size >= 0);
+  while(size > 0){
+    const char *pkbuf = NULL;
+    int32_t pksiz = 0;
+    int64_t pkid = 0;
+    if(*buf == '\0'){
+      buf++;
+      size--;
+      int step;
+      TCREADVNUMBUF(buf, pksiz, step);
+      buf += step;
+      size -= step;
+      pkbuf = buf;
+      buf += pksiz;
+      size -= pksiz;
+    } else {
+      int step;
+      TCREADVNUMBUF64(buf, pkid, step);
+      buf += step;
+      size -= step;
+    }
+    if(size > 0){
+      int off, step;
+      TCREADVNUMBUF(buf, off, step);
+      buf += step;
+      size -= step;
+      tctdbidxqgaryadd(ary, pkid, pkbuf, pksiz);
+      tctdbidxqgaryaddoff(ary, off);
+    }
+  }
+  return size == 0;
+}
+
+
+/* Decode a posting block of a q-gram into an array of q-gram postings.
+   `ary' specifies the array object.
+   `buf' specifies the pointer to the region of the block.
+   `size' specifies the size of the region.
+   If successful, the return value is true, else, it is false. */
+static bool tctdbidxqgdecblock(TDBQGARY *ary, const char *buf, int size){
+  assert(ary && buf && size >= 0);
+  if(size < 1) return false;
+  int pnum, step;
+  TCREADVNUMBUF(buf, pnum, step);
+  buf += step;
+  size -= step;
+  int64_t pkid = 0;
+  for(int i = 0; i < pnum && size > 0; i++){
+    if(*buf == '\0'){
+      buf++;
+      size--;
+      int pksiz;
+      TCREADVNUMBUF(buf, pksiz, step);
+      buf += step;
+      size -= step;
+      tctdbidxqgaryadd(ary, 0, buf, pksiz);
+      buf += pksiz;
+      size -= pksiz;
+    } else {
+      int64_t diff;
+      TCREADVNUMBUF64(buf, diff, step);
+      buf += step;
+      size -= step;
+      pkid += diff;
+      tctdbidxqgaryadd(ary, pkid, NULL, 0);
+    }
+    int onum;
+    TCREADVNUMBUF(buf, onum, step);
+    buf += step;
+    size -= step;
+    int32_t off = 0;
+    for(int j = 0; j < onum && size > 0; j++){
+      int diff;
+      TCREADVNUMBUF(buf, diff, step);
+      buf += step;
+      size -= step;
+      off += diff;
+      tctdbidxqgaryaddoff(ary, off);
+    }
+  }
+  return size == 0;
+}
+
+
+/* Encode a posting block of a q-gram.
+   `xstr' specifies the string object into which the block is written.
+   `ary' specifies the array object of sorted postings.
+   `begin' specifies the index of the first posting of the block.
+   `end' specifies the index after the last posting of the block.
+   The numeric primary keys and the offsets are stored as differences from the preceding ones in
+   variable length format. */
+static void tctdbidxqgencblock(TCXSTR *xstr, const TDBQGARY *ary, int begin, int end){
+  assert(xstr && ary && begin >= 0 && end >= begin);
+  tcxstrclear(xstr);
+  char nbuf[TCNUMBUFSIZ];
+  int step;
+  TCSETVNUMBUF(step, nbuf, end - begin);
+  TCXSTRCAT(xstr, nbuf, step);
+  int64_t pkid = 0;
+  for(int i = begin; i < end; i++){
+    const TDBQGPOST *post = ary->posts + i;
+    if(post->pkbuf){
+      TCXSTRCAT(xstr, "", 1);
+      TCSETVNUMBUF(step, nbuf, post->pksiz);
+      TCXSTRCAT(xstr, nbuf, step);
+      TCXSTRCAT(xstr, post->pkbuf, post->pksiz);
+    } else {
+      TCSETVNUMBUF64(step, nbuf, post->pkid - pkid);
+      TCXSTRCAT(xstr, nbuf, step);
+      pkid = post->pkid;
+    }
+    TCSETVNUMBUF(step, nbuf, post->onum);
+    TCXSTRCAT(xstr, nbuf, step);
+    const int32_t *offs = ary->offs + post->oidx;
+    int32_t off = 0;
+    for(int j = 0; j < post->onum; j++){
+      TCSETVNUMBUF(step, nbuf, offs[j] - off);
+      TCXSTRCAT(xstr, nbuf, step);
+      off = offs[j];
+    }
+  }
+}
+
+
+/* Open the postings of a q-gram for a phrase search.
+   `list' specifies the structure of the q-gram.
    `idx' specifies the index object.
-   `token' specifies the list object of tokens.
-   `op' specifies the operation type.
-   `hint' specifies the hint object.
-   The return value is a map object of the primary keys of the corresponding records. */
-static TCMAP *tctdbidxgetbytokens(TCTDB *tdb, TDBIDX *idx, const TCLIST *tokens, int op,
-                                  TCXSTR *hint){
-  assert(tdb && idx && tokens && hint);
+   `token' specifies the string of the q-gram.
+   `pos' specifies the position of the q-gram in the phrase. */
+static void tctdbidxqglistopen(TDBQGLIST *list, TDBIDX *idx, const char *token, int pos){
+  assert(list && idx && token && pos >= 0);
   TCBDB *db = idx->db;
-  TCMAP *cc = idx->cc;
-  int tnum = TCLISTNUM(tokens);
-  TCMAP *res = tcmapnew();
+  list->tsiz = strlen(token);
+  memcpy(list->token, token, list->tsiz + 1);
+  list->pos = pos;
+  tctdbidxqgaryinit(&list->tary);
+  list->tbuf = NULL;
+  int csiz;
+  const char *cbuf = tcmapget(idx->cc, token, list->tsiz, &csiz);
+  if(cbuf) tctdbidxqgdecraw(&list->tary, cbuf, csiz);
+  cbuf = tcbdbget3(db, token, list->tsiz, &csiz);
+  if(cbuf){
+    list->tbuf = tcmemdup(cbuf, csiz);
+    tctdbidxqgdecraw(&list->tary, list->tbuf, csiz);
+  }
+  tctdbidxqgarynorm(&list->tary);
+  list->ti = 0;
+  list->tpost = NULL;
+  list->cur = NULL;
+  list->kxstr = NULL;
+  list->bkey = NULL;
+  list->bbuf = NULL;
+  tctdbidxqgaryinit(&list->bary);
+  list->bi = 0;
+  list->bpost = NULL;
+  list->bend = true;
+  list->dnum = list->tary.pnum;
+  list->bnum = 0;
+  list->bread = 0;
+  if(!tctdbidxqgpacked(idx)) return;
+  char kbuf[TDBIDXQGUNIT*3+2];
+  memcpy(kbuf, token, list->tsiz + 1);
+  cbuf = tcbdbget3(db, kbuf, list->tsiz + 1, &csiz);
+  if(!cbuf) return;
+  int64_t num;
+  int step;
+  TCREADVNUMBUF64(cbuf, num, step);
+  list->dnum += num;
+  TCREADVNUMBUF64(cbuf + step, num, step);
+  list->bnum = num;
+  list->cur = tcbdbcurnew(db);
+  list->kxstr = tcxstrnew();
+  list->bkey = tcxstrnew();
+  list->bend = false;
+}
+
+
+/* Close the postings of a q-gram for a phrase search.
+   `list' specifies the structure of the q-gram. */
+static void tctdbidxqglistclose(TDBQGLIST *list){
+  assert(list);
+  if(list->cur){
+    tcxstrdel(list->bkey);
+    tcxstrdel(list->kxstr);
+    tcbdbcurdel(list->cur);
+  }
+  if(list->bbuf) TCFREE(list->bbuf);
+  tctdbidxqgaryfree(&list->bary);
+  if(list->tbuf) TCFREE(list->tbuf);
+  tctdbidxqgaryfree(&list->tary);
+}
+
+
+/* Load the posting block at the cursor of a q-gram for a phrase search.
+   `list' specifies the structure of the q-gram.
+   If successful, the return value is true, else, it is false.  False is returned if the cursor
+   is not on a posting block of the q-gram. */
+static bool tctdbidxqglistload(TDBQGLIST *list){
+  assert(list && list->cur);
+  int ksiz;
+  const char *kbuf = tcbdbcurkey3(list->cur, &ksiz);
+  if(!kbuf || ksiz <= list->tsiz + 1 || memcmp(kbuf, list->token, list->tsiz + 1)) return false;
+  if(TCXSTRSIZE(list->bkey) == ksiz && !memcmp(TCXSTRPTR(list->bkey), kbuf, ksiz)) return true;
+  tcxstrclear(list->bkey);
+  TCXSTRCAT(list->bkey, kbuf, ksiz);
+  int vsiz;
+  const char *vbuf = tcbdbcurval3(list->cur, &vsiz);
+  if(!vbuf) return false;
+  if(list->bbuf) TCFREE(list->bbuf);
+  list->bbuf = tcmemdup(vbuf, vsiz);
+  tctdbidxqgaryclear(&list->bary);
+  list->bi = 0;
+  list->bread++;
+  return tctdbidxqgdecblock(&list->bary, list->bbuf, vsiz);
+}
+
+
+/* Move the postings of a q-gram to the next primary key for a phrase search.
+   `list' specifies the structure of the q-gram.
+   If successful, the return value is true, else, it is false.  False is returned if no posting
+   remains.  The current postings of the plain list and of the blocks are set. */
+static bool tctdbidxqglistnext(TDBQGLIST *list){
+  assert(list);
+  TDBQGPOST *tpost = list->ti < list->tary.pnum ? list->tary.posts + list->ti : NULL;
+  TDBQGPOST *bpost = NULL;
+  if(!list->bend && TCXSTRSIZE(list->bkey) < 1){
+    tctdbidxqgkey(list->kxstr, list->token, list->tsiz, NULL);
+    tcbdbcurjump(list->cur, TCXSTRPTR(list->kxstr), TCXSTRSIZE(list->kxstr));
+    int ksiz;
+    if(tcbdbcurkey3(list->cur, &ksiz) && ksiz == list->tsiz + 1) tcbdbcurnext(list->cur);
+    if(!tctdbidxqglistload(list)) list->bend = true;
+  }
+  while(!list->bend && list->bi >= list->bary.pnum){
+    if(!tcbdbcurnext(list->cur) || !tctdbidxqglistload(list)) list->bend = true;
+  }
+  if(!list->bend) bpost = list->bary.posts + list->bi;
+  if(!tpost && !bpost) return false;
+  int cmp = !tpost ? 1 : !bpost ? -1 : tctdbidxqgcmppost(tpost, bpost);
+  list->tpost = cmp <= 0 ? tpost : NULL;
+  list->bpost = cmp >= 0 ? bpost : NULL;
+  if(list->tpost) list->ti++;
+  if(list->bpost) list->bi++;
+  return true;
+}
+
+
+/* Move the postings of a q-gram to a primary key for a phrase search.
+   `list' specifies the structure of the q-gram.
+   `post' specifies the posting of the primary key.
+   The return value is true if the primary key is found, else, it is false.
+   The plain list is searched by galloping from the current position.  A posting block which
+   cannot contain the key is never read but skipped by jumping the cursor of the blocks. */
+static bool tctdbidxqglistseek(TDBQGLIST *list, const TDBQGPOST *post){
+  assert(list && post);
+  TDBQGARY *ary = &list->tary;
+  list->ti = tctdbidxqgarygallop(ary, list->ti, post);
+  list->tpost = list->ti < ary->pnum && tctdbidxqgcmppost(ary->posts + list->ti, post) == 0 ?
+    ary->posts + list->ti : NULL;
+  list->bpost = NULL;
+  if(list->cur){
+    ary = &list->bary;
+    bool hit = ary->pnum > 0 && tctdbidxqgcmppost(ary->posts, post) <= 0 &&
+      tctdbidxqgcmppost(ary->posts + ary->pnum - 1, post) >= 0;
+    if(!hit){
+      tctdbidxqgkey(list->kxstr, list->token, list->tsiz, post);
+      hit = tcbdbcurjumpback(list->cur, TCXSTRPTR(list->kxstr), TCXSTRSIZE(list->kxstr)) &&
+        tctdbidxqglistload(list);
+    }
+    if(hit){
+      list->bi = tctdbidxqgarygallop(ary, list->bi, post);
+      if(list->bi < ary->pnum && tctdbidxqgcmppost(ary->posts + list->bi, post) == 0)
+        list->bpost = ary->posts + list->bi;
+    }
+  }
+  return list->tpost || list->bpost;
+}
+
+
+/* Check whether the current primary key of a q-gram has an offset for a phrase search.
+   `list' specifies the structure of the q-gram.
+   `off' specifies the offset.
+   The return value is true if the offset is found, else, it is false. */
+static bool tctdbidxqglisthasoff(const TDBQGLIST *list, int32_t off){
+  assert(list);
+  for(int i = 0; i < 2; i++){
+    const TDBQGPOST *post = i < 1 ? list->tpost : list->bpost;
+    if(!post) continue;
+    const int32_t *offs = (i < 1 ? list->tary.offs : list->bary.offs) + post->oidx;
+    int lo = 0;
+    int hi = post->onum;
+    while(lo < hi){
+      int mid = lo + (hi - lo) / 2;
+      if(offs[mid] == off) return true;
+      if(offs[mid] < off){
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+  }
+  return false;
+}
+
+
+/* Open the postings of the q-grams of a phrase.
+   `idx' specifies the index object.
+   `ary' specifies the array of the UCS-2 codes of the phrase, followed by padding zeros.
+   `anum' specifies the number of the codes of the phrase, which is not less than the unit number.
+   `np' specifies the pointer to the variable into which the number of the q-grams is assigned.
+   The return value is the array of the postings of the q-grams.  Each element should be closed
+   with `tctdbidxqglistclose' and the array should be released with `free'. */
+static TDBQGLIST *tctdbidxqgphraseopen(TDBIDX *idx, const uint16_t *ary, int anum, int *np){
+  assert(idx && ary && anum >= TDBIDXQGUNIT && np);
+  TDBQGLIST *lists;
+  TCMALLOC(lists, sizeof(*lists) * (anum / TDBIDXQGUNIT + 1));
+  int lnum = 0;
+  char token[TDBIDXQGUNIT*3+1];
+  for(int i = 0; i < anum; i += TDBIDXQGUNIT){
+    int diff = anum - i - TDBIDXQGUNIT;
+    if(diff < 0) i += diff;
+    tcstrucstoutf(ary + i, TDBIDXQGUNIT, token);
+    tctdbidxqglistopen(lists + lnum++, idx, token, i);
+  }
+  *np = lnum;
+  return lists;
+}
+
+
+/* Count the occurrences of a phrase in the current primary key of the postings of its q-grams.
+   `lists' specifies the array of the postings of the q-grams, all of which are on the key.
+   `lnum' specifies the number of the q-grams.
+   `max' specifies the maximum number to count.
+   The return value is the number of the occurrences. */
+static int tctdbidxqgphrasecnt(const TDBQGLIST *lists, int lnum, int max){
+  assert(lists && lnum > 0 && max >= 0);
   int cnt = 0;
-  for(int i = 0; i < tnum; i++){
-    const char *token;
-    int tsiz;
-    TCLISTVAL(token, tokens, i, tsiz);
-    if(tsiz < 1) continue;
-    int onum = 0;
-    TCMAP *wring = (cnt > 0 && op == TDBQCSTRAND) ? tcmapnew() : NULL;
-    int csiz;
-    const char *cbuf = tcmapget(cc, token, tsiz, &csiz);
-    if(cbuf){
-      while(csiz > 0){
-        if(*cbuf == '\0'){
-          cbuf++;
-          csiz--;
-          int tsiz, step;
-          TCREADVNUMBUF(cbuf, tsiz, step);
-          cbuf += step;
-          csiz -= step;
-          if(cnt < 1){
-            tcmapput(res, cbuf, tsiz, "", 0);
-          } else if(wring){
-            int rsiz;
-            if(tcmapget(res, cbuf, tsiz, &rsiz)) tcmapput(wring, cbuf, tsiz, "", 0);
-          } else {
-            tcmapput(res, cbuf, tsiz, "", 0);
-          }
-          cbuf += tsiz;
-          csiz -= tsiz;
-        } else {
-          int64_t tid;
-          int step;
-          TCREADVNUMBUF64(cbuf, tid, step);
-          char pkbuf[TCNUMBUFSIZ];
-          int pksiz = sprintf(pkbuf, "%lld", (long long)tid);
-          if(cnt < 1){
-            tcmapput(res, pkbuf, pksiz, "", 0);
-          } else if(wring){
-            int rsiz;
-            if(tcmapget(res, pkbuf, pksiz, &rsiz)) tcmapput(wring, pkbuf, pksiz, "", 0);
-          } else {
-            tcmapput(res, pkbuf, pksiz, "", 0);
-          }
-          cbuf += step;
-          csiz -= step;
-        }
-        onum++;
+  for(int i = 0; i < 2 && cnt < max; i++){
+    const TDBQGPOST *post = i < 1 ? lists->tpost : lists->bpost;
+    if(!post) continue;
+    const int32_t *offs = (i < 1 ? lists->tary.offs : lists->bary.offs) + post->oidx;
+    for(int j = 0; j < post->onum && cnt < max; j++){
+      int32_t base = offs[j] - lists->pos;
+      bool hit = true;
+      for(int k = 1; hit && k < lnum; k++){
+        if(!tctdbidxqglisthasoff(lists + k, base + lists[k].pos)) hit = false;
       }
+      if(hit) cnt++;
     }
-    cbuf = tcbdbget3(db, token, tsiz, &csiz);
-    if(cbuf){
-      while(csiz > 0){
-        if(*cbuf == '\0'){
-          cbuf++;
-          csiz--;
-          int tsiz, step;
-          TCREADVNUMBUF(cbuf, tsiz, step);
-          cbuf += step;
-          csiz -= step;
-          if(cnt < 1){
-            tcmapput(res, cbuf, tsiz, "", 0);
-          } else if(wring){
-            int rsiz;
-            if(tcmapget(res, cbuf, tsiz, &rsiz)) tcmapput(wring, cbuf, tsiz, "", 0);
-          } else {
-            tcmapput(res, cbuf, tsiz, "", 0);
-          }
-          cbuf += tsiz;
-          csiz -= tsiz;
+  }
+  return cnt;
+}
+
+
+/* Collect the postings of the q-grams beginning with a word.
+   `idx' specifies the index object.
+   `word' specifies the string of the word.
+   `wsiz' specifies the size of the string.
+   `ary' specifies the array object into which the postings are added.
+   `bufs' specifies the list object to keep the regions referred to by the postings. */
+static void tctdbidxqgprefix(TDBIDX *idx, const char *word, int wsiz, TDBQGARY *ary,
+                             TCLIST *bufs){
+  assert(idx && word && wsiz >= 0 && ary && bufs);
+  TCMAP *cc = idx->cc;
+  const char *kbuf;
+  int ksiz;
+  tcmapiterinit(cc);
+  while((kbuf = tcmapiternext(cc, &ksiz)) != NULL){
+    if(ksiz < wsiz || memcmp(kbuf, word, wsiz)) continue;
+    int csiz;
+    const char *cbuf = tcmapiterval(kbuf, &csiz);
+    tctdbidxqgdecraw(ary, cbuf, csiz);
+  }
+  BDBCUR *cur = tcbdbcurnew(idx->db);
+  tcbdbcurjump(cur, word, wsiz);
+  while((kbuf = tcbdbcurkey3(cur, &ksiz)) != NULL){
+    if(ksiz < wsiz || memcmp(kbuf, word, wsiz)) break;
+    const char *np = memchr(kbuf, '\0', ksiz);
+    if(!np || np < kbuf + ksiz - 1){
+      int csiz;
+      const char *cbuf = tcbdbcurval3(cur, &csiz);
+      if(cbuf){
+        TCLISTPUSH(bufs, cbuf, csiz);
+        TCLISTVAL(cbuf, bufs, TCLISTNUM(bufs) - 1, csiz);
+        if(np){
+          tctdbidxqgdecblock(ary, cbuf, csiz);
         } else {
-          int64_t tid;
-          int step;
-          TCREADVNUMBUF64(cbuf, tid, step);
-          char pkbuf[TCNUMBUFSIZ];
-          int pksiz = sprintf(pkbuf, "%lld", (long long)tid);
-          if(cnt < 1){
-            tcmapput(res, pkbuf, pksiz, "", 0);
-          } else if(wring){
-            int rsiz;
-            if(tcmapget(res, pkbuf, pksiz, &rsiz)) tcmapput(wring, pkbuf, pksiz, "", 0);
-          } else {
-            tcmapput(res, pkbuf, pksiz, "", 0);
-          }
-          cbuf += step;
-          csiz -= step;
+          tctdbidxqgdecraw(ary, cbuf, csiz);
         }
-        onum++;
       }
     }
-    if(wring){
-      tcmapdel(res);
-      res = wring;
+    tcbdbcurnext(cur);
+  }
+  tcbdbcurdel(cur);
+}
+
+
+/* Decode a posting list of a token into an array of postings.
+   `ary' specifies the array object.
+   `buf' specifies the pointer to the region of the list.
+   `size' specifies the size of the region.
+   If successful, the return value is true, else, it is false.
+   Each entry is added with the serial number of the entry as the offset, so that the number of
+   the offsets of each normalized posting is the frequency of the token in the record. */
+static bool tctdbidxqgdectoken(TDBQGARY *ary, const char *buf, int size){
+  assert(ary && buf && size >= 0);
+  while(size > 0){
+    int step;
+    if(*buf == '\0'){
+      buf++;
+      size--;
+      int pksiz;
+      TCREADVNUMBUF(buf, pksiz, step);
+      buf += step;
+      size -= step;
+      tctdbidxqgaryadd(ary, 0, buf, pksiz);
+      buf += pksiz;
+      size -= pksiz;
+    } else {
+      int64_t pkid;
+      TCREADVNUMBUF64(buf, pkid, step);
+      buf += step;
+      size -= step;
+      tctdbidxqgaryadd(ary, pkid, NULL, 0);
+    }
+    tctdbidxqgaryaddoff(ary, ary->onum);
+  }
+  return size == 0;
+}
+
+
+/* Set the primary key of a posting of an inverted index.
+   `post' specifies the posting.
+   `pkbuf' specifies the pointer to the region of the primary key.
+   `pksiz' specifies the size of the region of the primary key.
+   A primary key of decimal digits without leading zero is set as a number. */
+static void tctdbidxqgpostset(TDBQGPOST *post, const char *pkbuf, int pksiz){
+  assert(post && pkbuf && pksiz >= 0);
+  uint64_t pkid = 0;
+  for(int i = 0; i < pksiz; i++){
+    int c = pkbuf[i];
+    if(c >= '0' && c <= '9'){
+      pkid = pkid * 10 + c - '0';
+    } else {
+      pkid = 0;
+      break;
     }
-    tcxstrprintf(hint, "token occurrence: \"%s\" %d\n", token, onum);
-    cnt++;
   }
-  return res;
+  if(pksiz > 0 && *pkbuf == '0') pkid = 0;
+  post->pkid = pkid;
+  post->pkbuf = pkid > 0 ? NULL : pkbuf;
+  post->pksiz = pkid > 0 ? 0 : pksiz;
+  post->oidx = 0;
+  post->onum = 0;
 }
 
 
-/* Retrieve records by a token inverted index of a table database object.
+/* Store the length of the column value of a record into an inverted index.
    `tdb' specifies the table database object.
    `idx' specifies the index object.
-   `cond' specifies the condition object.
-   `hint' specifies the hint object.
-   The return value is a map object of the primary keys of the corresponding records. */
-static TCMAP *tctdbidxgetbyfts(TCTDB *tdb, TDBIDX *idx, TDBCOND *cond, TCXSTR *hint){
-  assert(tdb && idx && cond && hint);
-  TDBFTSUNIT *ftsunits = cond->ftsunits;
-  int ftsnum = cond->ftsnum;
-  if(ftsnum < 1) return tcmapnew2(1);
-  if(!ftsunits[0].sign) return tcmapnew2(1);
-  TCMAP *res = tcmapnew();
-  tctdbidxgetbyftsunion(idx, ftsunits->tokens, true, NULL, res, hint);
-  for(int i = 1; i < ftsnum; i++){
-    TDBFTSUNIT *ftsunit = ftsunits + i;
-    if(ftsunit->sign){
-      TCMAP *nres = tcmapnew2(TCMAPRNUM(res) + 1);
-      tctdbidxgetbyftsunion(idx, ftsunit->tokens, true, res, nres, hint);
-      tcmapdel(res);
-      res = nres;
-    } else {
-      tctdbidxgetbyftsunion(idx, ftsunit->tokens, false, res, NULL, hint);
-    }
+   `pkbuf' specifies the pointer to the region of the primary key.
+   `pksiz' specifies the size of the region of the primary key.
+   `len' specifies the number of the tokens or the characters of the column value.
+   If successful, the return value is true, else, it is false.
+   The length is stored with the key of a null code followed by the primary key encoded as the
+   keys of posting blocks, and the total number of the records and the total length are stored
+   with the key of a null code. */
+static bool tctdbidxlenput(TCTDB *tdb, TDBIDX *idx, const char *pkbuf, int pksiz, int len){
+  assert(tdb && idx && pkbuf && pksiz >= 0 && len >= 0);
+  TCBDB *db = idx->db;
+  TDBQGPOST post;
+  tctdbidxqgpostset(&post, pkbuf, pksiz);
+  TCXSTR *kxstr = tcxstrnew();
+  int64_t rnum = 1;
+  int64_t tlen = len;
+  int olen = tctdbidxlenget(idx, &post, kxstr);
+  if(olen >= 0){
+    rnum = 0;
+    tlen -= olen;
   }
-  return res;
+  bool err = false;
+  char nbuf[TCNUMBUFSIZ];
+  int step;
+  TCSETVNUMBUF(step, nbuf, len);
+  if(!tcbdbput(db, TCXSTRPTR(kxstr), TCXSTRSIZE(kxstr), nbuf, step)){
+    tctdbsetecode(tdb, tcbdbecode(db), __FILE__, __LINE__, __func__);
+    err = true;
+  }
+  tcxstrdel(kxstr);
+  if(!tctdbidxlenadd(tdb, idx, rnum, tlen)) err = true;
+  return !err;
 }
 
 
-/* Retrieve union records by a token inverted index of a table database object.
+/* Remove the length of the column value of a record from an inverted index.
+   `tdb' specifies the table database object.
    `idx' specifies the index object.
-   `tokens' specifies a list object of the union tokens.
-   `sign' specifies the logical sign.
-   `ores' specifies a map object of old primary keys.
-   `nres' specifies a map object of new primary keys.
-   `hint' specifies the hint object. */
-static void tctdbidxgetbyftsunion(TDBIDX *idx, const TCLIST *tokens, bool sign,
-                                  TCMAP *ores, TCMAP *nres, TCXSTR *hint){
-  assert(idx && tokens && hint);
+   `pkbuf' specifies the pointer to the region of the primary key.
+   `pksiz' specifies the size of the region of the primary key.
+   If successful, the return value is true, else, it is false. */
+static bool tctdbidxlenout(TCTDB *tdb, TDBIDX *idx, const char *pkbuf, int pksiz){
+  assert(tdb && idx && pkbuf && pksiz >= 0);
   TCBDB *db = idx->db;
-  TCMAP *cc = idx->cc;
-  int tnum = TCLISTNUM(tokens);
-  for(int i = 0; i < tnum; i++){
-    const char *word;
-    int wsiz;
-    TCLISTVAL(word, tokens, i, wsiz);
-    uint16_t *ary;
-    TCMALLOC(ary, sizeof(*ary) * (wsiz + TDBIDXQGUNIT));
-    int anum;
-    tcstrutftoucs(word, ary, &anum);
-    for(int j = 0; j < TDBIDXQGUNIT; j++){
-      ary[anum+j] = 0;
-    }
-    if(anum >= TDBIDXQGUNIT){
-      TDBFTSSTROCR *socrs;
-      TCMALLOC(socrs, TDBFTSOCRUNIT * sizeof(*socrs));
-      int sonum = 0;
-      int soanum = TDBFTSOCRUNIT;
-      int sobase = 0;
-      TDBFTSNUMOCR *nocrs;
-      TCMALLOC(nocrs, TDBFTSOCRUNIT * sizeof(*nocrs));
-      int nonum = 0;
-      int noanum = TDBFTSOCRUNIT;
-      int nobase = 0;
-      TCBITMAP *pkmap = TCBITMAPNEW(TDBFTSBMNUM);
-      char token[TDBIDXQGUNIT*3+1];
-      uint16_t seq = 0;
-      for(int j = 0; j < anum; j += TDBIDXQGUNIT){
-        sobase = sonum;
-        nobase = nonum;
-        int diff = anum - j - TDBIDXQGUNIT;
-        if(diff < 0){
-          j += diff;
-          diff = -diff;
-        } else {
-          diff = 0;
-        }
-        tcstrucstoutf(ary + j, TDBIDXQGUNIT, token);
-        int tsiz = strlen(token);
-        int csiz;
-        const char *cbuf = tcmapget(cc, token, tsiz, &csiz);
-        if(cbuf){
-          while(csiz > 0){
-            const char *pkbuf = NULL;
-            int32_t pksiz = 0;
-            int64_t pkid = 0;
-            if(*cbuf == '\0'){
-              cbuf++;
-              csiz--;
-              int step;
-              TCREADVNUMBUF(cbuf, pksiz, step);
-              cbuf += step;
-              csiz -= step;
-              pkbuf = cbuf;
-              cbuf += pksiz;
-              csiz -= pksiz;
-            } else {
-              int step;
-              TCREADVNUMBUF64(cbuf, pkid, step);
-              cbuf += step;
-              csiz -= step;
-            }
-            if(csiz > 0){
-              int off, step;
-              TCREADVNUMBUF(cbuf, off, step);
-              cbuf += step;
-              csiz -= step;
-              off += diff;
-              if(pkbuf){
-                unsigned int hash = 19780211;
-                for(int k = 0; k < pksiz; k++){
-                  hash = hash * 37 + ((unsigned char *)pkbuf)[k];
-                }
-                hash = hash % TDBFTSBMNUM;
-                if(j == 0 || TCBITMAPCHECK(pkmap, hash)){
-                  if(sonum >= soanum){
-                    soanum *= 2;
-                    TCREALLOC(socrs, socrs, soanum * sizeof(*socrs));
-                  }
-                  TDBFTSSTROCR *ocr = socrs + sonum;
-                  ocr->pkbuf = pkbuf;
-                  ocr->pksiz = pksiz;
-                  ocr->off = off;
-                  ocr->seq = seq;
-                  ocr->hash = hash;
-                  sonum++;
-                  if(j == 0) TCBITMAPON(pkmap, hash);
-                }
-              } else {
-                unsigned int hash = pkid % TDBFTSBMNUM;
-                if(j == 0 || TCBITMAPCHECK(pkmap, hash)){
-                  if(nonum >= noanum){
-                    noanum *= 2;
-                    TCREALLOC(nocrs, nocrs, noanum * sizeof(*nocrs));
-                  }
-                  TDBFTSNUMOCR *ocr = nocrs + nonum;
-                  ocr->pkid = pkid;
-                  ocr->off = off;
-                  ocr->seq = seq;
-                  ocr->hash = hash;
-                  nonum++;
-                  if(j == 0) TCBITMAPON(pkmap, hash);
-                }
-              }
-            }
-          }
-        }
-        cbuf = tcbdbget3(db, token, tsiz, &csiz);
-        if(cbuf){
-          while(csiz > 0){
-            const char *pkbuf = NULL;
-            int32_t pksiz = 0;
-            int64_t pkid = 0;
-            if(*cbuf == '\0'){
-              cbuf++;
-              csiz--;
-              int step;
-              TCREADVNUMBUF(cbuf, pksiz, step);
-              cbuf += step;
-              csiz -= step;
-              pkbuf = cbuf;
-              cbuf += pksiz;
-              csiz -= pksiz;
-            } else {
-              int step;
-              TCREADVNUMBUF64(cbuf, pkid, step);
-              cbuf += step;
-              csiz -= step;
-            }
-            if(csiz > 0){
-              int off, step;
-              TCREADVNUMBUF(cbuf, off, step);
-              cbuf += step;
-              csiz -= step;
-              off += diff;
-              if(pkbuf){
-                unsigned int hash = 19780211;
-                for(int k = 0; k < pksiz; k++){
-                  hash = hash * 37 + ((unsigned char *)pkbuf)[k];
-                }
-                hash = hash % TDBFTSBMNUM;
-                if(j == 0 || TCBITMAPCHECK(pkmap, hash)){
-                  if(sonum >= soanum){
-                    soanum *= 2;
-                    TCREALLOC(socrs, socrs, soanum * sizeof(*socrs));
-                  }
-                  TDBFTSSTROCR *ocr = socrs + sonum;
-                  ocr->pkbuf = pkbuf;
-                  ocr->pksiz = pksiz;
-                  ocr->off = off;
-                  ocr->seq = seq;
-                  ocr->hash = hash;
-                  sonum++;
-                  if(j == 0) TCBITMAPON(pkmap, hash);
-                }
-              } else {
-                unsigned int hash = pkid % TDBFTSBMNUM;
-                if(j == 0 || TCBITMAPCHECK(pkmap, hash)){
-                  if(nonum >= noanum){
-                    noanum *= 2;
-                    TCREALLOC(nocrs, nocrs, noanum * sizeof(*nocrs));
-                  }
-                  TDBFTSNUMOCR *ocr = nocrs + nonum;
-                  ocr->pkid = pkid;
-                  ocr->off = off;
-                  ocr->seq = seq;
-                  ocr->hash = hash;
-                  nonum++;
-                  if(j == 0) TCBITMAPON(pkmap, hash);
-                }
-              }
-            }
-          }
-        }
-        seq++;
-        if(sonum <= sobase && nonum <= nobase){
-          sonum = 0;
-          nonum = 0;
-          break;
-        }
-      }
-      TCBITMAPDEL(pkmap);
-      if(seq > 1){
-        if(sonum > UINT16_MAX){
-          int flnum = sonum * 16 + 1;
-          TCBITMAP *flmap = TCBITMAPNEW(flnum);
-          for(int j = sobase; j < sonum; j++){
-            TDBFTSSTROCR *ocr = socrs + j;
-            uint32_t hash = (((uint32_t)ocr->off << 16) | ocr->hash) % flnum;
-            TCBITMAPON(flmap, hash);
-          }
-          int wi = 0;
-          for(int j = 0; j < sobase; j++){
-            TDBFTSSTROCR *ocr = socrs + j;
-            int rem = (seq - ocr->seq - 1) * TDBIDXQGUNIT;
-            uint32_t hash = (((uint32_t)(ocr->off + rem) << 16) | ocr->hash) % flnum;
-            if(TCBITMAPCHECK(flmap, hash)) socrs[wi++] = *ocr;
-          }
-          for(int j = sobase; j < sonum; j++){
-            socrs[wi++] = socrs[j];
-          }
-          sonum = wi;
-          TCBITMAPDEL(flmap);
-        }
-        if(sonum > UINT16_MAX * 2){
-          TDBFTSSTROCR *rocrs;
-          TCMALLOC(rocrs, sizeof(*rocrs) * sonum);
-          uint32_t *counts;
-          TCCALLOC(counts, sizeof(*counts), (UINT16_MAX + 1));
-          for(int j = 0; j < sonum; j++){
-            counts[socrs[j].hash]++;
-          }
-          for(int j = 0; j < UINT16_MAX; j++){
-            counts[j+1] += counts[j];
-          }
-          for(int j = sonum - 1; j >= 0; j--){
-            rocrs[--counts[socrs[j].hash]] = socrs[j];
-          }
-          for(int j = 0; j < UINT16_MAX; j++){
-            int num = counts[j+1] - counts[j];
-            if(num > 1) qsort(rocrs + counts[j], num, sizeof(*rocrs),
-                              (int (*)(const void *, const void *))tctdbidxftscmpstrocr);
-          }
-          int num = sonum - counts[UINT16_MAX];
-          if(num > 1) qsort(rocrs + counts[UINT16_MAX], num, sizeof(*rocrs),
-                            (int (*)(const void *, const void *))tctdbidxftscmpstrocr);
-          TCFREE(counts);
-          TCFREE(socrs);
-          socrs = rocrs;
-        } else if(sonum > 1){
-          qsort(socrs, sonum, sizeof(*socrs),
-                (int (*)(const void *, const void *))tctdbidxftscmpstrocr);
-        }
-        if(nonum > UINT16_MAX){
-          int flnum = nonum * 16 + 1;
-          TCBITMAP *flmap = TCBITMAPNEW(flnum);
-          for(int j = nobase; j < nonum; j++){
-            TDBFTSNUMOCR *ocr = nocrs + j;
-            uint32_t hash = (((uint32_t)ocr->off << 16) | ocr->hash) % flnum;
-            TCBITMAPON(flmap, hash);
-          }
-          int wi = 0;
-          for(int j = 0; j < nobase; j++){
-            TDBFTSNUMOCR *ocr = nocrs + j;
-            int rem = (seq - ocr->seq - 1) * TDBIDXQGUNIT;
-            uint32_t hash = (((uint32_t)(ocr->off + rem) << 16) | ocr->hash) % flnum;
-            if(TCBITMAPCHECK(flmap, hash)) nocrs[wi++] = *ocr;
-          }
-          for(int j = nobase; j < nonum; j++){
-            nocrs[wi++] = nocrs[j];
-          }
-          nonum = wi;
-          TCBITMAPDEL(flmap);
-        }
-        if(nonum > UINT16_MAX * 2){
-          TDBFTSNUMOCR *rocrs;
-          TCMALLOC(rocrs, sizeof(*rocrs) * nonum);
-          uint32_t *counts;
-          TCCALLOC(counts, sizeof(*counts), (UINT16_MAX + 1));
-          for(int j = 0; j < nonum; j++){
-            counts[nocrs[j].hash]++;
-          }
-          for(int j = 0; j < UINT16_MAX; j++){
-            counts[j+1] += counts[j];
-          }
-          for(int j = nonum - 1; j >= 0; j--){
-            rocrs[--counts[nocrs[j].hash]] = nocrs[j];
-          }
-          for(int j = 0; j < UINT16_MAX; j++){
-            int num = counts[j+1] - counts[j];
-            if(num > 1) qsort(rocrs + counts[j], num, sizeof(*rocrs),
-                              (int (*)(const void *, const void *))tctdbidxftscmpnumocr);
-          }
-          int num = nonum - counts[UINT16_MAX];
-          if(num > 1) qsort(rocrs + counts[UINT16_MAX], num, sizeof(*rocrs),
-                            (int (*)(const void *, const void *))tctdbidxftscmpnumocr);
-          TCFREE(counts);
-          TCFREE(nocrs);
-          nocrs = rocrs;
-        } else if(nonum > 1){
-          qsort(nocrs, nonum, sizeof(*nocrs),
-                (int (*)(const void *, const void *))tctdbidxftscmpnumocr);
-        }
-      }
-      int rem = (seq - 1) * TDBIDXQGUNIT;
-      int onum = 0;
-      int ri = 0;
-      while(ri < sonum){
-        TDBFTSSTROCR *ocr = socrs + ri;
-        ri++;
-        if(ocr->seq > 0) continue;
-        const char *pkbuf = ocr->pkbuf;
-        int32_t pksiz = ocr->pksiz;
-        int32_t off = ocr->off;
-        uint16_t seq = 1;
-        for(int j = ri; j < sonum; j++){
-          TDBFTSSTROCR *tocr = socrs + j;
-          if(!tocr->pkbuf || tocr->pksiz != pksiz || memcmp(tocr->pkbuf, pkbuf, pksiz) ||
-             tocr->off > off + TDBIDXQGUNIT) break;
-          if(tocr->seq == seq && tocr->off == off + TDBIDXQGUNIT){
-            off = tocr->off;
-            seq++;
-          }
-        }
-        if(off == ocr->off + rem){
-          onum++;
-          if(ores){
-            int rsiz;
-            if(tcmapget(ores, pkbuf, pksiz, &rsiz)){
-              if(sign){
-                tcmapputkeep(nres, pkbuf, pksiz, "", 0);
-              } else {
-                tcmapout(ores, pkbuf, pksiz);
-              }
-            }
-          } else {
-            tcmapputkeep(nres, pkbuf, pksiz, "", 0);
-          }
-          while(ri < sonum){
-            ocr = socrs + ri;
-            if(!ocr->pkbuf || ocr->pksiz != pksiz || memcmp(ocr->pkbuf, pkbuf, pksiz)) break;
-            ri++;
-          }
-        }
-      }
-      ri = 0;
-      while(ri < nonum){
-        TDBFTSNUMOCR *ocr = nocrs + ri;
-        ri++;
-        if(ocr->seq > 0) continue;
-        int64_t pkid = ocr->pkid;
-        int32_t off = ocr->off;
-        uint16_t seq = 1;
-        for(int j = ri; j < nonum; j++){
-          TDBFTSNUMOCR *tocr = nocrs + j;
-          if(tocr->pkid != pkid || tocr->off > off + TDBIDXQGUNIT) break;
-          if(tocr->seq == seq && tocr->off == off + TDBIDXQGUNIT){
-            off = tocr->off;
-            seq++;
-          }
-        }
-        if(off == ocr->off + rem){
-          onum++;
-          char pkbuf[TCNUMBUFSIZ];
-          int pksiz = sprintf(pkbuf, "%lld", (long long)pkid);
-          if(ores){
-            int rsiz;
-            if(tcmapget(ores, pkbuf, pksiz, &rsiz)){
-              if(sign){
-                tcmapputkeep(nres, pkbuf, pksiz, "", 0);
-              } else {
-                tcmapout(ores, pkbuf, pksiz);
-              }
-            }
-          } else {
-            tcmapputkeep(nres, pkbuf, pksiz, "", 0);
-          }
-          while(ri < nonum && nocrs[ri].pkid == pkid){
-            ri++;
-          }
-        }
-      }
-      tcxstrprintf(hint, "token occurrence: \"%s\" %d\n", word, onum);
-      TCFREE(nocrs);
-      TCFREE(socrs);
-    } else {
-      int onum = 0;
-      TCMAP *uniq = (i > 0 || ores) ? tcmapnew2(UINT16_MAX) : NULL;
-      tcmapiterinit(cc);
-      const char *kbuf;
-      int ksiz;
-      while((kbuf = tcmapiternext(cc, &ksiz)) != NULL){
-        if(ksiz < wsiz || memcmp(kbuf, word, wsiz)) continue;
-        int csiz;
-        const char *cbuf = tcmapiterval(kbuf, &csiz);
-        while(csiz > 0){
-          const char *pkbuf = NULL;
-          int32_t pksiz = 0;
-          int64_t pkid = 0;
-          if(*cbuf == '\0'){
-            cbuf++;
-            csiz--;
-            int step;
-            TCREADVNUMBUF(cbuf, pksiz, step);
-            cbuf += step;
-            csiz -= step;
-            pkbuf = cbuf;
-            cbuf += pksiz;
-            csiz -= pksiz;
-          } else {
-            int step;
-            TCREADVNUMBUF64(cbuf, pkid, step);
-            cbuf += step;
-            csiz -= step;
-          }
-          if(csiz > 0){
-            int off, step;
-            TCREADVNUMBUF(cbuf, off, step);
-            cbuf += step;
-            csiz -= step;
-            if(pkbuf){
-              if(ores){
-                int rsiz;
-                if(tcmapget(ores, pkbuf, pksiz, &rsiz)){
-                  if(sign){
-                    tcmapputkeep(nres, pkbuf, pksiz, "", 0);
-                  } else {
-                    tcmapout(ores, pkbuf, pksiz);
-                  }
-                }
-              } else {
-                if(tcmapputkeep(nres, pkbuf, pksiz, "", 0)) onum++;
-              }
-              if(uniq) tcmapputkeep(uniq, pkbuf, pksiz, "", 0);
-            } else {
-              char numbuf[TCNUMBUFSIZ];
-              int pksiz = sprintf(numbuf, "%lld", (long long)pkid);
-              if(ores){
-                int rsiz;
-                if(tcmapget(ores, numbuf, pksiz, &rsiz)){
-                  if(sign){
-                    tcmapputkeep(nres, numbuf, pksiz, "", 0);
-                  } else {
-                    tcmapout(ores, numbuf, pksiz);
-                  }
-                }
-              } else {
-                if(tcmapputkeep(nres, numbuf, pksiz, "", 0)) onum++;
-              }
-              if(uniq) tcmapputkeep(uniq, numbuf, pksiz, "", 0);
-            }
-          }
-        }
-      }
-      BDBCUR *cur = tcbdbcurnew(db);
-      tcbdbcurjump(cur, word, wsiz);
-      TCXSTR *key = tcxstrnew();
-      TCXSTR *val = tcxstrnew();
-      while(tcbdbcurrec(cur, key, val)){
-        const char *kbuf = TCXSTRPTR(key);
-        int ksiz = TCXSTRSIZE(key);
-        if(ksiz < wsiz || memcmp(kbuf, word, wsiz)) break;
-        const char *cbuf = TCXSTRPTR(val);
-        int csiz = TCXSTRSIZE(val);
-        while(csiz > 0){
-          const char *pkbuf = NULL;
-          int32_t pksiz = 0;
-          int64_t pkid = 0;
-          if(*cbuf == '\0'){
-            cbuf++;
-            csiz--;
-            int step;
-            TCREADVNUMBUF(cbuf, pksiz, step);
-            cbuf += step;
-            csiz -= step;
-            pkbuf = cbuf;
-            cbuf += pksiz;
-            csiz -= pksiz;
-          } else {
-            int step;
-            TCREADVNUMBUF64(cbuf, pkid, step);
-            cbuf += step;
-            csiz -= step;
-          }
-          if(csiz > 0){
-            int off, step;
-            TCREADVNUMBUF(cbuf, off, step);
-            cbuf += step;
-            csiz -= step;
-            if(pkbuf){
-              if(ores){
-                int rsiz;
-                if(tcmapget(ores, pkbuf, pksiz, &rsiz)){
-                  if(sign){
-                    tcmapputkeep(nres, pkbuf, pksiz, "", 0);
-                  } else {
-                    tcmapout(ores, pkbuf, pksiz);
-                  }
-                }
-              } else {
-                if(tcmapputkeep(nres, pkbuf, pksiz, "", 0)) onum++;
-              }
-              if(uniq) tcmapputkeep(uniq, pkbuf, pksiz, "", 0);
-            } else {
-              char numbuf[TCNUMBUFSIZ];
-              int pksiz = sprintf(numbuf, "%lld", (long long)pkid);
-              if(ores){
-                int rsiz;
-                if(tcmapget(ores, numbuf, pksiz, &rsiz)){
-                  if(sign){
-                    tcmapputkeep(nres, numbuf, pksiz, "", 0);
-                  } else {
-                    tcmapout(ores, numbuf, pksiz);
-                  }
-                }
-              } else {
-                if(tcmapputkeep(nres, numbuf, pksiz, "", 0)) onum++;
-              }
-              if(uniq) tcmapputkeep(uniq, numbuf, pksiz, "", 0);
-            }
-          }
-        }
-        tcbdbcurnext(cur);
-      }
-      tcxstrdel(val);
-      tcxstrdel(key);
-      tcbdbcurdel(cur);
-      tcxstrprintf(hint, "token occurrence: \"%s\" %d\n",
-                   word, uniq ? (int)tcmaprnum(uniq) : onum);
-      if(uniq) tcmapdel(uniq);
+  TDBQGPOST post;
+  tctdbidxqgpostset(&post, pkbuf, pksiz);
+  TCXSTR *kxstr = tcxstrnew();
+  bool err = false;
+  int len = tctdbidxlenget(idx, &post, kxstr);
+  if(len >= 0){
+    if(!tcbdbout(db, TCXSTRPTR(kxstr), TCXSTRSIZE(kxstr))){
+      tctdbsetecode(tdb, tcbdbecode(db), __FILE__, __LINE__, __func__);
+      err = true;
     }
-    TCFREE(ary);
+    if(!tctdbidxlenadd(tdb, idx, -1, -len)) err = true;
   }
+  tcxstrdel(kxstr);
+  return !err;
 }
 
 
-/* Compare two string occurrences of full-text search in identical order.
-   `a' specifies the pointer to one occurrence.
-   `b' specifies the pointer to the other occurrence.
-   The return value is positive if the former is big, negative if the latter is big, 0 if both
-   are equivalent. */
-static int tctdbidxftscmpstrocr(TDBFTSSTROCR *a, TDBFTSSTROCR *b){
-  assert(a && b);
-  if(a->pksiz > b->pksiz) return 1;
-  if(a->pksiz < b->pksiz) return -1;
-  int diff = memcmp(a->pkbuf, b->pkbuf, a->pksiz);
-  if(diff != 0) return diff;
-  return a->off - b->off;
+/* Get the length of the column value of a record in an inverted index.
+   `idx' specifies the index object.
+   `post' specifies the posting of the primary key.
+   `kxstr' specifies the string object into which the key of the length is written.
+   The return value is the length or -1 if it is not stored. */
+static int tctdbidxlenget(TDBIDX *idx, const TDBQGPOST *post, TCXSTR *kxstr){
+  assert(idx && post && kxstr);
+  tctdbidxqgkey(kxstr, "", 0, post);
+  int vsiz;
+  const char *vbuf = tcbdbget3(idx->db, TCXSTRPTR(kxstr), TCXSTRSIZE(kxstr), &vsiz);
+  if(!vbuf) return -1;
+  int len, step;
+  TCREADVNUMBUF(vbuf, len, step);
+  return step <= vsiz ? len : -1;
 }
 
 
-/* Compare two number occurrences of full-text search in identical order.
-   `a' specifies the pointer to one occurrence.
-   `b' specifies the pointer to the other occurrence.
-   The return value is positive if the former is big, negative if the latter is big, 0 if both
-   are equivalent. */
-static int tctdbidxftscmpnumocr(TDBFTSNUMOCR *a, TDBFTSNUMOCR *b){
-  assert(a && b);
-  if(a->pkid > b->pkid) return 1;
-  if(a->pkid < b->pkid) return -1;
-  return a->off - b->off;
+/* Add the total number of the records and the total length of an inverted index.
+   `tdb' specifies the table database object.
+   `idx' specifies the index object.
+   `rnum' specifies the additional number of the records.
+   `tlen' specifies the additional length.
+   If successful, the return value is true, else, it is false. */
+static bool tctdbidxlenadd(TCTDB *tdb, TDBIDX *idx, int64_t rnum, int64_t tlen){
+  assert(tdb && idx);
+  if(rnum == 0 && tlen == 0) return true;
+  TCBDB *db = idx->db;
+  int64_t ornum, otlen;
+  bool has = tctdbidxlenstat(idx, &ornum, &otlen);
+  if(has){
+    rnum += ornum;
+    tlen += otlen;
+  }
+  bool err = false;
+  if(rnum > 0){
+    char vbuf[TCNUMBUFSIZ*2];
+    int vsiz, step;
+    TCSETVNUMBUF64(step, vbuf, rnum);
+    vsiz = step;
+    TCSETVNUMBUF64(step, vbuf + vsiz, tclmax(tlen, 0));
+    vsiz += step;
+    if(!tcbdbput(db, "", 1, vbuf, vsiz)){
+      tctdbsetecode(tdb, tcbdbecode(db), __FILE__, __LINE__, __func__);
+      err = true;
+    }
+  } else if(has && !tcbdbout(db, "", 1)){
+    tctdbsetecode(tdb, tcbdbecode(db), __FILE__, __LINE__, __func__);
+    err = true;
+  }
+  return !err;
+}
+
+
+/* Get the total number of the records and the total length of an inverted index.
+   `idx' specifies the index object.
+   `rnp' specifies the pointer to the variable into which the number of the records is assigned.
+   `tlp' specifies the pointer to the variable into which the total length is assigned.
+   If the statistics are stored, the return value is true, else, it is false. */
+static bool tctdbidxlenstat(TDBIDX *idx, int64_t *rnp, int64_t *tlp){
+  assert(idx && rnp && tlp);
+  int vsiz;
+  const char *vbuf = tcbdbget3(idx->db, "", 1, &vsiz);
+  if(!vbuf) return false;
+  int rstep, tstep;
+  TCREADVNUMBUF64(vbuf, *rnp, rstep);
+  TCREADVNUMBUF64(vbuf + rstep, *tlp, tstep);
+  return rstep + tstep <= vsiz;
 }
 
 
@@ -5887,6 +10160,9 @@ static bool tctdbdefragimpl(TCTDB *tdb, int64_t step){
     switch(idx->type){
     case TDBITLEXICAL:
     case TDBITDECIMAL:
+    case TDBITINT64:
+    case TDBITDOUBLE:
+    case TDBITCOMPOSITE:
     case TDBITTOKEN:
     case TDBITQGRAM:
       if(!tcbdbdefrag(idx->db, step)){
@@ -5922,7 +10198,7 @@ static bool tctdbforeachimpl(TCTDB *tdb, TCITER iter, void *op){
     }
     memcpy(rbuf, pkbuf, pksiz);
     stack[pksiz] = '\0';
-    TCMAP *cols = tcmapload(cbuf, csiz);
+    TCMAP *cols = tctdbrowload(tdb, cbuf, csiz);
     int zsiz;
     char *zbuf = tcstrjoin4(cols, &zsiz);
     bool rv = iter(rbuf, pksiz, zbuf, zsiz, op);
@@ -5939,6 +10215,75 @@ static bool tctdbforeachimpl(TCTDB *tdb, TCITER iter, void *op){
 }
 
 
+/* Process each record of a table database object by partitions in parallel.
+   `tdb' specifies the table database object.
+   `iter' specifies the pointer to the iterator function called for each record.
+   `ops' specifies the array of the opaque pointers of the workers.
+   `tnum' specifies the number of the workers.
+   `reduce' specifies the pointer to the reduce function or `NULL'.
+   `rop' specifies the opaque pointer given to the reduce function.
+   If successful, the return value is true, else, it is false.
+   The records are partitioned by the internal hash database and the columns are converted by
+   each worker. */
+static bool tctdbforeachparimpl(TCTDB *tdb, TCITER iter, void **ops, int tnum,
+                                TCREDUCE reduce, void *rop){
+  assert(tdb && iter && ops);
+  if(tnum < 1) tnum = 1;
+  TDBFEOP *fops;
+  TCMALLOC(fops, sizeof(*fops) * tnum);
+  void **wops;
+  TCMALLOC(wops, sizeof(*wops) * tnum);
+  for(int i = 0; i < tnum; i++){
+    fops[i].tdb = tdb;
+    fops[i].iter = iter;
+    fops[i].op = ops[i];
+    wops[i] = fops + i;
+  }
+  bool err = false;
+  if(!tchdbforeachpar(tdb->hdb, tctdbforeachiter, wops, tnum, NULL, NULL)){
+    tctdbsetecode(tdb, tchdbecode(tdb->hdb), __FILE__, __LINE__, __func__);
+    err = true;
+  }
+  if(reduce){
+    for(int i = 0; i < tnum; i++){
+      reduce(ops[i], rop);
+    }
+  }
+  TCFREE(wops);
+  TCFREE(fops);
+  return !err;
+}
+
+
+/* Convert the columns of a record for the iterator function of parallel iteration.
+   `kbuf' specifies the pointer to the region of the primary key.
+   `ksiz' specifies the size of the region of the primary key.
+   `vbuf' specifies the pointer to the region of the serialized columns.
+   `vsiz' specifies the size of the region of the serialized columns.
+   `op' specifies the pointer to the structure of the worker.
+   The return value is the return value of the iterator function of the worker. */
+static bool tctdbforeachiter(const void *kbuf, int ksiz, const void *vbuf, int vsiz, void *op){
+  assert(kbuf && ksiz >= 0 && vbuf && vsiz >= 0 && op);
+  TDBFEOP *fop = op;
+  char stack[TDBPAGEBUFSIZ], *rbuf;
+  if(ksiz < TDBPAGEBUFSIZ){
+    rbuf = stack;
+  } else {
+    TCMALLOC(rbuf, ksiz + 1);
+  }
+  memcpy(rbuf, kbuf, ksiz);
+  rbuf[ksiz] = '\0';
+  TCMAP *cols = tctdbrowload(fop->tdb, vbuf, vsiz);
+  int zsiz;
+  char *zbuf = tcstrjoin4(cols, &zsiz);
+  bool rv = fop->iter(rbuf, ksiz, zbuf, zsiz, fop->op);
+  TCFREE(zbuf);
+  tcmapdel(cols);
+  if(rbuf != stack) TCFREE(rbuf);
+  return rv;
+}
+
+
 /* Answer to remove for each record of a query.
    `pkbuf' is ignored.
    `pksiz' is ignored.
@@ -49,6 +49,7 @@ typedef struct {                         /* type of structure for a column index
   int type;                              /* data type */
   void *db;                              /* internal database object */
   void *cc;                              /* internal cache object */
+  void *cols;                            /* column list of a composite index */
 } TDBIDX;
 
 typedef struct {                         /* type of structure for a table database */
@@ -64,6 +65,9 @@ typedef struct {                         /* type of structure for a table databa
   TDBIDX *idxs;                          /* column indices */
   int inum;                              /* number of column indices */
   bool tran;                             /* whether in the transaction */
+  int32_t stnum;                         /* number of threads for parallel scan */
+  void *cdic;                            /* column dictionary of the columnar format */
+  void *cnames;                          /* column names by identifiers */
 } TCTDB;
 
 enum {                                   /* enumeration for additional flags */
@@ -76,7 +80,8 @@ enum {                                   /* enumeration for tuning options */
   TDBTDEFLATE = 1 << 1,                  /* compress each page with Deflate */
   TDBTBZIP = 1 << 2,                     /* compress each record with BZIP2 */
   TDBTTCBS = 1 << 3,                     /* compress each page with TCBS */
-  TDBTEXCODEC = 1 << 4                   /* compress each record with outer functions */
+  TDBTEXCODEC = 1 << 4,                  /* compress each record with outer functions */
+  TDBTCOLUMNAR = 1 << 5                  /* store each record in the columnar format */
 };
 
 enum {                                   /* enumeration for open modes */
@@ -94,6 +99,9 @@ enum {                                   /* enumeration for index types */
   TDBITDECIMAL,                          /* decimal string */
   TDBITTOKEN,                            /* token inverted index */
   TDBITQGRAM,                            /* q-gram inverted index */
+  TDBITINT64,                            /* 64-bit integer in binary */
+  TDBITDOUBLE,                           /* real number in binary */
+  TDBITCOMPOSITE,                        /* composite of columns */
   TDBITOPT = 9998,                       /* optimize */
   TDBITVOID = 9999,                      /* void */
   TDBITKEEP = 1 << 24                    /* keep existing index */
@@ -110,6 +118,9 @@ typedef struct {                         /* type of structure for a condition */
   void *regex;                           /* regular expression object */
   void *ftsunits;                        /* full-text search units */
   int ftsnum;                            /* number of full-text search units */
+  int ftsop;                             /* operation type of full-text search */
+  int64_t *nums;                         /* numbers of the operand expression */
+  int numnum;                            /* number of the numbers */
   bool alive;                            /* alive flag */
 } TDBCOND;
 
@@ -123,8 +134,38 @@ typedef struct {                         /* type of structure for a query */
   int skip;                              /* skipping number of retrieval */
   TCXSTR *hint;                          /* hint string */
   int count;                             /* count of corresponding records */
+  int *plan;                             /* cached plan of index usage */
 } TDBQRY;
 
+typedef struct {                         /* type of structure for a query cursor */
+  TDBQRY *qry;                           /* query object */
+  int mode;                              /* traversal mode */
+  char *iname;                           /* column name of the traversed index */
+  int itype;                             /* type of the traversed index */
+  TDBCOND *mcond;                        /* condition driving the index */
+  bool asc;                              /* ascending order */
+  TCLIST *segs;                          /* key segments of the index */
+  int sidx;                              /* index of the current segment */
+  TCXSTR *ikey;                          /* last index key */
+  TCXSTR *pkey;                          /* last primary key */
+  TCLIST *res;                           /* materialized result */
+  int ridx;                              /* index of the materialized result */
+  bool begun;                            /* begun flag */
+  bool ahead;                            /* look-ahead flag */
+  bool done;                             /* done flag */
+  int skip;                              /* number of records to be skipped */
+  int left;                              /* number of records to be retrieved */
+} TDBQRYCUR;
+
+typedef struct {                         /* type of structure for an aggregated group */
+  int64_t num;                           /* number of records */
+  int64_t vnum;                          /* number of records having the aggregated column */
+  double sum;                            /* summation of the values */
+  double min;                            /* minimum of the values */
+  double max;                            /* maximum of the values */
+  int64_t dnum;                          /* approximate number of distinct values */
+} TDBAGGR;
+
 enum {                                   /* enumeration for query conditions */
   TDBQCSTREQ,                            /* string is equal to */
   TDBQCSTRINC,                           /* string is included in */
@@ -231,9 +272,17 @@ bool tctdbsetmutex(TCTDB *tdb);
    `opts' specifies options by bitwise-or: `TDBTLARGE' specifies that the size of the database
    can be larger than 2GB by using 64-bit bucket array, `TDBTDEFLATE' specifies that each record
    is compressed with Deflate encoding, `TDBTBZIP' specifies that each record is compressed with
-   BZIP2 encoding, `TDBTTCBS' specifies that each record is compressed with TCBS encoding.
+   BZIP2 encoding, `TDBTTCBS' specifies that each record is compressed with TCBS encoding,
+   `TDBTCOLUMNAR' specifies that each record is stored in the columnar format, which has an
+   offset table of the columns identified by the column dictionary of the database.
    If successful, the return value is true, else, it is false.
-   Note that the tuning parameters should be set before the database is opened. */
+   Note that the tuning parameters should be set before the database is opened.  The columnar
+   format is applied only when a database file is created.  The offset table of each record has an
+   entry for every column identifier up to the largest one in the record, or a pair of the
+   identifier and the offset for every present column if the record has only a few of the columns
+   of the dictionary.  So, the columnar format suits records sharing a fixed set of columns, and it
+   is not efficient for records of many distinct column names because the dictionary, which keeps
+   every name ever stored, is never shrunk. */
 bool tctdbtune(TCTDB *tdb, int64_t bnum, int8_t apow, int8_t fpow, uint8_t opts);
 
 
@@ -574,11 +623,13 @@ bool tctdbsync(TCTDB *tdb);
    `opts' specifies options by bitwise-or: `BDBTLARGE' specifies that the size of the database
    can be larger than 2GB by using 64-bit bucket array, `BDBTDEFLATE' specifies that each record
    is compressed with Deflate encoding, `BDBTBZIP' specifies that each record is compressed with
-   BZIP2 encoding, `BDBTTCBS' specifies that each record is compressed with TCBS encoding.  If it
-   is `UINT8_MAX', the current setting is not changed.
+   BZIP2 encoding, `BDBTTCBS' specifies that each record is compressed with TCBS encoding,
+   `TDBTCOLUMNAR' specifies that each record is stored in the columnar format.  If it is
+   `UINT8_MAX', the current setting is not changed.
    If successful, the return value is true, else, it is false.
    This function is useful to reduce the size of the database file with data fragmentation by
-   successive updating. */
+   successive updating.  If the option `TDBTCOLUMNAR' is changed, every record is converted into
+   the new format. */
 bool tctdboptimize(TCTDB *tdb, int64_t bnum, int8_t apow, int8_t fpow, uint8_t opts);
 
 
@@ -653,9 +704,21 @@ uint64_t tctdbfsiz(TCTDB *tdb);
    `name' specifies the name of a column.  If the name of an existing index is specified, the
    index is rebuilt.  An empty string means the primary key.
    `type' specifies the index type: `TDBITLEXICAL' for lexical string, `TDBITDECIMAL' for decimal
-   string, `TDBITTOKEN' for token inverted index, `TDBITQGRAM' for q-gram inverted index.  If it
-   is `TDBITOPT', the index is optimized.  If it is `TDBITVOID', the index is removed.  If
-   `TDBITKEEP' is added by bitwise-or and the index exists, this function merely returns failure.
+   string, `TDBITTOKEN' for token inverted index, `TDBITQGRAM' for q-gram inverted index,
+   `TDBITINT64' for 64-bit integer, `TDBITDOUBLE' for real number.  The last two store each value
+   as a fixed-width binary key so that numeric conditions are evaluated without parsing text.  A
+   real number key consists of the integer part and the fraction of a value, ignoring an exponent,
+   and the conditions served by it are also checked on each record because numeric conditions
+   compare integer parts.  If a decimal index of the same column exists, it is converted into the
+   binary one.  If it is `TDBITCOMPOSITE', the index is over multiple columns and `name' specifies
+   their names separated by commas in order, each of which can be followed by a colon and "int64"
+   or "double" to compare the column as a number.  A search uses it with equality conditions on the
+   leading columns and an optional range condition on the next column, unless the estimated
+   records of a single-column index are fewer.  If it is `TDBITOPT', the index is optimized.  If
+   it is `TDBITVOID', the index is removed.  If `TDBITKEEP' is added by bitwise-or and the index
+   exists, this function merely returns failure.  Lexical, decimal, and binary numeric indices
+   keep statistics of their values, which are collected when the index is created or optimized
+   and used to choose the most selective index for a search.
    If successful, the return value is true, else, it is false.
    Note that the setting indices should be set after the database is opened. */
 bool tctdbsetindex(TCTDB *tdb, const char *name, int type);
@@ -701,6 +764,20 @@ void tctdbqrydel(TDBQRY *qry);
 void tctdbqryaddcond(TDBQRY *qry, const char *name, int op, const char *expr);
 
 
+/* Bind a new operand expression to a condition of a query object.
+   `qry' specifies the query object.
+   `index' specifies the index of the condition, which counts conditions in the order of
+   addition from 0.
+   `expr' specifies the new operand exression.
+   If successful, the return value is true, else, it is false.  False is returned if the index
+   is out of bounds.
+   A query object can be used as a prepared statement: conditions are added once with
+   placeholder expressions and each execution binds the actual values.  Only the bound condition
+   is parsed again.  The other conditions keep their compiled regular expressions and parsed
+   tokens, and the plan chosen at the first execution is reused until a condition is added. */
+bool tctdbqrybind(TDBQRY *qry, int index, const char *expr);
+
+
 /* Set the order of a query object.
    `qry' specifies the query object.
    `name' specifies the name of a column.  An empty string means the primary key.
@@ -751,7 +828,9 @@ bool tctdbqryproc(TDBQRY *qry, TDBQRYPROC proc, void *op);
    `qry' specifies the query object.
    The return value is the hint string.
    This function should be called after the query execution by `tctdbqrysearch' and so on.  The
-   region of the return value is overwritten when this function is called again. */
+   region of the return value is overwritten when this function is called again.  If multiple
+   conditions can use indices, the estimated number of records of each and the estimated result
+   set size are shown besides the actual sizes. */
 const char *tctdbqryhint(TDBQRY *qry);
 
 
@@ -768,6 +847,102 @@ const char *tctdbqryhint(TDBQRY *qry);
 TCLIST *tctdbmetasearch(TDBQRY **qrys, int num, int type);
 
 
+/* Create a cursor of a query object.
+   `qry' specifies the query object.
+   The return value is the new cursor object, or `NULL' on failure.
+   A cursor retrieves the primary keys of the corresponding records one by one, from the index
+   which the query would use or from the whole table, and evaluates the other conditions lazily,
+   so the memory usage does not depend on the number of the corresponding records.  Ordered
+   queries are traversed with the index of the ordering column if it covers every record, and
+   are materialized at the first retrieval otherwise.  The query object should not be modified
+   nor deleted while the cursor is in use.  Because the object of the return value is allocated
+   by the function `malloc', it should be deleted with the function `tctdbqrycurdel' when it is
+   no longer in use. */
+TDBQRYCUR *tctdbqrycurnew(TDBQRY *qry);
+
+
+/* Delete a query cursor object.
+   `cur' specifies the cursor object. */
+void tctdbqrycurdel(TDBQRYCUR *cur);
+
+
+/* Move a query cursor object to the position just after a record.
+   `cur' specifies the cursor object.
+   `pkbuf' specifies the pointer to the region of the primary key of a record which the cursor
+   has returned before.
+   `pksiz' specifies the size of the region of the primary key.
+   If successful, the return value is true, else, it is false.  False is returned if the record
+   does not exist or it does not correspond to the query.
+   This function enables keyset pagination: a cursor created for another page of the same query
+   resumes after the last primary key of the previous page without counting skipped records. */
+bool tctdbqrycurjump(TDBQRYCUR *cur, const void *pkbuf, int pksiz);
+
+
+/* Get the primary key of the next record of a query cursor object.
+   `cur' specifies the cursor object.
+   `sp' specifies the pointer to the variable into which the size of the region of the return
+   value is assigned.
+   If successful, the return value is the pointer to the region of the primary key of the next
+   corresponding record, else, it is `NULL'.  `NULL' is returned when no record is to be get
+   out of the cursor.
+   Because an additional zero code is appended at the end of the region of the return value,
+   the return value can be treated as a character string.  Because the region of the return
+   value is allocated with the `malloc' call, it should be released with the `free' call when it
+   is no longer in use.  The records can be updated or removed while they are retrieved, but the
+   traversal of the whole table ends when the record next to the last returned one is removed. */
+void *tctdbqrycurnext(TDBQRYCUR *cur, int *sp);
+
+
+/* Get the primary key string of the next record of a query cursor object.
+   `cur' specifies the cursor object.
+   If successful, the return value is the string of the primary key of the next corresponding
+   record, else, it is `NULL'.  `NULL' is returned when no record is to be get out of the cursor.
+   Because the region of the return value is allocated with the `malloc' call, it should be
+   released with the `free' call when it is no longer in use. */
+char *tctdbqrycurnext2(TDBQRYCUR *cur);
+
+
+/* Aggregate the records corresponding to a query object by groups.
+   `qry' specifies the query object.
+   `gname' specifies the name of the column to group records by.  If it is `NULL', all records
+   belong to one group.  Records without the column are gathered into the group of the empty
+   string.
+   `aname' specifies the name of the column whose values are aggregated as real numbers.  If it is
+   `NULL', only records are counted and the distinct primary keys are estimated.
+   The return value is a map object whose keys are the values of the grouping column and whose
+   values are regions of the structure `TDBAGGR': the number of records, the number of records
+   having the aggregated column, the summation, the minimum and the maximum of its values, and the
+   approximate number of its distinct values.  The average is the summation divided by the number
+   of records having the column.  This function does never fail.  It returns an empty map even if
+   no record corresponds.
+   The groups are accumulated in a hash table while the index or the whole table is traversed as
+   the query would, without materializing the result.  The whole table is scanned in parallel if
+   the number of threads is set by `tctdbsetparallel'.  The order and the limit of the query are
+   ignored.  Distinct values are estimated with registers of their hash values, whose error is
+   about 6 percent.  Because the object of the return value is created with the function
+   `tcmapnew', it should be deleted with the function `tcmapdel' when it is no longer in use. */
+TCMAP *tctdbqryaggr(TDBQRY *qry, const char *gname, const char *aname);
+
+
+/* Rank the records corresponding to a query object by the relevance to full-text search words.
+   `qry' specifies the query object.
+   `name' specifies the name of a column with a token inverted index or a q-gram inverted index.
+   `expr' specifies the string of the words separated by spaces or commas.  A word of a q-gram
+   inverted index is searched for as a phrase.
+   `max' specifies the maximum number of records to be ranked.  If it is negative, all records
+   having at least one of the words are ranked.
+   The return value is a map object whose keys are the primary keys of the top records and whose
+   values are their scores in decimal strings, in the descending order of the scores.  This
+   function does never fail.  It returns an empty map even if no record corresponds.
+   The scores are calculated by the BM25 formula with the frequencies of the words and the
+   lengths of the column values recorded in the index.  Records which cannot exceed the score of
+   the last of the top records are skipped without evaluating all words.  The conditions of the
+   query are checked only for the records to be ranked, and its order and limit are ignored.
+   Because the object of the return value is created with the function `tcmapnew', it should be
+   deleted with the function `tcmapdel' when it is no longer in use. */
+TCMAP *tctdbqryrank(TDBQRY *qry, const char *name, const char *expr, int max);
+
+
 
 /*************************************************************************************************
  * features for experts
@@ -898,6 +1073,18 @@ bool tctdbsetuidseed(TCTDB *tdb, int64_t seed);
 bool tctdbsetinvcache(TCTDB *tdb, int64_t iccmax, double iccsync);
 
 
+/* Set the number of threads of parallel scan of a table database object.
+   `tdb' specifies the table database object.
+   `tnum' specifies the number of worker threads of the full scan of query execution.  If it is
+   not more than 1, the full scan is performed by the calling thread only.  It is 1 by default.
+   If successful, the return value is true, else, it is false.
+   When no index is available for a query, the region of records of the internal hash database
+   is divided into ranges of offsets and the conditions are evaluated by the worker threads.  If
+   the order is not specified, the scan stops as soon as the maximum number of the result is
+   found. */
+bool tctdbsetparallel(TCTDB *tdb, int32_t tnum);
+
+
 /* Set the custom codec functions of a table database object.
    `tdb' specifies the table database object.
    `enc' specifies the pointer to the custom encoding function.  It receives four parameters.
@@ -1005,6 +1192,27 @@ bool tctdbiterinit3(TCTDB *tdb, const char *kstr);
 bool tctdbforeach(TCTDB *tdb, TCITER iter, void *op);
 
 
+/* Process each record of a table database object by partitions in parallel.
+   `tdb' specifies the table database object.
+   `iter' specifies the pointer to the iterator function called for each record.  It receives
+   the same parameters as with `tctdbforeach'.
+   `ops' specifies the array of arbitrary pointers.  Each worker gives its own element as the
+   fifth parameter of the iterator function.
+   `tnum' specifies the number of workers.  The array `ops' should have as many elements.
+   `reduce' specifies the pointer to the reduce function called for each worker after all
+   workers finish.  It receives the element of `ops' of the worker and `rop'.  If it is `NULL',
+   no reduce function is called.
+   `rop' specifies an arbitrary pointer to be given as a parameter of the reduce function.  If
+   it is not needed, `NULL' can be specified.
+   If successful, the return value is true, else, it is false.
+   The records are divided into ranges of offsets in the file of the internal hash database as
+   with `tchdbforeachpar'.  Because the iterator function is called by workers concurrently, it
+   should not modify any object shared among workers without synchronization.  Note that the
+   callback function can not perform any database operation because the function is called in
+   the critical section guarded by the same locks of database operations. */
+bool tctdbforeachpar(TCTDB *tdb, TCITER iter, void **ops, int tnum, TCREDUCE reduce, void *rop);
+
+
 /* Process each record corresponding to a query object with non-atomic fashion.
    `qry' specifies the query object of the database connected as a writer.
    `proc' specifies the pointer to the iterator function called for each record.  It receives
@@ -50,7 +50,8 @@ static int procget(const char *path, const char *pkbuf, int pksiz, int omode, bo
 static int proclist(const char *path, int omode, int max, bool pv, bool px, const char *fmstr);
 static int procsearch(const char *path, TCLIST *conds, const char *oname, const char *otype,
                       int omode, int max, int skip, bool pv, bool px, bool kw, bool ph, int bt,
-                      bool rm, const char *mtype);
+                      bool rm, const char *mtype, int tnum,
+                      const char *gname, const char *aname, const char *rname, const char *rexpr);
 static int procoptimize(const char *path, int bnum, int apow, int fpow, int opts, int omode,
                         bool df);
 static int procsetindex(const char *path, const char *name, int omode, int type);
@@ -100,7 +101,8 @@ static void usage(void){
   fprintf(stderr, "%s: the command line utility of the table database API\n", g_progname);
   fprintf(stderr, "\n");
   fprintf(stderr, "usage:\n");
-  fprintf(stderr, "  %s create [-tl] [-td|-tb|-tt|-tx] path [bnum [apow [fpow]]]\n", g_progname);
+  fprintf(stderr, "  %s create [-tl] [-td|-tb|-tt|-tx] [-tc] path [bnum [apow [fpow]]]\n",
+          g_progname);
   fprintf(stderr, "  %s inform [-nl|-nb] path\n", g_progname);
   fprintf(stderr, "  %s put [-nl|-nb] [-sx] [-dk|-dc|-dai|-dad] path pkey [cols...]\n",
           g_progname);
@@ -108,8 +110,9 @@ static void usage(void){
   fprintf(stderr, "  %s get [-nl|-nb] [-sx] [-px] [-pz] path pkey\n", g_progname);
   fprintf(stderr, "  %s list [-nl|-nb] [-m num] [-pv] [-px] [-fm str] path\n", g_progname);
   fprintf(stderr, "  %s search [-nl|-nb] [-ord name type] [-m num] [-sk num] [-kw] [-pv] [-px]"
-          " [-ph] [-bt num] [-rm] [-ms type] path [name op expr ...]\n", g_progname);
-  fprintf(stderr, "  %s optimize [-tl] [-td|-tb|-tt|-tx] [-tz] [-nl|-nb] [-df]"
+          " [-ph] [-bt num] [-rm] [-ms type] [-tn num] [-ag gname aname]"
+          " [-rk name expr] path [name op expr ...]\n", g_progname);
+  fprintf(stderr, "  %s optimize [-tl] [-td|-tb|-tt|-tx] [-tc] [-tz] [-nl|-nb] [-df]"
           " path [bnum [apow [fpow]]]\n", g_progname);
   fprintf(stderr, "  %s setindex [-nl|-nb] [-it type] path name\n", g_progname);
   fprintf(stderr, "  %s importtsv [-nl|-nb] [-sc] path [file]\n", g_progname);
@@ -194,6 +197,8 @@ static int runcreate(int argc, char **argv){
         opts |= TDBTTCBS;
       } else if(!strcmp(argv[i], "-tx")){
         opts |= TDBTEXCODEC;
+      } else if(!strcmp(argv[i], "-tc")){
+        opts |= TDBTCOLUMNAR;
       } else {
         usage();
       }
@@ -452,6 +457,11 @@ static int runsearch(int argc, char **argv){
   int bt = 0;
   bool rm = false;
   char *mtype = NULL;
+  int tnum = 1;
+  char *gname = NULL;
+  char *aname = NULL;
+  char *rname = NULL;
+  char *rexpr = NULL;
   for(int i = 2; i < argc; i++){
     if(!path && argv[i][0] == '-'){
       if(!strcmp(argv[i], "-nl")){
@@ -485,6 +495,19 @@ static int runsearch(int argc, char **argv){
       } else if(!strcmp(argv[i], "-ms")){
         if(++i >= argc) usage();
         mtype = argv[i];
+      } else if(!strcmp(argv[i], "-tn")){
+        if(++i >= argc) usage();
+        tnum = tcatoix(argv[i]);
+      } else if(!strcmp(argv[i], "-ag")){
+        if(++i >= argc) usage();
+        gname = argv[i];
+        if(++i >= argc) usage();
+        aname = argv[i];
+      } else if(!strcmp(argv[i], "-rk")){
+        if(++i >= argc) usage();
+        rname = argv[i];
+        if(++i >= argc) usage();
+        rexpr = argv[i];
       } else {
         usage();
       }
@@ -496,7 +519,7 @@ static int runsearch(int argc, char **argv){
   }
   if(!path || tclistnum(conds) % 3 != 0) usage();
   int rv = procsearch(path, conds, oname, otype, omode, max, skip,
-                      pv, px, kw, ph, bt, rm, mtype);
+                      pv, px, kw, ph, bt, rm, mtype, tnum, gname, aname, rname, rexpr);
   return rv;
 }
 
@@ -527,6 +550,9 @@ static int runoptimize(int argc, char **argv){
       } else if(!strcmp(argv[i], "-tx")){
         if(opts == UINT8_MAX) opts = 0;
         opts |= TDBTEXCODEC;
+      } else if(!strcmp(argv[i], "-tc")){
+        if(opts == UINT8_MAX) opts = 0;
+        opts |= TDBTCOLUMNAR;
       } else if(!strcmp(argv[i], "-tz")){
         if(opts == UINT8_MAX) opts = 0;
       } else if(!strcmp(argv[i], "-nl")){
@@ -702,6 +728,18 @@ static int procinform(const char *path, int omode){
       printf("  name=%s, type=qgram, rnum=%lld, fsiz=%lld\n",
              idxp->name, (long long)tcbdbrnum(idxp->db), (long long)tcbdbfsiz(idxp->db));
       break;
+    case TDBITINT64:
+      printf("  name=%s, type=int64, rnum=%lld, fsiz=%lld\n",
+             idxp->name, (long long)tcbdbrnum(idxp->db), (long long)tcbdbfsiz(idxp->db));
+      break;
+    case TDBITDOUBLE:
+      printf("  name=%s, type=double, rnum=%lld, fsiz=%lld\n",
+             idxp->name, (long long)tcbdbrnum(idxp->db), (long long)tcbdbfsiz(idxp->db));
+      break;
+    case TDBITCOMPOSITE:
+      printf("  name=%s, type=composite, rnum=%lld, fsiz=%lld\n",
+             idxp->name, (long long)tcbdbrnum(idxp->db), (long long)tcbdbfsiz(idxp->db));
+      break;
     }
   }
   printf("unique ID seed: %lld\n", (long long)tctdbuidseed(tdb));
@@ -716,6 +754,7 @@ static int procinform(const char *path, int omode){
   if(opts & TDBTBZIP) printf(" bzip");
   if(opts & TDBTTCBS) printf(" tcbs");
   if(opts & TDBTEXCODEC) printf(" excodec");
+  if(opts & TDBTCOLUMNAR) printf(" columnar");
   printf("\n");
   printf("record number: %llu\n", (unsigned long long)tctdbrnum(tdb));
   printf("file size: %llu\n", (unsigned long long)tctdbfsiz(tdb));
@@ -934,10 +973,12 @@ static int proclist(const char *path, int omode, int max, bool pv, bool px, cons
 /* perform search command */
 static int procsearch(const char *path, TCLIST *conds, const char *oname, const char *otype,
                       int omode, int max, int skip, bool pv, bool px, bool kw, bool ph, int bt,
-                      bool rm, const char *mtype){
+                      bool rm, const char *mtype, int tnum,
+                      const char *gname, const char *aname, const char *rname, const char *rexpr){
   TCTDB *tdb = tctdbnew();
   if(g_dbgfd >= 0) tctdbsetdbgfd(tdb, g_dbgfd);
   if(!tctdbsetcodecfunc(tdb, _tc_recencode, NULL, _tc_recdecode, NULL)) printerr(tdb);
+  if(!tctdbsetparallel(tdb, tnum)) printerr(tdb);
   if(!tctdbopen(tdb, path, (rm ? TDBOWRITER : TDBOREADER) | omode)){
     printerr(tdb);
     tctdbdel(tdb);
@@ -977,6 +1018,62 @@ static int procsearch(const char *path, TCLIST *conds, const char *oname, const
       printf("\t:::: number of records: %d\n", tctdbqrycount(qry));
       printf("\t:::: elapsed time: %.5f\n", etime - stime);
     }
+  } else if(gname){
+    double stime = tctime();
+    TCMAP *res = tctdbqryaggr(qry, *gname != '\0' ? gname : NULL, *aname != '\0' ? aname : NULL);
+    double etime = tctime();
+    TCLIST *groups = tcmapkeys(res);
+    tclistsort(groups);
+    int gnum = tclistnum(groups);
+    for(int i = 0; i < gnum; i++){
+      int gsiz;
+      const char *gbuf = tclistval(groups, i, &gsiz);
+      int vsiz;
+      TDBAGGR aggr;
+      memcpy(&aggr, tcmapget(res, gbuf, gsiz, &vsiz), sizeof(aggr));
+      printdata(gbuf, gsiz, px);
+      printf("\t%lld\t%lld\t%.3f\t%.3f\t%.3f\t%.3f\t%lld\n",
+             (long long)aggr.num, (long long)aggr.vnum, aggr.sum, aggr.min, aggr.max,
+             aggr.vnum > 0 ? aggr.sum / aggr.vnum : 0.0, (long long)aggr.dnum);
+    }
+    tclistdel(groups);
+    tcmapdel(res);
+    if(ph){
+      TCLIST *hints = tcstrsplit(tctdbqryhint(qry), "\n");
+      int hnum = tclistnum(hints);
+      for(int i = 0; i < hnum; i++){
+        const char *hint = tclistval2(hints, i);
+        if(*hint == '\0') continue;
+        printf("\t:::: %s\n", hint);
+      }
+      tclistdel(hints);
+      printf("\t:::: number of records: %d\n", tctdbqrycount(qry));
+      printf("\t:::: elapsed time: %.5f\n", etime - stime);
+    }
+  } else if(rname){
+    double stime = tctime();
+    TCMAP *res = tctdbqryrank(qry, rname, rexpr, max);
+    double etime = tctime();
+    tcmapiterinit(res);
+    const char *pkbuf;
+    int pksiz;
+    while((pkbuf = tcmapiternext(res, &pksiz)) != NULL){
+      printdata(pkbuf, pksiz, px);
+      printf("\t%s\n", tcmapiterval2(pkbuf));
+    }
+    tcmapdel(res);
+    if(ph){
+      TCLIST *hints = tcstrsplit(tctdbqryhint(qry), "\n");
+      int hnum = tclistnum(hints);
+      for(int i = 0; i < hnum; i++){
+        const char *hint = tclistval2(hints, i);
+        if(*hint == '\0') continue;
+        printf("\t:::: %s\n", hint);
+      }
+      tclistdel(hints);
+      printf("\t:::: number of records: %d\n", tctdbqrycount(qry));
+      printf("\t:::: elapsed time: %.5f\n", etime - stime);
+    }
   } else if(bt > 0){
     double sum = 0;
     for(int i = 1; i <= bt; i++){
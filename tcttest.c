@@ -37,6 +37,8 @@ static void sysprint(void);
 static int myrand(int range);
 static void *pdprocfunc(const void *vbuf, int vsiz, int *sp, void *op);
 static bool iterfunc(const void *kbuf, int ksiz, const void *vbuf, int vsiz, void *op);
+static bool itercount(const void *kbuf, int ksiz, const void *vbuf, int vsiz, void *op);
+static void reducecount(void *op, void *rop);
 static int runwrite(int argc, char **argv);
 static int runread(int argc, char **argv);
 static int runremove(int argc, char **argv);
@@ -98,18 +100,20 @@ static void usage(void){
   fprintf(stderr, "%s: test cases of the table database API of Tokyo Cabinet\n", g_progname);
   fprintf(stderr, "\n");
   fprintf(stderr, "usage:\n");
-  fprintf(stderr, "  %s write [-mt] [-tl] [-td|-tb|-tt|-tx] [-rc num] [-lc num] [-nc num]"
-          " [-xm num] [-df num] [-ip] [-is] [-in] [-it] [-if] [-ix] [-nl|-nb] [-rnd]"
+  fprintf(stderr, "  %s write [-mt] [-tl] [-td|-tb|-tt|-tx] [-tc] [-rc num] [-lc num]"
+          " [-nc num] [-xm num] [-df num] [-ip] [-is] [-in] [-it] [-if] [-ix] [-nl|-nb] [-rnd]"
           " path rnum [bnum [apow [fpow]]]\n", g_progname);
   fprintf(stderr, "  %s read [-mt] [-rc num] [-lc num] [-nc num] [-xm num] [-df num]"
           " [-nl|-nb] [-rnd] path\n", g_progname);
   fprintf(stderr, "  %s remove [-mt] [-rc num] [-lc num] [-nc num] [-xm num] [-df num]"
           " [-nl|-nb] [-rnd] path\n", g_progname);
-  fprintf(stderr, "  %s rcat [-mt] [-tl] [-td|-tb|-tt|-tx] [-rc num] [-lc num] [-nc num]"
-          " [-xm num] [-df num] [-ip] [-is] [-in] [-it] [-if] [-ix] [-nl|-nb] [-pn num]"
+  fprintf(stderr, "  %s rcat [-mt] [-tl] [-td|-tb|-tt|-tx] [-tc] [-rc num] [-lc num]"
+          " [-nc num] [-xm num] [-df num] [-ip] [-is] [-in] [-it] [-if] [-ix] [-nl|-nb] [-pn num]"
           " [-dai|-dad|-rl|-ru] path rnum [bnum [apow [fpow]]]\n", g_progname);
-  fprintf(stderr, "  %s misc [-mt] [-tl] [-td|-tb|-tt|-tx] [-nl|-nb] path rnum\n", g_progname);
-  fprintf(stderr, "  %s wicked [-mt] [-tl] [-td|-tb|-tt|-tx] [-nl|-nb] path rnum\n", g_progname);
+  fprintf(stderr, "  %s misc [-mt] [-tl] [-td|-tb|-tt|-tx] [-tc] [-nl|-nb] path rnum\n",
+          g_progname);
+  fprintf(stderr, "  %s wicked [-mt] [-tl] [-td|-tb|-tt|-tx] [-tc] [-nl|-nb] path rnum\n",
+          g_progname);
   fprintf(stderr, "\n");
   exit(1);
 }
@@ -191,6 +195,24 @@ static bool iterfunc(const void *kbuf, int ksiz, const void *vbuf, int vsiz, voi
 }
 
 
+/* iterator function to count records */
+static bool itercount(const void *kbuf, int ksiz, const void *vbuf, int vsiz, void *op){
+  int64_t *cnts = op;
+  cnts[0]++;
+  cnts[1] += ksiz + vsiz;
+  return true;
+}
+
+
+/* reduce function to sum up counts */
+static void reducecount(void *op, void *rop){
+  int64_t *cnts = op;
+  int64_t *sums = rop;
+  sums[0] += cnts[0];
+  sums[1] += cnts[1];
+}
+
+
 /* parse arguments of write command */
 static int runwrite(int argc, char **argv){
   char *path = NULL;
@@ -222,6 +244,8 @@ static int runwrite(int argc, char **argv){
         opts |= TDBTTCBS;
       } else if(!strcmp(argv[i], "-tx")){
         opts |= TDBTEXCODEC;
+      } else if(!strcmp(argv[i], "-tc")){
+        opts |= TDBTCOLUMNAR;
       } else if(!strcmp(argv[i], "-rc")){
         if(++i >= argc) usage();
         rcnum = tcatoix(argv[i]);
@@ -421,6 +445,8 @@ static int runrcat(int argc, char **argv){
         opts |= TDBTTCBS;
       } else if(!strcmp(argv[i], "-tx")){
         opts |= TDBTEXCODEC;
+      } else if(!strcmp(argv[i], "-tc")){
+        opts |= TDBTCOLUMNAR;
       } else if(!strcmp(argv[i], "-xm")){
         if(++i >= argc) usage();
         xmsiz = tcatoix(argv[i]);
@@ -513,6 +539,8 @@ static int runmisc(int argc, char **argv){
         opts |= TDBTTCBS;
       } else if(!strcmp(argv[i], "-tx")){
         opts |= TDBTEXCODEC;
+      } else if(!strcmp(argv[i], "-tc")){
+        opts |= TDBTCOLUMNAR;
       } else if(!strcmp(argv[i], "-nl")){
         omode |= TDBONOLCK;
       } else if(!strcmp(argv[i], "-nb")){
@@ -557,6 +585,8 @@ static int runwicked(int argc, char **argv){
         opts |= TDBTTCBS;
       } else if(!strcmp(argv[i], "-tx")){
         opts |= TDBTEXCODEC;
+      } else if(!strcmp(argv[i], "-tc")){
+        opts |= TDBTCOLUMNAR;
       } else if(!strcmp(argv[i], "-nl")){
         omode |= TDBONOLCK;
       } else if(!strcmp(argv[i], "-nb")){
@@ -1416,6 +1446,251 @@ static int procmisc(const char *path, int rnum, bool mt, int opts, int omode){
     eprint(tdb, __LINE__, "(validation)");
     err = true;
   }
+  iprintf("checking parallel iteration:\n");
+  int64_t sums[2] = { 0, 0 };
+  if(!tctdbforeach(tdb, itercount, sums)){
+    eprint(tdb, __LINE__, "tctdbforeach");
+    err = true;
+  }
+  int tnum = myrand(4) + 2;
+  int64_t cnts[tnum][2];
+  void *pops[tnum];
+  for(int i = 0; i < tnum; i++){
+    cnts[i][0] = 0;
+    cnts[i][1] = 0;
+    pops[i] = cnts[i];
+  }
+  int64_t psums[2] = { 0, 0 };
+  if(!tctdbforeachpar(tdb, itercount, pops, tnum, reducecount, psums)){
+    eprint(tdb, __LINE__, "tctdbforeachpar");
+    err = true;
+  }
+  if(psums[0] != sums[0] || psums[1] != sums[1] || psums[0] != tctdbrnum(tdb)){
+    eprint(tdb, __LINE__, "(validation)");
+    err = true;
+  }
+  iprintf("checking result order:\n");
+  int onum = rnum / 10 + 1;
+  int64_t *onums = tcmalloc(sizeof(*onums) * onum);
+  for(int i = 0; i < onum; i++){
+    char pkbuf[RECBUFSIZ];
+    int pksiz = sprintf(pkbuf, "order:%d", i + 1);
+    TCMAP *cols = tcmapnew2(7);
+    char vbuf[RECBUFSIZ];
+    int vsiz = sprintf(vbuf, myrand(2) == 0 ? "+%d" : "%d", myrand(onum));
+    int64_t num = tcatoi(vbuf);
+    int j = i;
+    while(j > 0 && onums[j-1] > num){
+      onums[j] = onums[j-1];
+      j--;
+    }
+    onums[j] = num;
+    tcmapput(cols, "num", 3, vbuf, vsiz);
+    tcmapput2(cols, "str", "order");
+    if(!tctdbput(tdb, pkbuf, pksiz, cols)){
+      eprint(tdb, __LINE__, "tctdbput");
+      err = true;
+    }
+    tcmapdel(cols);
+  }
+  for(int i = 1; i <= rnum && !err; i++){
+    qry = tctdbqrynew(tdb);
+    tctdbqryaddcond(qry, "str", TDBQCSTREQ, "order");
+    bool asc = myrand(2) == 0;
+    tctdbqrysetorder(qry, "num", asc ? TDBQONUMASC : TDBQONUMDESC);
+    int max = myrand(onum) + 1;
+    tctdbqrysetlimit(qry, max, 0);
+    res = tctdbqrysearch(qry);
+    if(tclistnum(res) != max){
+      eprint(tdb, __LINE__, "(validation)");
+      err = true;
+    }
+    for(int j = 0; !err && j < tclistnum(res); j++){
+      int pksiz;
+      const char *pkbuf = tclistval(res, j, &pksiz);
+      TCMAP *cols = tctdbget(tdb, pkbuf, pksiz);
+      const char *num = cols ? tcmapget2(cols, "num") : NULL;
+      if(!num || tcatoi(num) != onums[asc ? j : onum - j - 1]){
+        eprint(tdb, __LINE__, "(validation)");
+        err = true;
+      }
+      if(cols) tcmapdel(cols);
+    }
+    tclistdel(res);
+    tctdbqrydel(qry);
+    if(rnum > 250 && i % (rnum / 250) == 0){
+      iputchar('.');
+      if(i == rnum || i % (rnum / 10) == 0) iprintf(" (%08d)\n", i);
+    }
+  }
+  for(int i = 0; i < onum; i++){
+    char pkbuf[RECBUFSIZ];
+    int pksiz = sprintf(pkbuf, "order:%d", i + 1);
+    if(!tctdbout(tdb, pkbuf, pksiz)){
+      eprint(tdb, __LINE__, "tctdbout");
+      err = true;
+    }
+  }
+  tcfree(onums);
+  iprintf("checking sparse columns:\n");
+  int snum = rnum / 10 + 1;
+  for(int i = 1; i <= snum; i++){
+    char pkbuf[RECBUFSIZ];
+    int pksiz = sprintf(pkbuf, "sparse:%d", i);
+    TCMAP *cols = tcmapnew2(7);
+    char nbuf[RECBUFSIZ];
+    sprintf(nbuf, "sparse:%d", i);
+    tcmapput2(cols, nbuf, pkbuf);
+    tcmapput2(cols, "str", "sparse");
+    if(!tctdbput(tdb, pkbuf, pksiz, cols)){
+      eprint(tdb, __LINE__, "tctdbput");
+      err = true;
+    }
+    tcmapdel(cols);
+  }
+  for(int i = 1; i <= snum && !err; i++){
+    char pkbuf[RECBUFSIZ];
+    int pksiz = sprintf(pkbuf, "sparse:%d", i);
+    TCMAP *cols = tctdbget(tdb, pkbuf, pksiz);
+    const char *vbuf = cols ? tcmapget2(cols, pkbuf) : NULL;
+    if(!cols || tcmaprnum(cols) != 2 || !vbuf || strcmp(vbuf, pkbuf)){
+      eprint(tdb, __LINE__, "(validation)");
+      err = true;
+    }
+    if(cols) tcmapdel(cols);
+    int vsiz;
+    char *cbuf = tctdbget4(tdb, pkbuf, pksiz, pkbuf, pksiz, &vsiz);
+    if(!cbuf || vsiz != pksiz || memcmp(cbuf, pkbuf, pksiz)){
+      eprint(tdb, __LINE__, "(validation)");
+      err = true;
+    }
+    tcfree(cbuf);
+    qry = tctdbqrynew(tdb);
+    tctdbqryaddcond(qry, pkbuf, TDBQCSTREQ, pkbuf);
+    tctdbqryaddcond(qry, "str", TDBQCSTREQ, "sparse");
+    res = tctdbqrysearch(qry);
+    if(tclistnum(res) != 1){
+      eprint(tdb, __LINE__, "(validation)");
+      err = true;
+    }
+    tclistdel(res);
+    tctdbqrydel(qry);
+    if(!tctdbout(tdb, pkbuf, pksiz)){
+      eprint(tdb, __LINE__, "tctdbout");
+      err = true;
+    }
+  }
+  iprintf("converting numeric indices:\n");
+  if(!tctdbsetindex(tdb, "", TDBITINT64)){
+    eprint(tdb, __LINE__, "tctdbsetindex");
+    err = true;
+  }
+  if(!tctdbsetindex(tdb, "num", myrand(2) == 0 ? TDBITINT64 : TDBITDOUBLE)){
+    eprint(tdb, __LINE__, "tctdbsetindex");
+    err = true;
+  }
+  iprintf("checking real number indices:\n");
+  if(!tctdbsetindex(tdb, "real", TDBITDOUBLE)){
+    eprint(tdb, __LINE__, "tctdbsetindex");
+    err = true;
+  }
+  if(!tctdbsetindex(tdb, "rtype,real:double", TDBITCOMPOSITE)){
+    eprint(tdb, __LINE__, "tctdbsetindex");
+    err = true;
+  }
+  const char *rfmts[] = {
+    "%d", "+%d", "-%d", "%d.5", "-%d.25", "%de3", "-%de2", "%d.99999999999999999999", "inf"
+  };
+  int rrnum = rnum / 10 + 1;
+  for(int i = 1; i <= rrnum; i++){
+    char pkbuf[RECBUFSIZ];
+    int pksiz = sprintf(pkbuf, "real:%d", i);
+    TCMAP *cols = tcmapnew2(7);
+    char vbuf[RECBUFSIZ];
+    sprintf(vbuf, rfmts[myrand(sizeof(rfmts) / sizeof(*rfmts))], myrand(rrnum));
+    tcmapput2(cols, "real", vbuf);
+    tcmapput2(cols, "rtype", myrand(2) == 0 ? "odd" : "even");
+    if(!tctdbput(tdb, pkbuf, pksiz, cols)){
+      eprint(tdb, __LINE__, "tctdbput");
+      err = true;
+    }
+    tcmapdel(cols);
+  }
+  const int rops[] = {
+    TDBQCNUMEQ, TDBQCNUMGT, TDBQCNUMGE, TDBQCNUMLT, TDBQCNUMLE, TDBQCNUMBT, TDBQCNUMOREQ
+  };
+  for(int i = 1; i <= rnum && !err; i++){
+    TDBQRY *myqry = tctdbqrynew(tdb);
+    qry = tctdbqrynew(tdb);
+    int op = rops[myrand(sizeof(rops) / sizeof(*rops))];
+    char expr[RECBUFSIZ];
+    int num = myrand(rrnum * 2) - rrnum / 2;
+    if(op == TDBQCNUMBT || op == TDBQCNUMOREQ){
+      sprintf(expr, "%d,%d,%d", num, num + myrand(rrnum), num - 1);
+    } else {
+      sprintf(expr, "%d", num);
+    }
+    tctdbqryaddcond(myqry, "real", op | TDBQCNOIDX, expr);
+    tctdbqryaddcond(qry, "real", op, expr);
+    if(myrand(2) == 0){
+      const char *rtype = myrand(2) == 0 ? "odd" : "even";
+      tctdbqryaddcond(myqry, "rtype", TDBQCSTREQ | TDBQCNOIDX, rtype);
+      tctdbqryaddcond(qry, "rtype", TDBQCSTREQ, rtype);
+    }
+    TCLIST *myres = tctdbqrysearch(myqry);
+    res = tctdbqrysearch(qry);
+    tclistsort(myres);
+    tclistsort(res);
+    if(tclistnum(myres) != tclistnum(res)){
+      eprint(tdb, __LINE__, "(validation)");
+      err = true;
+    }
+    for(int j = 0; !err && j < tclistnum(res); j++){
+      if(strcmp(tclistval2(myres, j), tclistval2(res, j))){
+        eprint(tdb, __LINE__, "(validation)");
+        err = true;
+      }
+    }
+    tclistdel(res);
+    tclistdel(myres);
+    tctdbqrydel(qry);
+    tctdbqrydel(myqry);
+    if(rnum > 250 && i % (rnum / 250) == 0){
+      iputchar('.');
+      if(i == rnum || i % (rnum / 10) == 0) iprintf(" (%08d)\n", i);
+    }
+  }
+  for(int i = 1; i <= rrnum; i++){
+    char pkbuf[RECBUFSIZ];
+    int pksiz = sprintf(pkbuf, "real:%d", i);
+    if(!tctdbout(tdb, pkbuf, pksiz)){
+      eprint(tdb, __LINE__, "tctdbout");
+      err = true;
+    }
+  }
+  if(!tctdbsetindex(tdb, "real", TDBITVOID) ||
+     !tctdbsetindex(tdb, "rtype,real:double", TDBITVOID)){
+    eprint(tdb, __LINE__, "tctdbsetindex");
+    err = true;
+  }
+  iprintf("setting composite indices:\n");
+  if(!tctdbsetindex(tdb, "str,num:int64", TDBITCOMPOSITE)){
+    eprint(tdb, __LINE__, "tctdbsetindex");
+    err = true;
+  }
+  if(!tctdbsetindex(tdb, "type:int64,num:double,str", TDBITCOMPOSITE)){
+    eprint(tdb, __LINE__, "tctdbsetindex");
+    err = true;
+  }
+  iprintf("optimizing indices:\n");
+  if(!tctdbsetindex(tdb, "str", TDBITOPT)){
+    eprint(tdb, __LINE__, "tctdbsetindex");
+    err = true;
+  }
+  if(!tctdbsetindex(tdb, "text", TDBITOPT)){
+    eprint(tdb, __LINE__, "tctdbsetindex");
+    err = true;
+  }
   iprintf("checking search consistency:\n");
   for(int i = 1; i <= rnum; i++){
     TDBQRY *myqry = tctdbqrynew(tdb);
@@ -1434,11 +1709,25 @@ static int procmisc(const char *path, int rnum, bool mt, int opts, int omode){
       tctdbqryaddcond(myqry, name, op | (myrand(2) == 0 ? TDBQCNOIDX : 0), expr);
       tctdbqryaddcond(qry, name, op | (myrand(2) == 0 ? TDBQCNOIDX : 0), expr);
     }
+    if(myrand(4) == 0){
+      const char *oname = names[myrand(sizeof(names) / sizeof(*names))];
+      int otype = types[myrand(sizeof(types) / sizeof(*types))];
+      tctdbqrysetorder(myqry, oname, otype);
+      tctdbqrysetorder(qry, oname, otype);
+    }
     int max = (myrand(10) == 0) ? 0 : myrand(10) + 1;
     if(max > 0){
       tctdbqrysetlimit(myqry, max, 0);
       tctdbqrysetlimit(qry, max, 0);
+      if(!tctdbsetparallel(tdb, myrand(2) == 0 ? tnum : 1)){
+        eprint(tdb, __LINE__, "tctdbsetparallel");
+        err = true;
+      }
       TCLIST *myres = tctdbqrysearch(myqry);
+      if(!tctdbsetparallel(tdb, 1)){
+        eprint(tdb, __LINE__, "tctdbsetparallel");
+        err = true;
+      }
       res = tctdbqrysearch(qry);
       if(tclistnum(myres) != tclistnum(res)){
         eprint(tdb, __LINE__, "(validation)");
@@ -1447,7 +1736,15 @@ static int procmisc(const char *path, int rnum, bool mt, int opts, int omode){
       tclistdel(res);
       tclistdel(myres);
     } else {
+      if(!tctdbsetparallel(tdb, myrand(2) == 0 ? tnum : 1)){
+        eprint(tdb, __LINE__, "tctdbsetparallel");
+        err = true;
+      }
       TCLIST *myres = tctdbqrysearch(myqry);
+      if(!tctdbsetparallel(tdb, 1)){
+        eprint(tdb, __LINE__, "tctdbsetparallel");
+        err = true;
+      }
       res = tctdbqrysearch(qry);
       if(tclistnum(myres) == tclistnum(res)){
         tclistsort(myres);
@@ -1492,6 +1789,233 @@ static int procmisc(const char *path, int rnum, bool mt, int opts, int omode){
     err = true;
   }
   tctdbqrydel(qry);
+  iprintf("checking prepared queries:\n");
+  TDBQRY *pqry = tctdbqrynew(tdb);
+  tctdbqryaddcond(pqry, "num", TDBQCNUMBT, "?");
+  tctdbqryaddcond(pqry, "str", TDBQCSTRBW, "?");
+  tctdbqryaddcond(pqry, "type", TDBQCNUMOREQ, "?");
+  for(int i = 1; i <= rnum && !err; i++){
+    char lbuf[RECBUFSIZ], sbuf[RECBUFSIZ], tbuf[RECBUFSIZ];
+    sprintf(lbuf, "%d,%d", myrand(i), myrand(i));
+    sprintf(sbuf, "%d", myrand(i / 10 + 1));
+    sprintf(tbuf, "%d %d %d", myrand(32), myrand(32), myrand(32));
+    if(!tctdbqrybind(pqry, 0, lbuf) || !tctdbqrybind(pqry, 1, sbuf) ||
+       !tctdbqrybind(pqry, 2, tbuf)){
+      eprint(tdb, __LINE__, "tctdbqrybind");
+      err = true;
+    }
+    qry = tctdbqrynew(tdb);
+    tctdbqryaddcond(qry, "num", TDBQCNUMBT | TDBQCNOIDX, lbuf);
+    tctdbqryaddcond(qry, "str", TDBQCSTRBW | TDBQCNOIDX, sbuf);
+    tctdbqryaddcond(qry, "type", TDBQCNUMOREQ | TDBQCNOIDX, tbuf);
+    TCLIST *myres = tctdbqrysearch(pqry);
+    res = tctdbqrysearch(qry);
+    if(tclistnum(myres) != tclistnum(res)){
+      eprint(tdb, __LINE__, "(validation)");
+      err = true;
+    }
+    tclistdel(res);
+    tclistdel(myres);
+    tctdbqrydel(qry);
+    if(rnum > 250 && i % (rnum / 250) == 0){
+      iputchar('.');
+      if(i == rnum || i % (rnum / 10) == 0) iprintf(" (%08d)\n", i);
+    }
+  }
+  if(tctdbqrybind(pqry, 3, "")){
+    eprint(tdb, __LINE__, "tctdbqrybind");
+    err = true;
+  }
+  tctdbqrydel(pqry);
+  iprintf("checking query cursors:\n");
+  for(int i = 1; i <= rnum && !err; i++){
+    char ebuf[RECBUFSIZ];
+    qry = tctdbqrynew(tdb);
+    switch(myrand(4)){
+    default:
+      sprintf(ebuf, "%d", myrand(i));
+      tctdbqryaddcond(qry, "num", TDBQCNUMGE, ebuf);
+      break;
+    case 1:
+      sprintf(ebuf, "%d", myrand(i / 10 + 1));
+      tctdbqryaddcond(qry, "str", TDBQCSTRBW, ebuf);
+      break;
+    case 2:
+      sprintf(ebuf, "%d %d", myrand(32), myrand(32));
+      tctdbqryaddcond(qry, "type", TDBQCNUMOREQ, ebuf);
+      break;
+    case 3:
+      sprintf(ebuf, "%d", myrand(i));
+      tctdbqryaddcond(qry, "flag", TDBQCSTRBW, ebuf);
+      tctdbqrysetorder(qry, "num", TDBQONUMASC);
+      break;
+    }
+    res = tctdbqrysearch(qry);
+    TCMAP *pkeys = tcmapnew();
+    char *lpk = NULL;
+    int cnt = 0;
+    while(!err){
+      TDBQRYCUR *cur = tctdbqrycurnew(qry);
+      if(lpk && !tctdbqrycurjump(cur, lpk, strlen(lpk))){
+        eprint(tdb, __LINE__, "tctdbqrycurjump");
+        err = true;
+      }
+      int pnum = 0;
+      char *pk;
+      while(pnum < 10 && (pk = tctdbqrycurnext2(cur)) != NULL){
+        tcmapput2(pkeys, pk, "");
+        tcfree(lpk);
+        lpk = pk;
+        pnum++;
+      }
+      tctdbqrycurdel(cur);
+      cnt += pnum;
+      if(pnum < 10) break;
+    }
+    tcfree(lpk);
+    if(cnt != tclistnum(res) || tcmaprnum(pkeys) != tclistnum(res)){
+      eprint(tdb, __LINE__, "(validation)");
+      err = true;
+    }
+    tcmapdel(pkeys);
+    tclistdel(res);
+    tctdbqrydel(qry);
+    if(rnum > 250 && i % (rnum / 250) == 0){
+      iputchar('.');
+      if(i == rnum || i % (rnum / 10) == 0) iprintf(" (%08d)\n", i);
+    }
+  }
+  iprintf("checking aggregation:\n");
+  for(int i = 1; i <= rnum && !err; i++){
+    char ebuf[RECBUFSIZ];
+    sprintf(ebuf, "%d", myrand(i));
+    qry = tctdbqrynew(tdb);
+    tctdbqryaddcond(qry, "num", myrand(2) == 0 ? TDBQCNUMGE : TDBQCNUMGE | TDBQCNOIDX, ebuf);
+    res = tctdbqrysearch(qry);
+    TCMAP *mymap = tcmapnew();
+    int rsiz = tclistnum(res);
+    for(int j = 0; j < rsiz; j++){
+      int pksiz;
+      const char *pkbuf = tclistval(res, j, &pksiz);
+      TCMAP *cols = tctdbget(tdb, pkbuf, pksiz);
+      if(!cols) continue;
+      const char *type = tcmapget2(cols, "type");
+      const char *num = tcmapget2(cols, "num");
+      tcmapaddint(mymap, type ? type : "", type ? strlen(type) : 0, 1);
+      if(num) tcmapadddouble(mymap, "*", 1, tcatof(num));
+      tcmapdel(cols);
+    }
+    if(!tctdbsetparallel(tdb, myrand(2) == 0 ? tnum : 1)){
+      eprint(tdb, __LINE__, "tctdbsetparallel");
+      err = true;
+    }
+    TCMAP *aggrs = tctdbqryaggr(qry, "type", "num");
+    if(!tctdbsetparallel(tdb, 1)){
+      eprint(tdb, __LINE__, "tctdbsetparallel");
+      err = true;
+    }
+    double sum = 0;
+    tcmapiterinit(aggrs);
+    const char *kbuf;
+    int ksiz;
+    while((kbuf = tcmapiternext(aggrs, &ksiz)) != NULL){
+      int vsiz;
+      TDBAGGR aggr;
+      memcpy(&aggr, tcmapiterval(kbuf, &vsiz), sizeof(aggr));
+      const char *mbuf = tcmapget(mymap, kbuf, ksiz, &vsiz);
+      int num;
+      if(mbuf) memcpy(&num, mbuf, sizeof(num));
+      if(!mbuf || aggr.num != num || aggr.dnum > aggr.vnum){
+        eprint(tdb, __LINE__, "(validation)");
+        err = true;
+      }
+      sum += aggr.sum;
+    }
+    int vsiz;
+    const char *mbuf = tcmapget(mymap, "*", 1, &vsiz);
+    double mysum = 0;
+    if(mbuf) memcpy(&mysum, mbuf, sizeof(mysum));
+    if(tcmaprnum(aggrs) != tcmaprnum(mymap) - (mbuf ? 1 : 0) || sum != mysum){
+      eprint(tdb, __LINE__, "(validation)");
+      err = true;
+    }
+    tcmapdel(aggrs);
+    tcmapdel(mymap);
+    tclistdel(res);
+    tctdbqrydel(qry);
+    if(rnum > 250 && i % (rnum / 250) == 0){
+      iputchar('.');
+      if(i == rnum || i % (rnum / 10) == 0) iprintf(" (%08d)\n", i);
+    }
+  }
+  iprintf("checking ranked search:\n");
+  for(int i = 1; i <= rnum && !err; i++){
+    bool qg = myrand(2) == 0;
+    const char *name = qg ? "text" : "flag";
+    int ra = myrand(i) + 1;
+    int rb = rnum / (myrand(rnum) + 1);
+    char ebuf[RECBUFSIZ];
+    sprintf(ebuf, "%d %d", ra, rb);
+    qry = tctdbqrynew(tdb);
+    char sbuf[RECBUFSIZ];
+    sprintf(sbuf, qg ? "%d || %d" : "%d,%d", ra, rb);
+    tctdbqryaddcond(qry, name, qg ? TDBQCFTSEX : TDBQCSTROR, sbuf);
+    res = tctdbqrysearch(qry);
+    tctdbqrydel(qry);
+    qry = tctdbqrynew(tdb);
+    TCMAP *all = tctdbqryrank(qry, name, ebuf, -1);
+    if(tcmaprnum(all) != tclistnum(res)){
+      eprint(tdb, __LINE__, "(validation)");
+      err = true;
+    }
+    int rsiz = tclistnum(res);
+    for(int j = 0; j < rsiz; j++){
+      int pksiz;
+      const char *pkbuf = tclistval(res, j, &pksiz);
+      int vsiz;
+      if(!tcmapget(all, pkbuf, pksiz, &vsiz)){
+        eprint(tdb, __LINE__, "(validation)");
+        err = true;
+        break;
+      }
+    }
+    tclistdel(res);
+    tcmapdel(all);
+    if(myrand(2) == 0){
+      sprintf(sbuf, "%d", myrand(i));
+      tctdbqryaddcond(qry, "num", TDBQCNUMGE, sbuf);
+    }
+    all = tctdbqryrank(qry, name, ebuf, -1);
+    int max = myrand(10);
+    TCMAP *top = tctdbqryrank(qry, name, ebuf, max);
+    if(tcmaprnum(top) != tclmin(max, tcmaprnum(all))){
+      eprint(tdb, __LINE__, "(validation)");
+      err = true;
+    }
+    tcmapiterinit(all);
+    tcmapiterinit(top);
+    double score = HUGE_VAL;
+    const char *kbuf;
+    int ksiz;
+    while(!err && (kbuf = tcmapiternext(top, &ksiz)) != NULL){
+      int asiz;
+      const char *abuf = tcmapiternext(all, &asiz);
+      const char *vbuf = tcmapiterval2(kbuf);
+      if(!abuf || asiz != ksiz || memcmp(abuf, kbuf, ksiz) ||
+         strcmp(tcmapiterval2(abuf), vbuf) || tcatof(vbuf) > score){
+        eprint(tdb, __LINE__, "(validation)");
+        err = true;
+      }
+      score = tcatof(vbuf);
+    }
+    tcmapdel(top);
+    tcmapdel(all);
+    tctdbqrydel(qry);
+    if(rnum > 250 && i % (rnum / 250) == 0){
+      iputchar('.');
+      if(i == rnum || i % (rnum / 10) == 0) iprintf(" (%08d)\n", i);
+    }
+  }
   iprintf("checking transaction commit:\n");
   if(!tctdbtranbegin(tdb)){
     eprint(tdb, __LINE__, "tctdbtranbegin");
@@ -3501,6 +3501,7 @@ const char *tctreeget4(TCTREE *tree, const char *kstr, const char *dstr){
 void tctreeiterinit2(TCTREE *tree, const void *kbuf, int ksiz){
   assert(tree && kbuf && ksiz >= 0);
   TCTREEREC *rec = tree->root;
+  tree->cur = NULL;
   while(rec){
     char *dbuf = (char *)rec + sizeof(*rec);
     int cv = tree->cmp(kbuf, ksiz, dbuf, rec->ksiz, tree->cmpop);
@@ -9524,6 +9525,23 @@ int tccmpint64(const char *aptr, int asiz, const char *bptr, int bsiz, void *op)
 }
 
 
+/* Compare two keys as unsigned integers in the big-endian byte order. */
+int tccmpbeint(const char *aptr, int asiz, const char *bptr, int bsiz, void *op){
+  assert(aptr && asiz >= 0 && bptr && bsiz >= 0);
+  while(asiz > bsiz){
+    if(*aptr != '\0') return 1;
+    aptr++;
+    asiz--;
+  }
+  while(bsiz > asiz){
+    if(*bptr != '\0') return -1;
+    bptr++;
+    bsiz--;
+  }
+  return memcmp(aptr, bptr, asiz);
+}
+
+
 /* Compress a serial object with TCBS encoding. */
 char *tcbsencode(const char *ptr, int size, int *sp){
   assert(ptr && size >= 0 && sp);
@@ -152,6 +152,18 @@ typedef void *(*TCPDPROC)(const void *vbuf, int vsiz, int *sp, void *op);
    The return value is true to continue iteration or false to stop iteration. */
 typedef bool (*TCITER)(const void *kbuf, int ksiz, const void *vbuf, int vsiz, void *op);
 
+/* type of the pointer to a progress function.
+   `done' specifies the amount of processed data.
+   `total' specifies the total amount of data.
+   `op' specifies the pointer to the optional opaque object.
+   The return value is true to continue the process or false to stop it. */
+typedef bool (*TCPROGRESS)(int64_t done, int64_t total, void *op);
+
+/* type of the pointer to a reduce function.
+   `op' specifies the pointer to the opaque object of a worker.
+   `rop' specifies the pointer to the opaque object of the result. */
+typedef void (*TCREDUCE)(void *op, void *rop);
+
 
 
 /*************************************************************************************************
@@ -1051,7 +1063,8 @@ TCTREE *tctreenew(void);
    If it is not needed, `NULL' can be specified.
    The return value is the new tree object.
    The default comparison function compares keys of two records by lexical order.  The functions
-   `tccmplexical' (dafault), `tccmpdecimal', `tccmpint32', and `tccmpint64' are built-in. */
+   `tccmplexical' (dafault), `tccmpdecimal', `tccmpint32', `tccmpint64', and `tccmpbeint' are
+   built-in. */
 TCTREE *tctreenew2(TCCMP cmp, void *cmpop);
 
 
@@ -1815,8 +1828,8 @@ TCNDB *tcndbnew(void);
    If it is not needed, `NULL' can be specified.
    The return value is the new on-memory tree database object.
    The default comparison function compares keys of two records by lexical order.  The functions
-   `tccmplexical' (dafault), `tccmpdecimal', `tccmpint32', and `tccmpint64' are built-in.  The
-   object can be shared by plural threads because of the internal mutex. */
+   `tccmplexical' (dafault), `tccmpdecimal', `tccmpint32', `tccmpint64', and `tccmpbeint' are
+   built-in.  The object can be shared by plural threads because of the internal mutex. */
 TCNDB *tcndbnew2(TCCMP cmp, void *cmpop);
 
 
@@ -3779,6 +3792,20 @@ int tccmpint32(const char *aptr, int asiz, const char *bptr, int bsiz, void *op)
 int tccmpint64(const char *aptr, int asiz, const char *bptr, int bsiz, void *op);
 
 
+/* Compare two keys as unsigned integers in the big-endian byte order.
+   `aptr' specifies the pointer to the region of one key.
+   `asiz' specifies the size of the region of one key.
+   `bptr' specifies the pointer to the region of the other key.
+   `bsiz' specifies the size of the region of the other key.
+   `op' is ignored.
+   The return value is positive if the former is big, negative if the latter is big, 0 if both
+   are equivalent.
+   Keys of any width can be compared and leading zero bytes are not significant.  Keys of the
+   same width are compared as by `memcmp', so keys of fixed width such as time stamps and ID
+   numbers are ordered fast. */
+int tccmpbeint(const char *aptr, int asiz, const char *bptr, int bsiz, void *op);
+
+
 /* Encode a serial object with BWT encoding.
    `ptr' specifies the pointer to the region.
    `size' specifies the size of the region.